@@ -62,6 +62,12 @@ account_verify(const AuthenticationProviders* auth_providers,
 			return UserValidityOk;
 		}
 		VARIANT_CASE_END();
+		CASE_AUTHENTICATION_FIND_RESULT_IS_BUSY() {
+			LOG_MESSAGE_SIMPLE(LogLevelWarn, "The authentication providers are busy, the user "
+			                                 "couldn't be checked\n");
+			return UserValidityInternalError;
+		}
+		VARIANT_CASE_END();
 		default: {
 			LOG_MESSAGE_SIMPLE(LogLevelError, "An error occurred, while trying to find a user with "
 			                                  "password, unexpected return type enum value\n");
@@ -183,7 +183,7 @@ cleanup:
 
 NODISCARD static bool nts_internal_set_last_change_to_now(DataConnection* connection) {
 	Time current_time;
-	bool clock_result = get_monotonic_time(&current_time);
+	bool clock_result = get_coarse_monotonic_time(&current_time);
 
 	if(!clock_result) {
 		LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -356,7 +356,7 @@ NODISCARD static bool nts_internal_should_close_connection(DataConnection* conne
 		// Check timeout
 
 		Time current_time;
-		bool clock_result = get_monotonic_time(&current_time);
+		bool clock_result = get_coarse_monotonic_time(&current_time);
 
 		if(!clock_result) {
 			return false;
@@ -739,7 +739,7 @@ bool ftp_process_command(ConnectionDescriptor* const descriptor, FTPAddrField se
 				// Wait for data connection
 
 				Time start_time;
-				bool clock_result = get_monotonic_time(&start_time);
+				bool clock_result = get_coarse_monotonic_time(&start_time);
 
 				if(!clock_result) {
 					LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -772,7 +772,7 @@ bool ftp_process_command(ConnectionDescriptor* const descriptor, FTPAddrField se
 					}
 
 					Time current_time;
-					bool clock_result_2 = get_monotonic_time(&current_time);
+					bool clock_result_2 = get_coarse_monotonic_time(&current_time);
 
 					if(!clock_result_2) {
 						LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -945,7 +945,7 @@ bool ftp_process_command(ConnectionDescriptor* const descriptor, FTPAddrField se
 				// Wait for data connection
 
 				Time start_time;
-				bool clock_result = get_monotonic_time(&start_time);
+				bool clock_result = get_coarse_monotonic_time(&start_time);
 
 				if(!clock_result) {
 					LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -977,7 +977,7 @@ bool ftp_process_command(ConnectionDescriptor* const descriptor, FTPAddrField se
 					}
 
 					Time current_time;
-					bool clock_result_2 = get_monotonic_time(&current_time);
+					bool clock_result_2 = get_coarse_monotonic_time(&current_time);
 
 					if(!clock_result_2) {
 						LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -1190,7 +1190,7 @@ bool ftp_process_command(ConnectionDescriptor* const descriptor, FTPAddrField se
 				// Wait for data connection
 
 				Time start_time;
-				bool clock_result = get_monotonic_time(&start_time);
+				bool clock_result = get_coarse_monotonic_time(&start_time);
 
 				if(!clock_result) {
 					LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -1226,7 +1226,7 @@ bool ftp_process_command(ConnectionDescriptor* const descriptor, FTPAddrField se
 					}
 
 					Time current_time;
-					bool clock_result_2 = get_monotonic_time(&current_time);
+					bool clock_result_2 = get_coarse_monotonic_time(&current_time);
 
 					if(!clock_result_2) {
 						LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
@@ -2001,6 +2001,9 @@ ExitCode start_ftp_server(const FTPPortField control_port, tstr folder,
 		ports[i] = (uint16_t)next_port;
 	}
 
+	// the data connection timeouts use the coarse monotonic time of the clock service
+	global_start_clock_service();
+
 	// initializing the thread Arguments for the single listener thread, it receives all
 	// necessary arguments
 	pthread_t data_orchestrator_thread = {};
@@ -2128,6 +2131,8 @@ ExitCode start_ftp_server(const FTPPortField control_port, tstr folder,
 
 	free_authentication_providers(auth_providers);
 
+	global_stop_clock_service();
+
 #ifdef _SIMPLE_SERVER_USE_OPENSSL
 	openssl_cleanup_global_state();
 #endif
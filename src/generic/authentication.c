@@ -1,11 +1,15 @@
 #include "./authentication.h"
+#include "./authentication_cache.h"
+#include "./authentication_session.h"
 
 #ifdef _SIMPLE_SERVER_HAVE_BCRYPT
 	#include <bcrypt.h>
 #endif
 
 #include "utils/log.h"
+#include "utils/offload_pool.h"
 
+#include <stdatomic.h>
 #include <tmap.h>
 #include <tvec.h>
 
@@ -33,8 +37,22 @@ TVEC_DEFINE_AND_IMPLEMENT_VEC_TYPE_EXTENDED(AuthenticationProvider*, Authenticat
 
 struct AuthenticationProvidersImpl {
 	TVEC_TYPENAME(AuthenticationProviderPtr) providers;
+	// NULL, if it couldn't be initialized, then every lookup asks the providers
+	AuthenticationCache* cache;
+	// NULL, if it couldn't be initialized, then no sessions can be created
+	AuthenticationSessionStore* sessions;
 };
 
+// changes on every modification of an account store, cached results of older generations are
+// never used
+static atomic_uint_fast64_t
+    g_account_store_generation = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    0;
+
+void authentication_providers_invalidate_cache(void) {
+	atomic_fetch_add_explicit(&g_account_store_generation, 1, memory_order_acq_rel);
+}
+
 NODISCARD tstr_static get_name_for_auth_provider_type(const AuthenticationProviderType type) {
 	switch(type) {
 		case AuthenticationProviderTypeSimple:
@@ -63,6 +81,19 @@ NODISCARD AuthenticationProviders* initialize_authentication_providers(void) {
 
 	auth_providers->providers = TVEC_EMPTY(AuthenticationProviderPtr);
 
+	auth_providers->cache = initialize_authentication_cache(AUTHENTICATION_CACHE_TTL_MS);
+
+	if(auth_providers->cache == NULL) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn, "Couldn't initialize the authentication cache\n");
+	}
+
+	auth_providers->sessions =
+	    initialize_authentication_session_store(AUTHENTICATION_SESSION_TTL_MS);
+
+	if(auth_providers->sessions == NULL) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn, "Couldn't initialize the authentication sessions\n");
+	}
+
 	return auth_providers;
 }
 
@@ -111,6 +142,9 @@ NODISCARD bool add_authentication_provider(AuthenticationProviders* const auth_p
 	const TvecResult zvec_result =
 	    TVEC_PUSH(AuthenticationProviderPtr, &auth_providers->providers, provider);
 
+	// a user may now be found by another provider first
+	authentication_providers_invalidate_cache();
+
 	return zvec_result == TvecResultOk; // NOLINT(readability-implicit-bool-conversion)
 }
 
@@ -166,6 +200,8 @@ NODISCARD bool add_user_to_simple_authentication_provider_data_password_hash_sal
 		return false;
 	}
 
+	authentication_providers_invalidate_cache();
+
 	return true;
 }
 
@@ -217,6 +253,10 @@ void free_authentication_providers(AuthenticationProviders* const auth_providers
 
 	TVEC_FREE(AuthenticationProviderPtr, &(auth_providers->providers));
 
+	free_authentication_cache(auth_providers->cache);
+
+	free_authentication_session_store(auth_providers->sessions);
+
 	free(auth_providers);
 }
 
@@ -702,7 +742,7 @@ NODISCARD static int8_t compare_auth_results(const AuthenticationFindResult auth
 TVEC_DEFINE_AND_IMPLEMENT_VEC_TYPE(AuthenticationFindResult)
 /* NOLINTEND(misc-use-internal-linkage) */
 
-NODISCARD AuthenticationFindResult authentication_providers_find_user_with_password(
+NODISCARD static AuthenticationFindResult authentication_providers_find_user_with_password_uncached(
     const AuthenticationProviders* const auth_providers,
     const tstr* const username, // NOLINT(bugprone-easily-swappable-parameters)
     const tstr* const password) {
@@ -778,3 +818,100 @@ NODISCARD AuthenticationFindResult authentication_providers_find_user_with_passw
 
 	return best_result;
 }
+
+typedef struct {
+	const AuthenticationProviders* auth_providers;
+	const tstr* username;
+	const tstr* password;
+	AuthenticationFindResult result;
+} AuthenticationFindJob;
+
+static void authentication_find_job_function(ANY_TYPE(AuthenticationFindJob*) arg) {
+
+	AuthenticationFindJob* const job = (AuthenticationFindJob*)arg;
+
+	job->result = authentication_providers_find_user_with_password_uncached(
+	    job->auth_providers, job->username, job->password);
+}
+
+NODISCARD AuthenticationFindResult authentication_providers_find_user_with_password(
+    const AuthenticationProviders* const auth_providers,
+    const tstr* const username, // NOLINT(bugprone-easily-swappable-parameters)
+    const tstr* const password) {
+
+	// taken before the providers are asked, so that a result of a changed account store isn't
+	// cached as current one
+	const uint64_t generation =
+	    atomic_load_explicit(&g_account_store_generation, memory_order_acquire);
+
+	AuthenticationCacheKey key = { .data = {}, .size = 0 };
+
+	const bool has_key =
+	    auth_providers->cache != NULL &&
+	    get_authentication_cache_key(auth_providers->cache, username, password, &key);
+
+	if(has_key) {
+		AuthUserWithContext user;
+
+		if(authentication_cache_get(auth_providers->cache, &key, generation, &user)) {
+			return new_authentication_find_result_ok(user);
+		}
+	}
+
+	// bcrypt and pam are slow or block, so they don't run on the connection workers
+	AuthenticationFindJob job = {
+		.auth_providers = auth_providers,
+		.username = username,
+		.password = password,
+		.result = new_authentication_find_result_error(TSTR_STATIC_LIT("offloading failed")),
+	};
+
+	const OffloadResult offload_result = offload_run(authentication_find_job_function, &job);
+
+	if(offload_result == OffloadResultRejected) {
+		return new_authentication_find_result_busy();
+	}
+
+	const AuthenticationFindResult result = job.result;
+
+	if(has_key) {
+		IF_AUTHENTICATION_FIND_RESULT_IS_OK_CONST(result) {
+			// pam accounts can change without the generation changing, see authentication_cache.h
+			if(ok.provider_type != AuthenticationProviderTypeSystem) {
+				authentication_cache_put(auth_providers->cache, &key, generation, ok);
+			}
+		}
+	}
+
+	return result;
+}
+
+NODISCARD tstr authentication_providers_create_session(
+    const AuthenticationProviders* const auth_providers, const AuthUserWithContext user,
+    bool* const store_full) {
+
+	const uint64_t generation =
+	    atomic_load_explicit(&g_account_store_generation, memory_order_acquire);
+
+	return authentication_session_create(auth_providers->sessions, generation, user, store_full);
+}
+
+NODISCARD AuthenticationFindResult authentication_providers_find_user_with_session(
+    const AuthenticationProviders* const auth_providers, const tstr_view token) {
+
+	const uint64_t generation =
+	    atomic_load_explicit(&g_account_store_generation, memory_order_acquire);
+
+	AuthUserWithContext user;
+
+	if(!authentication_session_find(auth_providers->sessions, token, generation, &user)) {
+		return new_authentication_find_result_no_such_user();
+	}
+
+	return new_authentication_find_result_ok(user);
+}
+
+bool authentication_providers_revoke_session(const AuthenticationProviders* const auth_providers,
+                                             const tstr_view token) {
+	return authentication_session_revoke(auth_providers->sessions, token);
+}
@@ -9,6 +9,10 @@
 
 #include "all_variants.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct AuthenticationProvidersImpl AuthenticationProviders;
 
 typedef struct AuthenticationProviderImpl AuthenticationProvider;
@@ -49,6 +53,10 @@ NODISCARD bool add_user_to_simple_authentication_provider_data_password_hash_sal
 
 void free_authentication_providers(AuthenticationProviders* auth_providers);
 
+// the verified credentials of all providers are cached, this has to be called, after an account
+// store changed (e.g. it was reloaded) outside of the functions above, they already call it
+void authentication_providers_invalidate_cache(void);
+
 typedef struct {
 	tstr username;
 	UserRole role;
@@ -61,5 +69,29 @@ typedef struct {
 
 GENERATE_VARIANT_ALL_AUTHENTICATION_FIND_RESULT()
 
+// the providers are asked on the offload pool, if that is full, busy is returned and the
+// credentials weren't checked
 NODISCARD AuthenticationFindResult authentication_providers_find_user_with_password(
     const AuthenticationProviders* auth_providers, const tstr* username, const tstr* password);
+
+// sessions are issued after a successful password check, so that later requests don't need to
+// check the password again, they expire after some time, can be revoked and are all invalidated,
+// if an account store changes
+
+// returns the new opaque token, or a null tstr on errors, store_full is set, if no session could be
+// stored, as too many users have sessions
+NODISCARD tstr authentication_providers_create_session(
+    const AuthenticationProviders* auth_providers, AuthUserWithContext user,
+    OUT_PARAM(bool) store_full);
+
+// returns no such user, if the token is unknown, expired or revoked
+NODISCARD AuthenticationFindResult authentication_providers_find_user_with_session(
+    const AuthenticationProviders* auth_providers, tstr_view token);
+
+// returns true, if the token belonged to a session
+bool authentication_providers_revoke_session(const AuthenticationProviders* auth_providers,
+                                             tstr_view token);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,235 @@
+#include "./authentication_cache.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define AUTHENTICATION_CACHE_HMAC_KEY_SIZE 32
+
+typedef struct {
+	AuthenticationCacheKey key;
+	AuthUserWithContext user;
+	uint64_t generation;
+	uint64_t inserted_at_ms;
+	uint64_t expires_at_ms;
+	bool used;
+} AuthenticationCacheEntry;
+
+struct AuthenticationCacheImpl {
+	uint8_t hmac_key[AUTHENTICATION_CACHE_HMAC_KEY_SIZE];
+	uint64_t ttl_ms;
+	pthread_mutex_t mutex;
+	AuthenticationCacheEntry entries[AUTHENTICATION_CACHE_SET_AMOUNT][AUTHENTICATION_CACHE_WAYS];
+};
+
+NODISCARD AuthenticationCache* initialize_authentication_cache(const uint64_t ttl_ms) {
+
+	AuthenticationCache* cache = malloc(sizeof(AuthenticationCache));
+
+	if(!cache) {
+		return NULL;
+	}
+
+	int result = pthread_mutex_init(&cache->mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result,
+	    "An Error occurred while trying to initialize the mutex for the authentication cache",
+	    free(cache);
+	    return NULL;);
+
+	const GenericResult random_result =
+	    get_random_bytes(AUTHENTICATION_CACHE_HMAC_KEY_SIZE, cache->hmac_key);
+
+	IF_GENERIC_RESULT_IS_ERROR_IGN(random_result) {
+		result = pthread_mutex_destroy(&cache->mutex);
+		CHECK_FOR_THREAD_ERROR(result,
+		                       "An Error occurred while trying to destroy the mutex in the "
+		                       "authentication cache",
+		                       {});
+		free(cache);
+		return NULL;
+	}
+
+	cache->ttl_ms = ttl_ms;
+
+	for(size_t set = 0; set < AUTHENTICATION_CACHE_SET_AMOUNT; ++set) {
+		for(size_t way = 0; way < AUTHENTICATION_CACHE_WAYS; ++way) {
+			cache->entries[set][way].used = false;
+		}
+	}
+
+	return cache;
+}
+
+// has to be called with the mutex locked, or while no one else uses the cache
+static void clear_authentication_cache_entry(AuthenticationCacheEntry* const entry) {
+
+	if(!entry->used) {
+		return;
+	}
+
+	tstr_free(&(entry->user.user.username));
+	explicit_bzero(&(entry->key), sizeof(entry->key));
+	entry->used = false;
+}
+
+void free_authentication_cache(AuthenticationCache* const cache) {
+
+	if(cache == NULL) {
+		return;
+	}
+
+	for(size_t set = 0; set < AUTHENTICATION_CACHE_SET_AMOUNT; ++set) {
+		for(size_t way = 0; way < AUTHENTICATION_CACHE_WAYS; ++way) {
+			clear_authentication_cache_entry(&(cache->entries[set][way]));
+		}
+	}
+
+	explicit_bzero(cache->hmac_key, sizeof(cache->hmac_key));
+
+	int result = pthread_mutex_destroy(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(result,
+	                       "An Error occurred while trying to destroy the mutex in the "
+	                       "authentication cache",
+	                       {});
+
+	free(cache);
+}
+
+NODISCARD bool get_authentication_cache_key(const AuthenticationCache* const cache,
+                                            const tstr* const username,
+                                            const tstr* const password,
+                                            AuthenticationCacheKey* const key) {
+
+	const size_t username_length = tstr_len(username);
+	const size_t password_length = tstr_len(password);
+
+	// the username is prefixed by its length, so that "ab" + "c" and "a" + "bc" are different keys
+	const size_t data_size = sizeof(uint64_t) + username_length + password_length;
+
+	uint8_t* const data = malloc(data_size);
+
+	if(!data) {
+		return false;
+	}
+
+	const uint64_t username_length_value = username_length;
+	memcpy(data, &username_length_value, sizeof(uint64_t));
+	memcpy(data + sizeof(uint64_t), tstr_cstr(username), username_length);
+	memcpy(data + sizeof(uint64_t) + username_length, tstr_cstr(password), password_length);
+
+	const bool success = get_hmac_digest(
+	    (ReadonlyBuffer){ .data = cache->hmac_key, .size = AUTHENTICATION_CACHE_HMAC_KEY_SIZE },
+	    (ReadonlyBuffer){ .data = data, .size = data_size }, key);
+
+	// the password must not stay in freed memory
+	explicit_bzero(data, data_size);
+	free(data);
+
+	return success;
+}
+
+NODISCARD bool authentication_cache_get(AuthenticationCache* const cache,
+                                        const AuthenticationCacheKey* const key,
+                                        const uint64_t generation,
+                                        AuthUserWithContext* const user) {
+
+	if(cache == NULL) {
+		return false;
+	}
+
+	const uint64_t now_ms = get_coarse_monotonic_time_in_ms();
+
+	const size_t set_index = hmac_digest_get_index(key, AUTHENTICATION_CACHE_SET_AMOUNT);
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the authentication cache",
+	    return false;);
+
+	bool found = false;
+
+	for(size_t way = 0; way < AUTHENTICATION_CACHE_WAYS; ++way) {
+		AuthenticationCacheEntry* const entry = &(cache->entries[set_index][way]);
+
+		if(!entry->used) {
+			continue;
+		}
+
+		// expired entries and the ones of an old account store are evicted lazily
+		if(entry->expires_at_ms <= now_ms || entry->generation != generation) {
+			clear_authentication_cache_entry(entry);
+			continue;
+		}
+
+		if(hmac_digest_eq(&(entry->key), key)) {
+			*user = (AuthUserWithContext){
+				.user = { .username = tstr_dup(&(entry->user.user.username)),
+				          .role = entry->user.user.role },
+				.provider_type = entry->user.provider_type,
+			};
+			found = true;
+			break;
+		}
+	}
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the authentication cache",
+	    {});
+
+	return found;
+}
+
+void authentication_cache_put(AuthenticationCache* const cache,
+                              const AuthenticationCacheKey* const key, const uint64_t generation,
+                              const AuthUserWithContext user) {
+
+	if(cache == NULL) {
+		return;
+	}
+
+	const uint64_t now_ms = get_coarse_monotonic_time_in_ms();
+
+	const size_t set_index = hmac_digest_get_index(key, AUTHENTICATION_CACHE_SET_AMOUNT);
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the authentication cache",
+	    return;);
+
+	// an entry with the same key is replaced, otherwise a free or the oldest slot is used
+	AuthenticationCacheEntry* slot = NULL;
+
+	for(size_t way = 0; way < AUTHENTICATION_CACHE_WAYS; ++way) {
+		AuthenticationCacheEntry* const entry = &(cache->entries[set_index][way]);
+
+		if(entry->used && hmac_digest_eq(&(entry->key), key)) {
+			slot = entry;
+			break;
+		}
+
+		if(slot == NULL || (slot->used && (!entry->used ||
+		                                   entry->inserted_at_ms < slot->inserted_at_ms))) {
+			slot = entry;
+		}
+	}
+
+	clear_authentication_cache_entry(slot);
+
+	*slot = (AuthenticationCacheEntry){
+		.key = *key,
+		.user = { .user = { .username = tstr_dup(&(user.user.username)), .role = user.user.role },
+		          .provider_type = user.provider_type },
+		.generation = generation,
+		.inserted_at_ms = now_ms,
+		.expires_at_ms = now_ms + cache->ttl_ms,
+		.used = true,
+	};
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the authentication cache",
+	    {});
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "./authentication.h"
+#include "./hash.h"
+#include "utils/utils.h"
+
+#include <tstr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a bounded cache of verified credentials, so that authenticated requests don't run bcrypt on every
+// request, only successful results are cached
+// the key is a keyed hash (HMAC with a random key per cache) of the username and the password, so
+// the password is never stored
+// results of the system (pam) provider aren't cached, as a password change or a lock of the account
+// isn't noticed, an entry would stay valid for the whole ttl after that
+
+// entries are valid this long after they were cached, by default
+#define AUTHENTICATION_CACHE_TTL_MS (60 * 1000)
+
+// the cache is set associative, a new entry replaces the oldest one of its set
+#define AUTHENTICATION_CACHE_SET_AMOUNT 64
+
+#define AUTHENTICATION_CACHE_WAYS 4
+
+typedef struct AuthenticationCacheImpl AuthenticationCache;
+
+typedef HmacDigest AuthenticationCacheKey;
+
+NODISCARD AuthenticationCache* initialize_authentication_cache(uint64_t ttl_ms);
+
+void free_authentication_cache(AuthenticationCache* cache);
+
+NODISCARD bool get_authentication_cache_key(const AuthenticationCache* cache, const tstr* username,
+                                            const tstr* password,
+                                            OUT_PARAM(AuthenticationCacheKey) key);
+
+// the generation identifies the state of the account store, entries of other generations are
+// misses, on a hit the user is duplicated into the out param
+NODISCARD bool authentication_cache_get(AuthenticationCache* cache,
+                                        const AuthenticationCacheKey* key, uint64_t generation,
+                                        OUT_PARAM(AuthUserWithContext) user);
+
+// the user is duplicated, the generation has to be taken before the providers were asked, so that
+// results of an account store, that changed in the meantime, are never hits
+void authentication_cache_put(AuthenticationCache* cache, const AuthenticationCacheKey* key,
+                              uint64_t generation, AuthUserWithContext user);
+
+#ifdef __cplusplus
+}
+#endif
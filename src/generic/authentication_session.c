@@ -0,0 +1,376 @@
+#include "./authentication_session.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define AUTHENTICATION_SESSION_HMAC_KEY_SIZE 32
+
+typedef struct {
+	HmacDigest key;
+	AuthUserWithContext user;
+	uint64_t generation;
+	uint64_t expires_at_ms;
+	bool used;
+} AuthenticationSessionEntry;
+
+struct AuthenticationSessionStoreImpl {
+	uint8_t hmac_key[AUTHENTICATION_SESSION_HMAC_KEY_SIZE];
+	uint64_t ttl_ms;
+	pthread_mutex_t mutex;
+	AuthenticationSessionEntry entries[AUTHENTICATION_SESSION_SET_AMOUNT]
+	                                  [AUTHENTICATION_SESSION_WAYS];
+};
+
+NODISCARD AuthenticationSessionStore*
+initialize_authentication_session_store(const uint64_t ttl_ms) {
+
+	AuthenticationSessionStore* store = malloc(sizeof(AuthenticationSessionStore));
+
+	if(!store) {
+		return NULL;
+	}
+
+	int result = pthread_mutex_init(&store->mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result,
+	    "An Error occurred while trying to initialize the mutex for the authentication sessions",
+	    free(store);
+	    return NULL;);
+
+	const GenericResult random_result =
+	    get_random_bytes(AUTHENTICATION_SESSION_HMAC_KEY_SIZE, store->hmac_key);
+
+	IF_GENERIC_RESULT_IS_ERROR_IGN(random_result) {
+		result = pthread_mutex_destroy(&store->mutex);
+		CHECK_FOR_THREAD_ERROR(result,
+		                       "An Error occurred while trying to destroy the mutex in the "
+		                       "authentication sessions",
+		                       {});
+		free(store);
+		return NULL;
+	}
+
+	store->ttl_ms = ttl_ms;
+
+	for(size_t set = 0; set < AUTHENTICATION_SESSION_SET_AMOUNT; ++set) {
+		for(size_t way = 0; way < AUTHENTICATION_SESSION_WAYS; ++way) {
+			store->entries[set][way].used = false;
+		}
+	}
+
+	return store;
+}
+
+// has to be called with the mutex locked, or while no one else uses the store
+static void clear_authentication_session_entry(AuthenticationSessionEntry* const entry) {
+
+	if(!entry->used) {
+		return;
+	}
+
+	tstr_free(&(entry->user.user.username));
+	explicit_bzero(&(entry->key), sizeof(entry->key));
+	entry->used = false;
+}
+
+void free_authentication_session_store(AuthenticationSessionStore* const store) {
+
+	if(store == NULL) {
+		return;
+	}
+
+	for(size_t set = 0; set < AUTHENTICATION_SESSION_SET_AMOUNT; ++set) {
+		for(size_t way = 0; way < AUTHENTICATION_SESSION_WAYS; ++way) {
+			clear_authentication_session_entry(&(store->entries[set][way]));
+		}
+	}
+
+	explicit_bzero(store->hmac_key, sizeof(store->hmac_key));
+
+	int result = pthread_mutex_destroy(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(result,
+	                       "An Error occurred while trying to destroy the mutex in the "
+	                       "authentication sessions",
+	                       {});
+
+	free(store);
+}
+
+NODISCARD static bool get_authentication_session_key(const AuthenticationSessionStore* const store,
+                                                     const tstr_view token,
+                                                     HmacDigest* const key) {
+
+	if(token.len != AUTHENTICATION_SESSION_TOKEN_SIZE * 2) {
+		return false;
+	}
+
+	return get_hmac_digest(
+	    (ReadonlyBuffer){ .data = store->hmac_key, .size = AUTHENTICATION_SESSION_HMAC_KEY_SIZE },
+	    (ReadonlyBuffer){ .data = token.data, .size = token.len }, key);
+}
+
+NODISCARD static tstr get_new_authentication_session_token(void) {
+
+	uint8_t random_bytes[AUTHENTICATION_SESSION_TOKEN_SIZE];
+
+	const GenericResult random_result =
+	    get_random_bytes(AUTHENTICATION_SESSION_TOKEN_SIZE, random_bytes);
+
+	IF_GENERIC_RESULT_IS_ERROR_IGN(random_result) {
+		return tstr_null();
+	}
+
+	char* const token = malloc((AUTHENTICATION_SESSION_TOKEN_SIZE * 2) + 1);
+
+	if(!token) {
+		explicit_bzero(random_bytes, sizeof(random_bytes));
+		return tstr_null();
+	}
+
+	const char* const hex_digits = "0123456789abcdef";
+
+	for(size_t i = 0; i < AUTHENTICATION_SESSION_TOKEN_SIZE; ++i) {
+		// NOLINTBEGIN(readability-magic-numbers)
+		token[i * 2] = hex_digits[random_bytes[i] >> 4];
+		token[(i * 2) + 1] = hex_digits[random_bytes[i] & 0x0F];
+		// NOLINTEND(readability-magic-numbers)
+	}
+
+	token[AUTHENTICATION_SESSION_TOKEN_SIZE * 2] = '\0';
+
+	explicit_bzero(random_bytes, sizeof(random_bytes));
+
+	return tstr_own_cstr(token);
+}
+
+// has to be called with the mutex locked, a session is valid, if it neither expired nor belongs to
+// an old account store
+NODISCARD static bool is_valid_authentication_session_entry(
+    const AuthenticationSessionEntry* const entry, const uint64_t generation,
+    const uint64_t now_ms) {
+	return entry->used && entry->expires_at_ms > now_ms && entry->generation == generation;
+}
+
+// has to be called with the mutex locked, if the user already has the maximum amount of sessions,
+// their session, that expires first, is revoked, so that a user can only replace their own sessions
+static void limit_authentication_sessions_of_user(AuthenticationSessionStore* const store,
+                                                  const AuthUserWithContext* const user,
+                                                  const uint64_t generation,
+                                                  const uint64_t now_ms) {
+
+	size_t session_amount = 0;
+	AuthenticationSessionEntry* oldest_session = NULL;
+
+	// this scans the whole store, but sessions are only created after a password check, which is a
+	// lot slower
+	for(size_t set = 0; set < AUTHENTICATION_SESSION_SET_AMOUNT; ++set) {
+		for(size_t way = 0; way < AUTHENTICATION_SESSION_WAYS; ++way) {
+			AuthenticationSessionEntry* const entry = &(store->entries[set][way]);
+
+			if(!is_valid_authentication_session_entry(entry, generation, now_ms) ||
+			   entry->user.provider_type != user->provider_type ||
+			   !tstr_eq(&(entry->user.user.username), &(user->user.username))) {
+				continue;
+			}
+
+			++session_amount;
+
+			if(oldest_session == NULL || entry->expires_at_ms < oldest_session->expires_at_ms) {
+				oldest_session = entry;
+			}
+		}
+	}
+
+	if(session_amount >= AUTHENTICATION_SESSION_MAX_PER_USER) {
+		LOG_MESSAGE_SIMPLE(LogLevelTrace,
+		                   "A user has too many sessions, replacing their oldest session\n");
+		clear_authentication_session_entry(oldest_session);
+	}
+}
+
+NODISCARD tstr authentication_session_create(AuthenticationSessionStore* const store,
+                                             const uint64_t generation,
+                                             const AuthUserWithContext user,
+                                             bool* const store_full) {
+
+	*store_full = false;
+
+	if(store == NULL) {
+		return tstr_null();
+	}
+
+	tstr token = get_new_authentication_session_token();
+
+	if(tstr_is_null(&token)) {
+		return tstr_null();
+	}
+
+	HmacDigest key = { .data = {}, .size = 0 };
+
+	if(!get_authentication_session_key(store, tstr_as_view(&token), &key)) {
+		tstr_free(&token);
+		return tstr_null();
+	}
+
+	const uint64_t now_ms = get_coarse_monotonic_time_in_ms();
+
+	const size_t set_index = hmac_digest_get_index(&key, AUTHENTICATION_SESSION_SET_AMOUNT);
+
+	int result = pthread_mutex_lock(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the authentication sessions",
+	    tstr_free(&token);
+	    return tstr_null(););
+
+	limit_authentication_sessions_of_user(store, &user, generation, now_ms);
+
+	// a free, expired or invalidated slot is used, valid sessions of other users are never replaced
+	AuthenticationSessionEntry* slot = NULL;
+
+	for(size_t way = 0; way < AUTHENTICATION_SESSION_WAYS; ++way) {
+		AuthenticationSessionEntry* const entry = &(store->entries[set_index][way]);
+
+		if(!is_valid_authentication_session_entry(entry, generation, now_ms)) {
+			slot = entry;
+			break;
+		}
+	}
+
+	if(slot == NULL) {
+		*store_full = true;
+	} else {
+		clear_authentication_session_entry(slot);
+
+		*slot = (AuthenticationSessionEntry){
+			.key = key,
+			.user = { .user = { .username = tstr_dup(&(user.user.username)),
+			                    .role = user.user.role },
+			          .provider_type = user.provider_type },
+			.generation = generation,
+			.expires_at_ms = now_ms + store->ttl_ms,
+			.used = true,
+		};
+	}
+
+	result = pthread_mutex_unlock(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result,
+	    "An Error occurred while trying to unlock the mutex for the authentication sessions", {});
+
+	if(slot == NULL) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn, "The authentication session store is full\n");
+		tstr_free(&token);
+		return tstr_null();
+	}
+
+	return token;
+}
+
+// has to be called with the mutex locked, expired and invalidated entries are evicted lazily
+NODISCARD static AuthenticationSessionEntry*
+find_authentication_session_entry(AuthenticationSessionStore* const store,
+                                  const HmacDigest* const key,
+                                  const uint64_t generation, const uint64_t now_ms) {
+
+	const size_t set_index = hmac_digest_get_index(key, AUTHENTICATION_SESSION_SET_AMOUNT);
+
+	for(size_t way = 0; way < AUTHENTICATION_SESSION_WAYS; ++way) {
+		AuthenticationSessionEntry* const entry = &(store->entries[set_index][way]);
+
+		if(!entry->used) {
+			continue;
+		}
+
+		if(!is_valid_authentication_session_entry(entry, generation, now_ms)) {
+			clear_authentication_session_entry(entry);
+			continue;
+		}
+
+		if(hmac_digest_eq(&(entry->key), key)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+NODISCARD bool authentication_session_find(AuthenticationSessionStore* const store,
+                                           const tstr_view token, const uint64_t generation,
+                                           AuthUserWithContext* const user) {
+
+	if(store == NULL) {
+		return false;
+	}
+
+	HmacDigest key = { .data = {}, .size = 0 };
+
+	if(!get_authentication_session_key(store, token, &key)) {
+		return false;
+	}
+
+	const uint64_t now_ms = get_coarse_monotonic_time_in_ms();
+
+	int result = pthread_mutex_lock(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the authentication sessions",
+	    return false;);
+
+	const AuthenticationSessionEntry* const entry =
+	    find_authentication_session_entry(store, &key, generation, now_ms);
+
+	if(entry != NULL) {
+		*user = (AuthUserWithContext){
+			.user = { .username = tstr_dup(&(entry->user.user.username)),
+			          .role = entry->user.user.role },
+			.provider_type = entry->user.provider_type,
+		};
+	}
+
+	result = pthread_mutex_unlock(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result,
+	    "An Error occurred while trying to unlock the mutex for the authentication sessions", {});
+
+	return entry != NULL;
+}
+
+bool authentication_session_revoke(AuthenticationSessionStore* const store, const tstr_view token) {
+
+	if(store == NULL) {
+		return false;
+	}
+
+	HmacDigest key = { .data = {}, .size = 0 };
+
+	if(!get_authentication_session_key(store, token, &key)) {
+		return false;
+	}
+
+	int result = pthread_mutex_lock(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the authentication sessions",
+	    return false;);
+
+	bool revoked = false;
+
+	const size_t set_index = hmac_digest_get_index(&key, AUTHENTICATION_SESSION_SET_AMOUNT);
+
+	for(size_t way = 0; way < AUTHENTICATION_SESSION_WAYS; ++way) {
+		AuthenticationSessionEntry* const entry = &(store->entries[set_index][way]);
+
+		if(entry->used && hmac_digest_eq(&(entry->key), &key)) {
+			clear_authentication_session_entry(entry);
+			revoked = true;
+			break;
+		}
+	}
+
+	result = pthread_mutex_unlock(&store->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result,
+	    "An Error occurred while trying to unlock the mutex for the authentication sessions", {});
+
+	return revoked;
+}
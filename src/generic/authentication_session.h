@@ -0,0 +1,55 @@
+#pragma once
+
+#include "./authentication.h"
+#include "./hash.h"
+#include "utils/utils.h"
+
+#include <tstr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// an in-memory store of session tokens, a token is issued after a successful password check and
+// authenticates later requests without checking the password again
+// the tokens are opaque random values, only a keyed hash (HMAC with a random key per store) of
+// them is stored, so the store can't be used to forge requests
+
+// sessions expire this long after they were created, by default
+#define AUTHENTICATION_SESSION_TTL_MS (60 * 60 * 1000)
+
+// the store is set associative, if a set is full of valid sessions, no new session can be created
+// in it, so that one user can't log out everyone else
+#define AUTHENTICATION_SESSION_SET_AMOUNT 256
+
+#define AUTHENTICATION_SESSION_WAYS 8
+
+// if a user creates more sessions, their session, that expires first, is replaced
+#define AUTHENTICATION_SESSION_MAX_PER_USER 16
+
+// amount of random bytes in a token, it is sent hex encoded
+#define AUTHENTICATION_SESSION_TOKEN_SIZE 32
+
+typedef struct AuthenticationSessionStoreImpl AuthenticationSessionStore;
+
+NODISCARD AuthenticationSessionStore* initialize_authentication_session_store(uint64_t ttl_ms);
+
+void free_authentication_session_store(AuthenticationSessionStore* store);
+
+// the user is duplicated, the generation identifies the state of the account store, sessions of
+// other generations are invalid, returns a null tstr on errors, store_full is set, if that was the
+// reason
+NODISCARD tstr authentication_session_create(AuthenticationSessionStore* store, uint64_t generation,
+                                             AuthUserWithContext user, OUT_PARAM(bool) store_full);
+
+// on success the user is duplicated into the out param, unknown, expired and revoked tokens fail
+NODISCARD bool authentication_session_find(AuthenticationSessionStore* store, tstr_view token,
+                                           uint64_t generation,
+                                           OUT_PARAM(AuthUserWithContext) user);
+
+// returns true, if the token belonged to a session
+bool authentication_session_revoke(AuthenticationSessionStore* store, tstr_view token);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,478 @@
+#include "./client_limiter.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#define CLIENT_LIMITER_DEFAULT_REQUESTS_PER_SECOND 50
+
+#define CLIENT_LIMITER_DEFAULT_REQUEST_BURST 100
+
+// browsers open up to 6 connections per host, and clients behind a nat share an address, so the
+// default cap doesn't go below that, even with few workers
+#define CLIENT_LIMITER_MIN_DEFAULT_CONNECTIONS 8
+
+// the tokens are counted in thousandths, so that a refill after a few milliseconds isn't lost
+#define CLIENT_LIMITER_TOKEN_SCALE 1000
+
+// ipv4 addresses are stored as ipv4 mapped ipv6 addresses, so both use the same key
+#define CLIENT_LIMITER_KEY_SIZE 16
+
+typedef struct {
+	uint8_t bytes[CLIENT_LIMITER_KEY_SIZE];
+} ClientLimiterKey;
+
+typedef struct {
+	ClientLimiterKey key;
+	uint64_t tokens;
+	uint64_t refilled_at_ms;
+	uint64_t last_used_ms;
+	size_t connections;
+	bool used;
+} ClientLimiterEntry;
+
+typedef struct {
+	pthread_mutex_t mutex;
+	ClientLimiterEntry entries[CLIENT_LIMITER_SET_AMOUNT][CLIENT_LIMITER_WAYS];
+} ClientLimiterShard;
+
+typedef struct {
+	ClientLimiterOptions options;
+	ClientLimiterKey trusted_keys[CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES];
+	size_t trusted_key_amount;
+	// a random seed, so that a client can't choose addresses, that all land in the same set
+	uint64_t seed;
+	ClientLimiterShard* shards;
+	size_t initialized_shards;
+	bool initialized;
+} ClientLimiterState;
+
+static ClientLimiterState
+    g_client_limiter_state; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+NODISCARD ClientLimiterOptions get_default_client_limiter_options(void) {
+	return (ClientLimiterOptions){
+		.requests_per_second = CLIENT_LIMITER_DEFAULT_REQUESTS_PER_SECOND,
+		.request_burst = CLIENT_LIMITER_DEFAULT_REQUEST_BURST,
+		.max_connections = 0,
+		.trusted_addresses = {},
+		.trusted_address_amount = 0,
+	};
+}
+
+NODISCARD static ClientLimiterKey get_client_limiter_key(const IPAddress address) {
+
+	ClientLimiterKey key = { .bytes = {} };
+
+	SWITCH_IP_ADDRESS(address) {
+		CASE_IP_ADDRESS_IS_V4_CONST(address) {
+			// ::ffff:a.b.c.d, the ipv4 address is already in network order
+			// NOLINTBEGIN(readability-magic-numbers)
+			key.bytes[10] = 0xFF;
+			key.bytes[11] = 0xFF;
+			memcpy(key.bytes + 12, &(v4.underlying.s_addr), sizeof(v4.underlying.s_addr));
+			// NOLINTEND(readability-magic-numbers)
+		}
+		break;
+		VARIANT_CASE_END();
+		CASE_IP_ADDRESS_IS_V6_CONST(address) {
+			memcpy(key.bytes, v6.underlying.s6_addr, CLIENT_LIMITER_KEY_SIZE);
+		}
+		break;
+		VARIANT_CASE_END();
+		default: {
+			break;
+		}
+	}
+
+	return key;
+}
+
+static void free_client_limiter_shards(ClientLimiterState* const state) {
+
+	for(size_t i = 0; i < state->initialized_shards; ++i) {
+		int result = pthread_mutex_destroy(&(state->shards[i].mutex));
+		CHECK_FOR_THREAD_ERROR(result,
+		                       "An Error occurred while trying to destroy the mutex in the client "
+		                       "limiter",
+		                       {});
+	}
+
+	free(state->shards);
+	state->shards = NULL;
+	state->initialized_shards = 0;
+}
+
+NODISCARD bool global_initialize_client_limiter(const ClientLimiterOptions options,
+                                                const ThreadPool* const pool) {
+
+	ClientLimiterState* const state = &g_client_limiter_state;
+
+	ClientLimiterOptions resolved_options = options;
+
+	if(resolved_options.max_connections == 0) {
+		resolved_options.max_connections = pool == NULL ? 0 : pool->worker_threads_amount / 2;
+
+		if(resolved_options.max_connections < CLIENT_LIMITER_MIN_DEFAULT_CONNECTIONS) {
+			resolved_options.max_connections = CLIENT_LIMITER_MIN_DEFAULT_CONNECTIONS;
+		}
+	}
+
+	// a bucket has to hold at least one token, otherwise no request would ever pass
+	if(resolved_options.request_burst == 0) {
+		resolved_options.request_burst = 1;
+	}
+
+	state->shards = malloc(sizeof(ClientLimiterShard) * CLIENT_LIMITER_SHARD_AMOUNT);
+
+	if(!state->shards) {
+		return false;
+	}
+
+	state->initialized_shards = 0;
+
+	for(size_t i = 0; i < CLIENT_LIMITER_SHARD_AMOUNT; ++i) {
+		ClientLimiterShard* const shard = &(state->shards[i]);
+
+		int result = pthread_mutex_init(&(shard->mutex), NULL);
+		CHECK_FOR_THREAD_ERROR(
+		    result, "An Error occurred while trying to initialize the mutex for the client limiter",
+		    free_client_limiter_shards(state);
+		    return false;);
+
+		++(state->initialized_shards);
+
+		for(size_t set = 0; set < CLIENT_LIMITER_SET_AMOUNT; ++set) {
+			for(size_t way = 0; way < CLIENT_LIMITER_WAYS; ++way) {
+				shard->entries[set][way].used = false;
+			}
+		}
+	}
+
+	if(resolved_options.trusted_address_amount > CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES) {
+		resolved_options.trusted_address_amount = CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES;
+	}
+
+	for(size_t i = 0; i < resolved_options.trusted_address_amount; ++i) {
+		state->trusted_keys[i] = get_client_limiter_key(resolved_options.trusted_addresses[i]);
+	}
+
+	state->trusted_key_amount = resolved_options.trusted_address_amount;
+
+	state->seed = ((uint64_t)get_random_byte() << 32U) | get_random_byte();
+	state->options = resolved_options;
+	state->initialized = true;
+
+	LOG_MESSAGE(LogLevelInfo,
+	            "Limiting every client to %zu connections and %u requests per second, except "
+	            "loopback clients and %zu trusted addresses\n",
+	            resolved_options.max_connections, resolved_options.requests_per_second,
+	            state->trusted_key_amount);
+
+	return true;
+}
+
+void global_free_client_limiter(void) {
+
+	ClientLimiterState* const state = &g_client_limiter_state;
+
+	if(!state->initialized) {
+		return;
+	}
+
+	state->initialized = false;
+	state->trusted_key_amount = 0;
+
+	free_client_limiter_shards(state);
+}
+
+NODISCARD static bool is_client_limiter_key_loopback(const ClientLimiterKey* const key) {
+
+	// NOLINTBEGIN(readability-magic-numbers)
+	for(size_t i = 0; i < 10; ++i) {
+		if(key->bytes[i] != 0) {
+			return false;
+		}
+	}
+
+	// ::ffff:127.0.0.0/8
+	if(key->bytes[10] == 0xFF && key->bytes[11] == 0xFF) {
+		return key->bytes[12] == 127;
+	}
+
+	// ::1
+	return key->bytes[10] == 0 && key->bytes[11] == 0 && key->bytes[12] == 0 &&
+	       key->bytes[13] == 0 && key->bytes[14] == 0 && key->bytes[15] == 1;
+	// NOLINTEND(readability-magic-numbers)
+}
+
+NODISCARD static bool is_client_limiter_key_exempt(const ClientLimiterState* const state,
+                                                   const ClientLimiterKey* const key) {
+
+	if(is_client_limiter_key_loopback(key)) {
+		return true;
+	}
+
+	for(size_t i = 0; i < state->trusted_key_amount; ++i) {
+		if(memcmp(state->trusted_keys[i].bytes, key->bytes, CLIENT_LIMITER_KEY_SIZE) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+NODISCARD bool client_limiter_is_exempt(const IPAddress address) {
+
+	const ClientLimiterState* const state = &g_client_limiter_state;
+
+	const ClientLimiterKey key = get_client_limiter_key(address);
+
+	return is_client_limiter_key_exempt(state, &key);
+}
+
+NODISCARD static uint64_t get_client_limiter_hash(const ClientLimiterKey* const key,
+                                                  const uint64_t seed) {
+
+	// FNV-1a, seeded and finalized with a multiply-xorshift, so that the low and high bits, that
+	// select the shard and the set, both depend on all bytes
+	// NOLINTBEGIN(readability-magic-numbers)
+	uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+
+	for(size_t i = 0; i < CLIENT_LIMITER_KEY_SIZE; ++i) {
+		hash ^= key->bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	hash ^= hash >> 33U;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33U;
+	// NOLINTEND(readability-magic-numbers)
+
+	return hash;
+}
+
+NODISCARD static ClientLimiterShard* get_client_limiter_shard(ClientLimiterState* const state,
+                                                              const uint64_t hash) {
+	return &(state->shards[hash % CLIENT_LIMITER_SHARD_AMOUNT]);
+}
+
+NODISCARD static size_t get_client_limiter_set_index(const uint64_t hash) {
+	return (size_t)((hash / CLIENT_LIMITER_SHARD_AMOUNT) % CLIENT_LIMITER_SET_AMOUNT);
+}
+
+// has to be called with the mutex of the shard locked, adds the tokens since the last refill
+static void refill_client_limiter_entry(const ClientLimiterOptions* const options,
+                                        ClientLimiterEntry* const entry, const uint64_t now_ms) {
+
+	const uint64_t capacity = (uint64_t)options->request_burst * CLIENT_LIMITER_TOKEN_SCALE;
+
+	if(now_ms > entry->refilled_at_ms) {
+		// with a scale of 1000, requests_per_second scaled tokens are added per millisecond
+		const uint64_t elapsed_ms = now_ms - entry->refilled_at_ms;
+		const uint64_t missing = capacity - entry->tokens;
+		const uint64_t per_ms = options->requests_per_second;
+
+		if(per_ms == 0 || elapsed_ms >= (missing / per_ms) + 1) {
+			entry->tokens = capacity;
+		} else {
+			entry->tokens += elapsed_ms * per_ms;
+		}
+
+		entry->refilled_at_ms = now_ms;
+	}
+
+	if(entry->tokens > capacity) {
+		entry->tokens = capacity;
+	}
+}
+
+// has to be called with the mutex of the shard locked, returns NULL, if the client isn't tracked
+// and can't be tracked, as all entries of its set belong to clients with open connections
+NODISCARD static ClientLimiterEntry*
+get_client_limiter_entry(const ClientLimiterOptions* const options, ClientLimiterShard* const shard,
+                         const size_t set_index, const ClientLimiterKey* const key,
+                         const uint64_t now_ms) {
+
+	// a free slot is used, otherwise the client without connections, that was seen least recently
+	ClientLimiterEntry* slot = NULL;
+
+	for(size_t way = 0; way < CLIENT_LIMITER_WAYS; ++way) {
+		ClientLimiterEntry* const entry = &(shard->entries[set_index][way]);
+
+		if(!entry->used) {
+			if(slot == NULL || slot->used) {
+				slot = entry;
+			}
+			continue;
+		}
+
+		if(memcmp(entry->key.bytes, key->bytes, CLIENT_LIMITER_KEY_SIZE) == 0) {
+			refill_client_limiter_entry(options, entry, now_ms);
+			entry->last_used_ms = now_ms;
+			return entry;
+		}
+
+		if(entry->connections == 0 &&
+		   (slot == NULL || (slot->used && entry->last_used_ms < slot->last_used_ms))) {
+			slot = entry;
+		}
+	}
+
+	if(slot == NULL) {
+		return NULL;
+	}
+
+	*slot = (ClientLimiterEntry){
+		.key = *key,
+		.tokens = (uint64_t)options->request_burst * CLIENT_LIMITER_TOKEN_SCALE,
+		.refilled_at_ms = now_ms,
+		.last_used_ms = now_ms,
+		.connections = 0,
+		.used = true,
+	};
+
+	return slot;
+}
+
+NODISCARD bool client_limiter_acquire_connection(const IPAddress address) {
+
+	ClientLimiterState* const state = &g_client_limiter_state;
+
+	if(!state->initialized) {
+		return true;
+	}
+
+	const ClientLimiterKey key = get_client_limiter_key(address);
+
+	if(is_client_limiter_key_exempt(state, &key)) {
+		return true;
+	}
+
+	const uint64_t hash = get_client_limiter_hash(&key, state->seed);
+	const uint64_t now_ms = get_coarse_monotonic_time_in_ms();
+
+	ClientLimiterShard* const shard = get_client_limiter_shard(state, hash);
+
+	int result = pthread_mutex_lock(&(shard->mutex));
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the client limiter",
+	    return true;);
+
+	bool allowed = true;
+
+	ClientLimiterEntry* const entry = get_client_limiter_entry(
+	    &(state->options), shard, get_client_limiter_set_index(hash), &key, now_ms);
+
+	if(entry != NULL) {
+		if(entry->connections >= state->options.max_connections) {
+			allowed = false;
+		} else {
+			++(entry->connections);
+		}
+	}
+
+	result = pthread_mutex_unlock(&(shard->mutex));
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the client limiter", {});
+
+	return allowed;
+}
+
+void client_limiter_release_connection(const IPAddress address) {
+
+	ClientLimiterState* const state = &g_client_limiter_state;
+
+	if(!state->initialized) {
+		return;
+	}
+
+	const ClientLimiterKey key = get_client_limiter_key(address);
+
+	// exempt clients were never counted
+	if(is_client_limiter_key_exempt(state, &key)) {
+		return;
+	}
+
+	const uint64_t hash = get_client_limiter_hash(&key, state->seed);
+
+	ClientLimiterShard* const shard = get_client_limiter_shard(state, hash);
+
+	const size_t set_index = get_client_limiter_set_index(hash);
+
+	int result = pthread_mutex_lock(&(shard->mutex));
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the client limiter",
+	    return;);
+
+	// untracked connections aren't found, so this only decrements, what was incremented before
+	for(size_t way = 0; way < CLIENT_LIMITER_WAYS; ++way) {
+		ClientLimiterEntry* const entry = &(shard->entries[set_index][way]);
+
+		if(entry->used && memcmp(entry->key.bytes, key.bytes, CLIENT_LIMITER_KEY_SIZE) == 0) {
+			if(entry->connections > 0) {
+				--(entry->connections);
+			}
+			break;
+		}
+	}
+
+	result = pthread_mutex_unlock(&(shard->mutex));
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the client limiter", {});
+}
+
+NODISCARD bool client_limiter_allow_request(const IPAddress address,
+                                            uint32_t* const retry_after_s) {
+
+	ClientLimiterState* const state = &g_client_limiter_state;
+
+	*retry_after_s = 0;
+
+	if(!state->initialized || state->options.requests_per_second == 0) {
+		return true;
+	}
+
+	const ClientLimiterKey key = get_client_limiter_key(address);
+
+	if(is_client_limiter_key_exempt(state, &key)) {
+		return true;
+	}
+
+	const uint64_t hash = get_client_limiter_hash(&key, state->seed);
+	const uint64_t now_ms = get_coarse_monotonic_time_in_ms();
+
+	ClientLimiterShard* const shard = get_client_limiter_shard(state, hash);
+
+	int result = pthread_mutex_lock(&(shard->mutex));
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the client limiter",
+	    return true;);
+
+	bool allowed = true;
+
+	ClientLimiterEntry* const entry = get_client_limiter_entry(
+	    &(state->options), shard, get_client_limiter_set_index(hash), &key, now_ms);
+
+	if(entry != NULL) {
+		if(entry->tokens >= CLIENT_LIMITER_TOKEN_SCALE) {
+			entry->tokens -= CLIENT_LIMITER_TOKEN_SCALE;
+		} else {
+			allowed = false;
+
+			const uint64_t missing = CLIENT_LIMITER_TOKEN_SCALE - entry->tokens;
+			const uint64_t per_ms = state->options.requests_per_second;
+			const uint64_t wait_ms = (missing + per_ms - 1) / per_ms;
+
+			// NOLINTNEXTLINE(readability-magic-numbers)
+			*retry_after_s = (uint32_t)((wait_ms + 999) / 1000);
+		}
+	}
+
+	result = pthread_mutex_unlock(&(shard->mutex));
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the client limiter", {});
+
+	return allowed;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "./ip.h"
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// limits per client ip, so that a single client can't occupy all workers, it caps the concurrent
+// connections (checked at accept time) and the request rate (a token bucket per client)
+// the clients are kept in a sharded, set associative table, every shard has its own mutex, so
+// workers only contend, if their clients land in the same shard
+// the limits are best effort, if a set only holds clients with open connections, a new client
+// isn't tracked and therefore not limited, instead of rejecting it
+// the limiter is opt-in, loopback clients and the trusted addresses are never limited, as behind a
+// reverse proxy or a load balancer all clients share its address
+
+#define CLIENT_LIMITER_SHARD_AMOUNT 64
+
+#define CLIENT_LIMITER_SET_AMOUNT 16
+
+#define CLIENT_LIMITER_WAYS 8
+
+#define CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES 16
+
+typedef struct {
+	// sustained requests per second of one client, 0 disables the request limit
+	uint32_t requests_per_second;
+	// requests, that a client may send at once after being idle
+	uint32_t request_burst;
+	// concurrent connections of one client, 0 means half of the worker threads, but at least 8
+	size_t max_connections;
+	// addresses, that aren't limited, e.g. the reverse proxies in front of the server
+	IPAddress trusted_addresses[CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES];
+	size_t trusted_address_amount;
+} ClientLimiterOptions;
+
+NODISCARD ClientLimiterOptions get_default_client_limiter_options(void);
+
+// the pool is only used to compute the default connection cap, this has to be called before the
+// listener accepts connections, if it isn't called or failed, no client is limited
+NODISCARD bool global_initialize_client_limiter(ClientLimiterOptions options,
+                                                const ThreadPool* pool);
+
+// has to be called after all connections are finished
+void global_free_client_limiter(void);
+
+// loopback clients and trusted addresses are exempt from all limits, the server only listens on
+// tcp, so there are no unix socket clients, that would all share one address
+NODISCARD bool client_limiter_is_exempt(IPAddress address);
+
+// returns false, if the client already has the maximum amount of connections open, otherwise the
+// connection is counted and has to be released with client_limiter_release_connection
+NODISCARD bool client_limiter_acquire_connection(IPAddress address);
+
+void client_limiter_release_connection(IPAddress address);
+
+// takes a token from the bucket of the client, if it is empty, false is returned and retry_after_s
+// is set to the seconds, until the next token is available
+NODISCARD bool client_limiter_allow_request(IPAddress address,
+                                            OUT_PARAM(uint32_t) retry_after_s);
+
+#ifdef __cplusplus
+}
+#endif
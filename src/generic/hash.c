@@ -249,6 +249,112 @@ SizedBuffer get_sha1_from_string(const char* const string) {
 
 #endif
 
+#ifdef _SIMPLE_SERVER_USE_OPENSSL_FOR_HASHING
+
+	#include <openssl/hmac.h>
+
+NODISCARD size_t get_hmac_from_buffer(const ReadonlyBuffer key, const ReadonlyBuffer data,
+                                      uint8_t* const digest) {
+
+	unsigned int digest_size = 0; // NOLINT(totto-use-fixed-width-types-var)
+
+	const uint8_t* const result = HMAC(EVP_sha256(), key.data, (LibCInt)key.size,
+	                                   (const uint8_t*)data.data, data.size, digest, &digest_size);
+
+	if(result == NULL) {
+		return 0;
+	}
+
+	return digest_size;
+}
+
+#else
+
+	#define HMAC_SHA1_BLOCK_SIZE 64
+
+	#define HMAC_INNER_PAD 0x36
+
+	#define HMAC_OUTER_PAD 0x5C
+
+// see https://datatracker.ietf.org/doc/html/rfc2104
+NODISCARD size_t get_hmac_from_buffer(const ReadonlyBuffer key, const ReadonlyBuffer data,
+                                      uint8_t* const digest) {
+
+	uint8_t key_block[HMAC_SHA1_BLOCK_SIZE] = {};
+
+	SHA1_CTX sha_context;
+
+	// longer keys are hashed first
+	if(key.size > HMAC_SHA1_BLOCK_SIZE) {
+		SHA1Init(&sha_context);
+		SHA1Update(&sha_context, (const uint8_t*)key.data, key.size);
+		SHA1Final(key_block, &sha_context);
+	} else {
+		memcpy(key_block, key.data, key.size);
+	}
+
+	uint8_t pad[HMAC_SHA1_BLOCK_SIZE];
+
+	for(size_t i = 0; i < HMAC_SHA1_BLOCK_SIZE; ++i) {
+		pad[i] = key_block[i] ^ HMAC_INNER_PAD;
+	}
+
+	uint8_t inner_digest[SHA1_LEN];
+
+	SHA1Init(&sha_context);
+	SHA1Update(&sha_context, pad, HMAC_SHA1_BLOCK_SIZE);
+	SHA1Update(&sha_context, (const uint8_t*)data.data, data.size);
+	SHA1Final(inner_digest, &sha_context);
+
+	for(size_t i = 0; i < HMAC_SHA1_BLOCK_SIZE; ++i) {
+		pad[i] = key_block[i] ^ HMAC_OUTER_PAD;
+	}
+
+	SHA1Init(&sha_context);
+	SHA1Update(&sha_context, pad, HMAC_SHA1_BLOCK_SIZE);
+	SHA1Update(&sha_context, inner_digest, SHA1_LEN);
+	SHA1Final(digest, &sha_context);
+
+	// the key is secret
+	explicit_bzero(key_block, sizeof(key_block));
+	explicit_bzero(pad, sizeof(pad));
+
+	return SHA1_LEN;
+}
+
+#endif
+
+NODISCARD bool get_hmac_digest(const ReadonlyBuffer key, const ReadonlyBuffer data,
+                               HmacDigest* const digest) {
+
+	digest->size = get_hmac_from_buffer(key, data, digest->data);
+
+	return digest->size != 0;
+}
+
+NODISCARD bool hmac_digest_eq(const HmacDigest* const digest1, const HmacDigest* const digest2) {
+
+	if(digest1->size != digest2->size) {
+		return false;
+	}
+
+	uint8_t difference = 0;
+
+	for(size_t i = 0; i < digest1->size; ++i) {
+		difference |= (uint8_t)(digest1->data[i] ^ digest2->data[i]);
+	}
+
+	return difference == 0;
+}
+
+NODISCARD size_t hmac_digest_get_index(const HmacDigest* const digest, const size_t amount) {
+
+	uint64_t value = 0;
+	memcpy(&value, digest->data, sizeof(uint64_t));
+
+	return (size_t)(value % amount);
+}
+
 #ifdef _SIMPLE_SERVER_USE_OPENSSL_FOR_HASHING
 
 	#include <openssl/bio.h>
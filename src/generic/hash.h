@@ -28,6 +28,29 @@ void free_hash_salted_result(HashSaltResultType* hash_salted_string);
 
 NODISCARD SizedBuffer get_sha1_from_string(const char* string);
 
+// the digest of HMAC-SHA256, the biggest one, that can be returned
+#define HMAC_DIGEST_MAX_SIZE 32
+
+// a keyed hash, HMAC-SHA256 with openssl and HMAC-SHA1 otherwise, the digest needs to have space
+// for HMAC_DIGEST_MAX_SIZE bytes, returns the size of the digest or 0 on error
+NODISCARD size_t get_hmac_from_buffer(ReadonlyBuffer key, ReadonlyBuffer data, uint8_t* digest);
+
+typedef struct {
+	uint8_t data[HMAC_DIGEST_MAX_SIZE];
+	size_t size;
+} HmacDigest;
+
+// same as get_hmac_from_buffer, but returns false on error
+NODISCARD bool get_hmac_digest(ReadonlyBuffer key, ReadonlyBuffer data,
+                               OUT_PARAM(HmacDigest) digest);
+
+// doesn't stop at the first difference, so that the time doesn't leak, how much of a digest matched
+NODISCARD bool hmac_digest_eq(const HmacDigest* digest1, const HmacDigest* digest2);
+
+// an index in [0, amount), the digest is uniformly distributed, so its first bytes are a good
+// enough index for e.g. hash tables
+NODISCARD size_t hmac_digest_get_index(const HmacDigest* digest, size_t amount);
+
 NODISCARD tstr base64_encode_buffer(ReadonlyBuffer input_buffer);
 
 NODISCARD SizedBuffer base64_decode_buffer(ReadonlyBuffer input_buffer);
@@ -9,6 +9,10 @@
 
 #include "all_variants.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
 	struct in_addr underlying; // this is in network order
 } IPV4Address;
@@ -36,3 +40,7 @@ typedef struct {
 NODISCARD IPV4Address get_ipv4_address_from_host_bytes(const uint8_t* bytes);
 
 NODISCARD IPV4RawBytes get_raw_bytes_as_host_bytes_from_ipv4_address(IPV4Address address);
+
+#ifdef __cplusplus
+}
+#endif
@@ -756,6 +756,22 @@ int get_underlying_socket(const ConnectionDescriptor* const descriptor) {
 #endif
 }
 
+NODISCARD bool descriptor_has_pending_data(const ConnectionDescriptor* const descriptor) {
+	if(!is_secure_descriptor(descriptor)) {
+		// everything is in the kernel socket buffer, so poll() sees it
+		return false;
+	}
+
+#ifdef _SIMPLE_SERVER_SECURE_DISABLED
+	UNREACHABLE();
+#else
+
+	const SSL* const ssl_structure = descriptor->data.secure.ssl_structure;
+
+	return SSL_pending(ssl_structure) > 0;
+#endif
+}
+
 NODISCARD ProtocolSelected get_selected_protocol(const ConnectionDescriptor* descriptor) {
 	if(!is_secure_descriptor(descriptor)) {
 		// no way of negotiating a a protocol before starting reading, so always none
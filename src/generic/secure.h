@@ -12,6 +12,10 @@
 
 #include "utils/sized_buffer.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct SecureDataImpl SecureData;
 
 /**
@@ -96,6 +100,10 @@ NODISCARD ssize_t write_to_descriptor(const ConnectionDescriptor* descriptor,
 
 NODISCARD NativeFd get_underlying_socket(const ConnectionDescriptor* descriptor);
 
+// checks if the descriptor has already received data, that isn't visible on the underlying socket
+// anymore, e.g. decrypted tls records buffered in the ssl structure
+NODISCARD bool descriptor_has_pending_data(const ConnectionDescriptor* descriptor);
+
 /**
  * @enum value
  */
@@ -106,3 +114,7 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 } ProtocolSelected;
 
 NODISCARD ProtocolSelected get_selected_protocol(const ConnectionDescriptor* descriptor);
+
+#ifdef __cplusplus
+}
+#endif
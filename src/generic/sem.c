@@ -1,6 +1,7 @@
 
 
 #include "./sem.h"
+#include "utils/clock.h"
 
 // semaphore compatibility
 // see
@@ -26,6 +27,39 @@ LibCInt comp_sem_wait(SemaphoreType* sem) {
 #endif
 }
 
+LibCInt comp_sem_timed_wait(SemaphoreType* sem, uint32_t timeout_ms) {
+
+#ifdef __APPLE__
+	return dispatch_semaphore_wait(
+	    *sem, dispatch_time(DISPATCH_TIME_NOW, S_TO_NS(timeout_ms, int64_t) / S_TO_MS_RATE));
+#else
+	struct timespec deadline = {};
+
+	if(clock_gettime(CLOCK_REALTIME, &deadline) != 0) {
+		return -1;
+	}
+
+	deadline.tv_sec += (time_t)(timeout_ms / S_TO_MS_RATE);
+	deadline.tv_nsec += S_TO_NS(timeout_ms % S_TO_MS_RATE, long) / S_TO_MS_RATE;
+
+	if(deadline.tv_nsec >= S_TO_NS(1, long)) {
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= S_TO_NS(1, long);
+	}
+
+	return sem_timedwait(sem, &deadline);
+#endif
+}
+
+LibCInt comp_sem_try_wait(SemaphoreType* sem) {
+
+#ifdef __APPLE__
+	return dispatch_semaphore_wait(*sem, DISPATCH_TIME_NOW);
+#else
+	return sem_trywait(sem);
+#endif
+}
+
 LibCInt comp_sem_post(SemaphoreType* sem) {
 
 #ifdef __APPLE__
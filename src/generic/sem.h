@@ -23,6 +23,12 @@ NODISCARD LibCInt comp_sem_init(SemaphoreType* sem, uint32_t value, bool shared)
 
 NODISCARD LibCInt comp_sem_wait(SemaphoreType* sem);
 
+// returns 0, if the semaphore was decremented, otherwise the wait timed out or failed
+NODISCARD LibCInt comp_sem_timed_wait(SemaphoreType* sem, uint32_t timeout_ms);
+
+// returns 0, if the semaphore was decremented without waiting
+NODISCARD LibCInt comp_sem_try_wait(SemaphoreType* sem);
+
 NODISCARD LibCInt comp_sem_post(SemaphoreType* sem);
 
 NODISCARD LibCInt comp_sem_destroy(SemaphoreType* sem);
@@ -5,6 +5,14 @@
 
 #include <errno.h>
 
+static MetricsCounter*
+    g_sent_bytes_counter = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    NULL;
+
+void global_set_sent_bytes_counter(MetricsCounter* const counter) {
+	g_sent_bytes_counter = counter;
+}
+
 GenericResult send_data_to_connection(const ConnectionDescriptor* const descriptor,
                                       const void* const to_send, size_t length) {
 
@@ -24,6 +32,8 @@ GenericResult send_data_to_connection(const ConnectionDescriptor* const descript
 			return GENERIC_RES_ERR_RAW(tstr_static_from_static_cstr(strerror(errno)));
 		}
 
+		metrics_counter_add(g_sent_bytes_counter, (uint64_t)wrote_bytes);
+
 		if(wrote_bytes == (ssize_t)remaining_length) {
 			// the message was sent in one time
 			break;
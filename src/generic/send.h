@@ -3,6 +3,7 @@
 #pragma once
 
 #include "secure.h"
+#include "utils/metrics.h"
 #include "utils/string_builder.h"
 
 NODISCARD GenericResult send_data_to_connection(const ConnectionDescriptor* descriptor,
@@ -14,3 +15,7 @@ NODISCARD GenericResult send_buffer_to_connection(const ConnectionDescriptor* de
 // just a wrapper to send a string buffer to a connection, it also frees the string buffer!
 NODISCARD GenericResult send_string_builder_to_connection(const ConnectionDescriptor* descriptor,
                                                           StringBuilder** string_builder);
+
+// every written byte is added to this counter, it can be NULL, this is not synchronized, so it
+// may only be changed, while no other thread sends data
+void global_set_sent_bytes_counter(MetricsCounter* counter);
@@ -0,0 +1,137 @@
+#define _GNU_SOURCE // NOLINT(readability-identifier-naming,bugprone-reserved-identifier,cert-dcl37-c,cert-dcl51-cpp)
+#include <fcntl.h>
+#undef _GNU_SOURCE
+
+#include "./body_spool.h"
+#include "utils/log.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NODISCARD HttpBodySpoolSettings get_default_http_body_spool_settings(void) {
+	return (HttpBodySpoolSettings){
+		.threshold = HTTP_BODY_SPOOL_DEFAULT_THRESHOLD,
+		.directory = HTTP_BODY_SPOOL_DEFAULT_DIRECTORY,
+	};
+}
+
+NODISCARD bool http_body_spool_create(const HttpBodySpoolSettings* const settings,
+                                      OUT_PARAM(HttpBodySpool) spool) {
+
+#ifdef O_TMPFILE
+	// the file has no name, so it is removed automatically, once it is closed
+	const NativeFd tmp_fd =
+	    open(settings->directory, O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+	if(tmp_fd >= 0) {
+		*spool = (HttpBodySpool){ .fd = tmp_fd, .size = 0 };
+		return true;
+	}
+
+	// not every filesystem supports O_TMPFILE, so fall back to an unlinked named file
+	LOG_MESSAGE(LogLevelTrace, "O_TMPFILE in '%s' failed: %s\n", settings->directory,
+	            strerror(errno));
+#endif
+
+	char* file_template = NULL;
+	FORMAT_STRING(&file_template, return false;, "%s/http_body_XXXXXX", settings->directory);
+
+	const NativeFd named_fd = mkstemp(file_template);
+
+	if(named_fd < 0) {
+		LOG_MESSAGE(LogLevelError, "Couldn't create a spool file in '%s': %s\n",
+		            settings->directory, strerror(errno));
+		free(file_template);
+		return false;
+	}
+
+	if(unlink(file_template) != 0) {
+		LOG_MESSAGE(LogLevelWarn, "Couldn't unlink the spool file '%s': %s\n", file_template,
+		            strerror(errno));
+	}
+
+	free(file_template);
+
+	*spool = (HttpBodySpool){ .fd = named_fd, .size = 0 };
+	return true;
+}
+
+NODISCARD bool http_body_spool_append(HttpBodySpool* const spool, const ReadonlyBuffer data) {
+
+	size_t already_written = 0;
+
+	while(already_written < data.size) {
+		const ssize_t wrote_bytes = write(spool->fd, (const uint8_t*)data.data + already_written,
+		                                  data.size - already_written);
+
+		if(wrote_bytes < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+
+			LOG_MESSAGE(LogLevelError, "Couldn't write to the spool file: %s\n", strerror(errno));
+			return false;
+		}
+
+		already_written += (size_t)wrote_bytes;
+	}
+
+	spool->size += data.size;
+
+	return true;
+}
+
+NODISCARD bool http_body_spool_finish(HttpBodySpool* const spool, OUT_PARAM(SizedBuffer) body,
+                                      OUT_PARAM(HttpRequestBodyStorage) storage) {
+
+	if(spool->size == 0) {
+		// mmap doesn't support empty mappings
+		free_http_body_spool(spool);
+		*body = get_empty_sized_buffer();
+		*storage = (HttpRequestBodyStorage){ .type = HttpRequestBodyStorageTypeMemory, .fd = -1 };
+		return true;
+	}
+
+	void* const mapping = mmap(NULL, spool->size, PROT_READ, MAP_PRIVATE, spool->fd, 0);
+
+	if(mapping == MAP_FAILED) {
+		LOG_MESSAGE(LogLevelError, "Couldn't map the spool file: %s\n", strerror(errno));
+		return false;
+	}
+
+	*body = (SizedBuffer){ .data = mapping, .size = spool->size };
+	*storage = (HttpRequestBodyStorage){ .type = HttpRequestBodyStorageTypeFile, .fd = spool->fd };
+
+	// the fd is owned by the storage now
+	*spool = (HttpBodySpool){ .fd = -1, .size = 0 };
+
+	return true;
+}
+
+void free_http_body_spool(HttpBodySpool* const spool) {
+	if(spool->fd >= 0) {
+		close(spool->fd);
+	}
+
+	*spool = (HttpBodySpool){ .fd = -1, .size = 0 };
+}
+
+void free_http_request_body(const SizedBuffer body, const HttpRequestBodyStorage storage) {
+	switch(storage.type) {
+		case HttpRequestBodyStorageTypeFile: {
+			if(body.data != NULL) {
+				munmap(body.data, body.size);
+			}
+
+			close(storage.fd);
+			break;
+		}
+		case HttpRequestBodyStorageTypeMemory:
+		default: {
+			free_sized_buffer(body);
+			break;
+		}
+	}
+}
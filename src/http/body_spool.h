@@ -0,0 +1,46 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "./protocol.h"
+
+#define HTTP_BODY_SPOOL_DEFAULT_THRESHOLD (1 << 20)
+
+#define HTTP_BODY_SPOOL_DEFAULT_DIRECTORY "/tmp"
+
+// spooled bodies are read from the connection in slices of this size
+#define HTTP_BODY_SPOOL_SLICE_SIZE (1 << 16)
+
+typedef struct {
+	// bodies larger than this are written to an anonymous temporary file, 0 disables spooling
+	size_t threshold;
+	const char* directory;
+} HttpBodySpoolSettings;
+
+NODISCARD HttpBodySpoolSettings get_default_http_body_spool_settings(void);
+
+typedef struct {
+	NativeFd fd;
+	size_t size;
+} HttpBodySpool;
+
+NODISCARD bool http_body_spool_create(const HttpBodySpoolSettings* settings,
+                                      OUT_PARAM(HttpBodySpool) spool);
+
+NODISCARD bool http_body_spool_append(HttpBodySpool* spool, ReadonlyBuffer data);
+
+// maps the spooled data read only, the file is moved into the body storage, so that executors can
+// use the mapping or the fd
+NODISCARD bool http_body_spool_finish(HttpBodySpool* spool, OUT_PARAM(SizedBuffer) body,
+                                      OUT_PARAM(HttpRequestBodyStorage) storage);
+
+// only needed, if http_body_spool_finish wasn't called or failed
+void free_http_body_spool(HttpBodySpool* spool);
+
+void free_http_request_body(SizedBuffer body, HttpRequestBodyStorage storage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,238 @@
+#include "./chunked.h"
+
+NODISCARD HttpChunkedSettings get_default_http_chunked_settings(void) {
+	return (HttpChunkedSettings){
+		.max_chunk_size = HTTP_CHUNKED_DEFAULT_MAX_CHUNK_SIZE,
+		.max_body_size = HTTP_CHUNKED_DEFAULT_MAX_BODY_SIZE,
+	};
+}
+
+NODISCARD HttpChunkedDecoder http_chunked_decoder_init(const HttpChunkedSettings settings) {
+	return (HttpChunkedDecoder){
+		.settings = settings,
+		.state = HttpChunkedDecoderStateChunkSize,
+		.remaining_chunk_size = 0,
+		.body_size = 0,
+		.body_too_large = false,
+		.trailers = TVEC_EMPTY(HttpHeaderField),
+	};
+}
+
+NODISCARD static HttpChunkedReadResult http_chunked_decoder_error(HttpChunkedDecoder* const decoder,
+                                                                  const tstr_static error) {
+	decoder->state = HttpChunkedDecoderStateError;
+
+	return (HttpChunkedReadResult){
+		.type = HttpChunkedReadResultTypeError,
+		.value = { .error = error },
+	};
+}
+
+// parses the chunk-size, chunk extensions after a ';' are ignored, only whitespace may be between
+// the size and the ';', see https://datatracker.ietf.org/doc/html/rfc9112#section-7.1.1
+NODISCARD static bool parse_chunk_size(const tstr_view line, OUT_PARAM(size_t) result) {
+
+	size_t value = 0;
+	size_t digits = 0;
+
+	size_t i = 0;
+
+	for(; i < line.len; ++i) {
+		const char current = line.data[i];
+
+		size_t digit = 0;
+
+		if(current >= '0' && current <= '9') {
+			digit = (size_t)(current - '0');
+		} else if(current >= 'a' && current <= 'f') {
+			digit = (size_t)(current - 'a') + 10; // NOLINT(readability-magic-numbers)
+		} else if(current >= 'A' && current <= 'F') {
+			digit = (size_t)(current - 'A') + 10; // NOLINT(readability-magic-numbers)
+		} else if(current == ';' || current == ' ' || current == '\t') {
+			break;
+		} else {
+			return false;
+		}
+
+		// overflow check
+		if(value > (SIZE_MAX >> 4)) {
+			return false;
+		}
+
+		value = (value << 4) | digit;
+		++digits;
+	}
+
+	if(digits == 0) {
+		return false;
+	}
+
+	for(; i < line.len; ++i) {
+		const char current = line.data[i];
+
+		if(current == ';') {
+			break;
+		}
+
+		if(current != ' ' && current != '\t') {
+			return false;
+		}
+	}
+
+	*result = value;
+	return true;
+}
+
+NODISCARD HttpChunkedReadResult http_chunked_decoder_read(HttpChunkedDecoder* const decoder,
+                                                          BufferedReader* const reader) {
+
+	// the slice returned by the last call was consumed by the caller, so it can be discarded
+	buffered_reader_invalidate_old_data(reader);
+
+	while(true) {
+		switch(decoder->state) {
+			case HttpChunkedDecoderStateChunkSize: {
+				const BufferedReadResult read_result = buffered_reader_get_until_delimiter_bounded(
+				    reader, HTTP_LINE_SEPERATORS, HTTP_CHUNKED_MAX_LINE_LENGTH);
+
+				if(read_result.type != BufferedReadResultTypeOk) {
+					return http_chunked_decoder_error(decoder,
+					                                  TSTR_STATIC_LIT("failed to read chunk size"));
+				}
+
+				size_t chunk_size = 0;
+
+				if(!parse_chunk_size(tstr_view_from_readonly_buffer(read_result.value.buffer),
+				                     &chunk_size)) {
+					return http_chunked_decoder_error(decoder,
+					                                  TSTR_STATIC_LIT("invalid chunk size"));
+				}
+
+				if(chunk_size > decoder->settings.max_chunk_size) {
+					return http_chunked_decoder_error(decoder, TSTR_STATIC_LIT("chunk too large"));
+				}
+
+				if(chunk_size > decoder->settings.max_body_size - decoder->body_size) {
+					decoder->body_too_large = true;
+					return http_chunked_decoder_error(decoder,
+					                                  TSTR_STATIC_LIT("chunked body too large"));
+				}
+
+				if(chunk_size == 0) {
+					// the last-chunk, only the trailer section follows
+					decoder->state = HttpChunkedDecoderStateTrailers;
+					break;
+				}
+
+				decoder->remaining_chunk_size = chunk_size;
+				decoder->state = HttpChunkedDecoderStateChunkData;
+				break;
+			}
+			case HttpChunkedDecoderStateChunkData: {
+
+				if(decoder->remaining_chunk_size == 0) {
+					// every chunk-data is terminated by a CRLF, this is read in a separate step, as
+					// reading more data invalidates the previously returned slice
+					const BufferedReadResult read_result =
+					    buffered_reader_get_amount(reader, strlen(HTTP_LINE_SEPERATORS));
+
+					if(read_result.type != BufferedReadResultTypeOk ||
+					   memcmp(read_result.value.buffer.data, HTTP_LINE_SEPERATORS,
+					          strlen(HTTP_LINE_SEPERATORS)) != 0) {
+						return http_chunked_decoder_error(
+						    decoder, TSTR_STATIC_LIT("chunk data not terminated by CRLF"));
+					}
+
+					decoder->state = HttpChunkedDecoderStateChunkSize;
+					break;
+				}
+
+				const size_t slice_size =
+				    decoder->remaining_chunk_size < HTTP_CHUNKED_READ_SLICE_SIZE
+				        ? decoder->remaining_chunk_size
+				        : HTTP_CHUNKED_READ_SLICE_SIZE;
+
+				const BufferedReadResult read_result =
+				    buffered_reader_get_amount(reader, slice_size);
+
+				if(read_result.type != BufferedReadResultTypeOk) {
+					return http_chunked_decoder_error(decoder,
+					                                  TSTR_STATIC_LIT("failed to read chunk data"));
+				}
+
+				decoder->remaining_chunk_size -= slice_size;
+				decoder->body_size += slice_size;
+
+				return (HttpChunkedReadResult){
+					.type = HttpChunkedReadResultTypeData,
+					.value = { .data = read_result.value.buffer },
+				};
+			}
+			case HttpChunkedDecoderStateTrailers: {
+				const BufferedReadResult read_result = buffered_reader_get_until_delimiter_bounded(
+				    reader, HTTP_LINE_SEPERATORS, HTTP_CHUNKED_MAX_LINE_LENGTH);
+
+				if(read_result.type != BufferedReadResultTypeOk) {
+					return http_chunked_decoder_error(
+					    decoder, TSTR_STATIC_LIT("failed to read trailer section"));
+				}
+
+				const tstr_view trailer_line =
+				    tstr_view_from_readonly_buffer(read_result.value.buffer);
+
+				if(trailer_line.len == 0) {
+					decoder->state = HttpChunkedDecoderStateFinished;
+					break;
+				}
+
+				if(TVEC_LENGTH(HttpHeaderField, decoder->trailers) >=
+				   HTTP_CHUNKED_MAX_TRAILER_FIELDS) {
+					return http_chunked_decoder_error(decoder,
+					                                  TSTR_STATIC_LIT("too many trailer fields"));
+				}
+
+				const tstr_split_result split_result = tstr_split(trailer_line, ":");
+
+				if(!split_result.ok) {
+					return http_chunked_decoder_error(decoder,
+					                                  TSTR_STATIC_LIT("invalid trailer field"));
+				}
+
+				// the field is copied, as the line is only valid until the next read
+				HttpHeaderField field = {
+					.key = tstr_from_view(split_result.first),
+					.value = tstr_from_view(tstr_view_lstrip(split_result.second)),
+				};
+
+				auto _ = TVEC_PUSH(HttpHeaderField, &(decoder->trailers), field);
+				UNUSED(_);
+				break;
+			}
+			case HttpChunkedDecoderStateFinished: {
+				return (HttpChunkedReadResult){
+					.type = HttpChunkedReadResultTypeEnd,
+					.value = { .data = (ReadonlyBuffer){ .data = NULL, .size = 0 } },
+				};
+			}
+			case HttpChunkedDecoderStateError:
+			default: {
+				return (HttpChunkedReadResult){
+					.type = HttpChunkedReadResultTypeError,
+					.value = { .error = TSTR_STATIC_LIT("chunked decoder is in an error state") },
+				};
+			}
+		}
+	}
+}
+
+NODISCARD HttpHeaderFields http_chunked_decoder_release_trailers(HttpChunkedDecoder* const decoder) {
+	const HttpHeaderFields trailers = decoder->trailers;
+
+	decoder->trailers = TVEC_EMPTY(HttpHeaderField);
+
+	return trailers;
+}
+
+void free_http_chunked_decoder(HttpChunkedDecoder* const decoder) {
+	free_http_header_fields(&(decoder->trailers));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "./protocol.h"
+#include "utils/buffered_reader.h"
+
+#define HTTP_CHUNKED_DEFAULT_MAX_CHUNK_SIZE (1 << 20)
+
+#define HTTP_CHUNKED_DEFAULT_MAX_BODY_SIZE (1 << 26)
+
+#define HTTP_CHUNKED_MAX_TRAILER_FIELDS 64
+
+// chunk-size lines (including the ignored extensions) and trailer lines can't be longer than this
+#define HTTP_CHUNKED_MAX_LINE_LENGTH (1 << 13)
+
+// the data of a single chunk is returned in slices of at most this size
+#define HTTP_CHUNKED_READ_SLICE_SIZE (1 << 14)
+
+typedef struct {
+	size_t max_chunk_size;
+	size_t max_body_size;
+} HttpChunkedSettings;
+
+NODISCARD HttpChunkedSettings get_default_http_chunked_settings(void);
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HttpChunkedDecoderStateChunkSize = 0,
+	HttpChunkedDecoderStateChunkData,
+	HttpChunkedDecoderStateTrailers,
+	HttpChunkedDecoderStateFinished,
+	HttpChunkedDecoderStateError,
+} HttpChunkedDecoderState;
+
+// streaming decoder for the chunked transfer coding, see
+// https://datatracker.ietf.org/doc/html/rfc9112#section-7.1
+typedef struct {
+	HttpChunkedSettings settings;
+	HttpChunkedDecoderState state;
+	size_t remaining_chunk_size;
+	size_t body_size;
+	// set together with the error, if the body exceeds max_body_size, so that it can be answered
+	// with a 413 instead of a 400
+	bool body_too_large;
+	HttpHeaderFields trailers;
+} HttpChunkedDecoder;
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HttpChunkedReadResultTypeData = 0,
+	HttpChunkedReadResultTypeEnd,
+	HttpChunkedReadResultTypeError,
+} HttpChunkedReadResultType;
+
+typedef struct {
+	HttpChunkedReadResultType type;
+	union {
+		ReadonlyBuffer data;
+		tstr_static error;
+	} value;
+} HttpChunkedReadResult;
+
+NODISCARD HttpChunkedDecoder http_chunked_decoder_init(HttpChunkedSettings settings);
+
+/**
+ * @brief Reads the next slice of the decoded body, the returned data is only valid until the next
+ * call, as already consumed data of the reader gets discarded, so that the whole body never has
+ * to be in memory at once. After HttpChunkedReadResultTypeEnd the trailer fields are available.
+ *
+ * @param decoder
+ * @param reader
+ * @return HttpChunkedReadResult
+ */
+NODISCARD HttpChunkedReadResult http_chunked_decoder_read(HttpChunkedDecoder* decoder,
+                                                          BufferedReader* reader);
+
+// moves the trailer fields out of the decoder, the caller has to free them
+NODISCARD HttpHeaderFields http_chunked_decoder_release_trailers(HttpChunkedDecoder* decoder);
+
+void free_http_chunked_decoder(HttpChunkedDecoder* decoder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,104 +1,234 @@
 
 #include "./common_log.h"
+#include "utils/log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the entries are fixed size, so that collecting them doesn't allocate and the ring owns no memory
+typedef struct {
+	IPAddress host;
+	Time time;
+	HTTPRequestMethod method;
+	HTTPProtocolVersion protocol_version;
+	HttpStatusCode result;
+	size_t body_size;
+	char uri[LOG_ENTRY_URI_MAX_SIZE];
+	// these are already escaped, as they are written in quotes
+	char referer[LOG_ENTRY_HEADER_VALUE_MAX_SIZE];
+	char user_agent[LOG_ENTRY_HEADER_VALUE_MAX_SIZE];
+} LogEntry;
+
+// a single producer single consumer ring, the producer is the thread, that owns it, the consumer is
+// the drainer thread
+typedef struct {
+	// only written by the consumer
+	atomic_size_t head;
+	// only written by the producer
+	atomic_size_t tail;
+	atomic_size_t dropped;
+	LogEntry entries[LOG_COLLECTOR_RING_SIZE];
+} LogEntryRing;
+
+TVEC_DEFINE_AND_IMPLEMENT_VEC_TYPE_EXTENDED(LogEntryRing*, LogEntryRingPtr)
+
+struct LogCollectorImpl {
+	// unique per collector, so that the thread local rings of a freed collector are not reused
+	uint64_t id;
+	LogCollectorOptions options;
+	// only locked, when a thread collects its first entry and by the drainer
+	pthread_mutex_t rings_mutex;
+	TVEC_TYPENAME(LogEntryRingPtr) rings;
+	pthread_t drainer;
+	// protects everything below, workers never lock it
+	pthread_mutex_t mutex;
+	pthread_cond_t wakeup;
+	bool should_stop;
+	bool flush_requested;
+	// a ring of formatted lines, the oldest is at recent_next, if the ring is full
+	char* recent[LOG_COLLECTOR_RECENT_ENTRIES];
+	size_t recent_next;
+	size_t recent_count;
+	// only used by the drainer
+	int file_fd;
+	size_t file_size;
+	uint64_t file_opened_at_s;
+	size_t reported_dropped;
+};
+
+static atomic_uint_fast64_t
+    g_log_collector_next_id = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    1;
+
+static atomic_bool
+    g_log_collector_reopen_requested = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    false;
+
+typedef struct {
+	uint64_t collector_id;
+	LogEntryRing* ring;
+} LogCollectorThreadState;
+
+static _Thread_local LogCollectorThreadState
+    g_log_collector_thread_state = { // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+	    .collector_id = 0,
+	    .ring = NULL,
+    };
+
+void log_collector_request_reopen(void) {
+	atomic_store_explicit(&g_log_collector_reopen_requested, true, memory_order_relaxed);
+}
 
-TVEC_IMPLEMENT_VEC_TYPE(LogEntry)
+NODISCARD static uint64_t get_log_collector_now_s(void) {
+	Time now;
 
-LogCollector* initialize_log_collector(void) {
+	if(!get_coarse_monotonic_time(&now)) {
+		return 0;
+	}
 
-	LogCollector* collector = malloc(sizeof(LogCollector));
+	return get_time_in_seconds(now);
+}
 
-	if(collector == NULL) {
-		return NULL;
+static void open_log_collector_file(LogCollector* const collector) {
+
+	if(collector->options.file_path == NULL) {
+		return;
 	}
 
-	*collector = (LogCollector){
-		.entries = TVEC_EMPTY(LogEntry),
-	};
+	collector->file_fd = open(collector->options.file_path,
+	                          O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+	                          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
-	return collector;
-}
+	if(collector->file_fd < 0) {
+		LOG_MESSAGE(LogLevelError, "Couldn't open the access log file '%s': %s\n",
+		            collector->options.file_path, strerror(errno));
+		return;
+	}
 
-static void free_log_entry(LogEntry entry) {
-	free(entry.ident);
-	free(entry.user);
-	free_parsed_request_uri(entry.request.uri);
+	struct stat file_stat = {};
+
+	collector->file_size = fstat(collector->file_fd, &file_stat) == 0 ? (size_t)file_stat.st_size
+	                                                                  : 0;
+	collector->file_opened_at_s = get_log_collector_now_s();
 }
 
-void free_log_collector(LogCollector* collector) {
+static void close_log_collector_file(LogCollector* const collector) {
 
-	for(size_t i = 0; i < TVEC_LENGTH(LogEntry, collector->entries); ++i) {
-		LogEntry entry = TVEC_AT(LogEntry, collector->entries, i);
-		free_log_entry(entry);
+	if(collector->file_fd < 0) {
+		return;
 	}
 
-	TVEC_FREE(LogEntry, &collector->entries);
-
-	free(collector);
+	close(collector->file_fd);
+	collector->file_fd = -1;
 }
 
-void log_collector_collect(LogCollector* collector, IPAddress address, HttpRequest http_request,
-                           HTTPResponseToSend response) {
+// the current file is moved to "<file_path>.<unix seconds>" and a new one is started, if that
+// already exists, as the file was rotated in the same second before, ".<counter>" is appended
+static void rotate_log_collector_file(LogCollector* const collector) {
 
-	Time now;
+	close_log_collector_file(collector);
 
-	bool success = get_current_time(&now);
+	Time now;
 
-	if(!success) {
+	if(!get_coarse_current_time(&now)) {
 		now = empty_time();
 	}
 
-	LogEntry entry = {
-		.host = address,
-		.ident = NULL,
-		.user = NULL,
-		.time = now,
-		.request =
-		    (HttpRequestLine){
-		        .method = http_request.head.request_line.method,
-		        .uri = duplicate_request_uri(http_request.head.request_line.uri),
-		        .protocol_data = http_request.head.request_line.protocol_data,
-		    },
-
-		.result = response.status,
-		.body_size = response.body.content.size,
-	};
+	const unsigned long now_s = (unsigned long)get_time_in_seconds(now);
+
+	char* rotated_path = NULL;
+	FORMAT_STRING(&rotated_path, { return; }, "%s.%lu", collector->options.file_path, now_s);
+
+	// the drainer is the only one, that rotates, so the name can't be taken in between
+	for(size_t counter = 1; access(rotated_path, F_OK) == 0; ++counter) {
+		FORMAT_STRING(&rotated_path, { return; }, "%s.%lu.%zu", collector->options.file_path,
+		              now_s, counter);
+	}
 
-	auto _ = TVEC_PUSH(LogEntry, &collector->entries, entry);
-	UNUSED(_);
+	if(rename(collector->options.file_path, rotated_path) != 0) {
+		LOG_MESSAGE(LogLevelError, "Couldn't rotate the access log file '%s': %s\n",
+		            collector->options.file_path, strerror(errno));
+	}
+
+	free(rotated_path);
+
+	open_log_collector_file(collector);
 }
 
-NODISCARD static bool log_entry_to_string(StringBuilder* const builder, const LogEntry entry) {
+static void rotate_log_collector_file_if_needed(LogCollector* const collector) {
+
+	if(collector->file_fd < 0) {
+		return;
+	}
 
-	char* ip_str = ipv_to_string(entry.host);
+	const LogCollectorOptions options = collector->options;
 
-	if(ip_str == NULL) {
-		return false;
+	const bool too_big = options.rotate_size != 0 && collector->file_size >= options.rotate_size;
+
+	const bool too_old =
+	    options.rotate_interval_s != 0 &&
+	    get_log_collector_now_s() - collector->file_opened_at_s >= options.rotate_interval_s;
+
+	if(too_big || too_old) {
+		rotate_log_collector_file(collector);
 	}
+}
 
-	STRING_BUILDER_APPENDF(builder, return false;, "%s ", ip_str);
-	free(ip_str);
+static void write_to_log_collector_file(LogCollector* const collector, const SizedBuffer batch) {
 
-	if(entry.ident != NULL) {
-		STRING_BUILDER_APPENDF(builder, return false;, "%s ", entry.ident);
-	} else {
-		string_builder_append_single(builder, "- ");
+	if(collector->file_fd < 0 || batch.size == 0) {
+		return;
 	}
 
-	if(entry.user != NULL) {
-		STRING_BUILDER_APPENDF(builder, return false;, "%s ", entry.user);
-	} else {
-		string_builder_append_single(builder, "- ");
+	size_t written = 0;
+
+	while(written < batch.size) {
+		const ssize_t result =
+		    write(collector->file_fd, ((const uint8_t*)batch.data) + written, batch.size - written);
+
+		if(result < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+
+			LOG_MESSAGE(LogLevelError, "Couldn't write to the access log file '%s': %s\n",
+			            collector->options.file_path, strerror(errno));
+			break;
+		}
+
+		written += (size_t)result;
 	}
 
-	if(get_time_in_nano_seconds(entry.time) != 0) {
-		char* time_str = get_date_string(entry.time, TimeFormatCommonLog);
+	collector->file_size += written;
+}
+
+NODISCARD static bool log_entry_to_string(StringBuilder* const builder, const LogEntry* const entry,
+                                          const AccessLogFormat format) {
+
+	char* ip_str = ipv_to_string(entry->host);
 
-		if(!time_str) {
+	if(ip_str == NULL) {
+		return false;
+	}
+
+	// ident and user are not supported
+	STRING_BUILDER_APPENDF(builder, return false;, "%s - - ", ip_str);
+	free(ip_str);
+
+	if(get_time_in_nano_seconds(entry->time) != 0) {
+		char time_str[64]; // NOLINT(readability-magic-numbers)
+
+		if(format_date_string(entry->time, TimeFormatCommonLog, time_str, sizeof(time_str)) ==
+		   0) {
 			return false;
 		}
 
 		STRING_BUILDER_APPENDF(builder, return false;, "[%s] ", time_str);
-		free(time_str);
 
 	} else {
 		string_builder_append_single(builder, "- ");
@@ -106,49 +236,609 @@ NODISCARD static bool log_entry_to_string(StringBuilder* const builder, const Lo
 
 	{ // request line
 
-		const char* method_str = get_http_method_string(entry.request.method);
-
-		tstr uri_str = get_request_uri_as_string(entry.request.uri);
+		const char* method_str = get_http_method_string(entry->method);
 
-		const char* protocol_str =
-		    get_http_protocol_version_string(entry.request.protocol_data.version);
+		const char* protocol_str = get_http_protocol_version_string(entry->protocol_version);
 
-		if(method_str == NULL ||
-		   tstr_is_null(&uri_str) || // NOLINT(readability-implicit-bool-conversion)
-		   protocol_str == NULL) {
-			tstr_free(&uri_str);
+		if(method_str == NULL || protocol_str == NULL) {
 			return false;
 		}
 
 		STRING_BUILDER_APPENDF(builder, return false;
-		                       , "\"%s %s %s\" ", method_str, tstr_cstr(&uri_str), protocol_str);
+		                       , "\"%s %s %s\" ", method_str, entry->uri, protocol_str);
 	}
 
-	if(entry.result != 0) {
-		STRING_BUILDER_APPENDF(builder, return false;, "%d ", entry.result);
+	if(entry->result != 0) {
+		STRING_BUILDER_APPENDF(builder, return false;, "%d ", entry->result);
 	} else {
 		string_builder_append_single(builder, "- ");
 	}
 
-	STRING_BUILDER_APPENDF(builder, return false;, "%zu", entry.body_size);
+	STRING_BUILDER_APPENDF(builder, return false;, "%zu", entry->body_size);
+
+	if(format == AccessLogFormatCombined) {
+		STRING_BUILDER_APPENDF(builder, return false;
+		                       , " \"%s\" \"%s\"", entry->referer, entry->user_agent);
+	}
 
 	return true;
 }
 
-NODISCARD StringBuilder* log_collector_to_string_builder(const LogCollector* const collector) {
+static void add_recent_log_line(LogCollector* const collector, char* const line) {
 
-	StringBuilder* string_builder = string_builder_init();
+	int result = pthread_mutex_lock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the log collector", {
+		    free(line);
+		    return;
+	    });
+
+	free(collector->recent[collector->recent_next]);
+	collector->recent[collector->recent_next] = line;
+
+	collector->recent_next = (collector->recent_next + 1) % LOG_COLLECTOR_RECENT_ENTRIES;
+
+	if(collector->recent_count < LOG_COLLECTOR_RECENT_ENTRIES) {
+		collector->recent_count++;
+	}
+
+	result = pthread_mutex_unlock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the log collector", {});
+}
+
+static void drain_log_entry_ring(LogCollector* const collector, LogEntryRing* const ring,
+                                 StringBuilder* const batch) {
+
+	const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	const size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	for(size_t i = head; i != tail; ++i) {
+		const LogEntry* entry = &(ring->entries[i % LOG_COLLECTOR_RING_SIZE]);
+
+		StringBuilder* line_builder = string_builder_init();
+
+		if(!log_entry_to_string(line_builder, entry, collector->options.format)) {
+			free_string_builder(line_builder);
+			continue;
+		}
+
+		char* line = string_builder_release_into_string(&line_builder);
+
+		if(line == NULL) {
+			continue;
+		}
+
+		string_builder_append_single(batch, line);
+		string_builder_append_single(batch, "\n");
+
+		// the line is owned by the recent entries now
+		add_recent_log_line(collector, line);
+	}
+
+	// the slots can be reused by the producer now
+	atomic_store_explicit(&ring->head, tail, memory_order_release);
+}
+
+static void drain_log_collector(LogCollector* const collector) {
+
+	if(atomic_exchange_explicit(&g_log_collector_reopen_requested, false, memory_order_relaxed)) {
+		close_log_collector_file(collector);
+		open_log_collector_file(collector);
+	}
+
+	StringBuilder* batch = string_builder_init();
+
+	size_t dropped = 0;
+
+	int result = pthread_mutex_lock(&collector->rings_mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the rings mutex for the log collector", {
+		    free_string_builder(batch);
+		    return;
+	    });
+
+	for(size_t i = 0; i < TVEC_LENGTH(LogEntryRingPtr, collector->rings); ++i) {
+		LogEntryRing* ring = TVEC_AT(LogEntryRingPtr, collector->rings, i);
+
+		drain_log_entry_ring(collector, ring, batch);
+
+		dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+	}
+
+	result = pthread_mutex_unlock(&collector->rings_mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the rings mutex for the log collector",
+	    {});
+
+	if(dropped != collector->reported_dropped) {
+		LOG_MESSAGE(LogLevelWarn, "The access log dropped %zu entries, as it was full\n",
+		            dropped - collector->reported_dropped);
+		collector->reported_dropped = dropped;
+	}
+
+	// the whole batch is written with as few syscalls as possible
+	SizedBuffer batch_buffer = string_builder_release_into_sized_buffer(&batch);
+
+	write_to_log_collector_file(collector, batch_buffer);
+
+	free_sized_buffer(batch_buffer);
+
+	rotate_log_collector_file_if_needed(collector);
+}
+
+// waits for the next drain, returns false, if the drainer should stop
+NODISCARD static bool finish_log_collector_drain(LogCollector* const collector) {
+
+	int result = pthread_mutex_lock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the log collector",
+	    return false;);
+
+	const bool should_stop = collector->should_stop;
+
+	if(!should_stop && !collector->flush_requested) {
+		struct timespec deadline = {};
+		clock_gettime(CLOCK_REALTIME, &deadline);
+
+		deadline.tv_nsec += S_TO_NS(LOG_COLLECTOR_DRAIN_INTERVAL_MS, long) / S_TO_MS_RATE;
+
+		if(deadline.tv_nsec >= S_TO_NS(1, long)) {
+			deadline.tv_sec += 1;
+			deadline.tv_nsec -= S_TO_NS(1, long);
+		}
+
+		// a timeout is the normal case, so the result is ignored
+		pthread_cond_timedwait(&collector->wakeup, &collector->mutex, &deadline);
+	}
+
+	collector->flush_requested = false;
+
+	result = pthread_mutex_unlock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the log collector",
+	    return false;);
+
+	return !should_stop;
+}
+
+static ANY_TYPE(void) log_collector_drainer_function(ANY_TYPE(LogCollector*) arg) {
+
+	set_thread_name("access log thread");
+
+	LogCollector* collector = (LogCollector*)arg;
+
+	// the last drain happens after should_stop was set, so no collected entry is lost
+	do {
+		drain_log_collector(collector);
+	} while(finish_log_collector_drain(collector));
+
+	unset_thread_name();
+
+	return NULL;
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	LogCollectorSyncStateNone = 0,
+	LogCollectorSyncStateRingsMutex,
+	LogCollectorSyncStateMutex,
+	LogCollectorSyncStateWakeup,
+} LogCollectorSyncState;
+
+// destroys the mutexes and conditions in reverse order, up to the last one, that was initialized
+static void destroy_log_collector_sync(LogCollector* const collector,
+                                       const LogCollectorSyncState initialized) {
+
+	if(initialized >= LogCollectorSyncStateWakeup) {
+		pthread_cond_destroy(&collector->wakeup);
+	}
+
+	if(initialized >= LogCollectorSyncStateMutex) {
+		pthread_mutex_destroy(&collector->mutex);
+	}
+
+	if(initialized >= LogCollectorSyncStateRingsMutex) {
+		pthread_mutex_destroy(&collector->rings_mutex);
+	}
+}
+
+NODISCARD LogCollector* initialize_log_collector(const LogCollectorOptions options) {
+
+	LogCollector* collector = malloc(sizeof(LogCollector));
+
+	if(collector == NULL) {
+		return NULL;
+	}
+
+	*collector = (LogCollector){
+		.id = atomic_fetch_add_explicit(&g_log_collector_next_id, 1, memory_order_relaxed),
+		.options = options,
+		.rings = TVEC_EMPTY(LogEntryRingPtr),
+		.should_stop = false,
+		.flush_requested = false,
+		.recent = {},
+		.recent_next = 0,
+		.recent_count = 0,
+		.file_fd = -1,
+		.file_size = 0,
+		.file_opened_at_s = 0,
+		.reported_dropped = 0,
+	};
+
+	int result = pthread_mutex_init(&collector->rings_mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the mutex for the log collector",
+	    free(collector);
+	    return NULL;);
+
+	result = pthread_mutex_init(&collector->mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the mutex for the log collector", {
+		    destroy_log_collector_sync(collector, LogCollectorSyncStateRingsMutex);
+		    free(collector);
+		    return NULL;
+	    });
+
+	result = pthread_cond_init(&collector->wakeup, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the condition for the log collector",
+	    {
+		    destroy_log_collector_sync(collector, LogCollectorSyncStateMutex);
+		    free(collector);
+		    return NULL;
+	    });
+
+	open_log_collector_file(collector);
+
+	result = pthread_create(&collector->drainer, NULL, log_collector_drainer_function, collector);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to create a new Thread", {
+		close_log_collector_file(collector);
+		destroy_log_collector_sync(collector, LogCollectorSyncStateWakeup);
+		free(collector);
+		return NULL;
+	});
+
+	return collector;
+}
+
+void free_log_collector(LogCollector* collector) {
+
+	int result = pthread_mutex_lock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the log collector", {});
+
+	// the drainer drains everything, that is left, before it stops
+	collector->should_stop = true;
+
+	result = pthread_cond_signal(&collector->wakeup);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to signal the condition for the log collector",
+	    {});
+
+	result = pthread_mutex_unlock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the log collector", {});
+
+	result = pthread_join(collector->drainer, NULL);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to wait for a Thread", {});
+
+	close_log_collector_file(collector);
+
+	for(size_t i = 0; i < TVEC_LENGTH(LogEntryRingPtr, collector->rings); ++i) {
+		LogEntryRing* ring = TVEC_AT(LogEntryRingPtr, collector->rings, i);
+		free(ring);
+	}
+
+	TVEC_FREE(LogEntryRingPtr, &collector->rings);
+
+	for(size_t i = 0; i < LOG_COLLECTOR_RECENT_ENTRIES; ++i) {
+		free(collector->recent[i]);
+	}
+
+	destroy_log_collector_sync(collector, LogCollectorSyncStateWakeup);
+
+	free(collector);
+}
+
+// the ring is registered once per thread, so only the first entry of a thread locks a mutex
+NODISCARD static LogEntryRing* get_log_collector_thread_ring(LogCollector* const collector) {
+
+	if(g_log_collector_thread_state.collector_id == collector->id) {
+		return g_log_collector_thread_state.ring;
+	}
+
+	LogEntryRing* ring = malloc(sizeof(LogEntryRing));
+
+	if(ring == NULL) {
+		return NULL;
+	}
+
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->dropped, 0);
+
+	int result = pthread_mutex_lock(&collector->rings_mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the rings mutex for the log collector", {
+		    free(ring);
+		    return NULL;
+	    });
+
+	const TvecResult push_res = TVEC_PUSH(LogEntryRingPtr, &collector->rings, ring);
+
+	result = pthread_mutex_unlock(&collector->rings_mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the rings mutex for the log collector",
+	    {});
+
+	if(push_res != TvecResultOk) { // NOLINT(readability-implicit-bool-conversion)
+		free(ring);
+		return NULL;
+	}
+
+	g_log_collector_thread_state = (LogCollectorThreadState){
+		.collector_id = collector->id,
+		.ring = ring,
+	};
+
+	return ring;
+}
+
+// truncates the value and escapes it, so that it can be written in quotes
+// a value of an entry, that is built in place from several parts
+typedef struct {
+	char* data;
+	size_t size;
+	size_t written;
+	bool truncated;
+} LogEntryValueBuilder;
+
+NODISCARD static LogEntryValueBuilder init_log_entry_value(char* const destination,
+                                                           const size_t destination_size) {
+	destination[0] = '\0';
+
+	return (LogEntryValueBuilder){
+		.data = destination,
+		.size = destination_size,
+		.written = 0,
+		.truncated = false,
+	};
+}
+
+// escapes the part, if it doesn't fit, it is truncated and later parts are ignored
+static void append_log_entry_value(LogEntryValueBuilder* const builder, const char* const value,
+                                   const size_t value_len) {
+
+	for(size_t i = 0; i < value_len && !builder->truncated; ++i) {
+		const unsigned char current = (unsigned char)value[i];
+
+		const bool needs_escape = current == '"' || current == '\\';
+		// NOLINTNEXTLINE(readability-magic-numbers)
+		const bool printable = current >= ' ' && current < 0x7F;
+
+		const size_t needed = needs_escape ? 2 : 1;
+
+		if(builder->written + needed >= builder->size) {
+			builder->truncated = true;
+			break;
+		}
+
+		if(needs_escape) {
+			builder->data[builder->written++] = '\\';
+		}
+
+		builder->data[builder->written++] = printable ? (char)current : '?';
+	}
+
+	builder->data[builder->written] = '\0';
+}
+
+static void append_log_entry_value_tstr(LogEntryValueBuilder* const builder,
+                                        const tstr* const value) {
+	append_log_entry_value(builder, tstr_cstr(value), tstr_len(value));
+}
+
+static void copy_log_entry_value(char* const destination, const size_t destination_size,
+                                 const char* const value, const size_t value_len) {
+
+	LogEntryValueBuilder builder = init_log_entry_value(destination, destination_size);
+
+	append_log_entry_value(&builder, value, value_len);
+}
+
+// the same as get_parsed_authority_as_string, but a password is never logged
+static void append_log_entry_authority(LogEntryValueBuilder* const builder,
+                                       const ParsedAuthority* const authority) {
+
+	if(!tstr_is_null(&(authority->user_info.username))) {
+		append_log_entry_value_tstr(builder, &(authority->user_info.username));
+		append_log_entry_value(builder, "@", 1);
+	}
+
+	append_log_entry_value_tstr(builder, &(authority->host));
 
-	for(size_t i = 0; i < TVEC_LENGTH(LogEntry, collector->entries); ++i) {
-		LogEntry entry = TVEC_AT(LogEntry, collector->entries, i);
+	if(authority->port != 0) {
+		char port_str[8]; // NOLINT(readability-magic-numbers)
+		const int length = snprintf(port_str, sizeof(port_str), ":%u", authority->port);
 
-		if(!log_entry_to_string(string_builder, entry)) {
-			free_string_builder(string_builder);
-			return NULL;
+		if(length > 0) {
+			append_log_entry_value(builder, port_str, (size_t)length);
 		}
+	}
+}
+
+// the same as get_parsed_url_as_string
+static void append_log_entry_url_path(LogEntryValueBuilder* const builder, ParsedURLPath path) {
+
+	append_log_entry_value_tstr(builder, &path.path);
+
+	if(TMAP_IS_EMPTY(ParsedSearchPathHashMap, &path.search_path.hash_map)) {
+		return;
+	}
+
+	append_log_entry_value(builder, "?", 1);
+
+	TMAP_TYPENAME_ITER(ParsedSearchPathHashMap)
+	iter = TMAP_ITER_INIT(ParsedSearchPathHashMap, &path.search_path.hash_map);
+
+	TMAP_TYPENAME_ENTRY(ParsedSearchPathHashMap) entry;
+
+	bool first = true;
+
+	while(TMAP_ITER_NEXT(ParsedSearchPathHashMap, &iter, &entry)) {
+
+		if(!first) {
+			append_log_entry_value(builder, "&", 1);
+		}
+
+		first = false;
+
+		append_log_entry_value_tstr(builder, &entry.key);
+
+		if(tstr_len(&entry.value.val) != 0) {
+			append_log_entry_value(builder, "=", 1);
+			append_log_entry_value_tstr(builder, &entry.value.val);
+		}
+	}
+}
+
+// writes the uri like get_request_uri_as_string, but directly into the entry, so that collecting
+// doesn't allocate
+static void copy_log_entry_request_uri(char* const destination, const size_t destination_size,
+                                       const ParsedRequestURI* const uri) {
 
+	LogEntryValueBuilder builder = init_log_entry_value(destination, destination_size);
+
+	switch(uri->type) {
+		case ParsedURITypeAsterisk: {
+			append_log_entry_value(&builder, "*", 1);
+			break;
+		}
+		case ParsedURITypeAbsoluteURI: {
+			append_log_entry_value_tstr(&builder, &(uri->data.uri.scheme));
+			append_log_entry_value(&builder, "://", 3);
+
+			if(!tstr_is_null(&(uri->data.uri.authority.host))) {
+				append_log_entry_authority(&builder, &(uri->data.uri.authority));
+			}
+
+			append_log_entry_url_path(&builder, uri->data.uri.path);
+			break;
+		}
+		case ParsedURITypeAbsPath: {
+			append_log_entry_url_path(&builder, uri->data.path);
+			break;
+		}
+		case ParsedURITypeAuthority: {
+			append_log_entry_authority(&builder, &(uri->data.authority));
+			break;
+		}
+		default: {
+			append_log_entry_value(&builder, "-", 1);
+			break;
+		}
+	}
+}
+
+static void copy_log_entry_header_value(char* const destination, const size_t destination_size,
+                                        const HttpRequest http_request,
+                                        const HttpHeaderToken token) {
+
+	const HttpHeaderField* header = find_request_header(&(http_request.head), token);
+
+	if(header == NULL) {
+		copy_log_entry_value(destination, destination_size, "-", 1);
+		return;
+	}
+
+	copy_log_entry_value(destination, destination_size, tstr_cstr(&(header->value)),
+	                     tstr_len(&(header->value)));
+}
+
+void log_collector_collect(LogCollector* collector, IPAddress address, HttpRequest http_request,
+                           HTTPResponseToSend response) {
+
+	LogEntryRing* ring = get_log_collector_thread_ring(collector);
+
+	if(ring == NULL) {
+		return;
+	}
+
+	const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	const size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	if(tail - head >= LOG_COLLECTOR_RING_SIZE) {
+		atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	LogEntry* entry = &(ring->entries[tail % LOG_COLLECTOR_RING_SIZE]);
+
+	Time now;
+
+	// a log entry only needs a resolution of seconds
+	bool success = get_coarse_current_time(&now);
+
+	if(!success) {
+		now = empty_time();
+	}
+
+	entry->host = address;
+	entry->time = now;
+	entry->method = http_request.head.request_line.method;
+	entry->protocol_version = http_request.head.request_line.protocol_data.version;
+	entry->result = response.status;
+	entry->body_size = response.body.content.size;
+
+	copy_log_entry_request_uri(entry->uri, LOG_ENTRY_URI_MAX_SIZE,
+	                           &(http_request.head.request_line.uri));
+
+	if(collector->options.format == AccessLogFormatCombined) {
+		copy_log_entry_header_value(entry->referer, LOG_ENTRY_HEADER_VALUE_MAX_SIZE, http_request,
+		                            HttpHeaderTokenReferer);
+		copy_log_entry_header_value(entry->user_agent, LOG_ENTRY_HEADER_VALUE_MAX_SIZE,
+		                            http_request, HttpHeaderTokenUserAgent);
+	}
+
+	// publishes the entry to the drainer
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+NODISCARD StringBuilder* log_collector_to_string_builder(LogCollector* const collector) {
+
+	int result = pthread_mutex_lock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the log collector",
+	    return NULL;);
+
+	// the entries, that aren't drained yet, are drained soon, but this doesn't wait for that, so
+	// the connection worker is only blocked for copying the snapshot
+	collector->flush_requested = true;
+
+	result = pthread_cond_signal(&collector->wakeup);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to signal the condition for the log collector",
+	    {});
+
+	StringBuilder* string_builder = string_builder_init();
+
+	const size_t first = (collector->recent_next + LOG_COLLECTOR_RECENT_ENTRIES -
+	                      collector->recent_count) %
+	                     LOG_COLLECTOR_RECENT_ENTRIES;
+
+	for(size_t i = 0; i < collector->recent_count; ++i) {
+		const char* line = collector->recent[(first + i) % LOG_COLLECTOR_RECENT_ENTRIES];
+
+		string_builder_append_single(string_builder, line);
 		string_builder_append_single(string_builder, "\n");
 	}
 
+	result = pthread_mutex_unlock(&collector->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the log collector", {});
+
 	return string_builder;
 }
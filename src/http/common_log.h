@@ -1,34 +1,66 @@
-
-
 #pragma once
 
 #include "generic/ip.h"
 #include "http/send.h"
 #include "utils/clock.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	AccessLogFormatCommon = 0,
+	// the common log format plus the referer and the user agent
+	AccessLogFormatCombined,
+} AccessLogFormat;
+
 typedef struct {
-	IPAddress host;
-	char* ident;
-	char* user;
-	Time time;
-	HttpRequestLine request;
-	HttpStatusCode result;
-	size_t body_size;
-} LogEntry;
+	// NULL, if the entries should only be kept in memory
+	const char* file_path;
+	AccessLogFormat format;
+	// the file gets rotated, if it is bigger than this, 0 disables it
+	size_t rotate_size;
+	// the file gets rotated, after it was written to for this long, 0 disables it
+	uint64_t rotate_interval_s;
+} LogCollectorOptions;
 
-TVEC_DEFINE_VEC_TYPE(LogEntry)
+// every thread, that collects entries, has its own ring of this size, entries are dropped, if the
+// drainer can't keep up
+#define LOG_COLLECTOR_RING_SIZE 256
 
-typedef TVEC_TYPENAME(LogEntry) LogEntries;
+// the amount of formatted entries, that are kept in memory for log_collector_to_string_builder
+#define LOG_COLLECTOR_RECENT_ENTRIES 1024
 
-typedef struct {
-	LogEntries entries;
-} LogCollector;
+#define LOG_COLLECTOR_DRAIN_INTERVAL_MS 50
 
-LogCollector* initialize_log_collector(void);
+// longer values get truncated, so that collecting doesn't allocate
+#define LOG_ENTRY_URI_MAX_SIZE 256
+
+#define LOG_ENTRY_HEADER_VALUE_MAX_SIZE 128
+
+typedef struct LogCollectorImpl LogCollector;
+
+NODISCARD LogCollector* initialize_log_collector(LogCollectorOptions options);
 
 void free_log_collector(LogCollector* collector);
 
+// this never blocks, it only copies the entry into the ring of the calling thread, the background
+// thread formats and writes it
 void log_collector_collect(LogCollector* collector, IPAddress address, HttpRequest http_request,
                            HTTPResponseToSend response);
 
-NODISCARD StringBuilder* log_collector_to_string_builder(const LogCollector* collector);
+// returns a snapshot of the recent lines, that are already drained, so entries, that were collected
+// just before, may be missing, the drainer is woken up, so that they are drained soon, this never
+// waits for the drainer
+NODISCARD StringBuilder* log_collector_to_string_builder(LogCollector* collector);
+
+// async signal safe, the log file gets reopened on the next drain, so that it can be moved by
+// external tools
+void log_collector_request_reopen(void);
+
+#ifdef __cplusplus
+}
+#endif
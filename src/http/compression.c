@@ -88,12 +88,16 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 NODISCARD static SizedBuffer
 compress_buffer_with_zlib_impl(SizedBuffer buffer,
                                ZlibMode mode, // NOLINT(bugprone-easily-swappable-parameters)
-                               size_t max_window_bits, int flush_mode) {
+                               size_t max_window_bits, int flush_mode, int level) {
 
 	if(max_window_bits < Z_MIN_WINDOW_BITS || max_window_bits > Z_MAX_WINDOW_BITS) {
 		return get_empty_sized_buffer();
 	}
 
+	if(level != Z_DEFAULT_COMPRESSION && (level < Z_BEST_SPEED || level > Z_BEST_COMPRESSION)) {
+		return get_empty_sized_buffer();
+	}
+
 	int window_bits = (int)max_window_bits;
 
 	switch(mode) {
@@ -134,7 +138,7 @@ compress_buffer_with_zlib_impl(SizedBuffer buffer,
 	zstream.avail_out = chunk_size;
 	zstream.next_out = (Bytef*)result_buffer.data;
 
-	int result = deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits,
+	int result = deflateInit2(&zstream, level, Z_DEFLATED, window_bits,
 	                          Z_MEMORY_USAGE_LEVEL, Z_DEFAULT_STRATEGY);
 
 	if(result != Z_OK) {
@@ -201,19 +205,21 @@ compress_buffer_with_zlib_impl(SizedBuffer buffer,
 
 	#define Z_DEFAULT_WINDOW_SIZE 15 // 8-15
 
-NODISCARD static SizedBuffer compress_buffer_with_zlib_compat(SizedBuffer buffer, bool gzip) {
+NODISCARD static SizedBuffer compress_buffer_with_zlib_compat(SizedBuffer buffer, bool gzip,
+                                                              int level) {
 
 	return compress_buffer_with_zlib_impl(
 	    buffer,
 	    gzip ? ZlibModeGzip : ZlibModeDeflate, // NOLINT(readability-implicit-bool-conversion)
-	    Z_DEFAULT_WINDOW_SIZE, Z_FINISH);
+	    Z_DEFAULT_WINDOW_SIZE, Z_FINISH,
+	    level == COMPRESSION_LEVEL_DEFAULT ? Z_DEFAULT_COMPRESSION : level);
 }
 
 	#define WS_FLUSH_MODE Z_SYNC_FLUSH
 
 NODISCARD SizedBuffer compress_buffer_with_zlib_for_ws(SizedBuffer buffer, size_t max_window_bits) {
 	return compress_buffer_with_zlib_impl(buffer, ZlibModeDeflateRaw, max_window_bits,
-	                                      WS_FLUSH_MODE);
+	                                      WS_FLUSH_MODE, Z_DEFAULT_COMPRESSION);
 }
 
 // see https://zlib.net/manual.html
@@ -338,14 +344,14 @@ NODISCARD SizedBuffer decompress_buffer_with_zlib_for_ws(SizedBuffer buffer,
 #endif
 
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_GZIP
-static SizedBuffer compress_buffer_with_gzip(SizedBuffer buffer) {
-	return compress_buffer_with_zlib_compat(buffer, true);
+static SizedBuffer compress_buffer_with_gzip(SizedBuffer buffer, int level) {
+	return compress_buffer_with_zlib_compat(buffer, true, level);
 }
 #endif
 
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_DEFLATE
-static SizedBuffer compress_buffer_with_deflate(SizedBuffer buffer) {
-	return compress_buffer_with_zlib_compat(buffer, false);
+static SizedBuffer compress_buffer_with_deflate(SizedBuffer buffer, int level) {
+	return compress_buffer_with_zlib_compat(buffer, false, level);
 }
 #endif
 
@@ -354,7 +360,13 @@ static SizedBuffer compress_buffer_with_deflate(SizedBuffer buffer) {
 	#define BROTLI_QUALITY 11     // 0-11
 	#define BROTLI_WINDOW_SIZE 15 // 10-24
 
-static SizedBuffer compress_buffer_with_br(SizedBuffer buffer) {
+static SizedBuffer compress_buffer_with_br(SizedBuffer buffer, int level) {
+
+	const int quality = level == COMPRESSION_LEVEL_DEFAULT ? BROTLI_QUALITY : level;
+
+	if(quality < BROTLI_MIN_QUALITY || quality > BROTLI_MAX_QUALITY) {
+		return SIZED_BUFFER_ERROR;
+	}
 
 	BrotliEncoderState* state = BrotliEncoderCreateInstance(NULL, NULL, NULL);
 
@@ -366,10 +378,11 @@ static SizedBuffer compress_buffer_with_br(SizedBuffer buffer) {
 		return SIZED_BUFFER_ERROR;
 	}
 
-	if(!BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, BROTLI_QUALITY)) {
+	if(!BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, (uint32_t)quality)) {
 		LOG_MESSAGE_SIMPLE(LogLevelError, "An error in brotli compression initialization occurred: "
 		                                  "failed to set parameter quality\n");
 
+		BrotliEncoderDestroyInstance(state);
 		return SIZED_BUFFER_ERROR;
 	};
 
@@ -445,7 +458,14 @@ static SizedBuffer compress_buffer_with_br(SizedBuffer buffer) {
 
 	#define ZSTD_CHUNK_SIZE 15 // not a windows size, just the chunk size
 
-static SizedBuffer compress_buffer_with_zstd(SizedBuffer buffer) {
+static SizedBuffer compress_buffer_with_zstd(SizedBuffer buffer, int level) {
+
+	const int compression_level =
+	    level == COMPRESSION_LEVEL_DEFAULT ? ZSTD_COMPRESSION_LEVEL : level;
+
+	if(compression_level < 1 || compression_level > ZSTD_maxCLevel()) {
+		return SIZED_BUFFER_ERROR;
+	}
 
 	ZSTD_CStream* stream = ZSTD_createCStream();
 
@@ -457,7 +477,7 @@ static SizedBuffer compress_buffer_with_zstd(SizedBuffer buffer) {
 		return SIZED_BUFFER_ERROR;
 	}
 
-	const size_t init_result = ZSTD_initCStream(stream, ZSTD_COMPRESSION_LEVEL);
+	const size_t init_result = ZSTD_initCStream(stream, compression_level);
 	if(ZSTD_isError(init_result)) {
 		LOG_MESSAGE(LogLevelError, "An error in zstd compression initialization occurred: %s\n",
 		            ZSTD_getErrorName(init_result));
@@ -654,40 +674,47 @@ NODISCARD tstr get_string_for_compress_format(CompressionType format) {
 }
 
 NODISCARD SizedBuffer compress_buffer_with(SizedBuffer buffer, CompressionType format) {
+	return compress_buffer_with_level(buffer, format, COMPRESSION_LEVEL_DEFAULT);
+}
+
+NODISCARD SizedBuffer compress_buffer_with_level(SizedBuffer buffer, CompressionType format,
+                                                 int level) {
 
 	switch(format) {
 		case CompressionTypeNone: return SIZED_BUFFER_ERROR; ;
 		case CompressionTypeGzip: {
 
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_GZIP
-			return compress_buffer_with_gzip(buffer);
+			return compress_buffer_with_gzip(buffer, level);
 #else
 			return SIZED_BUFFER_ERROR;
 #endif
 		};
 		case CompressionTypeDeflate: {
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_DEFLATE
-			return compress_buffer_with_deflate(buffer);
+			return compress_buffer_with_deflate(buffer, level);
 #else
 			return SIZED_BUFFER_ERROR;
 #endif
 		};
 		case CompressionTypeBr: {
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_BR
-			return compress_buffer_with_br(buffer);
+			return compress_buffer_with_br(buffer, level);
 #else
 			return SIZED_BUFFER_ERROR;
 #endif
 		};
 		case CompressionTypeZstd: {
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_ZSTD
-			return compress_buffer_with_zstd(buffer);
+			return compress_buffer_with_zstd(buffer, level);
 #else
 			return SIZED_BUFFER_ERROR;
 #endif
 		};
 		case CompressionTypeCompress: {
 #ifdef _SIMPLE_SERVER_COMPRESSION_SUPPORT_COMPRESS
+			// lzw has no notion of a compression level
+			UNUSED(level);
 			return compress_buffer_with_compress(buffer);
 #else
 			return SIZED_BUFFER_ERROR;
@@ -695,6 +722,7 @@ NODISCARD SizedBuffer compress_buffer_with(SizedBuffer buffer, CompressionType f
 		};
 		default: {
 			UNUSED(buffer);
+			UNUSED(level);
 			return SIZED_BUFFER_ERROR;
 		}
 	}
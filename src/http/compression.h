@@ -37,8 +37,15 @@ NODISCARD SizedBuffer compress_buffer_with_zlib_for_ws(SizedBuffer buffer, size_
 
 #endif
 
+// uses the built-in default level of the given format
+#define COMPRESSION_LEVEL_DEFAULT (-1)
+
 NODISCARD SizedBuffer compress_buffer_with(SizedBuffer buffer, CompressionType format);
 
+// the level is format specific: gzip and deflate 1-9, br 0-11, zstd 1-22, compress has no levels
+NODISCARD SizedBuffer compress_buffer_with_level(SizedBuffer buffer, CompressionType format,
+                                                 int level);
+
 #ifdef __cplusplus
 }
 #endif
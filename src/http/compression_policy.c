@@ -0,0 +1,123 @@
+#include "./compression_policy.h"
+#include "./mime.h"
+
+#define COMPRESSION_POLICY_DEFAULT_MIN_BODY_SIZE 256
+
+#define COMPRESSION_POLICY_DEFAULT_SATURATION_PERCENTAGE 75
+
+#define COMPRESSION_POLICY_DEFAULT_OFFLOAD_MIN_BODY_SIZE (1024 * 1024)
+
+NODISCARD CompressionPolicy get_default_compression_policy(void) {
+	return (CompressionPolicy){
+		.min_body_size = COMPRESSION_POLICY_DEFAULT_MIN_BODY_SIZE,
+		// NOLINTBEGIN(readability-magic-numbers)
+		.levels = { .gzip = 6, .deflate = 6, .br = 5, .zstd = 3 },
+		.saturated_levels = { .gzip = 1, .deflate = 1, .br = 1, .zstd = 1 },
+		// gzip and deflate stay cheap on all levels, br and zstd get expensive on the high ones
+		.offload_levels = { .gzip = COMPRESSION_LEVEL_DEFAULT,
+		                    .deflate = COMPRESSION_LEVEL_DEFAULT,
+		                    .br = 9,
+		                    .zstd = 15 },
+		// NOLINTEND(readability-magic-numbers)
+		.saturation_percentage = COMPRESSION_POLICY_DEFAULT_SATURATION_PERCENTAGE,
+		.offload_min_body_size = COMPRESSION_POLICY_DEFAULT_OFFLOAD_MIN_BODY_SIZE,
+	};
+}
+
+typedef struct {
+	CompressionPolicy policy;
+	const ThreadPool* pool;
+} CompressionPolicyState;
+
+static CompressionPolicyState
+    g_compression_policy_state = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    {
+	    .policy = { .min_body_size = COMPRESSION_POLICY_DEFAULT_MIN_BODY_SIZE,
+	                .levels = { .gzip = COMPRESSION_LEVEL_DEFAULT,
+	                            .deflate = COMPRESSION_LEVEL_DEFAULT,
+	                            .br = COMPRESSION_LEVEL_DEFAULT,
+	                            .zstd = COMPRESSION_LEVEL_DEFAULT },
+	                .saturated_levels = { .gzip = COMPRESSION_LEVEL_DEFAULT,
+	                                      .deflate = COMPRESSION_LEVEL_DEFAULT,
+	                                      .br = COMPRESSION_LEVEL_DEFAULT,
+	                                      .zstd = COMPRESSION_LEVEL_DEFAULT },
+	                .saturation_percentage = COMPRESSION_POLICY_DEFAULT_SATURATION_PERCENTAGE,
+	                .offload_min_body_size = COMPRESSION_POLICY_DEFAULT_OFFLOAD_MIN_BODY_SIZE,
+	                .offload_levels = { .gzip = COMPRESSION_LEVEL_DEFAULT,
+	                                    .deflate = COMPRESSION_LEVEL_DEFAULT,
+	                                    .br = COMPRESSION_LEVEL_DEFAULT,
+	                                    .zstd = COMPRESSION_LEVEL_DEFAULT } },
+	    .pool = NULL,
+    };
+
+void global_initialize_compression_policy(const CompressionPolicy policy,
+                                          const ThreadPool* const pool) {
+	g_compression_policy_state.policy = policy;
+	g_compression_policy_state.pool = pool;
+}
+
+void global_free_compression_policy(void) {
+	g_compression_policy_state.pool = NULL;
+}
+
+NODISCARD static bool compression_policy_is_pool_saturated(const CompressionPolicyState* state) {
+
+	if(state->pool == NULL || state->pool->worker_threads_amount == 0) {
+		return false;
+	}
+
+	const size_t busy_workers = pool_get_busy_workers(state->pool);
+
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	return (busy_workers * 100) >=
+	       (state->pool->worker_threads_amount * state->policy.saturation_percentage);
+}
+
+NODISCARD static int get_level_for_format(const CompressionLevels levels,
+                                          const CompressionType format) {
+	switch(format) {
+		case CompressionTypeGzip: return levels.gzip;
+		case CompressionTypeDeflate: return levels.deflate;
+		case CompressionTypeBr: return levels.br;
+		case CompressionTypeZstd: return levels.zstd;
+		case CompressionTypeNone:
+		case CompressionTypeCompress:
+		default: return COMPRESSION_LEVEL_DEFAULT;
+	}
+}
+
+NODISCARD CompressionDecision compression_policy_decide(const CompressionType negotiated_format,
+                                                        const tstr mime_type,
+                                                        const size_t body_size) {
+
+	const CompressionDecision no_compression = { .format = CompressionTypeNone,
+		                                         .level = COMPRESSION_LEVEL_DEFAULT,
+		                                         .offload = false };
+
+	if(negotiated_format == CompressionTypeNone) {
+		return no_compression;
+	}
+
+	const CompressionPolicyState* const state = &g_compression_policy_state;
+
+	if(body_size < state->policy.min_body_size) {
+		return no_compression;
+	}
+
+	if(!is_mime_type_compressible(mime_type)) {
+		return no_compression;
+	}
+
+	const CompressionLevels levels = compression_policy_is_pool_saturated(state)
+	                                     ? state->policy.saturated_levels
+	                                     : state->policy.levels;
+
+	const int level = get_level_for_format(levels, negotiated_format);
+
+	const int offload_level = get_level_for_format(state->policy.offload_levels, negotiated_format);
+
+	const bool offload = body_size >= state->policy.offload_min_body_size ||
+	                     (offload_level != COMPRESSION_LEVEL_DEFAULT && level >= offload_level);
+
+	return (CompressionDecision){ .format = negotiated_format, .level = level, .offload = offload };
+}
@@ -0,0 +1,61 @@
+
+#pragma once
+
+#include "./compression.h"
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
+
+#include <tstr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the policy that decides, if and how strongly a response body gets compressed, the negotiated
+// format from get_send_settings is only an upper bound, as compressing tiny or already compressed
+// bodies wastes cpu time and often makes them bigger
+
+typedef struct {
+	int gzip;
+	int deflate;
+	int br;
+	int zstd;
+} CompressionLevels;
+
+typedef struct {
+	// bodies smaller than this are always sent uncompressed
+	size_t min_body_size;
+	// levels used in normal operation
+	CompressionLevels levels;
+	// levels used, when the worker pool is saturated
+	CompressionLevels saturated_levels;
+	// percentage (0-100) of busy workers, from which on the pool counts as saturated
+	uint8_t saturation_percentage;
+	// bodies of at least this size are compressed on the offload pool
+	size_t offload_min_body_size;
+	// levels, from which on a body of any size is compressed on the offload pool,
+	// COMPRESSION_LEVEL_DEFAULT means, that the level alone never offloads
+	CompressionLevels offload_levels;
+} CompressionPolicy;
+
+typedef struct {
+	CompressionType format;
+	int level;
+	// the compression is expensive enough, to be run on the offload pool
+	bool offload;
+} CompressionDecision;
+
+NODISCARD CompressionPolicy get_default_compression_policy(void);
+
+// the pool is used to estimate the current load, it may be NULL, then the pool never counts as
+// saturated, this has to be called before any worker uses the policy
+void global_initialize_compression_policy(CompressionPolicy policy, const ThreadPool* pool);
+
+void global_free_compression_policy(void);
+
+NODISCARD CompressionDecision compression_policy_decide(CompressionType negotiated_format,
+                                                        tstr mime_type, size_t body_size);
+
+#ifdef __cplusplus
+}
+#endif
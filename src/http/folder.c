@@ -3,6 +3,7 @@
 
 #include "./debug.h"
 #include "utils/clock.h"
+#include "utils/offload_pool.h"
 #include "utils/path.h"
 
 #include <cwalk.h>
@@ -105,6 +106,22 @@ static char* get_final_file_path(HTTPRouteServeFolder data, const char* const ro
 	return result_path;
 }
 
+// files of at least this size are read on the offload pool
+#define SERVE_FOLDER_OFFLOAD_MIN_FILE_SIZE (1024 * 1024)
+
+typedef struct {
+	const char* path;
+	size_t file_size;
+	void* file_data;
+} FileReadJob;
+
+static void file_read_job_function(ANY_TYPE(FileReadJob*) arg) {
+
+	FileReadJob* const job = (FileReadJob*)arg;
+
+	job->file_data = read_entire_file(job->path, &(job->file_size));
+}
+
 static ServeFolderResult get_serve_folder_content_for_file(const tstr* const path,
                                                            const bool send_body) {
 
@@ -177,7 +194,25 @@ static ServeFolderResult get_serve_folder_content_for_file(const tstr* const pat
 
 		file_content = (SizedBuffer){ .data = NULL, .size = file_size };
 	} else {
-		void* file_data = read_entire_file(tstr_cstr(path), &file_size);
+		FileReadJob job = { .path = tstr_cstr(path), .file_size = 0, .file_data = NULL };
+
+		size_t expected_file_size = 0;
+
+		bool has_read = false;
+
+		// big files are read on the offload pool, if that is full, they are read here, as the
+		// request can't be answered otherwise
+		if(get_file_size_of_file(job.path, &expected_file_size) &&
+		   expected_file_size >= SERVE_FOLDER_OFFLOAD_MIN_FILE_SIZE) {
+			has_read = offload_run(file_read_job_function, &job) == OffloadResultOk;
+		}
+
+		if(!has_read) {
+			file_read_job_function(&job);
+		}
+
+		void* file_data = job.file_data;
+		file_size = job.file_size;
 
 		if(file_data == NULL) {
 
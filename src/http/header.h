@@ -49,6 +49,14 @@ HTTP_HEADER_MAKE(http2_settings, "http2-settings");
 
 HTTP_HEADER_MAKE(alt_svc, "alt-svc");
 
+HTTP_HEADER_MAKE(keep_alive, "keep-alive");
+
+HTTP_HEADER_MAKE(retry_after, "retry-after");
+
+HTTP_HEADER_MAKE(set_cookie, "set-cookie");
+
+HTTP_HEADER_MAKE(cache_control, "cache-control");
+
 // ws specific stuff
 
 HTTP_HEADER_MAKE(ws_sec_websocket_key, "sec-websocket-key");
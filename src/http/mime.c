@@ -2,6 +2,8 @@
 
 #include "./mime.h"
 
+#include <strings.h>
+
 // NOLINTBEGIN(bugprone-easily-swappable-parameters)
 TMAP_IMPLEMENT_MAP_TYPE(tstr_view, TStringView, tstr, MimeTypeEntryHashMap)
 // NOLINTEND(bugprone-easily-swappable-parameters)
@@ -136,3 +138,88 @@ NODISCARD NODISCARD tstr get_mime_type_for_ext(const tstr_view ext) {
 
 	return *result;
 }
+
+// mime types that benefit from compression, everything else (images, audio, video, archives,
+// fonts like woff2) is either already compressed or not worth the cpu time
+static const char* const g_compressible_mime_types[] = {
+	"application/json",     "application/javascript", "application/x-javascript",
+	"application/xml",      "application/xhtml+xml",  "application/rss+xml",
+	"application/atom+xml", "application/ld+json",    "application/manifest+json",
+	"application/wasm",     "image/svg+xml",          "image/x-icon",
+	"font/ttf",             "font/otf",
+};
+
+#define COMPRESSIBLE_MIME_TYPES_SIZE \
+	(sizeof(g_compressible_mime_types) / sizeof(*g_compressible_mime_types))
+
+NODISCARD static bool mime_view_eq_ignore_case(const tstr_view view, const char* const value) {
+	const size_t value_len = strlen(value);
+
+	if(view.len != value_len) {
+		return false;
+	}
+
+	return strncasecmp(view.data, value, value_len) == 0;
+}
+
+NODISCARD static bool mime_view_starts_with_ignore_case(const tstr_view view,
+                                                        const char* const prefix) {
+	const size_t prefix_len = strlen(prefix);
+
+	if(view.len < prefix_len) {
+		return false;
+	}
+
+	return strncasecmp(view.data, prefix, prefix_len) == 0;
+}
+
+NODISCARD static bool mime_view_ends_with_ignore_case(const tstr_view view,
+                                                      const char* const suffix) {
+	const size_t suffix_len = strlen(suffix);
+
+	if(view.len < suffix_len) {
+		return false;
+	}
+
+	return strncasecmp(view.data + (view.len - suffix_len), suffix, suffix_len) == 0;
+}
+
+NODISCARD bool is_mime_type_compressible(const tstr mime_type) {
+
+	const tstr actual_mime_type =
+	    tstr_is_null(&mime_type) // NOLINT(readability-implicit-bool-conversion)
+	        ? DEFAULT_MIME_TYPE
+	        : mime_type;
+
+	tstr_view essence = tstr_as_view(&actual_mime_type);
+
+	// strip parameters, e.g. "text/html; charset=utf-8"
+	for(size_t i = 0; i < essence.len; ++i) {
+		if(essence.data[i] == ';') {
+			essence.len = i;
+			break;
+		}
+	}
+
+	while(essence.len > 0 &&
+	      (essence.data[essence.len - 1] == ' ' || essence.data[essence.len - 1] == '\t')) {
+		essence.len--;
+	}
+
+	if(mime_view_starts_with_ignore_case(essence, "text/")) {
+		return true;
+	}
+
+	if(mime_view_ends_with_ignore_case(essence, "+json") ||
+	   mime_view_ends_with_ignore_case(essence, "+xml")) {
+		return true;
+	}
+
+	for(size_t i = 0; i < COMPRESSIBLE_MIME_TYPES_SIZE; ++i) {
+		if(mime_view_eq_ignore_case(essence, g_compressible_mime_types[i])) {
+			return true;
+		}
+	}
+
+	return false;
+}
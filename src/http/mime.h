@@ -53,6 +53,10 @@ extern MimeTypeMappings
 
 NODISCARD tstr get_mime_type_for_ext(tstr_view ext);
 
+// checks the mime type against an allowlist of types that are worth compressing, parameters like
+// charset are ignored, a null mime type is treated as DEFAULT_MIME_TYPE
+NODISCARD bool is_mime_type_compressible(tstr mime_type);
+
 void global_initialize_mime_map(void);
 
 void global_free_mime_map(void);
@@ -3,6 +3,7 @@
 #include "./send.h"
 #include "./v2.h"
 #include "generic/hash.h"
+#include "generic/send.h"
 #include "utils/buffered_reader.h"
 #include "utils/number_parsing.h"
 
@@ -186,11 +187,20 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HTTPContextTypeV2,
 } HTTPContextType;
 
+// responses to pipelined http/1 requests, see
+// https://datatracker.ietf.org/doc/html/rfc9112#section-9.3.2
+typedef struct {
+	bool queue_output;
+	StringBuilder* pending_output;
+} Http1PipelineState;
+
 struct HTTPGeneralContextImpl {
 	HTTPContextType type;
 	union {
 		HTTP2Context v2;
 	} data;
+	Http1PipelineState pipeline;
+	HTTPRequestMetrics request_metrics;
 };
 
 struct HTTPReaderImpl {
@@ -199,10 +209,29 @@ struct HTTPReaderImpl {
 	BufferedReader* buffered_reader;
 	HTTPReaderState state;
 	HTTPGeneralContext general_context;
+	//
+	HttpReaderSettings settings;
+	size_t handled_requests;
 };
 
-NODISCARD HTTPReader* NULLABLE
-initialize_http_reader_from_connection(ConnectionDescriptor* const descriptor) {
+NODISCARD HttpKeepAliveSettings get_default_http_keep_alive_settings(void) {
+	return (HttpKeepAliveSettings){
+		.max_requests = HTTP_KEEP_ALIVE_DEFAULT_MAX_REQUESTS,
+		.idle_timeout_ms = HTTP_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT_MS,
+	};
+}
+
+NODISCARD HttpReaderSettings get_default_http_reader_settings(void) {
+	return (HttpReaderSettings){
+		.keep_alive = get_default_http_keep_alive_settings(),
+		.chunked = get_default_http_chunked_settings(),
+		.body_spool = get_default_http_body_spool_settings(),
+		.max_body_size = HTTP_DEFAULT_MAX_BODY_SIZE,
+	};
+}
+
+NODISCARD HTTPReader* NULLABLE initialize_http_reader_from_connection(
+    ConnectionDescriptor* const descriptor, const HttpReaderSettings settings) {
 
 	HTTPReader* reader = malloc(sizeof(HTTPReader));
 
@@ -223,7 +252,13 @@ initialize_http_reader_from_connection(ConnectionDescriptor* const descriptor) {
 		.protocol = protocol,
 		.state = HTTPReaderStateEmpty,
 		.buffered_reader = buffered_reader,
-		.general_context = (HTTPGeneralContext){ .type = HTTPContextTypeV1 },
+		.general_context =
+		    (HTTPGeneralContext){ .type = HTTPContextTypeV1,
+		                          .pipeline = { .queue_output = false, .pending_output = NULL },
+		                          .request_metrics = get_default_http_request_metrics(
+		                              DEFAULT_RESPONSE_PROTOCOL_VERSION) },
+		.settings = settings,
+		.handled_requests = 0,
 	};
 
 	return reader;
@@ -528,6 +563,9 @@ NODISCARD RequestSettings get_request_settings(const HttpRequest http_request) {
 		    },
 		.protocol_data = http_request.head.request_line.protocol_data,
 		.http_properties = { .type = HTTPPropertyTypeInvalid },
+		.persistence = { .type = HttpConnectionPersistenceTypeClose,
+		                 .idle_timeout_s = 0,
+		                 .remaining_requests = 0 },
 	};
 
 	CompressionSettings compression_settings =
@@ -573,7 +611,6 @@ typedef struct {
  */
 typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HttpAnalyzeConnectionTypeNothingSpecial = 0,
-	HttpAnalyzeConnectionTypeKeepAlive,
 	HttpAnalyzeConnectionTypeUpgradeH2C,
 } HttpAnalyzeConnectionType;
 
@@ -588,6 +625,10 @@ typedef struct {
 	HTTPRequestLength length;
 	RequestSettings settings;
 	HttpAnalyzeConnection connection;
+	// the connection options "close" and "keep-alive", see
+	// https://datatracker.ietf.org/doc/html/rfc9112#section-9.3
+	bool close_requested;
+	bool keep_alive_requested;
 } HTTPAnalyzeHeaders;
 
 /**
@@ -614,6 +655,8 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	ConnectionHeaderTypeUpgrade = 0x01,
 	ConnectionHeaderTypeHTTP2Settings = 0x02,
 	ConnectionHeaderTypeOther = 0x04,
+	ConnectionHeaderTypeClose = 0x08,
+	ConnectionHeaderTypeKeepAlive = 0x10,
 	ConnectionHeaderTypeNeededForH2C = ConnectionHeaderTypeUpgrade |
 	                                   ConnectionHeaderTypeHTTP2Settings
 } ConnectionHeaderType;
@@ -626,6 +669,10 @@ static void process_connection_header(const tstr_view value, void* argument) {
 		*state = *state | ConnectionHeaderTypeUpgrade;
 	} else if(tstr_view_eq_ignore_case(value, TSTR_TSV("http2-settings"))) {
 		*state = *state | ConnectionHeaderTypeHTTP2Settings;
+	} else if(tstr_view_eq_ignore_case(value, TSTR_TSV("close"))) {
+		*state = *state | ConnectionHeaderTypeClose;
+	} else if(tstr_view_eq_ignore_case(value, TSTR_TSV("keep-alive"))) {
+		*state = *state | ConnectionHeaderTypeKeepAlive;
 	} else {
 		*state = *state | ConnectionHeaderTypeOther;
 	}
@@ -636,6 +683,8 @@ NODISCARD static HttpAnalyzeHeadersResult http_analyze_headers(const HttpRequest
 	HTTPAnalyzeHeaders analyze_result = {
 		.length = { .type = HTTPRequestLengthTypeNoBody },
 		.connection = { .type = HttpAnalyzeConnectionTypeNothingSpecial },
+		.close_requested = false,
+		.keep_alive_requested = false,
 	};
 
 	// see: https://datatracker.ietf.org/doc/html/rfc7540#section-3.2
@@ -656,7 +705,9 @@ NODISCARD static HttpAnalyzeHeadersResult http_analyze_headers(const HttpRequest
 	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, http_request.head.header_fields); ++i) {
 		const HttpHeaderField header = TVEC_AT(HttpHeaderField, http_request.head.header_fields, i);
 
-		if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(content_length))) {
+		const HttpHeaderToken token = get_http_header_field_token(&header);
+
+		if(token == HttpHeaderTokenContentLength) {
 			if(analyze_result.length.type != HTTPRequestLengthTypeNoBody) {
 				// both transfer-encoding and length are used
 
@@ -683,8 +734,7 @@ NODISCARD static HttpAnalyzeHeadersResult http_analyze_headers(const HttpRequest
 			analyze_result.length.type = HTTPRequestLengthTypeContentLength;
 			analyze_result.length.value.length = (size_t)content_length;
 
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key,
-		                                          HTTP_HEADER_NAME(transfer_encoding))) {
+		} else if(token == HttpHeaderTokenTransferEncoding) {
 
 			if(analyze_result.length.type != HTTPRequestLengthTypeNoBody) {
 				// both transfer-encoding and length are used
@@ -702,49 +752,45 @@ NODISCARD static HttpAnalyzeHeadersResult http_analyze_headers(const HttpRequest
 				return new_http_analyze_headers_result_error(HTTPAnalyzeHeaderErrorNotSupported);
 			}
 			analyze_result.length.value.encoding = HTTPEncodingChunked;
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(connection))) {
+		} else if(token == HttpHeaderTokenConnection) {
 			// see https://datatracker.ietf.org/doc/html/rfc7230#section-6.1
-			if(tstr_eq_ignore_case_static_tstr(&header.value, TSTR_STATIC_LIT("close"))) {
-				analyze_result.length.type = HTTPRequestLengthTypeClose;
-			} else if(tstr_eq_ignore_case_static_tstr(&header.value,
-			                                          TSTR_STATIC_LIT("keep-alive"))) {
-				if(analyze_result.connection.type != HttpAnalyzeConnectionTypeNothingSpecial) {
-					FREE_AT_END();
-					return new_http_analyze_headers_result_error(
-					    HTTPAnalyzeHeaderErrorProtocolError);
-				}
 
-				analyze_result.connection.type = HttpAnalyzeConnectionTypeKeepAlive;
-			} else {
+			// parse the header field, it is a list of connection options
 
-				// parse the header field
+			ConnectionHeaderType state = ConnectionHeaderTypeNone;
 
-				ConnectionHeaderType state = ConnectionHeaderTypeNone;
+			process_delimitered_header_value(tstr_as_view(&header.value), ",",
+			                                 process_connection_header, &state);
 
-				process_delimitered_header_value(tstr_as_view(&header.value), ",",
-				                                 process_connection_header, &state);
+			if((state & ConnectionHeaderTypeNeededForH2C) == ConnectionHeaderTypeNeededForH2C) {
+				h2state.connection_has_both_upgrade_and_h2_settings = true;
+			}
 
-				if((state & ConnectionHeaderTypeNeededForH2C) == ConnectionHeaderTypeNeededForH2C) {
-					h2state.connection_has_both_upgrade_and_h2_settings = true;
-				}
+			if((state & ConnectionHeaderTypeClose) != 0) {
+				analyze_result.close_requested = true;
 			}
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(upgrade))) {
+
+			if((state & ConnectionHeaderTypeKeepAlive) != 0) {
+				analyze_result.keep_alive_requested = true;
+			}
+		} else if(token == HttpHeaderTokenUpgrade) {
 			// see: https://datatracker.ietf.org/doc/html/rfc7230#section-6.7
 
 			if(tstr_eq_ignore_case_cstr(&header.value, "h2c")) {
 				h2state.upgrade_h2c_present = true;
 			}
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(http2_settings))) {
+		} else if(token == HttpHeaderTokenHttp2Settings) {
 
 			h2state.settings_buffer =
 			    base64_decode_buffer(readonly_buffer_from_tstr(&header.value));
 		}
 	}
 
-	// only allow HTTPRequestLengthTypeClose on http/1.0
-	if(analyze_result.length.type == HTTPRequestLengthTypeClose &&
-	   http_request.head.request_line.protocol_data.version != HTTPProtocolVersion1Dot0) {
-		analyze_result.length.type = HTTPRequestLengthTypeNoBody;
+	// only allow HTTPRequestLengthTypeClose on http/1.0 and only if no explicit length was given
+	if(analyze_result.close_requested &&
+	   analyze_result.length.type == HTTPRequestLengthTypeNoBody &&
+	   http_request.head.request_line.protocol_data.version == HTTPProtocolVersion1Dot0) {
+		analyze_result.length.type = HTTPRequestLengthTypeClose;
 	}
 
 	analyze_result.settings = get_request_settings(http_request);
@@ -775,8 +821,197 @@ NODISCARD static HttpAnalyzeHeadersResult http_analyze_headers(const HttpRequest
 
 GENERATE_VARIANT_ALL_HTTP_BODY_READ_RESULT()
 
+// collects a request body, it is kept in memory up to the spool threshold, after that it is
+// written to a temporary file
+typedef struct {
+	const HttpBodySpoolSettings* settings;
+	StringBuilder* memory;
+	HttpBodySpool spool;
+	bool spooled;
+} HttpBodySink;
+
+NODISCARD static HttpBodySink http_body_sink_init(const HttpBodySpoolSettings* const settings) {
+	return (HttpBodySink){
+		.settings = settings,
+		.memory = string_builder_init(),
+		.spool = (HttpBodySpool){ .fd = -1, .size = 0 },
+		.spooled = false,
+	};
+}
+
+NODISCARD static bool http_body_sink_append(HttpBodySink* const sink, const ReadonlyBuffer data) {
+
+	if(sink->spooled) {
+		return http_body_spool_append(&(sink->spool), data);
+	}
+
+	if(sink->memory == NULL) {
+		return false;
+	}
+
+	const size_t memory_size = string_builder_get_string_size(sink->memory);
+
+	if(sink->settings->threshold == 0 || memory_size + data.size <= sink->settings->threshold) {
+		const GenericResult append_result = string_builder_append_buffer(sink->memory, data);
+
+		IF_GENERIC_RESULT_IS_ERROR_IGN(append_result) {
+			return false;
+		}
+
+		return true;
+	}
+
+	// the body gets too large, so move it to a file
+	if(!http_body_spool_create(sink->settings, &(sink->spool))) {
+		return false;
+	}
+
+	sink->spooled = true;
+
+	const SizedBuffer memory_data = string_builder_release_into_sized_buffer(&(sink->memory));
+
+	const bool success =
+	    http_body_spool_append(&(sink->spool), readonly_buffer_from_sized_buffer(memory_data));
+
+	free_sized_buffer(memory_data);
+
+	if(!success) {
+		return false;
+	}
+
+	return http_body_spool_append(&(sink->spool), data);
+}
+
+NODISCARD static bool http_body_sink_finish(HttpBodySink* const sink, OUT_PARAM(SizedBuffer) body,
+                                            OUT_PARAM(HttpRequestBodyStorage) storage) {
+
+	if(sink->spooled) {
+		return http_body_spool_finish(&(sink->spool), body, storage);
+	}
+
+	*body = string_builder_release_into_sized_buffer(&(sink->memory));
+	*storage = (HttpRequestBodyStorage){ .type = HttpRequestBodyStorageTypeMemory, .fd = -1 };
+
+	return true;
+}
+
+static void free_http_body_sink(HttpBodySink* const sink) {
+	free_string_builder(sink->memory);
+	sink->memory = NULL;
+	free_http_body_spool(&(sink->spool));
+}
+
+NODISCARD static HttpBodyReadResult
+get_http_body_from_sink(HttpBodySink* const sink, OUT_PARAM(HttpRequest) request) {
+
+	SizedBuffer body = get_empty_sized_buffer();
+
+	if(!http_body_sink_finish(sink, &body, &(request->body_storage))) {
+		free_http_body_sink(sink);
+		return new_http_body_read_result_error(TSTR_STATIC_LIT("storing the body failed"));
+	}
+
+	free_http_body_sink(sink);
+
+	return new_http_body_read_result_ok(body);
+}
+
+NODISCARD static HttpBodyReadResult get_large_http_body(HTTPReader* const reader,
+                                                        const size_t length,
+                                                        OUT_PARAM(HttpRequest) request) {
+
+	HttpBodySink sink = http_body_sink_init(&(reader->settings.body_spool));
+
+	size_t remaining_length = length;
+
+	while(remaining_length > 0) {
+		// the already stored data isn't needed anymore, so the reader only holds one slice
+		buffered_reader_invalidate_old_data(reader->buffered_reader);
+
+		const size_t slice_size = remaining_length < HTTP_BODY_SPOOL_SLICE_SIZE
+		                              ? remaining_length
+		                              : HTTP_BODY_SPOOL_SLICE_SIZE;
+
+		const BufferedReadResult res =
+		    buffered_reader_get_amount(reader->buffered_reader, slice_size);
+
+		if(res.type != BufferedReadResultTypeOk) {
+			free_http_body_sink(&sink);
+			return new_http_body_read_result_error(TSTR_STATIC_LIT("read failed"));
+		}
+
+		if(!http_body_sink_append(&sink, res.value.buffer)) {
+			free_http_body_sink(&sink);
+			return new_http_body_read_result_error(TSTR_STATIC_LIT("storing the body failed"));
+		}
+
+		remaining_length -= slice_size;
+	}
+
+	return get_http_body_from_sink(&sink, request);
+}
+
+NODISCARD static HttpBodyReadResult get_chunked_http_body(HTTPReader* const reader,
+                                                          const size_t max_body_size,
+                                                          OUT_PARAM(HttpRequest) request) {
+
+	HttpChunkedSettings chunked_settings = reader->settings.chunked;
+	chunked_settings.max_body_size = max_body_size;
+
+	HttpChunkedDecoder decoder = http_chunked_decoder_init(chunked_settings);
+
+	// only the decoded data is accumulated, the encoded data is discarded after every slice
+	HttpBodySink sink = http_body_sink_init(&(reader->settings.body_spool));
+
+	while(true) {
+		const HttpChunkedReadResult read_result =
+		    http_chunked_decoder_read(&decoder, reader->buffered_reader);
+
+		if(read_result.type == HttpChunkedReadResultTypeError) {
+			const bool body_too_large = decoder.body_too_large;
+
+			free_http_body_sink(&sink);
+			free_http_chunked_decoder(&decoder);
+
+			if(body_too_large) {
+				return new_http_body_read_result_too_large();
+			}
+
+			return new_http_body_read_result_error(read_result.value.error);
+		}
+
+		if(read_result.type == HttpChunkedReadResultTypeEnd) {
+			break;
+		}
+
+		if(!http_body_sink_append(&sink, read_result.value.data)) {
+			free_http_body_sink(&sink);
+			free_http_chunked_decoder(&decoder);
+			return new_http_body_read_result_error(TSTR_STATIC_LIT("storing the body failed"));
+		}
+	}
+
+	HttpHeaderFields trailer_fields = http_chunked_decoder_release_trailers(&decoder);
+	free_http_chunked_decoder(&decoder);
+
+	const HttpBodyReadResult body_result = get_http_body_from_sink(&sink, request);
+
+	IF_HTTP_BODY_READ_RESULT_IS_ERROR_IGN(body_result) {
+		free_http_header_fields(&trailer_fields);
+		return body_result;
+	}
+
+	request->trailer_fields = trailer_fields;
+
+	return body_result;
+}
+
+// the body itself is returned, the other body related fields are set in the request, content-length
+// bodies above max_body_size are rejected by the caller, before anything is read
 NODISCARD static HttpBodyReadResult get_http_body(HTTPReader* const reader,
-                                                  const HTTPAnalyzeHeaders analyze) {
+                                                  const HTTPAnalyzeHeaders analyze,
+                                                  const size_t max_body_size,
+                                                  OUT_PARAM(HttpRequest) request) {
 
 	switch(analyze.length.type) {
 		case HTTPRequestLengthTypeClose: {
@@ -789,12 +1024,23 @@ NODISCARD static HttpBodyReadResult get_http_body(HTTPReader* const reader,
 
 			reader->state = HTTPReaderStateEnd;
 
+			// the body is only in memory, as it has to be read until the connection is closed
+			if(res.value.buffer.size > max_body_size) {
+				return new_http_body_read_result_too_large();
+			}
+
 			return new_http_body_read_result_ok(
 			    sized_buffer_allocate_from_readonly_buffer(res.value.buffer));
 		}
 
 		case HTTPRequestLengthTypeContentLength: {
 
+			const size_t spool_threshold = reader->settings.body_spool.threshold;
+
+			if(spool_threshold != 0 && analyze.length.value.length > spool_threshold) {
+				return get_large_http_body(reader, analyze.length.value.length, request);
+			}
+
 			const BufferedReadResult res =
 			    buffered_reader_get_amount(reader->buffered_reader, analyze.length.value.length);
 
@@ -806,9 +1052,15 @@ NODISCARD static HttpBodyReadResult get_http_body(HTTPReader* const reader,
 			    sized_buffer_allocate_from_readonly_buffer(res.value.buffer));
 		}
 		case HTTPRequestLengthTypeTransferEncoded: {
-			// TODO(Totto): implement
-			return new_http_body_read_result_error(
-			    TSTR_STATIC_LIT("transfer encoding not yet implemented"));
+			switch(analyze.length.value.encoding) {
+				case HTTPEncodingChunked: {
+					return get_chunked_http_body(reader, max_body_size, request);
+				}
+				default: {
+					return new_http_body_read_result_error(
+					    TSTR_STATIC_LIT("unsupported transfer encoding"));
+				}
+			}
 		}
 		case HTTPRequestLengthTypeNoBody: {
 			return new_http_body_read_result_ok((SizedBuffer){ .data = NULL, .size = 0 });
@@ -868,6 +1120,51 @@ process_http2_upgrade_request(const HTTPResultOk ok_res, HTTPReader* const reade
 	                                 h2c_upgrade_settings, ok_res.request);
 }
 
+// see https://datatracker.ietf.org/doc/html/rfc9112#section-9.3
+NODISCARD static HttpConnectionPersistence
+get_connection_persistence(const HTTPReader* const reader, const HTTPAnalyzeHeaders analyze,
+                           const HTTPProtocolVersion version) {
+
+	const HttpConnectionPersistence close_persistence = {
+		.type = HttpConnectionPersistenceTypeClose,
+		.idle_timeout_s = 0,
+		.remaining_requests = 0,
+	};
+
+	if(analyze.close_requested || analyze.length.type == HTTPRequestLengthTypeClose) {
+		return close_persistence;
+	}
+
+	switch(version) {
+		case HTTPProtocolVersion1Dot1: {
+			// persistent by default
+			break;
+		}
+		case HTTPProtocolVersion1Dot0: {
+			if(!analyze.keep_alive_requested) {
+				return close_persistence;
+			}
+			break;
+		}
+		case HTTPProtocolVersion2:
+		default: {
+			return close_persistence;
+		}
+	}
+
+	if(reader->handled_requests >= reader->settings.keep_alive.max_requests) {
+		return close_persistence;
+	}
+
+	const HttpKeepAliveSettings keep_alive = reader->settings.keep_alive;
+
+	return (HttpConnectionPersistence){
+		.type = HttpConnectionPersistenceTypeKeepAlive,
+		.idle_timeout_s = keep_alive.idle_timeout_ms / 1000, // NOLINT(readability-magic-numbers)
+		.remaining_requests = keep_alive.max_requests - reader->handled_requests,
+	};
+}
+
 NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine request_line,
                                                        HTTPReader* const reader,
                                                        const bool first_request) {
@@ -879,8 +1176,12 @@ NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine req
 		        .header_fields = TVEC_EMPTY(HttpHeaderField),
 		    },
 		.body = (SizedBuffer){ .data = NULL, .size = 0 },
+		.body_storage = { .type = HttpRequestBodyStorageTypeMemory, .fd = -1 },
+		.trailer_fields = TVEC_EMPTY(HttpHeaderField),
 	};
 
+	reader->handled_requests++;
+
 	// parse headers
 	while(true) {
 
@@ -928,6 +1229,8 @@ NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine req
 		}
 	}
 
+	index_http_request_head(&(request.head));
+
 	const HttpAnalyzeHeadersResult analyze_result = http_analyze_headers(request);
 
 	IF_HTTP_ANALYZE_HEADERS_RESULT_IS_ERROR_CONST(analyze_result) {
@@ -956,7 +1259,42 @@ NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine req
 
 	const HTTPAnalyzeHeaders analyze = http_analyze_headers_result_get_as_ok(analyze_result).result;
 
-	const HttpBodyReadResult body_result = get_http_body(reader, analyze);
+	// these requests can't have a body, it is rejected before it is read, so that it is never
+	// spooled, chunked bodies are rejected at their first non empty chunk
+	const bool body_allowed = request_line.method != HTTPRequestMethodGet &&
+	                          request_line.method != HTTPRequestMethodHead &&
+	                          request_line.method != HTTPRequestMethodOptions;
+
+	const size_t max_body_size = body_allowed ? reader->settings.max_body_size : 0;
+
+	const HttpRequestErrorType body_too_large_error = body_allowed
+	                                                      ? HttpRequestErrorTypePayloadTooLarge
+	                                                      : HttpRequestErrorTypeInvalidNonEmptyBody;
+
+	if(analyze.length.type == HTTPRequestLengthTypeContentLength &&
+	   analyze.length.value.length > max_body_size) {
+		free_http_request(request);
+		free_request_settings(analyze.settings);
+
+		return (HttpRequestResult){
+			.type = HttpRequestResultTypeError,
+			.value = { .error = (HttpRequestError){
+			               .is_advanced = false, .value = { .enum_value = body_too_large_error } } }
+		};
+	}
+
+	const HttpBodyReadResult body_result = get_http_body(reader, analyze, max_body_size, &request);
+
+	IF_HTTP_BODY_READ_RESULT_IS_TOO_LARGE(body_result) {
+		free_http_request(request);
+		free_request_settings(analyze.settings);
+
+		return (HttpRequestResult){
+			.type = HttpRequestResultTypeError,
+			.value = { .error = (HttpRequestError){
+			               .is_advanced = false, .value = { .enum_value = body_too_large_error } } }
+		};
+	}
 
 	IF_HTTP_BODY_READ_RESULT_IS_ERROR_CONST(body_result) {
 		return (HttpRequestResult){ .type = HttpRequestResultTypeError,
@@ -968,10 +1306,9 @@ NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine req
 	request.body = http_body_read_result_get_as_ok(body_result).body;
 
 	// check if the request body makes sense
-	if((request_line.method == HTTPRequestMethodGet ||
-	    request_line.method == HTTPRequestMethodHead ||
-	    request_line.method == HTTPRequestMethodOptions) &&
-	   request.body.size != 0) {
+	if(!body_allowed && request.body.size != 0) {
+		free_http_request(request);
+		free_request_settings(analyze.settings);
 
 		return (HttpRequestResult){
 			.type = HttpRequestResultTypeError,
@@ -983,25 +1320,17 @@ NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine req
 		};
 	}
 
+	RequestSettings settings = analyze.settings;
+
+	settings.persistence =
+	    get_connection_persistence(reader, analyze, request_line.protocol_data.version);
+
 	const HTTPResultOk ok_result = (HTTPResultOk){
 		.request = request,
-		.settings = analyze.settings,
+		.settings = settings,
 	};
 
 	switch(analyze.connection.type) {
-		case HttpAnalyzeConnectionTypeKeepAlive: {
-			// TODO(Totto): implement keepalive, atm this ignores it, we send a conenction: close
-			// header, so the sender knows, we don't support it
-			break;
-			// keepalive not yet supported
-			/* return (HttpRequestResult){
-			    .type = HttpRequestResultTypeError,
-			    .value = { .error =
-			                   (HttpRequestError){
-			                       .is_advanced = false,
-			                       .value = { .enum_value = HttpRequestErrorTypeNotSupported } } }
-			}; */
-		}
 		case HttpAnalyzeConnectionTypeUpgradeH2C: {
 			if(!first_request) {
 				return (HttpRequestResult){ .type = HttpRequestResultTypeError,
@@ -1036,17 +1365,10 @@ NODISCARD static HttpRequestResult parse_http1_request(const HttpRequestLine req
 		                        } };
 }
 
-NODISCARD static HttpRequestResult parse_first_http_request(HTTPReader* const reader) {
-
-	// only possible in the first request, as also http2 must send a valid http1 request line
-	// (the preface)
-	HttpRequestLineResult request_line_result = parse_http1_request_line(reader->buffered_reader);
-
-	switch(request_line_result.type) {
-		case HttpRequestLineResultTypeOk: {
-			break;
-		}
+NODISCARD static HttpRequestResult
+get_request_line_error_result(const HttpRequestLineResultType type) {
 
+	switch(type) {
 		case HttpRequestLineResultTypeUnsupportedHttpVersion: {
 			return (HttpRequestResult){
 				.type = HttpRequestResultTypeError,
@@ -1088,6 +1410,99 @@ NODISCARD static HttpRequestResult parse_first_http_request(HTTPReader* const re
 				                                           "failed to parse request line") } } } };
 		}
 	}
+}
+
+// checks the request line of a http/1.x request, that don't depend on the position of the request
+// in the connection
+NODISCARD static bool is_valid_http1_request_line(const HttpRequestLine request_line,
+                                                  OUT_PARAM(HttpRequestResult) error_result) {
+
+	if(request_line.method == HTTPRequestMethodPRI) {
+		// this makes no sense here, as this can be only used with an http2 preface
+		*error_result = (HttpRequestResult){
+			.type = HttpRequestResultTypeError,
+			.value = { .error =
+			               (HttpRequestError){
+			                   .is_advanced = false,
+			                   .value = { .enum_value =
+			                                  HttpRequestErrorTypeInvalidHttp2Preface } } }
+		};
+		return false;
+	}
+
+	{ // check path compatibilities
+		if(request_line.uri.type == ParsedURITypeAsterisk) {
+			if(request_line.method != HTTPRequestMethodOptions) {
+
+				*error_result = (HttpRequestResult){
+					.type = HttpRequestResultTypeError,
+					.value = { .error =
+					               (HttpRequestError){
+					                   .is_advanced = true,
+					                   .value = { .advanced = TSTR_STATIC_LIT(
+					                                  "Invalid path in combination "
+					                                  "with method: path '*' is only "
+					                                  "supported with OPTIONS") } } }
+				};
+				return false;
+			}
+
+			// TODO(Totto): implement further, search for todo_options
+			*error_result = (HttpRequestResult){
+				.type = HttpRequestResultTypeError,
+				.value = { .error = (HttpRequestError){ .is_advanced = true,
+				                                        .value = { .advanced = TSTR_STATIC_LIT(
+				                                                       "not implemented for "
+				                                                       "method OPTIONS: "
+				                                                       "asterisk or normal "
+				                                                       "request") } } }
+			};
+			return false;
+		}
+
+		if(request_line.uri.type == ParsedURITypeAuthority) {
+			if(request_line.method != HTTPRequestMethodConnect) {
+
+				*error_result = (HttpRequestResult){
+					.type = HttpRequestResultTypeError,
+					.value = { .error =
+					               (HttpRequestError){
+					                   .is_advanced = true,
+					                   .value = { .advanced = TSTR_STATIC_LIT(
+					                                  "Invalid path in combination "
+					                                  "with method: path '*' is only "
+					                                  "supported with OPTIONS") } } }
+				};
+				return false;
+			}
+
+			// TODO(Totto): implement further, search for todo_options
+			*error_result = (HttpRequestResult){
+				.type = HttpRequestResultTypeError,
+				.value = { .error = (HttpRequestError){ .is_advanced = true,
+				                                        .value = { .advanced = TSTR_STATIC_LIT(
+				                                                       "not implemented for "
+				                                                       "method CONNECT: "
+				                                                       "authority or normal "
+				                                                       "request") } } }
+
+			};
+			return false;
+		}
+	}
+
+	return true;
+}
+
+NODISCARD static HttpRequestResult parse_first_http_request(HTTPReader* const reader) {
+
+	// only possible in the first request, as also http2 must send a valid http1 request line
+	// (the preface)
+	HttpRequestLineResult request_line_result = parse_http1_request_line(reader->buffered_reader);
+
+	if(request_line_result.type != HttpRequestLineResultTypeOk) {
+		return get_request_line_error_result(request_line_result.type);
+	}
 
 	HttpRequestLine request_line = request_line_result.data.line;
 
@@ -1192,72 +1607,10 @@ NODISCARD static HttpRequestResult parse_first_http_request(HTTPReader* const re
 			return parse_http2_request(&(reader->general_context.data.v2), reader->buffered_reader);
 		}
 
-		if(request_line.method == HTTPRequestMethodPRI) {
-			// this makes no sense here, as this can be only used with an http2 preface
-			return (HttpRequestResult){
-				.type = HttpRequestResultTypeError,
-				.value = { .error =
-				               (HttpRequestError){
-				                   .is_advanced = false,
-				                   .value = { .enum_value =
-				                                  HttpRequestErrorTypeInvalidHttp2Preface } } }
-			};
-		}
-
-		{ // check path compatibilities
-			if(request_line.uri.type == ParsedURITypeAsterisk) {
-				if(request_line.method != HTTPRequestMethodOptions) {
-
-					return (HttpRequestResult){
-						.type = HttpRequestResultTypeError,
-						.value = { .error =
-						               (HttpRequestError){
-						                   .is_advanced = true,
-						                   .value = { .advanced = TSTR_STATIC_LIT(
-						                                  "Invalid path in combination "
-						                                  "with method: path '*' is only "
-						                                  "supported with OPTIONS") } } }
-					};
-				}
-
-				// TODO(Totto): implement further, search for todo_options
-				return (HttpRequestResult){ .type = HttpRequestResultTypeError,
-					                        .value = { .error = (HttpRequestError){
-					                                       .is_advanced = true,
-					                                       .value = { .advanced = TSTR_STATIC_LIT(
-					                                                      "not implemented for "
-					                                                      "method OPTIONS: "
-					                                                      "asterisk or normal "
-					                                                      "request") } } } };
-			}
-
-			if(request_line.uri.type == ParsedURITypeAuthority) {
-				if(request_line.method != HTTPRequestMethodConnect) {
+		HttpRequestResult error_result = {};
 
-					return (HttpRequestResult){
-						.type = HttpRequestResultTypeError,
-						.value = { .error =
-						               (HttpRequestError){
-						                   .is_advanced = true,
-						                   .value = { .advanced = TSTR_STATIC_LIT(
-						                                  "Invalid path in combination "
-						                                  "with method: path '*' is only "
-						                                  "supported with OPTIONS") } } }
-					};
-				}
-
-				// TODO(Totto): implement further, search for todo_options
-				return (HttpRequestResult){
-					.type = HttpRequestResultTypeError,
-					.value = { .error = (HttpRequestError){ .is_advanced = true,
-					                                        .value = { .advanced = TSTR_STATIC_LIT(
-					                                                       "not implemented for "
-					                                                       "method CONNECT: "
-					                                                       "authority or normal "
-					                                                       "request") } } }
-
-				};
-			}
+		if(!is_valid_http1_request_line(request_line, &error_result)) {
+			return error_result;
 		}
 	}
 
@@ -1278,6 +1631,14 @@ NODISCARD static HttpRequestResult parse_first_http_request(HTTPReader* const re
 		}
 	}
 
+	if(reader->general_context.type == HTTPContextTypeV1 &&
+	   result.type == HttpRequestResultTypeOk &&
+	   result.value.ok.settings.persistence.type == HttpConnectionPersistenceTypeKeepAlive) {
+		// the connection persists, any data after this request is the next request
+		reader->general_context.type = HTTPContextTypeV1Keepalive;
+		return result;
+	}
+
 	if(reader->general_context.type == HTTPContextTypeV1) {
 
 		// TODO(Totto): use eof, but that has problems, as some clients only close, after we
@@ -1303,12 +1664,73 @@ NODISCARD static HttpRequestResult parse_first_http_request(HTTPReader* const re
 	return result;
 }
 
+NODISCARD static HttpRequestResult parse_next_http1_request(HTTPReader* const reader) {
+
+	HttpRequestLineResult request_line_result = parse_http1_request_line(reader->buffered_reader);
+
+	if(request_line_result.type != HttpRequestLineResultTypeOk) {
+		reader->state = HTTPReaderStateError;
+		return get_request_line_error_result(request_line_result.type);
+	}
+
+	HttpRequestLine request_line = request_line_result.data.line;
+
+	{ // check for logic errors, the protocol can't change anymore after the first request
+
+		if(request_line.protocol_data.version == HTTPProtocolVersion2) {
+			reader->state = HTTPReaderStateError;
+			return (HttpRequestResult){
+				.type = HttpRequestResultTypeError,
+				.value = { .error =
+				               (HttpRequestError){
+				                   .is_advanced = false,
+				                   .value = { .enum_value =
+				                                  HttpRequestErrorTypeInvalidHttpVersion } } }
+			};
+		}
+
+		HttpRequestResult error_result = {};
+
+		if(!is_valid_http1_request_line(request_line, &error_result)) {
+			reader->state = HTTPReaderStateError;
+			return error_result;
+		}
+	}
+
+	const HttpRequestResult result = parse_http1_request(request_line, reader, false);
+
+	switch(result.type) {
+		case HttpRequestResultTypeOk: {
+			if(result.value.ok.settings.persistence.type != HttpConnectionPersistenceTypeKeepAlive) {
+				// this is the last request on this connection
+				reader->state = HTTPReaderStateEnd;
+			}
+			break;
+		}
+		case HttpRequestResultTypeCloseConnection: {
+			reader->state = HTTPReaderStateEnd;
+			break;
+		}
+		case HttpRequestResultTypeError:
+		default: {
+			reader->state = HTTPReaderStateError;
+			break;
+		}
+	}
+
+	return result;
+}
+
 NODISCARD static HttpRequestResult parse_next_http_request(HTTPReader* const reader) {
 
 	if(reader->general_context.type == HTTPContextTypeV2) {
 		return parse_http2_request(&(reader->general_context.data.v2), reader->buffered_reader);
 	}
 
+	if(reader->general_context.type == HTTPContextTypeV1Keepalive) {
+		return parse_next_http1_request(reader);
+	}
+
 	return (HttpRequestResult){ .type = HttpRequestResultTypeError,
 		                        .value = { .error = (HttpRequestError){
 		                                       .is_advanced = true,
@@ -1316,6 +1738,14 @@ NODISCARD static HttpRequestResult parse_next_http_request(HTTPReader* const rea
 		                                                      "Not yet supported") } } } };
 }
 
+// the responses are only queued, if the next request was already (at least partially) received
+static void update_http1_pipeline_state(HTTPReader* const reader) {
+	reader->general_context.pipeline.queue_output =
+	    reader->state == HTTPReaderStateReading &&
+	    reader->general_context.type == HTTPContextTypeV1Keepalive &&
+	    !buffered_reader_has_more_data(reader->buffered_reader);
+}
+
 HttpRequestResult get_http_request(HTTPReader* const reader) {
 
 	if(!reader) {
@@ -1331,7 +1761,11 @@ HttpRequestResult get_http_request(HTTPReader* const reader) {
 
 			reader->state = HTTPReaderStateReading;
 
-			return parse_first_http_request(reader);
+			const HttpRequestResult result = parse_first_http_request(reader);
+
+			update_http1_pipeline_state(reader);
+
+			return result;
 		}
 		case HTTPReaderStateReading: {
 			if(reader->general_context.type == HTTPContextTypeV1) {
@@ -1352,7 +1786,11 @@ HttpRequestResult get_http_request(HTTPReader* const reader) {
 			// hold onto strings from there)
 			buffered_reader_invalidate_old_data(reader->buffered_reader);
 
-			return parse_next_http_request(reader);
+			const HttpRequestResult result = parse_next_http_request(reader);
+
+			update_http1_pipeline_state(reader);
+
+			return result;
 		}
 		case HTTPReaderStateEnd:
 		case HTTPReaderStateError:
@@ -1382,8 +1820,50 @@ NODISCARD bool http_reader_more_available(const HTTPReader* const reader) {
 	}
 }
 
+NODISCARD HttpReaderWaitResult http_reader_wait_for_next_request(HTTPReader* const reader,
+                                                                 const uint32_t timeout_ms) {
+
+	if(reader->state != HTTPReaderStateReading ||
+	   reader->general_context.type != HTTPContextTypeV1Keepalive) {
+		return HttpReaderWaitResultReady;
+	}
+
+	const BufferedWaitResult wait_result =
+	    buffered_reader_wait_for_data(reader->buffered_reader, timeout_ms);
+
+	switch(wait_result) {
+		case BufferedWaitResultDataAvailable: {
+			return HttpReaderWaitResultReady;
+		}
+		case BufferedWaitResultTimeout: {
+			return HttpReaderWaitResultTimeout;
+		}
+		case BufferedWaitResultClosed: {
+			// the client closed the connection between two requests, that is no error
+			reader->state = HTTPReaderStateEnd;
+			return HttpReaderWaitResultClosed;
+		}
+		case BufferedWaitResultError:
+		default: {
+			reader->state = HTTPReaderStateError;
+			return HttpReaderWaitResultError;
+		}
+	}
+}
+
+void http_reader_disable_keep_alive(HTTPReader* const reader) {
+	reader->settings.keep_alive.max_requests = 0;
+
+	if(reader->state == HTTPReaderStateReading &&
+	   reader->general_context.type == HTTPContextTypeV1Keepalive) {
+		reader->state = HTTPReaderStateEnd;
+	}
+}
+
 static void free_reader_general_context(HTTPGeneralContext general_context) {
 
+	free_string_builder(general_context.pipeline.pending_output);
+
 	switch(general_context.type) {
 		case HTTPContextTypeV1:
 		case HTTPContextTypeV1Keepalive: {
@@ -1438,3 +1918,45 @@ http_general_context_get_http2_context(HTTPGeneralContext* const general_context
 
 	return &(general_context->data.v2);
 }
+
+NODISCARD bool
+http_general_context_should_queue_http1_output(const HTTPGeneralContext* const general_context) {
+	return general_context->pipeline.queue_output;
+}
+
+NODISCARD bool
+http_general_context_has_pending_http1_output(const HTTPGeneralContext* const general_context) {
+	return string_builder_get_string_size(general_context->pipeline.pending_output) > 0;
+}
+
+NODISCARD StringBuilder* NULLABLE
+http_general_context_get_pending_http1_output(HTTPGeneralContext* const general_context) {
+
+	if(general_context->pipeline.pending_output == NULL) {
+		general_context->pipeline.pending_output = string_builder_init();
+	}
+
+	return general_context->pipeline.pending_output;
+}
+
+NODISCARD GenericResult http_general_context_flush_http1_output(
+    HTTPGeneralContext* const general_context, const ConnectionDescriptor* const descriptor) {
+
+	if(!http_general_context_has_pending_http1_output(general_context)) {
+		return GENERIC_RES_OK();
+	}
+
+	// this frees the string builder
+	return send_string_builder_to_connection(descriptor,
+	                                         &(general_context->pipeline.pending_output));
+}
+
+void http_general_context_set_request_metrics(HTTPGeneralContext* const general_context,
+                                              const HTTPRequestMetrics request_metrics) {
+	general_context->request_metrics = request_metrics;
+}
+
+NODISCARD HTTPRequestMetrics
+http_general_context_get_request_metrics(const HTTPGeneralContext* const general_context) {
+	return general_context->request_metrics;
+}
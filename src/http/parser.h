@@ -6,15 +6,44 @@
 extern "C" {
 #endif
 
+#include "./body_spool.h"
+#include "./chunked.h"
 #include "./protocol.h"
+#include "./server_metrics.h"
 #include "./v2.h"
 
 NODISCARD HTTPRequestMethod get_http_method_from_string(tstr_view method, OUT_PARAM(bool) success);
 
 typedef struct HTTPReaderImpl HTTPReader;
 
-NODISCARD HTTPReader* NULLABLE
-initialize_http_reader_from_connection(ConnectionDescriptor* descriptor);
+#define HTTP_KEEP_ALIVE_DEFAULT_MAX_REQUESTS 100
+
+#define HTTP_KEEP_ALIVE_DEFAULT_IDLE_TIMEOUT_MS 5000
+
+// settings for http/1.x persistent connections
+typedef struct {
+	// the maximum amount of requests on one connection, 0 disables keep-alive
+	size_t max_requests;
+	uint32_t idle_timeout_ms;
+} HttpKeepAliveSettings;
+
+NODISCARD HttpKeepAliveSettings get_default_http_keep_alive_settings(void);
+
+// larger request bodies are answered with a 413, before they are read, for chunked bodies, as soon
+// as the limit is crossed, this is also the limit of the decoded chunked body
+#define HTTP_DEFAULT_MAX_BODY_SIZE HTTP_CHUNKED_DEFAULT_MAX_BODY_SIZE
+
+typedef struct {
+	HttpKeepAliveSettings keep_alive;
+	HttpChunkedSettings chunked;
+	HttpBodySpoolSettings body_spool;
+	size_t max_body_size;
+} HttpReaderSettings;
+
+NODISCARD HttpReaderSettings get_default_http_reader_settings(void);
+
+NODISCARD HTTPReader* NULLABLE initialize_http_reader_from_connection(
+    ConnectionDescriptor* descriptor, HttpReaderSettings settings);
 
 typedef struct HTTPGeneralContextImpl HTTPGeneralContext;
 
@@ -24,10 +53,55 @@ NODISCARD BufferedReader* http_reader_release_buffered_reader(HTTPReader* reader
 
 NODISCARD HTTP2Context* http_general_context_get_http2_context(HTTPGeneralContext* general_context);
 
+// if the pending http/1 output grows above this, it is flushed, even if more requests are buffered
+#define HTTP1_PIPELINE_MAX_PENDING_OUTPUT_SIZE (1 << 16)
+
+// http/1 pipelining: while further requests are already buffered, the responses are queued in the
+// general context and written in one go, once the input buffer runs empty
+NODISCARD bool
+http_general_context_should_queue_http1_output(const HTTPGeneralContext* general_context);
+
+NODISCARD bool
+http_general_context_has_pending_http1_output(const HTTPGeneralContext* general_context);
+
+// creates the pending output, if there is none yet
+NODISCARD StringBuilder* NULLABLE
+http_general_context_get_pending_http1_output(HTTPGeneralContext* general_context);
+
+NODISCARD GenericResult http_general_context_flush_http1_output(
+    HTTPGeneralContext* general_context, const ConnectionDescriptor* descriptor);
+
+// the responses and phases, that are sent or measured while this is set, are recorded for this
+// request
+void http_general_context_set_request_metrics(HTTPGeneralContext* general_context,
+                                              HTTPRequestMetrics request_metrics);
+
+NODISCARD HTTPRequestMetrics
+http_general_context_get_request_metrics(const HTTPGeneralContext* general_context);
+
 NODISCARD HttpRequestResult get_http_request(HTTPReader* reader);
 
 NODISCARD bool http_reader_more_available(const HTTPReader* reader);
 
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HttpReaderWaitResultReady = 0,
+	HttpReaderWaitResultTimeout,
+	HttpReaderWaitResultClosed,
+	HttpReaderWaitResultError,
+} HttpReaderWaitResult;
+
+// waits at most timeout_ms for the next request on a http/1.x keep-alive connection, for all other
+// states this returns HttpReaderWaitResultReady immediately, as get_http_request then either reads
+// the first request or reports the error itself
+NODISCARD HttpReaderWaitResult http_reader_wait_for_next_request(HTTPReader* reader,
+                                                                 uint32_t timeout_ms);
+
+// the currently handled request is the last one on this connection
+void http_reader_disable_keep_alive(HTTPReader* reader);
+
 NODISCARD bool finish_reader(HTTPReader* reader, ConnectionContext* context);
 
 NODISCARD CompressionSettings get_compression_settings(HttpHeaderFields header_fields);
@@ -1,5 +1,6 @@
 
 #include "./protocol.h"
+#include "./body_spool.h"
 #include "./parser.h"
 
 TVEC_IMPLEMENT_VEC_TYPE(HttpHeaderField)
@@ -37,6 +38,7 @@ get_error_string_for_http_request_error_type(const HttpRequestErrorType type) {
 		case HttpRequestErrorTypeLengthRequired: return TSTR_STATIC_LIT("LengthRequired");
 		case HttpRequestErrorTypeProtocolError: return TSTR_STATIC_LIT("ProtocolError");
 		case HttpRequestErrorTypeNotSupported: return TSTR_STATIC_LIT("NotSupported");
+		case HttpRequestErrorTypePayloadTooLarge: return TSTR_STATIC_LIT("PayloadTooLarge");
 		default: return TSTR_STATIC_LIT("<Unknown>");
 	}
 }
@@ -60,7 +62,8 @@ void free_http_request_head(HttpRequestHead head) {
 // when a corrupted request e.g was parsed partly correct
 void free_http_request(HttpRequest request) {
 	free_http_request_head(request.head);
-	free_sized_buffer(request.body);
+	free_http_request_body(request.body, request.body_storage);
+	free_http_header_fields(&request.trailer_fields);
 }
 
 void free_http_request_result(HTTPResultOk result) {
@@ -111,63 +114,109 @@ NODISCARD const ParsedSearchPathEntry* find_search_key(const ParsedSearchPath se
 	return entry;
 }
 
+// every status code with its reason phrase, according to
+// https://datatracker.ietf.org/doc/html/rfc7231#section-6.1, so that the message and the
+// precomputed http/1 status lines can't get out of sync
+#define HTTP_STATUS_CODE_LIST(X) \
+	X(HttpStatusContinue, 100, "Continue") \
+	X(HttpStatusSwitchingProtocols, 101, "Switching Protocols") \
+	X(HttpStatusOk, 200, "OK") \
+	X(HttpStatusCreated, 201, "Created") \
+	X(HttpStatusAccepted, 202, "Accepted") \
+	X(HttpStatusNonAuthoritativeInformation, 203, "Non-Authoritative Information") \
+	X(HttpStatusNoContent, 204, "No Content") \
+	X(HttpStatusResetContent, 205, "Reset Content") \
+	X(HttpStatusPartialContent, 206, "Partial Content") \
+	X(HttpStatusMultipleChoices, 300, "Multiple Choices") \
+	X(HttpStatusMovedPermanently, 301, "Moved Permanently") \
+	X(HttpStatusFound, 302, "Found") \
+	X(HttpStatusSeeOther, 303, "See Other") \
+	X(HttpStatusNotModified, 304, "Not Modified") \
+	X(HttpStatusUseProxy, 305, "Use Proxy") \
+	X(HttpStatusTemporaryRedirect, 307, "Temporary Redirect") \
+	X(HttpStatusBadRequest, 400, "Bad Request") \
+	X(HttpStatusUnauthorized, 401, "Unauthorized") \
+	X(HttpStatusPaymentRequired, 402, "Payment Required") \
+	X(HttpStatusForbidden, 403, "Forbidden") \
+	X(HttpStatusNotFound, 404, "Not Found") \
+	X(HttpStatusMethodNotAllowed, 405, "Method Not Allowed") \
+	X(HttpStatusNotAcceptable, 406, "Not Acceptable") \
+	X(HttpStatusProxyAuthenticationRequired, 407, "Proxy Authentication Required") \
+	X(HttpStatusRequestTimeout, 408, "Request Timeout") \
+	X(HttpStatusConflict, 409, "Conflict") \
+	X(HttpStatusGone, 410, "Gone") \
+	X(HttpStatusLengthRequired, 411, "Length Required") \
+	X(HttpStatusPreconditionFailed, 412, "Precondition Failed") \
+	X(HttpStatusPayloadTooLarge, 413, "Payload Too Large") \
+	X(HttpStatusUriTooLong, 414, "URI Too Long") \
+	X(HttpStatusUnsupportedMediaType, 415, "Unsupported Media Type") \
+	X(HttpStatusRangeNotSatisfiable, 416, "Range Not Satisfiable") \
+	X(HttpStatusExpectationFailed, 417, "Expectation Failed") \
+	X(HttpStatusUpgradeRequired, 426, "Upgrade Required") \
+	X(HttpStatusTooManyRequests, 429, "Too Many Requests") \
+	X(HttpStatusInternalServerError, 500, "Internal Server Error") \
+	X(HttpStatusNotImplemented, 501, "Not Implemented") \
+	X(HttpStatusBadGateway, 502, "Bad Gateway") \
+	X(HttpStatusServiceUnavailable, 503, "Service Unavailable") \
+	X(HttpStatusGatewayTimeout, 504, "Gateway Timeout") \
+	X(HttpStatusHttpVersionNotSupported, 505, "HTTP Version Not Supported")
+
 // simple helper for getting the status Message for a special status code, all from the spec for
 // http 1.1 implemented (not in the spec e.g. 418)
 const char* get_status_message(HttpStatusCode status_code) {
-	const char* result = "NOT SUPPORTED STATUS CODE"; // NOLINT(clang-analyzer-deadcode.DeadStores)
-	// according to https://datatracker.ietf.org/doc/html/rfc7231#section-6.1
 	switch(status_code) {
-		case HttpStatusContinue: result = "Continue"; break;
-		case HttpStatusSwitchingProtocols: result = "Switching Protocols"; break;
-		case HttpStatusOk: result = "OK"; break;
-		case HttpStatusCreated: result = "Created"; break;
-		case HttpStatusAccepted: result = "Accepted"; break;
-		case HttpStatusNonAuthoritativeInformation: result = "Non-Authoritative Information"; break;
-		case HttpStatusNoContent: result = "No Content"; break;
-		case HttpStatusResetContent: result = "Reset Content"; break;
-		case HttpStatusPartialContent: result = "Partial Content"; break;
-		case HttpStatusMultipleChoices: result = "Multiple Choices"; break;
-		case HttpStatusMovedPermanently: result = "Moved Permanently"; break;
-		case HttpStatusFound: result = "Found"; break;
-		case HttpStatusSeeOther: result = "See Other"; break;
-		case HttpStatusNotModified: result = "Not Modified"; break;
-		case HttpStatusUseProxy: result = "Use Proxy"; break;
-		case HttpStatusTemporaryRedirect: result = "Temporary Redirect"; break;
-		case HttpStatusBadRequest: result = "Bad Request"; break;
-		case HttpStatusUnauthorized: result = "Unauthorized"; break;
-		case HttpStatusPaymentRequired: result = "Payment Required"; break;
-		case HttpStatusForbidden: result = "Forbidden"; break;
-		case HttpStatusNotFound: result = "Not Found"; break;
-		case HttpStatusMethodNotAllowed: result = "Method Not Allowed"; break;
-		case HttpStatusNotAcceptable: result = "Not Acceptable"; break;
-		case HttpStatusProxyAuthenticationRequired: result = "Proxy Authentication Required"; break;
-		case HttpStatusRequestTimeout: result = "Request Timeout"; break;
-		case HttpStatusConflict: result = "Conflict"; break;
-		case HttpStatusGone: result = "Gone"; break;
-		case HttpStatusLengthRequired: result = "Length Required"; break;
-		case HttpStatusPreconditionFailed: result = "Precondition Failed"; break;
-		case HttpStatusPayloadTooLarge: result = "Payload Too Large"; break;
-		case HttpStatusUriTooLong: result = "URI Too Long"; break;
-		case HttpStatusUnsupportedMediaType: result = "Unsupported Media Type"; break;
-		case HttpStatusRangeNotSatisfiable: result = "Range Not Satisfiable"; break;
-		case HttpStatusExpectationFailed: result = "Expectation Failed"; break;
-		case HttpStatusUpgradeRequired: result = "Upgrade Required"; break;
-		case HttpStatusInternalServerError: result = "Internal Server Error"; break;
-		case HttpStatusNotImplemented: result = "Not Implemented"; break;
-		case HttpStatusBadGateway: result = "Bad Gateway"; break;
-		case HttpStatusServiceUnavailable: result = "Service Unavailable"; break;
-		case HttpStatusGatewayTimeout: result = "Gateway Timeout"; break;
-		case HttpStatusHttpVersionNotSupported: result = "HTTP Version Not Supported"; break;
-		default: break;
+#define HTTP_STATUS_MESSAGE_CASE(STATUS, CODE, MESSAGE) \
+	case STATUS: return MESSAGE;
+		HTTP_STATUS_CODE_LIST(HTTP_STATUS_MESSAGE_CASE)
+#undef HTTP_STATUS_MESSAGE_CASE
+		default: return "NOT SUPPORTED STATUS CODE";
+	}
+}
+
+#define HTTP1_STATUS_LINE_LIT(VERSION, CODE, MESSAGE) \
+	TSTR_STATIC_LIT(VERSION " " STRINGIFY(CODE) " " MESSAGE HTTP_LINE_SEPERATORS)
+
+NODISCARD tstr_static get_http1_status_line(const HTTPProtocolVersion protocol_version,
+                                            const HttpStatusCode status_code) {
+
+	const bool is_http1_0 = protocol_version == HTTPProtocolVersion1Dot0;
+
+	switch(status_code) {
+#define HTTP1_STATUS_LINE_CASE(STATUS, CODE, MESSAGE) \
+	case STATUS: \
+		return is_http1_0 ? HTTP1_STATUS_LINE_LIT("HTTP/1.0", CODE, MESSAGE) \
+		                  : HTTP1_STATUS_LINE_LIT("HTTP/1.1", CODE, MESSAGE);
+		HTTP_STATUS_CODE_LIST(HTTP1_STATUS_LINE_CASE)
+#undef HTTP1_STATUS_LINE_CASE
+		default: return tstr_static_null();
 	}
-	return result;
+}
+
+#undef HTTP1_STATUS_LINE_LIT
+
+NODISCARD static bool is_header_field_matching(const HttpHeaderField* const header,
+                                               const tstr_static key,
+                                               const HttpHeaderToken key_token) {
+
+	// well known names only need an integer compare, if the token of the field is computed
+	if(header->token != HttpHeaderTokenNone && key_token != HttpHeaderTokenOther) {
+		return header->token == key_token;
+	}
+
+	if(header->token != HttpHeaderTokenNone && header->token != HttpHeaderTokenOther) {
+		return false;
+	}
+
+	return tstr_eq_ignore_case_static_tstr(&(header->key), key);
 }
 
 NODISCARD HttpHeaderField* find_header_by_key(HttpHeaderFields array, const tstr_static key) {
 
+	const HttpHeaderToken key_token = get_http_header_token(key.ptr, key.len);
+
 	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, array); ++i) {
 		HttpHeaderField* header = TVEC_GET_AT_MUT(HttpHeaderField, &array, i);
-		if(tstr_eq_ignore_case_static_tstr(&(header->key), key)) {
+		if(is_header_field_matching(header, key, key_token)) {
 			return header;
 		}
 	}
@@ -175,6 +224,69 @@ NODISCARD HttpHeaderField* find_header_by_key(HttpHeaderFields array, const tstr
 	return NULL;
 }
 
+NODISCARD HttpHeaderToken get_http_header_token_for_key(const tstr* const key) {
+	return get_http_header_token(tstr_cstr(key), tstr_len(key));
+}
+
+NODISCARD HttpHeaderToken get_http_header_field_token(const HttpHeaderField* const field) {
+	if(field->token != HttpHeaderTokenNone) {
+		return field->token;
+	}
+
+	return get_http_header_token_for_key(&(field->key));
+}
+
+void index_http_request_head(HttpRequestHead* const head) {
+
+	head->header_index = (HttpHeaderIndex){ .valid = false, .positions = {} };
+
+	const size_t length = TVEC_LENGTH(HttpHeaderField, head->header_fields);
+
+	if(length >= UINT16_MAX) {
+		// the lookups just fall back to a scan
+		return;
+	}
+
+	for(size_t i = length; i > 0; --i) {
+		HttpHeaderField* header = TVEC_GET_AT_MUT(HttpHeaderField, &(head->header_fields), i - 1);
+
+		if(header->token == HttpHeaderTokenNone) {
+			header->token = get_http_header_token_for_key(&(header->key));
+		}
+
+		// iterating backwards, so that the first field with that name is indexed
+		head->header_index.positions[header->token] = (uint16_t)i;
+	}
+
+	head->header_index.valid = true;
+}
+
+NODISCARD HttpHeaderField* find_request_header(const HttpRequestHead* const head,
+                                               const HttpHeaderToken token) {
+
+	if(token == HttpHeaderTokenNone || token == HttpHeaderTokenOther ||
+	   token >= HTTP_HEADER_TOKEN_COUNT) {
+		return NULL;
+	}
+
+	if(head->header_index.valid) {
+		const uint16_t position = head->header_index.positions[token];
+
+		if(position == 0) {
+			return NULL;
+		}
+
+		HttpHeaderFields header_fields = head->header_fields;
+
+		return TVEC_GET_AT_MUT(HttpHeaderField, &header_fields, position - 1);
+	}
+
+	const char* const name = get_http_header_token_name(token);
+
+	return find_header_by_key(head->header_fields,
+	                          (tstr_static){ .ptr = name, .len = strlen(name) });
+}
+
 #define COMPRESSIONS_SIZE 5
 
 static CompressionType get_best_compression_that_is_supported(void) {
@@ -215,6 +327,7 @@ SendSettings get_send_settings(const RequestSettings request_settings) {
 	SendSettings result = {
 		.compression_to_use = CompressionTypeNone,
 		.protocol_data = request_settings.protocol_data,
+		.persistence = request_settings.persistence,
 	};
 
 	CompressionEntries entries = request_settings.compression_settings.entries;
@@ -278,12 +391,73 @@ void free_http_header_fields(HttpHeaderFields* header_fields) {
 void add_http_header_field(HttpHeaderFields* const header_fields, const tstr key,
                            const tstr value) {
 
-	HttpHeaderField field = { .key = key, .value = value };
+	HttpHeaderField field = {
+		.key = key, .value = value, .token = get_http_header_token_for_key(&key)
+	};
 
 	const TvecResult push_res = TVEC_PUSH(HttpHeaderField, header_fields, field);
 	OOM_ASSERT(push_res == TvecResultOk, "Vec push error");
 }
 
+NODISCARD static bool is_http_token_char(const char character) {
+
+	if((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+	   (character >= '0' && character <= '9')) {
+		return true;
+	}
+
+	switch(character) {
+		case '!':
+		case '#':
+		case '$':
+		case '%':
+		case '&':
+		case '\'':
+		case '*':
+		case '+':
+		case '-':
+		case '.':
+		case '^':
+		case '_':
+		case '`':
+		case '|':
+		case '~': {
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+NODISCARD bool is_valid_http_header_field_name(const tstr_view name) {
+
+	if(name.len == 0) {
+		return false;
+	}
+
+	for(size_t i = 0; i < name.len; ++i) {
+		if(!is_http_token_char(name.data[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+NODISCARD bool is_valid_http_header_field_value(const tstr_view value) {
+
+	for(size_t i = 0; i < value.len; ++i) {
+		const char character = value.data[i];
+
+		if(character == '\0' || character == '\r' || character == '\n') {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void process_delimitered_header_value(const tstr_view value, const char* const delimiter,
                                       ProcessHeaderValue callback_function,
                                       void* callback_argument) {
@@ -6,6 +6,7 @@
 #include "./compression.h"
 
 #include "./uri.h"
+#include "generated_http_header_tokens.h"
 #include "generic/secure.h"
 #include "utils/log.h"
 #include "utils/sized_buffer.h"
@@ -62,6 +63,7 @@ typedef enum C_23_NARROW_ENUM_TO(uint16_t) {
 	HttpStatusRangeNotSatisfiable = 416,
 	HttpStatusExpectationFailed = 417,
 	HttpStatusUpgradeRequired = 426,
+	HttpStatusTooManyRequests = 429,
 	//
 	HttpStatusInternalServerError = 500,
 	HttpStatusNotImplemented = 501,
@@ -76,6 +78,9 @@ typedef enum C_23_NARROW_ENUM_TO(uint16_t) {
 typedef struct {
 	tstr key;
 	tstr value;
+	// set for parsed and added header fields, so that well known headers can be compared without
+	// a string compare
+	HttpHeaderToken token;
 } HttpHeaderField;
 
 /**
@@ -134,16 +139,44 @@ TVEC_DEFINE_VEC_TYPE(HttpHeaderField)
 
 typedef TVEC_TYPENAME(HttpHeaderField) HttpHeaderFields;
 
+// the position of the first header field for every well known header name, so that these lookups
+// are just an array index
+typedef struct {
+	bool valid;
+	// the position + 1, 0 means, that the header field is not present
+	uint16_t positions[HTTP_HEADER_TOKEN_COUNT];
+} HttpHeaderIndex;
+
 typedef struct {
 	HttpRequestLine request_line;
 	// TODO(Totto): are header fields an array of key value or a hashmap?
 	//  see MAP_INSERT(ParsedSearchPathHashMap, as we treat search params as map
 	HttpHeaderFields header_fields;
+	HttpHeaderIndex header_index;
 } HttpRequestHead;
 
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HttpRequestBodyStorageTypeMemory = 0,
+	HttpRequestBodyStorageTypeFile,
+} HttpRequestBodyStorageType;
+
+// large bodies are spooled to an anonymous temporary file, the body is then a read only mapping of
+// that file, alternatively the file can be read with the fd
+typedef struct {
+	HttpRequestBodyStorageType type;
+	// only valid for HttpRequestBodyStorageTypeFile
+	NativeFd fd;
+} HttpRequestBodyStorage;
+
 typedef struct {
 	HttpRequestHead head;
 	SizedBuffer body;
+	HttpRequestBodyStorage body_storage;
+	// only present for http/1 bodies using the chunked transfer coding
+	HttpHeaderFields trailer_fields;
 } HttpRequest;
 
 /**
@@ -157,6 +190,7 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HttpRequestErrorTypeLengthRequired,
 	HttpRequestErrorTypeProtocolError,
 	HttpRequestErrorTypeNotSupported,
+	HttpRequestErrorTypePayloadTooLarge,
 } HttpRequestErrorType;
 
 NODISCARD tstr_static get_error_string_for_http_request_error_type(HttpRequestErrorType type);
@@ -217,10 +251,27 @@ typedef struct {
 	CompressionEntries entries;
 } CompressionSettings;
 
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HttpConnectionPersistenceTypeClose = 0,
+	HttpConnectionPersistenceTypeKeepAlive,
+} HttpConnectionPersistenceType;
+
+// whether a http/1.x connection stays open after the response, for http/2 this is ignored
+typedef struct {
+	HttpConnectionPersistenceType type;
+	// advertised in the Keep-Alive header, only valid for HttpConnectionPersistenceTypeKeepAlive
+	uint32_t idle_timeout_s;
+	size_t remaining_requests;
+} HttpConnectionPersistence;
+
 typedef struct {
 	CompressionSettings compression_settings;
 	HttpProtocolData protocol_data;
 	HttpRequestProperties http_properties;
+	HttpConnectionPersistence persistence;
 } RequestSettings;
 
 typedef struct {
@@ -259,11 +310,28 @@ NODISCARD const ParsedSearchPathEntry* find_search_key(ParsedSearchPath path, ts
 // only the ones needed
 NODISCARD const char* get_status_message(HttpStatusCode status_code);
 
+// the whole status line including the line separators, e.g. "HTTP/1.1 200 OK\r\n", these are
+// string literals, so they don't need to be formatted per response, returns a null tstr_static
+// for unknown status codes
+NODISCARD tstr_static get_http1_status_line(HTTPProtocolVersion protocol_version,
+                                            HttpStatusCode status_code);
+
 NODISCARD HttpHeaderField* find_header_by_key(HttpHeaderFields array, tstr_static key);
 
+NODISCARD HttpHeaderToken get_http_header_token_for_key(const tstr* key);
+
+// uses the stored token, if it was computed
+NODISCARD HttpHeaderToken get_http_header_field_token(const HttpHeaderField* field);
+
+// has to be called after all header fields are added to the head
+void index_http_request_head(HttpRequestHead* head);
+
+NODISCARD HttpHeaderField* find_request_header(const HttpRequestHead* head, HttpHeaderToken token);
+
 typedef struct {
 	CompressionType compression_to_use;
 	HttpProtocolData protocol_data;
+	HttpConnectionPersistence persistence;
 } SendSettings;
 
 NODISCARD SendSettings get_send_settings(RequestSettings request_settings);
@@ -276,6 +344,14 @@ void add_http_header_field(HttpHeaderFields* header_fields,
                            MOVED(tstr) key,    // NOLINT(totto-function-passing-type)
                            MOVED(tstr) value); // NOLINT(totto-function-passing-type)
 
+// a field name has to be a token, see https://datatracker.ietf.org/doc/html/rfc9110#section-5.1,
+// so it can't contain whitespace, ':' or control characters
+NODISCARD bool is_valid_http_header_field_name(tstr_view name);
+
+// a field value can't contain NUL, CR or LF, see
+// https://datatracker.ietf.org/doc/html/rfc9110#section-5.5, other whitespace isn't checked
+NODISCARD bool is_valid_http_header_field_value(tstr_view value);
+
 #define HTTP_LINE_SEPERATORS "\r\n"
 
 #define SIZEOF_HTTP_LINE_SEPERATORS 2
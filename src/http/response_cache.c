@@ -0,0 +1,587 @@
+
+#include "./response_cache.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+#include "utils/string_builder.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+struct HTTPResponseCacheEntryImpl {
+	SizedBuffer key;
+	PrebuiltHttpResponse* response;
+	uint64_t expires_at_ms;
+	// the cache holds one reference, as long as the entry is in it, so that evicting an entry
+	// doesn't free it, while it is sent
+	atomic_size_t references;
+};
+
+struct HTTPResponseCacheFlightImpl {
+	SizedBuffer key;
+	// the formats of the first request and of all waiters, so that the entry has all of them
+	PrebuiltFormatMask formats;
+	bool finished;
+	// the first request and the waiters, the last one frees the flight
+	size_t references;
+};
+
+struct HTTPResponseCacheImpl {
+	HTTPResponseCacheOptions options;
+	pthread_mutex_t mutex;
+	// NULL for empty slots, the amount is small, so a linear search is fine
+	HTTPResponseCacheEntry* entries[HTTP_RESPONSE_CACHE_MAX_ENTRIES];
+	// NULL for empty slots, finished flights are removed at once
+	HTTPResponseCacheFlight* flights[HTTP_RESPONSE_CACHE_MAX_FLIGHTS];
+	// broadcast, when a flight finishes
+	pthread_cond_t flight_finished;
+};
+
+NODISCARD HTTPResponseCache* initialize_http_response_cache(HTTPResponseCacheOptions options) {
+
+	if(options.ttl_ms == 0) {
+		return NULL;
+	}
+
+	if(options.ttl_ms < HTTP_RESPONSE_CACHE_MIN_TTL_MS) {
+		options.ttl_ms = HTTP_RESPONSE_CACHE_MIN_TTL_MS;
+	} else if(options.ttl_ms > HTTP_RESPONSE_CACHE_MAX_TTL_MS) {
+		options.ttl_ms = HTTP_RESPONSE_CACHE_MAX_TTL_MS;
+	}
+
+	HTTPResponseCache* cache = malloc(sizeof(HTTPResponseCache));
+
+	if(!cache) {
+		return NULL;
+	}
+
+	int result = pthread_mutex_init(&cache->mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the mutex for the response cache",
+	    free(cache);
+	    return NULL;);
+
+	result = pthread_cond_init(&cache->flight_finished, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the condition for the response cache",
+	    pthread_mutex_destroy(&cache->mutex);
+	    free(cache);
+	    return NULL;);
+
+	cache->options = options;
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_ENTRIES; ++i) {
+		cache->entries[i] = NULL;
+	}
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_FLIGHTS; ++i) {
+		cache->flights[i] = NULL;
+	}
+
+	return cache;
+}
+
+static void free_http_response_cache_entry(HTTPResponseCacheEntry* const entry) {
+	free_sized_buffer(entry->key);
+	free_prebuilt_http_response(entry->response);
+	free(entry);
+}
+
+void http_response_cache_release(HTTPResponseCacheEntry* const entry) {
+
+	if(entry == NULL) {
+		return;
+	}
+
+	if(atomic_fetch_sub_explicit(&entry->references, 1, memory_order_acq_rel) == 1) {
+		free_http_response_cache_entry(entry);
+	}
+}
+
+void free_http_response_cache(HTTPResponseCache* const cache) {
+
+	if(cache == NULL) {
+		return;
+	}
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_ENTRIES; ++i) {
+		http_response_cache_release(cache->entries[i]);
+	}
+
+	// no request uses the cache anymore, so no flight can be running
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_FLIGHTS; ++i) {
+		if(cache->flights[i] != NULL) {
+			free_sized_buffer(cache->flights[i]->key);
+			free(cache->flights[i]);
+		}
+	}
+
+	int result = pthread_cond_destroy(&cache->flight_finished);
+	CHECK_FOR_THREAD_ERROR(result,
+	                       "An Error occurred while trying to destroy the condition in the "
+	                       "response cache",
+	                       {});
+
+	result = pthread_mutex_destroy(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(result,
+	                       "An Error occurred while trying to destroy the mutex in the "
+	                       "response cache",
+	                       {});
+
+	free(cache);
+}
+
+NODISCARD bool http_response_cache_is_cacheable_request(const HttpRequest http_request) {
+	const HTTPRequestMethod method = http_request.head.request_line.method;
+
+	return method == HTTPRequestMethodGet || method == HTTPRequestMethodHead;
+}
+
+// every part is prefixed by its length, so that values containing separators can't produce the
+// same key as other values
+static void append_http_response_cache_key_part(StringBuilder* const string_builder,
+                                                const ReadonlyBuffer part) {
+	STRING_BUILDER_APPENDF(string_builder, return;, "%zu:", part.size);
+	string_builder_append_buffer(string_builder, part);
+}
+
+NODISCARD SizedBuffer http_response_cache_get_key(const HTTPResponseCache* const cache,
+                                                  const HttpRequest http_request,
+                                                  const ParsedURLPath path) {
+
+	StringBuilder* string_builder = string_builder_init();
+
+	if(string_builder == NULL) {
+		return get_empty_sized_buffer();
+	}
+
+	// HEAD responses are the GET responses without the body, so they share the entry
+	const char* const method = get_http_method_string(HTTPRequestMethodGet);
+
+	append_http_response_cache_key_part(string_builder,
+	                                    (ReadonlyBuffer){ .data = method, .size = strlen(method) });
+
+	append_http_response_cache_key_part(string_builder, readonly_buffer_from_tstr(&path.path));
+
+	if(cache->options.query_keys != NULL) {
+		for(const char* const* query_key = cache->options.query_keys; *query_key != NULL;
+		    ++query_key) {
+
+			const ParsedSearchPathEntry* entry = find_search_key(
+			    path.search_path, (tstr_static){ .ptr = *query_key, .len = strlen(*query_key) });
+
+			if(entry == NULL) {
+				string_builder_append_single(string_builder, "-");
+				continue;
+			}
+
+			append_http_response_cache_key_part(string_builder,
+			                                    readonly_buffer_from_tstr(&(entry->value.val)));
+		}
+	}
+
+	if(cache->options.vary_headers != NULL) {
+		for(const char* const* vary_header = cache->options.vary_headers; *vary_header != NULL;
+		    ++vary_header) {
+
+			const tstr_static header_name = { .ptr = *vary_header, .len = strlen(*vary_header) };
+
+			const HttpHeaderField* header =
+			    find_header_by_key(http_request.head.header_fields, header_name);
+
+			if(header == NULL) {
+				string_builder_append_single(string_builder, "-");
+				continue;
+			}
+
+			append_http_response_cache_key_part(string_builder,
+			                                    readonly_buffer_from_tstr(&(header->value)));
+		}
+	}
+
+	return string_builder_release_into_sized_buffer(&string_builder);
+}
+
+NODISCARD static uint64_t get_http_response_cache_now_ms(void) {
+	Time now;
+
+	if(!get_coarse_monotonic_time(&now)) {
+		return 0;
+	}
+
+	return get_time_in_milli_seconds(now);
+}
+
+// has to be called with the mutex locked, the slot is empty afterwards
+static void evict_http_response_cache_slot(HTTPResponseCache* const cache, const size_t index) {
+	http_response_cache_release(cache->entries[index]);
+	cache->entries[index] = NULL;
+}
+
+// has to be called with the mutex locked, returns an acquired entry
+NODISCARD static HTTPResponseCacheEntry*
+find_http_response_cache_entry(HTTPResponseCache* const cache, const SizedBuffer key,
+                               const CompressionType format) {
+
+	const uint64_t now_ms = get_http_response_cache_now_ms();
+
+	HTTPResponseCacheEntry* found = NULL;
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_ENTRIES; ++i) {
+		HTTPResponseCacheEntry* entry = cache->entries[i];
+
+		if(entry == NULL) {
+			continue;
+		}
+
+		// expired entries are evicted lazily
+		if(entry->expires_at_ms <= now_ms) {
+			evict_http_response_cache_slot(cache, i);
+			continue;
+		}
+
+		if(sized_buffer_eq(entry->key, key)) {
+			// a missing format is a miss, the next put then builds the entry for both formats
+			if(prebuilt_http_response_has_format(entry->response, format)) {
+				atomic_fetch_add_explicit(&entry->references, 1, memory_order_relaxed);
+				found = entry;
+			}
+			break;
+		}
+	}
+
+	return found;
+}
+
+NODISCARD HTTPResponseCacheEntry* http_response_cache_get(HTTPResponseCache* const cache,
+                                                          const SizedBuffer key,
+                                                          const CompressionType format) {
+
+	if(cache == NULL || key.data == NULL) {
+		return NULL;
+	}
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the response cache",
+	    return NULL;);
+
+	HTTPResponseCacheEntry* found = find_http_response_cache_entry(cache, key, format);
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the response cache", {});
+
+	return found;
+}
+
+// has to be called with the mutex locked, returns NULL, if all flight slots are used or on error
+NODISCARD static HTTPResponseCacheFlight*
+start_http_response_cache_flight(HTTPResponseCache* const cache, const SizedBuffer key,
+                                 const CompressionType format) {
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_FLIGHTS; ++i) {
+		if(cache->flights[i] != NULL) {
+			continue;
+		}
+
+		HTTPResponseCacheFlight* flight = malloc(sizeof(HTTPResponseCacheFlight));
+
+		if(!flight) {
+			return NULL;
+		}
+
+		*flight = (HTTPResponseCacheFlight){
+			.key = sized_buffer_dup(key),
+			.formats = PREBUILT_FORMAT_BIT(format),
+			.finished = false,
+			.references = 1,
+		};
+
+		if(flight->key.data == NULL) {
+			free(flight);
+			return NULL;
+		}
+
+		cache->flights[i] = flight;
+
+		return flight;
+	}
+
+	return NULL;
+}
+
+// has to be called with the mutex locked
+static void release_http_response_cache_flight(HTTPResponseCacheFlight* const flight) {
+
+	--(flight->references);
+
+	if(flight->references == 0 && flight->finished) {
+		free_sized_buffer(flight->key);
+		free(flight);
+	}
+}
+
+// has to be called with the mutex locked, returns false, if the flight didn't finish in time
+NODISCARD static bool wait_for_http_response_cache_flight(HTTPResponseCache* const cache,
+                                                          const HTTPResponseCacheFlight* flight) {
+
+	struct timespec deadline = {};
+	clock_gettime(CLOCK_REALTIME, &deadline);
+
+	deadline.tv_sec += (time_t)(HTTP_RESPONSE_CACHE_MAX_FLIGHT_WAIT_MS / S_TO_MS_RATE);
+	deadline.tv_nsec +=
+	    S_TO_NS(HTTP_RESPONSE_CACHE_MAX_FLIGHT_WAIT_MS % S_TO_MS_RATE, long) / S_TO_MS_RATE;
+
+	if(deadline.tv_nsec >= S_TO_NS(1, long)) {
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= S_TO_NS(1, long);
+	}
+
+	while(!flight->finished) {
+		const int result =
+		    pthread_cond_timedwait(&cache->flight_finished, &cache->mutex, &deadline);
+
+		if(result == ETIMEDOUT) {
+			return flight->finished;
+		}
+
+		if(result != 0) {
+			LOG_MESSAGE(LogLevelError,
+			            "An Error occurred while waiting for a flight of the response cache: %s\n",
+			            strerror(result));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+NODISCARD HTTPResponseCacheEntry*
+http_response_cache_get_or_join(HTTPResponseCache* const cache, const SizedBuffer key,
+                                const CompressionType format,
+                                HTTPResponseCacheFlight** const flight) {
+
+	*flight = NULL;
+
+	if(cache == NULL || !cache->options.coalesce) {
+		return http_response_cache_get(cache, key, format);
+	}
+
+	if(key.data == NULL) {
+		return NULL;
+	}
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the response cache",
+	    return NULL;);
+
+	HTTPResponseCacheEntry* found = find_http_response_cache_entry(cache, key, format);
+
+	if(found == NULL) {
+		HTTPResponseCacheFlight* running = NULL;
+
+		for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_FLIGHTS; ++i) {
+			if(cache->flights[i] != NULL && sized_buffer_eq(cache->flights[i]->key, key)) {
+				running = cache->flights[i];
+				break;
+			}
+		}
+
+		if(running == NULL) {
+			*flight = start_http_response_cache_flight(cache, key, format);
+		} else {
+			running->formats |= PREBUILT_FORMAT_BIT(format);
+			++(running->references);
+
+			// on a timeout or an uncached response, this is a miss, so the route gets executed
+			if(wait_for_http_response_cache_flight(cache, running)) {
+				found = find_http_response_cache_entry(cache, key, format);
+			}
+
+			release_http_response_cache_flight(running);
+		}
+	}
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the response cache", {});
+
+	return found;
+}
+
+// has to be called with the mutex locked
+static void finish_http_response_cache_flight(HTTPResponseCache* const cache,
+                                              HTTPResponseCacheFlight* const flight) {
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_FLIGHTS; ++i) {
+		if(cache->flights[i] == flight) {
+			cache->flights[i] = NULL;
+			break;
+		}
+	}
+
+	flight->finished = true;
+
+	int result = pthread_cond_broadcast(&cache->flight_finished);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to signal the condition for the response cache",
+	    {});
+
+	release_http_response_cache_flight(flight);
+}
+
+void http_response_cache_abandon_flight(HTTPResponseCache* const cache,
+                                        HTTPResponseCacheFlight* const flight) {
+
+	if(cache == NULL || flight == NULL) {
+		return;
+	}
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the response cache",
+	    return;);
+
+	finish_http_response_cache_flight(cache, flight);
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the response cache", {});
+}
+
+// the waiters can join, until the entry is built, so their formats are read as late as possible
+NODISCARD static PrebuiltFormatMask
+get_http_response_cache_flight_formats(HTTPResponseCache* const cache,
+                                       const HTTPResponseCacheFlight* const flight) {
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the response cache",
+	    return 0;);
+
+	const PrebuiltFormatMask formats = flight->formats;
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the response cache", {});
+
+	return formats;
+}
+
+NODISCARD HTTPResponseCacheEntry*
+http_response_cache_put(HTTPResponseCache* const cache,
+                        SizedBuffer key, // NOLINT(totto-function-passing-type)
+                        const HttpStatusCode status, const tstr mime_type,
+                        const ReadonlyBuffer body, const CompressionType format,
+                        HTTPResponseCacheFlight* const flight) {
+
+	if(cache == NULL || key.data == NULL) {
+		http_response_cache_abandon_flight(cache, flight);
+		free_sized_buffer(key);
+		return NULL;
+	}
+
+	PrebuiltFormatMask format_mask = PREBUILT_FORMAT_BIT(format);
+
+	if(flight != NULL) {
+		format_mask |= get_http_response_cache_flight_formats(cache, flight);
+	}
+
+	{
+		// keep the formats of the current entry, so that alternating encodings don't evict each
+		// other
+		HTTPResponseCacheEntry* current = http_response_cache_get(cache, key, CompressionTypeNone);
+
+		if(current != NULL) {
+			format_mask |= prebuilt_http_response_get_format_mask(current->response);
+			http_response_cache_release(current);
+		}
+	}
+
+	// compressing is done without holding the lock
+	PrebuiltHttpResponse* response =
+	    build_prebuilt_http_response_for_formats(status, mime_type, body, format_mask);
+
+	if(response == NULL) {
+		http_response_cache_abandon_flight(cache, flight);
+		free_sized_buffer(key);
+		return NULL;
+	}
+
+	HTTPResponseCacheEntry* entry = malloc(sizeof(HTTPResponseCacheEntry));
+
+	if(!entry) {
+		http_response_cache_abandon_flight(cache, flight);
+		free_prebuilt_http_response(response);
+		free_sized_buffer(key);
+		return NULL;
+	}
+
+	entry->key = key;
+	entry->response = response;
+	entry->expires_at_ms = get_http_response_cache_now_ms() + cache->options.ttl_ms;
+	// one for the cache and one for the caller
+	atomic_init(&entry->references, 2);
+
+	int result = pthread_mutex_lock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the response cache", {
+		    // the entry is still usable for this response, it is just not cached
+		    atomic_store_explicit(&entry->references, 1, memory_order_relaxed);
+		    http_response_cache_abandon_flight(cache, flight);
+		    return entry;
+	    });
+
+	size_t slot = HTTP_RESPONSE_CACHE_MAX_ENTRIES;
+	size_t oldest_slot = 0;
+	const HTTPResponseCacheEntry* oldest = NULL;
+
+	for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_ENTRIES; ++i) {
+		HTTPResponseCacheEntry* current = cache->entries[i];
+
+		if(current == NULL) {
+			if(slot == HTTP_RESPONSE_CACHE_MAX_ENTRIES) {
+				slot = i;
+			}
+			continue;
+		}
+
+		if(sized_buffer_eq(current->key, entry->key)) {
+			slot = i;
+			break;
+		}
+
+		if(oldest == NULL || current->expires_at_ms < oldest->expires_at_ms) {
+			oldest = current;
+			oldest_slot = i;
+		}
+	}
+
+	if(slot == HTTP_RESPONSE_CACHE_MAX_ENTRIES) {
+		// full, the entry, that expires first, is the oldest one, as all have the same ttl
+		slot = oldest_slot;
+	}
+
+	evict_http_response_cache_slot(cache, slot);
+	cache->entries[slot] = entry;
+
+	// the entry is in the cache, so the waiters find it
+	if(flight != NULL) {
+		finish_http_response_cache_flight(cache, flight);
+	}
+
+	result = pthread_mutex_unlock(&cache->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the response cache", {});
+
+	return entry;
+}
+
+NODISCARD const PrebuiltHttpResponse*
+http_response_cache_entry_get_response(const HTTPResponseCacheEntry* const entry) {
+	return entry->response;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "./protocol.h"
+#include "./send.h"
+#include "utils/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a short lived cache in front of route executors, so that bursts of the same request only execute
+// the route once per ttl, it stores the final response as prebuilt response, so hits also don't
+// compress anything
+// routes opt in per route, a ttl of 0 disables the cache for that route
+typedef struct {
+	uint32_t ttl_ms;
+	// the query parameters, that are part of the key, all others are ignored, NULL terminated
+	const char* const* query_keys;
+	// the request header fields, that select different responses, NULL terminated
+	const char* const* vary_headers;
+	// concurrent misses for the same key wait for the first request, that executes the route, and
+	// share its entry, instead of all executing the route (single flight)
+	bool coalesce;
+} HTTPResponseCacheOptions;
+
+// the ttl gets clamped to this range, this is only meant for absorbing bursts
+#define HTTP_RESPONSE_CACHE_MIN_TTL_MS 100
+
+#define HTTP_RESPONSE_CACHE_MAX_TTL_MS 5000
+
+#define HTTP_RESPONSE_CACHE_MAX_ENTRIES 64
+
+// keys, that are executed at the same time with coalescing, further keys aren't coalesced
+#define HTTP_RESPONSE_CACHE_MAX_FLIGHTS 16
+
+// a waiting request blocks its worker, so it executes the route itself after this
+#define HTTP_RESPONSE_CACHE_MAX_FLIGHT_WAIT_MS 2000
+
+typedef struct HTTPResponseCacheImpl HTTPResponseCache;
+
+typedef struct HTTPResponseCacheEntryImpl HTTPResponseCacheEntry;
+
+// a running execution of a route for a key, that other requests with the same key wait for
+typedef struct HTTPResponseCacheFlightImpl HTTPResponseCacheFlight;
+
+// returns NULL, if the options don't enable the cache
+NODISCARD HTTPResponseCache* initialize_http_response_cache(HTTPResponseCacheOptions options);
+
+void free_http_response_cache(HTTPResponseCache* cache);
+
+// only responses to GET and HEAD requests are looked up, HEAD requests use the GET entries
+NODISCARD bool http_response_cache_is_cacheable_request(HttpRequest http_request);
+
+// the key consists of the method, the path, the configured query parameters and the configured
+// request header fields, returns an empty buffer on error
+NODISCARD SizedBuffer http_response_cache_get_key(const HTTPResponseCache* cache,
+                                                  HttpRequest http_request, ParsedURLPath path);
+
+// returns an acquired entry, that has to be released, or NULL, if there is no entry, that is still
+// valid and was built for the given format
+NODISCARD HTTPResponseCacheEntry* http_response_cache_get(HTTPResponseCache* cache,
+                                                          SizedBuffer key, CompressionType format);
+
+// the same as http_response_cache_get, but with coalescing, a miss waits for a running flight with
+// the same key and looks up the entry again afterwards, if no flight is running, the caller starts
+// one, then flight is set and has to be passed to http_response_cache_put or
+// http_response_cache_abandon_flight after executing the route
+NODISCARD HTTPResponseCacheEntry*
+http_response_cache_get_or_join(HTTPResponseCache* cache, SizedBuffer key, CompressionType format,
+                                OUT_PARAM(HTTPResponseCacheFlight*) flight);
+
+// replaces an existing entry with the same key, the formats of that entry and the formats, that the
+// waiters of the flight want, are kept, the key is moved into the cache, the body is copied, the
+// flight may be NULL and is finished in any case, returns an acquired entry or NULL on error
+NODISCARD HTTPResponseCacheEntry*
+http_response_cache_put(HTTPResponseCache* cache,
+                        MOVED(SizedBuffer) key, // NOLINT(totto-function-passing-type)
+                        HttpStatusCode status, tstr mime_type, ReadonlyBuffer body,
+                        CompressionType format, HTTPResponseCacheFlight* flight);
+
+// for responses, that aren't cached, the waiters then execute the route themselves, the flight may
+// be NULL
+void http_response_cache_abandon_flight(HTTPResponseCache* cache, HTTPResponseCacheFlight* flight);
+
+NODISCARD const PrebuiltHttpResponse*
+http_response_cache_entry_get_response(const HTTPResponseCacheEntry* entry);
+
+void http_response_cache_release(HTTPResponseCacheEntry* entry);
+
+#ifdef __cplusplus
+}
+#endif
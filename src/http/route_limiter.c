@@ -0,0 +1,221 @@
+#include "./route_limiter.h"
+#include "./header.h"
+#include "./mime.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+struct HTTPRouteLimiterImpl {
+	uint32_t max_concurrent;
+	uint32_t max_waiting;
+	uint32_t max_wait_ms;
+	pthread_mutex_t mutex;
+	// signalled, when a slot gets free
+	pthread_cond_t released;
+	uint32_t active;
+	uint32_t waiting;
+	// NULL, if registering the metrics failed
+	MetricsGauge* active_gauge;
+	MetricsGauge* waiting_gauge;
+	MetricsCounter* rejected_counter;
+};
+
+NODISCARD HTTPRouteLimiter*
+initialize_http_route_limiter(const char* const route_path,
+                              const HTTPRouteConcurrencyOptions options) {
+
+	if(options.max_concurrent == 0) {
+		return NULL;
+	}
+
+	HTTPRouteLimiter* limiter = malloc(sizeof(HTTPRouteLimiter));
+
+	if(limiter == NULL) {
+		return NULL;
+	}
+
+	uint32_t max_wait_ms =
+	    options.max_wait_ms == 0 ? HTTP_ROUTE_LIMITER_DEFAULT_WAIT_MS : options.max_wait_ms;
+
+	if(max_wait_ms > HTTP_ROUTE_LIMITER_MAX_WAIT_MS) {
+		max_wait_ms = HTTP_ROUTE_LIMITER_MAX_WAIT_MS;
+	}
+
+	*limiter = (HTTPRouteLimiter){
+		.max_concurrent = options.max_concurrent,
+		.max_waiting = options.max_waiting,
+		.max_wait_ms = max_wait_ms,
+		.active = 0,
+		.waiting = 0,
+		.active_gauge = NULL,
+		.waiting_gauge = NULL,
+		.rejected_counter = NULL,
+	};
+
+	int result = pthread_mutex_init(&limiter->mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the mutex for the route limiter",
+	    free(limiter);
+	    return NULL;);
+
+	result = pthread_cond_init(&limiter->released, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the condition for the route limiter",
+	    pthread_mutex_destroy(&limiter->mutex);
+	    free(limiter);
+	    return NULL;);
+
+	const MetricsLabel label = { .name = "route", .value = route_path };
+	const MetricsLabels labels = { .labels = &label, .label_amount = 1 };
+
+	// a failed registration only means, that this metric is missing
+	limiter->active_gauge = metrics_register_gauge(
+	    "http_route_executions", "The amount of requests, that currently execute the route",
+	    labels);
+
+	limiter->waiting_gauge = metrics_register_gauge(
+	    "http_route_waiting", "The amount of requests, that wait for a free slot of the route",
+	    labels);
+
+	limiter->rejected_counter = metrics_register_counter(
+	    "http_route_rejected_total",
+	    "The amount of requests, that were rejected, as the route was at its concurrency limit",
+	    labels);
+
+	return limiter;
+}
+
+void free_http_route_limiter(HTTPRouteLimiter* const limiter) {
+
+	if(limiter == NULL) {
+		return;
+	}
+
+	pthread_cond_destroy(&limiter->released);
+	pthread_mutex_destroy(&limiter->mutex);
+
+	free(limiter);
+}
+
+// has to be called with the mutex locked, returns false, if no slot got free in time, a request,
+// that arrives, while the mutex is unlocked in the wait, can take the slot first
+NODISCARD static bool wait_for_http_route_limiter_slot(HTTPRouteLimiter* const limiter) {
+
+	struct timespec deadline = {};
+	clock_gettime(CLOCK_REALTIME, &deadline);
+
+	deadline.tv_sec += (time_t)(limiter->max_wait_ms / S_TO_MS_RATE);
+	deadline.tv_nsec += S_TO_NS(limiter->max_wait_ms % S_TO_MS_RATE, long) / S_TO_MS_RATE;
+
+	if(deadline.tv_nsec >= S_TO_NS(1, long)) {
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= S_TO_NS(1, long);
+	}
+
+	while(limiter->active >= limiter->max_concurrent) {
+		const int result =
+		    pthread_cond_timedwait(&limiter->released, &limiter->mutex, &deadline);
+
+		if(result == ETIMEDOUT) {
+			return limiter->active < limiter->max_concurrent;
+		}
+
+		if(result != 0) {
+			LOG_MESSAGE(LogLevelError,
+			            "An Error occurred while waiting for a slot of the route limiter: %s\n",
+			            strerror(result));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+NODISCARD bool http_route_limiter_acquire(HTTPRouteLimiter* const limiter) {
+
+	if(limiter == NULL) {
+		return true;
+	}
+
+	int result = pthread_mutex_lock(&limiter->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the route limiter",
+	    return true;);
+
+	bool acquired = false;
+
+	if(limiter->active < limiter->max_concurrent) {
+		acquired = true;
+	} else if(limiter->waiting < limiter->max_waiting) {
+		++(limiter->waiting);
+		metrics_gauge_add(limiter->waiting_gauge, 1);
+
+		acquired = wait_for_http_route_limiter_slot(limiter);
+
+		--(limiter->waiting);
+		metrics_gauge_add(limiter->waiting_gauge, -1);
+	}
+
+	if(acquired) {
+		++(limiter->active);
+	}
+
+	result = pthread_mutex_unlock(&limiter->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the route limiter", {});
+
+	if(acquired) {
+		metrics_gauge_add(limiter->active_gauge, 1);
+	} else {
+		metrics_counter_increment(limiter->rejected_counter);
+	}
+
+	return acquired;
+}
+
+void http_route_limiter_release(HTTPRouteLimiter* const limiter) {
+
+	if(limiter == NULL) {
+		return;
+	}
+
+	int result = pthread_mutex_lock(&limiter->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the route limiter", return;);
+
+	if(limiter->active > 0) {
+		--(limiter->active);
+	}
+
+	// only one slot got free, so waking up one waiter is enough
+	result = pthread_cond_signal(&limiter->released);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to signal the condition for the route limiter",
+	    {});
+
+	result = pthread_mutex_unlock(&limiter->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the route limiter", {});
+
+	metrics_gauge_add(limiter->active_gauge, -1);
+}
+
+NODISCARD HTTPResponseToSend get_http_route_limiter_busy_response(const bool send_body) {
+
+	HttpHeaderFields additional_headers = TVEC_EMPTY(HttpHeaderField);
+
+	add_http_header_field(&additional_headers,
+	                      tstr_from_static_tstr(HTTP_HEADER_NAME(retry_after)),
+	                      TSTR_LIT(HTTP_ROUTE_LIMITER_RETRY_AFTER_S));
+
+	return (HTTPResponseToSend){ .status = HttpStatusServiceUnavailable,
+		                         .body = http_response_body_from_static_string(
+		                             "Service Unavailable: the route is busy", send_body),
+		                         .mime_type = MIME_TYPE_TEXT,
+		                         .additional_headers = additional_headers };
+}
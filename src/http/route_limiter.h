@@ -0,0 +1,53 @@
+#pragma once
+
+#include "./send.h"
+#include "utils/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// limits the concurrent executions of a route, so that a slow route can't occupy all workers,
+// while cheap routes starve, requests over the limit wait briefly for a free slot, if the wait
+// queue isn't full, otherwise they are rejected at once
+// the wait queue is not FIFO, a new request takes a free slot, before the waiting requests are
+// woken up, and a free slot wakes up an arbitrary waiter, so a waiter can time out, even if slots
+// got free in the meantime
+// routes opt in per route, a max_concurrent of 0 disables the limit for that route
+typedef struct {
+	uint32_t max_concurrent;
+	// requests, that may wait for a free slot at the same time, 0 means, that no request waits
+	uint32_t max_waiting;
+	// 0 means HTTP_ROUTE_LIMITER_DEFAULT_WAIT_MS
+	uint32_t max_wait_ms;
+} HTTPRouteConcurrencyOptions;
+
+#define HTTP_ROUTE_LIMITER_DEFAULT_WAIT_MS 100
+
+// the wait gets clamped to this, a waiting request blocks its worker
+#define HTTP_ROUTE_LIMITER_MAX_WAIT_MS 1000
+
+typedef struct HTTPRouteLimiterImpl HTTPRouteLimiter;
+
+// the gauges and counters are registered with the route path as label, returns NULL, if the
+// options don't enable the limit or on error
+NODISCARD HTTPRouteLimiter* initialize_http_route_limiter(const char* route_path,
+                                                          HTTPRouteConcurrencyOptions options);
+
+void free_http_route_limiter(HTTPRouteLimiter* limiter);
+
+// returns true, if the request may execute the route, then the slot has to be released with
+// http_route_limiter_release, a NULL limiter allows every request
+NODISCARD bool http_route_limiter_acquire(HTTPRouteLimiter* limiter);
+
+void http_route_limiter_release(HTTPRouteLimiter* limiter);
+
+// a busy route is only busy for a short time, so the client can retry soon
+#define HTTP_ROUTE_LIMITER_RETRY_AFTER_S "1"
+
+// the 503 response for requests, that didn't get a slot, with a Retry-After header
+NODISCARD HTTPResponseToSend get_http_route_limiter_busy_response(bool send_body);
+
+#ifdef __cplusplus
+}
+#endif
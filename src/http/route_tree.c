@@ -0,0 +1,400 @@
+#include "./route_tree.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+// get and post, head requests are matched by get routes
+#define HTTP_ROUTE_TREE_METHOD_COUNT 2
+
+typedef struct HTTPRouteTreeNodeImpl HTTPRouteTreeNode;
+
+TVEC_DEFINE_AND_IMPLEMENT_VEC_TYPE_EXTENDED(HTTPRouteTreeNode*, HTTPRouteTreeNodePtr)
+
+struct HTTPRouteTreeNodeImpl {
+	// the static part of the path, that this node consumes, it is empty for the root and for
+	// parameter nodes, the labels are views into the route definitions
+	tstr_view label;
+	// the labels of the children start with distinct characters
+	TVEC_TYPENAME(HTTPRouteTreeNodePtr) children;
+	// matches exactly one non-empty path segment
+	HTTPRouteTreeNode* param_child;
+	// route indices per method, for routes that end at this node
+	size_t exact_routes[HTTP_ROUTE_TREE_METHOD_COUNT];
+	size_t prefix_routes[HTTP_ROUTE_TREE_METHOD_COUNT];
+};
+
+typedef struct {
+	tstr_view names[HTTP_ROUTE_TREE_MAX_PARAMS];
+	size_t count;
+} HTTPRouteTreeParamNames;
+
+struct HTTPRouteTreeImpl {
+	HTTPRouteTreeNode* root;
+	// indexed by the route index
+	HTTPRouteTreeParamNames* param_names;
+	size_t route_count;
+};
+
+NODISCARD static HTTPRouteTreeNode* new_http_route_tree_node(const tstr_view label) {
+	HTTPRouteTreeNode* node = malloc(sizeof(HTTPRouteTreeNode));
+
+	if(node == NULL) {
+		return NULL;
+	}
+
+	*node = (HTTPRouteTreeNode){
+		.label = label,
+		.children = TVEC_EMPTY(HTTPRouteTreeNodePtr),
+		.param_child = NULL,
+		.exact_routes = { HTTP_ROUTE_TREE_NO_ROUTE, HTTP_ROUTE_TREE_NO_ROUTE },
+		.prefix_routes = { HTTP_ROUTE_TREE_NO_ROUTE, HTTP_ROUTE_TREE_NO_ROUTE },
+	};
+
+	return node;
+}
+
+static void free_http_route_tree_node(HTTPRouteTreeNode* node) {
+	if(node == NULL) {
+		return;
+	}
+
+	for(size_t i = 0; i < TVEC_LENGTH(HTTPRouteTreeNodePtr, node->children); ++i) {
+		free_http_route_tree_node(TVEC_AT(HTTPRouteTreeNodePtr, node->children, i));
+	}
+
+	TVEC_FREE(HTTPRouteTreeNodePtr, &(node->children));
+
+	free_http_route_tree_node(node->param_child);
+
+	free(node);
+}
+
+NODISCARD static tstr_view tstr_view_slice(const tstr_view view, const size_t start,
+                                           const size_t len) {
+	return (tstr_view){ .data = view.data + start, .len = len };
+}
+
+NODISCARD static size_t get_common_prefix_length(const tstr_view view1, const tstr_view view2) {
+	const size_t max_len = view1.len < view2.len ? view1.len : view2.len;
+
+	size_t i = 0;
+	for(; i < max_len; ++i) {
+		if(view1.data[i] != view2.data[i]) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+// returns the node, that ends exactly after the given static text, edges are split as needed
+NODISCARD static HTTPRouteTreeNode* insert_static_text(HTTPRouteTreeNode* node, tstr_view text) {
+
+	while(text.len > 0) {
+		HTTPRouteTreeNode* next = NULL;
+		size_t next_index = 0;
+
+		for(size_t i = 0; i < TVEC_LENGTH(HTTPRouteTreeNodePtr, node->children); ++i) {
+			HTTPRouteTreeNode* child = TVEC_AT(HTTPRouteTreeNodePtr, node->children, i);
+
+			if(child->label.data[0] == text.data[0]) {
+				next = child;
+				next_index = i;
+				break;
+			}
+		}
+
+		if(next == NULL) {
+			HTTPRouteTreeNode* new_node = new_http_route_tree_node(text);
+
+			if(new_node == NULL) {
+				return NULL;
+			}
+
+			const TvecResult push_res =
+			    TVEC_PUSH(HTTPRouteTreeNodePtr, &(node->children), new_node);
+
+			if(push_res != TvecResultOk) {
+				free_http_route_tree_node(new_node);
+				return NULL;
+			}
+
+			return new_node;
+		}
+
+		const size_t common_length = get_common_prefix_length(next->label, text);
+
+		if(common_length < next->label.len) {
+			// split the edge, so that the common part gets its own node
+			HTTPRouteTreeNode* split_node =
+			    new_http_route_tree_node(tstr_view_slice(next->label, 0, common_length));
+
+			if(split_node == NULL) {
+				return NULL;
+			}
+
+			const TvecResult push_res =
+			    TVEC_PUSH(HTTPRouteTreeNodePtr, &(split_node->children), next);
+
+			if(push_res != TvecResultOk) {
+				free_http_route_tree_node(split_node);
+				return NULL;
+			}
+
+			next->label =
+			    tstr_view_slice(next->label, common_length, next->label.len - common_length);
+
+			auto _ = TVEC_SET_AT(HTTPRouteTreeNodePtr, &(node->children), next_index, split_node);
+			UNUSED(_);
+
+			next = split_node;
+		}
+
+		node = next;
+		text = tstr_view_slice(text, common_length, text.len - common_length);
+	}
+
+	return node;
+}
+
+NODISCARD static bool insert_http_route(HTTPRouteTree* const tree, const HTTPRoute route,
+                                        const size_t route_index) {
+
+	if(route.method >= HTTP_ROUTE_TREE_METHOD_COUNT) {
+		return false;
+	}
+
+	HTTPRouteTreeNode* node = tree->root;
+	HTTPRouteTreeParamNames* const names = &(tree->param_names[route_index]);
+
+	// a route without a path matches everything, so it is a prefix route of the root
+	const bool is_prefix_route =
+	    route.path.data == NULL || route.path.type == HTTPRoutePathTypeStartsWith;
+
+	if(route.path.data != NULL) {
+		const tstr_view path = tstr_view_from(route.path.data);
+
+		size_t static_start = 0;
+
+		for(size_t i = 0; i <= path.len;) {
+
+			// parameters always start a segment
+			const bool is_param_start =
+			    i < path.len && i > 0 && path.data[i] == ':' && path.data[i - 1] == '/';
+
+			if(i < path.len && !is_param_start) {
+				++i;
+				continue;
+			}
+
+			if(i > static_start) {
+				node = insert_static_text(node, tstr_view_slice(path, static_start,
+				                                                 i - static_start));
+
+				if(node == NULL) {
+					return false;
+				}
+			}
+
+			if(i == path.len) {
+				break;
+			}
+
+			size_t name_end = i + 1;
+			while(name_end < path.len && path.data[name_end] != '/') {
+				++name_end;
+			}
+
+			if(names->count >= HTTP_ROUTE_TREE_MAX_PARAMS) {
+				LOG_MESSAGE(LogLevelError, "Route '%s' has too many parameters\n",
+				            route.path.data);
+				return false;
+			}
+
+			names->names[names->count] = tstr_view_slice(path, i + 1, name_end - i - 1);
+			names->count++;
+
+			if(node->param_child == NULL) {
+				node->param_child = new_http_route_tree_node(tstr_view_slice(path, i, 0));
+
+				if(node->param_child == NULL) {
+					return false;
+				}
+			}
+
+			node = node->param_child;
+
+			i = name_end;
+			static_start = name_end;
+		}
+	}
+
+	size_t* const slot = is_prefix_route ? &(node->prefix_routes[route.method])
+	                                     : &(node->exact_routes[route.method]);
+
+	// earlier routes take precedence, as they did, when the routes were checked in order
+	if(*slot == HTTP_ROUTE_TREE_NO_ROUTE) {
+		*slot = route_index;
+	}
+
+	return true;
+}
+
+NODISCARD HTTPRouteTree* build_http_route_tree(const HTTPRoutesArray routes) {
+
+	HTTPRouteTree* tree = malloc(sizeof(HTTPRouteTree));
+
+	if(tree == NULL) {
+		return NULL;
+	}
+
+	const size_t route_count = TVEC_LENGTH(HTTPRoute, routes);
+
+	*tree = (HTTPRouteTree){
+		.root = new_http_route_tree_node(tstr_view_from("")),
+		.param_names = calloc(route_count == 0 ? 1 : route_count, sizeof(HTTPRouteTreeParamNames)),
+		.route_count = route_count,
+	};
+
+	if(tree->root == NULL || tree->param_names == NULL) {
+		free_http_route_tree(tree);
+		return NULL;
+	}
+
+	for(size_t i = 0; i < route_count; ++i) {
+		const HTTPRoute route = TVEC_AT(HTTPRoute, routes, i);
+
+		if(!insert_http_route(tree, route, i)) {
+			LOG_MESSAGE(LogLevelError, "Couldn't insert route %zu into the route tree\n", i);
+			free_http_route_tree(tree);
+			return NULL;
+		}
+	}
+
+	return tree;
+}
+
+void free_http_route_tree(HTTPRouteTree* tree) {
+	free_http_route_tree_node(tree->root);
+	free(tree->param_names);
+	free(tree);
+}
+
+typedef struct {
+	size_t method;
+	tstr_view values[HTTP_ROUTE_TREE_MAX_PARAMS];
+	size_t value_count;
+	size_t best_route;
+	tstr_view best_values[HTTP_ROUTE_TREE_MAX_PARAMS];
+	size_t best_value_count;
+} HTTPRouteTreeSearch;
+
+static void update_http_route_tree_search(HTTPRouteTreeSearch* const search,
+                                          const size_t route_index) {
+	if(route_index >= search->best_route) {
+		return;
+	}
+
+	search->best_route = route_index;
+	search->best_value_count = search->value_count;
+
+	for(size_t i = 0; i < search->value_count; ++i) {
+		search->best_values[i] = search->values[i];
+	}
+}
+
+// the label of the node is already consumed
+static void find_in_http_route_tree_node(const HTTPRouteTreeNode* const node, const tstr_view rest,
+                                         HTTPRouteTreeSearch* const search) {
+
+	update_http_route_tree_search(search, node->prefix_routes[search->method]);
+
+	if(rest.len == 0) {
+		update_http_route_tree_search(search, node->exact_routes[search->method]);
+		return;
+	}
+
+	// static matches and parameter matches may both lead to a route, so both are tried, the
+	// lowest route index wins
+	for(size_t i = 0; i < TVEC_LENGTH(HTTPRouteTreeNodePtr, node->children); ++i) {
+		const HTTPRouteTreeNode* child = TVEC_AT(HTTPRouteTreeNodePtr, node->children, i);
+
+		if(child->label.data[0] != rest.data[0]) {
+			continue;
+		}
+
+		if(child->label.len <= rest.len &&
+		   memcmp(child->label.data, rest.data, child->label.len) == 0) {
+			find_in_http_route_tree_node(
+			    child, tstr_view_slice(rest, child->label.len, rest.len - child->label.len),
+			    search);
+		}
+
+		break;
+	}
+
+	if(node->param_child == NULL || rest.data[0] == '/' ||
+	   search->value_count >= HTTP_ROUTE_TREE_MAX_PARAMS) {
+		return;
+	}
+
+	size_t segment_length = 0;
+	while(segment_length < rest.len && rest.data[segment_length] != '/') {
+		++segment_length;
+	}
+
+	search->values[search->value_count] = tstr_view_slice(rest, 0, segment_length);
+	search->value_count++;
+
+	find_in_http_route_tree_node(
+	    node->param_child, tstr_view_slice(rest, segment_length, rest.len - segment_length),
+	    search);
+
+	search->value_count--;
+}
+
+NODISCARD size_t http_route_tree_find(const HTTPRouteTree* const tree,
+                                      const HTTPRequestMethod method, const tstr_view path,
+                                      OUT_PARAM(HTTPRouteParams) params) {
+
+	*params = TVEC_EMPTY(HTTPRouteParam);
+
+	HTTPRouteTreeSearch search = {
+		.method = HTTPRequestRouteMethodGet,
+		.value_count = 0,
+		.best_route = HTTP_ROUTE_TREE_NO_ROUTE,
+		.best_value_count = 0,
+	};
+
+	switch(method) {
+		case HTTPRequestMethodGet:
+		case HTTPRequestMethodHead: {
+			search.method = HTTPRequestRouteMethodGet;
+			break;
+		}
+		case HTTPRequestMethodPost: {
+			search.method = HTTPRequestRouteMethodPost;
+			break;
+		}
+		default: {
+			return HTTP_ROUTE_TREE_NO_ROUTE;
+		}
+	}
+
+	find_in_http_route_tree_node(tree->root, path, &search);
+
+	if(search.best_route == HTTP_ROUTE_TREE_NO_ROUTE) {
+		return HTTP_ROUTE_TREE_NO_ROUTE;
+	}
+
+	const HTTPRouteTreeParamNames names = tree->param_names[search.best_route];
+
+	for(size_t i = 0; i < search.best_value_count && i < names.count; ++i) {
+		const HTTPRouteParam param = { .name = names.names[i], .value = search.best_values[i] };
+
+		const TvecResult push_res = TVEC_PUSH(HTTPRouteParam, params, param);
+		OOM_ASSERT(push_res == TvecResultOk, "Vec push error");
+	}
+
+	return search.best_route;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "./protocol.h"
+#include "./routes.h"
+#include "utils/utils.h"
+
+#include <tstr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a compressed radix tree over all route paths, so that a lookup only depends on the length of the
+// requested path and not on the number of routes
+// path segments of the form ":name" match a single segment and are captured as parameter "name"
+typedef struct HTTPRouteTreeImpl HTTPRouteTree;
+
+#define HTTP_ROUTE_TREE_MAX_PARAMS 16
+
+#define HTTP_ROUTE_TREE_NO_ROUTE SIZE_MAX
+
+NODISCARD HTTPRouteTree* build_http_route_tree(HTTPRoutesArray routes);
+
+void free_http_route_tree(HTTPRouteTree* tree);
+
+// returns the index of the first route in the routes array, that matches, as routes are checked in
+// the order they were registered in, or HTTP_ROUTE_TREE_NO_ROUTE if no route matches
+// the captured parameters are views into the route definition and the given path
+NODISCARD size_t http_route_tree_find(const HTTPRouteTree* tree, HTTPRequestMethod method,
+                                      tstr_view path, OUT_PARAM(HTTPRouteParams) params);
+
+#ifdef __cplusplus
+}
+#endif
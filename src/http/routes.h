@@ -3,7 +3,11 @@
 #pragma once
 
 #include "./protocol.h"
+#include "./response_cache.h"
+#include "./route_limiter.h"
 #include "./send.h"
+#include "./server_metrics.h"
+#include "./upstream.h"
 #include "generic/authentication.h"
 #include "generic/ip.h"
 #include "generic/secure.h"
@@ -11,6 +15,10 @@
 
 #include <tvec.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct RouteManagerImpl RouteManager;
 
 /**
@@ -22,6 +30,18 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HTTPRouteFnTypeExecutorAuth,
 } HTTPRouteFnType;
 
+// the captured ":name" segments of the route path, the views are valid as long as the request is
+typedef struct {
+	tstr_view name;
+	tstr_view value;
+} HTTPRouteParam;
+
+TVEC_DEFINE_VEC_TYPE(HTTPRouteParam)
+
+typedef TVEC_TYPENAME(HTTPRouteParam) HTTPRouteParams;
+
+NODISCARD const HTTPRouteParam* find_route_param(const HTTPRouteParams* params, tstr_view name);
+
 typedef HTTPResponseToSend (*HTTPRouteFnExecutor)(ParsedURLPath path, bool send_body);
 
 typedef HTTPResponseToSend (*HTTPRouteFnExecutorAuth)(ParsedURLPath path, AuthUserWithContext user,
@@ -30,7 +50,8 @@ typedef HTTPResponseToSend (*HTTPRouteFnExecutorAuth)(ParsedURLPath path, AuthUs
 typedef HTTPResponseToSend (*HTTPRouteFnExecutorExtended)(SendSettings send_settings,
                                                           const HttpRequest http_request,
                                                           const ConnectionContext* const context,
-                                                          ParsedURLPath path, void* data);
+                                                          ParsedURLPath path,
+                                                          HTTPRouteParams params, void* data);
 
 typedef struct {
 	void* data;
@@ -54,6 +75,8 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HTTPRouteTypeSpecial,
 	HTTPRouteTypeInternal,
 	HTTPRouteTypeServeFolder,
+	HTTPRouteTypeConstant,
+	HTTPRouteTypeReverseProxy,
 } HTTPRouteType;
 
 /**
@@ -62,6 +85,10 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HTTPRouteSpecialDataTypeShutdown = 0,
 	HTTPRouteSpecialDataTypeWs,
+	// issues a session token for the authenticated user, the route needs an authorization
+	HTTPRouteSpecialDataTypeSessionCreate,
+	// revokes the session token of the request, the route needs an authorization
+	HTTPRouteSpecialDataTypeSessionRevoke,
 } HTTPRouteSpecialDataType;
 
 typedef struct {
@@ -72,6 +99,17 @@ typedef struct {
 	HTTPResponseToSend send;
 } HTTPRouteInternal;
 
+// a response, that doesn't depend on the request, it is prebuilt once by
+// route_manager_prebuild_responses, so that sending it doesn't construct or compress anything
+typedef struct {
+	HttpStatusCode status;
+	tstr mime_type;
+	const char* body;
+	// NULL, until the responses are prebuilt or if that failed, then the response gets constructed
+	// on every request
+	PrebuiltHttpResponse* prebuilt;
+} HTTPRouteConstant;
+
 /**
  * @enum value
  */
@@ -95,6 +133,11 @@ typedef struct {
 	tstr folder_path;
 } HTTPRouteServeFolder;
 
+// the request path is forwarded unchanged, the group is owned by whoever creates the route
+typedef struct {
+	HTTPUpstreamGroup* upstreams;
+} HTTPRouteReverseProxy;
+
 /**
  * @enum value
  */
@@ -124,6 +167,8 @@ typedef struct {
 		HTTPRouteInternal internal;
 		HTTPRouteFn normal;
 		HTTPRouteServeFolder serve_folder;
+		HTTPRouteConstant constant;
+		HTTPRouteReverseProxy reverse_proxy;
 	} value;
 } HTTPRouteData;
 
@@ -132,6 +177,13 @@ typedef struct {
 	ParsedURLPath path;
 	const char* original_path;
 	AuthUserWithContext* auth_user;
+	HTTPRouteParams params;
+	// NULL, if the route doesn't use the response cache
+	HTTPResponseCache* response_cache;
+	// NULL, if the metrics of the route couldn't be registered
+	const HTTPRouteMetrics* route_metrics;
+	// NULL, if the route has no concurrency limit
+	HTTPRouteLimiter* route_limiter;
 } HTTPSelectedRoute;
 
 /**
@@ -150,6 +202,7 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	HTTPRoutePathTypeStartsWith,
 } HTTPRoutePathType;
 
+// path segments of the form ":name" match any single segment and are captured as parameters
 typedef struct {
 	HTTPRoutePathType type;
 	const char* data;
@@ -160,6 +213,10 @@ typedef struct {
 	HTTPRoutePath path;
 	HTTPRouteData data;
 	HTTPAuthorization auth;
+	// only used for normal routes, that don't need an authenticated user, zero disables it
+	HTTPResponseCacheOptions cache;
+	// not used for special routes, zero disables it
+	HTTPRouteConcurrencyOptions concurrency;
 } HTTPRoute;
 
 TVEC_DEFINE_VEC_TYPE(HTTPRoute)
@@ -220,19 +277,45 @@ NODISCARD RouteManager* initialize_route_manager(HTTPRoutes* routes,
 
 void free_route_manager(RouteManager* route_manager);
 
+// this needs the global http data and the compression policy, so it is called after initializing
+// them
+void route_manager_prebuild_responses(RouteManager* route_manager);
+
 typedef struct SelectedRouteImpl SelectedRoute;
 
 void free_selected_route(SelectedRoute* selected_route);
 
+// secure means, that the request was received over tls, e.g. session cookies are then only sent
+// back over tls
 NODISCARD SelectedRoute* route_manager_get_route_for_request(const RouteManager* route_manager,
                                                              HttpRequestProperties http_properties,
                                                              HttpRequest request,
-                                                             IPAddress address);
+                                                             IPAddress address, bool secure);
+
+// the token of the session, that authenticates the request, either as bearer or as cookie, the
+// token is a view into the header value
+NODISCARD bool http_request_find_session_token(HttpRequest request,
+                                               OUT_PARAM(tstr_view) session_token);
 
 NODISCARD HTTPSelectedRoute get_selected_route_data(const SelectedRoute* route);
 
 NODISCARD GenericResult route_manager_execute_route(
     const RouteManager* route_manager, HTTPRouteFn route, const ConnectionDescriptor* descriptor,
     HTTPGeneralContext* general_context, SendSettings send_settings, HttpRequest http_request,
-    const ConnectionContext* context, ParsedURLPath path, AuthUserWithContext* auth_user,
-    IPAddress address);
+    const ConnectionContext* context, ParsedURLPath path, HTTPRouteParams params,
+    AuthUserWithContext* auth_user, HTTPResponseCache* response_cache, IPAddress address);
+
+NODISCARD GenericResult route_manager_execute_constant_route(
+    const RouteManager* route_manager, const HTTPRouteConstant* constant,
+    const ConnectionDescriptor* descriptor, HTTPGeneralContext* general_context,
+    SendSettings send_settings, HttpRequest http_request, IPAddress address);
+
+// the response for requests, that didn't match any route
+NODISCARD GenericResult route_manager_send_not_found(const RouteManager* route_manager,
+                                                     const ConnectionDescriptor* descriptor,
+                                                     HTTPGeneralContext* general_context,
+                                                     SendSettings send_settings, bool send_body);
+
+#ifdef __cplusplus
+}
+#endif
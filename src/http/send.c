@@ -1,12 +1,16 @@
 #include "./send.h"
+#include "./compression_policy.h"
 #include "./parser.h"
 #include "generic/send.h"
 #include "http/header.h"
 #include "http/mime.h"
 #include "http/v2.h"
+#include "utils/clock.h"
+#include "utils/offload_pool.h"
 
 typedef struct {
-	StringBuilder* headers;
+	// the status line, the header fields and the empty line, serialized into one buffer
+	SizedBuffer head;
 	SizedBuffer body;
 } Http1ConcattedResponse;
 
@@ -14,8 +18,9 @@ NODISCARD static GenericResult
 send_concatted_http1_response_to_connection(const ConnectionDescriptor* const descriptor,
 
                                             Http1ConcattedResponse* concatted_response) {
-	GenericResult result =
-	    send_string_builder_to_connection(descriptor, &concatted_response->headers);
+	GenericResult result = send_buffer_to_connection(descriptor, concatted_response->head);
+
+	free_sized_buffer(concatted_response->head);
 
 	IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
 		free(concatted_response);
@@ -31,105 +36,66 @@ send_concatted_http1_response_to_connection(const ConnectionDescriptor* const de
 	return result;
 }
 
-// may size of uint61_t is 65535 alias 5 chars, + h2="" => 5 + 1 for 0 byte
-#define SIZE_OF_GLOBAL_ALT_SVC_DATA ((5 + 1) + 5)
-
-// support h2 alt-sv, populate it once, use it after that
-char g_alt_svc_constant_data // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
-    [SIZE_OF_GLOBAL_ALT_SVC_DATA] = { 'h', '2', '=', '"', 0, 0, 0, 0, 0, '"', '\0' };
-
-void global_setup_port_data(uint16_t port) {
-	size_t result =
-	    snprintf(g_alt_svc_constant_data, SIZE_OF_GLOBAL_ALT_SVC_DATA, "h2=\"%u\"", port);
-
-	assert(result <= SIZE_OF_GLOBAL_ALT_SVC_DATA);
-	UNUSED(result);
-}
-
-static bool construct_http1_headers_for_request(
-    SendSettings send_settings, HttpHeaderFields* const result_header_fields, const tstr mime_type,
-    HttpHeaderFields additional_headers, CompressionType compression_format, const SizedBuffer body,
-    const HttpStatusCode status) {
-
-	// add standard fields
-
-	{
-		// MIME TYPE
+// appends the response to the pending output of the connection, it is sent later on, all at once
+NODISCARD static GenericResult
+queue_concatted_http1_response(HTTPGeneralContext* const general_context,
+                               Http1ConcattedResponse* concatted_response) {
 
-		const tstr actual_mime_type =
-		    tstr_is_null(&mime_type) // NOLINT(readability-implicit-bool-conversion)
-		        ? DEFAULT_MIME_TYPE
-		        : mime_type;
+	StringBuilder* const pending_output =
+	    http_general_context_get_pending_http1_output(general_context);
 
-		add_http_header_field(result_header_fields,
-		                      tstr_from_static_tstr(HTTP_HEADER_NAME(content_type)),
-		                      actual_mime_type);
+	if(pending_output == NULL) {
+		free_sized_buffer(concatted_response->head);
+		free(concatted_response);
+		return GENERIC_RES_ERR_UNIQUE();
 	}
 
-	{
-		if(send_settings.protocol_data.version != HTTPProtocolVersion2) {
-			// CONTENT LENGTH
+	GenericResult result = string_builder_append_buffer(
+	    pending_output, readonly_buffer_from_sized_buffer(concatted_response->head));
 
-			char* content_length_buffer = NULL;
-			FORMAT_STRING(&content_length_buffer, return NULL;, "%ld", body.size);
+	free_sized_buffer(concatted_response->head);
 
-			add_http_header_field(result_header_fields,
-			                      tstr_from_static_tstr(HTTP_HEADER_NAME(content_length)),
-			                      tstr_own_cstr(content_length_buffer));
-		}
+	IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
+		free(concatted_response);
+		return result;
 	}
 
-	{
-
-		// Eventual Connection header
-
-		// TODO(Totto): once we support http1.1 keepalive, remove this
-
-		if(send_settings.protocol_data.version != HTTPProtocolVersion2 &&
-		   status != HttpStatusSwitchingProtocols) {
-
-			add_http_header_field(result_header_fields,
-			                      tstr_from_static_tstr(HTTP_HEADER_NAME(connection)),
-			                      TSTR_LIT("close"));
-		}
+	if(concatted_response->body.data != NULL) {
+		result = string_builder_append_buffer(
+		    pending_output, readonly_buffer_from_sized_buffer(concatted_response->body));
 	}
 
-	{
-		// Server
-
-		const tstr server_value = TSTR_LIT("Simple C HTTP Server: v" STRINGIFY(VERSION_STRING));
-
-		add_http_header_field(result_header_fields, tstr_from_static_tstr(HTTP_HEADER_NAME(server)),
-		                      server_value);
-	}
+	free(concatted_response);
 
-	{
-		// Alt-Svc
-		// see: https://datatracker.ietf.org/doc/html/rfc7838
+	return result;
+}
 
-		if(send_settings.protocol_data.version != HTTPProtocolVersion2 &&
-		   status != HttpStatusSwitchingProtocols) {
+// may size of uint61_t is 65535 alias 5 chars, + h2="" => 5 + 1 for 0 byte
+#define SIZE_OF_GLOBAL_ALT_SVC_DATA ((5 + 1) + 5)
 
-			add_http_header_field(result_header_fields,
-			                      tstr_from_static_tstr(HTTP_HEADER_NAME(alt_svc)),
-			                      tstr_from_static_cstr_with_len(g_alt_svc_constant_data,
-			                                                     SIZE_OF_GLOBAL_ALT_SVC_DATA - 1));
-		}
-	}
+// support h2 alt-sv, populate it once, use it after that
+char g_alt_svc_constant_data // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    [SIZE_OF_GLOBAL_ALT_SVC_DATA] = { 'h', '2', '=', '"', 0, 0, 0, 0, 0, '"', '\0' };
 
-	{
+void global_setup_port_data(uint16_t port) {
+	size_t result =
+	    snprintf(g_alt_svc_constant_data, SIZE_OF_GLOBAL_ALT_SVC_DATA, "h2=\"%u\"", port);
 
-		// Content-Encoding
+	assert(result <= SIZE_OF_GLOBAL_ALT_SVC_DATA);
+	UNUSED(result);
+}
 
-		if(compression_format != CompressionTypeNone) {
+#define SERVER_HEADER_VALUE "Simple C HTTP Server: v" STRINGIFY(VERSION_STRING)
 
-			const tstr content_encoding = get_string_for_compress_format(compression_format);
+NODISCARD static tstr get_response_mime_type(const tstr mime_type) {
+	return tstr_is_null(&mime_type) // NOLINT(readability-implicit-bool-conversion)
+	           ? DEFAULT_MIME_TYPE
+	           : mime_type;
+}
 
-			add_http_header_field(result_header_fields,
-			                      tstr_from_static_tstr(HTTP_HEADER_NAME(content_encoding)),
-			                      content_encoding);
-		}
-	}
+// moves the additional header fields into the result, they are freed in any case
+NODISCARD static bool append_additional_header_fields(HttpHeaderFields* const result_header_fields,
+                                                      HttpHeaderFields additional_headers) {
 
 	size_t current_array_size = TVEC_LENGTH(HttpHeaderField, *result_header_fields);
 
@@ -167,10 +133,13 @@ static bool construct_http1_headers_for_request(
 	return true;
 }
 
-static bool construct_http2_headers_for_request(
-    SendSettings send_settings, HttpHeaderFields* const result_header_fields, const tstr mime_type,
-    HttpHeaderFields additional_headers, CompressionType compression_format, const SizedBuffer body,
-    const HttpStatusCode status) {
+// http/1 responses don't use this, their standard header fields are written directly while
+// serializing the head, see Http1StandardHeaders
+static bool construct_http2_headers_for_request(HttpHeaderFields* const result_header_fields,
+                                                const tstr mime_type,
+                                                HttpHeaderFields additional_headers,
+                                                CompressionType compression_format,
+                                                const HttpStatusCode status) {
 
 	*result_header_fields = TVEC_EMPTY(HttpHeaderField);
 
@@ -181,9 +150,20 @@ static bool construct_http2_headers_for_request(
 	                      tstr_from_static_tstr(HTTP_HEADER_NAME(http2_pseudo_status)),
 	                      tstr_own_cstr(status_code_buffer));
 
-	return construct_http1_headers_for_request(send_settings, result_header_fields, mime_type,
-	                                           additional_headers, compression_format, body,
-	                                           status);
+	add_http_header_field(result_header_fields,
+	                      tstr_from_static_tstr(HTTP_HEADER_NAME(content_type)),
+	                      get_response_mime_type(mime_type));
+
+	add_http_header_field(result_header_fields, tstr_from_static_tstr(HTTP_HEADER_NAME(server)),
+	                      TSTR_LIT(SERVER_HEADER_VALUE));
+
+	if(compression_format != CompressionTypeNone) {
+		add_http_header_field(result_header_fields,
+		                      tstr_from_static_tstr(HTTP_HEADER_NAME(content_encoding)),
+		                      get_string_for_compress_format(compression_format));
+	}
+
+	return append_additional_header_fields(result_header_fields, additional_headers);
 }
 
 typedef struct {
@@ -220,15 +200,150 @@ send_http2_response_to_connection(const ConnectionDescriptor* const descriptor,
 	return GENERIC_RES_OK();
 }
 
+// responses, that are sent before the reader exists, are recorded without a route
+NODISCARD static HTTPRequestMetrics
+get_request_metrics(const HTTPGeneralContext* const general_context,
+                    const SendSettings send_settings) {
+
+	if(general_context == NULL) {
+		return get_default_http_request_metrics(send_settings.protocol_data.version);
+	}
+
+	return http_general_context_get_request_metrics(general_context);
+}
+
+typedef struct {
+	SizedBuffer content;
+	CompressionType format;
+	int level;
+	SizedBuffer result;
+} CompressionJob;
+
+static void compression_job_function(ANY_TYPE(CompressionJob*) arg) {
+
+	CompressionJob* const job = (CompressionJob*)arg;
+
+	job->result = compress_buffer_with_level(job->content, job->format, job->level);
+}
+
+// applies the compression policy to the body and compresses it, if that is worth it, the original
+// body is either moved into the result or freed
+NODISCARD static CompressionType compress_response_body(const HTTPResponseToSend* const to_send,
+                                                        const SendSettings send_settings,
+                                                        const HTTPRequestMetrics request_metrics,
+                                                        SizedBuffer* const result_body) {
+
+	const SizedBuffer content = to_send->body.content;
+
+	if(!content.data) {
+		*result_body = content;
+		return CompressionTypeNone;
+	}
+
+	const CompressionDecision decision = compression_policy_decide(
+	    send_settings.compression_to_use, to_send->mime_type, content.size);
+
+	if(decision.format == CompressionTypeNone) {
+		*result_body = content;
+		return CompressionTypeNone;
+	}
+
+	const uint64_t compression_start_us = http_server_metrics_get_timestamp_us();
+
+	// here only supported protocols can be used, otherwise previous checks were wrong
+	CompressionJob job = { .content = content,
+		                   .format = decision.format,
+		                   .level = decision.level,
+		                   .result = { .data = NULL, .size = 0 } };
+
+	if(decision.offload) {
+		const OffloadResult offload_result = offload_run(compression_job_function, &job);
+
+		// compressing it here would block this worker, so the body is just sent uncompressed
+		if(offload_result == OffloadResultRejected) {
+			*result_body = content;
+			return CompressionTypeNone;
+		}
+	} else {
+		compression_job_function(&job);
+	}
+
+	SizedBuffer new_body = job.result;
+
+	http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseCompression,
+	                                  compression_start_us);
+
+	if(!new_body.data) {
+		const tstr str = get_string_for_compress_format(decision.format);
+
+		LOG_MESSAGE(LogLevelError,
+		            "An error occurred while compressing the body with the compression "
+		            "format " TSTR_FMT "\n",
+		            TSTR_FMT_ARGS(str));
+		*result_body = content;
+		return CompressionTypeNone;
+	}
+
+	// incompressible data can get bigger, then just send the original body
+	if(new_body.size >= content.size) {
+		free_sized_buffer(new_body);
+		*result_body = content;
+		return CompressionTypeNone;
+	}
+
+	free_sized_buffer(content);
+	*result_body = new_body;
+	return decision.format;
+}
+
 typedef struct {
-	tstr protocol_version;
-	tstr status_code_str;
-	tstr status_message;
+	HTTPProtocolVersion protocol_version;
+	HttpStatusCode status;
 } Http1ResponseLine;
 
+// headers with numeric values, these are written as decimal numbers while serializing the head,
+// so that they don't need to be formatted into a header field first
+typedef struct {
+	size_t content_length;
+	bool has_keep_alive;
+	uint32_t keep_alive_timeout_s;
+	size_t keep_alive_max;
+} Http1NumericHeaders;
+
+// the header fields, that every http/1 response has, they are written directly while serializing
+// the head, so that no header field has to be allocated per response
+typedef struct {
+	// owned, NULL means the default mime type
+	tstr mime_type;
+	CompressionType content_encoding;
+	// see https://datatracker.ietf.org/doc/html/rfc9112#section-9.6, it is left out for prebuilt
+	// responses, as it depends on the connection
+	bool has_connection;
+	bool keep_alive;
+	// see https://datatracker.ietf.org/doc/html/rfc7838
+	bool has_alt_svc;
+} Http1StandardHeaders;
+
+// Connection and Alt-Svc are not sent with a protocol switch
+NODISCARD static Http1StandardHeaders
+get_http1_standard_headers(const SendSettings send_settings, const tstr mime_type,
+                           const CompressionType compression_format, const HttpStatusCode status,
+                           const bool add_connection_header) {
+	return (Http1StandardHeaders){
+		.mime_type = mime_type,
+		.content_encoding = compression_format,
+		.has_connection = add_connection_header && status != HttpStatusSwitchingProtocols,
+		.keep_alive = send_settings.persistence.type == HttpConnectionPersistenceTypeKeepAlive,
+		.has_alt_svc = status != HttpStatusSwitchingProtocols,
+	};
+}
+
 typedef struct {
 	Http1ResponseLine response_line;
+	Http1StandardHeaders standard_headers;
+	// the additional header fields of the response, they are written after the standard ones
 	HttpHeaderFields header_fields;
+	Http1NumericHeaders numeric_headers;
 } Http1ResponseHead;
 
 typedef struct {
@@ -236,17 +351,11 @@ typedef struct {
 	SizedBuffer body;
 } Http1Response;
 
-static void free_http1_response(Http1Response* response);
-
-#define FREE_AT_END() \
-	do { \
-		free_http1_response(response); \
-	} while(false)
-
 // simple http Response constructor using string builder, headers can be NULL, when header_size is
 // also null!
 NODISCARD static Http1Response* construct_http1_response(HTTPResponseToSend to_send,
-                                                         SendSettings send_settings) {
+                                                         SendSettings send_settings,
+                                                         HTTPRequestMetrics request_metrics) {
 
 	Http1Response* response = (Http1Response*)malloc(sizeof(Http1Response));
 
@@ -256,67 +365,39 @@ NODISCARD static Http1Response* construct_http1_response(HTTPResponseToSend to_s
 		return NULL;
 	}
 
+	SizedBuffer body = get_empty_sized_buffer();
+
+	const CompressionType format_used =
+	    compress_response_body(&to_send, send_settings, request_metrics, &body);
+
 	*response = (Http1Response){ 
 		.head = {
-			.header_fields = 	TVEC_EMPTY(HttpHeaderField),
+			.standard_headers = get_http1_standard_headers(send_settings, to_send.mime_type,
+			                                               format_used, to_send.status, true),
+			.header_fields = to_send.additional_headers,
 			.response_line = {
-				.protocol_version = tstr_null(),
-				.status_code_str =  tstr_null(),
-				.status_message = tstr_null(),
-			} 
+				.protocol_version = send_settings.protocol_data.version,
+				.status = to_send.status,
+			},
+			.numeric_headers = {
+				.content_length = 0,
+				.has_keep_alive = false,
+				.keep_alive_timeout_s = 0,
+				.keep_alive_max = 0,
+			},
 		},
-		.body = (SizedBuffer){ .data = NULL, .size = 0 } };
-
-	HTTPProtocolVersion version_to_use = send_settings.protocol_data.version;
-
-	const char* protocol_version = get_http_protocol_version_string(version_to_use);
-
-	const char* status_message = get_status_message(to_send.status);
-
-	// using the same trick as before, \0 in the malloced string :)
-	char* status_code_buffer = NULL;
-	FORMAT_STRING(&status_code_buffer, FREE_AT_END(); return NULL;, "%d", to_send.status);
-
-	response->head.response_line.protocol_version = tstr_from(protocol_version);
-	response->head.response_line.status_code_str = tstr_own_cstr(status_code_buffer);
-	response->head.response_line.status_message = tstr_from(status_message);
-
-	CompressionType format_used = send_settings.compression_to_use;
-
-	if(to_send.body.content.data) {
-
-		if(format_used != CompressionTypeNone) {
-
-			// here only supported protocols can be used, otherwise previous checks were wrong
-			SizedBuffer new_body =
-			    compress_buffer_with(to_send.body.content, send_settings.compression_to_use);
-
-			if(!new_body.data) {
-				const tstr str = get_string_for_compress_format(send_settings.compression_to_use);
-
-				LOG_MESSAGE(LogLevelError,
-				            "An error occurred while compressing the body with the compression "
-				            "format " TSTR_FMT "\n",
-				            TSTR_FMT_ARGS(str));
-				format_used = CompressionTypeNone;
-				response->body = to_send.body.content;
-			} else {
-				response->body = new_body;
-				free_sized_buffer(to_send.body.content);
-			}
-		} else {
-			response->body = to_send.body.content;
-		}
-	} else {
-		response->body = to_send.body.content;
-		format_used = CompressionTypeNone;
-	}
-
-	if(!construct_http1_headers_for_request(send_settings, &(response->head.header_fields),
-	                                        to_send.mime_type, to_send.additional_headers,
-	                                        format_used, response->body, to_send.status)) {
-		// TODO(Totto): free things accordingly
-		return NULL;
+		.body = body };
+
+	response->head.numeric_headers.content_length = response->body.size;
+
+	// see the Connection header in Http1StandardHeaders
+	if(response->head.standard_headers.has_connection &&
+	   response->head.standard_headers.keep_alive) {
+		response->head.numeric_headers.has_keep_alive = true;
+		response->head.numeric_headers.keep_alive_timeout_s =
+		    send_settings.persistence.idle_timeout_s;
+		response->head.numeric_headers.keep_alive_max =
+		    send_settings.persistence.remaining_requests;
 	}
 
 	if(!to_send.body.send_body_data) {
@@ -329,8 +410,6 @@ NODISCARD static Http1Response* construct_http1_response(HTTPResponseToSend to_s
 	return response;
 }
 
-#undef FREE_AT_END
-
 static void free_http2_response(Http2Response* response);
 
 #define FREE_AT_END() \
@@ -340,7 +419,8 @@ static void free_http2_response(Http2Response* response);
 
 NODISCARD static Http2Response* construct_http2_response(Http2ContextState* const state,
                                                          HTTPResponseToSend to_send,
-                                                         SendSettings send_settings) {
+                                                         SendSettings send_settings,
+                                                         HTTPRequestMetrics request_metrics) {
 
 	Http2Response* response = (Http2Response*)malloc(sizeof(Http2Response));
 
@@ -356,41 +436,13 @@ NODISCARD static Http2Response* construct_http2_response(Http2ContextState* cons
 		.stream_identifier = send_settings.protocol_data.value.v2.stream_identifier,
 	};
 
-	CompressionType format_used = send_settings.compression_to_use;
-
-	if(to_send.body.content.data) {
-
-		if(format_used != CompressionTypeNone) {
-
-			// here only supported protocols can be used, otherwise previous checks were wrong
-			SizedBuffer new_body =
-			    compress_buffer_with(to_send.body.content, send_settings.compression_to_use);
-
-			if(!new_body.data) {
-				const tstr str = get_string_for_compress_format(send_settings.compression_to_use);
-
-				LOG_MESSAGE(LogLevelError,
-				            "An error occurred while compressing the body with the compression "
-				            "format " TSTR_FMT "\n",
-				            TSTR_FMT_ARGS(str));
-				format_used = CompressionTypeNone;
-				response->body = to_send.body.content;
-			} else {
-				response->body = new_body;
-				free_sized_buffer(to_send.body.content);
-			}
-		} else {
-			response->body = to_send.body.content;
-		}
-	} else {
-		response->body = to_send.body.content;
-		format_used = CompressionTypeNone;
-	}
+	const CompressionType format_used =
+	    compress_response_body(&to_send, send_settings, request_metrics, &(response->body));
 
 	HttpHeaderFields result_headers = TVEC_EMPTY(HttpHeaderField);
 
-	if(!construct_http2_headers_for_request(send_settings, &result_headers, to_send.mime_type,
-	                                        to_send.additional_headers, format_used, response->body,
+	if(!construct_http2_headers_for_request(&result_headers, to_send.mime_type,
+	                                        to_send.additional_headers, format_used,
 	                                        to_send.status)) {
 
 		FREE_AT_END();
@@ -425,66 +477,296 @@ NODISCARD static Http2Response* construct_http2_response(Http2ContextState* cons
 
 #undef FREE_AT_END
 
-#define FREE_AT_END() \
-	do { \
-		free(concatted_response); \
-	} while(false)
+// the maximum amount of decimal digits of an uint64_t: 18446744073709551615
+#define UINT64_MAX_DECIMAL_DIGITS 20
 
-// makes a string_builder + a sized body from the HttpResponse, just does the opposite of parsing
-// a Request, but with some slight modification
-NODISCARD static Http1ConcattedResponse* http1_response_concat(Http1Response* response) {
-	Http1ConcattedResponse* concatted_response =
-	    (Http1ConcattedResponse*)malloc(sizeof(Http1ConcattedResponse));
+#define DECIMAL_BASE 10
 
-	if(response == NULL) {
-		FREE_AT_END();
-		return NULL;
+typedef struct {
+	char* data;
+	size_t offset;
+} Http1HeadWriter;
+
+static void http1_head_write(Http1HeadWriter* const writer, const void* const data,
+                             const size_t size) {
+	memcpy(writer->data + writer->offset, data, size);
+	writer->offset += size;
+}
+
+static void http1_head_write_cstr(Http1HeadWriter* const writer, const char* const str) {
+	http1_head_write(writer, str, strlen(str));
+}
+
+static void http1_head_write_tstr_static(Http1HeadWriter* const writer, const tstr_static str) {
+	http1_head_write(writer, str.ptr, str.len);
+}
+
+static void http1_head_write_decimal(Http1HeadWriter* const writer, uint64_t value) {
+	char digits[UINT64_MAX_DECIMAL_DIGITS];
+	size_t start = UINT64_MAX_DECIMAL_DIGITS;
+
+	do {
+		--start;
+		digits[start] = (char)('0' + (value % DECIMAL_BASE));
+		value /= DECIMAL_BASE;
+	} while(value != 0);
+
+	http1_head_write(writer, digits + start, UINT64_MAX_DECIMAL_DIGITS - start);
+}
+
+#define HEADER_FIELD_SEPERATOR ": "
+
+#define SIZEOF_HEADER_FIELD_SEPERATOR (sizeof(HEADER_FIELD_SEPERATOR) - 1)
+
+#define KEEP_ALIVE_TIMEOUT_PREFIX "timeout="
+
+#define KEEP_ALIVE_MAX_PREFIX ", max="
+
+// the status line of unknown status codes is formatted by hand, the precomputed ones are string
+// literals
+NODISCARD static size_t get_http1_status_line_size(const Http1ResponseLine response_line,
+                                                   const tstr_static precomputed) {
+	if(!tstr_static_is_null(precomputed)) {
+		return precomputed.len;
 	}
 
-	if(concatted_response == NULL) {
-		return NULL;
+	return strlen(get_http_protocol_version_string(response_line.protocol_version)) + 1 +
+	       UINT64_MAX_DECIMAL_DIGITS + 1 + strlen(get_status_message(response_line.status)) +
+	       SIZEOF_HTTP_LINE_SEPERATORS;
+}
+
+static void write_http1_status_line(Http1HeadWriter* const writer,
+                                    const Http1ResponseLine response_line,
+                                    const tstr_static precomputed) {
+	if(!tstr_static_is_null(precomputed)) {
+		http1_head_write_tstr_static(writer, precomputed);
+		return;
 	}
 
-	*concatted_response =
-	    (Http1ConcattedResponse){ .headers = NULL,
-		                          .body = (SizedBuffer){ .data = NULL, .size = 0 } };
+	http1_head_write_cstr(writer, get_http_protocol_version_string(response_line.protocol_version));
+	http1_head_write_cstr(writer, " ");
+	http1_head_write_decimal(writer, response_line.status);
+	http1_head_write_cstr(writer, " ");
+	http1_head_write_cstr(writer, get_status_message(response_line.status));
+	http1_head_write_cstr(writer, HTTP_LINE_SEPERATORS);
+}
+
+NODISCARD static size_t get_http1_header_fields_size(const HttpHeaderFields* const header_fields) {
+	size_t size = 0;
 
-	StringBuilder* result = string_builder_init();
+	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, *header_fields); ++i) {
+		const HttpHeaderField entry = TVEC_AT(HttpHeaderField, *header_fields, i);
 
-	STRING_BUILDER_APPENDF(
-	    result, FREE_AT_END(); return NULL;
-	    , "%s %s %s%s", tstr_cstr(&response->head.response_line.protocol_version),
-	    tstr_cstr(&response->head.response_line.status_code_str),
-	    tstr_cstr(&response->head.response_line.status_message), HTTP_LINE_SEPERATORS);
+		size += tstr_len(&entry.key) + SIZEOF_HEADER_FIELD_SEPERATOR + tstr_len(&entry.value) +
+		        SIZEOF_HTTP_LINE_SEPERATORS;
+	}
 
-	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, response->head.header_fields); ++i) {
+	return size;
+}
 
-		HttpHeaderField entry = TVEC_AT(HttpHeaderField, response->head.header_fields, i);
+static void write_http1_header_fields(Http1HeadWriter* const writer,
+                                      const HttpHeaderFields* const header_fields) {
+	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, *header_fields); ++i) {
+		const HttpHeaderField entry = TVEC_AT(HttpHeaderField, *header_fields, i);
 
-		STRING_BUILDER_APPENDF(result, FREE_AT_END(); return NULL;
-		                       , "%s: %s%s", tstr_cstr(&entry.key), tstr_cstr(&entry.value),
-		                       HTTP_LINE_SEPERATORS);
+		http1_head_write(writer, tstr_cstr(&entry.key), tstr_len(&entry.key));
+		http1_head_write_cstr(writer, HEADER_FIELD_SEPERATOR);
+		http1_head_write(writer, tstr_cstr(&entry.value), tstr_len(&entry.value));
+		http1_head_write_cstr(writer, HTTP_LINE_SEPERATORS);
 	}
+}
 
-	string_builder_append_single(result, HTTP_LINE_SEPERATORS);
+NODISCARD static size_t get_http1_header_field_size(const tstr_static name,
+                                                   const size_t value_size) {
+	return name.len + SIZEOF_HEADER_FIELD_SEPERATOR + value_size + SIZEOF_HTTP_LINE_SEPERATORS;
+}
 
-	concatted_response->headers = result;
-	concatted_response->body = response->body;
+static void write_http1_header_field(Http1HeadWriter* const writer, const tstr_static name,
+                                     const char* const value, const size_t value_size) {
+	http1_head_write_tstr_static(writer, name);
+	http1_head_write_cstr(writer, HEADER_FIELD_SEPERATOR);
+	http1_head_write(writer, value, value_size);
+	http1_head_write_cstr(writer, HTTP_LINE_SEPERATORS);
+}
 
-	return concatted_response;
+NODISCARD static const char* get_http1_connection_value(const Http1StandardHeaders* const headers) {
+	return headers->keep_alive ? "keep-alive" : "close";
 }
 
-#undef FREE_AT_END
+NODISCARD static size_t
+get_http1_standard_header_fields_size(const Http1StandardHeaders* const headers) {
+
+	const tstr mime_type = get_response_mime_type(headers->mime_type);
+
+	size_t size = get_http1_header_field_size(HTTP_HEADER_NAME(content_type), tstr_len(&mime_type));
+
+	if(headers->has_connection) {
+		size += get_http1_header_field_size(HTTP_HEADER_NAME(connection),
+		                                    strlen(get_http1_connection_value(headers)));
+	}
+
+	size += get_http1_header_field_size(HTTP_HEADER_NAME(server), sizeof(SERVER_HEADER_VALUE) - 1);
+
+	if(headers->has_alt_svc) {
+		size += get_http1_header_field_size(HTTP_HEADER_NAME(alt_svc),
+		                                    strlen(g_alt_svc_constant_data));
+	}
+
+	if(headers->content_encoding != CompressionTypeNone) {
+		const tstr content_encoding = get_string_for_compress_format(headers->content_encoding);
+
+		size += get_http1_header_field_size(HTTP_HEADER_NAME(content_encoding),
+		                                    tstr_len(&content_encoding));
+	}
+
+	return size;
+}
+
+// the order is the same, as the one of the header fields of http/2 responses
+static void write_http1_standard_header_fields(Http1HeadWriter* const writer,
+                                               const Http1StandardHeaders* const headers) {
+
+	const tstr mime_type = get_response_mime_type(headers->mime_type);
+
+	write_http1_header_field(writer, HTTP_HEADER_NAME(content_type), tstr_cstr(&mime_type),
+	                         tstr_len(&mime_type));
+
+	if(headers->has_connection) {
+		const char* const connection = get_http1_connection_value(headers);
+
+		write_http1_header_field(writer, HTTP_HEADER_NAME(connection), connection,
+		                         strlen(connection));
+	}
+
+	write_http1_header_field(writer, HTTP_HEADER_NAME(server), SERVER_HEADER_VALUE,
+	                         sizeof(SERVER_HEADER_VALUE) - 1);
+
+	// the port may be shorter than the reserved space, so the length is computed
+	if(headers->has_alt_svc) {
+		write_http1_header_field(writer, HTTP_HEADER_NAME(alt_svc), g_alt_svc_constant_data,
+		                         strlen(g_alt_svc_constant_data));
+	}
+
+	if(headers->content_encoding != CompressionTypeNone) {
+		const tstr content_encoding = get_string_for_compress_format(headers->content_encoding);
+
+		write_http1_header_field(writer, HTTP_HEADER_NAME(content_encoding),
+		                         tstr_cstr(&content_encoding), tstr_len(&content_encoding));
+	}
+}
+
+#define CONTENT_LENGTH_HEADER_FIELD_MAX_SIZE \
+	(HTTP_HEADER_NAME(content_length).len + SIZEOF_HEADER_FIELD_SEPERATOR + \
+	 UINT64_MAX_DECIMAL_DIGITS + SIZEOF_HTTP_LINE_SEPERATORS)
+
+static void write_http1_content_length_header_field(Http1HeadWriter* const writer,
+                                                    const size_t content_length) {
+	http1_head_write_tstr_static(writer, HTTP_HEADER_NAME(content_length));
+	http1_head_write_cstr(writer, HEADER_FIELD_SEPERATOR);
+	http1_head_write_decimal(writer, content_length);
+	http1_head_write_cstr(writer, HTTP_LINE_SEPERATORS);
+}
+
+#define KEEP_ALIVE_HEADER_FIELD_MAX_SIZE \
+	(HTTP_HEADER_NAME(keep_alive).len + SIZEOF_HEADER_FIELD_SEPERATOR + \
+	 (sizeof(KEEP_ALIVE_TIMEOUT_PREFIX) - 1) + UINT64_MAX_DECIMAL_DIGITS + \
+	 (sizeof(KEEP_ALIVE_MAX_PREFIX) - 1) + UINT64_MAX_DECIMAL_DIGITS + SIZEOF_HTTP_LINE_SEPERATORS)
+
+static void write_http1_keep_alive_header_field(Http1HeadWriter* const writer,
+                                                const uint32_t timeout_s, const size_t max) {
+	http1_head_write_tstr_static(writer, HTTP_HEADER_NAME(keep_alive));
+	http1_head_write_cstr(writer, HEADER_FIELD_SEPERATOR);
+	http1_head_write_cstr(writer, KEEP_ALIVE_TIMEOUT_PREFIX);
+	http1_head_write_decimal(writer, timeout_s);
+	http1_head_write_cstr(writer, KEEP_ALIVE_MAX_PREFIX);
+	http1_head_write_decimal(writer, max);
+	http1_head_write_cstr(writer, HTTP_LINE_SEPERATORS);
+}
+
+// serializes the head into one buffer, that is allocated once with the exact upper bound of the
+// needed size, header names and values are just copied, numbers are converted by hand, so that no
+// snprintf is needed
+NODISCARD static SizedBuffer serialize_http1_response_head(const Http1ResponseHead* const head) {
+
+	const tstr_static status_line = get_http1_status_line(head->response_line.protocol_version,
+	                                                      head->response_line.status);
+
+	size_t size = get_http1_status_line_size(head->response_line, status_line);
+
+	size += get_http1_standard_header_fields_size(&(head->standard_headers));
+
+	size += get_http1_header_fields_size(&(head->header_fields));
+
+	size += CONTENT_LENGTH_HEADER_FIELD_MAX_SIZE;
+
+	if(head->numeric_headers.has_keep_alive) {
+		size += KEEP_ALIVE_HEADER_FIELD_MAX_SIZE;
+	}
+
+	size += SIZEOF_HTTP_LINE_SEPERATORS;
+
+	SizedBuffer result = allocate_sized_buffer(size);
+
+	if(result.data == NULL) {
+		return result;
+	}
+
+	Http1HeadWriter writer = { .data = (char*)result.data, .offset = 0 };
+
+	write_http1_status_line(&writer, head->response_line, status_line);
+
+	write_http1_standard_header_fields(&writer, &(head->standard_headers));
+
+	write_http1_header_fields(&writer, &(head->header_fields));
+
+	write_http1_content_length_header_field(&writer, head->numeric_headers.content_length);
+
+	if(head->numeric_headers.has_keep_alive) {
+		write_http1_keep_alive_header_field(&writer, head->numeric_headers.keep_alive_timeout_s,
+		                                    head->numeric_headers.keep_alive_max);
+	}
+
+	http1_head_write_cstr(&writer, HTTP_LINE_SEPERATORS);
+
+	assert(writer.offset <= size && "the head size was computed wrong");
+
+	// the buffer may be a few bytes bigger, as the numbers were estimated with their maximum size
+	result.size = writer.offset;
+
+	return result;
+}
+
+// makes a serialized head + a sized body from the HttpResponse, just does the opposite of parsing
+// a Request, but with some slight modification
+NODISCARD static Http1ConcattedResponse* http1_response_concat(Http1Response* response) {
+
+	if(response == NULL) {
+		return NULL;
+	}
+
+	Http1ConcattedResponse* concatted_response =
+	    (Http1ConcattedResponse*)malloc(sizeof(Http1ConcattedResponse));
+
+	if(concatted_response == NULL) {
+		return NULL;
+	}
+
+	const SizedBuffer head = serialize_http1_response_head(&(response->head));
+
+	if(head.data == NULL) {
+		free(concatted_response);
+		return NULL;
+	}
+
+	*concatted_response = (Http1ConcattedResponse){ .head = head, .body = response->body };
 
-static void free_http1_response_line(Http1ResponseLine* line) {
-	tstr_free(&line->protocol_version);
-	tstr_free(&line->status_code_str);
-	tstr_free(&line->status_message);
+	return concatted_response;
 }
 
 // free the HttpResponse, just freeing everything necessary
 static void free_http1_response(Http1Response* response) {
-	free_http1_response_line(&(response->head.response_line));
+	tstr_free(&response->head.standard_headers.mime_type);
+
 	free_http_header_fields(&response->head.header_fields);
 
 	free_sized_buffer(response->body);
@@ -499,20 +781,66 @@ static void free_http2_response(Http2Response* response) {
 	free(response);
 }
 
+// sends the response or queues it, if requests are pipelined, this frees the concatted response,
+// but not its body
+NODISCARD static GenericResult
+send_or_queue_concatted_http1_response(HTTPGeneralContext* const general_context,
+                                       const ConnectionDescriptor* descriptor,
+                                       Http1ConcattedResponse* concatted_response,
+                                       const HttpStatusCode status) {
+
+	// a protocol switch is always the last http/1 response, so it is never queued
+	const bool queue_response = general_context != NULL && status != HttpStatusSwitchingProtocols &&
+	                            http_general_context_should_queue_http1_output(general_context);
+
+	const bool has_pending_output =
+	    general_context != NULL && http_general_context_has_pending_http1_output(general_context);
+
+	if(!queue_response && !has_pending_output) {
+		return send_concatted_http1_response_to_connection(descriptor, concatted_response);
+	}
+
+	// pipelined requests: queue the response, so that the responses stay in order and get
+	// flushed in one write, once the input buffer ran empty
+	GenericResult result = queue_concatted_http1_response(general_context, concatted_response);
+
+	IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
+		return result;
+	}
+
+	if(!queue_response ||
+	   string_builder_get_string_size(http_general_context_get_pending_http1_output(
+	       general_context)) >= HTTP1_PIPELINE_MAX_PENDING_OUTPUT_SIZE) {
+		result = http_general_context_flush_http1_output(general_context, descriptor);
+	}
+
+	return result;
+}
+
 NODISCARD static inline GenericResult
-send_message_to_connection_http1(const ConnectionDescriptor* descriptor, HTTPResponseToSend to_send,
-                                 SendSettings send_settings) {
+send_message_to_connection_http1(HTTPGeneralContext* const general_context,
+                                 const ConnectionDescriptor* descriptor, HTTPResponseToSend to_send,
+                                 SendSettings send_settings, HTTPRequestMetrics request_metrics) {
 
-	Http1Response* http_response = construct_http1_response(to_send, send_settings);
+	Http1Response* http_response =
+	    construct_http1_response(to_send, send_settings, request_metrics);
 
 	Http1ConcattedResponse* concatted_response = http1_response_concat(http_response);
 
 	if(!concatted_response) {
+		if(http_response != NULL) {
+			free_http1_response(http_response);
+		}
 		return GENERIC_RES_ERR_UNIQUE();
 	}
 
-	GenericResult result =
-	    send_concatted_http1_response_to_connection(descriptor, concatted_response);
+	const uint64_t send_start_us = http_server_metrics_get_timestamp_us();
+
+	const GenericResult result = send_or_queue_concatted_http1_response(
+	    general_context, descriptor, concatted_response, to_send.status);
+
+	http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseSend, send_start_us);
+
 	// body gets freed
 	free_http1_response(http_response);
 	return result;
@@ -521,16 +849,21 @@ send_message_to_connection_http1(const ConnectionDescriptor* descriptor, HTTPRes
 NODISCARD static inline GenericResult
 send_message_to_connection_http2(HTTP2Context* const context,
                                  const ConnectionDescriptor* descriptor, HTTPResponseToSend to_send,
-                                 SendSettings send_settings) {
+                                 SendSettings send_settings, HTTPRequestMetrics request_metrics) {
 
 	Http2Response* http_response =
-	    construct_http2_response(&(context->state), to_send, send_settings);
+	    construct_http2_response(&(context->state), to_send, send_settings, request_metrics);
 
 	if(!http_response) {
 		return GENERIC_RES_ERR_UNIQUE();
 	}
 
+	const uint64_t send_start_us = http_server_metrics_get_timestamp_us();
+
 	GenericResult result = send_http2_response_to_connection(descriptor, http_response, context);
+
+	http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseSend, send_start_us);
+
 	// body gets freed
 	free_http2_response(http_response);
 	return result;
@@ -539,17 +872,19 @@ send_message_to_connection_http2(HTTP2Context* const context,
 NODISCARD static inline GenericResult
 send_message_to_connection(HTTPGeneralContext* const general_context,
                            const ConnectionDescriptor* descriptor, HTTPResponseToSend to_send,
-                           SendSettings send_settings) {
+                           SendSettings send_settings, HTTPRequestMetrics request_metrics) {
 
 	if(send_settings.protocol_data.version == HTTPProtocolVersion2) {
 		HTTP2Context* const context = http_general_context_get_http2_context(general_context);
 		if(context == NULL) {
 			return GENERIC_RES_ERR_UNIQUE();
 		}
-		return send_message_to_connection_http2(context, descriptor, to_send, send_settings);
+		return send_message_to_connection_http2(context, descriptor, to_send, send_settings,
+		                                        request_metrics);
 	}
 
-	return send_message_to_connection_http1(descriptor, to_send, send_settings);
+	return send_message_to_connection_http1(general_context, descriptor, to_send, send_settings,
+	                                        request_metrics);
 }
 
 // sends a http message to the connection, takes status and if that special status needs some
@@ -560,7 +895,13 @@ GenericResult send_http_message_to_connection(HTTPGeneralContext* const general_
                                               HTTPResponseToSend to_send,
                                               SendSettings send_settings) {
 
-	return send_message_to_connection(general_context, descriptor, to_send, send_settings);
+	const HTTPRequestMetrics request_metrics = get_request_metrics(general_context, send_settings);
+
+	// responses are counted, even if writing them fails, as the status was already decided
+	http_server_metrics_response_sent(request_metrics, to_send.status);
+
+	return send_message_to_connection(general_context, descriptor, to_send, send_settings,
+	                                  request_metrics);
 }
 
 NODISCARD HTTPResponseBody http_response_body_from_static_string(const char* static_string,
@@ -590,3 +931,496 @@ NODISCARD HTTPResponseBody http_response_body_from_data(void* data, size_t size,
 NODISCARD HTTPResponseBody http_response_body_empty(void) {
 	return (HTTPResponseBody){ .content = get_empty_sized_buffer(), .send_body_data = false };
 }
+
+// the date has a fixed length, so the placeholder is overwritten on every send, without moving the
+// rest of the head, see get_http_date_string
+#define PREBUILT_DATE_PLACEHOLDER "Thu, 01 Jan 1970 00:00:00 GMT"
+
+#define PREBUILT_DATE_LENGTH (sizeof(PREBUILT_DATE_PLACEHOLDER) - 1)
+
+#define PREBUILT_HTTP_RESPONSE_VARIANT_AMOUNT (CompressionTypeCompress + 1)
+
+typedef struct {
+	bool valid;
+	// all http/1 header fields, that don't depend on the connection, including Content-Length
+	// and Date, this starts after the status line and doesn't have the terminating empty line
+	SizedBuffer http1_head;
+	size_t http1_date_offset;
+	// the hpack block only uses the static table and never adds to the dynamic table, so that it
+	// can be sent on every connection, the date value is the last part of it
+	SizedBuffer http2_headers;
+	size_t http2_date_offset;
+	SizedBuffer body;
+} PrebuiltHttpResponseVariant;
+
+struct PrebuiltHttpResponseImpl {
+	HttpStatusCode status;
+	// the formats, that were tried to build, see PREBUILT_FORMAT_BIT
+	PrebuiltFormatMask format_mask;
+	// indexed by the CompressionType, CompressionTypeNone is always valid, other formats are only
+	// valid, if compressing is supported and worth it
+	PrebuiltHttpResponseVariant variants[PREBUILT_HTTP_RESPONSE_VARIANT_AMOUNT];
+};
+
+static void free_prebuilt_http_response_variant(PrebuiltHttpResponseVariant* const variant) {
+	free_sized_buffer(variant->http1_head);
+	free_sized_buffer(variant->http2_headers);
+	free_sized_buffer(variant->body);
+
+	*variant = (PrebuiltHttpResponseVariant){ .valid = false };
+}
+
+void free_prebuilt_http_response(PrebuiltHttpResponse* const prebuilt_response) {
+	if(prebuilt_response == NULL) {
+		return;
+	}
+
+	for(size_t i = 0; i < PREBUILT_HTTP_RESPONSE_VARIANT_AMOUNT; ++i) {
+		free_prebuilt_http_response_variant(&(prebuilt_response->variants[i]));
+	}
+
+	free(prebuilt_response);
+}
+
+NODISCARD static HttpHeaderField get_prebuilt_date_header_field(void) {
+	return (HttpHeaderField){ .key = tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
+		                      .value = TSTR_LIT(PREBUILT_DATE_PLACEHOLDER),
+		                      .token = HttpHeaderTokenDate };
+}
+
+NODISCARD static bool build_prebuilt_http1_head(const HttpStatusCode status, const tstr mime_type,
+                                                const CompressionType format,
+                                                const size_t content_length,
+                                                PrebuiltHttpResponseVariant* const variant) {
+
+	const SendSettings send_settings = {
+		.compression_to_use = format,
+		.protocol_data = DEFAULT_RESPONSE_PROTOCOL_DATA,
+		.persistence = { .type = HttpConnectionPersistenceTypeClose,
+		                 .idle_timeout_s = 0,
+		                 .remaining_requests = 0 },
+	};
+
+	// the mime type is only borrowed here, so these are not freed
+	const Http1StandardHeaders standard_headers =
+	    get_http1_standard_headers(send_settings, mime_type, format, status, false);
+
+	const HttpHeaderField date_field = get_prebuilt_date_header_field();
+
+	const size_t size = get_http1_standard_header_fields_size(&standard_headers) +
+	                    CONTENT_LENGTH_HEADER_FIELD_MAX_SIZE + HTTP_HEADER_NAME(date).len +
+	                    SIZEOF_HEADER_FIELD_SEPERATOR + PREBUILT_DATE_LENGTH +
+	                    SIZEOF_HTTP_LINE_SEPERATORS;
+
+	SizedBuffer head = allocate_sized_buffer(size);
+
+	if(head.data == NULL) {
+		return false;
+	}
+
+	Http1HeadWriter writer = { .data = (char*)head.data, .offset = 0 };
+
+	write_http1_standard_header_fields(&writer, &standard_headers);
+
+	write_http1_content_length_header_field(&writer, content_length);
+
+	http1_head_write(&writer, tstr_cstr(&date_field.key), tstr_len(&date_field.key));
+	http1_head_write_cstr(&writer, HEADER_FIELD_SEPERATOR);
+	variant->http1_date_offset = writer.offset;
+	http1_head_write(&writer, tstr_cstr(&date_field.value), tstr_len(&date_field.value));
+	http1_head_write_cstr(&writer, HTTP_LINE_SEPERATORS);
+
+	assert(writer.offset <= size && "the head size was computed wrong");
+
+	head.size = writer.offset;
+	variant->http1_head = head;
+
+	return true;
+}
+
+NODISCARD static bool build_prebuilt_http2_headers(const HttpStatusCode status,
+                                                   const tstr mime_type,
+                                                   const CompressionType format,
+                                                   PrebuiltHttpResponseVariant* const variant) {
+
+	HttpHeaderFields header_fields = TVEC_EMPTY(HttpHeaderField);
+
+	if(!construct_http2_headers_for_request(&header_fields, mime_type,
+	                                        TVEC_EMPTY(HttpHeaderField), format, status)) {
+		free_http_header_fields(&header_fields);
+		return false;
+	}
+
+	// without any table additions, the compress state isn't used at all
+	const Http2HpackCompressOptions compress_options = {
+		.huffman_usage = Http2HpackHuffmanUsageAuto,
+		.type = Http2HpackCompressTypeStaticTableUsage,
+		.table_add_type = Http2HpackTableAddTypeNone,
+	};
+
+	const SizedBuffer fields_block =
+	    http2_hpack_compress_data(NULL, header_fields, compress_options);
+
+	free_http_header_fields(&header_fields);
+
+	if(fields_block.data == NULL) {
+		return false;
+	}
+
+	// the date is encoded on its own without huffman coding, so that its value are the last bytes
+	// of the block
+	HttpHeaderFields date_fields = TVEC_EMPTY(HttpHeaderField);
+
+	const TvecResult push_res =
+	    TVEC_PUSH(HttpHeaderField, &date_fields, get_prebuilt_date_header_field());
+
+	if(push_res != TvecResultOk) { // NOLINT(readability-implicit-bool-conversion)
+		free_sized_buffer(fields_block);
+		return false;
+	}
+
+	const Http2HpackCompressOptions date_compress_options = {
+		.huffman_usage = Http2HpackHuffmanUsageNever,
+		.type = Http2HpackCompressTypeStaticTableUsage,
+		.table_add_type = Http2HpackTableAddTypeNone,
+	};
+
+	const SizedBuffer date_block =
+	    http2_hpack_compress_data(NULL, date_fields, date_compress_options);
+
+	TVEC_FREE(HttpHeaderField, &date_fields);
+
+	if(date_block.data == NULL || date_block.size < PREBUILT_DATE_LENGTH) {
+		free_sized_buffer(fields_block);
+		free_sized_buffer(date_block);
+		return false;
+	}
+
+	SizedBuffer block = allocate_sized_buffer(fields_block.size + date_block.size);
+
+	if(block.data == NULL) {
+		free_sized_buffer(fields_block);
+		free_sized_buffer(date_block);
+		return false;
+	}
+
+	memcpy(block.data, fields_block.data, fields_block.size);
+	memcpy(((uint8_t*)block.data) + fields_block.size, date_block.data, date_block.size);
+
+	free_sized_buffer(fields_block);
+	free_sized_buffer(date_block);
+
+	variant->http2_headers = block;
+	variant->http2_date_offset = block.size - PREBUILT_DATE_LENGTH;
+
+	return true;
+}
+
+// the body is moved into the variant
+NODISCARD static bool build_prebuilt_http_response_variant(
+    const HttpStatusCode status, const tstr mime_type, const CompressionType format,
+    const SizedBuffer body, PrebuiltHttpResponseVariant* const variant) {
+
+	*variant = (PrebuiltHttpResponseVariant){
+		.valid = false,
+		.http1_head = get_empty_sized_buffer(),
+		.http1_date_offset = 0,
+		.http2_headers = get_empty_sized_buffer(),
+		.http2_date_offset = 0,
+		.body = body,
+	};
+
+	if(!build_prebuilt_http1_head(status, mime_type, format, body.size, variant)) {
+		free_prebuilt_http_response_variant(variant);
+		return false;
+	}
+
+	if(!build_prebuilt_http2_headers(status, mime_type, format, variant)) {
+		free_prebuilt_http_response_variant(variant);
+		return false;
+	}
+
+	variant->valid = true;
+
+	return true;
+}
+
+NODISCARD PrebuiltHttpResponse* build_prebuilt_http_response(const HttpStatusCode status,
+                                                             const tstr mime_type,
+                                                             const ReadonlyBuffer body) {
+	return build_prebuilt_http_response_for_formats(status, mime_type, body,
+	                                                PREBUILT_FORMAT_MASK_ALL);
+}
+
+NODISCARD PrebuiltHttpResponse*
+build_prebuilt_http_response_for_formats(const HttpStatusCode status, const tstr mime_type,
+                                         const ReadonlyBuffer body,
+                                         const PrebuiltFormatMask format_mask) {
+
+	if(tstr_static_is_null(get_http1_status_line(DEFAULT_RESPONSE_PROTOCOL_VERSION, status))) {
+		return NULL;
+	}
+
+	PrebuiltHttpResponse* prebuilt_response =
+	    (PrebuiltHttpResponse*)malloc(sizeof(PrebuiltHttpResponse));
+
+	if(prebuilt_response == NULL) {
+		return NULL;
+	}
+
+	prebuilt_response->status = status;
+	prebuilt_response->format_mask = format_mask | PREBUILT_FORMAT_BIT(CompressionTypeNone);
+
+	for(size_t i = 0; i < PREBUILT_HTTP_RESPONSE_VARIANT_AMOUNT; ++i) {
+		prebuilt_response->variants[i] = (PrebuiltHttpResponseVariant){
+			.valid = false,
+			.http1_head = get_empty_sized_buffer(),
+			.http1_date_offset = 0,
+			.http2_headers = get_empty_sized_buffer(),
+			.http2_date_offset = 0,
+			.body = get_empty_sized_buffer(),
+		};
+	}
+
+	const SizedBuffer identity_body = sized_buffer_allocate_from_readonly_buffer(body);
+
+	if(body.size != 0 && identity_body.data == NULL) {
+		free_prebuilt_http_response(prebuilt_response);
+		return NULL;
+	}
+
+	if(!build_prebuilt_http_response_variant(status, mime_type, CompressionTypeNone, identity_body,
+	                                         &(prebuilt_response->variants[CompressionTypeNone]))) {
+		free_prebuilt_http_response(prebuilt_response);
+		return NULL;
+	}
+
+	// every supported encoding is compressed once here, so that a send never compresses
+	for(size_t i = CompressionTypeNone + 1; i < PREBUILT_HTTP_RESPONSE_VARIANT_AMOUNT; ++i) {
+		const CompressionType format = (CompressionType)i;
+
+		if((format_mask & PREBUILT_FORMAT_BIT(format)) == 0) {
+			continue;
+		}
+
+		if(!is_compression_supported(format)) {
+			continue;
+		}
+
+		const CompressionDecision decision =
+		    compression_policy_decide(format, mime_type, identity_body.size);
+
+		if(decision.format == CompressionTypeNone) {
+			continue;
+		}
+
+		const SizedBuffer compressed_body =
+		    compress_buffer_with_level(identity_body, decision.format, decision.level);
+
+		if(compressed_body.data == NULL) {
+			continue;
+		}
+
+		// incompressible data can get bigger, then the identity variant is used
+		if(compressed_body.size >= identity_body.size) {
+			free_sized_buffer(compressed_body);
+			continue;
+		}
+
+		if(!build_prebuilt_http_response_variant(status, mime_type, decision.format,
+		                                         compressed_body,
+		                                         &(prebuilt_response->variants[i]))) {
+			free_prebuilt_http_response(prebuilt_response);
+			return NULL;
+		}
+	}
+
+	return prebuilt_response;
+}
+
+NODISCARD SizedBuffer prebuilt_http_response_get_body(const PrebuiltHttpResponse* const response) {
+	return response->variants[CompressionTypeNone].body;
+}
+
+NODISCARD HttpStatusCode
+prebuilt_http_response_get_status(const PrebuiltHttpResponse* const response) {
+	return response->status;
+}
+
+NODISCARD bool prebuilt_http_response_has_format(const PrebuiltHttpResponse* const response,
+                                                 const CompressionType format) {
+	return (response->format_mask & PREBUILT_FORMAT_BIT(format)) != 0;
+}
+
+NODISCARD PrebuiltFormatMask
+prebuilt_http_response_get_format_mask(const PrebuiltHttpResponse* const response) {
+	return response->format_mask;
+}
+
+NODISCARD static const PrebuiltHttpResponseVariant*
+get_prebuilt_http_response_variant(const PrebuiltHttpResponse* const prebuilt_response,
+                                   const CompressionType format) {
+
+	if(format < PREBUILT_HTTP_RESPONSE_VARIANT_AMOUNT &&
+	   prebuilt_response->variants[format].valid) {
+		return &(prebuilt_response->variants[format]);
+	}
+
+	return &(prebuilt_response->variants[CompressionTypeNone]);
+}
+
+static void patch_prebuilt_date(SizedBuffer buffer, const size_t offset) {
+	HttpDateString date_string = {};
+
+	if(!get_http_date_string(&date_string) || date_string.length != PREBUILT_DATE_LENGTH) {
+		return;
+	}
+
+	assert(offset + PREBUILT_DATE_LENGTH <= buffer.size && "date offset out of bounds");
+
+	memcpy(((uint8_t*)buffer.data) + offset, date_string.data, PREBUILT_DATE_LENGTH);
+}
+
+// the Connection and Keep-Alive headers depend on the connection, so prebuilt responses write them
+// on every send, see write_http1_standard_header_fields
+NODISCARD static size_t get_http1_connection_header_fields_max_size(void) {
+	return HTTP_HEADER_NAME(connection).len + SIZEOF_HEADER_FIELD_SEPERATOR +
+	       (sizeof("keep-alive") - 1) + SIZEOF_HTTP_LINE_SEPERATORS +
+	       KEEP_ALIVE_HEADER_FIELD_MAX_SIZE;
+}
+
+static void write_http1_connection_header_fields(Http1HeadWriter* const writer,
+                                                 const SendSettings send_settings,
+                                                 const HttpStatusCode status) {
+	if(status == HttpStatusSwitchingProtocols) {
+		return;
+	}
+
+	http1_head_write_tstr_static(writer, HTTP_HEADER_NAME(connection));
+	http1_head_write_cstr(writer, HEADER_FIELD_SEPERATOR);
+
+	if(send_settings.persistence.type != HttpConnectionPersistenceTypeKeepAlive) {
+		http1_head_write_cstr(writer, "close" HTTP_LINE_SEPERATORS);
+		return;
+	}
+
+	http1_head_write_cstr(writer, "keep-alive" HTTP_LINE_SEPERATORS);
+
+	write_http1_keep_alive_header_field(writer, send_settings.persistence.idle_timeout_s,
+	                                    send_settings.persistence.remaining_requests);
+}
+
+NODISCARD static GenericResult send_prebuilt_http1_response(
+    HTTPGeneralContext* const general_context, const ConnectionDescriptor* const descriptor,
+    const PrebuiltHttpResponse* const prebuilt_response,
+    const PrebuiltHttpResponseVariant* const variant, const SendSettings send_settings,
+    const bool send_body) {
+
+	const tstr_static status_line =
+	    get_http1_status_line(send_settings.protocol_data.version, prebuilt_response->status);
+
+	const size_t size = status_line.len + variant->http1_head.size +
+	                    get_http1_connection_header_fields_max_size() +
+	                    SIZEOF_HTTP_LINE_SEPERATORS;
+
+	SizedBuffer head = allocate_sized_buffer(size);
+
+	if(head.data == NULL) {
+		return GENERIC_RES_ERR_UNIQUE();
+	}
+
+	Http1HeadWriter writer = { .data = (char*)head.data, .offset = 0 };
+
+	http1_head_write_tstr_static(&writer, status_line);
+	http1_head_write(&writer, variant->http1_head.data, variant->http1_head.size);
+	write_http1_connection_header_fields(&writer, send_settings, prebuilt_response->status);
+	http1_head_write_cstr(&writer, HTTP_LINE_SEPERATORS);
+
+	assert(writer.offset <= size && "the head size was computed wrong");
+
+	head.size = writer.offset;
+
+	patch_prebuilt_date(head, status_line.len + variant->http1_date_offset);
+
+	Http1ConcattedResponse* concatted_response =
+	    (Http1ConcattedResponse*)malloc(sizeof(Http1ConcattedResponse));
+
+	if(concatted_response == NULL) {
+		free_sized_buffer(head);
+		return GENERIC_RES_ERR_UNIQUE();
+	}
+
+	// the body is only borrowed, it is never freed by sending or queueing
+	*concatted_response = (Http1ConcattedResponse){
+		.head = head,
+		.body = send_body && variant->body.size != 0 ? variant->body : get_empty_sized_buffer(),
+	};
+
+	return send_or_queue_concatted_http1_response(general_context, descriptor, concatted_response,
+	                                              prebuilt_response->status);
+}
+
+NODISCARD static GenericResult
+send_prebuilt_http2_response(HTTPGeneralContext* const general_context,
+                             const ConnectionDescriptor* const descriptor,
+                             const PrebuiltHttpResponseVariant* const variant,
+                             const SendSettings send_settings, const bool send_body) {
+
+	HTTP2Context* const context = http_general_context_get_http2_context(general_context);
+
+	if(context == NULL) {
+		return GENERIC_RES_ERR_UNIQUE();
+	}
+
+	const SizedBuffer headers = sized_buffer_dup(variant->http2_headers);
+
+	if(headers.data == NULL) {
+		return GENERIC_RES_ERR_UNIQUE();
+	}
+
+	patch_prebuilt_date(headers, variant->http2_date_offset);
+
+	const Http2Response response = {
+		.hpack_encoded_headers = headers,
+		.body = send_body && variant->body.size != 0 ? variant->body : get_empty_sized_buffer(),
+		.stream_identifier = send_settings.protocol_data.value.v2.stream_identifier,
+	};
+
+	const GenericResult result = send_http2_response_to_connection(descriptor, &response, context);
+
+	// the body is only borrowed
+	free_sized_buffer(headers);
+
+	return result;
+}
+
+GenericResult send_prebuilt_http_response_to_connection(
+    HTTPGeneralContext* const general_context, const ConnectionDescriptor* const descriptor,
+    const PrebuiltHttpResponse* const prebuilt_response, const SendSettings send_settings,
+    const bool send_body) {
+
+	const PrebuiltHttpResponseVariant* const variant =
+	    get_prebuilt_http_response_variant(prebuilt_response, send_settings.compression_to_use);
+
+	const HTTPRequestMetrics request_metrics = get_request_metrics(general_context, send_settings);
+
+	http_server_metrics_response_sent(request_metrics,
+	                                  prebuilt_http_response_get_status(prebuilt_response));
+
+	// nothing is compressed here, so the whole call is the send phase
+	const uint64_t send_start_us = http_server_metrics_get_timestamp_us();
+
+	GenericResult result = GENERIC_RES_ERR_UNIQUE();
+
+	if(send_settings.protocol_data.version == HTTPProtocolVersion2) {
+		result = send_prebuilt_http2_response(general_context, descriptor, variant, send_settings,
+		                                      send_body);
+	} else {
+		result = send_prebuilt_http1_response(general_context, descriptor, prebuilt_response,
+		                                      variant, send_settings, send_body);
+	}
+
+	http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseSend, send_start_us);
+
+	return result;
+}
@@ -6,6 +6,10 @@
 #include "generic/secure.h"
 #include "http/protocol.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
 	SizedBuffer content;
 	bool send_body_data;
@@ -36,3 +40,47 @@ NODISCARD HTTPResponseBody http_response_body_from_data(void* data, size_t size,
 NODISCARD HTTPResponseBody http_response_body_empty(void);
 
 void global_setup_port_data(uint16_t port);
+
+// a response, that is the same on every request, it is serialized once for http/1 and http/2 and
+// compressed once for every supported encoding, so that sending it only copies bytes and patches
+// the Date header
+typedef struct PrebuiltHttpResponseImpl PrebuiltHttpResponse;
+
+typedef uint8_t PrebuiltFormatMask;
+
+#define PREBUILT_FORMAT_BIT(format) ((PrebuiltFormatMask)(1U << (format)))
+
+#define PREBUILT_FORMAT_MASK_ALL ((PrebuiltFormatMask)UINT8_MAX)
+
+// the body is copied, this uses the compression policy, so it has to be initialized before
+NODISCARD PrebuiltHttpResponse* build_prebuilt_http_response(HttpStatusCode status, tstr mime_type,
+                                                             ReadonlyBuffer body);
+
+// only compresses the body for the given formats, the uncompressed variant is always built, other
+// formats are sent uncompressed
+NODISCARD PrebuiltHttpResponse*
+build_prebuilt_http_response_for_formats(HttpStatusCode status, tstr mime_type,
+                                         ReadonlyBuffer body, PrebuiltFormatMask format_mask);
+
+void free_prebuilt_http_response(PrebuiltHttpResponse* prebuilt_response);
+
+// the uncompressed body, it is owned by the prebuilt response
+NODISCARD SizedBuffer prebuilt_http_response_get_body(const PrebuiltHttpResponse* response);
+
+NODISCARD HttpStatusCode prebuilt_http_response_get_status(const PrebuiltHttpResponse* response);
+
+// if the format was requested while building, this doesn't mean, that the body is compressed with
+// it, as compressing may not be worth it
+NODISCARD bool prebuilt_http_response_has_format(const PrebuiltHttpResponse* response,
+                                                 CompressionType format);
+
+NODISCARD PrebuiltFormatMask
+prebuilt_http_response_get_format_mask(const PrebuiltHttpResponse* response);
+
+NODISCARD GenericResult send_prebuilt_http_response_to_connection(
+    HTTPGeneralContext* general_context, const ConnectionDescriptor* descriptor,
+    const PrebuiltHttpResponse* prebuilt_response, SendSettings send_settings, bool send_body);
+
+#ifdef __cplusplus
+}
+#endif
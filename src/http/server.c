@@ -1,11 +1,16 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <signal.h>
+#include <stdatomic.h>
 
+#include "./common_log.h"
+#include "./compression_policy.h"
 #include "./folder.h"
 #include "./hpack.h"
 #include "./send.h"
 #include "./server.h"
+#include "./server_metrics.h"
+#include "generic/client_limiter.h"
 #include "generic/helper.h"
 #include "generic/secure.h"
 #include "generic/signal_fd.h"
@@ -16,6 +21,7 @@
 #include "utils/clock.h"
 #include "utils/errors.h"
 #include "utils/log.h"
+#include "utils/offload_pool.h"
 #include "utils/thread_pool.h"
 #include "utils/utils.h"
 #include "ws/handler.h"
@@ -35,6 +41,18 @@ static void receive_signal(int signal_number) {
 	g_signal_received = signal_number;
 }
 
+// SIGHUP doesn't stop the server, it only reopens the access log, e.g. after it was rotated by
+// external tools
+static void receive_reopen_signal(int /* signal_number */) {
+	log_collector_request_reopen();
+}
+
+// set, when the server shuts down, so that idle keep-alive connections are closed and don't delay
+// the shutdown
+static atomic_bool
+    g_shutdown_requested = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    false;
+
 #define SUPPORTED_HTTP_METHODS TSTR_LIT("GET, POST, HEAD, OPTIONS, CONNECT")
 
 #define FREE_AT_END() \
@@ -43,6 +61,20 @@ static void receive_signal(int signal_number) {
 
 #define INT_ERROR_FROM_VOID_PTR(ERR) (-((int)((uintptr_t)(ERR))))
 
+// the date string comes preformatted from the clock service, so this only copies it
+static void add_http_date_header_field(HttpHeaderFields* additional_headers) {
+
+	HttpDateString date_string = {};
+
+	if(!get_http_date_string(&date_string)) {
+		return;
+	}
+
+	add_http_header_field(
+	    additional_headers, tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
+	    tstr_from_view((tstr_view){ .data = date_string.data, .len = date_string.length }));
+}
+
 NODISCARD static GenericResult process_http_error(const HttpRequestError error,
                                                   ConnectionDescriptor* const descriptor,
                                                   HTTPGeneralContext* general_context,
@@ -82,18 +114,7 @@ NODISCARD static GenericResult process_http_error(const HttpRequestError error,
 
 			{
 
-				Time now;
-
-				bool success = get_current_time(&now);
-
-				if(success) {
-					char* date_str = get_date_string(now, TimeFormatHTTP1Dot1);
-					if(date_str != NULL) {
-						add_http_header_field(&additional_headers,
-						                      tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
-						                      tstr_own_cstr(date_str));
-					}
-				}
+				add_http_date_header_field(&additional_headers);
 			}
 
 			HTTPResponseToSend to_send = { .status = HttpStatusHttpVersionNotSupported,
@@ -119,18 +140,7 @@ NODISCARD static GenericResult process_http_error(const HttpRequestError error,
 				}
 
 				{
-					Time now;
-
-					bool success = get_current_time(&now);
-
-					if(success) {
-						char* date_str = get_date_string(now, TimeFormatHTTP1Dot1);
-						if(date_str != NULL) {
-							add_http_header_field(&additional_headers,
-							                      tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
-							                      tstr_own_cstr(date_str));
-						}
-					}
+					add_http_date_header_field(&additional_headers);
 				}
 			}
 
@@ -172,6 +182,17 @@ NODISCARD static GenericResult process_http_error(const HttpRequestError error,
 			return send_http_message_to_connection(general_context, descriptor, to_send,
 			                                       send_settings);
 		}
+		case HttpRequestErrorTypePayloadTooLarge: {
+			// the body wasn't read, so the connection is closed afterwards
+			HTTPResponseToSend to_send = { .status = HttpStatusPayloadTooLarge,
+				                           .body = http_response_body_from_static_string(
+				                               "The request body is too large", send_body),
+				                           .mime_type = MIME_TYPE_TEXT,
+				                           .additional_headers = TVEC_EMPTY(HttpHeaderField) };
+
+			return send_http_message_to_connection(general_context, descriptor, to_send,
+			                                       send_settings);
+		}
 		case HttpRequestErrorTypeProtocolError: {
 			HTTPResponseToSend to_send = { .status = HttpStatusBadRequest,
 				                           .body = http_response_body_from_static_string(
@@ -206,6 +227,39 @@ NODISCARD static GenericResult process_http_error(const HttpRequestError error,
 	}
 }
 
+// cheap on purpose, the request isn't routed and the response is neither compressed nor cached
+NODISCARD static GenericResult
+send_too_many_requests(const ConnectionDescriptor* const descriptor,
+                       HTTPGeneralContext* const general_context,
+                       const RequestSettings request_settings, const uint32_t retry_after_s,
+                       const bool send_body) {
+
+	const SendSettings send_settings = {
+		.compression_to_use = CompressionTypeNone,
+		.protocol_data = request_settings.protocol_data,
+		.persistence = { .type = HttpConnectionPersistenceTypeClose,
+		                 .idle_timeout_s = 0,
+		                 .remaining_requests = 0 },
+	};
+
+	HttpHeaderFields additional_headers = TVEC_EMPTY(HttpHeaderField);
+
+	char* retry_after_value = NULL;
+	FORMAT_STRING(&retry_after_value, return GENERIC_RES_ERR_UNIQUE();, "%u", retry_after_s);
+
+	add_http_header_field(&additional_headers,
+	                      tstr_from_static_tstr(HTTP_HEADER_NAME(retry_after)),
+	                      tstr_own_cstr(retry_after_value));
+
+	HTTPResponseToSend to_send = { .status = HttpStatusTooManyRequests,
+		                           .body = http_response_body_from_static_string(
+		                               "Too Many Requests", send_body),
+		                           .mime_type = MIME_TYPE_TEXT,
+		                           .additional_headers = additional_headers };
+
+	return send_http_message_to_connection(general_context, descriptor, to_send, send_settings);
+}
+
 NODISCARD static JobError
 process_http_request(const HttpRequest http_request, ConnectionDescriptor* const descriptor,
                      HTTPReader* const http_reader, const RouteManager* const route_manager,
@@ -217,6 +271,8 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 
 	HTTPGeneralContext* general_context = http_reader_get_general_context(http_reader);
 
+	http_server_metrics_request_received();
+
 	// To test this error codes you can use '-X POST' with curl or
 	// '--http2' (doesn't work, since http can only be HTTP/1.1, https can be HTTP 2 or QUIC
 	// alias HTTP 3)
@@ -229,26 +285,29 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 	SendSettings send_settings = get_send_settings(request_settings);
 	HttpRequestProperties http_properties = request_settings.http_properties;
 
-	SelectedRoute* selected_route =
-	    route_manager_get_route_for_request(route_manager, http_properties, http_request, address);
+	HTTPRequestMetrics request_metrics =
+	    get_default_http_request_metrics(send_settings.protocol_data.version);
+
+	http_general_context_set_request_metrics(general_context, request_metrics);
+
+	const uint64_t route_lookup_start_us = http_server_metrics_get_timestamp_us();
+
+	SelectedRoute* selected_route = route_manager_get_route_for_request(
+	    route_manager, http_properties, http_request, address, is_secure_context(context));
 
 	if(selected_route == NULL) {
 
+		http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseRouteLookup,
+		                                  route_lookup_start_us);
+
 		GenericResult result = GENERIC_RES_ERR_UNIQUE();
 
 		switch(http_request.head.request_line.method) {
 			case HTTPRequestMethodGet:
 			case HTTPRequestMethodPost:
 			case HTTPRequestMethodHead: {
-
-				HTTPResponseToSend to_send = { .status = HttpStatusNotFound,
-					                           .body = http_response_body_from_static_string(
-					                               "File not Found", send_body),
-					                           .mime_type = MIME_TYPE_TEXT,
-					                           .additional_headers = TVEC_EMPTY(HttpHeaderField) };
-
-				result = send_http_message_to_connection(general_context, descriptor, to_send,
-				                                         send_settings);
+				result = route_manager_send_not_found(route_manager, descriptor, general_context,
+				                                      send_settings, send_body);
 				break;
 			}
 			case HTTPRequestMethodOptions: {
@@ -264,18 +323,7 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 					}
 
 					{
-						Time now;
-
-						bool success = get_current_time(&now);
-
-						if(success) {
-							char* date_str = get_date_string(now, TimeFormatHTTP1Dot1);
-							if(date_str != NULL) {
-								add_http_header_field(&additional_headers,
-								                      tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
-								                      tstr_own_cstr(date_str));
-							}
-						}
+						add_http_date_header_field(&additional_headers);
 					}
 				}
 
@@ -302,18 +350,7 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 					}
 
 					{
-						Time now;
-
-						bool success = get_current_time(&now);
-
-						if(success) {
-							char* date_str = get_date_string(now, TimeFormatHTTP1Dot1);
-							if(date_str != NULL) {
-								add_http_header_field(&additional_headers,
-								                      tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
-								                      tstr_own_cstr(date_str));
-							}
-						}
+						add_http_date_header_field(&additional_headers);
 					}
 				}
 
@@ -353,6 +390,40 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 
 	HTTPRouteData route_data = selected_route_data.data;
 
+	request_metrics.route = selected_route_data.route_metrics;
+
+	if(route_data.type == HTTPRouteTypeSpecial &&
+	   route_data.value.special.type == HTTPRouteSpecialDataTypeWs) {
+		request_metrics.protocol = HTTPMetricsProtocolWsUpgrade;
+	}
+
+	http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseRouteLookup,
+	                                  route_lookup_start_us);
+
+	// reset after the route was handled, upgraded connections don't send http responses anymore
+	http_general_context_set_request_metrics(general_context, request_metrics);
+
+	// this is checked after the authorization, so that rejected requests never take a slot
+	if(!http_route_limiter_acquire(selected_route_data.route_limiter)) {
+		const HTTPResponseToSend to_send = get_http_route_limiter_busy_response(send_body);
+
+		const GenericResult result =
+		    send_http_message_to_connection(general_context, descriptor, to_send, send_settings);
+
+		http_general_context_set_request_metrics(
+		    general_context, get_default_http_request_metrics(send_settings.protocol_data.version));
+
+		free_selected_route(selected_route);
+
+		IF_GENERIC_RESULT_IS_ERROR_CONST(result) {
+			LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
+			            "Error in sending response: " TSTR_FMT "\n",
+			            TSTR_STATIC_FMT_ARGS(error.error));
+		}
+
+		return JOB_ERROR_NONE;
+	}
+
 	GenericResult result = GENERIC_RES_ERR_UNIQUE();
 
 	switch(route_data.type) {
@@ -402,6 +473,12 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 
 					LOG_MESSAGE_SIMPLE(LogLevelInfo, "Shutdown requested!\n");
 
+					atomic_store(&g_shutdown_requested, true);
+
+					// this is the last request on this connection
+					send_settings.persistence.type = HttpConnectionPersistenceTypeClose;
+					http_reader_disable_keep_alive(http_reader);
+
 					HTTPResponseToSend to_send = { .status = HttpStatusOk,
 						                           .body = body,
 						                           .mime_type = MIME_TYPE_TEXT,
@@ -504,7 +581,9 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 			result = route_manager_execute_route(route_manager, route_data.value.normal, descriptor,
 			                                     general_context, send_settings, http_request,
 			                                     context, selected_route_data.path,
-			                                     selected_route_data.auth_user, address);
+			                                     selected_route_data.params,
+			                                     selected_route_data.auth_user,
+			                                     selected_route_data.response_cache, address);
 
 			break;
 		}
@@ -513,12 +592,55 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 			                                         route_data.value.internal.send, send_settings);
 			break;
 		}
+		case HTTPRouteTypeConstant: {
+			result = route_manager_execute_constant_route(
+			    route_manager, &(route_data.value.constant), descriptor, general_context,
+			    send_settings, http_request, address);
+			break;
+		}
+		case HTTPRouteTypeReverseProxy: {
+			if(http_properties.type != HTTPPropertyTypeNormal) {
+				HTTPResponseToSend to_send = {
+					.status = HttpStatusInternalServerError,
+					.body = http_response_body_from_static_string(
+					    "Internal Server Error: Not allowed internal type: HTTPPropertyType",
+					    send_body),
+					.mime_type = MIME_TYPE_TEXT,
+					.additional_headers = TVEC_EMPTY(HttpHeaderField)
+				};
+
+				result = send_http_message_to_connection(general_context, descriptor, to_send,
+				                                         send_settings);
+				break;
+			}
+
+			const uint64_t executor_start_us = http_server_metrics_get_timestamp_us();
+
+			result = http_upstream_proxy_request(
+			    route_data.value.reverse_proxy.upstreams, descriptor, general_context,
+			    send_settings, http_request, http_properties.data.normal, address);
+
+			http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseExecutor,
+			                                  executor_start_us);
+
+			IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
+				// a partially relayed response leaves the connection in an undefined state
+				http_reader_disable_keep_alive(http_reader);
+			}
+
+			break;
+		}
 		case HTTPRouteTypeServeFolder: {
 			const HTTPRouteServeFolder data = route_data.value.serve_folder;
 
+			const uint64_t executor_start_us = http_server_metrics_get_timestamp_us();
+
 			ServeFolderResult* serve_folder_result =
 			    get_serve_folder_content(http_properties, data, selected_route_data, send_body);
 
+			http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseExecutor,
+			                                  executor_start_us);
+
 			if(serve_folder_result == NULL) {
 				HTTPResponseToSend to_send = {
 					.status = HttpStatusInternalServerError,
@@ -539,19 +661,7 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 					HttpHeaderFields additional_headers = TVEC_EMPTY(HttpHeaderField);
 
 					{
-						Time now;
-
-						bool success = get_current_time(&now);
-
-						if(success) {
-							char* date_str = get_date_string(now, TimeFormatHTTP1Dot1);
-							if(date_str != NULL) {
-
-								add_http_header_field(&additional_headers,
-								                      tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
-								                      tstr_own_cstr(date_str));
-							}
-						}
+						add_http_date_header_field(&additional_headers);
 					}
 
 					// TODO(Totto): send a info page
@@ -602,6 +712,7 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 							    &content_disposition_buffer,
 							    {
 								    TVEC_FREE(HttpHeaderField, &additional_headers);
+								    http_route_limiter_release(selected_route_data.route_limiter);
 								    return NULL;
 							    },
 							    "attachment; filename=\"" TSTR_FMT "\"",
@@ -614,20 +725,7 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 						}
 
 						{
-							Time now;
-
-							bool success = get_current_time(&now);
-
-							if(success) {
-								char* date_str = get_date_string(now, TimeFormatHTTP1Dot1);
-								if(date_str != NULL) {
-
-									add_http_header_field(
-									    &additional_headers,
-									    tstr_from_static_tstr(HTTP_HEADER_NAME(date)),
-									    tstr_own_cstr(date_str));
-								}
-							}
+							add_http_date_header_field(&additional_headers);
 						}
 					}
 
@@ -750,6 +848,11 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 		}
 	}
 
+	http_route_limiter_release(selected_route_data.route_limiter);
+
+	http_general_context_set_request_metrics(
+	    general_context, get_default_http_request_metrics(send_settings.protocol_data.version));
+
 	free_selected_route(selected_route);
 
 	IF_GENERIC_RESULT_IS_ERROR_CONST(result) {
@@ -762,6 +865,91 @@ process_http_request(const HttpRequest http_request, ConnectionDescriptor* const
 
 #undef FREE_AT_END
 
+// waits for the next request on a keep-alive connection, the wait is given up early, if the server
+// shuts down or other connections wait for a worker of the pool, as an idle connection would
+// otherwise block that worker
+NODISCARD static HttpReaderWaitResult
+wait_for_next_http_request_impl(HTTPReader* const http_reader,
+                                const HTTPConnectionArgument* const argument) {
+
+	const uint32_t idle_timeout_ms = argument->reader_settings.keep_alive.idle_timeout_ms;
+
+	uint32_t waited_ms = 0;
+
+	while(true) {
+
+		const uint32_t remaining_ms = idle_timeout_ms - waited_ms;
+
+		const uint32_t slice_ms = remaining_ms < HTTP_KEEP_ALIVE_POLL_INTERVAL_MS
+		                              ? remaining_ms
+		                              : HTTP_KEEP_ALIVE_POLL_INTERVAL_MS;
+
+		const HttpReaderWaitResult wait_result =
+		    http_reader_wait_for_next_request(http_reader, slice_ms);
+
+		if(wait_result != HttpReaderWaitResultTimeout) {
+			return wait_result;
+		}
+
+		waited_ms += slice_ms;
+
+		if(waited_ms >= idle_timeout_ms) {
+			return HttpReaderWaitResultTimeout;
+		}
+
+		if(atomic_load(&g_shutdown_requested) || g_signal_received != 0) {
+			return HttpReaderWaitResultTimeout;
+		}
+
+		if(pool_has_pending_jobs(argument->pool)) {
+			// yield this worker to the waiting connections
+			return HttpReaderWaitResultTimeout;
+		}
+	}
+}
+
+// the worker isn't counted as busy, while the connection waits idle, otherwise a few idle
+// keep-alive connections would make the pool look saturated, e.g. for the compression policy
+NODISCARD static HttpReaderWaitResult
+wait_for_next_http_request(HTTPReader* const http_reader,
+                           const HTTPConnectionArgument* const argument) {
+
+	pool_mark_worker_idle(argument->pool);
+
+	const HttpReaderWaitResult wait_result =
+	    wait_for_next_http_request_impl(http_reader, argument);
+
+	pool_mark_worker_busy(argument->pool);
+
+	return wait_result;
+}
+
+// the phases before the first request, they are measured once per connection
+typedef struct {
+	uint64_t queue_wait_us;
+	uint64_t tls_handshake_us;
+	bool recorded;
+} HTTPConnectionPhases;
+
+static void observe_http_connection_phases(HTTPConnectionPhases* const connection_phases,
+                                           const HTTPRequestMetrics request_metrics,
+                                           const bool is_secure) {
+
+	if(connection_phases->recorded) {
+		return;
+	}
+
+	connection_phases->recorded = true;
+
+	http_server_metrics_observe_phase_duration(request_metrics, HTTPRequestPhaseQueueWait,
+	                                           connection_phases->queue_wait_us);
+
+	if(is_secure) {
+		http_server_metrics_observe_phase_duration(request_metrics, HTTPRequestPhaseTlsHandshake,
+		                                           connection_phases->tls_handshake_us);
+	}
+}
+
 // the connectionHandler, that ist the thread spawned by the listener, or better said by the thread
 // pool, but the listener adds it
 // it receives all the necessary information and also handles the html parsing and response
@@ -777,7 +965,8 @@ http_socket_connection_handler(ANY_TYPE(HTTPConnectionArgument*) arg_ign,
 	    TVEC_AT(ConnectionContextPtr, argument->contexts, worker_info.worker_index);
 
 	char* thread_name_buffer = NULL;
-	FORMAT_STRING(&thread_name_buffer, return JOB_ERROR_STRING_FORMAT;
+	FORMAT_STRING(&thread_name_buffer, client_limiter_release_connection(argument->address);
+	              return JOB_ERROR_STRING_FORMAT;
 	              , "connection handler %lu", worker_info.worker_index);
 	set_thread_name(thread_name_buffer);
 
@@ -785,6 +974,7 @@ http_socket_connection_handler(ANY_TYPE(HTTPConnectionArgument*) arg_ign,
 
 #define FREE_AT_END() \
 	do { \
+		client_limiter_release_connection(argument->address); \
 		unset_thread_name(); \
 		free(thread_name_buffer); \
 		free(argument); \
@@ -799,9 +989,30 @@ http_socket_connection_handler(ANY_TYPE(HTTPConnectionArgument*) arg_ign,
 
 	LOG_MESSAGE_SIMPLE(LogLevelTrace, "Starting Connection handler\n");
 
+	// the protocol is only known after the first request, so these are recorded then
+	HTTPConnectionPhases connection_phases = {
+		.queue_wait_us = 0,
+		.tls_handshake_us = 0,
+		.recorded = false,
+	};
+
+	const uint64_t descriptor_start_us = http_server_metrics_get_timestamp_us();
+
+	if(argument->accepted_at_us != 0 && descriptor_start_us >= argument->accepted_at_us) {
+		connection_phases.queue_wait_us = descriptor_start_us - argument->accepted_at_us;
+	}
+
 	ConnectionDescriptor* const descriptor =
 	    get_connection_descriptor(context, argument->connection_fd);
 
+	if(is_secure_context(context)) {
+		const uint64_t descriptor_end_us = http_server_metrics_get_timestamp_us();
+
+		if(descriptor_start_us != 0 && descriptor_end_us >= descriptor_start_us) {
+			connection_phases.tls_handshake_us = descriptor_end_us - descriptor_start_us;
+		}
+	}
+
 	if(descriptor == NULL) {
 		LOG_MESSAGE_SIMPLE(LogLevelError, "get_connection_descriptor failed\n");
 
@@ -809,9 +1020,12 @@ http_socket_connection_handler(ANY_TYPE(HTTPConnectionArgument*) arg_ign,
 		return JOB_ERROR_DESC;
 	}
 
+	http_server_metrics_connection_opened();
+
 	JobError job_error = JOB_ERROR_NONE;
 
-	HTTPReader* http_reader = initialize_http_reader_from_connection(descriptor);
+	HTTPReader* http_reader =
+	    initialize_http_reader_from_connection(descriptor, argument->reader_settings);
 
 	if(!http_reader) {
 		HTTPResponseToSend to_send = { .status = HttpStatusInternalServerError,
@@ -840,6 +1054,17 @@ http_socket_connection_handler(ANY_TYPE(HTTPConnectionArgument*) arg_ign,
 
 	do {
 
+		// this only waits on idle keep-alive connections
+		const HttpReaderWaitResult wait_result = wait_for_next_http_request(http_reader, argument);
+
+		if(wait_result != HttpReaderWaitResultReady) {
+			// the client closed the connection or was idle for too long, that is no error
+			job_error = JOB_ERROR_NONE;
+			goto cleanup;
+		}
+
+		const uint64_t header_parse_start_us = http_server_metrics_get_timestamp_us();
+
 		// raw_http_request gets freed in here
 		HttpRequestResult http_request_result = get_http_request(http_reader);
 
@@ -867,6 +1092,34 @@ http_socket_connection_handler(ANY_TYPE(HTTPConnectionArgument*) arg_ign,
 				const HTTPResultOk http_result = http_request_result.value.ok;
 				const HttpRequest http_request = http_result.request;
 
+				const HTTPRequestMetrics request_metrics = get_default_http_request_metrics(
+				    http_result.settings.protocol_data.version);
+
+				http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseHeaderParse,
+				                                  header_parse_start_us);
+
+				observe_http_connection_phases(&connection_phases, request_metrics,
+				                               is_secure_context(context));
+
+				uint32_t retry_after_s = 0;
+
+				if(!client_limiter_allow_request(argument->address, &retry_after_s)) {
+					const GenericResult result = send_too_many_requests(
+					    descriptor, general_context, http_result.settings, retry_after_s,
+					    http_request.head.request_line.method != HTTPRequestMethodHead);
+
+					free_http_request_result(http_result);
+
+					IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
+						LOG_MESSAGE_SIMPLE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
+						                   "Error in sending response\n");
+					}
+
+					// the connection is closed, so the worker is free for other clients
+					job_error = JOB_ERROR_NONE;
+					goto cleanup;
+				}
+
 				JobError process_error = process_http_request(
 				    http_request, descriptor, http_reader, route_manager, argument, worker_info,
 				    http_result.settings, argument->address);
@@ -909,8 +1162,21 @@ cleanup:
 	// TODO(Totto): should we log, if the reader had an error or what the reason for the exit of the
 	// loop was?
 
+	if(http_reader != NULL) {
+		// responses to pipelined requests may still be queued
+		const GenericResult flush_result = http_general_context_flush_http1_output(
+		    http_reader_get_general_context(http_reader), descriptor);
+
+		IF_GENERIC_RESULT_IS_ERROR_IGN(flush_result) {
+			LOG_MESSAGE_SIMPLE(COMBINE_LOG_FLAGS(LogLevelError, LogPrintLocation),
+			                   "Error in sending queued responses\n");
+		}
+	}
+
 	bool finished_cleanly = finish_reader(http_reader, context);
 
+	http_server_metrics_connection_closed();
+
 	// free the malloced stuff
 	// needs to be called at the very end, as some things here are in use by the http_reader
 	FREE_AT_END();
@@ -972,6 +1238,7 @@ ANY_TYPE(ListenerError*) http_listener_thread_function(ANY_TYPE(HTTPThreadArgume
 			// TODO(Totto): This fd isn't closed, when pthread_cancel is called from somewhere else,
 			// fix that somehow
 			close(poll_fds[1].fd);
+			atomic_store(&g_shutdown_requested, true);
 			RUN_LIFECYCLE_FN(argument.fns.shutdown_fn);
 			int result = pthread_cancel(pthread_self());
 			CHECK_FOR_ERROR(result, "While trying to cancel the listener Thread on signal",
@@ -995,6 +1262,14 @@ ANY_TYPE(ListenerError*) http_listener_thread_function(ANY_TYPE(HTTPThreadArgume
 
 		IPAddress address = from_ipv4(client_addr.sin_addr);
 
+		// rejecting here is the cheapest option, the connection never reaches a worker
+		if(!client_limiter_acquire_connection(address)) {
+			LOG_MESSAGE_SIMPLE(LogLevelTrace,
+			                   "Rejected a connection, the client has too many connections\n");
+			close(connection_fd);
+			continue;
+		}
+
 		HTTPConnectionArgument* connection_argument =
 		    (HTTPConnectionArgument*)malloc(sizeof(HTTPConnectionArgument));
 
@@ -1011,6 +1286,9 @@ ANY_TYPE(ListenerError*) http_listener_thread_function(ANY_TYPE(HTTPThreadArgume
 		connection_argument->web_socket_manager = argument.web_socket_manager;
 		connection_argument->route_manager = argument.route_manager;
 		connection_argument->address = address;
+		connection_argument->pool = argument.pool;
+		connection_argument->reader_settings = argument.reader_settings;
+		connection_argument->accepted_at_us = http_server_metrics_get_timestamp_us();
 
 		// push to the queue, but not await, since when we wait it wouldn't be fast and
 		// ready to accept new connections
@@ -1064,7 +1342,8 @@ ANY_TYPE(ListenerError*) http_listener_thread_function(ANY_TYPE(HTTPThreadArgume
 
 ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
                            AuthenticationProviders* const auth_providers,
-                           HTTPRoutes* const routes) {
+                           HTTPRoutes* const routes,
+                           const ClientLimiterOptions* const client_limiter_options) {
 
 	// using TCP  and not 0, which is more explicit about what protocol to use
 	// so essentially a socket is created, the protocol is AF_INET alias the IPv4 Prototol,
@@ -1259,6 +1538,18 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 								    COMBINE_LOG_FLAGS(LogLevelTrace, LogPrintNoPrelude), "WS\n");
 								break;
 							}
+							case HTTPRouteSpecialDataTypeSessionCreate: {
+								LOG_MESSAGE_SIMPLE(
+								    COMBINE_LOG_FLAGS(LogLevelTrace, LogPrintNoPrelude),
+								    "Session\n");
+								break;
+							}
+							case HTTPRouteSpecialDataTypeSessionRevoke: {
+								LOG_MESSAGE_SIMPLE(
+								    COMBINE_LOG_FLAGS(LogLevelTrace, LogPrintNoPrelude),
+								    "Session revoke\n");
+								break;
+							}
 							default: {
 								LOG_MESSAGE_SIMPLE(
 								    COMBINE_LOG_FLAGS(LogLevelTrace, LogPrintNoPrelude),
@@ -1275,6 +1566,18 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 
 						break;
 					}
+					case HTTPRouteTypeConstant: {
+						LOG_MESSAGE(COMBINE_LOG_FLAGS(LogLevelTrace, LogPrintNoPrelude),
+						            "Constant: %d\n", route.data.value.constant.status);
+
+						break;
+					}
+					case HTTPRouteTypeReverseProxy: {
+						LOG_MESSAGE_SIMPLE(COMBINE_LOG_FLAGS(LogLevelTrace, LogPrintNoPrelude),
+						                   "Reverse Proxy\n");
+
+						break;
+					}
 					case HTTPRouteTypeServeFolder: {
 
 						const HTTPRouteServeFolder data = route.data.value.serve_folder;
@@ -1309,6 +1612,17 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 		return ExitCodeFailure;
 	}
 
+	struct sigaction reopen_action = {};
+
+	reopen_action.sa_handler = receive_reopen_signal;
+	reopen_action.sa_flags = SA_RESTART;
+	int empty_reopen_set_result = sigemptyset(&reopen_action.sa_mask);
+	int result2 = sigaction(SIGHUP, &reopen_action, NULL);
+	if(result2 < 0 || empty_reopen_set_result < 0) {
+		LOG_MESSAGE(LogLevelError, "Couldn't set signal interception: %s\n", strerror(errno));
+		return ExitCodeFailure;
+	}
+
 	// create pool and queue! then initializing both!
 	// the pool is created and destroyed outside of the listener, so the listener can be
 	// cancelled and then the main thread destroys everything accordingly
@@ -1379,6 +1693,27 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 	// create global http arguments
 	global_initialize_http_global_data();
 
+	global_initialize_compression_policy(get_default_compression_policy(), &pool);
+
+	// the pool outlives all scrapes, as they are handled by its workers
+	global_initialize_http_server_metrics(&pool);
+
+	route_manager_prebuild_responses(route_manager);
+
+	// blocking and cpu heavy work gets its own threads, so it can't occupy all workers
+	if(!global_initialize_offload_pool(get_default_offload_pool_options(), &pool)) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn,
+		                   "Couldn't initialize the offload pool, heavy work is run inline\n");
+	}
+
+	// if enabled, a single client can't occupy all workers, neither with connections nor with
+	// requests
+	if(client_limiter_options != NULL &&
+	   !global_initialize_client_limiter(*client_limiter_options, &pool)) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn,
+		                   "Couldn't initialize the client limiter, clients aren't limited\n");
+	}
+
 	// initializing the thread Arguments for the single listener thread, it receives all
 	// necessary arguments
 	pthread_t listener_thread = {};
@@ -1388,6 +1723,7 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 		                                   .socket_fd = socket_fd,
 		                                   .web_socket_manager = web_socket_manager,
 		                                   .route_manager = route_manager,
+		                                   .reader_settings = get_default_http_reader_settings(),
 		                                   .fns = { .startup_fn = NULL, .shutdown_fn = NULL } };
 
 	// creating the thread
@@ -1436,6 +1772,15 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 		}
 	}
 
+	// the policy must not reference the pool after it is destroyed
+	global_free_compression_policy();
+
+	// no worker can offload work anymore
+	global_free_offload_pool();
+
+	// all connections are finished, so none of them releases its slot anymore
+	global_free_client_limiter();
+
 	// then after all were awaited the pool is destroyed
 	const GenericResult destroy_result1 = pool_destroy(&pool);
 
@@ -1484,6 +1829,9 @@ ExitCode start_http_server(const uint16_t port, SecureOptions* const options,
 	openssl_cleanup_global_state();
 #endif
 
+	// the route manager, that held the route metrics, is already freed
+	global_free_http_server_metrics();
+
 	global_free_http_global_data();
 
 	return ExitCodeSuccess;
@@ -1493,9 +1841,11 @@ void global_initialize_http_global_data(void) {
 	global_initialize_mime_map();
 	global_initialize_locale_for_http();
 	global_initialize_http2_hpack_data();
+	global_start_clock_service();
 }
 
 void global_free_http_global_data(void) {
+	global_stop_clock_service();
 	global_free_mime_map();
 	global_free_locale_for_http();
 	global_free_http2_hpack_data();
@@ -11,7 +11,9 @@
 // stay in the same file
 #include "./routes.h"
 #include "generic/authentication.h"
+#include "generic/client_limiter.h"
 #include "generic/secure.h"
+#include "http/parser.h"
 #include "http/protocol.h"
 #include "utils/thread_pool.h"
 #include "ws/thread_manager.h"
@@ -19,12 +21,20 @@
 // some general utils used in more programs, so saved into header!
 #include "utils/utils.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // specific numbers for the task, these are arbitrary, but suited for that problem
 
 #define HTTP_SOCKET_BACKLOG_SIZE 10
 
 #define HTTP_MAX_QUEUE_SIZE 100
 
+// the idle wait of keep-alive connections is split into slices of this length, so that idle
+// connections notice a shutdown or waiting connections fast
+#define HTTP_KEEP_ALIVE_POLL_INTERVAL_MS 100
+
 // structs for the listenerThread
 
 typedef struct {
@@ -34,6 +44,7 @@ typedef struct {
 	NativeFd socket_fd;
 	WebSocketThreadManager* web_socket_manager;
 	const RouteManager* route_manager;
+	HttpReaderSettings reader_settings;
 	LifecycleFunctions fns;
 } HTTPThreadArgument;
 
@@ -44,6 +55,10 @@ typedef struct {
 	WebSocketThreadManager* web_socket_manager;
 	const RouteManager* route_manager;
 	IPAddress address;
+	ThreadPool* pool;
+	HttpReaderSettings reader_settings;
+	// see http_server_metrics_get_timestamp_us, used for the queue wait
+	uint64_t accepted_at_us;
 } HTTPConnectionArgument;
 
 // the connectionHandler, that ist the thread spawned by the listener, or better said by the thread
@@ -58,10 +73,16 @@ NODISCARD ANY_TYPE(JobError*)
 // trough the argument
 NODISCARD ANY_TYPE(NULL) http_listener_thread_function(ANY_TYPE(HTTPThreadArgument*) arg);
 
+// the client limiter is only used, if its options are given
 NODISCARD ExitCode start_http_server(uint16_t port, MOVED(SecureOptions* options),
                                      MOVED(AuthenticationProviders* auth_providers),
-                                     MOVED(HTTPRoutes* routes));
+                                     MOVED(HTTPRoutes* routes),
+                                     const ClientLimiterOptions* NULLABLE client_limiter_options);
 
 void global_initialize_http_global_data(void);
 
 void global_free_http_global_data(void);
+
+#ifdef __cplusplus
+}
+#endif
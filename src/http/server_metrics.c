@@ -0,0 +1,334 @@
+
+#include "./server_metrics.h"
+#include "generic/send.h"
+#include "utils/clock.h"
+
+struct HTTPRouteMetricsImpl {
+	// index 0 is 1xx, index 4 is 5xx
+	MetricsCounter* responses[HTTP_STATUS_CLASS_AMOUNT];
+	// NULL for the phases before the route lookup
+	MetricsHistogram* phases[HTTP_REQUEST_PHASE_AMOUNT];
+};
+
+typedef struct {
+	MetricsCounter* requests;
+	MetricsCounter* responses[HTTP_STATUS_CLASS_AMOUNT];
+	MetricsCounter* sent_bytes;
+	MetricsGauge* active_connections;
+	MetricsHistogram* phases[HTTP_METRICS_PROTOCOL_AMOUNT][HTTP_REQUEST_PHASE_AMOUNT];
+} HTTPServerMetrics;
+
+static HTTPServerMetrics
+    g_http_server_metrics = { // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+	    .requests = NULL,
+	    .responses = { NULL },
+	    .sent_bytes = NULL,
+	    .active_connections = NULL,
+	    .phases = { { NULL } },
+    };
+
+static const char* const g_http_status_class_names[HTTP_STATUS_CLASS_AMOUNT] = {
+	"1xx", "2xx", "3xx", "4xx", "5xx",
+};
+
+static const char* const g_http_request_phase_names[HTTP_REQUEST_PHASE_AMOUNT] = {
+	[HTTPRequestPhaseQueueWait] = "queue_wait",
+	[HTTPRequestPhaseTlsHandshake] = "tls_handshake",
+	[HTTPRequestPhaseHeaderParse] = "header_parse",
+	[HTTPRequestPhaseRouteLookup] = "route_lookup",
+	[HTTPRequestPhaseExecutor] = "executor",
+	[HTTPRequestPhaseCompression] = "compression",
+	[HTTPRequestPhaseSend] = "send",
+};
+
+static const char* const g_http_metrics_protocol_names[HTTP_METRICS_PROTOCOL_AMOUNT] = {
+	[HTTPMetricsProtocolHttp1] = "http1",
+	[HTTPMetricsProtocolHttp2] = "http2",
+	[HTTPMetricsProtocolWsUpgrade] = "ws_upgrade",
+};
+
+// the buckets are log-linear, like in hdr histograms, every power of two from 8us up to about 33s
+// is split into 8 linear sub-buckets, so that the relative error is at most 12.5% for fast and
+// slow phases alike
+#define HTTP_PHASE_HISTOGRAM_FIRST_POWER 3
+#define HTTP_PHASE_HISTOGRAM_LAST_POWER 25
+#define HTTP_PHASE_HISTOGRAM_SUB_BUCKETS 8
+
+// the first bound is 2^first_power, the others are the sub-buckets up to 2^last_power
+#define HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT \
+	(1 + ((HTTP_PHASE_HISTOGRAM_LAST_POWER - HTTP_PHASE_HISTOGRAM_FIRST_POWER) * \
+	      HTTP_PHASE_HISTOGRAM_SUB_BUCKETS))
+
+static_assert(HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT <= METRICS_HISTOGRAM_MAX_BUCKETS);
+
+// the bounds are copied on registration, so they can be filled on the stack of the caller
+static void get_http_phase_histogram_bounds(uint64_t bounds[HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT]) {
+
+	size_t index = 0;
+
+	bounds[index++] = ((uint64_t)1) << HTTP_PHASE_HISTOGRAM_FIRST_POWER;
+
+	for(size_t power = HTTP_PHASE_HISTOGRAM_FIRST_POWER; power < HTTP_PHASE_HISTOGRAM_LAST_POWER;
+	    ++power) {
+		const uint64_t base = ((uint64_t)1) << power;
+		// the first power is at least 8, so the steps are whole microseconds
+		const uint64_t step = base / HTTP_PHASE_HISTOGRAM_SUB_BUCKETS;
+
+		for(size_t sub_bucket = 1; sub_bucket <= HTTP_PHASE_HISTOGRAM_SUB_BUCKETS; ++sub_bucket) {
+			bounds[index++] = base + (step * sub_bucket);
+		}
+	}
+}
+
+NODISCARD static MetricsHistogramOptions
+get_http_phase_histogram_options(const uint64_t bounds[HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT]) {
+	return (MetricsHistogramOptions){
+		.bounds = bounds,
+		.bound_amount = HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT,
+		.scale = 1.0 / S_TO_US_RATE,
+	};
+}
+
+// only the phases after the route lookup are recorded per route
+NODISCARD static bool is_http_route_phase(const HTTPRequestPhase phase) {
+	return phase >= HTTPRequestPhaseRouteLookup;
+}
+
+NODISCARD HTTPMetricsProtocol get_http_metrics_protocol(const HTTPProtocolVersion version) {
+	return version == HTTPProtocolVersion2 ? HTTPMetricsProtocolHttp2 : HTTPMetricsProtocolHttp1;
+}
+
+NODISCARD HTTPRequestMetrics get_default_http_request_metrics(const HTTPProtocolVersion version) {
+	return (HTTPRequestMetrics){ .route = NULL, .protocol = get_http_metrics_protocol(version) };
+}
+
+// returns HTTP_STATUS_CLASS_AMOUNT for invalid status codes
+NODISCARD static size_t get_http_status_class_index(const HttpStatusCode status) {
+	const size_t status_class = ((size_t)status) / 100; // NOLINT(readability-magic-numbers)
+
+	if(status_class < 1 || status_class > HTTP_STATUS_CLASS_AMOUNT) {
+		return HTTP_STATUS_CLASS_AMOUNT;
+	}
+
+	return status_class - 1;
+}
+
+NODISCARD static int64_t get_http_server_queue_depth(void* data) {
+	ThreadPool* pool = (ThreadPool*)data;
+
+	return (int64_t)pool_get_pending_jobs_amount(pool);
+}
+
+NODISCARD static int64_t get_http_server_busy_workers(void* data) {
+	const ThreadPool* pool = (const ThreadPool*)data;
+
+	return (int64_t)pool_get_busy_workers(pool);
+}
+
+NODISCARD static int64_t get_http_server_worker_threads(void* data) {
+	const ThreadPool* pool = (const ThreadPool*)data;
+
+	return (int64_t)pool->worker_threads_amount;
+}
+
+void global_initialize_http_server_metrics(ThreadPool* const pool) {
+
+	const MetricsLabels no_labels = { .labels = NULL, .label_amount = 0 };
+
+	g_http_server_metrics.requests = metrics_register_counter(
+	    "http_requests_total", "The amount of parsed http requests", no_labels);
+
+	for(size_t i = 0; i < HTTP_STATUS_CLASS_AMOUNT; ++i) {
+		const MetricsLabel label = { .name = "code", .value = g_http_status_class_names[i] };
+
+		g_http_server_metrics.responses[i] = metrics_register_counter(
+		    "http_responses_total", "The amount of sent http responses by status class",
+		    (MetricsLabels){ .labels = &label, .label_amount = 1 });
+	}
+
+	g_http_server_metrics.sent_bytes = metrics_register_counter(
+	    "connection_sent_bytes_total",
+	    "The amount of bytes written to connections, including tls and websocket connections",
+	    no_labels);
+
+	global_set_sent_bytes_counter(g_http_server_metrics.sent_bytes);
+
+	g_http_server_metrics.active_connections = metrics_register_gauge(
+	    "http_active_connections", "The amount of http connections, that are currently handled",
+	    no_labels);
+
+	uint64_t phase_bounds[HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT];
+	get_http_phase_histogram_bounds(phase_bounds);
+
+	for(size_t protocol = 0; protocol < HTTP_METRICS_PROTOCOL_AMOUNT; ++protocol) {
+		for(size_t phase = 0; phase < HTTP_REQUEST_PHASE_AMOUNT; ++phase) {
+			const MetricsLabel labels[] = {
+				{ .name = "protocol", .value = g_http_metrics_protocol_names[protocol] },
+				{ .name = "phase", .value = g_http_request_phase_names[phase] },
+			};
+
+			g_http_server_metrics.phases[protocol][phase] = metrics_register_histogram(
+			    "http_request_phase_seconds", "The duration of the phases of http requests",
+			    (MetricsLabels){ .labels = labels,
+			                     .label_amount = sizeof(labels) / sizeof(*labels) },
+			    get_http_phase_histogram_options(phase_bounds));
+		}
+	}
+
+	if(pool == NULL) {
+		return;
+	}
+
+	bool success = metrics_register_gauge_callback(
+	    "http_worker_queue_depth", "The amount of connections, that wait for a worker", no_labels,
+	    get_http_server_queue_depth, pool);
+
+	success = metrics_register_gauge_callback(
+	              "http_worker_busy", "The amount of workers, that currently handle a connection",
+	              no_labels, get_http_server_busy_workers, pool) &&
+	          success;
+
+	success = metrics_register_gauge_callback("http_worker_threads", "The amount of workers",
+	                                          no_labels, get_http_server_worker_threads, pool) &&
+	          success;
+
+	if(!success) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn, "Couldn't register the worker pool metrics\n");
+	}
+}
+
+void global_free_http_server_metrics(void) {
+
+	global_set_sent_bytes_counter(NULL);
+
+	g_http_server_metrics = (HTTPServerMetrics){
+		.requests = NULL,
+		.responses = { NULL },
+		.sent_bytes = NULL,
+		.active_connections = NULL,
+		.phases = { { NULL } },
+	};
+
+	global_free_metrics();
+}
+
+NODISCARD HTTPRouteMetrics* initialize_http_route_metrics(const char* const route_path) {
+
+	HTTPRouteMetrics* route_metrics = malloc(sizeof(HTTPRouteMetrics));
+
+	if(route_metrics == NULL) {
+		return NULL;
+	}
+
+	for(size_t i = 0; i < HTTP_STATUS_CLASS_AMOUNT; ++i) {
+		const MetricsLabel labels[] = {
+			{ .name = "route", .value = route_path },
+			{ .name = "code", .value = g_http_status_class_names[i] },
+		};
+
+		// a failed registration only means, that this counter is missing
+		route_metrics->responses[i] = metrics_register_counter(
+		    "http_route_responses_total",
+		    "The amount of sent http responses by route and status class",
+		    (MetricsLabels){ .labels = labels, .label_amount = sizeof(labels) / sizeof(*labels) });
+	}
+
+	uint64_t phase_bounds[HTTP_PHASE_HISTOGRAM_BOUND_AMOUNT];
+	get_http_phase_histogram_bounds(phase_bounds);
+
+	for(size_t phase = 0; phase < HTTP_REQUEST_PHASE_AMOUNT; ++phase) {
+		route_metrics->phases[phase] = NULL;
+
+		if(!is_http_route_phase((HTTPRequestPhase)phase)) {
+			continue;
+		}
+
+		const MetricsLabel labels[] = {
+			{ .name = "route", .value = route_path },
+			{ .name = "phase", .value = g_http_request_phase_names[phase] },
+		};
+
+		route_metrics->phases[phase] = metrics_register_histogram(
+		    "http_route_phase_seconds", "The duration of the phases of http requests by route",
+		    (MetricsLabels){ .labels = labels, .label_amount = sizeof(labels) / sizeof(*labels) },
+		    get_http_phase_histogram_options(phase_bounds));
+	}
+
+	return route_metrics;
+}
+
+void free_http_route_metrics(HTTPRouteMetrics* const route_metrics) {
+	free(route_metrics);
+}
+
+void http_server_metrics_request_received(void) {
+	metrics_counter_increment(g_http_server_metrics.requests);
+}
+
+void http_server_metrics_response_sent(const HTTPRequestMetrics request_metrics,
+                                       const HttpStatusCode status) {
+
+	const size_t status_class = get_http_status_class_index(status);
+
+	if(status_class == HTTP_STATUS_CLASS_AMOUNT) {
+		return;
+	}
+
+	metrics_counter_increment(g_http_server_metrics.responses[status_class]);
+
+	if(request_metrics.route != NULL) {
+		metrics_counter_increment(request_metrics.route->responses[status_class]);
+	}
+}
+
+void http_server_metrics_connection_opened(void) {
+	metrics_gauge_add(g_http_server_metrics.active_connections, 1);
+}
+
+void http_server_metrics_connection_closed(void) {
+	metrics_gauge_add(g_http_server_metrics.active_connections, -1);
+}
+
+NODISCARD uint64_t http_server_metrics_get_timestamp_us(void) {
+	Time now;
+
+	if(!get_monotonic_time(&now)) {
+		return 0;
+	}
+
+	return get_time_in_nano_seconds(now) / (S_TO_NS_RATE / S_TO_US_RATE);
+}
+
+void http_server_metrics_observe_phase_duration(const HTTPRequestMetrics request_metrics,
+                                                const HTTPRequestPhase phase,
+                                                const uint64_t duration_us) {
+
+	if(phase >= HTTP_REQUEST_PHASE_AMOUNT ||
+	   request_metrics.protocol >= HTTP_METRICS_PROTOCOL_AMOUNT) {
+		return;
+	}
+
+	metrics_histogram_observe(g_http_server_metrics.phases[request_metrics.protocol][phase],
+	                          duration_us);
+
+	if(request_metrics.route != NULL) {
+		metrics_histogram_observe(request_metrics.route->phases[phase], duration_us);
+	}
+}
+
+void http_server_metrics_observe_phase(const HTTPRequestMetrics request_metrics,
+                                       const HTTPRequestPhase phase, const uint64_t start_us) {
+
+	if(start_us == 0) {
+		return;
+	}
+
+	const uint64_t now_us = http_server_metrics_get_timestamp_us();
+
+	// the clock is monotonic, but a failed read returns 0
+	if(now_us < start_us) {
+		return;
+	}
+
+	http_server_metrics_observe_phase_duration(request_metrics, phase, now_us - start_us);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "./protocol.h"
+#include "utils/metrics.h"
+#include "utils/thread_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the metrics of the http server, see utils/metrics.h, they are exported by the /metrics route
+
+// status codes are counted per class, as counting every single code per route would create a lot
+// of series, that are nearly always 0
+#define HTTP_STATUS_CLASS_AMOUNT 5
+
+typedef struct HTTPRouteMetricsImpl HTTPRouteMetrics;
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	// from accepting the connection, until a worker picks it up
+	HTTPRequestPhaseQueueWait = 0,
+	HTTPRequestPhaseTlsHandshake,
+	// includes reading the request from the connection
+	HTTPRequestPhaseHeaderParse,
+	// includes the authorization
+	HTTPRequestPhaseRouteLookup,
+	HTTPRequestPhaseExecutor,
+	HTTPRequestPhaseCompression,
+	HTTPRequestPhaseSend,
+} HTTPRequestPhase;
+
+#define HTTP_REQUEST_PHASE_AMOUNT 7
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPMetricsProtocolHttp1 = 0,
+	HTTPMetricsProtocolHttp2,
+	HTTPMetricsProtocolWsUpgrade,
+} HTTPMetricsProtocol;
+
+#define HTTP_METRICS_PROTOCOL_AMOUNT 3
+
+// what the metrics of the request, that is currently handled, are recorded for
+typedef struct {
+	// NULL, if no route matched (yet)
+	const HTTPRouteMetrics* route;
+	HTTPMetricsProtocol protocol;
+} HTTPRequestMetrics;
+
+NODISCARD HTTPMetricsProtocol get_http_metrics_protocol(HTTPProtocolVersion version);
+
+NODISCARD HTTPRequestMetrics get_default_http_request_metrics(HTTPProtocolVersion version);
+
+// the pool is used for the queue depth and the busy workers, it has to outlive all scrapes, this
+// has to be called before any worker uses the metrics
+void global_initialize_http_server_metrics(ThreadPool* pool);
+
+// this also frees all other registered metrics
+void global_free_http_server_metrics(void);
+
+// the counters and histograms are registered with the route path as label, returns NULL on error
+NODISCARD HTTPRouteMetrics* initialize_http_route_metrics(const char* route_path);
+
+// only frees the handles, the counters stay registered, until the global metrics are freed
+void free_http_route_metrics(HTTPRouteMetrics* route_metrics);
+
+void http_server_metrics_request_received(void);
+
+// if no route matched, only the global counters are incremented
+void http_server_metrics_response_sent(HTTPRequestMetrics request_metrics, HttpStatusCode status);
+
+// a monotonic timestamp in microseconds, for http_server_metrics_observe_phase, returns 0 on error
+NODISCARD uint64_t http_server_metrics_get_timestamp_us(void);
+
+// records the time since start_us, the phases are recorded per protocol, the phases after the route
+// lookup also per route
+void http_server_metrics_observe_phase(HTTPRequestMetrics request_metrics, HTTPRequestPhase phase,
+                                       uint64_t start_us);
+
+// the same as http_server_metrics_observe_phase, for durations, that were measured before the
+// protocol was known
+void http_server_metrics_observe_phase_duration(HTTPRequestMetrics request_metrics,
+                                                HTTPRequestPhase phase, uint64_t duration_us);
+
+void http_server_metrics_connection_opened(void);
+
+void http_server_metrics_connection_closed(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1842 @@
+#include "./upstream.h"
+#include "./chunked.h"
+#include "./header.h"
+#include "./server_metrics.h"
+#include "generic/send.h"
+#include "utils/buffered_reader.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+#include "utils/number_parsing.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define HTTP_UPSTREAM_UNIX_PREFIX "unix:"
+
+// a connection from the pool may have been closed by the server, before the request reached it,
+// then the request is sent again on a new connection, if that is allowed, see
+// https://datatracker.ietf.org/doc/html/rfc9112#section-9.3.1
+#define HTTP_UPSTREAM_MAX_ATTEMPTS 2
+
+#define HTTP_UPSTREAM_MAX_HEADER_FIELDS 128
+
+// the lines of the response head are bounded, so that an upstream can't make the proxy buffer an
+// unbounded line
+#define HTTP_UPSTREAM_MAX_HEAD_LINE_LENGTH (1 << 13)
+
+// "<size in hex>\r\n" before and "\r\n" after the data of a chunk
+#define HTTP_UPSTREAM_CHUNK_FRAME_OVERHEAD (sizeof(size_t) * 2 + 2 * SIZEOF_HTTP_LINE_SEPERATORS)
+
+#define HTTP_UPSTREAM_LAST_CHUNK "0" HTTP_LINE_SEPERATORS HTTP_LINE_SEPERATORS
+
+#define HTTP_UPSTREAM_BUSY_RETRY_AFTER_S "1"
+
+typedef struct {
+	BufferedReader* reader;
+	uint64_t idle_since_ms;
+} HTTPUpstreamIdleConnection;
+
+typedef struct {
+	// the name as given in the options, it is used in logs and as metrics label
+	char* name;
+	struct sockaddr_storage address;
+	socklen_t address_length;
+	// a stack, the most recently used connection is on top, so the oldest ones are at the bottom
+	HTTPUpstreamIdleConnection* idle_connections;
+	size_t idle_amount;
+	// idle and in use connections, including the ones, that are currently connecting
+	size_t open_amount;
+	uint32_t consecutive_fails;
+	uint64_t down_until_ms;
+	// NULL, if registering the metrics failed
+	MetricsGauge* outstanding_gauge;
+	MetricsGauge* connections_gauge;
+	MetricsCounter* failures_counter;
+} HTTPUpstreamServer;
+
+struct HTTPUpstreamGroupImpl {
+	HTTPUpstreamOptions options;
+	pthread_mutex_t mutex;
+	// upstream connections never use tls
+	ConnectionContext* context;
+	HTTPUpstreamServer servers[HTTP_UPSTREAM_MAX_SERVERS];
+	size_t server_amount;
+	// the search for the least loaded server starts here, so that ties are spread over all servers
+	size_t next_server;
+};
+
+typedef struct {
+	HTTPUpstreamServer* server;
+	BufferedReader* reader;
+	// set, if the connection was taken from the pool
+	bool reused;
+} HTTPUpstreamConnection;
+
+NODISCARD HTTPUpstreamOptions get_default_http_upstream_options(void) {
+	return (HTTPUpstreamOptions){
+		.max_connections = HTTP_UPSTREAM_DEFAULT_MAX_CONNECTIONS,
+		.max_fails = HTTP_UPSTREAM_DEFAULT_MAX_FAILS,
+		.fail_timeout_ms = HTTP_UPSTREAM_DEFAULT_FAIL_TIMEOUT_MS,
+		.connect_timeout_ms = HTTP_UPSTREAM_DEFAULT_CONNECT_TIMEOUT_MS,
+		.io_timeout_ms = HTTP_UPSTREAM_DEFAULT_IO_TIMEOUT_MS,
+		.idle_timeout_ms = HTTP_UPSTREAM_DEFAULT_IDLE_TIMEOUT_MS,
+	};
+}
+
+NODISCARD static uint64_t get_http_upstream_time_ms(void) {
+	Time now;
+
+	if(!get_coarse_monotonic_time(&now)) {
+		return 0;
+	}
+
+	return get_time_in_milli_seconds(now);
+}
+
+// only the first resolved address of a host is used
+NODISCARD static bool resolve_http_upstream_server(const char* const name,
+                                                   OUT_PARAM(HTTPUpstreamServer) server) {
+
+	const size_t unix_prefix_length = sizeof(HTTP_UPSTREAM_UNIX_PREFIX) - 1;
+
+	if(strncmp(name, HTTP_UPSTREAM_UNIX_PREFIX, unix_prefix_length) == 0) {
+		const char* const path = name + unix_prefix_length;
+		const size_t path_length = strlen(path);
+
+		struct sockaddr_un unix_address = { .sun_family = AF_UNIX };
+
+		if(path_length == 0 || path_length >= sizeof(unix_address.sun_path)) {
+			LOG_MESSAGE(LogLevelError, "Invalid unix socket path of the upstream server '%s'\n",
+			            name);
+			return false;
+		}
+
+		memcpy(unix_address.sun_path, path, path_length + 1);
+
+		memcpy(&(server->address), &unix_address, sizeof(unix_address));
+		server->address_length =
+		    (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_length + 1);
+
+		return true;
+	}
+
+	// "host:port", the host of ipv6 addresses is in brackets
+	const char* const port_separator = strrchr(name, ':');
+
+	if(port_separator == NULL || port_separator == name || port_separator[1] == '\0') {
+		LOG_MESSAGE(LogLevelError, "The upstream server '%s' has no port\n", name);
+		return false;
+	}
+
+	const char* host_start = name;
+	size_t host_length = (size_t)(port_separator - name);
+
+	if(name[0] == '[') {
+		if(host_length <= 2 || name[host_length - 1] != ']') {
+			LOG_MESSAGE(LogLevelError, "Invalid ipv6 address of the upstream server '%s'\n",
+			            name);
+			return false;
+		}
+
+		host_start = name + 1;
+		host_length -= 2;
+	}
+
+	char* const host = strndup(host_start, host_length);
+
+	if(host == NULL) {
+		return false;
+	}
+
+	const struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+
+	struct addrinfo* addresses = NULL;
+
+	const int result = getaddrinfo(host, port_separator + 1, &hints, &addresses);
+
+	free(host);
+
+	if(result != 0) {
+		LOG_MESSAGE(LogLevelError, "Couldn't resolve the upstream server '%s': %s\n", name,
+		            gai_strerror(result));
+		return false;
+	}
+
+	if(addresses == NULL || addresses->ai_addrlen > sizeof(server->address)) {
+		freeaddrinfo(addresses);
+		return false;
+	}
+
+	memcpy(&(server->address), addresses->ai_addr, addresses->ai_addrlen);
+	server->address_length = addresses->ai_addrlen;
+
+	freeaddrinfo(addresses);
+
+	return true;
+}
+
+static void register_http_upstream_server_metrics(HTTPUpstreamServer* const server) {
+
+	const MetricsLabel label = { .name = "upstream", .value = server->name };
+	const MetricsLabels labels = { .labels = &label, .label_amount = 1 };
+
+	// a failed registration only means, that this metric is missing
+	server->outstanding_gauge = metrics_register_gauge(
+	    "http_upstream_requests_in_flight",
+	    "The amount of requests, that are currently forwarded to the upstream server", labels);
+
+	server->connections_gauge = metrics_register_gauge(
+	    "http_upstream_connections",
+	    "The amount of open (idle and in use) connections to the upstream server", labels);
+
+	server->failures_counter = metrics_register_counter(
+	    "http_upstream_failures_total",
+	    "The amount of requests, that failed because of a connection or protocol error of the "
+	    "upstream server",
+	    labels);
+}
+
+static void close_http_upstream_reader(BufferedReader* const reader) {
+
+	if(!finish_buffered_reader(reader, NULL, false)) {
+		LOG_MESSAGE_SIMPLE(LogLevelWarn, "Couldn't close an upstream connection\n");
+	}
+}
+
+NODISCARD HTTPUpstreamGroup* initialize_http_upstream_group(const char* const* const servers,
+                                                            const size_t server_amount,
+                                                            const HTTPUpstreamOptions options) {
+
+	if(server_amount == 0 || server_amount > HTTP_UPSTREAM_MAX_SERVERS) {
+		LOG_MESSAGE(LogLevelError, "An upstream group needs between 1 and %d servers\n",
+		            HTTP_UPSTREAM_MAX_SERVERS);
+		return NULL;
+	}
+
+	HTTPUpstreamGroup* group = malloc(sizeof(HTTPUpstreamGroup));
+
+	if(group == NULL) {
+		return NULL;
+	}
+
+	*group = (HTTPUpstreamGroup){
+		.options = options,
+		.context = NULL,
+		.servers = {},
+		.server_amount = 0,
+		.next_server = 0,
+	};
+
+	if(group->options.max_connections == 0) {
+		group->options.max_connections = HTTP_UPSTREAM_DEFAULT_MAX_CONNECTIONS;
+	}
+
+	const SecureOptions not_secure = { .type = SecureOptionsTypeNotSecure };
+
+	group->context = get_connection_context(&not_secure);
+
+	if(group->context == NULL) {
+		free(group);
+		return NULL;
+	}
+
+	int result = pthread_mutex_init(&group->mutex, NULL);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to initialize the mutex for the upstream group",
+	    free_connection_context(group->context);
+	    free(group);
+	    return NULL;);
+
+	for(size_t i = 0; i < server_amount; ++i) {
+		HTTPUpstreamServer* const server = &(group->servers[i]);
+
+		*server = (HTTPUpstreamServer){
+			.name = strdup(servers[i]),
+			.address = {},
+			.address_length = 0,
+			.idle_connections =
+			    malloc(sizeof(HTTPUpstreamIdleConnection) * group->options.max_connections),
+			.idle_amount = 0,
+			.open_amount = 0,
+			.consecutive_fails = 0,
+			.down_until_ms = 0,
+			.outstanding_gauge = NULL,
+			.connections_gauge = NULL,
+			.failures_counter = NULL,
+		};
+
+		group->server_amount++;
+
+		if(server->name == NULL || server->idle_connections == NULL ||
+		   !resolve_http_upstream_server(servers[i], server)) {
+			free_http_upstream_group(group);
+			return NULL;
+		}
+
+		register_http_upstream_server_metrics(server);
+	}
+
+	return group;
+}
+
+NODISCARD HTTPUpstreamGroup*
+initialize_http_upstream_group_from_list(const char* const server_list,
+                                         const HTTPUpstreamOptions options) {
+
+	char* const list = strdup(server_list);
+
+	if(list == NULL) {
+		return NULL;
+	}
+
+	const char* servers[HTTP_UPSTREAM_MAX_SERVERS] = {};
+	size_t server_amount = 0;
+
+	char* save_pointer = NULL;
+
+	for(char* server = strtok_r(list, ",", &save_pointer); server != NULL;
+	    server = strtok_r(NULL, ",", &save_pointer)) {
+
+		if(server_amount == HTTP_UPSTREAM_MAX_SERVERS) {
+			LOG_MESSAGE(LogLevelError, "An upstream group can have at most %d servers\n",
+			            HTTP_UPSTREAM_MAX_SERVERS);
+			free(list);
+			return NULL;
+		}
+
+		servers[server_amount] = server;
+		++server_amount;
+	}
+
+	// the names are copied
+	HTTPUpstreamGroup* group = initialize_http_upstream_group(servers, server_amount, options);
+
+	free(list);
+
+	return group;
+}
+
+void free_http_upstream_group(HTTPUpstreamGroup* const group) {
+
+	if(group == NULL) {
+		return;
+	}
+
+	for(size_t i = 0; i < group->server_amount; ++i) {
+		HTTPUpstreamServer* const server = &(group->servers[i]);
+
+		for(size_t j = 0; j < server->idle_amount; ++j) {
+			close_http_upstream_reader(server->idle_connections[j].reader);
+		}
+
+		free(server->idle_connections);
+		free(server->name);
+	}
+
+	pthread_mutex_destroy(&group->mutex);
+
+	free_connection_context(group->context);
+
+	free(group);
+}
+
+// connects with a timeout, afterwards the socket is blocking again and single reads and writes
+// time out after io_timeout_ms, returns -1 on error and sets errno
+NODISCARD static NativeFd connect_to_http_upstream_server(const HTTPUpstreamServer* const server,
+                                                          const HTTPUpstreamOptions options) {
+
+	const NativeFd fd =
+	    socket(server->address.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+	if(fd < 0) {
+		return -1;
+	}
+
+	if(connect(fd, (const struct sockaddr*)&(server->address), server->address_length) != 0) {
+
+		if(errno != EINPROGRESS) {
+			const int saved_errno = errno;
+			close(fd);
+			errno = saved_errno;
+			return -1;
+		}
+
+		struct pollfd poll_fd = { .fd = fd, .events = POLLOUT, .revents = 0 };
+
+		const int poll_result = poll(&poll_fd, 1, (int)options.connect_timeout_ms);
+
+		int socket_error = 0;
+		socklen_t socket_error_length = sizeof(socket_error);
+
+		if(poll_result == 0) {
+			socket_error = ETIMEDOUT;
+		} else if(poll_result < 0) {
+			socket_error = errno;
+		} else if(getsockopt(fd, SOL_SOCKET, SO_ERROR, &socket_error, &socket_error_length) !=
+		          0) {
+			socket_error = errno;
+		}
+
+		if(socket_error != 0) {
+			close(fd);
+			errno = socket_error;
+			return -1;
+		}
+	}
+
+	const int flags = fcntl(fd, F_GETFL, 0);
+
+	if(flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0) {
+		const int saved_errno = errno;
+		close(fd);
+		errno = saved_errno;
+		return -1;
+	}
+
+	const struct timeval io_timeout = {
+		.tv_sec = (time_t)(options.io_timeout_ms / S_TO_MS_RATE),
+		.tv_usec = (suseconds_t)((options.io_timeout_ms % S_TO_MS_RATE) * S_TO_MS_RATE),
+	};
+
+	// without the timeouts a hanging upstream server would block the worker forever
+	if(setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &io_timeout, sizeof(io_timeout)) != 0 ||
+	   setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &io_timeout, sizeof(io_timeout)) != 0) {
+		const int saved_errno = errno;
+		close(fd);
+		errno = saved_errno;
+		return -1;
+	}
+
+	if(server->address.ss_family != AF_UNIX) {
+		// the head and the body of a request are written separately
+		const int enabled = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+	}
+
+	return fd;
+}
+
+// an idle connection is readable, if the server closed it or sent something unexpected, the
+// unexpected bytes may also already be in the buffer, e.g. if the server sent more than the framing
+// of the last response said, then they would be read as the head of the next response
+NODISCARD static bool is_idle_http_upstream_connection_usable(BufferedReader* const reader) {
+
+	// this is false, if unconsumed data is buffered
+	if(!buffered_reader_has_more_data(reader)) {
+		return false;
+	}
+
+	struct pollfd poll_fd = {
+		.fd = get_underlying_socket(buffered_reader_get_connection_descriptor(reader)),
+		.events = POLLIN,
+		.revents = 0,
+	};
+
+	return poll(&poll_fd, 1, 0) == 0;
+}
+
+// has to be called with the mutex locked, returns NULL, if no server can take the request, then
+// all_busy is set, if there are healthy servers, that are all at their connection limit
+NODISCARD static HTTPUpstreamServer*
+select_http_upstream_server(HTTPUpstreamGroup* const group, const uint64_t now_ms,
+                            OUT_PARAM(bool) all_busy) {
+
+	HTTPUpstreamServer* best_server = NULL;
+	size_t best_outstanding = 0;
+	bool has_healthy_server = false;
+
+	for(size_t i = 0; i < group->server_amount; ++i) {
+		HTTPUpstreamServer* const server =
+		    &(group->servers[(group->next_server + i) % group->server_amount]);
+
+		if(now_ms < server->down_until_ms) {
+			continue;
+		}
+
+		has_healthy_server = true;
+
+		if(server->idle_amount == 0 && server->open_amount >= group->options.max_connections) {
+			continue;
+		}
+
+		// every request, that is forwarded to the server, uses one connection
+		const size_t outstanding = server->open_amount - server->idle_amount;
+
+		if(best_server == NULL || outstanding < best_outstanding) {
+			best_server = server;
+			best_outstanding = outstanding;
+		}
+	}
+
+	group->next_server = (group->next_server + 1) % group->server_amount;
+
+	*all_busy = best_server == NULL && has_healthy_server;
+
+	return best_server;
+}
+
+// has to be called with the mutex locked, the pooled connections, that were idle for too long,
+// are at the bottom of the stack
+static void close_expired_http_upstream_connections(const HTTPUpstreamGroup* const group,
+                                                    HTTPUpstreamServer* const server,
+                                                    const uint64_t now_ms) {
+
+	size_t expired_amount = 0;
+
+	while(expired_amount < server->idle_amount &&
+	      now_ms - server->idle_connections[expired_amount].idle_since_ms >=
+	          group->options.idle_timeout_ms) {
+		close_http_upstream_reader(server->idle_connections[expired_amount].reader);
+		++expired_amount;
+	}
+
+	if(expired_amount == 0) {
+		return;
+	}
+
+	server->idle_amount -= expired_amount;
+	server->open_amount -= expired_amount;
+
+	memmove(server->idle_connections, server->idle_connections + expired_amount,
+	        sizeof(HTTPUpstreamIdleConnection) * server->idle_amount);
+
+	metrics_gauge_add(server->connections_gauge, -(int64_t)expired_amount);
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPUpstreamReleaseTypeReuse = 0,
+	// the connection can't be reused, but the server did nothing wrong
+	HTTPUpstreamReleaseTypeClose,
+	// counts towards the passive health check of the server
+	HTTPUpstreamReleaseTypeFailed,
+} HTTPUpstreamReleaseType;
+
+// returns the connection to the pool or closes it, the reader may be NULL, if connecting failed
+static void release_http_upstream_connection(HTTPUpstreamGroup* const group,
+                                             const HTTPUpstreamConnection connection,
+                                             HTTPUpstreamReleaseType release_type) {
+
+	HTTPUpstreamServer* const server = connection.server;
+
+	const uint64_t now_ms = get_http_upstream_time_ms();
+
+	bool close_connection = true;
+
+	int result = pthread_mutex_lock(&group->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the upstream group", {
+		    if(connection.reader != NULL) {
+			    close_http_upstream_reader(connection.reader);
+		    }
+		    return;
+	    });
+
+	if(release_type == HTTPUpstreamReleaseTypeFailed) {
+		++(server->consecutive_fails);
+
+		if(group->options.max_fails != 0 &&
+		   server->consecutive_fails >= group->options.max_fails) {
+			LOG_MESSAGE(LogLevelWarn,
+			            "The upstream server '%s' failed %u times in a row, it is skipped for "
+			            "%u ms\n",
+			            server->name, server->consecutive_fails, group->options.fail_timeout_ms);
+
+			server->down_until_ms = now_ms + group->options.fail_timeout_ms;
+			server->consecutive_fails = 0;
+		}
+	} else {
+		server->consecutive_fails = 0;
+	}
+
+	if(release_type == HTTPUpstreamReleaseTypeReuse && connection.reader != NULL &&
+	   server->idle_amount < group->options.max_connections) {
+		server->idle_connections[server->idle_amount] = (HTTPUpstreamIdleConnection){
+			.reader = connection.reader,
+			.idle_since_ms = now_ms,
+		};
+		++(server->idle_amount);
+		close_connection = false;
+	} else {
+		--(server->open_amount);
+	}
+
+	result = pthread_mutex_unlock(&group->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the upstream group", {});
+
+	metrics_gauge_add(server->outstanding_gauge, -1);
+
+	if(release_type == HTTPUpstreamReleaseTypeFailed) {
+		metrics_counter_increment(server->failures_counter);
+	}
+
+	if(close_connection) {
+		metrics_gauge_add(server->connections_gauge, -1);
+
+		if(connection.reader != NULL) {
+			close_http_upstream_reader(connection.reader);
+		}
+	}
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPUpstreamAcquireResultOk = 0,
+	// connecting failed, the failure was already recorded, another attempt may succeed
+	HTTPUpstreamAcquireResultFailed,
+	// all healthy servers are at their connection limit
+	HTTPUpstreamAcquireResultBusy,
+	// no server is healthy
+	HTTPUpstreamAcquireResultUnavailable,
+} HTTPUpstreamAcquireResult;
+
+NODISCARD static HTTPUpstreamAcquireResult
+acquire_http_upstream_connection(HTTPUpstreamGroup* const group,
+                                 OUT_PARAM(HTTPUpstreamConnection) connection) {
+
+	const uint64_t now_ms = get_http_upstream_time_ms();
+
+	*connection = (HTTPUpstreamConnection){ .server = NULL, .reader = NULL, .reused = false };
+
+	int result = pthread_mutex_lock(&group->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to lock the mutex for the upstream group",
+	    return HTTPUpstreamAcquireResultUnavailable;);
+
+	bool all_busy = false;
+
+	HTTPUpstreamServer* const server = select_http_upstream_server(group, now_ms, &all_busy);
+
+	bool new_connection = false;
+
+	if(server != NULL) {
+		close_expired_http_upstream_connections(group, server, now_ms);
+
+		if(server->idle_amount > 0) {
+			--(server->idle_amount);
+			connection->reader = server->idle_connections[server->idle_amount].reader;
+			connection->reused = true;
+		} else {
+			// the slot is reserved, while connecting
+			++(server->open_amount);
+			new_connection = true;
+		}
+	}
+
+	result = pthread_mutex_unlock(&group->mutex);
+	CHECK_FOR_THREAD_ERROR(
+	    result, "An Error occurred while trying to unlock the mutex for the upstream group", {});
+
+	if(server == NULL) {
+		return all_busy ? HTTPUpstreamAcquireResultBusy : HTTPUpstreamAcquireResultUnavailable;
+	}
+
+	connection->server = server;
+
+	metrics_gauge_add(server->outstanding_gauge, 1);
+
+	if(new_connection) {
+		metrics_gauge_add(server->connections_gauge, 1);
+	}
+
+	if(connection->reader != NULL) {
+		if(is_idle_http_upstream_connection_usable(connection->reader)) {
+			return HTTPUpstreamAcquireResultOk;
+		}
+
+		// the slot of the closed connection is used for the new one
+		close_http_upstream_reader(connection->reader);
+		connection->reader = NULL;
+		connection->reused = false;
+	}
+
+	const NativeFd fd = connect_to_http_upstream_server(server, group->options);
+
+	if(fd < 0) {
+		LOG_MESSAGE(LogLevelWarn, "Couldn't connect to the upstream server '%s': %s\n",
+		            server->name, strerror(errno));
+		release_http_upstream_connection(group, *connection, HTTPUpstreamReleaseTypeFailed);
+		return HTTPUpstreamAcquireResultFailed;
+	}
+
+	ConnectionDescriptor* const descriptor = get_connection_descriptor(group->context, fd);
+
+	if(descriptor != NULL) {
+		connection->reader = get_buffered_reader(descriptor);
+
+		if(connection->reader == NULL) {
+			const GenericResult _ = close_connection_descriptor(descriptor);
+			UNUSED(_);
+		}
+	} else {
+		close(fd);
+	}
+
+	if(connection->reader == NULL) {
+		release_http_upstream_connection(group, *connection, HTTPUpstreamReleaseTypeClose);
+		return HTTPUpstreamAcquireResultUnavailable;
+	}
+
+	return HTTPUpstreamAcquireResultOk;
+}
+
+// the upstream writes bypass send_data_to_connection, so that they aren't counted as sent bytes
+NODISCARD static bool write_to_http_upstream(BufferedReader* const reader,
+                                             const ReadonlyBuffer buffer) {
+
+	const ConnectionDescriptor* const descriptor =
+	    buffered_reader_get_connection_descriptor(reader);
+
+	size_t written = 0;
+
+	while(written < buffer.size) {
+		const ssize_t result = write_to_descriptor(
+		    descriptor, (ReadonlyBuffer){ .data = (const uint8_t*)buffer.data + written,
+		                                  .size = buffer.size - written });
+
+		if(result <= 0) {
+			if(result < 0 && errno == EINTR) {
+				continue;
+			}
+
+			return false;
+		}
+
+		written += (size_t)result;
+	}
+
+	return true;
+}
+
+// the header fields, that only apply to a single connection, see
+// https://datatracker.ietf.org/doc/html/rfc9110#section-7.6.1, the framing is also always done by
+// the proxy itself
+NODISCARD static bool is_hop_by_hop_header_field(const HttpHeaderField* const field,
+                                                 const HttpHeaderField* const connection_field) {
+
+	switch(get_http_header_field_token(field)) {
+		case HttpHeaderTokenConnection:
+		case HttpHeaderTokenKeepAlive:
+		case HttpHeaderTokenTransferEncoding:
+		case HttpHeaderTokenTe:
+		case HttpHeaderTokenTrailer:
+		case HttpHeaderTokenUpgrade:
+		case HttpHeaderTokenProxyAuthorization:
+		case HttpHeaderTokenHttp2Settings: {
+			return true;
+		}
+		default: {
+			break;
+		}
+	}
+
+	if(connection_field == NULL) {
+		return false;
+	}
+
+	// the Connection header may list further hop by hop header fields
+	tstr_split_iter iter = tstr_split_init(tstr_as_view(&(connection_field->value)), ",");
+
+	while(true) {
+		tstr_view option;
+
+		if(!tstr_split_next(&iter, &option)) {
+			break;
+		}
+
+		if(tstr_view_eq_ignore_case(tstr_view_lstrip(option), tstr_as_view(&(field->key)))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void append_http_upstream_header_field(StringBuilder* const string_builder,
+                                              const HttpHeaderField* const field) {
+	string_builder_append_tstr(string_builder, &(field->key));
+	string_builder_append_single(string_builder, ": ");
+	string_builder_append_tstr(string_builder, &(field->value));
+	string_builder_append_single(string_builder, HTTP_LINE_SEPERATORS);
+}
+
+// the target isn't escaped, so it can't contain whitespace or control characters, otherwise it
+// could end the request line early
+NODISCARD static bool is_valid_http_upstream_request_target(const tstr_view target) {
+
+	if(target.len == 0) {
+		return false;
+	}
+
+	for(size_t i = 0; i < target.len; ++i) {
+		const unsigned char character = (unsigned char)target.data[i];
+
+		// NOLINTNEXTLINE(readability-magic-numbers)
+		if(character <= ' ' || character == 0x7F) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPUpstreamRequestHeadResultOk = 0,
+	// a field or the target would change the meaning of the forwarded request, e.g. a CR LF in a
+	// http/2 field value, that would start a new header field or even a new request
+	HTTPUpstreamRequestHeadResultInvalid,
+	HTTPUpstreamRequestHeadResultError,
+} HTTPUpstreamRequestHeadResult;
+
+// the request is always sent as http/1.1, also if the client uses http/2 or http/1.0
+NODISCARD static HTTPUpstreamRequestHeadResult
+build_http_upstream_request_head(const HttpRequest* const http_request, const ParsedURLPath path,
+                                 const IPAddress address, OUT_PARAM(SizedBuffer) request_head) {
+
+	*request_head = get_empty_sized_buffer();
+
+	// the path and the query are forwarded with the bytes, that the client sent
+	tstr target = get_parsed_url_as_string(path);
+
+	if(!is_valid_http_upstream_request_target(tstr_as_view(&target))) {
+		tstr_free(&target);
+		return HTTPUpstreamRequestHeadResultInvalid;
+	}
+
+	StringBuilder* string_builder = string_builder_init();
+
+	if(string_builder == NULL) {
+		tstr_free(&target);
+		return HTTPUpstreamRequestHeadResultError;
+	}
+
+	const HTTPRequestMethod method = http_request->head.request_line.method;
+
+	string_builder_append_single(string_builder, get_http_method_string(method));
+	string_builder_append_single(string_builder, " ");
+
+	string_builder_append_tstr(string_builder, &target);
+	tstr_free(&target);
+
+	string_builder_append_single(string_builder, " HTTP/1.1" HTTP_LINE_SEPERATORS);
+
+	const HttpHeaderField* const connection_field =
+	    find_request_header(&(http_request->head), HttpHeaderTokenConnection);
+
+	const HttpHeaderField* const forwarded_for_field =
+	    find_request_header(&(http_request->head), HttpHeaderTokenXForwardedFor);
+
+	bool has_host = false;
+
+	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, http_request->head.header_fields); ++i) {
+		const HttpHeaderField entry = TVEC_AT(HttpHeaderField, http_request->head.header_fields, i);
+		const HttpHeaderField* const field = &entry;
+
+		// the http/1 parser splits at CR LF only, and the hpack decoder doesn't check the
+		// characters at all, so every forwarded field is checked here
+		if(!is_valid_http_header_field_name(tstr_as_view(&(field->key))) ||
+		   !is_valid_http_header_field_value(tstr_as_view(&(field->value)))) {
+			free_string_builder(string_builder);
+			return HTTPUpstreamRequestHeadResultInvalid;
+		}
+
+		const HttpHeaderToken token = get_http_header_field_token(field);
+
+		// the body was already read completely, so there is nothing to continue
+		if(token == HttpHeaderTokenExpect || token == HttpHeaderTokenContentLength ||
+		   is_hop_by_hop_header_field(field, connection_field)) {
+			continue;
+		}
+
+		if(token == HttpHeaderTokenXForwardedFor) {
+			continue;
+		}
+
+		if(token == HttpHeaderTokenHost) {
+			has_host = true;
+		}
+
+		append_http_upstream_header_field(string_builder, field);
+	}
+
+	// http/2 requests have the host in the :authority pseudo header field
+	if(!has_host && http_request->head.request_line.uri.type == ParsedURITypeAbsoluteURI) {
+		tstr authority =
+		    get_parsed_authority_as_string(http_request->head.request_line.uri.data.uri.authority);
+
+		if(!is_valid_http_header_field_value(tstr_as_view(&authority))) {
+			tstr_free(&authority);
+			free_string_builder(string_builder);
+			return HTTPUpstreamRequestHeadResultInvalid;
+		}
+
+		string_builder_append_single(string_builder, "host: ");
+		string_builder_append_tstr(string_builder, &authority);
+		string_builder_append_single(string_builder, HTTP_LINE_SEPERATORS);
+
+		tstr_free(&authority);
+	}
+
+	{
+		// the client address is appended to the chain of the previous proxies
+
+		char* const client_address = ipv_to_string(address);
+
+		if(client_address != NULL) {
+			string_builder_append_single(string_builder, "x-forwarded-for: ");
+
+			if(forwarded_for_field != NULL) {
+				string_builder_append_tstr(string_builder, &(forwarded_for_field->value));
+				string_builder_append_single(string_builder, ", ");
+			}
+
+			string_builder_append_single(string_builder, client_address);
+			string_builder_append_single(string_builder, HTTP_LINE_SEPERATORS);
+
+			free(client_address);
+		}
+	}
+
+	if(http_request->body.size != 0 || method == HTTPRequestMethodPost) {
+		STRING_BUILDER_APPENDF(
+		    string_builder,
+		    {
+			    free_string_builder(string_builder);
+			    return HTTPUpstreamRequestHeadResultError;
+		    },
+		    "content-length: %zu" HTTP_LINE_SEPERATORS, http_request->body.size);
+	}
+
+	string_builder_append_single(string_builder, HTTP_LINE_SEPERATORS);
+
+	*request_head = string_builder_release_into_sized_buffer(&string_builder);
+
+	return request_head->data == NULL ? HTTPUpstreamRequestHeadResultError
+	                                  : HTTPUpstreamRequestHeadResultOk;
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPUpstreamBodyTypeNone = 0,
+	HTTPUpstreamBodyTypeContentLength,
+	HTTPUpstreamBodyTypeChunked,
+	// the body ends, when the server closes the connection
+	HTTPUpstreamBodyTypeUntilClose,
+} HTTPUpstreamBodyType;
+
+typedef struct {
+	uint16_t status;
+	tstr reason;
+	// the keys are lowercase, as http/2 needs them to be lowercase
+	HttpHeaderFields header_fields;
+	HTTPUpstreamBodyType body_type;
+	size_t content_length;
+	bool keep_alive;
+} HTTPUpstreamResponseHead;
+
+// the head can be freed again or reused afterwards
+static void free_http_upstream_response_head(HTTPUpstreamResponseHead* const head) {
+	tstr_free(&(head->reason));
+	free_http_header_fields(&(head->header_fields));
+
+	head->reason = tstr_null();
+	head->header_fields = TVEC_EMPTY(HttpHeaderField);
+}
+
+NODISCARD static tstr get_lowercase_header_key(const tstr_view key) {
+
+	char* const data = malloc(key.len + 1);
+
+	if(data == NULL) {
+		return tstr_null();
+	}
+
+	for(size_t i = 0; i < key.len; ++i) {
+		data[i] = (char)tolower((unsigned char)key.data[i]);
+	}
+
+	data[key.len] = '\0';
+
+	return tstr_own_cstr(data);
+}
+
+NODISCARD static bool has_connection_close_option(const HttpHeaderFields header_fields) {
+
+	const HttpHeaderField* const connection_field =
+	    find_header_by_key(header_fields, HTTP_HEADER_NAME(connection));
+
+	if(connection_field == NULL) {
+		return false;
+	}
+
+	tstr_split_iter iter = tstr_split_init(tstr_as_view(&(connection_field->value)), ",");
+
+	while(true) {
+		tstr_view option;
+
+		if(!tstr_split_next(&iter, &option)) {
+			return false;
+		}
+
+		if(tstr_view_eq_ignore_case(tstr_view_lstrip(option), TSTR_TSV("close"))) {
+			return true;
+		}
+	}
+}
+
+// the codings are applied in order, so e.g. "gzip, chunked" is framed by the chunked coding, see
+// https://datatracker.ietf.org/doc/html/rfc9112#section-6.1
+NODISCARD static bool is_last_http_upstream_transfer_coding_chunked(const tstr_view value) {
+
+	tstr_split_iter iter = tstr_split_init(value, ",");
+
+	tstr_view last_coding = TSTR_EMPTY_VIEW;
+
+	while(true) {
+		tstr_view coding;
+
+		if(!tstr_split_next(&iter, &coding)) {
+			break;
+		}
+
+		last_coding = tstr_view_lstrip(coding);
+	}
+
+	while(last_coding.len != 0 && (last_coding.data[last_coding.len - 1] == ' ' ||
+	                               last_coding.data[last_coding.len - 1] == '\t')) {
+		--last_coding.len;
+	}
+
+	return tstr_view_eq_ignore_case(last_coding, TSTR_TSV("chunked"));
+}
+
+// determines the length of the body, as given by
+// https://datatracker.ietf.org/doc/html/rfc9112#section-6.3
+NODISCARD static bool analyze_http_upstream_response_head(HTTPUpstreamResponseHead* const head,
+                                                          const HTTPRequestMethod method,
+                                                          const bool is_http1_1) {
+
+	head->body_type = HTTPUpstreamBodyTypeUntilClose;
+
+	if(method == HTTPRequestMethodHead || head->status == HttpStatusNoContent ||
+	   head->status == HttpStatusNotModified) {
+		head->body_type = HTTPUpstreamBodyTypeNone;
+	} else {
+		const HttpHeaderField* const transfer_encoding_field =
+		    find_header_by_key(head->header_fields, HTTP_HEADER_NAME(transfer_encoding));
+
+		const HttpHeaderField* const content_length_field =
+		    find_header_by_key(head->header_fields, HTTP_HEADER_NAME(content_length));
+
+		if(transfer_encoding_field != NULL) {
+			// if the last coding isn't chunked, the body ends with the connection
+			if(is_last_http_upstream_transfer_coding_chunked(
+			       tstr_as_view(&(transfer_encoding_field->value)))) {
+				head->body_type = HTTPUpstreamBodyTypeChunked;
+			}
+		} else if(content_length_field != NULL) {
+			bool success = false;
+
+			const uint64_t content_length =
+			    parse_u64(tstr_as_view(&(content_length_field->value)), &success);
+
+			if(!success || content_length > SIZE_MAX) {
+				return false;
+			}
+
+			head->body_type = HTTPUpstreamBodyTypeContentLength;
+			head->content_length = (size_t)content_length;
+		}
+	}
+
+	head->keep_alive = is_http1_1 && head->body_type != HTTPUpstreamBodyTypeUntilClose &&
+	                   !has_connection_close_option(head->header_fields);
+
+	return true;
+}
+
+// parses "HTTP/1.1 200 OK", the reason phrase may be empty
+NODISCARD static bool parse_http_upstream_status_line(const tstr_view status_line,
+                                                      HTTPUpstreamResponseHead* const head,
+                                                      OUT_PARAM(bool) is_http1_1) {
+
+	const tstr_split_result version_split = tstr_split(status_line, " ");
+
+	if(!version_split.ok) {
+		return false;
+	}
+
+	if(tstr_view_eq_ignore_case(version_split.first, TSTR_TSV("HTTP/1.1"))) {
+		*is_http1_1 = true;
+	} else if(tstr_view_eq_ignore_case(version_split.first, TSTR_TSV("HTTP/1.0"))) {
+		*is_http1_1 = false;
+	} else {
+		return false;
+	}
+
+	tstr_view status = version_split.second;
+	tstr_view reason = TSTR_EMPTY_VIEW;
+
+	const tstr_split_result status_split = tstr_split(version_split.second, " ");
+
+	if(status_split.ok) {
+		status = status_split.first;
+		reason = status_split.second;
+	}
+
+	bool success = false;
+
+	const uint64_t status_code = parse_u64(status, &success);
+
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	if(!success || status.len != 3 || status_code < 100 || status_code > 599) {
+		return false;
+	}
+
+	// the reason is relayed to the client, it has the same characters as a field value
+	if(!is_valid_http_header_field_value(reason)) {
+		return false;
+	}
+
+	head->status = (uint16_t)status_code;
+	head->reason = tstr_from_view(reason);
+
+	return true;
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPUpstreamHeadResultOk = 0,
+	// the connection ended, before anything of the response was received
+	HTTPUpstreamHeadResultNothingReceived,
+	HTTPUpstreamHeadResultError,
+} HTTPUpstreamHeadResult;
+
+// interim (1xx) responses are skipped, protocol switches aren't supported
+NODISCARD static HTTPUpstreamHeadResult
+read_http_upstream_response_head(BufferedReader* const reader, const HTTPRequestMethod method,
+                                 OUT_PARAM(HTTPUpstreamResponseHead) head) {
+
+	*head = (HTTPUpstreamResponseHead){
+		.status = 0,
+		.reason = tstr_null(),
+		.header_fields = TVEC_EMPTY(HttpHeaderField),
+		.body_type = HTTPUpstreamBodyTypeNone,
+		.content_length = 0,
+		.keep_alive = false,
+	};
+
+	bool first_line = true;
+
+	while(true) {
+		const BufferedReadResult status_result = buffered_reader_get_until_delimiter_bounded(
+		    reader, HTTP_LINE_SEPERATORS, HTTP_UPSTREAM_MAX_HEAD_LINE_LENGTH);
+
+		if(status_result.type != BufferedReadResultTypeOk) {
+			return first_line && status_result.type == BufferedReadResultTypeEOF
+			           ? HTTPUpstreamHeadResultNothingReceived
+			           : HTTPUpstreamHeadResultError;
+		}
+
+		first_line = false;
+
+		bool is_http1_1 = false;
+
+		free_http_upstream_response_head(head);
+
+		if(!parse_http_upstream_status_line(
+		       tstr_view_from_readonly_buffer(status_result.value.buffer), head, &is_http1_1)) {
+			return HTTPUpstreamHeadResultError;
+		}
+
+		while(true) {
+			const BufferedReadResult line_result = buffered_reader_get_until_delimiter_bounded(
+			    reader, HTTP_LINE_SEPERATORS, HTTP_UPSTREAM_MAX_HEAD_LINE_LENGTH);
+
+			if(line_result.type != BufferedReadResultTypeOk) {
+				return HTTPUpstreamHeadResultError;
+			}
+
+			const tstr_view line = tstr_view_from_readonly_buffer(line_result.value.buffer);
+
+			if(line.len == 0) {
+				break;
+			}
+
+			const tstr_split_result split_result = tstr_split(line, ":");
+
+			if(!split_result.ok || split_result.first.len == 0 ||
+			   TVEC_LENGTH(HttpHeaderField, head->header_fields) >=
+			       HTTP_UPSTREAM_MAX_HEADER_FIELDS) {
+				return HTTPUpstreamHeadResultError;
+			}
+
+			const tstr_view value = tstr_view_lstrip(split_result.second);
+
+			// the fields are relayed to the client, a bare CR, LF or NUL could start a new field
+			// there
+			if(!is_valid_http_header_field_name(split_result.first) ||
+			   !is_valid_http_header_field_value(value)) {
+				return HTTPUpstreamHeadResultError;
+			}
+
+			add_http_header_field(&(head->header_fields),
+			                      get_lowercase_header_key(split_result.first),
+			                      tstr_from_view(value));
+		}
+
+		buffered_reader_invalidate_old_data(reader);
+
+		// NOLINTNEXTLINE(readability-magic-numbers)
+		if(head->status >= 200) {
+			return analyze_http_upstream_response_head(head, method, is_http1_1)
+			           ? HTTPUpstreamHeadResultOk
+			           : HTTPUpstreamHeadResultError;
+		}
+
+		if(head->status == HttpStatusSwitchingProtocols) {
+			return HTTPUpstreamHeadResultError;
+		}
+	}
+}
+
+// the response head for http/1.x clients, the header fields of the upstream are forwarded as they
+// are, only the hop by hop fields and the framing are replaced
+NODISCARD static SizedBuffer
+build_http_upstream_client_head(const HTTPUpstreamResponseHead* const head,
+                                const SendSettings send_settings) {
+
+	StringBuilder* string_builder = string_builder_init();
+
+	if(string_builder == NULL) {
+		return get_empty_sized_buffer();
+	}
+
+	STRING_BUILDER_APPENDF(
+	    string_builder,
+	    {
+		    free_string_builder(string_builder);
+		    return get_empty_sized_buffer();
+	    },
+	    "%s %u " TSTR_FMT HTTP_LINE_SEPERATORS,
+	    get_http_protocol_version_string(send_settings.protocol_data.version), head->status,
+	    TSTR_FMT_ARGS(head->reason));
+
+	const HttpHeaderField* const connection_field =
+	    find_header_by_key(head->header_fields, HTTP_HEADER_NAME(connection));
+
+	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, head->header_fields); ++i) {
+		const HttpHeaderField entry = TVEC_AT(HttpHeaderField, head->header_fields, i);
+		const HttpHeaderField* const field = &entry;
+
+		// without a body, the Content-Length describes the body of a GET request
+		if((head->body_type != HTTPUpstreamBodyTypeNone &&
+		    get_http_header_field_token(field) == HttpHeaderTokenContentLength) ||
+		   is_hop_by_hop_header_field(field, connection_field)) {
+			continue;
+		}
+
+		append_http_upstream_header_field(string_builder, field);
+	}
+
+	switch(head->body_type) {
+		case HTTPUpstreamBodyTypeContentLength: {
+			STRING_BUILDER_APPENDF(
+			    string_builder,
+			    {
+				    free_string_builder(string_builder);
+				    return get_empty_sized_buffer();
+			    },
+			    "content-length: %zu" HTTP_LINE_SEPERATORS, head->content_length);
+			break;
+		}
+		case HTTPUpstreamBodyTypeChunked: {
+			string_builder_append_single(string_builder,
+			                             "transfer-encoding: chunked" HTTP_LINE_SEPERATORS);
+			break;
+		}
+		case HTTPUpstreamBodyTypeNone:
+		case HTTPUpstreamBodyTypeUntilClose:
+		default: {
+			break;
+		}
+	}
+
+	if(send_settings.persistence.type == HttpConnectionPersistenceTypeKeepAlive) {
+		STRING_BUILDER_APPENDF(
+		    string_builder,
+		    {
+			    free_string_builder(string_builder);
+			    return get_empty_sized_buffer();
+		    },
+		    "connection: keep-alive" HTTP_LINE_SEPERATORS
+		    "keep-alive: timeout=%u, max=%zu" HTTP_LINE_SEPERATORS,
+		    send_settings.persistence.idle_timeout_s, send_settings.persistence.remaining_requests);
+	} else {
+		string_builder_append_single(string_builder, "connection: close" HTTP_LINE_SEPERATORS);
+	}
+
+	string_builder_append_single(string_builder, HTTP_LINE_SEPERATORS);
+
+	return string_builder_release_into_sized_buffer(&string_builder);
+}
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	HTTPUpstreamRelayResultOk = 0,
+	// reading from the upstream server failed
+	HTTPUpstreamRelayResultUpstreamError,
+	// writing to the client failed
+	HTTPUpstreamRelayResultClientError,
+} HTTPUpstreamRelayResult;
+
+NODISCARD static HTTPUpstreamRelayResult
+stream_http_upstream_content_length_body(BufferedReader* const reader, size_t remaining,
+                                         const ConnectionDescriptor* const descriptor) {
+
+	while(remaining > 0) {
+		const size_t slice_size =
+		    remaining < HTTP_CHUNKED_READ_SLICE_SIZE ? remaining : HTTP_CHUNKED_READ_SLICE_SIZE;
+
+		const BufferedReadResult read_result = buffered_reader_get_amount(reader, slice_size);
+
+		if(read_result.type != BufferedReadResultTypeOk) {
+			return HTTPUpstreamRelayResultUpstreamError;
+		}
+
+		const GenericResult send_result = send_data_to_connection(
+		    descriptor, read_result.value.buffer.data, read_result.value.buffer.size);
+
+		// the slice isn't needed anymore, so the buffer of the reader stays small
+		buffered_reader_invalidate_old_data(reader);
+
+		IF_GENERIC_RESULT_IS_ERROR_IGN(send_result) {
+			return HTTPUpstreamRelayResultClientError;
+		}
+
+		remaining -= slice_size;
+	}
+
+	return HTTPUpstreamRelayResultOk;
+}
+
+// the decoded slices are chunked again, as the chunk boundaries of the upstream aren't kept, the
+// trailer fields are dropped
+NODISCARD static HTTPUpstreamRelayResult
+stream_http_upstream_chunked_body(BufferedReader* const reader,
+                                  const ConnectionDescriptor* const descriptor) {
+
+	SizedBuffer frame =
+	    allocate_sized_buffer(HTTP_CHUNKED_READ_SLICE_SIZE + HTTP_UPSTREAM_CHUNK_FRAME_OVERHEAD);
+
+	if(frame.data == NULL) {
+		return HTTPUpstreamRelayResultClientError;
+	}
+
+	HttpChunkedSettings settings = get_default_http_chunked_settings();
+	// the body is never held in memory as a whole, so only the chunk size is limited
+	settings.max_body_size = SIZE_MAX;
+
+	HttpChunkedDecoder decoder = http_chunked_decoder_init(settings);
+
+	HTTPUpstreamRelayResult result = HTTPUpstreamRelayResultOk;
+
+	while(result == HTTPUpstreamRelayResultOk) {
+		const HttpChunkedReadResult read_result = http_chunked_decoder_read(&decoder, reader);
+
+		if(read_result.type == HttpChunkedReadResultTypeError) {
+			result = HTTPUpstreamRelayResultUpstreamError;
+			break;
+		}
+
+		if(read_result.type == HttpChunkedReadResultTypeEnd) {
+			const GenericResult send_result = send_data_to_connection(
+			    descriptor, HTTP_UPSTREAM_LAST_CHUNK, sizeof(HTTP_UPSTREAM_LAST_CHUNK) - 1);
+
+			IF_GENERIC_RESULT_IS_ERROR_IGN(send_result) {
+				result = HTTPUpstreamRelayResultClientError;
+			}
+
+			break;
+		}
+
+		const ReadonlyBuffer data = read_result.value.data;
+
+		if(data.size == 0) {
+			continue;
+		}
+
+		assert(data.size <= HTTP_CHUNKED_READ_SLICE_SIZE && "the decoder returned a larger slice");
+
+		// the frame is sent in one write, so that the small size line doesn't go out alone
+		const int prefix_size = snprintf((char*)frame.data, HTTP_UPSTREAM_CHUNK_FRAME_OVERHEAD,
+		                                 "%zx" HTTP_LINE_SEPERATORS, data.size);
+
+		if(prefix_size <= 0) {
+			result = HTTPUpstreamRelayResultClientError;
+			break;
+		}
+
+		uint8_t* const frame_data = (uint8_t*)frame.data;
+
+		memcpy(frame_data + prefix_size, data.data, data.size);
+		memcpy(frame_data + prefix_size + data.size, HTTP_LINE_SEPERATORS,
+		       SIZEOF_HTTP_LINE_SEPERATORS);
+
+		const GenericResult send_result = send_data_to_connection(
+		    descriptor, frame.data, (size_t)prefix_size + data.size + SIZEOF_HTTP_LINE_SEPERATORS);
+
+		IF_GENERIC_RESULT_IS_ERROR_IGN(send_result) {
+			result = HTTPUpstreamRelayResultClientError;
+		}
+	}
+
+	free_http_chunked_decoder(&decoder);
+	free_sized_buffer(frame);
+
+	return result;
+}
+
+// reads the whole body, the result is NULL for an empty body
+NODISCARD static HTTPUpstreamRelayResult
+read_http_upstream_body(BufferedReader* const reader, const HTTPUpstreamResponseHead* const head,
+                        OUT_PARAM(SizedBuffer) body) {
+
+	*body = get_empty_sized_buffer();
+
+	switch(head->body_type) {
+		case HTTPUpstreamBodyTypeNone: {
+			return HTTPUpstreamRelayResultOk;
+		}
+		case HTTPUpstreamBodyTypeContentLength: {
+			if(head->content_length > HTTP_UPSTREAM_MAX_BUFFERED_BODY_SIZE) {
+				return HTTPUpstreamRelayResultUpstreamError;
+			}
+
+			if(head->content_length == 0) {
+				return HTTPUpstreamRelayResultOk;
+			}
+
+			const BufferedReadResult read_result =
+			    buffered_reader_get_amount(reader, head->content_length);
+
+			if(read_result.type != BufferedReadResultTypeOk) {
+				return HTTPUpstreamRelayResultUpstreamError;
+			}
+
+			*body = allocate_sized_buffer(read_result.value.buffer.size);
+
+			if(body->data == NULL) {
+				return HTTPUpstreamRelayResultClientError;
+			}
+
+			memcpy(body->data, read_result.value.buffer.data, read_result.value.buffer.size);
+
+			buffered_reader_invalidate_old_data(reader);
+
+			return HTTPUpstreamRelayResultOk;
+		}
+		case HTTPUpstreamBodyTypeChunked: {
+			HttpChunkedSettings settings = get_default_http_chunked_settings();
+			settings.max_body_size = HTTP_UPSTREAM_MAX_BUFFERED_BODY_SIZE;
+
+			HttpChunkedDecoder decoder = http_chunked_decoder_init(settings);
+
+			StringBuilder* string_builder = string_builder_init();
+
+			HTTPUpstreamRelayResult result =
+			    string_builder == NULL ? HTTPUpstreamRelayResultClientError
+			                           : HTTPUpstreamRelayResultOk;
+
+			while(result == HTTPUpstreamRelayResultOk) {
+				const HttpChunkedReadResult read_result =
+				    http_chunked_decoder_read(&decoder, reader);
+
+				if(read_result.type == HttpChunkedReadResultTypeError) {
+					result = HTTPUpstreamRelayResultUpstreamError;
+				} else if(read_result.type == HttpChunkedReadResultTypeEnd) {
+					break;
+				} else {
+					const GenericResult append_result =
+					    string_builder_append_buffer(string_builder, read_result.value.data);
+
+					IF_GENERIC_RESULT_IS_ERROR_IGN(append_result) {
+						result = HTTPUpstreamRelayResultClientError;
+					}
+				}
+			}
+
+			free_http_chunked_decoder(&decoder);
+
+			if(string_builder != NULL) {
+				if(result == HTTPUpstreamRelayResultOk &&
+				   string_builder_get_string_size(string_builder) != 0) {
+					*body = string_builder_release_into_sized_buffer(&string_builder);
+				} else {
+					free_string_builder(string_builder);
+				}
+			}
+
+			return result;
+		}
+		case HTTPUpstreamBodyTypeUntilClose:
+		default: {
+			const BufferedReadResult read_result = buffered_reader_get_until_end(reader);
+
+			if(read_result.type != BufferedReadResultTypeOk ||
+			   read_result.value.buffer.size > HTTP_UPSTREAM_MAX_BUFFERED_BODY_SIZE) {
+				return HTTPUpstreamRelayResultUpstreamError;
+			}
+
+			if(read_result.value.buffer.size == 0) {
+				return HTTPUpstreamRelayResultOk;
+			}
+
+			*body = allocate_sized_buffer(read_result.value.buffer.size);
+
+			if(body->data == NULL) {
+				return HTTPUpstreamRelayResultClientError;
+			}
+
+			memcpy(body->data, read_result.value.buffer.data, read_result.value.buffer.size);
+
+			return HTTPUpstreamRelayResultOk;
+		}
+	}
+}
+
+// status is one of HttpStatusBadRequest, HttpStatusBadGateway or HttpStatusServiceUnavailable, the
+// latter means, that all upstream servers are busy
+NODISCARD static GenericResult
+send_http_upstream_error(HTTPGeneralContext* const general_context,
+                         const ConnectionDescriptor* const descriptor,
+                         const SendSettings send_settings, const bool send_body,
+                         const HttpStatusCode status) {
+
+	HttpHeaderFields additional_headers = TVEC_EMPTY(HttpHeaderField);
+
+	const char* message = "Bad Gateway";
+
+	if(status == HttpStatusServiceUnavailable) {
+		add_http_header_field(&additional_headers,
+		                      tstr_from_static_tstr(HTTP_HEADER_NAME(retry_after)),
+		                      TSTR_LIT(HTTP_UPSTREAM_BUSY_RETRY_AFTER_S));
+
+		message = "Service Unavailable: all upstream servers are busy";
+	} else if(status == HttpStatusBadRequest) {
+		message = "Bad Request: the request can't be forwarded";
+	}
+
+	HTTPResponseToSend to_send = { .status = status,
+		                           .body = http_response_body_from_static_string(message,
+		                                                                         send_body),
+		                           .mime_type = MIME_TYPE_TEXT,
+		                           .additional_headers = additional_headers };
+
+	return send_http_message_to_connection(general_context, descriptor, to_send, send_settings);
+}
+
+// the response is sent with the normal send functions, the header fields, that these add
+// themselves, are not forwarded
+NODISCARD static GenericResult send_buffered_http_upstream_response(
+    HTTPGeneralContext* const general_context, const ConnectionDescriptor* const descriptor,
+    SendSettings send_settings, HTTPUpstreamResponseHead* const head, const SizedBuffer body,
+    const bool send_body) {
+
+	tstr mime_type = tstr_null();
+
+	HttpHeaderFields additional_headers = TVEC_EMPTY(HttpHeaderField);
+
+	const HttpHeaderField* const connection_field =
+	    find_header_by_key(head->header_fields, HTTP_HEADER_NAME(connection));
+
+	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, head->header_fields); ++i) {
+		const HttpHeaderField entry = TVEC_AT(HttpHeaderField, head->header_fields, i);
+		const HttpHeaderField* const field = &entry;
+
+		const HttpHeaderToken token = get_http_header_field_token(field);
+
+		if(token == HttpHeaderTokenContentLength || token == HttpHeaderTokenServer ||
+		   token == HttpHeaderTokenAltSvc ||
+		   is_hop_by_hop_header_field(field, connection_field)) {
+			continue;
+		}
+
+		if(token == HttpHeaderTokenContentType) {
+			tstr_free(&mime_type);
+			mime_type = tstr_dup(&(field->value));
+			continue;
+		}
+
+		add_http_header_field(&additional_headers, tstr_dup(&(field->key)),
+		                      tstr_dup(&(field->value)));
+	}
+
+	// the upstream server decides about the content coding
+	send_settings.compression_to_use = CompressionTypeNone;
+
+	HTTPResponseToSend to_send = {
+		.status = (HttpStatusCode)head->status,
+		.body = body.data == NULL ? http_response_body_empty()
+		                          : http_response_body_from_data(body.data, body.size, send_body),
+		.mime_type = mime_type,
+		.additional_headers = additional_headers,
+	};
+
+	return send_http_message_to_connection(general_context, descriptor, to_send, send_settings);
+}
+
+// streams the response to a http/1.x client, the request metrics are recorded here, as the normal
+// send functions aren't used
+NODISCARD static HTTPUpstreamRelayResult stream_http_upstream_response(
+    HTTPGeneralContext* const general_context, const ConnectionDescriptor* const descriptor,
+    const SendSettings send_settings, BufferedReader* const reader,
+    const HTTPUpstreamResponseHead* const head) {
+
+	const HTTPRequestMetrics request_metrics =
+	    http_general_context_get_request_metrics(general_context);
+
+	http_server_metrics_response_sent(request_metrics, (HttpStatusCode)head->status);
+
+	const SizedBuffer client_head = build_http_upstream_client_head(head, send_settings);
+
+	if(client_head.data == NULL) {
+		return HTTPUpstreamRelayResultClientError;
+	}
+
+	const uint64_t send_start_us = http_server_metrics_get_timestamp_us();
+
+	// pipelined responses, that were queued before, have to go out first
+	GenericResult send_result =
+	    http_general_context_flush_http1_output(general_context, descriptor);
+
+	IF_GENERIC_RESULT_IS_NOT_ERROR(send_result) {
+		send_result = send_buffer_to_connection(descriptor, client_head);
+	}
+
+	free_sized_buffer(client_head);
+
+	IF_GENERIC_RESULT_IS_ERROR_IGN(send_result) {
+		return HTTPUpstreamRelayResultClientError;
+	}
+
+	HTTPUpstreamRelayResult result = HTTPUpstreamRelayResultOk;
+
+	switch(head->body_type) {
+		case HTTPUpstreamBodyTypeContentLength: {
+			result = stream_http_upstream_content_length_body(reader, head->content_length,
+			                                                  descriptor);
+			break;
+		}
+		case HTTPUpstreamBodyTypeChunked: {
+			result = stream_http_upstream_chunked_body(reader, descriptor);
+			break;
+		}
+		case HTTPUpstreamBodyTypeNone:
+		case HTTPUpstreamBodyTypeUntilClose:
+		default: {
+			break;
+		}
+	}
+
+	http_server_metrics_observe_phase(request_metrics, HTTPRequestPhaseSend, send_start_us);
+
+	return result;
+}
+
+// http/1.0 clients don't understand the chunked coding, and a body, that ends with the upstream
+// connection, has no length, these and http/2 responses are buffered
+NODISCARD static bool can_stream_http_upstream_response(const HTTPUpstreamResponseHead* const head,
+                                                        const SendSettings send_settings) {
+
+	switch(send_settings.protocol_data.version) {
+		case HTTPProtocolVersion1Dot1: {
+			return head->body_type != HTTPUpstreamBodyTypeUntilClose;
+		}
+		case HTTPProtocolVersion1Dot0: {
+			return head->body_type == HTTPUpstreamBodyTypeNone ||
+			       head->body_type == HTTPUpstreamBodyTypeContentLength;
+		}
+		case HTTPProtocolVersion2:
+		default: {
+			return false;
+		}
+	}
+}
+
+NODISCARD static bool is_idempotent_http_upstream_method(const HTTPRequestMethod method) {
+	switch(method) {
+		case HTTPRequestMethodGet:
+		case HTTPRequestMethodHead:
+		case HTTPRequestMethodOptions: {
+			return true;
+		}
+		case HTTPRequestMethodPost:
+		case HTTPRequestMethodConnect:
+		case HTTPRequestMethodPRI:
+		default: {
+			return false;
+		}
+	}
+}
+
+NODISCARD GenericResult http_upstream_proxy_request(
+    HTTPUpstreamGroup* const group, const ConnectionDescriptor* const descriptor,
+    HTTPGeneralContext* const general_context, const SendSettings send_settings,
+    const HttpRequest http_request, const ParsedURLPath path, const IPAddress address) {
+
+	const HTTPRequestMethod method = http_request.head.request_line.method;
+	const bool send_body = method != HTTPRequestMethodHead;
+
+	SizedBuffer request_head = get_empty_sized_buffer();
+
+	const HTTPUpstreamRequestHeadResult request_head_result =
+	    build_http_upstream_request_head(&http_request, path, address, &request_head);
+
+	if(request_head_result != HTTPUpstreamRequestHeadResultOk) {
+		return send_http_upstream_error(general_context, descriptor, send_settings, send_body,
+		                                request_head_result == HTTPUpstreamRequestHeadResultInvalid
+		                                    ? HttpStatusBadRequest
+		                                    : HttpStatusBadGateway);
+	}
+
+	HTTPUpstreamConnection connection = { .server = NULL, .reader = NULL, .reused = false };
+	HTTPUpstreamResponseHead head = {
+		.status = 0,
+		.reason = tstr_null(),
+		.header_fields = TVEC_EMPTY(HttpHeaderField),
+		.body_type = HTTPUpstreamBodyTypeNone,
+		.content_length = 0,
+		.keep_alive = false,
+	};
+	bool has_response = false;
+	bool busy = false;
+
+	for(size_t attempt = 0; attempt < HTTP_UPSTREAM_MAX_ATTEMPTS && !has_response; ++attempt) {
+
+		const HTTPUpstreamAcquireResult acquire_result =
+		    acquire_http_upstream_connection(group, &connection);
+
+		if(acquire_result == HTTPUpstreamAcquireResultFailed) {
+			continue;
+		}
+
+		if(acquire_result != HTTPUpstreamAcquireResultOk) {
+			busy = acquire_result == HTTPUpstreamAcquireResultBusy;
+			break;
+		}
+
+		// the body was already read completely by the parser, larger ones are a mapping of the
+		// spooled file, a blocking write only returns, once the upstream took all of it
+		bool sent = write_to_http_upstream(connection.reader,
+		                                   readonly_buffer_from_sized_buffer(request_head));
+
+		if(sent && http_request.body.size != 0) {
+			sent = write_to_http_upstream(connection.reader,
+			                              readonly_buffer_from_sized_buffer(http_request.body));
+		}
+
+		const HTTPUpstreamHeadResult head_result =
+		    sent ? read_http_upstream_response_head(connection.reader, method, &head)
+		         : HTTPUpstreamHeadResultNothingReceived;
+
+		if(head_result == HTTPUpstreamHeadResultOk) {
+			has_response = true;
+			break;
+		}
+
+		free_http_upstream_response_head(&head);
+
+		// a pooled connection may have been closed by the server in the meantime, that is no
+		// failure of the server
+		const bool stale_connection =
+		    connection.reused && head_result == HTTPUpstreamHeadResultNothingReceived;
+
+		LOG_MESSAGE(LogLevelWarn, "The request to the upstream server '%s' failed%s\n",
+		            connection.server->name, stale_connection ? " on a pooled connection" : "");
+
+		release_http_upstream_connection(group, connection,
+		                                 stale_connection ? HTTPUpstreamReleaseTypeClose
+		                                                  : HTTPUpstreamReleaseTypeFailed);
+
+		// if the request was written completely, the server may have processed it before
+		// closing, so only idempotent requests are sent again
+		if(!stale_connection || (sent && !is_idempotent_http_upstream_method(method))) {
+			break;
+		}
+	}
+
+	free_sized_buffer(request_head);
+
+	if(!has_response) {
+		return send_http_upstream_error(general_context, descriptor, send_settings, send_body,
+		                                busy ? HttpStatusServiceUnavailable : HttpStatusBadGateway);
+	}
+
+	GenericResult result = GENERIC_RES_OK();
+	HTTPUpstreamReleaseType release_type =
+	    head.keep_alive ? HTTPUpstreamReleaseTypeReuse : HTTPUpstreamReleaseTypeClose;
+
+	if(can_stream_http_upstream_response(&head, send_settings)) {
+		const HTTPUpstreamRelayResult relay_result = stream_http_upstream_response(
+		    general_context, descriptor, send_settings, connection.reader, &head);
+
+		if(relay_result != HTTPUpstreamRelayResultOk) {
+			// the head was maybe already sent, so the client connection can't be used anymore
+			result = GENERIC_RES_ERR_UNIQUE();
+			release_type = relay_result == HTTPUpstreamRelayResultUpstreamError
+			                   ? HTTPUpstreamReleaseTypeFailed
+			                   : HTTPUpstreamReleaseTypeClose;
+		}
+	} else {
+		SizedBuffer body = get_empty_sized_buffer();
+
+		const HTTPUpstreamRelayResult relay_result =
+		    read_http_upstream_body(connection.reader, &head, &body);
+
+		if(relay_result == HTTPUpstreamRelayResultOk) {
+			result = send_buffered_http_upstream_response(general_context, descriptor,
+			                                              send_settings, &head, body, send_body);
+		} else {
+			release_type = relay_result == HTTPUpstreamRelayResultUpstreamError
+			                   ? HTTPUpstreamReleaseTypeFailed
+			                   : HTTPUpstreamReleaseTypeClose;
+
+			result = send_http_upstream_error(general_context, descriptor, send_settings,
+			                                  send_body, HttpStatusBadGateway);
+		}
+	}
+
+	release_http_upstream_connection(group, connection, release_type);
+
+	free_http_upstream_response_head(&head);
+
+	return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "./parser.h"
+#include "./send.h"
+#include "generic/ip.h"
+#include "utils/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a group of upstream http/1.1 servers, that a reverse proxy route forwards its requests to
+// every server has a pool of keep-alive connections, the requests go to the healthy server with
+// the least outstanding requests, a server is marked as down for a while, after too many
+// consecutive connection or protocol errors (passive health checking)
+
+// servers are given as "unix:/path/to/socket", "host:port" or "[ipv6]:port"
+#define HTTP_UPSTREAM_MAX_SERVERS 16
+
+#define HTTP_UPSTREAM_DEFAULT_MAX_CONNECTIONS 8
+
+#define HTTP_UPSTREAM_DEFAULT_MAX_FAILS 3
+
+#define HTTP_UPSTREAM_DEFAULT_FAIL_TIMEOUT_MS 10000
+
+#define HTTP_UPSTREAM_DEFAULT_CONNECT_TIMEOUT_MS 1000
+
+#define HTTP_UPSTREAM_DEFAULT_IO_TIMEOUT_MS 30000
+
+// idle connections are closed after this, it should be lower than the keep-alive timeout of the
+// upstream servers, so that a pooled connection is rarely closed by the other side while in use
+#define HTTP_UPSTREAM_DEFAULT_IDLE_TIMEOUT_MS 4000
+
+// responses to http/2 clients and responses without a length are buffered, before they are sent,
+// larger ones are answered with a 502
+#define HTTP_UPSTREAM_MAX_BUFFERED_BODY_SIZE (1 << 26)
+
+typedef struct {
+	// the connections (idle + in use), that may be open to one server at once
+	uint32_t max_connections;
+	// consecutive failures, after which a server is skipped for fail_timeout_ms, 0 disables it
+	uint32_t max_fails;
+	uint32_t fail_timeout_ms;
+	uint32_t connect_timeout_ms;
+	// timeout for a single read or write on an upstream connection
+	uint32_t io_timeout_ms;
+	uint32_t idle_timeout_ms;
+} HTTPUpstreamOptions;
+
+NODISCARD HTTPUpstreamOptions get_default_http_upstream_options(void);
+
+typedef struct HTTPUpstreamGroupImpl HTTPUpstreamGroup;
+
+// the servers are resolved once here, returns NULL, if a server is invalid or can't be resolved
+NODISCARD HTTPUpstreamGroup* initialize_http_upstream_group(const char* const* servers,
+                                                            size_t server_amount,
+                                                            HTTPUpstreamOptions options);
+
+// parses a comma separated list of servers, e.g. from an environment variable
+NODISCARD HTTPUpstreamGroup* initialize_http_upstream_group_from_list(const char* server_list,
+                                                                      HTTPUpstreamOptions options);
+
+// has to be called after all requests are finished, this closes the pooled connections
+void free_http_upstream_group(HTTPUpstreamGroup* group);
+
+// forwards the request to one of the servers and relays the response, errors of the upstream are
+// answered with a 502 (or a 503, if all servers are at their connection limit)
+// http/1.x responses are streamed in slices, so a slow client slows down the reads from the
+// upstream, instead of the response being buffered
+// returns an error, if the client connection is in an undefined state afterwards, e.g. because
+// a response was sent only partially, then the connection has to be closed
+NODISCARD GenericResult http_upstream_proxy_request(HTTPUpstreamGroup* group,
+                                                    const ConnectionDescriptor* descriptor,
+                                                    HTTPGeneralContext* general_context,
+                                                    SendSettings send_settings,
+                                                    HttpRequest http_request, ParsedURLPath path,
+                                                    IPAddress address);
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,7 +12,7 @@ NODISCARD ParsedURLPath parse_url_path(const tstr_view path) {
 
 	ParsedURLPath result = { .search_path = {
 		                         .hash_map = TMAP_EMPTY(ParsedSearchPathHashMap),
-		                     } ,.fragment = tstr_null()};
+		                     } ,.query = tstr_null(), .fragment = tstr_null()};
 
 	tstr_view search_path;
 	tstr_view path_view;
@@ -48,6 +48,10 @@ NODISCARD ParsedURLPath parse_url_path(const tstr_view path) {
 	result.path = tstr_from_view(path_view);
 	result.fragment = tstr_from_view(fragment_view);
 
+	if(search_path_res.ok) {
+		result.query = tstr_from_view(search_path);
+	}
+
 	tstr_view search_params = search_path;
 
 	if(search_params.len == 0) {
@@ -81,18 +85,19 @@ NODISCARD ParsedURLPath parse_url_path(const tstr_view path) {
 			value = value_res.second;
 		}
 
-		const ParsedSearchPathValue value_entry = { .val = tstr_from_view(value) };
+		ParsedSearchPathValue value_entry = { .val = tstr_from_view(value) };
+		tstr key_entry = tstr_from_view(key);
 
 		const TmapInsertResult insert_result =
-		    TMAP_INSERT(ParsedSearchPathHashMap, &(result.search_path.hash_map),
-		                tstr_from_view(key), value_entry, false);
+		    TMAP_INSERT(ParsedSearchPathHashMap, &(result.search_path.hash_map), key_entry,
+		                value_entry, false);
 
 		switch(insert_result) {
 			case TmapInsertResultWouldOverwrite: {
-				// TODO(Totto): search path keys can be non unique, either error, as we don't
-				// support duplicates here, or just append them to the existing string, but with
-				// what separator?
-				UNREACHABLE();
+				// search path keys can be repeated, the first value is kept, all values are still
+				// in the query
+				tstr_free(&key_entry);
+				tstr_free(&value_entry.val);
 				break;
 			}
 			case TmapInsertResultOk: {
@@ -290,7 +295,7 @@ NODISCARD static ParsedRequestUriResult parse_uri_or_authority(const tstr_view p
 
 		ParsedURLPath parsed_path =  {.path=TSTR_LIT("/"), .search_path= {
 		                         .hash_map = TMAP_INIT(ParsedSearchPathHashMap),
-		                     },.fragment = tstr_null()};
+		                     },.query = tstr_null(),.fragment = tstr_null()};
 
 		uri.path = parsed_path;
 	} else {
@@ -315,7 +320,7 @@ NODISCARD ParsedRequestUriResult parse_request_uri(const tstr_view path) {
 		result.type = ParsedURITypeAbsPath;
 		result.data.path = (ParsedURLPath){.path=TSTR_LIT("/"), .search_path= {
 		                         .hash_map = TMAP_INIT(ParsedSearchPathHashMap),
-		                     },.fragment = tstr_null()};
+		                     },.query = tstr_null(),.fragment = tstr_null()};
 
 		return new_parsed_request_uri_result_ok(result);
 	}
@@ -354,6 +359,7 @@ static void free_parsed_url_path(ParsedURLPath path) {
 
 	TMAP_FREE(ParsedSearchPathHashMap, &(path.search_path.hash_map));
 
+	tstr_free(&path.query);
 	tstr_free(&path.fragment);
 }
 
@@ -400,13 +406,17 @@ void free_parsed_request_uri(ParsedRequestURI uri) {
 
 NODISCARD tstr get_parsed_url_as_string(ParsedURLPath path) {
 
-	// TODO(Totto): support escape codes!
-
 	StringBuilder* string_builder = string_builder_init();
 
 	string_builder_append_single(string_builder, tstr_cstr(&path.path));
 
-	if(!TMAP_IS_EMPTY(ParsedSearchPathHashMap, &path.search_path.hash_map)) {
+	// the received query keeps the order, the repeated keys and the escape codes of the parameters
+	if(!tstr_is_null(&path.query)) {
+		string_builder_append_single(string_builder, "?");
+		string_builder_append_tstr(string_builder, &path.query);
+	} else if(!TMAP_IS_EMPTY(ParsedSearchPathHashMap, &path.search_path.hash_map)) {
+
+		// TODO(Totto): support escape codes!
 
 		string_builder_append_single(string_builder, "?");
 
@@ -423,7 +433,7 @@ NODISCARD tstr get_parsed_url_as_string(ParsedURLPath path) {
 				string_builder_append_single(string_builder, "&");
 			}
 
-			start = true;
+			start = false;
 
 			string_builder_append_single(string_builder, tstr_cstr(&entry.key));
 
@@ -535,6 +545,7 @@ static ParsedURLPath duplicate_path(const ParsedURLPath path) {
 	ParsedURLPath result = {
 		.path = tstr_null(),
 		.search_path = { .hash_map = TMAP_EMPTY(ParsedSearchPathHashMap), },
+		.query = tstr_null(),
 		.fragment = tstr_null(),
 	};
 
@@ -542,6 +553,10 @@ static ParsedURLPath duplicate_path(const ParsedURLPath path) {
 		result.path = tstr_dup(&path.path);
 	}
 
+	if(!tstr_is_null(&path.query)) {
+		result.query = tstr_dup(&path.query);
+	}
+
 	TMAP_TYPENAME_ITER(ParsedSearchPathHashMap)
 	iter = TMAP_ITER_INIT(ParsedSearchPathHashMap, &path.search_path.hash_map);
 
@@ -576,6 +591,7 @@ static ParsedURI duplicate_uri(const ParsedURI uri) {
 		               .port = 0 },
 		.path = { .path = tstr_null(),
 		          .search_path = { .hash_map = TMAP_EMPTY(ParsedSearchPathHashMap) },
+		          .query = tstr_null(),
 		          .fragment = tstr_null() }
 	};
 
@@ -34,6 +34,9 @@ typedef struct {
 typedef struct {
 	tstr path;
 	ParsedSearchPath /* NULLABLE */ search_path;
+	// the query as it was received, without the '?', the search path neither keeps the order nor
+	// repeated keys, so this is used, where the query has to be passed on unchanged
+	tstr /* NULLABLE */ query;
 	tstr /* NULLABLE */ fragment;
 } ParsedURLPath;
 
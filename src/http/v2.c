@@ -2819,6 +2819,46 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
 	                                        PseudoHeadersForHttp2Scheme | PseudoHeadersForHttp2Path,
 } PseudoHeadersForHttp2;
 
+// see https://datatracker.ietf.org/doc/html/rfc9113#section-8.2.1, these fields could otherwise
+// smuggle header fields or whole requests, if the request is forwarded as http/1.1
+NODISCARD static bool is_valid_http2_header_field(const HttpHeaderField* const field) {
+
+	tstr_view name = tstr_as_view(&(field->key));
+
+	// the pseudo header field names are checked later
+	if(name.len > 0 && name.data[0] == ':') {
+		name.data++;
+		name.len--;
+	}
+
+	if(!is_valid_http_header_field_name(name)) {
+		return false;
+	}
+
+	for(size_t i = 0; i < name.len; ++i) {
+		if(name.data[i] >= 'A' && name.data[i] <= 'Z') {
+			return false;
+		}
+	}
+
+	const tstr_view value = tstr_as_view(&(field->value));
+
+	if(!is_valid_http_header_field_value(value)) {
+		return false;
+	}
+
+	if(value.len > 0) {
+		const char first = value.data[0];
+		const char last = value.data[value.len - 1];
+
+		if(first == ' ' || first == '\t' || last == ' ' || last == '\t') {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 NODISCARD static Http2RequestHeadersResult
 parse_http2_headers(HpackDecompressState* const hpack_decompress_state,
                     const Http2StreamHeaders headers, const Http2Identifier stream_identifier) {
@@ -2881,6 +2921,14 @@ parse_http2_headers(HpackDecompressState* const hpack_decompress_state,
 	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, http2_headers); ++i) {
 		HttpHeaderField entry = TVEC_AT(HttpHeaderField, http2_headers, i);
 
+		if(!is_valid_http2_header_field(&entry)) {
+			return (Http2RequestHeadersResult){ .type = Http2RequestHeadersResultTypeError,
+				                                .data = {
+				                                    .error = TSTR_STATIC_LIT(
+				                                        "invalid character in a header field"),
+				                                } };
+		}
+
 		if(tstr_len(&entry.key) > 0 && tstr_cstr(&entry.key)[0] == ':') {
 			if(pseudo_headers_finished) {
 				return (Http2RequestHeadersResult){ .type = Http2RequestHeadersResultTypeError,
@@ -3005,6 +3053,8 @@ parse_http2_headers(HpackDecompressState* const hpack_decompress_state,
 			                            } };
 	}
 
+	index_http_request_head(&result);
+
 	return (Http2RequestHeadersResult){ .type = Http2RequestHeadersResultTypeOk,
 		                                .data = {
 		                                    .result = result,
@@ -3051,7 +3101,11 @@ get_http2_request_from_finished_stream(Http2ContextState* const state,
 				                        } };
 	}
 
-	const HttpRequest request = { .head = head, .body = body_res.result };
+	const HttpRequest request = { .head = head,
+		                          .body = body_res.result,
+		                          .body_storage = { .type = HttpRequestBodyStorageTypeMemory,
+		                                            .fd = -1 },
+		                          .trailer_fields = TVEC_EMPTY(HttpHeaderField) };
 
 	const RequestSettings settings = get_request_settings(request);
 
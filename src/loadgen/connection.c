@@ -0,0 +1,1567 @@
+
+#include "./connection.h"
+#include "http/hpack.h"
+#include "http/v2.h"
+#include "utils/clock.h"
+#include "utils/number_parsing.h"
+#include "ws/types.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// after a failed connect or a broken connection, the connection is reopened after this delay, so
+// that a server, that is down, isn't flooded with connects
+#define LOADGEN_RECONNECT_DELAY_US 10000
+
+#define LOADGEN_READ_CHUNK_SIZE 16384
+
+#define LOADGEN_BUFFER_INITIAL_CAPACITY 4096
+
+// the head of a response and a single chunk size or trailer line have to fit into this
+#define LOADGEN_MAX_HEAD_SIZE 65536
+
+#define LOADGEN_MAX_LINE_SIZE 1024
+
+// the websocket messages are echoed, so they are bounded by the message size, this is just a
+// safety net against broken frames
+#define LOADGEN_MAX_WS_FRAME_SIZE (1ULL << 30)
+
+// the mask key of the sent websocket frames, the payload is not checked, so it can be constant
+#define LOADGEN_WS_MASK_KEY { 0x12, 0x34, 0x56, 0x78 }
+
+#define LOADGEN_WS_MASK_KEY_SIZE 4
+
+#define LOADGEN_HTTP2_CLIENT_PREFACE "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+
+#define LOADGEN_HTTP2_FRAME_HEADER_SIZE 9
+
+// the default SETTINGS_MAX_FRAME_SIZE, it is not changed by the load generator
+#define LOADGEN_HTTP2_MAX_FRAME_SIZE 16384
+
+#define LOADGEN_HTTP2_DEFAULT_WINDOW_SIZE 65535
+
+#define LOADGEN_HTTP2_MAX_WINDOW_SIZE 0x7FFFFFFF
+
+#define LOADGEN_HTTP2_MAX_STREAM_IDENTIFIER 0x7FFFFFFF
+
+// the connection window is refilled, once this much data was received
+#define LOADGEN_HTTP2_WINDOW_UPDATE_THRESHOLD (1 << 30)
+
+/**
+ * @enum MASK / FLAGS
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	LoadgenHttp2FlagEndStream = 0x01,
+	LoadgenHttp2FlagAck = 0x01,
+	LoadgenHttp2FlagEndHeaders = 0x04,
+	LoadgenHttp2FlagPadded = 0x08,
+	LoadgenHttp2FlagPriority = 0x20,
+} LoadgenHttp2Flag;
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	LoadgenConnectionStateClosed = 0,
+	LoadgenConnectionStateConnecting,
+	// the websocket upgrade request or the http2 preface was sent, but not yet answered
+	LoadgenConnectionStateHandshake,
+	LoadgenConnectionStateIdle,
+	LoadgenConnectionStateWaiting,
+} LoadgenConnectionState;
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	LoadgenHttp1PartHead = 0,
+	LoadgenHttp1PartBody,
+	LoadgenHttp1PartChunkSize,
+	LoadgenHttp1PartChunkData,
+	LoadgenHttp1PartTrailers,
+	// neither a content length nor chunked encoding, the body ends with the connection
+	LoadgenHttp1PartUntilClose,
+} LoadgenHttp1Part;
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	LoadgenParseResultNeedMore = 0,
+	// the response or the handshake is complete
+	LoadgenParseResultDone,
+	// the server closes the connection gracefully
+	LoadgenParseResultClose,
+	LoadgenParseResultError,
+} LoadgenParseResult;
+
+typedef struct {
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+	// the bytes before the offset are already consumed
+	size_t offset;
+} LoadgenBuffer;
+
+typedef struct {
+	LoadgenHttp1Part part;
+	// the bytes of the head, that were already searched for its end
+	size_t scanned_head_bytes;
+	// of the body or of the current chunk, including the line break after the chunk
+	uint64_t remaining_bytes;
+} LoadgenHttp1State;
+
+typedef struct {
+	HpackDecompressState* decompress_state;
+	uint32_t stream_identifier;
+	uint32_t next_stream_identifier;
+	// a header block, that is continued in CONTINUATION frames
+	LoadgenBuffer header_block;
+	bool header_block_pending;
+	bool header_block_end_stream;
+	uint32_t header_block_stream_identifier;
+	// received DATA bytes, that were not yet given back with a WINDOW_UPDATE
+	uint64_t unacknowledged_bytes;
+} LoadgenHttp2State;
+
+struct LoadgenConnectionImpl {
+	const LoadgenTarget* target;
+	LoadgenStats* stats;
+	int epoll_fd;
+	int fd;
+	LoadgenConnectionState state;
+	uint64_t retry_at_us;
+	uint64_t intended_send_us;
+	uint64_t actual_send_us;
+	uint16_t status;
+	bool close_after_response;
+	// http1: the request, http2: the hpack encoded request headers, they don't use the dynamic
+	// table, so they can be reused, ws: the masked message frame
+	SizedBuffer request;
+	// ws: the upgrade request, empty otherwise
+	SizedBuffer handshake;
+	LoadgenBuffer write_buffer;
+	LoadgenBuffer read_buffer;
+	LoadgenHttp1State http1;
+	LoadgenHttp2State http2;
+};
+
+NODISCARD uint64_t get_loadgen_timestamp_us(void) {
+	Time now;
+
+	if(!get_monotonic_time(&now)) {
+		return 0;
+	}
+
+	return get_time_in_nano_seconds(now) / (S_TO_NS_RATE / S_TO_US_RATE);
+}
+
+NODISCARD static size_t loadgen_buffer_get_available(const LoadgenBuffer* const buffer) {
+	return buffer->size - buffer->offset;
+}
+
+NODISCARD static const uint8_t* loadgen_buffer_get_current(const LoadgenBuffer* const buffer) {
+	return buffer->data + buffer->offset;
+}
+
+static void loadgen_buffer_consume(LoadgenBuffer* const buffer, const size_t amount) {
+	buffer->offset += amount;
+
+	if(buffer->offset >= buffer->size) {
+		buffer->offset = 0;
+		buffer->size = 0;
+	}
+}
+
+static void loadgen_buffer_clear(LoadgenBuffer* const buffer) {
+	buffer->offset = 0;
+	buffer->size = 0;
+}
+
+static void free_loadgen_buffer(LoadgenBuffer* const buffer) {
+	free(buffer->data);
+	*buffer = (LoadgenBuffer){ .data = NULL, .size = 0, .capacity = 0, .offset = 0 };
+}
+
+NODISCARD static bool loadgen_buffer_reserve(LoadgenBuffer* const buffer, const size_t additional) {
+
+	// move the unconsumed bytes to the front, before growing the buffer
+	if(buffer->offset > 0 && buffer->offset >= buffer->capacity / 2) {
+		memmove(buffer->data, buffer->data + buffer->offset, buffer->size - buffer->offset);
+		buffer->size -= buffer->offset;
+		buffer->offset = 0;
+	}
+
+	if(buffer->size + additional <= buffer->capacity) {
+		return true;
+	}
+
+	size_t new_capacity =
+	    buffer->capacity == 0 ? LOADGEN_BUFFER_INITIAL_CAPACITY : buffer->capacity * 2;
+
+	while(new_capacity < buffer->size + additional) {
+		new_capacity *= 2;
+	}
+
+	uint8_t* const new_data = realloc(buffer->data, new_capacity);
+
+	if(new_data == NULL) {
+		return false;
+	}
+
+	buffer->data = new_data;
+	buffer->capacity = new_capacity;
+
+	return true;
+}
+
+NODISCARD static bool loadgen_buffer_append(LoadgenBuffer* const buffer, const void* const data,
+                                            const size_t size) {
+
+	if(size == 0) {
+		return true;
+	}
+
+	if(!loadgen_buffer_reserve(buffer, size)) {
+		return false;
+	}
+
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+
+	return true;
+}
+
+// returns size, if the needle was not found
+NODISCARD static size_t find_loadgen_bytes(const uint8_t* const data, const size_t size,
+                                           const char* const needle) {
+
+	const size_t needle_size = strlen(needle);
+
+	if(size < needle_size) {
+		return size;
+	}
+
+	for(size_t i = 0; i + needle_size <= size; ++i) {
+		if(memcmp(data + i, needle, needle_size) == 0) {
+			return i;
+		}
+	}
+
+	return size;
+}
+
+static void write_loadgen_u32_be(uint8_t* const destination, const uint32_t value) {
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	destination[0] = (uint8_t)((value >> 24) & 0xFF);
+	destination[1] = (uint8_t)((value >> 16) & 0xFF);
+	destination[2] = (uint8_t)((value >> 8) & 0xFF);
+	destination[3] = (uint8_t)(value & 0xFF);
+	/* NOLINTEND(readability-magic-numbers) */
+}
+
+NODISCARD static uint32_t read_loadgen_u32_be(const uint8_t* const source) {
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	return (((uint32_t)source[0]) << 24) | (((uint32_t)source[1]) << 16) |
+	       (((uint32_t)source[2]) << 8) | ((uint32_t)source[3]);
+	/* NOLINTEND(readability-magic-numbers) */
+}
+
+// returns false, if the connection broke
+NODISCARD static bool loadgen_connection_flush(LoadgenConnection* const connection) {
+
+	LoadgenBuffer* const buffer = &connection->write_buffer;
+
+	while(loadgen_buffer_get_available(buffer) > 0) {
+		const ssize_t written =
+		    send(connection->fd, loadgen_buffer_get_current(buffer),
+		         loadgen_buffer_get_available(buffer), MSG_NOSIGNAL);
+
+		if(written < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+
+			// the rest is written, once epoll reports the connection as writable
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+		loadgen_buffer_consume(buffer, (size_t)written);
+	}
+
+	return true;
+}
+
+NODISCARD static bool loadgen_connection_queue(LoadgenConnection* const connection,
+                                               const void* const data, const size_t size) {
+	return loadgen_buffer_append(&connection->write_buffer, data, size);
+}
+
+NODISCARD static bool loadgen_connection_queue_http2_frame(LoadgenConnection* const connection,
+                                                           const Http2FrameType type,
+                                                           const uint8_t flags,
+                                                           const uint32_t stream_identifier,
+                                                           const void* const payload,
+                                                           const size_t length) {
+
+	uint8_t header[LOADGEN_HTTP2_FRAME_HEADER_SIZE];
+
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	header[0] = (uint8_t)((length >> 16) & 0xFF);
+	header[1] = (uint8_t)((length >> 8) & 0xFF);
+	header[2] = (uint8_t)(length & 0xFF);
+	header[3] = (uint8_t)type;
+	header[4] = flags;
+	write_loadgen_u32_be(header + 5, stream_identifier & LOADGEN_HTTP2_MAX_STREAM_IDENTIFIER);
+	/* NOLINTEND(readability-magic-numbers) */
+
+	return loadgen_connection_queue(connection, header, sizeof(header)) &&
+	       loadgen_connection_queue(connection, payload, length);
+}
+
+NODISCARD static bool
+loadgen_connection_queue_http2_window_update(LoadgenConnection* const connection,
+                                             const uint32_t stream_identifier,
+                                             const uint32_t increment) {
+
+	uint8_t payload[sizeof(uint32_t)];
+	write_loadgen_u32_be(payload, increment & LOADGEN_HTTP2_MAX_WINDOW_SIZE);
+
+	return loadgen_connection_queue_http2_frame(connection, Http2FrameTypeWindowUpdate, 0,
+	                                            stream_identifier, payload, sizeof(payload));
+}
+
+// the frame header is followed by the extended payload length and the mask key
+NODISCARD static size_t write_loadgen_ws_frame_header(uint8_t* const destination,
+                                                      const WsOpcode opcode,
+                                                      const uint64_t payload_length) {
+
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	size_t header_size = 2;
+
+	// fin is always set
+	destination[0] = (uint8_t)(0x80 | opcode);
+
+	if(payload_length < 126) {
+		destination[1] = (uint8_t)(0x80 | payload_length);
+	} else if(payload_length <= UINT16_MAX) {
+		destination[1] = 0x80 | 126;
+		destination[2] = (uint8_t)((payload_length >> 8) & 0xFF);
+		destination[3] = (uint8_t)(payload_length & 0xFF);
+		header_size = 4;
+	} else {
+		destination[1] = 0x80 | 127;
+		for(size_t i = 0; i < 8; ++i) {
+			destination[2 + i] = (uint8_t)((payload_length >> ((7 - i) * 8)) & 0xFF);
+		}
+		header_size = 10;
+	}
+	/* NOLINTEND(readability-magic-numbers) */
+
+	const uint8_t mask_key[LOADGEN_WS_MASK_KEY_SIZE] = LOADGEN_WS_MASK_KEY;
+	memcpy(destination + header_size, mask_key, LOADGEN_WS_MASK_KEY_SIZE);
+
+	return header_size + LOADGEN_WS_MASK_KEY_SIZE;
+}
+
+// the maximum size of the header, the extended payload length and the mask key
+#define LOADGEN_WS_MAX_FRAME_HEADER_SIZE (10 + LOADGEN_WS_MASK_KEY_SIZE)
+
+static void mask_loadgen_ws_payload(uint8_t* const destination, const uint8_t* const payload,
+                                    const size_t length) {
+
+	const uint8_t mask_key[LOADGEN_WS_MASK_KEY_SIZE] = LOADGEN_WS_MASK_KEY;
+
+	for(size_t i = 0; i < length; ++i) {
+		destination[i] = payload[i] ^ mask_key[i % LOADGEN_WS_MASK_KEY_SIZE];
+	}
+}
+
+NODISCARD static SizedBuffer get_loadgen_ws_message_frame(const size_t message_size) {
+
+	SizedBuffer frame = allocate_sized_buffer(LOADGEN_WS_MAX_FRAME_HEADER_SIZE + message_size);
+
+	if(frame.data == NULL) {
+		return get_empty_sized_buffer();
+	}
+
+	uint8_t* const data = (uint8_t*)frame.data;
+
+	const size_t header_size = write_loadgen_ws_frame_header(data, WsOpcodeBin, message_size);
+
+	uint8_t* const payload = data + header_size;
+	memset(payload, 'x', message_size);
+	mask_loadgen_ws_payload(payload, payload, message_size);
+
+	frame.size = header_size + message_size;
+
+	return frame;
+}
+
+NODISCARD static SizedBuffer get_loadgen_http2_request_block(const LoadgenTarget* const target) {
+
+	HttpHeaderFields header_fields = TVEC_EMPTY(HttpHeaderField);
+
+	add_http_header_field(&header_fields, tstr_from_static_tstr(TSTR_STATIC_LIT(":method")),
+	                      tstr_from_static_tstr(TSTR_STATIC_LIT("GET")));
+	add_http_header_field(&header_fields, tstr_from_static_tstr(TSTR_STATIC_LIT(":scheme")),
+	                      tstr_from_static_tstr(TSTR_STATIC_LIT("http")));
+	add_http_header_field(&header_fields, tstr_from_static_tstr(TSTR_STATIC_LIT(":path")),
+	                      tstr_from_view(tstr_view_from(target->path)));
+	add_http_header_field(&header_fields, tstr_from_static_tstr(TSTR_STATIC_LIT(":authority")),
+	                      tstr_from_view(tstr_view_from(target->authority)));
+
+	// without any table additions, the compress state isn't used at all
+	const Http2HpackCompressOptions compress_options = {
+		.huffman_usage = Http2HpackHuffmanUsageAuto,
+		.type = Http2HpackCompressTypeStaticTableUsage,
+		.table_add_type = Http2HpackTableAddTypeNone,
+	};
+
+	const SizedBuffer block = http2_hpack_compress_data(NULL, header_fields, compress_options);
+
+	free_http_header_fields(&header_fields);
+
+	return block;
+}
+
+NODISCARD static SizedBuffer get_loadgen_http1_request(const LoadgenTarget* const target) {
+
+	char* request = NULL;
+	FORMAT_STRING_IMPL(&request, return get_empty_sized_buffer();, IMPL_STDERR_LOGGER,
+	                   "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n\r\n",
+	                   target->path, target->authority);
+
+	return (SizedBuffer){ .data = request, .size = strlen(request) };
+}
+
+// the key is not random, as the accept value is not checked
+NODISCARD static SizedBuffer get_loadgen_ws_handshake(const LoadgenTarget* const target) {
+
+	char* request = NULL;
+	FORMAT_STRING_IMPL(&request, return get_empty_sized_buffer();, IMPL_STDERR_LOGGER,
+	                   "GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\n"
+	                   "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+	                   "Sec-WebSocket-Version: 13\r\n\r\n",
+	                   target->path, target->authority);
+
+	return (SizedBuffer){ .data = request, .size = strlen(request) };
+}
+
+NODISCARD LoadgenConnection* initialize_loadgen_connection(const LoadgenTarget* const target,
+                                                           LoadgenStats* const stats,
+                                                           const int epoll_fd) {
+
+	LoadgenConnection* const connection = malloc(sizeof(LoadgenConnection));
+
+	if(connection == NULL) {
+		return NULL;
+	}
+
+	*connection = (LoadgenConnection){
+		.target = target,
+		.stats = stats,
+		.epoll_fd = epoll_fd,
+		.fd = -1,
+		.state = LoadgenConnectionStateClosed,
+		.retry_at_us = 0,
+		.intended_send_us = 0,
+		.actual_send_us = 0,
+		.status = 0,
+		.close_after_response = false,
+		.request = get_empty_sized_buffer(),
+		.handshake = get_empty_sized_buffer(),
+		.write_buffer = { .data = NULL, .size = 0, .capacity = 0, .offset = 0 },
+		.read_buffer = { .data = NULL, .size = 0, .capacity = 0, .offset = 0 },
+		.http1 = { .part = LoadgenHttp1PartHead, .scanned_head_bytes = 0, .remaining_bytes = 0 },
+		.http2 = { .decompress_state = NULL,
+		           .stream_identifier = 0,
+		           .next_stream_identifier = 1,
+		           .header_block = { .data = NULL, .size = 0, .capacity = 0, .offset = 0 },
+		           .header_block_pending = false,
+		           .header_block_end_stream = false,
+		           .header_block_stream_identifier = 0,
+		           .unacknowledged_bytes = 0 },
+	};
+
+	switch(target->protocol) {
+		case LoadgenProtocolHttp1: {
+			connection->request = get_loadgen_http1_request(target);
+			break;
+		}
+		case LoadgenProtocolH2c: {
+			connection->request = get_loadgen_http2_request_block(target);
+			break;
+		}
+		case LoadgenProtocolWs: {
+			connection->handshake = get_loadgen_ws_handshake(target);
+
+			if(connection->handshake.data == NULL) {
+				free(connection);
+				return NULL;
+			}
+
+			connection->request = get_loadgen_ws_message_frame(target->message_size);
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+
+	if(connection->request.data == NULL) {
+		free_sized_buffer(connection->handshake);
+		free(connection);
+		return NULL;
+	}
+
+	return connection;
+}
+
+static void loadgen_connection_close(LoadgenConnection* const connection, const bool failed) {
+
+	if(connection->fd >= 0) {
+		// closing the fd also removes it from the epoll instance
+		close(connection->fd);
+		connection->fd = -1;
+	}
+
+	if(failed) {
+		connection->stats->errors++;
+	}
+
+	if(connection->http2.decompress_state != NULL) {
+		free_hpack_decompress_state(connection->http2.decompress_state);
+		connection->http2.decompress_state = NULL;
+	}
+
+	loadgen_buffer_clear(&connection->write_buffer);
+	loadgen_buffer_clear(&connection->read_buffer);
+	loadgen_buffer_clear(&connection->http2.header_block);
+
+	connection->http1 = (LoadgenHttp1State){
+		.part = LoadgenHttp1PartHead, .scanned_head_bytes = 0, .remaining_bytes = 0
+	};
+
+	connection->http2.stream_identifier = 0;
+	connection->http2.next_stream_identifier = 1;
+	connection->http2.header_block_pending = false;
+	connection->http2.unacknowledged_bytes = 0;
+
+	connection->close_after_response = false;
+	connection->state = LoadgenConnectionStateClosed;
+
+	// a graceful close is followed by a reconnect at once
+	connection->retry_at_us = failed ? get_loadgen_timestamp_us() + LOADGEN_RECONNECT_DELAY_US : 0;
+}
+
+void free_loadgen_connection(LoadgenConnection* const connection) {
+
+	if(connection == NULL) {
+		return;
+	}
+
+	loadgen_connection_close(connection, false);
+
+	free_loadgen_buffer(&connection->write_buffer);
+	free_loadgen_buffer(&connection->read_buffer);
+	free_loadgen_buffer(&connection->http2.header_block);
+	free_sized_buffer(connection->request);
+	free_sized_buffer(connection->handshake);
+	free(connection);
+}
+
+NODISCARD static bool loadgen_connection_start_http2(LoadgenConnection* const connection) {
+
+	connection->http2.decompress_state =
+	    get_default_hpack_decompress_state(LOADGEN_BUFFER_INITIAL_CAPACITY);
+
+	if(connection->http2.decompress_state == NULL) {
+		return false;
+	}
+
+	const char* const preface = LOADGEN_HTTP2_CLIENT_PREFACE;
+
+	if(!loadgen_connection_queue(connection, preface, strlen(preface))) {
+		return false;
+	}
+
+	// push is not used, and the stream windows are big enough, that no stream ever has to be
+	// refilled
+	uint8_t settings[2 * (sizeof(uint16_t) + sizeof(uint32_t))];
+
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	settings[0] = 0;
+	settings[1] = (uint8_t)Http2SettingsFrameIdentifierEnablePush;
+	write_loadgen_u32_be(settings + 2, 0);
+	settings[6] = 0;
+	settings[7] = (uint8_t)Http2SettingsFrameIdentifierInitialWindowSize;
+	write_loadgen_u32_be(settings + 8, LOADGEN_HTTP2_MAX_WINDOW_SIZE);
+	/* NOLINTEND(readability-magic-numbers) */
+
+	if(!loadgen_connection_queue_http2_frame(connection, Http2FrameTypeSettings, 0, 0, settings,
+	                                         sizeof(settings))) {
+		return false;
+	}
+
+	return loadgen_connection_queue_http2_window_update(
+	    connection, 0, LOADGEN_HTTP2_MAX_WINDOW_SIZE - LOADGEN_HTTP2_DEFAULT_WINDOW_SIZE);
+}
+
+NODISCARD static bool loadgen_connection_on_connected(LoadgenConnection* const connection) {
+
+	switch(connection->target->protocol) {
+		case LoadgenProtocolHttp1: {
+			connection->state = LoadgenConnectionStateIdle;
+			return true;
+		}
+		case LoadgenProtocolH2c: {
+			connection->state = LoadgenConnectionStateHandshake;
+
+			if(!loadgen_connection_start_http2(connection)) {
+				return false;
+			}
+
+			return loadgen_connection_flush(connection);
+		}
+		case LoadgenProtocolWs: {
+			connection->state = LoadgenConnectionStateHandshake;
+
+			if(!loadgen_connection_queue(connection, connection->handshake.data,
+			                             connection->handshake.size)) {
+				return false;
+			}
+
+			return loadgen_connection_flush(connection);
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+NODISCARD static bool loadgen_connection_connect(LoadgenConnection* const connection) {
+
+	const LoadgenTarget* const target = connection->target;
+
+	const int socket_fd =
+	    socket(target->address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if(socket_fd < 0) {
+		return false;
+	}
+
+	connection->fd = socket_fd;
+	connection->state = LoadgenConnectionStateConnecting;
+	connection->stats->connects++;
+
+	if(target->address.ss_family != AF_UNIX) {
+		// the requests are small and latency sensitive, a failure only costs latency
+		const int enabled = 1;
+		setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+	}
+
+	// edge triggered, so that a connection, that waits for the response, isn't reported as
+	// writable all the time
+	struct epoll_event event = {
+		.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+		.data = { .ptr = connection },
+	};
+
+	if(epoll_ctl(connection->epoll_fd, EPOLL_CTL_ADD, socket_fd, &event) != 0) {
+		return false;
+	}
+
+	const int result =
+	    connect(socket_fd, (const struct sockaddr*)&target->address, target->address_length);
+
+	if(result == 0) {
+		return loadgen_connection_on_connected(connection);
+	}
+
+	// unix sockets report a full backlog with EAGAIN, that is handled as failure
+	return errno == EINPROGRESS;
+}
+
+void loadgen_connection_maintain(LoadgenConnection* const connection, const uint64_t now_us) {
+
+	if(connection->state != LoadgenConnectionStateClosed || now_us < connection->retry_at_us) {
+		return;
+	}
+
+	if(!loadgen_connection_connect(connection)) {
+		loadgen_connection_close(connection, true);
+	}
+}
+
+NODISCARD bool loadgen_connection_is_idle(const LoadgenConnection* const connection) {
+	return connection->state == LoadgenConnectionStateIdle;
+}
+
+NODISCARD static bool loadgen_connection_queue_request(LoadgenConnection* const connection) {
+
+	switch(connection->target->protocol) {
+		case LoadgenProtocolHttp1:
+		case LoadgenProtocolWs: {
+			return loadgen_connection_queue(connection, connection->request.data,
+			                                connection->request.size);
+		}
+		case LoadgenProtocolH2c: {
+			connection->http2.stream_identifier = connection->http2.next_stream_identifier;
+			connection->http2.next_stream_identifier += 2;
+
+			return loadgen_connection_queue_http2_frame(
+			    connection, Http2FrameTypeHeaders,
+			    LoadgenHttp2FlagEndStream | LoadgenHttp2FlagEndHeaders,
+			    connection->http2.stream_identifier, connection->request.data,
+			    connection->request.size);
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+void loadgen_connection_send_request(LoadgenConnection* const connection,
+                                     const uint64_t intended_send_us) {
+
+	if(connection->state != LoadgenConnectionStateIdle) {
+		return;
+	}
+
+	connection->intended_send_us = intended_send_us;
+	connection->actual_send_us = get_loadgen_timestamp_us();
+	connection->status = 0;
+	connection->state = LoadgenConnectionStateWaiting;
+
+	if(!loadgen_connection_queue_request(connection) || !loadgen_connection_flush(connection)) {
+		loadgen_connection_close(connection, true);
+	}
+}
+
+NODISCARD static bool is_loadgen_header_name(const tstr_view name, const char* const expected) {
+	const size_t expected_length = strlen(expected);
+
+	return name.len == expected_length && strncasecmp(name.data, expected, expected_length) == 0;
+}
+
+NODISCARD static bool has_loadgen_header_value_suffix(const tstr_view value,
+                                                      const char* const suffix) {
+	const size_t suffix_length = strlen(suffix);
+
+	return value.len >= suffix_length &&
+	       strncasecmp(value.data + (value.len - suffix_length), suffix, suffix_length) == 0;
+}
+
+NODISCARD static tstr_view trim_loadgen_header_value(const tstr_view value) {
+	tstr_view result = value;
+
+	while(result.len > 0 && (result.data[0] == ' ' || result.data[0] == '\t')) {
+		result.data++;
+		result.len--;
+	}
+
+	while(result.len > 0 && (result.data[result.len - 1] == ' ' ||
+	                         result.data[result.len - 1] == '\t')) {
+		result.len--;
+	}
+
+	return result;
+}
+
+// parses the status line and the headers, that define, where the body ends
+NODISCARD static bool loadgen_connection_parse_http1_head(LoadgenConnection* const connection,
+                                                          const char* const head,
+                                                          const size_t head_size) {
+
+	// "HTTP/1.1 200"
+	const size_t status_line_min_size = 12;
+
+	if(head_size < status_line_min_size || strncmp(head, "HTTP/1.", strlen("HTTP/1.")) != 0) {
+		return false;
+	}
+
+	bool success = false;
+	const uint64_t status =
+	    parse_u64((tstr_view){ .data = head + status_line_min_size - 3, .len = 3 }, &success);
+
+	if(!success) {
+		return false;
+	}
+
+	connection->status = (uint16_t)status;
+
+	bool chunked = false;
+	bool has_content_length = false;
+	uint64_t content_length = 0;
+
+	size_t position = find_loadgen_bytes((const uint8_t*)head, head_size, "\r\n") + 2;
+
+	while(position < head_size) {
+		const size_t line_length =
+		    find_loadgen_bytes((const uint8_t*)head + position, head_size - position, "\r\n");
+
+		if(line_length == 0) {
+			break;
+		}
+
+		const tstr_view line = { .data = head + position, .len = line_length };
+		position += line_length + 2;
+
+		const char* const colon = memchr(line.data, ':', line.len);
+
+		if(colon == NULL) {
+			return false;
+		}
+
+		const tstr_view name = { .data = line.data, .len = (size_t)(colon - line.data) };
+		const tstr_view value = trim_loadgen_header_value(
+		    (tstr_view){ .data = colon + 1, .len = line.len - name.len - 1 });
+
+		if(is_loadgen_header_name(name, "content-length")) {
+			content_length = parse_u64(value, &success);
+
+			if(!success) {
+				return false;
+			}
+
+			has_content_length = true;
+		} else if(is_loadgen_header_name(name, "transfer-encoding")) {
+			// chunked has to be the last transfer coding
+			chunked = has_loadgen_header_value_suffix(value, "chunked");
+		} else if(is_loadgen_header_name(name, "connection")) {
+			if(has_loadgen_header_value_suffix(value, "close")) {
+				connection->close_after_response = true;
+			}
+		}
+	}
+
+	LoadgenHttp1State* const state = &connection->http1;
+	state->part = LoadgenHttp1PartHead;
+	state->remaining_bytes = 0;
+
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	if(status < 200 || status == HttpStatusNoContent || status == HttpStatusNotModified) {
+		return true;
+	}
+	/* NOLINTEND(readability-magic-numbers) */
+
+	if(chunked) {
+		state->part = LoadgenHttp1PartChunkSize;
+	} else if(has_content_length) {
+		if(content_length > 0) {
+			state->part = LoadgenHttp1PartBody;
+			state->remaining_bytes = content_length;
+		}
+	} else {
+		state->part = LoadgenHttp1PartUntilClose;
+		connection->close_after_response = true;
+	}
+
+	return true;
+}
+
+NODISCARD static bool parse_loadgen_chunk_size(const tstr_view line, OUT_PARAM(uint64_t) size) {
+
+	uint64_t result = 0;
+	size_t digits = 0;
+
+	for(size_t i = 0; i < line.len; ++i) {
+		const char current = line.data[i];
+		uint64_t digit = 0;
+
+		/* NOLINTBEGIN(readability-magic-numbers) */
+		if(current >= '0' && current <= '9') {
+			digit = (uint64_t)(current - '0');
+		} else if(current >= 'a' && current <= 'f') {
+			digit = (uint64_t)(current - 'a') + 10;
+		} else if(current >= 'A' && current <= 'F') {
+			digit = (uint64_t)(current - 'A') + 10;
+		} else {
+			// chunk extensions are ignored
+			break;
+		}
+
+		// more would overflow
+		if(digits == 15) {
+			return false;
+		}
+
+		result = (result << 4) | digit;
+		/* NOLINTEND(readability-magic-numbers) */
+		++digits;
+	}
+
+	*size = result;
+	return digits > 0;
+}
+
+NODISCARD static LoadgenParseResult
+loadgen_connection_process_http1(LoadgenConnection* const connection) {
+
+	LoadgenHttp1State* const state = &connection->http1;
+	LoadgenBuffer* const buffer = &connection->read_buffer;
+
+	while(true) {
+		const uint8_t* const data = loadgen_buffer_get_current(buffer);
+		const size_t available = loadgen_buffer_get_available(buffer);
+
+		switch(state->part) {
+			case LoadgenHttp1PartHead: {
+				// the end may start in the already scanned bytes
+				const size_t search_start =
+				    state->scanned_head_bytes >= 3 ? state->scanned_head_bytes - 3 : 0;
+
+				const size_t end_position =
+				    find_loadgen_bytes(data + search_start, available - search_start, "\r\n\r\n");
+
+				if(search_start + end_position == available) {
+					state->scanned_head_bytes = available;
+					return available > LOADGEN_MAX_HEAD_SIZE ? LoadgenParseResultError
+					                                         : LoadgenParseResultNeedMore;
+				}
+
+				const size_t head_size = search_start + end_position + 4;
+				state->scanned_head_bytes = 0;
+
+				const bool parsed =
+				    loadgen_connection_parse_http1_head(connection, (const char*)data, head_size);
+
+				loadgen_buffer_consume(buffer, head_size);
+
+				if(!parsed) {
+					return LoadgenParseResultError;
+				}
+
+				// interim responses are followed by the real one, only the upgrade ends the
+				// http part
+				if(connection->status < 200 && // NOLINT(readability-magic-numbers)
+				   connection->status != HttpStatusSwitchingProtocols) {
+					continue;
+				}
+
+				if(state->part == LoadgenHttp1PartHead) {
+					return LoadgenParseResultDone;
+				}
+
+				break;
+			}
+			case LoadgenHttp1PartBody:
+			case LoadgenHttp1PartChunkData: {
+				const size_t amount =
+				    available < state->remaining_bytes ? available : state->remaining_bytes;
+
+				loadgen_buffer_consume(buffer, amount);
+				state->remaining_bytes -= amount;
+
+				if(state->remaining_bytes > 0) {
+					return LoadgenParseResultNeedMore;
+				}
+
+				if(state->part == LoadgenHttp1PartBody) {
+					state->part = LoadgenHttp1PartHead;
+					return LoadgenParseResultDone;
+				}
+
+				state->part = LoadgenHttp1PartChunkSize;
+				break;
+			}
+			case LoadgenHttp1PartChunkSize:
+			case LoadgenHttp1PartTrailers: {
+				const size_t line_length = find_loadgen_bytes(data, available, "\r\n");
+
+				if(line_length == available) {
+					return available > LOADGEN_MAX_LINE_SIZE ? LoadgenParseResultError
+					                                         : LoadgenParseResultNeedMore;
+				}
+
+				const tstr_view line = { .data = (const char*)data, .len = line_length };
+
+				loadgen_buffer_consume(buffer, line_length + 2);
+
+				if(state->part == LoadgenHttp1PartTrailers) {
+					if(line_length == 0) {
+						state->part = LoadgenHttp1PartHead;
+						return LoadgenParseResultDone;
+					}
+
+					break;
+				}
+
+				uint64_t chunk_size = 0;
+
+				if(!parse_loadgen_chunk_size(line, &chunk_size)) {
+					return LoadgenParseResultError;
+				}
+
+				if(chunk_size == 0) {
+					state->part = LoadgenHttp1PartTrailers;
+				} else {
+					state->part = LoadgenHttp1PartChunkData;
+					// the line break after the chunk
+					state->remaining_bytes = chunk_size + 2;
+				}
+
+				break;
+			}
+			case LoadgenHttp1PartUntilClose: {
+				loadgen_buffer_consume(buffer, available);
+				return LoadgenParseResultNeedMore;
+			}
+			default: {
+				return LoadgenParseResultError;
+			}
+		}
+	}
+}
+
+NODISCARD static bool loadgen_connection_decode_http2_headers(LoadgenConnection* const connection,
+                                                              OUT_PARAM(uint16_t) status) {
+
+	LoadgenBuffer* const block = &connection->http2.header_block;
+
+	const Http2HpackDecompressResult result = http2_hpack_decompress_data(
+	    connection->http2.decompress_state,
+	    (ReadonlyBuffer){ .data = loadgen_buffer_get_current(block),
+	                      .size = loadgen_buffer_get_available(block) });
+
+	loadgen_buffer_clear(block);
+
+	IF_HTTP2_HPACK_DECOMPRESS_RESULT_IS_ERROR_IGN(result) {
+		return false;
+	}
+
+	MUT HttpHeaderFields header_fields = http2_hpack_decompress_result_get_as_ok(result);
+
+	// trailers have no status
+	const HttpHeaderField* const status_field =
+	    find_header_by_key(header_fields, TSTR_STATIC_LIT(":status"));
+
+	if(status_field != NULL) {
+		bool success = false;
+		const uint64_t parsed = parse_u64(tstr_as_view(&status_field->value), &success);
+
+		if(success && parsed <= UINT16_MAX) {
+			*status = (uint16_t)parsed;
+		}
+	}
+
+	free_http_header_fields(&header_fields);
+
+	return true;
+}
+
+NODISCARD static LoadgenParseResult
+loadgen_connection_process_http2_headers(LoadgenConnection* const connection,
+                                         const Http2FrameType type, const uint8_t flags,
+                                         const uint32_t stream_identifier,
+                                         const uint8_t* const payload, const size_t length) {
+
+	LoadgenHttp2State* const state = &connection->http2;
+
+	size_t start = 0;
+	size_t end = length;
+
+	if(type == Http2FrameTypeHeaders) {
+		if(state->header_block_pending) {
+			return LoadgenParseResultError;
+		}
+
+		if((flags & LoadgenHttp2FlagPadded) != 0) {
+			if(length < 1 || payload[0] > length - 1) {
+				return LoadgenParseResultError;
+			}
+
+			start = 1;
+			end = length - payload[0];
+		}
+
+		if((flags & LoadgenHttp2FlagPriority) != 0) {
+			// the stream dependency and the weight
+			start += sizeof(uint32_t) + sizeof(uint8_t);
+
+			if(start > end) {
+				return LoadgenParseResultError;
+			}
+		}
+
+		state->header_block_end_stream = (flags & LoadgenHttp2FlagEndStream) != 0;
+		state->header_block_stream_identifier = stream_identifier;
+	} else if(!state->header_block_pending ||
+	          state->header_block_stream_identifier != stream_identifier) {
+		return LoadgenParseResultError;
+	}
+
+	if(!loadgen_buffer_append(&state->header_block, payload + start, end - start)) {
+		return LoadgenParseResultError;
+	}
+
+	state->header_block_pending = (flags & LoadgenHttp2FlagEndHeaders) == 0;
+
+	if(state->header_block_pending) {
+		return LoadgenParseResultNeedMore;
+	}
+
+	// every block has to be decoded, so that the dynamic table stays in sync
+	uint16_t status = 0;
+
+	if(!loadgen_connection_decode_http2_headers(connection, &status)) {
+		return LoadgenParseResultError;
+	}
+
+	if(connection->state != LoadgenConnectionStateWaiting ||
+	   stream_identifier != state->stream_identifier) {
+		return LoadgenParseResultNeedMore;
+	}
+
+	if(status != 0) {
+		connection->status = status;
+	}
+
+	return state->header_block_end_stream ? LoadgenParseResultDone : LoadgenParseResultNeedMore;
+}
+
+NODISCARD static LoadgenParseResult
+loadgen_connection_process_http2_frame(LoadgenConnection* const connection,
+                                       const Http2FrameType type, const uint8_t flags,
+                                       const uint32_t stream_identifier,
+                                       const uint8_t* const payload, const size_t length) {
+
+	LoadgenHttp2State* const state = &connection->http2;
+
+	const bool is_current_stream = connection->state == LoadgenConnectionStateWaiting &&
+	                               stream_identifier == state->stream_identifier;
+
+	switch(type) {
+		case Http2FrameTypeData: {
+			state->unacknowledged_bytes += length;
+
+			if(state->unacknowledged_bytes >= LOADGEN_HTTP2_WINDOW_UPDATE_THRESHOLD) {
+				if(!loadgen_connection_queue_http2_window_update(
+				       connection, 0, (uint32_t)state->unacknowledged_bytes)) {
+					return LoadgenParseResultError;
+				}
+
+				state->unacknowledged_bytes = 0;
+			}
+
+			return is_current_stream && (flags & LoadgenHttp2FlagEndStream) != 0
+			           ? LoadgenParseResultDone
+			           : LoadgenParseResultNeedMore;
+		}
+		case Http2FrameTypeHeaders:
+		case Http2FrameTypeContinuation: {
+			return loadgen_connection_process_http2_headers(connection, type, flags,
+			                                                stream_identifier, payload, length);
+		}
+		case Http2FrameTypeRstStream: {
+			return is_current_stream ? LoadgenParseResultError : LoadgenParseResultNeedMore;
+		}
+		case Http2FrameTypeSettings: {
+			if((flags & LoadgenHttp2FlagAck) != 0) {
+				return LoadgenParseResultNeedMore;
+			}
+
+			if(!loadgen_connection_queue_http2_frame(connection, Http2FrameTypeSettings,
+			                                         LoadgenHttp2FlagAck, 0, NULL, 0)) {
+				return LoadgenParseResultError;
+			}
+
+			return connection->state == LoadgenConnectionStateHandshake
+			           ? LoadgenParseResultDone
+			           : LoadgenParseResultNeedMore;
+		}
+		case Http2FrameTypePing: {
+			if((flags & LoadgenHttp2FlagAck) != 0) {
+				return LoadgenParseResultNeedMore;
+			}
+
+			return loadgen_connection_queue_http2_frame(connection, Http2FrameTypePing,
+			                                            LoadgenHttp2FlagAck, 0, payload, length)
+			           ? LoadgenParseResultNeedMore
+			           : LoadgenParseResultError;
+		}
+		case Http2FrameTypeGoaway: {
+			if(length < sizeof(uint32_t)) {
+				return LoadgenParseResultError;
+			}
+
+			const uint32_t last_stream_identifier =
+			    read_loadgen_u32_be(payload) & LOADGEN_HTTP2_MAX_STREAM_IDENTIFIER;
+
+			// the request in flight is still answered, if the server already accepted it
+			if(connection->state == LoadgenConnectionStateWaiting &&
+			   last_stream_identifier >= state->stream_identifier) {
+				connection->close_after_response = true;
+				return LoadgenParseResultNeedMore;
+			}
+
+			return connection->state == LoadgenConnectionStateWaiting ? LoadgenParseResultError
+			                                                          : LoadgenParseResultClose;
+		}
+		case Http2FrameTypePriority:
+		case Http2FrameTypePushPromise:
+		case Http2FrameTypeWindowUpdate:
+		default: {
+			return LoadgenParseResultNeedMore;
+		}
+	}
+}
+
+NODISCARD static LoadgenParseResult
+loadgen_connection_process_http2(LoadgenConnection* const connection) {
+
+	LoadgenBuffer* const buffer = &connection->read_buffer;
+
+	while(loadgen_buffer_get_available(buffer) >= LOADGEN_HTTP2_FRAME_HEADER_SIZE) {
+		const uint8_t* const header = loadgen_buffer_get_current(buffer);
+
+		/* NOLINTBEGIN(readability-magic-numbers) */
+		const size_t length =
+		    (((size_t)header[0]) << 16) | (((size_t)header[1]) << 8) | ((size_t)header[2]);
+		const Http2FrameType type = (Http2FrameType)header[3];
+		const uint8_t flags = header[4];
+		const uint32_t stream_identifier =
+		    read_loadgen_u32_be(header + 5) & LOADGEN_HTTP2_MAX_STREAM_IDENTIFIER;
+		/* NOLINTEND(readability-magic-numbers) */
+
+		if(length > LOADGEN_HTTP2_MAX_FRAME_SIZE) {
+			return LoadgenParseResultError;
+		}
+
+		if(loadgen_buffer_get_available(buffer) < LOADGEN_HTTP2_FRAME_HEADER_SIZE + length) {
+			return LoadgenParseResultNeedMore;
+		}
+
+		const LoadgenParseResult result = loadgen_connection_process_http2_frame(
+		    connection, type, flags, stream_identifier, header + LOADGEN_HTTP2_FRAME_HEADER_SIZE,
+		    length);
+
+		loadgen_buffer_consume(buffer, LOADGEN_HTTP2_FRAME_HEADER_SIZE + length);
+
+		if(result != LoadgenParseResultNeedMore) {
+			return result;
+		}
+	}
+
+	return LoadgenParseResultNeedMore;
+}
+
+NODISCARD static bool loadgen_connection_queue_ws_pong(LoadgenConnection* const connection,
+                                                       const uint8_t* const payload,
+                                                       const size_t length) {
+
+	// control frames have at most 125 bytes of payload
+	uint8_t frame[LOADGEN_WS_MAX_FRAME_HEADER_SIZE + 125]; // NOLINT(readability-magic-numbers)
+
+	if(length > sizeof(frame) - LOADGEN_WS_MAX_FRAME_HEADER_SIZE) {
+		return false;
+	}
+
+	const size_t header_size = write_loadgen_ws_frame_header(frame, WsOpcodePong, length);
+	mask_loadgen_ws_payload(frame + header_size, payload, length);
+
+	return loadgen_connection_queue(connection, frame, header_size + length);
+}
+
+NODISCARD static LoadgenParseResult
+loadgen_connection_process_ws(LoadgenConnection* const connection) {
+
+	if(connection->state == LoadgenConnectionStateHandshake) {
+		const LoadgenParseResult result = loadgen_connection_process_http1(connection);
+
+		if(result == LoadgenParseResultDone &&
+		   connection->status != HttpStatusSwitchingProtocols) {
+			return LoadgenParseResultError;
+		}
+
+		return result;
+	}
+
+	LoadgenBuffer* const buffer = &connection->read_buffer;
+
+	while(loadgen_buffer_get_available(buffer) >= 2) {
+		const uint8_t* const data = loadgen_buffer_get_current(buffer);
+		const size_t available = loadgen_buffer_get_available(buffer);
+
+		/* NOLINTBEGIN(readability-magic-numbers) */
+		const bool fin = (data[0] & 0x80) != 0;
+		const WsOpcode opcode = (WsOpcode)(data[0] & 0x0F);
+		const bool masked = (data[1] & 0x80) != 0;
+		uint64_t payload_length = data[1] & 0x7F;
+		size_t header_size = 2;
+
+		if(payload_length == 126) {
+			header_size = 4;
+		} else if(payload_length == 127) {
+			header_size = 10;
+		}
+
+		if(available < header_size) {
+			return LoadgenParseResultNeedMore;
+		}
+
+		if(header_size > 2) {
+			payload_length = 0;
+			for(size_t i = 2; i < header_size; ++i) {
+				payload_length = (payload_length << 8) | data[i];
+			}
+		}
+		/* NOLINTEND(readability-magic-numbers) */
+
+		// servers don't mask their frames, but skipping the key costs nothing
+		if(masked) {
+			header_size += LOADGEN_WS_MASK_KEY_SIZE;
+		}
+
+		if(payload_length > LOADGEN_MAX_WS_FRAME_SIZE) {
+			return LoadgenParseResultError;
+		}
+
+		if(available < header_size + payload_length) {
+			return LoadgenParseResultNeedMore;
+		}
+
+		LoadgenParseResult result = LoadgenParseResultNeedMore;
+
+		switch(opcode) {
+			case WsOpcodeCont:
+			case WsOpcodeText:
+			case WsOpcodeBin: {
+				if(fin && connection->state == LoadgenConnectionStateWaiting) {
+					result = LoadgenParseResultDone;
+				}
+				break;
+			}
+			case WsOpcodeClose: {
+				result = connection->state == LoadgenConnectionStateWaiting
+				             ? LoadgenParseResultError
+				             : LoadgenParseResultClose;
+				break;
+			}
+			case WsOpcodePing: {
+				if(!loadgen_connection_queue_ws_pong(connection, data + header_size,
+				                                     (size_t)payload_length)) {
+					result = LoadgenParseResultError;
+				}
+				break;
+			}
+			case WsOpcodePong: {
+				break;
+			}
+			default: {
+				result = LoadgenParseResultError;
+				break;
+			}
+		}
+
+		loadgen_buffer_consume(buffer, header_size + (size_t)payload_length);
+
+		if(result != LoadgenParseResultNeedMore) {
+			return result;
+		}
+	}
+
+	return LoadgenParseResultNeedMore;
+}
+
+NODISCARD static LoadgenParseResult
+loadgen_connection_process(LoadgenConnection* const connection) {
+
+	switch(connection->target->protocol) {
+		case LoadgenProtocolHttp1: {
+			return loadgen_connection_process_http1(connection);
+		}
+		case LoadgenProtocolH2c: {
+			return loadgen_connection_process_http2(connection);
+		}
+		case LoadgenProtocolWs: {
+			return loadgen_connection_process_ws(connection);
+		}
+		default: {
+			return LoadgenParseResultError;
+		}
+	}
+}
+
+static void loadgen_connection_complete_response(LoadgenConnection* const connection) {
+
+	const uint64_t now_us = get_loadgen_timestamp_us();
+	LoadgenStats* const stats = connection->stats;
+
+	stats->responses++;
+
+	if(connection->status >= HttpStatusBadRequest) {
+		stats->error_responses++;
+	}
+
+	if(now_us >= connection->intended_send_us) {
+		latency_histogram_record(stats->latencies, now_us - connection->intended_send_us);
+	}
+
+	if(now_us >= connection->actual_send_us) {
+		latency_histogram_record(stats->service_latencies, now_us - connection->actual_send_us);
+	}
+
+	connection->state = LoadgenConnectionStateIdle;
+
+	if(connection->http2.next_stream_identifier > LOADGEN_HTTP2_MAX_STREAM_IDENTIFIER - 2) {
+		connection->close_after_response = true;
+	}
+}
+
+// returns false, if the connection was closed
+NODISCARD static bool loadgen_connection_handle_parse_result(LoadgenConnection* const connection,
+                                                             const LoadgenParseResult result) {
+
+	switch(result) {
+		case LoadgenParseResultNeedMore: {
+			return true;
+		}
+		case LoadgenParseResultDone: {
+			if(connection->state == LoadgenConnectionStateHandshake) {
+				connection->state = LoadgenConnectionStateIdle;
+				return true;
+			}
+
+			if(connection->state == LoadgenConnectionStateWaiting) {
+				loadgen_connection_complete_response(connection);
+			}
+
+			if(connection->close_after_response) {
+				loadgen_connection_close(connection, false);
+				return false;
+			}
+
+			return true;
+		}
+		case LoadgenParseResultClose: {
+			loadgen_connection_close(connection, false);
+			return false;
+		}
+		case LoadgenParseResultError:
+		default: {
+			loadgen_connection_close(connection, true);
+			return false;
+		}
+	}
+}
+
+// returns false, if the connection was closed
+NODISCARD static bool loadgen_connection_process_received(LoadgenConnection* const connection) {
+
+	while(true) {
+		const LoadgenParseResult result = loadgen_connection_process(connection);
+
+		if(!loadgen_connection_handle_parse_result(connection, result)) {
+			return false;
+		}
+
+		// http2 control frames, that follow a response, are processed at once, the other
+		// protocols send nothing on their own between responses
+		if(result != LoadgenParseResultDone ||
+		   connection->target->protocol != LoadgenProtocolH2c ||
+		   loadgen_buffer_get_available(&connection->read_buffer) == 0) {
+			return true;
+		}
+	}
+}
+
+static void loadgen_connection_handle_readable(LoadgenConnection* const connection) {
+
+	while(true) {
+		if(!loadgen_buffer_reserve(&connection->read_buffer, LOADGEN_READ_CHUNK_SIZE)) {
+			loadgen_connection_close(connection, true);
+			return;
+		}
+
+		LoadgenBuffer* const buffer = &connection->read_buffer;
+
+		const ssize_t received =
+		    recv(connection->fd, buffer->data + buffer->size, buffer->capacity - buffer->size, 0);
+
+		if(received < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				return;
+			}
+
+			loadgen_connection_close(connection, true);
+			return;
+		}
+
+		if(received == 0) {
+			// a body, that ends with the connection, is complete now
+			const bool until_close = connection->target->protocol == LoadgenProtocolHttp1 &&
+			                         connection->http1.part == LoadgenHttp1PartUntilClose;
+
+			if(until_close && connection->state == LoadgenConnectionStateWaiting) {
+				loadgen_connection_complete_response(connection);
+				loadgen_connection_close(connection, false);
+				return;
+			}
+
+			// a keep alive timeout is no error, as long as no request is in flight
+			loadgen_connection_close(connection,
+			                         connection->state != LoadgenConnectionStateIdle);
+			return;
+		}
+
+		buffer->size += (size_t)received;
+		connection->stats->received_bytes += (uint64_t)received;
+
+		if(!loadgen_connection_process_received(connection)) {
+			return;
+		}
+	}
+}
+
+void loadgen_connection_handle_events(LoadgenConnection* const connection,
+                                      const uint32_t events) {
+
+	if(connection->fd < 0) {
+		return;
+	}
+
+	if(connection->state == LoadgenConnectionStateConnecting) {
+		if((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0) {
+			return;
+		}
+
+		int error = 0;
+		socklen_t error_length = sizeof(error);
+
+		if(getsockopt(connection->fd, SOL_SOCKET, SO_ERROR, &error, &error_length) != 0 ||
+		   error != 0) {
+			loadgen_connection_close(connection, true);
+			return;
+		}
+
+		if(!loadgen_connection_on_connected(connection)) {
+			loadgen_connection_close(connection, true);
+			return;
+		}
+	}
+
+	if((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+		loadgen_connection_handle_readable(connection);
+
+		if(connection->fd < 0) {
+			return;
+		}
+	}
+
+	// acks and pongs, that were queued while processing, and the rest of a partial write
+	if(!loadgen_connection_flush(connection)) {
+		loadgen_connection_close(connection, true);
+	}
+}
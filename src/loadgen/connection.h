@@ -0,0 +1,69 @@
+#pragma once
+
+#include "./histogram.h"
+#include "utils/utils.h"
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	LoadgenProtocolHttp1 = 0,
+	// http2 over cleartext with prior knowledge
+	LoadgenProtocolH2c,
+	// every request is a binary message, that the server echoes back
+	LoadgenProtocolWs,
+} LoadgenProtocol;
+
+typedef struct {
+	LoadgenProtocol protocol;
+	// either a tcp or a unix socket address
+	struct sockaddr_storage address;
+	socklen_t address_length;
+	// used for the Host header and the :authority pseudo header
+	const char* authority;
+	const char* path;
+	// the payload size of the websocket messages
+	size_t message_size;
+} LoadgenTarget;
+
+// every worker thread has its own stats, they are merged after the run
+typedef struct {
+	// measured from the time, the request should have been sent at, see coordinated omission
+	LatencyHistogram* latencies;
+	// measured from the time, the request was actually sent at
+	LatencyHistogram* service_latencies;
+	uint64_t responses;
+	// responses with a status code >= 400
+	uint64_t error_responses;
+	// failed connects, broken connections and protocol errors
+	uint64_t errors;
+	uint64_t connects;
+	uint64_t received_bytes;
+} LoadgenStats;
+
+typedef struct LoadgenConnectionImpl LoadgenConnection;
+
+// the connection is registered in the epoll instance with itself as data pointer, returns NULL on
+// error
+NODISCARD LoadgenConnection* initialize_loadgen_connection(const LoadgenTarget* target,
+                                                           LoadgenStats* stats, int epoll_fd);
+
+void free_loadgen_connection(LoadgenConnection* connection);
+
+// a monotonic timestamp in microseconds, returns 0 on error
+NODISCARD uint64_t get_loadgen_timestamp_us(void);
+
+// connects, if the connection is closed and the retry delay after a failure has passed
+void loadgen_connection_maintain(LoadgenConnection* connection, uint64_t now_us);
+
+// true, if the connection is established and no request is in flight
+NODISCARD bool loadgen_connection_is_idle(const LoadgenConnection* connection);
+
+// the latency is measured from intended_send_us, the service latency from now on
+void loadgen_connection_send_request(LoadgenConnection* connection, uint64_t intended_send_us);
+
+// handles the events, epoll reported for this connection
+void loadgen_connection_handle_events(LoadgenConnection* connection, uint32_t events);
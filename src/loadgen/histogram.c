@@ -0,0 +1,210 @@
+
+#include "./histogram.h"
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+NODISCARD static size_t get_latency_histogram_bucket_index(const uint64_t value) {
+
+	if(value < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return (size_t)value;
+	}
+
+	// the highest set bit is at least LATENCY_HISTOGRAM_SUB_BUCKET_BITS, so the shift is at least 1
+	const size_t highest_bit =
+	    (sizeof(value) * CHAR_BIT) - 1 - (size_t)__builtin_clzll((unsigned long long)value);
+	const size_t shift = highest_bit - (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1);
+
+	if(shift > LATENCY_HISTOGRAM_MAX_SHIFT) {
+		return LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+	}
+
+	const size_t sub_bucket = (size_t)(value >> shift) - LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT;
+
+	return LATENCY_HISTOGRAM_SUB_BUCKET_COUNT +
+	       ((shift - 1) * LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT) + sub_bucket;
+}
+
+NODISCARD static size_t get_latency_histogram_bucket_shift(const size_t index) {
+
+	if(index < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return 0;
+	}
+
+	const size_t offset = index - LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+
+	return (offset / LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT) + 1;
+}
+
+NODISCARD static uint64_t get_latency_histogram_bucket_lowest_value(const size_t index) {
+
+	if(index < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return (uint64_t)index;
+	}
+
+	const size_t shift = get_latency_histogram_bucket_shift(index);
+
+	const uint64_t sub_bucket =
+	    ((index - LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) % LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT) +
+	    LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT;
+
+	return sub_bucket << shift;
+}
+
+NODISCARD static uint64_t get_latency_histogram_bucket_highest_value(const size_t index) {
+
+	const size_t shift = get_latency_histogram_bucket_shift(index);
+
+	return get_latency_histogram_bucket_lowest_value(index) + ((((uint64_t)1) << shift) - 1);
+}
+
+void latency_histogram_reset(LatencyHistogram* const histogram) {
+	memset(histogram->counts, 0, sizeof(histogram->counts));
+	histogram->total_count = 0;
+	histogram->min_value = UINT64_MAX;
+	histogram->max_value = 0;
+	histogram->value_sum = 0.0;
+}
+
+static void latency_histogram_record_with_count(LatencyHistogram* const histogram,
+                                                const uint64_t value_us, const uint64_t count) {
+
+	if(count == 0) {
+		return;
+	}
+
+	histogram->counts[get_latency_histogram_bucket_index(value_us)] += count;
+	histogram->total_count += count;
+	histogram->value_sum += ((double)value_us) * ((double)count);
+
+	if(value_us < histogram->min_value) {
+		histogram->min_value = value_us;
+	}
+
+	if(value_us > histogram->max_value) {
+		histogram->max_value = value_us;
+	}
+}
+
+void latency_histogram_record(LatencyHistogram* const histogram, const uint64_t value_us) {
+	latency_histogram_record_with_count(histogram, value_us, 1);
+}
+
+void latency_histogram_merge(LatencyHistogram* const destination,
+                             const LatencyHistogram* const source) {
+
+	if(source->total_count == 0) {
+		return;
+	}
+
+	for(size_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+		destination->counts[i] += source->counts[i];
+	}
+
+	destination->total_count += source->total_count;
+	destination->value_sum += source->value_sum;
+
+	if(source->min_value < destination->min_value) {
+		destination->min_value = source->min_value;
+	}
+
+	if(source->max_value > destination->max_value) {
+		destination->max_value = source->max_value;
+	}
+}
+
+void latency_histogram_copy_corrected(LatencyHistogram* const destination,
+                                      const LatencyHistogram* const source,
+                                      const uint64_t expected_interval_us) {
+
+	latency_histogram_reset(destination);
+
+	if(source->total_count == 0) {
+		return;
+	}
+
+	for(size_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+		const uint64_t count = source->counts[i];
+
+		if(count == 0) {
+			continue;
+		}
+
+		// the exact values are lost, the bucket boundaries are clamped to the recorded range
+		uint64_t value = get_latency_histogram_bucket_lowest_value(i);
+
+		if(value < source->min_value) {
+			value = source->min_value;
+		}
+
+		if(value > source->max_value) {
+			value = source->max_value;
+		}
+
+		latency_histogram_record_with_count(destination, value, count);
+
+		if(expected_interval_us == 0) {
+			continue;
+		}
+
+		for(uint64_t missing = value; missing > expected_interval_us;) {
+			missing -= expected_interval_us;
+			latency_histogram_record_with_count(destination, missing, count);
+		}
+	}
+}
+
+NODISCARD uint64_t latency_histogram_get_percentile(const LatencyHistogram* const histogram,
+                                                    const double percentile) {
+
+	if(histogram->total_count == 0) {
+		return 0;
+	}
+
+	double clamped_percentile = percentile;
+
+	if(clamped_percentile < 0.0) {
+		clamped_percentile = 0.0;
+	}
+
+	if(clamped_percentile > 100.0) { // NOLINT(readability-magic-numbers)
+		clamped_percentile = 100.0;  // NOLINT(readability-magic-numbers)
+	}
+
+	uint64_t target_count =
+	    (uint64_t)ceil((clamped_percentile / 100.0) * // NOLINT(readability-magic-numbers)
+	                   ((double)histogram->total_count));
+
+	if(target_count == 0) {
+		target_count = 1;
+	}
+
+	uint64_t cumulative_count = 0;
+
+	for(size_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+		cumulative_count += histogram->counts[i];
+
+		if(cumulative_count >= target_count) {
+			// the last bucket also holds all values, that are too big for the histogram
+			if(i == LATENCY_HISTOGRAM_BUCKET_COUNT - 1) {
+				return histogram->max_value;
+			}
+
+			const uint64_t value = get_latency_histogram_bucket_highest_value(i);
+
+			return value > histogram->max_value ? histogram->max_value : value;
+		}
+	}
+
+	return histogram->max_value;
+}
+
+NODISCARD double latency_histogram_get_mean(const LatencyHistogram* const histogram) {
+
+	if(histogram->total_count == 0) {
+		return 0.0;
+	}
+
+	return histogram->value_sum / ((double)histogram->total_count);
+}
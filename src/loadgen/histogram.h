@@ -0,0 +1,56 @@
+#pragma once
+
+#include "utils/utils.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a log linear histogram of latencies in microseconds, like a hdr histogram with 2 significant
+// digits: values below LATENCY_HISTOGRAM_SUB_BUCKET_COUNT are exact, every power of two above is
+// split into LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT buckets, so the relative error is below 1/64
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 7
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_COUNT (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT / 2)
+
+// values up to 2^41us (about 25 days) are distinguishable, bigger ones land in the last bucket
+#define LATENCY_HISTOGRAM_MAX_SHIFT 34
+
+#define LATENCY_HISTOGRAM_BUCKET_COUNT \
+	(LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + \
+	 (LATENCY_HISTOGRAM_MAX_SHIFT * LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT))
+
+typedef struct {
+	uint64_t counts[LATENCY_HISTOGRAM_BUCKET_COUNT];
+	uint64_t total_count;
+	uint64_t min_value;
+	uint64_t max_value;
+	double value_sum;
+} LatencyHistogram;
+
+void latency_histogram_reset(LatencyHistogram* histogram);
+
+void latency_histogram_record(LatencyHistogram* histogram, uint64_t value_us);
+
+void latency_histogram_merge(LatencyHistogram* destination, const LatencyHistogram* source);
+
+// the same as HdrHistogram's copyCorrectedForCoordinatedOmission: a closed loop client can't send
+// while it waits for a slow response, so for every recorded value above the expected interval, the
+// values of the requests, that would have been sent in the meantime, are added as well
+void latency_histogram_copy_corrected(LatencyHistogram* destination,
+                                      const LatencyHistogram* source,
+                                      uint64_t expected_interval_us);
+
+// percentile is in the range [0, 100], returns 0 for an empty histogram
+NODISCARD uint64_t latency_histogram_get_percentile(const LatencyHistogram* histogram,
+                                                    double percentile);
+
+NODISCARD double latency_histogram_get_mean(const LatencyHistogram* histogram);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,662 @@
+#include "./connection.h"
+#include "./histogram.h"
+#include "http/hpack.h"
+#include "utils/clock.h"
+#include "utils/log.h"
+#include "utils/number_parsing.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// a load generator for the http server, it keeps a fixed amount of connections open and measures
+// the latency of every request, if a rate is given, the requests are sent on a fixed schedule and
+// the latency is measured from the time, the request should have been sent at, so that a stalled
+// server can't hide its latency by delaying the requests (coordinated omission)
+
+#define IDENT1 "\t"
+#define IDENT2 IDENT1 IDENT1
+
+#define LOADGEN_DEFAULT_CONNECTIONS 16
+
+#define LOADGEN_DEFAULT_THREADS 2
+
+#define LOADGEN_DEFAULT_DURATION_S 10
+
+#define LOADGEN_DEFAULT_MESSAGE_SIZE 64
+
+#define LOADGEN_MAX_EPOLL_EVENTS 256
+
+// the event loop wakes up at least this often, to check the schedule and the end of the run
+#define LOADGEN_MAX_WAIT_MS 10
+
+#define LOADGEN_MAX_HOST_SIZE 256
+
+static void print_usage(const tstr_static program_name) {
+	printf("usage: " TSTR_FMT " <target> [options]\n", TSTR_STATIC_FMT_ARGS(program_name));
+	printf(IDENT1 "target: <host>:<port> or unix:<path> (required)\n");
+	printf(IDENT1 "options:\n");
+	printf(IDENT2 "-p, --protocol <http1|h2c|ws>: The protocol to use, default is http1\n");
+	printf(IDENT2 "-c, --connections <amount>: The amount of connections, default is %d\n",
+	       LOADGEN_DEFAULT_CONNECTIONS);
+	printf(IDENT2 "-t, --threads <amount>: The amount of threads, default is %d\n",
+	       LOADGEN_DEFAULT_THREADS);
+	printf(IDENT2 "-d, --duration <seconds>: The duration of the run, default is %d\n",
+	       LOADGEN_DEFAULT_DURATION_S);
+	printf(IDENT2 "-r, --rate <requests>: The requests per second over all connections, 0 sends "
+	              "the next request as soon as the response arrived, default is 0\n");
+	printf(IDENT2 "-u, --path <path>: The requested path, default is '/' and '/ws' for ws\n");
+	printf(IDENT2 "-m, --message-size <bytes>: The size of the websocket messages, default is %d\n",
+	       LOADGEN_DEFAULT_MESSAGE_SIZE);
+}
+
+NODISCARD static bool is_help_string(const tstr_static str) {
+	return tstr_static_eq(str, TSTR_STATIC_LIT("--help")) ||
+	       tstr_static_eq(str, TSTR_STATIC_LIT("-h")) || tstr_static_eq(str, TSTR_STATIC_LIT("-?"));
+}
+
+typedef struct {
+	size_t size;
+	const LibCChar* const* data;
+} ProgramArgs;
+
+#define PROGRAM_ARGS_AT(args, index) \
+	(assert((index) < (args).size), tstr_static_from_static_cstr((args).data[(index)]))
+
+typedef struct {
+	LoadgenTarget target;
+	size_t connection_amount;
+	size_t thread_amount;
+	uint64_t duration_s;
+	// 0 means, that every connection sends the next request as soon as the response arrived
+	uint64_t rate;
+} LoadgenOptions;
+
+typedef struct {
+	const LoadgenOptions* options;
+	// the index of the first connection of this thread, over all threads
+	size_t first_connection;
+	size_t connection_amount;
+	uint64_t start_us;
+	uint64_t end_us;
+	LoadgenStats stats;
+} LoadgenWorkerArgument;
+
+NODISCARD static const char* get_loadgen_protocol_name(const LoadgenProtocol protocol) {
+	switch(protocol) {
+		case LoadgenProtocolHttp1: {
+			return "http1";
+		}
+		case LoadgenProtocolH2c: {
+			return "h2c";
+		}
+		case LoadgenProtocolWs: {
+			return "ws";
+		}
+		default: {
+			return "<unknown>";
+		}
+	}
+}
+
+NODISCARD static bool parse_loadgen_protocol(const tstr_static value,
+                                             OUT_PARAM(LoadgenProtocol) protocol) {
+	if(tstr_static_eq(value, TSTR_STATIC_LIT("http1"))) {
+		*protocol = LoadgenProtocolHttp1;
+		return true;
+	}
+
+	if(tstr_static_eq(value, TSTR_STATIC_LIT("h2c"))) {
+		*protocol = LoadgenProtocolH2c;
+		return true;
+	}
+
+	if(tstr_static_eq(value, TSTR_STATIC_LIT("ws"))) {
+		*protocol = LoadgenProtocolWs;
+		return true;
+	}
+
+	return false;
+}
+
+// the authority is the target itself, for unix sockets it is localhost
+NODISCARD static bool resolve_loadgen_target(const char* const target_string,
+                                             OUT_PARAM(LoadgenTarget) target) {
+
+	const char* const unix_prefix = "unix:";
+
+	if(strncmp(target_string, unix_prefix, strlen(unix_prefix)) == 0) {
+		const char* const path = target_string + strlen(unix_prefix);
+
+		struct sockaddr_un* const address = (struct sockaddr_un*)&target->address;
+		*address = (struct sockaddr_un){ .sun_family = AF_UNIX, .sun_path = { 0 } };
+
+		if(strlen(path) == 0 || strlen(path) >= sizeof(address->sun_path)) {
+			fprintf(stderr, "Invalid unix socket path '%s'\n", path);
+			return false;
+		}
+
+		memcpy(address->sun_path, path, strlen(path));
+		target->address_length = sizeof(struct sockaddr_un);
+		target->authority = "localhost";
+		return true;
+	}
+
+	const char* const port_separator = strrchr(target_string, ':');
+
+	if(port_separator == NULL || port_separator == target_string) {
+		fprintf(stderr, "The target '%s' has no port\n", target_string);
+		return false;
+	}
+
+	const char* host_start = target_string;
+	size_t host_length = (size_t)(port_separator - target_string);
+
+	// ipv6 addresses are written as [::1]:port
+	if(host_length >= 2 && host_start[0] == '[' && host_start[host_length - 1] == ']') {
+		host_start++;
+		host_length -= 2;
+	}
+
+	char host[LOADGEN_MAX_HOST_SIZE] = { 0 };
+
+	if(host_length == 0 || host_length >= sizeof(host)) {
+		fprintf(stderr, "Invalid host in the target '%s'\n", target_string);
+		return false;
+	}
+
+	memcpy(host, host_start, host_length);
+
+	const struct addrinfo hints = {
+		.ai_family = AF_UNSPEC,
+		.ai_socktype = SOCK_STREAM,
+	};
+
+	struct addrinfo* addresses = NULL;
+
+	const int result = getaddrinfo(host, port_separator + 1, &hints, &addresses);
+
+	if(result != 0 || addresses == NULL) {
+		fprintf(stderr, "Couldn't resolve the target '%s': %s\n", target_string,
+		        gai_strerror(result));
+		return false;
+	}
+
+	memcpy(&target->address, addresses->ai_addr, addresses->ai_addrlen);
+	target->address_length = addresses->ai_addrlen;
+	target->authority = target_string;
+
+	freeaddrinfo(addresses);
+
+	return true;
+}
+
+NODISCARD static bool parse_loadgen_number_option(const ProgramArgs args,
+                                                  const size_t processed_args,
+                                                  const char* const name,
+                                                  OUT_PARAM(uint64_t) result) {
+
+	if(processed_args + 2 > args.size) {
+		fprintf(stderr, "Not enough arguments for the '%s' option\n", name);
+		return false;
+	}
+
+	const tstr_static value = PROGRAM_ARGS_AT(args, processed_args + 1);
+
+	bool success = false;
+	*result = parse_u64(tstr_static_as_view(value), &success);
+
+	if(!success) {
+		fprintf(stderr,
+		        "Couldn't parse the incorrect integer " TSTR_FMT " for the '%s' option\n",
+		        TSTR_STATIC_FMT_ARGS(value), name);
+		return false;
+	}
+
+	return true;
+}
+
+NODISCARD static bool parse_loadgen_options(const ProgramArgs args,
+                                            OUT_PARAM(LoadgenOptions) options) {
+
+	*options = (LoadgenOptions){
+		.target = { .protocol = LoadgenProtocolHttp1,
+		            .address_length = 0,
+		            .authority = NULL,
+		            .path = NULL,
+		            .message_size = LOADGEN_DEFAULT_MESSAGE_SIZE },
+		.connection_amount = LOADGEN_DEFAULT_CONNECTIONS,
+		.thread_amount = LOADGEN_DEFAULT_THREADS,
+		.duration_s = LOADGEN_DEFAULT_DURATION_S,
+		.rate = 0,
+	};
+
+	// the target
+	size_t processed_args = 1;
+
+	while(processed_args != args.size) {
+
+		const tstr_static arg = PROGRAM_ARGS_AT(args, processed_args);
+		uint64_t number = 0;
+
+		if(tstr_static_eq(arg, TSTR_STATIC_LIT("-p")) ||
+		   tstr_static_eq(arg, TSTR_STATIC_LIT("--protocol"))) {
+			if(processed_args + 2 > args.size) {
+				fprintf(stderr, "Not enough arguments for the 'protocol' option\n");
+				return false;
+			}
+
+			const tstr_static protocol_arg = PROGRAM_ARGS_AT(args, processed_args + 1);
+
+			if(!parse_loadgen_protocol(protocol_arg, &options->target.protocol)) {
+				fprintf(stderr,
+				        "Wrong option for the 'protocol' option, unrecognized protocol: " TSTR_FMT
+				        "\n",
+				        TSTR_STATIC_FMT_ARGS(protocol_arg));
+				return false;
+			}
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("-c")) ||
+		          tstr_static_eq(arg, TSTR_STATIC_LIT("--connections"))) {
+			if(!parse_loadgen_number_option(args, processed_args, "connections", &number)) {
+				return false;
+			}
+
+			options->connection_amount = (size_t)number;
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("-t")) ||
+		          tstr_static_eq(arg, TSTR_STATIC_LIT("--threads"))) {
+			if(!parse_loadgen_number_option(args, processed_args, "threads", &number)) {
+				return false;
+			}
+
+			options->thread_amount = (size_t)number;
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("-d")) ||
+		          tstr_static_eq(arg, TSTR_STATIC_LIT("--duration"))) {
+			if(!parse_loadgen_number_option(args, processed_args, "duration", &number)) {
+				return false;
+			}
+
+			options->duration_s = number;
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("-r")) ||
+		          tstr_static_eq(arg, TSTR_STATIC_LIT("--rate"))) {
+			if(!parse_loadgen_number_option(args, processed_args, "rate", &number)) {
+				return false;
+			}
+
+			options->rate = number;
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("-u")) ||
+		          tstr_static_eq(arg, TSTR_STATIC_LIT("--path"))) {
+			if(processed_args + 2 > args.size) {
+				fprintf(stderr, "Not enough arguments for the 'path' option\n");
+				return false;
+			}
+
+			options->target.path = args.data[processed_args + 1];
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("-m")) ||
+		          tstr_static_eq(arg, TSTR_STATIC_LIT("--message-size"))) {
+			if(!parse_loadgen_number_option(args, processed_args, "message-size", &number)) {
+				return false;
+			}
+
+			options->target.message_size = (size_t)number;
+		} else {
+			fprintf(stderr, "Unrecognized option: " TSTR_FMT "\n", TSTR_STATIC_FMT_ARGS(arg));
+			return false;
+		}
+
+		processed_args += 2;
+	}
+
+	if(options->connection_amount == 0 || options->thread_amount == 0 ||
+	   options->duration_s == 0) {
+		fprintf(stderr, "The connections, threads and duration have to be greater than 0\n");
+		return false;
+	}
+
+	if(options->target.path == NULL) {
+		options->target.path = options->target.protocol == LoadgenProtocolWs ? "/ws" : "/";
+	}
+
+	// every thread needs at least one connection
+	if(options->thread_amount > options->connection_amount) {
+		options->thread_amount = options->connection_amount;
+	}
+
+	return resolve_loadgen_target(args.data[0], &options->target);
+}
+
+static ANY_TYPE(void*) loadgen_worker_thread_function(ANY_TYPE(LoadgenWorkerArgument*) arg) {
+
+	LoadgenWorkerArgument* const argument = (LoadgenWorkerArgument*)arg;
+	const LoadgenOptions* const options = argument->options;
+
+	const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+	if(epoll_fd < 0) {
+		fprintf(stderr, "Couldn't create an epoll instance: %s\n", strerror(errno));
+		argument->stats.errors++;
+		return NULL;
+	}
+
+	LoadgenConnection** const connections =
+	    calloc(argument->connection_amount, sizeof(LoadgenConnection*));
+	uint64_t* const next_send_us = calloc(argument->connection_amount, sizeof(uint64_t));
+
+	// every connection sends its share of the rate, 0 for a closed loop
+	uint64_t interval_us = 0;
+
+	if(options->rate != 0) {
+		interval_us = (options->connection_amount * S_TO_US_RATE) / options->rate;
+
+		if(interval_us == 0) {
+			interval_us = 1;
+		}
+	}
+
+	for(size_t i = 0; connections != NULL && next_send_us != NULL &&
+	                  i < argument->connection_amount;
+	    ++i) {
+		connections[i] =
+		    initialize_loadgen_connection(&options->target, &argument->stats, epoll_fd);
+
+		if(connections[i] == NULL) {
+			argument->stats.errors++;
+		}
+
+		// the connections are staggered over one interval, so that they don't send in bursts
+		next_send_us[i] = argument->start_us + ((interval_us * (argument->first_connection + i)) /
+		                                        options->connection_amount);
+	}
+
+	struct epoll_event events[LOADGEN_MAX_EPOLL_EVENTS];
+
+	while(connections != NULL && next_send_us != NULL) {
+		const uint64_t now_us = get_loadgen_timestamp_us();
+
+		if(now_us >= argument->end_us) {
+			break;
+		}
+
+		uint64_t next_wakeup_us = now_us + (LOADGEN_MAX_WAIT_MS * (S_TO_US_RATE / S_TO_MS_RATE));
+
+		if(next_wakeup_us > argument->end_us) {
+			next_wakeup_us = argument->end_us;
+		}
+
+		for(size_t i = 0; i < argument->connection_amount; ++i) {
+			LoadgenConnection* const connection = connections[i];
+
+			if(connection == NULL) {
+				continue;
+			}
+
+			loadgen_connection_maintain(connection, now_us);
+
+			if(!loadgen_connection_is_idle(connection)) {
+				continue;
+			}
+
+			if(interval_us == 0) {
+				loadgen_connection_send_request(connection, now_us);
+				continue;
+			}
+
+			// a connection, that is behind the schedule, catches up, the latency of the delayed
+			// requests is still measured from their scheduled time
+			if(next_send_us[i] <= now_us) {
+				loadgen_connection_send_request(connection, next_send_us[i]);
+				next_send_us[i] += interval_us;
+			} else if(next_send_us[i] < next_wakeup_us) {
+				next_wakeup_us = next_send_us[i];
+			}
+		}
+
+		// rounded down, so that no request is sent late, this spins in the last millisecond
+		const int timeout_ms = (int)((next_wakeup_us - now_us) / (S_TO_US_RATE / S_TO_MS_RATE));
+
+		const int event_amount = epoll_wait(epoll_fd, events, LOADGEN_MAX_EPOLL_EVENTS, timeout_ms);
+
+		if(event_amount < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+
+			fprintf(stderr, "epoll_wait failed: %s\n", strerror(errno));
+			argument->stats.errors++;
+			break;
+		}
+
+		for(int i = 0; i < event_amount; ++i) {
+			loadgen_connection_handle_events((LoadgenConnection*)events[i].data.ptr,
+			                                 events[i].events);
+		}
+	}
+
+	if(connections == NULL || next_send_us == NULL) {
+		fprintf(stderr, "Couldn't allocate the connections\n");
+		argument->stats.errors++;
+	} else {
+		for(size_t i = 0; i < argument->connection_amount; ++i) {
+			free_loadgen_connection(connections[i]);
+		}
+	}
+
+	free(connections);
+	free(next_send_us);
+	close(epoll_fd);
+
+	return NULL;
+}
+
+static void print_loadgen_latencies(const char* const title, const LatencyHistogram* histogram) {
+
+	/* NOLINTBEGIN(readability-magic-numbers) */
+	const double percentiles[] = { 50.0, 75.0, 90.0, 99.0, 99.9, 99.99 };
+	/* NOLINTEND(readability-magic-numbers) */
+
+	printf("  %s:\n", title);
+	printf("    mean   %10.3fms\n", latency_histogram_get_mean(histogram) / S_TO_MS_RATE);
+
+	for(size_t i = 0; i < sizeof(percentiles) / sizeof(*percentiles); ++i) {
+		const uint64_t value = latency_histogram_get_percentile(histogram, percentiles[i]);
+
+		printf("    p%-6g%10.3fms\n", percentiles[i], ((double)value) / S_TO_MS_RATE);
+	}
+
+	printf("    max    %10.3fms\n", ((double)histogram->max_value) / S_TO_MS_RATE);
+}
+
+static void print_loadgen_report(const LoadgenOptions* const options,
+                                 const LoadgenStats* const stats, const double elapsed_s) {
+
+	printf("%s load against %s%s for %.2fs, %zu connections on %zu threads\n",
+	       get_loadgen_protocol_name(options->target.protocol), options->target.authority,
+	       options->target.path, elapsed_s, options->connection_amount, options->thread_amount);
+
+	if(options->rate == 0) {
+		printf("  closed loop, every connection sends the next request after the response\n");
+	} else {
+		printf("  open loop with %" PRIu64 " requests/s\n", options->rate);
+	}
+
+	printf("  %" PRIu64 " responses, %" PRIu64 " with status >= 400, %" PRIu64 " errors, %" PRIu64
+	       " connects\n",
+	       stats->responses, stats->error_responses, stats->errors, stats->connects);
+
+	const double received_mib =
+	    ((double)stats->received_bytes) / (1024.0 * 1024.0); // NOLINT(readability-magic-numbers)
+
+	printf("  %.2f responses/s, %.2f MiB/s received\n", ((double)stats->responses) / elapsed_s,
+	       received_mib / elapsed_s);
+
+	LatencyHistogram* const corrected = malloc(sizeof(LatencyHistogram));
+
+	if(corrected == NULL) {
+		return;
+	}
+
+	if(options->rate == 0) {
+		// a closed loop has no schedule, the median is used as the interval, the connections
+		// would have sent their requests at, like HdrHistogram does with an expected interval
+		const uint64_t expected_interval_us = latency_histogram_get_percentile(
+		    stats->service_latencies, 50.0); // NOLINT(readability-magic-numbers)
+
+		latency_histogram_copy_corrected(corrected, stats->service_latencies,
+		                                 expected_interval_us);
+	} else {
+		*corrected = *stats->latencies;
+	}
+
+	print_loadgen_latencies("latency (corrected for coordinated omission)", corrected);
+	print_loadgen_latencies("service time (uncorrected)", stats->service_latencies);
+
+	free(corrected);
+}
+
+static ExitCode rich_main(const ProgramArgs args) {
+	if(args.size < 1) {
+		fprintf(stderr, "No program name specified: FATAL ERROR\n");
+		return ExitCodeFailure;
+	}
+
+	const tstr_static program_name = PROGRAM_ARGS_AT(args, 0);
+
+	if(args.size < 2) {
+		fprintf(stderr, "missing <target>\n");
+		print_usage(program_name);
+		return ExitCodeFailure;
+	}
+
+	if(is_help_string(PROGRAM_ARGS_AT(args, 1))) {
+		print_usage(program_name);
+		return ExitCodeSuccess;
+	}
+
+	LoadgenOptions options;
+
+	if(!parse_loadgen_options((ProgramArgs){ .size = args.size - 1, .data = args.data + 1 },
+	                          &options)) {
+		print_usage(program_name);
+		return ExitCodeFailure;
+	}
+
+	initialize_logger();
+	set_log_level(LogLevelError);
+	set_thread_name("main thread");
+
+	global_initialize_http2_hpack_data();
+
+	LoadgenWorkerArgument* const workers =
+	    calloc(options.thread_amount, sizeof(LoadgenWorkerArgument));
+	pthread_t* const threads = calloc(options.thread_amount, sizeof(pthread_t));
+	LatencyHistogram* const histograms =
+	    malloc(sizeof(LatencyHistogram) * 2 * (options.thread_amount + 1));
+
+	if(workers == NULL || threads == NULL || histograms == NULL) {
+		fprintf(stderr, "Couldn't allocate the workers\n");
+		free(workers);
+		free(threads);
+		free(histograms);
+		global_free_http2_hpack_data();
+		return ExitCodeFailure;
+	}
+
+	for(size_t i = 0; i < 2 * (options.thread_amount + 1); ++i) {
+		latency_histogram_reset(&histograms[i]);
+	}
+
+	const uint64_t start_us = get_loadgen_timestamp_us();
+	const uint64_t end_us = start_us + S_TO_US(options.duration_s);
+
+	size_t first_connection = 0;
+	size_t started_threads = 0;
+
+	for(size_t i = 0; i < options.thread_amount; ++i) {
+		// the remainder is spread over the first threads
+		const size_t connection_amount =
+		    (options.connection_amount / options.thread_amount) +
+		    (i < options.connection_amount % options.thread_amount ? 1 : 0);
+
+		workers[i] = (LoadgenWorkerArgument){
+			.options = &options,
+			.first_connection = first_connection,
+			.connection_amount = connection_amount,
+			.start_us = start_us,
+			.end_us = end_us,
+			.stats = { .latencies = &histograms[2 * i],
+			           .service_latencies = &histograms[(2 * i) + 1],
+			           .responses = 0,
+			           .error_responses = 0,
+			           .errors = 0,
+			           .connects = 0,
+			           .received_bytes = 0 },
+		};
+
+		first_connection += connection_amount;
+
+		const int result =
+		    pthread_create(&threads[i], NULL, loadgen_worker_thread_function, &workers[i]);
+
+		// the break has to be outside of CHECK_FOR_THREAD_ERROR, as that is a loop itself
+		if(result != 0) {
+			fprintf(stderr, "Couldn't create a worker thread: %s\n", strerror(result));
+			break;
+		}
+
+		started_threads++;
+	}
+
+	for(size_t i = 0; i < started_threads; ++i) {
+		const int result = pthread_join(threads[i], NULL);
+		CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to wait for a Thread", {});
+	}
+
+	const uint64_t finished_us = get_loadgen_timestamp_us();
+
+	LoadgenStats total = {
+		.latencies = &histograms[2 * options.thread_amount],
+		.service_latencies = &histograms[(2 * options.thread_amount) + 1],
+		.responses = 0,
+		.error_responses = 0,
+		.errors = 0,
+		.connects = 0,
+		.received_bytes = 0,
+	};
+
+	for(size_t i = 0; i < started_threads; ++i) {
+		const LoadgenStats stats = workers[i].stats;
+
+		latency_histogram_merge(total.latencies, stats.latencies);
+		latency_histogram_merge(total.service_latencies, stats.service_latencies);
+		total.responses += stats.responses;
+		total.error_responses += stats.error_responses;
+		total.errors += stats.errors;
+		total.connects += stats.connects;
+		total.received_bytes += stats.received_bytes;
+	}
+
+	print_loadgen_report(&options, &total,
+	                     ((double)(finished_us - start_us)) / ((double)S_TO_US_RATE));
+
+	const bool all_started = started_threads == options.thread_amount;
+
+	free(workers);
+	free(threads);
+	free(histograms);
+
+	global_free_http2_hpack_data();
+
+	shutdown_logger();
+
+	return all_started ? ExitCodeSuccess : ExitCodeFailure;
+}
+
+int main(const LibCInt argc, const LibCChar* const* const argv) {
+	const ProgramArgs args = { .size = argc, .data = argv };
+	return rich_main(args);
+}
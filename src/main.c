@@ -6,6 +6,7 @@
 #include "utils/number_parsing.h"
 #include "utils/path.h"
 
+#include <arpa/inet.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -27,6 +28,12 @@ static void print_http_server_usage(const bool is_subcommand) {
 	              "(https), you have to provide the public and private certificates\n");
 	printf(IDENT2 "-r, --route <route_name>: Use a certain route mapping\n");
 	printf(IDENT2 "-l, --loglevel <loglevel>: Set the log level for the application\n");
+	printf(IDENT2 "--client-limit <requests_per_second>: Limit the requests and connections of "
+	              "every client address, 0 only limits the connections, loopback clients are "
+	              "never limited\n");
+	printf(IDENT2 "--trusted-proxy <address>: Don't limit this address, e.g. a reverse proxy or "
+	              "load balancer, can be given up to %d times\n",
+	       CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES);
 }
 
 static void print_ftp_server_usage(const bool is_subcommand) {
@@ -230,6 +237,10 @@ NODISCARD static ExitCode subcommand_http(const tstr_static program_name, const
 
 	RouteIdentifier route_identifier = RouteIdentifierDefault;
 
+	// the client limiter is opt-in, all clients behind a proxy share one address
+	bool client_limit = false;
+	ClientLimiterOptions client_limiter_options = get_default_client_limiter_options();
+
 	LogLevel log_level =
 #ifdef NDEBUG
 	    LogLevelError
@@ -311,6 +322,72 @@ NODISCARD static ExitCode subcommand_http(const tstr_static program_name, const
 				return ExitCodeFailure;
 			}
 
+			processed_args += 2;
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("--client-limit"))) {
+			if(processed_args + 2 > args.size) {
+				fprintf(stderr, "Not enough arguments for the 'client-limit' option\n");
+				print_usage(program_name, UsageCommandHttp);
+				return ExitCodeFailure;
+			}
+
+			const tstr_static rate_arg = PROGRAM_ARGS_AT(args, processed_args + 1);
+
+			success = false;
+			const uint64_t rate = parse_u64(tstr_static_as_view(rate_arg), &success);
+
+			// the burst is twice the rate, so it has to fit too
+			if(!success || rate > UINT32_MAX / 2) {
+				fprintf(stderr,
+				        "Wrong option for the 'client-limit' option, invalid rate: " TSTR_FMT
+				        "\n",
+				        TSTR_STATIC_FMT_ARGS(rate_arg));
+				print_usage(program_name, UsageCommandHttp);
+				return ExitCodeFailure;
+			}
+
+			client_limit = true;
+			client_limiter_options.requests_per_second = (uint32_t)rate;
+			client_limiter_options.request_burst = (uint32_t)(rate * 2);
+
+			processed_args += 2;
+		} else if(tstr_static_eq(arg, TSTR_STATIC_LIT("--trusted-proxy"))) {
+			if(processed_args + 2 > args.size) {
+				fprintf(stderr, "Not enough arguments for the 'trusted-proxy' option\n");
+				print_usage(program_name, UsageCommandHttp);
+				return ExitCodeFailure;
+			}
+
+			if(client_limiter_options.trusted_address_amount >=
+			   CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES) {
+				fprintf(stderr, "Too many 'trusted-proxy' options, the maximum is %d\n",
+				        CLIENT_LIMITER_MAX_TRUSTED_ADDRESSES);
+				print_usage(program_name, UsageCommandHttp);
+				return ExitCodeFailure;
+			}
+
+			const char* const address_arg = args.data[processed_args + 1];
+
+			struct in_addr v4_address = {};
+			struct in6_addr v6_address = {};
+
+			IPAddress* const trusted_address =
+			    &(client_limiter_options
+			          .trusted_addresses[client_limiter_options.trusted_address_amount]);
+
+			if(inet_pton(AF_INET, address_arg, &v4_address) == 1) {
+				*trusted_address = from_ipv4(v4_address);
+			} else if(inet_pton(AF_INET6, address_arg, &v6_address) == 1) {
+				*trusted_address = from_ipv6(v6_address);
+			} else {
+				fprintf(stderr,
+				        "Wrong option for the 'trusted-proxy' option, invalid address: %s\n",
+				        address_arg);
+				print_usage(program_name, UsageCommandHttp);
+				return ExitCodeFailure;
+			}
+
+			++(client_limiter_options.trusted_address_amount);
+
 			processed_args += 2;
 		} else {
 			fprintf(stderr, "Unrecognized option: " TSTR_FMT "\n", TSTR_STATIC_FMT_ARGS(arg));
@@ -370,7 +447,8 @@ NODISCARD static ExitCode subcommand_http(const tstr_static program_name, const
 		return ExitCodeFailure;
 	}
 
-	return start_http_server(port, MOVE(options), MOVE(auth_providers), MOVE(routes));
+	return start_http_server(port, MOVE(options), MOVE(auth_providers), MOVE(routes),
+	                         client_limit ? &client_limiter_options : NULL);
 }
 
 NODISCARD static ExitCode subcommand_ftp(const tstr_static program_name, const ProgramArgs args) {
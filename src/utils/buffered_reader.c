@@ -3,6 +3,9 @@
 #include "./buffered_reader.h"
 #include "utils/log.h"
 
+#include <errno.h>
+#include <poll.h>
+
 typedef struct {
 	size_t cursor;
 	SizedBuffer buffer;
@@ -151,7 +154,8 @@ static void buffered_reader_get_data_until(BufferedReader* const reader, size_t
 }
 
 NODISCARD static BufferedReadResult
-buffered_reader_get_until_delimiter_impl(BufferedReader* const reader, const tstr_view delimiter) {
+buffered_reader_get_until_delimiter_impl(BufferedReader* const reader, const tstr_view delimiter,
+                                         const size_t max_length) {
 
 	if(!buffered_reader_is_safe_to_read(reader)) {
 		return (BufferedReadResult){
@@ -167,6 +171,16 @@ buffered_reader_get_until_delimiter_impl(BufferedReader* const reader, const tst
 	const size_t start_cursor = reader->data.cursor;
 
 	while(true) {
+		const size_t consumed = reader->data.cursor - start_cursor;
+
+		// all bytes up to here didn't end with the delimiter, so the data is already too long
+		if(consumed >= delimiter.len && consumed - delimiter.len >= max_length) {
+			return (BufferedReadResult){
+				.type = BufferedReadResultTypeErr,
+				.value = { .error = "Data exceeds the maximum length in read until delimiter" }
+			};
+		}
+
 		if(reader->data.cursor >= reader->data.buffer.size) {
 			buffered_reader_get_more_data_at_least_some(reader, BUFFERED_READER_CHUNK_SIZE);
 
@@ -211,13 +225,19 @@ buffered_reader_get_until_delimiter_impl(BufferedReader* const reader, const tst
 NODISCARD BufferedReadResult buffered_reader_get_until_delimiter(BufferedReader* const reader,
                                                                  const char* const delimiter) {
 	const tstr_view fixed = { .data = delimiter, .len = strlen(delimiter) };
-	return buffered_reader_get_until_delimiter_impl(reader, fixed);
+	return buffered_reader_get_until_delimiter_impl(reader, fixed, SIZE_MAX);
+}
+
+NODISCARD BufferedReadResult buffered_reader_get_until_delimiter_bounded(
+    BufferedReader* const reader, const char* const delimiter, const size_t max_length) {
+	const tstr_view fixed = { .data = delimiter, .len = strlen(delimiter) };
+	return buffered_reader_get_until_delimiter_impl(reader, fixed, max_length);
 }
 
 NODISCARD BufferedReadResult buffered_reader_get_until_delimiter_fixed(
     BufferedReader* const reader, const SizedBuffer delimiter) {
 	const tstr_view delimiter_view = { .data = (const char*)delimiter.data, .len = delimiter.size };
-	return buffered_reader_get_until_delimiter_impl(reader, delimiter_view);
+	return buffered_reader_get_until_delimiter_impl(reader, delimiter_view, SIZE_MAX);
 }
 
 NODISCARD BufferedReadResult buffered_reader_get_until_end(BufferedReader* const reader) {
@@ -382,6 +402,65 @@ NODISCARD bool buffered_reader_has_more_data(const BufferedReader* const reader)
 	return true;
 }
 
+NODISCARD BufferedWaitResult buffered_reader_wait_for_data(BufferedReader* const reader,
+                                                           const uint32_t timeout_ms) {
+
+	if(!buffered_reader_is_safe_to_read(reader)) {
+		return reader->state == StreamStateClosed ? BufferedWaitResultClosed
+		                                          : BufferedWaitResultError;
+	}
+
+	if(get_available_data_length(reader) > 0) {
+		return BufferedWaitResultDataAvailable;
+	}
+
+	if(!descriptor_has_pending_data(reader->descriptor)) {
+
+		struct pollfd poll_fd = {
+			.fd = get_underlying_socket(reader->descriptor),
+			.events = POLLIN,
+			.revents = 0,
+		};
+
+		if(poll_fd.fd < 0) {
+			reader->state = StreamStateError;
+			return BufferedWaitResultError;
+		}
+
+		const LibCInt poll_result = poll(&poll_fd, 1, (LibCInt)timeout_ms);
+
+		if(poll_result == 0) {
+			return BufferedWaitResultTimeout;
+		}
+
+		if(poll_result < 0) {
+			if(errno == EINTR) {
+				return BufferedWaitResultTimeout;
+			}
+
+			LOG_MESSAGE(LogLevelError, "poll failed: %s\n", strerror(errno));
+			reader->state = StreamStateError;
+			return BufferedWaitResultError;
+		}
+	}
+
+	// POLLIN or POLLHUP: read, to see if this is data or the end of the stream
+	buffered_reader_get_more_data_at_least_some(reader, BUFFERED_READER_CHUNK_SIZE);
+
+	switch(reader->state) {
+		case StreamStateOpen: {
+			return BufferedWaitResultDataAvailable;
+		}
+		case StreamStateClosed: {
+			return BufferedWaitResultClosed;
+		}
+		case StreamStateError:
+		default: {
+			return BufferedWaitResultError;
+		}
+	}
+}
+
 void free_buffered_reader(BufferedReader* const reader) {
 	free_sized_buffer(reader->data.buffer);
 	free(reader);
@@ -38,6 +38,19 @@ typedef struct {
 NODISCARD BufferedReadResult buffered_reader_get_until_delimiter(BufferedReader* reader,
                                                                  const char* delimiter);
 
+/**
+ * @brief Like buffered_reader_get_until_delimiter, but fails, if the data before the delimiter is
+ * longer than max_length, so that a peer can't make the reader buffer an unbounded line
+ *
+ * @param reader
+ * @param delimiter
+ * @param max_length
+ * @return BufferedReadResult
+ */
+NODISCARD BufferedReadResult buffered_reader_get_until_delimiter_bounded(BufferedReader* reader,
+                                                                         const char* delimiter,
+                                                                         size_t max_length);
+
 /**
  * @brief Get the until delimiter fixed object
  *
@@ -62,6 +75,28 @@ void buffered_reader_invalidate_old_data(BufferedReader* reader);
 
 NODISCARD bool buffered_reader_has_more_data(const BufferedReader* reader);
 
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	BufferedWaitResultDataAvailable = 0,
+	BufferedWaitResultTimeout,
+	BufferedWaitResultClosed,
+	BufferedWaitResultError,
+} BufferedWaitResult;
+
+/**
+ * @brief Waits at most timeout_ms milliseconds until unread data is available, if the connection
+ * has data, some of it is read into the buffer, so that a following read doesn't block on an
+ * already closed connection
+ *
+ * @param reader
+ * @param timeout_ms
+ * @return BufferedWaitResult
+ */
+NODISCARD BufferedWaitResult buffered_reader_wait_for_data(BufferedReader* reader,
+                                                           uint32_t timeout_ms);
+
 void free_buffered_reader(BufferedReader* reader);
 
 NODISCARD bool finish_buffered_reader(BufferedReader* reader, ConnectionContext* context,
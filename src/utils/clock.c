@@ -5,6 +5,8 @@
 
 #include <errno.h>
 #include <locale.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <string.h>
 
 #ifdef __APPLE__
@@ -205,6 +207,7 @@ void global_free_locale_for_http(void) {
 
 	if(g_clock_data.http_locale != (locale_t)0) {
 		freelocale(g_clock_data.http_locale);
+		g_clock_data.http_locale = (locale_t)0;
 	}
 }
 
@@ -228,78 +231,353 @@ static locale_t get_http_locale(void) {
 // see: https://en.wikipedia.org/wiki/Common_Log_Format
 #define COMMON_LOG_TIME_FORMAT "%d/%b/%Y:%H:%M:%S %z"
 
-NODISCARD char* get_date_string(Time time, TimeFormat format) {
+typedef struct {
+	const char* format_str;
+	locale_t locale_to_use;
+	bool use_utc;
+	size_t max_bytes;
+} DateFormatDescription;
 
-	const char* format_str = NULL;
-	locale_t locale_to_use = (locale_t)0;
-	bool use_utc = true;
-	size_t max_bytes = 0;
+NODISCARD static bool get_date_format_description(TimeFormat format,
+                                                  OUT_PARAM(DateFormatDescription) description) {
 
 	switch(format) {
 		case TimeFormatFTP: {
-
-			format_str = FTP_TIME_FORMAT;
-			locale_to_use = (locale_t)0;
-			use_utc = false;
-			// just a guess, should suffice
-			max_bytes = 0xFF; // NOLINT(readability-magic-numbers)
-			break;
+			*description = (DateFormatDescription){
+				.format_str = FTP_TIME_FORMAT,
+				.locale_to_use = (locale_t)0,
+				.use_utc = false,
+				// just a guess, should suffice
+				.max_bytes = 0xFF, // NOLINT(readability-magic-numbers)
+			};
+			return true;
 		}
 		case TimeFormatHTTP1Dot1: {
-			format_str = HTTP1_1_RFC_7231_TIME_FORMAT;
-			locale_to_use = get_http_locale();
-			use_utc = true;
-			// just a guess, should suffice
-			max_bytes = 64UL; // NOLINT(readability-magic-numbers)
-			break;
+			*description = (DateFormatDescription){
+				.format_str = HTTP1_1_RFC_7231_TIME_FORMAT,
+				.locale_to_use = get_http_locale(),
+				.use_utc = true,
+				// just a guess, should suffice
+				.max_bytes = 64UL, // NOLINT(readability-magic-numbers)
+			};
+			return true;
 		}
 		case TimeFormatCommonLog: {
-			format_str = COMMON_LOG_TIME_FORMAT;
-			locale_to_use = (locale_t)0;
-			use_utc = false;
-			// just a guess, should suffice
-			max_bytes = 64UL; // NOLINT(readability-magic-numbers)
-			break;
+			*description = (DateFormatDescription){
+				.format_str = COMMON_LOG_TIME_FORMAT,
+				.locale_to_use = (locale_t)0,
+				.use_utc = false,
+				// just a guess, should suffice
+				.max_bytes = 64UL, // NOLINT(readability-magic-numbers)
+			};
+			return true;
 		}
 		default: {
-			return NULL;
+			return false;
 		}
 	}
+}
 
-	char* date_str = (char*)malloc(max_bytes * sizeof(char));
-
-	if(!date_str) {
-		return NULL;
-	}
+NODISCARD static size_t format_date_string_with_description(Time time,
+                                                            DateFormatDescription description,
+                                                            char* buffer, size_t buffer_size) {
 
 	struct tm converted_time = ZERO_STRUCT(struct tm);
 	const struct tm* convert_result = NULL;
 
-	if(use_utc) {
+	if(description.use_utc) {
 		convert_result = gmtime_r(&time._impl_value.tv_sec, &converted_time);
 	} else {
 		convert_result = localtime_r(&time._impl_value.tv_sec, &converted_time);
 	}
 
 	if(!convert_result) {
-		free(date_str);
-		return NULL;
+		return 0;
 	}
 
 	size_t result = 0;
 
-	if(locale_to_use == (locale_t)0) {
-		result = strftime(date_str, max_bytes, format_str, &converted_time);
+	if(description.locale_to_use == (locale_t)0) {
+		result = strftime(buffer, buffer_size, description.format_str, &converted_time);
 	} else {
-		result = strftime_l(date_str, max_bytes, format_str, &converted_time, locale_to_use);
+		result = strftime_l(buffer, buffer_size, description.format_str, &converted_time,
+		                    description.locale_to_use);
 	}
 
 	if(result == 0) {
-		free(date_str);
+		return 0;
+	}
+
+	buffer[result] = '\0';
+
+	return result;
+}
+
+NODISCARD size_t format_date_string(Time time, TimeFormat format, char* buffer,
+                                    size_t buffer_size) {
+
+	DateFormatDescription description = {};
+
+	if(!get_date_format_description(format, &description)) {
+		return 0;
+	}
+
+	return format_date_string_with_description(time, description, buffer, buffer_size);
+}
+
+NODISCARD char* get_date_string(Time time, TimeFormat format) {
+
+	DateFormatDescription description = {};
+
+	if(!get_date_format_description(format, &description)) {
 		return NULL;
 	}
 
-	date_str[result] = '\0';
+	char* date_str = (char*)malloc(description.max_bytes * sizeof(char));
+
+	if(!date_str) {
+		return NULL;
+	}
+
+	const size_t result =
+	    format_date_string_with_description(time, description, date_str, description.max_bytes);
+
+	if(result == 0) {
+		free(date_str);
+		return NULL;
+	}
 
 	return date_str;
 }
+
+typedef struct {
+	Time current_time;
+	Time monotonic_time;
+	HttpDateString http_date;
+} ClockSnapshot;
+
+#define CLOCK_SNAPSHOT_WORDS ((sizeof(ClockSnapshot) + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+
+typedef struct {
+	// a seqlock: the writer makes the sequence odd, while it writes the snapshot, and even again
+	// afterwards, readers retry, if the sequence was odd or changed while they copied the snapshot,
+	// the snapshot is stored in atomic words, so that copying it concurrently isn't a data race
+	_Atomic(uint64_t) snapshot_words[CLOCK_SNAPSHOT_WORDS];
+	// 0 means, that there is no snapshot yet
+	_Atomic(uint64_t) sequence;
+	// the last written snapshot, only used by the writer
+	ClockSnapshot last_snapshot;
+	atomic_bool running;
+	atomic_bool should_stop;
+	pthread_t thread;
+} ClockService;
+
+static ClockService g_clock_service = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    {
+	    .snapshot_words = {},
+	    .sequence = 0,
+	    .last_snapshot = {},
+	    .running = false,
+	    .should_stop = false,
+	    .thread = {},
+    };
+
+NODISCARD static bool format_http_date_string(Time time,
+                                              OUT_PARAM(HttpDateString) date_string) {
+
+	date_string->length =
+	    format_date_string(time, TimeFormatHTTP1Dot1, date_string->data, HTTP_DATE_STRING_MAX_SIZE);
+
+	return date_string->length != 0;
+}
+
+static void store_clock_snapshot(ClockService* service, const ClockSnapshot* snapshot) {
+
+	uint64_t words[CLOCK_SNAPSHOT_WORDS] = {};
+	memcpy(words, snapshot, sizeof(ClockSnapshot));
+
+	const uint64_t sequence = atomic_load_explicit(&service->sequence, memory_order_relaxed);
+
+	atomic_store_explicit(&service->sequence, sequence + 1, memory_order_relaxed);
+	// the odd sequence has to be visible, before any word of the snapshot changes
+	atomic_thread_fence(memory_order_release);
+
+	for(size_t i = 0; i < CLOCK_SNAPSHOT_WORDS; ++i) {
+		atomic_store_explicit(&(service->snapshot_words[i]), words[i], memory_order_relaxed);
+	}
+
+	atomic_store_explicit(&service->sequence, sequence + 2, memory_order_release);
+}
+
+// only called by one thread at a time, either the service thread or the starting thread before the
+// service thread exists
+static void update_clock_service(ClockService* service) {
+
+	const bool has_previous = atomic_load_explicit(&service->sequence, memory_order_relaxed) != 0;
+
+	const ClockSnapshot* previous = &(service->last_snapshot);
+	ClockSnapshot next = {};
+
+	if(!get_current_time(&(next.current_time))) {
+		return;
+	}
+
+	if(!get_monotonic_time(&(next.monotonic_time))) {
+		return;
+	}
+
+	if(has_previous && previous->http_date.length != 0 &&
+	   previous->current_time._impl_value.tv_sec == next.current_time._impl_value.tv_sec) {
+		// the date string only has a resolution of seconds
+		next.http_date = previous->http_date;
+	} else if(!format_http_date_string(next.current_time, &(next.http_date))) {
+		return;
+	}
+
+	service->last_snapshot = next;
+
+	store_clock_snapshot(service, &next);
+}
+
+NODISCARD static bool get_clock_snapshot(OUT_PARAM(ClockSnapshot) snapshot) {
+
+	if(!atomic_load_explicit(&g_clock_service.running, memory_order_acquire)) {
+		return false;
+	}
+
+	while(true) {
+		const uint64_t sequence =
+		    atomic_load_explicit(&g_clock_service.sequence, memory_order_acquire);
+
+		if(sequence == 0) {
+			return false;
+		}
+
+		if((sequence & 1) != 0) {
+			// the writer is in the middle of an update
+			continue;
+		}
+
+		uint64_t words[CLOCK_SNAPSHOT_WORDS] = {};
+
+		for(size_t i = 0; i < CLOCK_SNAPSHOT_WORDS; ++i) {
+			words[i] =
+			    atomic_load_explicit(&(g_clock_service.snapshot_words[i]), memory_order_relaxed);
+		}
+
+		// the words have to be read, before the sequence is checked again
+		atomic_thread_fence(memory_order_acquire);
+
+		if(atomic_load_explicit(&g_clock_service.sequence, memory_order_relaxed) == sequence) {
+			memcpy(snapshot, words, sizeof(ClockSnapshot));
+			return true;
+		}
+	}
+}
+
+static ANY_TYPE(void) clock_service_thread_function(ANY_TYPE(ClockService*) arg) {
+
+	set_thread_name("clock service thread");
+
+	ClockService* service = (ClockService*)arg;
+
+	const struct timespec interval = {
+		.tv_sec = 0,
+		.tv_nsec = S_TO_NS(CLOCK_SERVICE_RESOLUTION_MS, long) / S_TO_MS_RATE,
+	};
+
+	while(!atomic_load_explicit(&service->should_stop, memory_order_acquire)) {
+		update_clock_service(service);
+
+		nanosleep(&interval, NULL);
+	}
+
+	unset_thread_name();
+
+	return NULL;
+}
+
+void global_start_clock_service(void) {
+
+	if(atomic_load_explicit(&g_clock_service.running, memory_order_acquire)) {
+		return;
+	}
+
+	atomic_store_explicit(&g_clock_service.should_stop, false, memory_order_release);
+
+	// so that the first reads already find a snapshot
+	update_clock_service(&g_clock_service);
+
+	const int result = pthread_create(&g_clock_service.thread, NULL,
+	                                  clock_service_thread_function, &g_clock_service);
+
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to create a new Thread",
+	                       return;);
+
+	atomic_store_explicit(&g_clock_service.running, true, memory_order_release);
+}
+
+void global_stop_clock_service(void) {
+
+	if(!atomic_load_explicit(&g_clock_service.running, memory_order_acquire)) {
+		return;
+	}
+
+	atomic_store_explicit(&g_clock_service.running, false, memory_order_release);
+	atomic_store_explicit(&g_clock_service.should_stop, true, memory_order_release);
+
+	const int result = pthread_join(g_clock_service.thread, NULL);
+
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to wait for a Thread", return;);
+}
+
+NODISCARD bool get_coarse_monotonic_time(Time* time) {
+
+	ClockSnapshot snapshot = {};
+
+	if(!get_clock_snapshot(&snapshot)) {
+		return get_monotonic_time(time);
+	}
+
+	*time = snapshot.monotonic_time;
+	return true;
+}
+
+NODISCARD uint64_t get_coarse_monotonic_time_in_ms(void) {
+	Time now;
+
+	if(!get_coarse_monotonic_time(&now)) {
+		return 0;
+	}
+
+	return get_time_in_milli_seconds(now);
+}
+
+NODISCARD bool get_coarse_current_time(Time* time) {
+
+	ClockSnapshot snapshot = {};
+
+	if(!get_clock_snapshot(&snapshot)) {
+		return get_current_time(time);
+	}
+
+	*time = snapshot.current_time;
+	return true;
+}
+
+NODISCARD bool get_http_date_string(HttpDateString* date_string) {
+
+	ClockSnapshot snapshot = {};
+
+	if(get_clock_snapshot(&snapshot)) {
+		*date_string = snapshot.http_date;
+		return true;
+	}
+
+	Time now;
+	if(!get_current_time(&now)) {
+		return false;
+	}
+
+	return format_http_date_string(now, date_string);
+}
@@ -6,6 +6,10 @@
 
 #include "./utils.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct timespec UnderlyingTimeValue;
 
 typedef time_t NanoTime;
@@ -66,6 +70,51 @@ typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
  */
 NODISCARD char* get_date_string(Time time, TimeFormat format);
 
+/**
+ * @brief Same as get_date_string, but writes into the given buffer, without allocating
+ *
+ * @param time
+ * @param format
+ * @param buffer
+ * @param buffer_size
+ * @return the length of the written string (without the null terminator) or 0 on error
+ */
+NODISCARD size_t format_date_string(Time time, TimeFormat format, char* buffer,
+                                    size_t buffer_size);
+
 void global_initialize_locale_for_http(void);
 
 void global_free_locale_for_http(void);
+
+// the clock service refreshes the current time every CLOCK_SERVICE_RESOLUTION_MS milliseconds in a
+// background thread, so that hot paths (e.g. the Date header, logs and timeouts) don't need to call
+// clock_gettime and strftime themselves
+// the coarse functions below fall back to the precise clocks, if the service isn't running
+
+#define CLOCK_SERVICE_RESOLUTION_MS 10
+
+// "Sun, 06 Nov 1994 08:49:37 GMT" has 29 characters
+#define HTTP_DATE_STRING_MAX_SIZE 32
+
+typedef struct {
+	char data[HTTP_DATE_STRING_MAX_SIZE];
+	size_t length;
+} HttpDateString;
+
+void global_start_clock_service(void);
+
+void global_stop_clock_service(void);
+
+NODISCARD bool get_coarse_monotonic_time(OUT_PARAM(Time) time);
+
+NODISCARD bool get_coarse_current_time(OUT_PARAM(Time) time);
+
+// the coarse monotonic time in milliseconds, e.g. for expiry times, 0 on errors
+NODISCARD uint64_t get_coarse_monotonic_time_in_ms(void);
+
+// the IMF-fixdate of the current second, this is formatted only once per second
+NODISCARD bool get_http_date_string(OUT_PARAM(HttpDateString) date_string);
+
+#ifdef __cplusplus
+}
+#endif
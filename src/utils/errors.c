@@ -94,6 +94,10 @@ void print_create_error(const CreateError error) {
 	LOG_MESSAGE(LogLevelError, "Create Error: %s\n", error_str);
 }
 
+bool is_submit_error(SubmitError error) {
+	return error >= SUBMIT_ERROR_START && error <= SUBMIT_ERROR_END;
+}
+
 void print_submit_error(SubmitError error) {
 
 	const char* error_str = "Unknown error";
@@ -79,6 +79,11 @@ typedef ANY SubmitError;
 #define SUBMIT_ERROR_INVALID_START_ROUTINE ((SubmitError)0xA3)
 #define SUBMIT_ERROR_QUEUE_PUSH ((SubmitError)0xA4)
 
+#define SUBMIT_ERROR_START SUBMIT_ERROR_MALLOC
+#define SUBMIT_ERROR_END SUBMIT_ERROR_QUEUE_PUSH
+
+NODISCARD bool is_submit_error(SubmitError error);
+
 void print_submit_error(SubmitError error);
 
 // worker errors
@@ -4,32 +4,105 @@
 #undef _GNU_SOURCE
 
 #include "log.h"
+#include "generic/sem.h"
 #include "thread_helper.h"
 #include "utils/utils.h"
 
+#include <errno.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <time.h>
+
 #define DEFAULT_LOG_LEVEL LogLevelInfo
 
+// longer messages are written synchronously
+#define LOG_RECORD_MAX_SIZE 512
+
+// per thread, if the flusher can't keep up, messages are dropped
+#define LOG_RING_SIZE 128
+
+// while records arrive, the flusher collects them for this long, before it writes them
+#define LOG_FLUSH_INTERVAL_MS 5
+
+// while all rings are empty, the flusher sleeps, until a record is published, it only wakes up
+// after this time, to free the rings of exited threads
+#define LOG_IDLE_INTERVAL_MS 1000
+
+typedef struct {
+	// monotonic, taken at the call site, so that the flusher can merge the rings in order
+	uint64_t timestamp_ns;
+	size_t length;
+	bool to_stderr;
+	char data[LOG_RECORD_MAX_SIZE];
+} LogRecord;
+
+typedef struct LogRingImpl LogRing;
+
+// a single producer single consumer ring, the producer is the thread, that owns it, the consumer is
+// the flusher thread
+struct LogRingImpl {
+	// only written by the consumer
+	atomic_size_t head;
+	// only written by the producer
+	atomic_size_t tail;
+	atomic_size_t dropped;
+	// set, when the owning thread exits, the flusher frees the ring, after it wrote it
+	atomic_bool abandoned;
+	// only used by the flusher
+	size_t flush_end;
+	size_t reported_dropped;
+	// new rings are pushed at the front without a lock, only the flusher removes rings
+	LogRing* next;
+	LogRecord records[LOG_RING_SIZE];
+};
+
 // global state
 
 typedef struct {
 	LogLevel log_level;
+	// NULL means stdout and stderr
+	FILE* output;
+	FILE* error_output;
+	// serializes the synchronous output and the output of the flusher
 	pthread_mutex_t mutex;
+	_Atomic(LogRing*) rings;
+	pthread_key_t ring_key;
+	pthread_t flusher;
+	atomic_bool running;
+	atomic_bool should_stop;
+	// records, that were started while the flusher was running, but aren't published yet
+	atomic_size_t active_writers;
+	// the flusher waits on this, while all rings are empty, the writers only post it, if the
+	// flusher sleeps, a post doesn't take a lock, so a log call never waits for the flusher
+	SemaphoreType wakeup;
+	atomic_bool flusher_sleeping;
+	// the mutex, the semaphore and the key are kept after shutdown_logger, so that threads keep
+	// their rings, if the logger is initialized again
+	bool initialized;
 } GlobalLogState;
 
 static GlobalLogState
     g_global_value_log_entry = { // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
-	    .log_level = DEFAULT_LOG_LEVEL
+	    .log_level = DEFAULT_LOG_LEVEL,
+	    .output = NULL,
+	    .error_output = NULL,
+	    .initialized = false,
     };
 
 // thread state
 
 typedef struct {
 	const char* name;
+	LogRing* ring;
+	// used for synchronous messages
+	char buffer[LOG_RECORD_MAX_SIZE];
 } ThreadState;
 
 static _Thread_local ThreadState
     g_global_value_log_thread_state = { // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
-	    .name = NULL
+	    .name = NULL,
+	    .ring = NULL,
+	    .buffer = {},
     };
 
 bool log_should_log(LogLevel level) {
@@ -135,8 +208,8 @@ const char* get_thread_name(void) {
 	return g_global_value_log_thread_state.name;
 }
 
-void log_lock_mutex(void) {
-	const LibCInt result = pthread_mutex_lock(&g_global_value_log_entry.mutex);
+static void log_lock_mutex(pthread_mutex_t* const mutex) {
+	const LibCInt result = pthread_mutex_lock(mutex);
 
 	if(result != 0) {
 		/*pthread function don't set errno, but return the error value \
@@ -147,8 +220,8 @@ void log_lock_mutex(void) {
 	}
 }
 
-void log_unlock_mutex(void) {
-	const LibCInt result = pthread_mutex_unlock(&g_global_value_log_entry.mutex);
+static void log_unlock_mutex(pthread_mutex_t* const mutex) {
+	const LibCInt result = pthread_mutex_unlock(mutex);
 
 	if(result != 0) {
 		/*pthread function don't set errno, but return the error value \
@@ -159,18 +232,536 @@ void log_unlock_mutex(void) {
 	}
 }
 
+// this doesn't use the coarse clock of the clock service, the flusher merges the rings of all
+// threads by this timestamp, and with a resolution of 10 ms, the records of different threads
+// within that time would be written in an arbitrary order, CLOCK_MONOTONIC is read in the vdso, so
+// it doesn't need a system call either
+NODISCARD static uint64_t get_log_timestamp_ns(void) {
+	struct timespec now = {};
+
+	if(clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+		return 0;
+	}
+
+	return ((uint64_t)now.tv_sec * 1000000000ULL) + // NOLINT(readability-magic-numbers)
+	       (uint64_t)now.tv_nsec;
+}
+
+NODISCARD static FILE* get_log_output_file(const bool to_stderr) {
+
+	FILE* const output = to_stderr ? g_global_value_log_entry.error_output
+	                               : g_global_value_log_entry.output;
+
+	if(output != NULL) {
+		return output;
+	}
+
+	return to_stderr ? stderr : stdout;
+}
+
+static void write_log_output_synchronously(const bool to_stderr, const char* const data,
+                                           const size_t length) {
+	log_lock_mutex(&g_global_value_log_entry.mutex);
+	fwrite(data, 1, length, get_log_output_file(to_stderr));
+	log_unlock_mutex(&g_global_value_log_entry.mutex);
+}
+
+// this is called while logging, so errors can't be logged with LOG_MESSAGE
+static void wake_log_flusher(void) {
+	const LibCInt result = comp_sem_post(&g_global_value_log_entry.wakeup);
+
+	if(result == -1) {
+		fprintf(stderr, "An Error occurred while trying to signal the log flusher: %s\n",
+		        strerror(errno));
+	}
+}
+
+// shutdown_logger waits for the writers, that saw the flusher running, so that their records are
+// written, before it stops the flusher
+static void release_log_writer(void) {
+	atomic_fetch_sub_explicit(&g_global_value_log_entry.active_writers, 1, memory_order_seq_cst);
+}
+
+// called by the exiting thread, that owns the ring, if it logs afterwards, it gets a new ring
+static void abandon_log_ring(ANY_TYPE(LogRing*) arg) {
+	LogRing* ring = (LogRing*)arg;
+
+	g_global_value_log_thread_state.ring = NULL;
+
+	atomic_store_explicit(&ring->abandoned, true, memory_order_release);
+}
+
+NODISCARD static LogRing* get_thread_log_ring(void) {
+
+	if(g_global_value_log_thread_state.ring != NULL) {
+		return g_global_value_log_thread_state.ring;
+	}
+
+	LogRing* ring = malloc(sizeof(LogRing));
+
+	if(ring == NULL) {
+		return NULL;
+	}
+
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->dropped, 0);
+	atomic_init(&ring->abandoned, false);
+	ring->flush_end = 0;
+	ring->reported_dropped = 0;
+
+	if(pthread_setspecific(g_global_value_log_entry.ring_key, ring) != 0) {
+		free(ring);
+		return NULL;
+	}
+
+	LogRing* current_head =
+	    atomic_load_explicit(&g_global_value_log_entry.rings, memory_order_relaxed);
+
+	do {
+		ring->next = current_head;
+	} while(!atomic_compare_exchange_weak_explicit(&g_global_value_log_entry.rings, &current_head,
+	                                               ring, memory_order_release,
+	                                               memory_order_relaxed));
+
+	g_global_value_log_thread_state.ring = ring;
+
+	return ring;
+}
+
+NODISCARD LogRecordWriter log_begin_record(const bool to_stderr) {
+
+	LogRecordWriter writer = {
+		.record = NULL,
+		.data = g_global_value_log_thread_state.buffer,
+		.capacity = LOG_RECORD_MAX_SIZE,
+		.length = 0,
+		.to_stderr = to_stderr,
+		.dropped = false,
+		.allocated = false,
+	};
+
+	// the writer is counted before running is checked, pairs with shutdown_logger, that clears
+	// running before it waits for the counted writers
+	atomic_fetch_add_explicit(&g_global_value_log_entry.active_writers, 1, memory_order_seq_cst);
+
+	if(!atomic_load_explicit(&g_global_value_log_entry.running, memory_order_seq_cst)) {
+		release_log_writer();
+		return writer;
+	}
+
+	LogRing* ring = get_thread_log_ring();
+
+	if(ring == NULL) {
+		release_log_writer();
+		return writer;
+	}
+
+	const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	const size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	if(tail - head >= LOG_RING_SIZE) {
+		atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+		release_log_writer();
+		writer.dropped = true;
+		return writer;
+	}
+
+	// the slot belongs to this thread, until the tail is advanced in log_end_record
+	LogRecord* record = &(ring->records[tail % LOG_RING_SIZE]);
+
+	record->timestamp_ns = get_log_timestamp_ns();
+	record->to_stderr = to_stderr;
+
+	writer.record = record;
+	writer.data = record->data;
+
+	return writer;
+}
+
+void log_record_printf(LogRecordWriter* const writer, const char* const format, ...) {
+
+	if(writer->dropped) {
+		return;
+	}
+
+	va_list args;
+	va_start(args, format);
+
+	va_list args_copy;
+	va_copy(args_copy, args);
+
+	const size_t remaining = writer->capacity - writer->length;
+
+	const LibCInt written = vsnprintf(writer->data + writer->length, remaining, format, args);
+
+	va_end(args);
+
+	if(written < 0) {
+		va_end(args_copy);
+		return;
+	}
+
+	if((size_t)written < remaining) {
+		writer->length += (size_t)written;
+		va_end(args_copy);
+		return;
+	}
+
+	// the message doesn't fit, so it continues in an allocated buffer and is written synchronously
+	const size_t new_capacity = writer->length + (size_t)written + 1;
+
+	char* new_data = malloc(new_capacity);
+
+	if(new_data == NULL) {
+		va_end(args_copy);
+		writer->length = writer->capacity - 1;
+		return;
+	}
+
+	memcpy(new_data, writer->data, writer->length);
+
+	if(writer->allocated) {
+		free(writer->data);
+	}
+
+	writer->data = new_data;
+	writer->capacity = new_capacity;
+	writer->allocated = true;
+
+	const LibCInt written_again =
+	    vsnprintf(writer->data + writer->length, new_capacity - writer->length, format, args_copy);
+
+	va_end(args_copy);
+
+	if(written_again > 0) {
+		writer->length += (size_t)written_again;
+	}
+}
+
+void log_record_write_prelude(LogRecordWriter* const writer, const LogLevel level,
+                              const bool color) {
+
+	const char* const level_name = get_level_name_internal(level, color);
+	const char* const thread_name = get_thread_name();
+
+	log_record_printf(writer, "[%s] ", level_name);
+
+	if(color) {
+		log_record_printf(writer, "[\033[32m%s\033[0m] ", thread_name); /*GREEN*/
+	} else {
+		log_record_printf(writer, "[%s] ", thread_name);
+	}
+}
+
+void log_end_record(LogRecordWriter* const writer) {
+
+	if(writer->dropped) {
+		return;
+	}
+
+	if(writer->allocated) {
+		// the reserved slot is just not published
+		write_log_output_synchronously(writer->to_stderr, writer->data, writer->length);
+		free(writer->data);
+
+		if(writer->record != NULL) {
+			release_log_writer();
+		}
+		return;
+	}
+
+	if(writer->record == NULL) {
+		write_log_output_synchronously(writer->to_stderr, writer->data, writer->length);
+		return;
+	}
+
+	LogRecord* record = (LogRecord*)writer->record;
+
+	record->length = writer->length;
+
+	LogRing* ring = g_global_value_log_thread_state.ring;
+
+	const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	// publishes the record to the flusher
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+	// pairs with wait_for_log_records, either the flusher sees the new tail, before it sleeps, or
+	// this sees, that it sleeps
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if(atomic_load_explicit(&g_global_value_log_entry.flusher_sleeping, memory_order_relaxed)) {
+		wake_log_flusher();
+	}
+
+	release_log_writer();
+}
+
+// only the flusher calls this, returns true, if anything was written
+static bool flush_log_rings(void) {
+
+	LogRing* const first_ring =
+	    atomic_load_explicit(&g_global_value_log_entry.rings, memory_order_acquire);
+
+	// abandoned rings can only be freed, if they were abandoned before their tail was read, as
+	// otherwise records could be added after the tail was read
+	for(LogRing* ring = first_ring; ring != NULL; ring = ring->next) {
+		ring->flush_end = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	}
+
+	log_lock_mutex(&g_global_value_log_entry.mutex);
+
+	bool written = false;
+
+	// the records of all threads are merged by their timestamp, the amount of threads is small
+	while(true) {
+		LogRing* oldest_ring = NULL;
+		const LogRecord* oldest_record = NULL;
+
+		for(LogRing* ring = first_ring; ring != NULL; ring = ring->next) {
+			const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+			if(head == ring->flush_end) {
+				continue;
+			}
+
+			const LogRecord* record = &(ring->records[head % LOG_RING_SIZE]);
+
+			if(oldest_record == NULL || record->timestamp_ns < oldest_record->timestamp_ns) {
+				oldest_ring = ring;
+				oldest_record = record;
+			}
+		}
+
+		if(oldest_ring == NULL) {
+			break;
+		}
+
+		fwrite(oldest_record->data, 1, oldest_record->length,
+		       get_log_output_file(oldest_record->to_stderr));
+		written = true;
+
+		const size_t head = atomic_load_explicit(&oldest_ring->head, memory_order_relaxed);
+		atomic_store_explicit(&oldest_ring->head, head + 1, memory_order_release);
+	}
+
+	size_t dropped = 0;
+
+	for(LogRing* ring = first_ring; ring != NULL; ring = ring->next) {
+		const size_t ring_dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+
+		dropped += ring_dropped - ring->reported_dropped;
+		ring->reported_dropped = ring_dropped;
+	}
+
+	if(dropped > 0) {
+		fprintf(get_log_output_file(true),
+		        "[%s] [%s] Dropped %zu log messages, as the log buffers were full\n",
+		        get_level_name_internal(LogLevelWarn, false), get_thread_name(), dropped);
+		written = true;
+	}
+
+	if(written) {
+		fflush(get_log_output_file(false));
+		fflush(get_log_output_file(true));
+	}
+
+	log_unlock_mutex(&g_global_value_log_entry.mutex);
+
+	return written;
+}
+
+NODISCARD static bool has_pending_log_records(void) {
+
+	for(LogRing* ring = atomic_load_explicit(&g_global_value_log_entry.rings, memory_order_acquire);
+	    ring != NULL; ring = ring->next) {
+		if(atomic_load_explicit(&ring->head, memory_order_relaxed) !=
+		   atomic_load_explicit(&ring->tail, memory_order_seq_cst)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// sleeps, until a record is published, shutdown_logger is called or the idle interval passed
+static void wait_for_log_records(void) {
+
+	// pairs with the fence in log_end_record
+	atomic_store_explicit(&g_global_value_log_entry.flusher_sleeping, true, memory_order_seq_cst);
+
+	if(!has_pending_log_records() &&
+	   !atomic_load_explicit(&g_global_value_log_entry.should_stop, memory_order_acquire)) {
+		// a timeout is the normal case, so the result is ignored
+		UNUSED(comp_sem_timed_wait(&g_global_value_log_entry.wakeup, LOG_IDLE_INTERVAL_MS));
+	}
+
+	atomic_store_explicit(&g_global_value_log_entry.flusher_sleeping, false, memory_order_relaxed);
+
+	// several writers may have posted, while the flusher slept, those posts are consumed, so that
+	// the next sleep isn't cut short
+	while(comp_sem_try_wait(&g_global_value_log_entry.wakeup) == 0) {
+	}
+}
+
+// frees the rings of exited threads, only new rings are added concurrently, and they are added at
+// the front
+static void free_abandoned_log_rings(void) {
+
+	LogRing* previous = NULL;
+	LogRing* ring = atomic_load_explicit(&g_global_value_log_entry.rings, memory_order_acquire);
+
+	while(ring != NULL) {
+		LogRing* const next = ring->next;
+
+		const bool abandoned = atomic_load_explicit(&ring->abandoned, memory_order_acquire);
+
+		if(!abandoned || atomic_load_explicit(&ring->head, memory_order_relaxed) !=
+		                     atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+			previous = ring;
+			ring = next;
+			continue;
+		}
+
+		if(previous != NULL) {
+			previous->next = next;
+		} else {
+			LogRing* expected = ring;
+
+			if(!atomic_compare_exchange_strong_explicit(&g_global_value_log_entry.rings,
+			                                            &expected, next, memory_order_acq_rel,
+			                                            memory_order_acquire)) {
+				// a new ring was pushed in front of it, it is removed in the next round
+				previous = ring;
+				ring = next;
+				continue;
+			}
+		}
+
+		free(ring);
+		ring = next;
+	}
+}
+
+static ANY_TYPE(void) log_flusher_thread_function(ANY_TYPE(void) /* arg */) {
+
+	set_thread_name("log flusher thread");
+
+	const struct timespec interval = {
+		.tv_sec = 0,
+		.tv_nsec = (long)LOG_FLUSH_INTERVAL_MS * 1000000L, // NOLINT(readability-magic-numbers)
+	};
+
+	while(!atomic_load_explicit(&g_global_value_log_entry.should_stop, memory_order_acquire)) {
+		const bool written = flush_log_rings();
+		free_abandoned_log_rings();
+
+		// while records arrive, they are written in batches, an idle flusher doesn't wake up for
+		// every interval
+		if(written) {
+			nanosleep(&interval, NULL);
+		} else {
+			wait_for_log_records();
+		}
+	}
+
+	// shutdown_logger waited for the started records, so this writes everything
+	flush_log_rings();
+
+	unset_thread_name();
+
+	return NULL;
+}
+
+void shutdown_logger(void) {
+
+	if(!atomic_load_explicit(&g_global_value_log_entry.running, memory_order_acquire)) {
+		return;
+	}
+
+	// new messages are written synchronously from now on
+	atomic_store_explicit(&g_global_value_log_entry.running, false, memory_order_seq_cst);
+
+	// records, that were started before, are only a formatting call away from being published
+	const struct timespec writer_interval = {
+		.tv_sec = 0,
+		.tv_nsec = 100000L, // NOLINT(readability-magic-numbers)
+	};
+
+	while(atomic_load_explicit(&g_global_value_log_entry.active_writers, memory_order_seq_cst) !=
+	      0) {
+		nanosleep(&writer_interval, NULL);
+	}
+
+	atomic_store_explicit(&g_global_value_log_entry.should_stop, true, memory_order_release);
+	wake_log_flusher();
+
+	const LibCInt result = pthread_join(g_global_value_log_entry.flusher, NULL);
+
+	if(result != 0) {
+		fprintf(stderr, "An Error occurred while trying to wait for the log flusher: %s\n",
+		        strerror(result));
+		return;
+	}
+}
+
 void initialize_logger(void) {
 	g_global_value_log_entry.log_level = DEFAULT_LOG_LEVEL;
 
-	const LibCInt result = pthread_mutex_init(&g_global_value_log_entry.mutex, NULL);
-	CHECK_FOR_THREAD_ERROR(
-	    result, "An Error occurred while trying to initialize the mutex for the logger", return;);
+	if(atomic_load_explicit(&g_global_value_log_entry.running, memory_order_acquire)) {
+		return;
+	}
+
+	if(!g_global_value_log_entry.initialized) {
+		const LibCInt result = pthread_mutex_init(&g_global_value_log_entry.mutex, NULL);
+		CHECK_FOR_THREAD_ERROR(
+		    result, "An Error occurred while trying to initialize the mutex for the logger",
+		    return;);
+
+		const LibCInt wakeup_result = comp_sem_init(&g_global_value_log_entry.wakeup, 0, true);
+		CHECK_FOR_ERROR(wakeup_result,
+		                "An Error occurred while trying to initialize the semaphore for the logger",
+		                return;);
+
+		const LibCInt key_result =
+		    pthread_key_create(&g_global_value_log_entry.ring_key, abandon_log_ring);
+		CHECK_FOR_THREAD_ERROR(
+		    key_result, "An Error occurred while trying to create the thread key for the logger",
+		    return;);
+
+		atomic_store_explicit(&g_global_value_log_entry.rings, NULL, memory_order_relaxed);
+
+		g_global_value_log_entry.initialized = true;
+
+		// so that nothing, that was logged, gets lost, when main returns
+		atexit(shutdown_logger);
+	}
+
+	atomic_store_explicit(&g_global_value_log_entry.should_stop, false, memory_order_relaxed);
+
+	const LibCInt create_result =
+	    pthread_create(&g_global_value_log_entry.flusher, NULL, log_flusher_thread_function, NULL);
+	CHECK_FOR_THREAD_ERROR(create_result,
+	                       "An Error occurred while trying to create the log flusher thread",
+	                       return;);
+
+	atomic_store_explicit(&g_global_value_log_entry.running, true, memory_order_release);
 }
 
 void set_log_level(LogLevel level) {
 	g_global_value_log_entry.log_level = level;
 }
 
+NODISCARD LogLevel get_log_level(void) {
+	return g_global_value_log_entry.log_level;
+}
+
+void set_log_output(FILE* const output, FILE* const error_output) {
+	g_global_value_log_entry.output = output;
+	g_global_value_log_entry.error_output = error_output;
+}
+
 // taken from my work in oopetris
 // inspired by SDL_SYS_SetupThread also uses that code for most platforms
 static void set_platform_thread_name(const char* name) {
@@ -40,10 +40,6 @@ NODISCARD const char* get_level_name_internal(LogLevel level, bool color);
 
 NODISCARD const char* get_thread_name(void);
 
-void log_lock_mutex(void);
-
-void log_unlock_mutex(void);
-
 NODISCARD bool log_should_use_color(bool stderr);
 
 NODISCARD bool has_flag(FLAGS_TYPE flags, LogFlags needle);
@@ -55,6 +51,36 @@ typedef struct {
 
 LevelAndFlags get_level_and_flags(FLAGS_TYPE level_and_flags);
 
+#if defined(__GNUC__) || defined(__clang__)
+	#define LOG_PRINTF_FORMAT(format_index, args_index) \
+		__attribute__((format(printf, format_index, args_index)))
+#else
+	#define LOG_PRINTF_FORMAT(format_index, args_index)
+#endif
+
+// a message is formatted at the call site directly into a slot of the ring of the calling thread,
+// the flusher thread writes the rings in the order of the timestamps, so the calling thread never
+// waits for the output
+// if the ring is full, the message is dropped and counted, messages, that don't fit into a slot,
+// or are logged, while the flusher isn't running, are written synchronously
+typedef struct {
+	void* record;
+	char* data;
+	size_t capacity;
+	size_t length;
+	bool to_stderr;
+	bool dropped;
+	bool allocated;
+} LogRecordWriter;
+
+NODISCARD LogRecordWriter log_begin_record(bool to_stderr);
+
+void log_record_write_prelude(LogRecordWriter* writer, LogLevel level, bool color);
+
+void log_record_printf(LogRecordWriter* writer, const char* format, ...) LOG_PRINTF_FORMAT(2, 3);
+
+void log_end_record(LogRecordWriter* writer);
+
 #define LOG_MESSAGE(level_and_flags, msg, ...) \
 	do { \
 		const LevelAndFlags destructured = get_level_and_flags(level_and_flags); \
@@ -63,23 +89,15 @@ LevelAndFlags get_level_and_flags(FLAGS_TYPE level_and_flags);
 		if(log_should_log(level)) { \
 			const bool should_log_to_stderr = log_should_log_to_stderr(level); \
 			const bool should_use_color = log_should_use_color(should_log_to_stderr); \
-			const char* const level_name = get_level_name_internal(level, should_use_color); \
-			const char* const thread_name = get_thread_name(); \
-			log_lock_mutex(); \
-			FILE* file_stream = should_log_to_stderr ? stderr : stdout; \
+			LogRecordWriter log_writer = log_begin_record(should_log_to_stderr); \
 			if(!has_flag(flags, LogPrintNoPrelude)) { \
-				fprintf(file_stream, "[%s] ", level_name); \
-				if(should_use_color) { \
-					fprintf(file_stream, "[\033[32m%s\033[0m] ", thread_name); /*GREEN*/ \
-				} else { \
-					fprintf(file_stream, "[%s] ", thread_name); \
-				} \
+				log_record_write_prelude(&log_writer, level, should_use_color); \
 			} \
 			if(has_flag(flags, LogPrintLocation)) { \
-				fprintf(file_stream, "[%s %s:%d] ", __func__, __FILE__, __LINE__); \
+				log_record_printf(&log_writer, "[%s %s:%d] ", __func__, __FILE__, __LINE__); \
 			} \
-			fprintf(file_stream, msg, __VA_ARGS__); \
-			log_unlock_mutex(); \
+			log_record_printf(&log_writer, msg, __VA_ARGS__); \
+			log_end_record(&log_writer); \
 		} \
 	} while(false);
 
@@ -89,12 +107,24 @@ LevelAndFlags get_level_and_flags(FLAGS_TYPE level_and_flags);
 
 // everybody can use them
 
-// NOT thread safe
+// NOT thread safe, this starts the flusher thread, it is stopped at exit, see shutdown_logger
 void initialize_logger(void);
 
+// NOT thread safe, writes all pending messages, including the ones, that other threads are
+// formatting right now, and stops the flusher thread, messages logged afterwards are written
+// synchronously, initialize_logger can start it again
+void shutdown_logger(void);
+
 // NOT thread safe
 void set_log_level(LogLevel level);
 
+// NOT thread safe
+NODISCARD LogLevel get_log_level(void);
+
+// NOT thread safe, has to be called, while the logger isn't running, messages are written to these
+// files instead of stdout and stderr, NULL restores the default
+void set_log_output(FILE* output, FILE* error_output);
+
 // IS thread safe
 void set_thread_name(const char* name);
 
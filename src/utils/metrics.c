@@ -0,0 +1,627 @@
+
+#include "./metrics.h"
+#include "./log.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+// every shard is on its own cache line, so that threads, that write to different shards, don't
+// invalidate each others cache lines
+
+typedef struct {
+	alignas(METRICS_CACHE_LINE_SIZE) _Atomic(uint64_t) value;
+} MetricsCounterShard;
+
+struct MetricsCounterImpl {
+	MetricsCounterShard shards[METRICS_SHARD_COUNT];
+};
+
+typedef struct {
+	alignas(METRICS_CACHE_LINE_SIZE) _Atomic(int64_t) value;
+} MetricsGaugeShard;
+
+struct MetricsGaugeImpl {
+	MetricsGaugeShard shards[METRICS_SHARD_COUNT];
+};
+
+typedef struct {
+	alignas(METRICS_CACHE_LINE_SIZE) _Atomic(uint64_t) count;
+	_Atomic(uint64_t) sum;
+	// not cumulative, the last one is the +Inf bucket, they are summed up on export
+	_Atomic(uint64_t) buckets[METRICS_HISTOGRAM_MAX_BUCKETS + 1];
+} MetricsHistogramShard;
+
+struct MetricsHistogramImpl {
+	MetricsHistogramShard shards[METRICS_SHARD_COUNT];
+	size_t bound_amount;
+	uint64_t bounds[METRICS_HISTOGRAM_MAX_BUCKETS];
+	double scale;
+};
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	MetricsTypeCounter = 0,
+	MetricsTypeGauge,
+	MetricsTypeGaugeCallback,
+	MetricsTypeHistogram,
+} MetricsType;
+
+typedef struct {
+	MetricsGaugeCallback callback;
+	void* data;
+} MetricsGaugeCallbackData;
+
+typedef union {
+	MetricsCounter* counter;
+	MetricsGauge* gauge;
+	MetricsGaugeCallbackData callback;
+	MetricsHistogram* histogram;
+} MetricsValue;
+
+typedef struct MetricsEntryImpl MetricsEntry;
+
+struct MetricsEntryImpl {
+	MetricsType type;
+	char* name;
+	char* help;
+	// already formatted and escaped, without the braces, empty, if there are no labels
+	char* labels;
+	MetricsValue value;
+	// only used while exporting, so that every family is exported once
+	bool exported;
+	MetricsEntry* next;
+};
+
+typedef struct {
+	pthread_mutex_t mutex;
+	// in registration order, so that the export is stable
+	MetricsEntry* first;
+	MetricsEntry* last;
+} MetricsRegistry;
+
+static MetricsRegistry
+    g_metrics_registry = { // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+	    .mutex = PTHREAD_MUTEX_INITIALIZER,
+	    .first = NULL,
+	    .last = NULL,
+    };
+
+static atomic_size_t
+    g_metrics_next_shard = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    0;
+
+static _Thread_local size_t
+    g_metrics_thread_shard = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    METRICS_SHARD_COUNT;
+
+NODISCARD static size_t get_metrics_thread_shard(void) {
+
+	if(g_metrics_thread_shard == METRICS_SHARD_COUNT) {
+		g_metrics_thread_shard =
+		    atomic_fetch_add_explicit(&g_metrics_next_shard, 1, memory_order_relaxed) %
+		    METRICS_SHARD_COUNT;
+	}
+
+	return g_metrics_thread_shard;
+}
+
+// see https://prometheus.io/docs/instrumenting/exposition_formats/#text-format-details
+static void append_escaped_metrics_label_value(StringBuilder* const string_builder,
+                                               const char* const value) {
+
+	for(const char* current = value; *current != '\0'; ++current) {
+		switch(*current) {
+			case '\\': {
+				string_builder_append_single(string_builder, "\\\\");
+				break;
+			}
+			case '"': {
+				string_builder_append_single(string_builder, "\\\"");
+				break;
+			}
+			case '\n': {
+				string_builder_append_single(string_builder, "\\n");
+				break;
+			}
+			default: {
+				string_builder_append_buffer(string_builder,
+				                             (ReadonlyBuffer){ .data = current, .size = 1 });
+				break;
+			}
+		}
+	}
+}
+
+NODISCARD static char* format_metrics_labels(const MetricsLabels labels) {
+
+	StringBuilder* string_builder = string_builder_init();
+
+	if(string_builder == NULL) {
+		return NULL;
+	}
+
+	for(size_t i = 0; i < labels.label_amount; ++i) {
+		const MetricsLabel label = labels.labels[i];
+
+		if(i != 0) {
+			string_builder_append_single(string_builder, ",");
+		}
+
+		string_builder_append_single(string_builder, label.name);
+		string_builder_append_single(string_builder, "=\"");
+		append_escaped_metrics_label_value(string_builder, label.value);
+		string_builder_append_single(string_builder, "\"");
+	}
+
+	// an empty builder has no string yet
+	if(string_builder_get_string_size(string_builder) == 0) {
+		free_string_builder(string_builder);
+		return strdup("");
+	}
+
+	return string_builder_release_into_string(&string_builder);
+}
+
+static void free_metrics_value(const MetricsType type, const MetricsValue value) {
+
+	switch(type) {
+		case MetricsTypeCounter: {
+			free(value.counter);
+			break;
+		}
+		case MetricsTypeGauge: {
+			free(value.gauge);
+			break;
+		}
+		case MetricsTypeHistogram: {
+			free(value.histogram);
+			break;
+		}
+		case MetricsTypeGaugeCallback:
+		default: {
+			break;
+		}
+	}
+}
+
+static void free_metrics_entry(MetricsEntry* const entry) {
+	free_metrics_value(entry->type, entry->value);
+	free(entry->name);
+	free(entry->help);
+	free(entry->labels);
+	free(entry);
+}
+
+// takes ownership of the value, it gets freed on error
+NODISCARD static bool register_metrics_entry(const char* const name, const char* const help,
+                                             const MetricsLabels labels, const MetricsType type,
+                                             const MetricsValue value) {
+
+	MetricsEntry* entry = malloc(sizeof(MetricsEntry));
+
+	if(entry == NULL) {
+		free_metrics_value(type, value);
+		return false;
+	}
+
+	*entry = (MetricsEntry){
+		.type = type,
+		.name = strdup(name),
+		.help = strdup(help),
+		.labels = format_metrics_labels(labels),
+		.value = value,
+		.exported = false,
+		.next = NULL,
+	};
+
+	if(entry->name == NULL || entry->help == NULL || entry->labels == NULL) {
+		free_metrics_entry(entry);
+		return false;
+	}
+
+	int result = pthread_mutex_lock(&g_metrics_registry.mutex);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to lock the metrics mutex", {
+		free_metrics_entry(entry);
+		return false;
+	});
+
+	if(g_metrics_registry.last == NULL) {
+		g_metrics_registry.first = entry;
+	} else {
+		g_metrics_registry.last->next = entry;
+	}
+
+	g_metrics_registry.last = entry;
+
+	result = pthread_mutex_unlock(&g_metrics_registry.mutex);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to unlock the metrics mutex",
+	                       {});
+
+	return true;
+}
+
+NODISCARD MetricsCounter* metrics_register_counter(const char* const name, const char* const help,
+                                                   const MetricsLabels labels) {
+
+	MetricsCounter* counter = aligned_alloc(alignof(MetricsCounter), sizeof(MetricsCounter));
+
+	if(counter == NULL) {
+		return NULL;
+	}
+
+	for(size_t i = 0; i < METRICS_SHARD_COUNT; ++i) {
+		atomic_init(&(counter->shards[i].value), 0);
+	}
+
+	if(!register_metrics_entry(name, help, labels, MetricsTypeCounter,
+	                           (MetricsValue){ .counter = counter })) {
+		return NULL;
+	}
+
+	return counter;
+}
+
+NODISCARD MetricsGauge* metrics_register_gauge(const char* const name, const char* const help,
+                                               const MetricsLabels labels) {
+
+	MetricsGauge* gauge = aligned_alloc(alignof(MetricsGauge), sizeof(MetricsGauge));
+
+	if(gauge == NULL) {
+		return NULL;
+	}
+
+	for(size_t i = 0; i < METRICS_SHARD_COUNT; ++i) {
+		atomic_init(&(gauge->shards[i].value), 0);
+	}
+
+	if(!register_metrics_entry(name, help, labels, MetricsTypeGauge,
+	                           (MetricsValue){ .gauge = gauge })) {
+		return NULL;
+	}
+
+	return gauge;
+}
+
+NODISCARD bool metrics_register_gauge_callback(const char* const name, const char* const help,
+                                               const MetricsLabels labels,
+                                               const MetricsGaugeCallback callback,
+                                               void* const data) {
+
+	if(callback == NULL) {
+		return false;
+	}
+
+	return register_metrics_entry(
+	    name, help, labels, MetricsTypeGaugeCallback,
+	    (MetricsValue){ .callback = { .callback = callback, .data = data } });
+}
+
+NODISCARD MetricsHistogram* metrics_register_histogram(const char* const name,
+                                                       const char* const help,
+                                                       const MetricsLabels labels,
+                                                       const MetricsHistogramOptions options) {
+
+	if(options.bound_amount > METRICS_HISTOGRAM_MAX_BUCKETS) {
+		LOG_MESSAGE(LogLevelError, "Too many histogram buckets for metric '%s': %zu\n", name,
+		            options.bound_amount);
+		return NULL;
+	}
+
+	for(size_t i = 1; i < options.bound_amount; ++i) {
+		if(options.bounds[i - 1] >= options.bounds[i]) {
+			LOG_MESSAGE(LogLevelError, "The histogram bounds of metric '%s' are not ascending\n",
+			            name);
+			return NULL;
+		}
+	}
+
+	MetricsHistogram* histogram =
+	    aligned_alloc(alignof(MetricsHistogram), sizeof(MetricsHistogram));
+
+	if(histogram == NULL) {
+		return NULL;
+	}
+
+	histogram->bound_amount = options.bound_amount;
+	histogram->scale = options.scale;
+
+	for(size_t i = 0; i < options.bound_amount; ++i) {
+		histogram->bounds[i] = options.bounds[i];
+	}
+
+	for(size_t i = 0; i < METRICS_SHARD_COUNT; ++i) {
+		MetricsHistogramShard* shard = &(histogram->shards[i]);
+
+		atomic_init(&(shard->count), 0);
+		atomic_init(&(shard->sum), 0);
+
+		for(size_t j = 0; j < METRICS_HISTOGRAM_MAX_BUCKETS + 1; ++j) {
+			atomic_init(&(shard->buckets[j]), 0);
+		}
+	}
+
+	if(!register_metrics_entry(name, help, labels, MetricsTypeHistogram,
+	                           (MetricsValue){ .histogram = histogram })) {
+		return NULL;
+	}
+
+	return histogram;
+}
+
+// the hot path only touches the shard of the calling thread, relaxed ordering is enough, as the
+// values don't synchronize anything
+
+void metrics_counter_add(MetricsCounter* const counter, const uint64_t value) {
+
+	if(counter == NULL) {
+		return;
+	}
+
+	atomic_fetch_add_explicit(&(counter->shards[get_metrics_thread_shard()].value), value,
+	                          memory_order_relaxed);
+}
+
+void metrics_counter_increment(MetricsCounter* const counter) {
+	metrics_counter_add(counter, 1);
+}
+
+void metrics_gauge_add(MetricsGauge* const gauge, const int64_t value) {
+
+	if(gauge == NULL) {
+		return;
+	}
+
+	// a shard can get negative, if a thread decrements a value, that another thread incremented,
+	// only the sum is meaningful
+	atomic_fetch_add_explicit(&(gauge->shards[get_metrics_thread_shard()].value), value,
+	                          memory_order_relaxed);
+}
+
+void metrics_histogram_observe(MetricsHistogram* const histogram, const uint64_t value) {
+
+	if(histogram == NULL) {
+		return;
+	}
+
+	// a binary search for the first bound, that is not smaller than the value, as log-linear
+	// histograms have a lot of buckets, if there is none, this is the +Inf bucket
+	size_t bucket = 0;
+	size_t end = histogram->bound_amount;
+
+	while(bucket < end) {
+		const size_t middle = bucket + ((end - bucket) / 2);
+
+		if(histogram->bounds[middle] < value) {
+			bucket = middle + 1;
+		} else {
+			end = middle;
+		}
+	}
+
+	MetricsHistogramShard* shard = &(histogram->shards[get_metrics_thread_shard()]);
+
+	atomic_fetch_add_explicit(&(shard->buckets[bucket]), 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&(shard->sum), value, memory_order_relaxed);
+	atomic_fetch_add_explicit(&(shard->count), 1, memory_order_relaxed);
+}
+
+NODISCARD static uint64_t get_metrics_counter_value(const MetricsCounter* const counter) {
+	uint64_t sum = 0;
+
+	for(size_t i = 0; i < METRICS_SHARD_COUNT; ++i) {
+		sum += atomic_load_explicit(&(counter->shards[i].value), memory_order_relaxed);
+	}
+
+	return sum;
+}
+
+NODISCARD static int64_t get_metrics_gauge_value(const MetricsGauge* const gauge) {
+	int64_t sum = 0;
+
+	for(size_t i = 0; i < METRICS_SHARD_COUNT; ++i) {
+		sum += atomic_load_explicit(&(gauge->shards[i].value), memory_order_relaxed);
+	}
+
+	return sum;
+}
+
+NODISCARD static const char* get_metrics_type_name(const MetricsType type) {
+	switch(type) {
+		case MetricsTypeCounter: return "counter";
+		case MetricsTypeGauge:
+		case MetricsTypeGaugeCallback: return "gauge";
+		case MetricsTypeHistogram: return "histogram";
+		default: return "untyped";
+	}
+}
+
+// the braces are only added, if there are labels, extra_label is appended to the labels of the
+// entry, it can be NULL
+static void append_metrics_sample_name(StringBuilder* const string_builder,
+                                       const MetricsEntry* const entry, const char* const suffix,
+                                       const char* const extra_label) {
+
+	string_builder_append_single(string_builder, entry->name);
+	string_builder_append_single(string_builder, suffix);
+
+	const bool has_labels = entry->labels[0] != '\0';
+
+	if(!has_labels && extra_label == NULL) {
+		return;
+	}
+
+	string_builder_append_single(string_builder, "{");
+	string_builder_append_single(string_builder, entry->labels);
+
+	if(extra_label != NULL) {
+		if(has_labels) {
+			string_builder_append_single(string_builder, ",");
+		}
+		string_builder_append_single(string_builder, extra_label);
+	}
+
+	string_builder_append_single(string_builder, "}");
+}
+
+static void append_metrics_histogram(StringBuilder* const string_builder,
+                                     const MetricsEntry* const entry) {
+
+	const MetricsHistogram* const histogram = entry->value.histogram;
+
+	uint64_t buckets[METRICS_HISTOGRAM_MAX_BUCKETS + 1] = { 0 };
+	uint64_t count = 0;
+	uint64_t sum = 0;
+
+	for(size_t i = 0; i < METRICS_SHARD_COUNT; ++i) {
+		const MetricsHistogramShard* const shard = &(histogram->shards[i]);
+
+		for(size_t j = 0; j < histogram->bound_amount + 1; ++j) {
+			buckets[j] += atomic_load_explicit(&(shard->buckets[j]), memory_order_relaxed);
+		}
+
+		count += atomic_load_explicit(&(shard->count), memory_order_relaxed);
+		sum += atomic_load_explicit(&(shard->sum), memory_order_relaxed);
+	}
+
+	uint64_t cumulative = 0;
+
+	for(size_t i = 0; i < histogram->bound_amount + 1; ++i) {
+		cumulative += buckets[i];
+
+		char* le_label = NULL;
+
+		if(i == histogram->bound_amount) {
+			// the shards are not read at the same instant, this keeps the +Inf bucket and the
+			// count consistent, as required by the format
+			cumulative = count;
+			FORMAT_STRING(&le_label, return;, "%s", "le=\"+Inf\"");
+		} else {
+			FORMAT_STRING(&le_label, return;, "le=\"%g\"",
+			              (double)histogram->bounds[i] * histogram->scale);
+		}
+
+		append_metrics_sample_name(string_builder, entry, "_bucket", le_label);
+		free(le_label);
+
+		STRING_BUILDER_APPENDF(string_builder, return;, " %" PRIu64 "\n", cumulative);
+	}
+
+	append_metrics_sample_name(string_builder, entry, "_sum", NULL);
+	STRING_BUILDER_APPENDF(string_builder, return;, " %.9g\n", (double)sum * histogram->scale);
+
+	append_metrics_sample_name(string_builder, entry, "_count", NULL);
+	STRING_BUILDER_APPENDF(string_builder, return;, " %" PRIu64 "\n", count);
+}
+
+static void append_metrics_entry(StringBuilder* const string_builder,
+                                 const MetricsEntry* const entry) {
+
+	switch(entry->type) {
+		case MetricsTypeCounter: {
+			append_metrics_sample_name(string_builder, entry, "", NULL);
+			STRING_BUILDER_APPENDF(string_builder, return;, " %" PRIu64 "\n",
+			                       get_metrics_counter_value(entry->value.counter));
+			break;
+		}
+		case MetricsTypeGauge: {
+			append_metrics_sample_name(string_builder, entry, "", NULL);
+			STRING_BUILDER_APPENDF(string_builder, return;, " %" PRId64 "\n",
+			                       get_metrics_gauge_value(entry->value.gauge));
+			break;
+		}
+		case MetricsTypeGaugeCallback: {
+			const MetricsGaugeCallbackData callback = entry->value.callback;
+
+			append_metrics_sample_name(string_builder, entry, "", NULL);
+			STRING_BUILDER_APPENDF(string_builder, return;, " %" PRId64 "\n",
+			                       callback.callback(callback.data));
+			break;
+		}
+		case MetricsTypeHistogram: {
+			append_metrics_histogram(string_builder, entry);
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+}
+
+NODISCARD StringBuilder* metrics_to_prometheus_text(void) {
+
+	StringBuilder* string_builder = string_builder_init();
+
+	if(string_builder == NULL) {
+		return NULL;
+	}
+
+	int result = pthread_mutex_lock(&g_metrics_registry.mutex);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to lock the metrics mutex", {
+		free_string_builder(string_builder);
+		return NULL;
+	});
+
+	for(MetricsEntry* entry = g_metrics_registry.first; entry != NULL; entry = entry->next) {
+		entry->exported = false;
+	}
+
+	// all samples of a family have to be next to each other, the amount of metrics is small, so
+	// searching the rest of the list for every family is fine
+	for(MetricsEntry* family = g_metrics_registry.first; family != NULL; family = family->next) {
+
+		if(family->exported) {
+			continue;
+		}
+
+		string_builder_append_single(string_builder, "# HELP ");
+		string_builder_append_single(string_builder, family->name);
+		string_builder_append_single(string_builder, " ");
+		string_builder_append_single(string_builder, family->help);
+		string_builder_append_single(string_builder, "\n# TYPE ");
+		string_builder_append_single(string_builder, family->name);
+		string_builder_append_single(string_builder, " ");
+		string_builder_append_single(string_builder, get_metrics_type_name(family->type));
+		string_builder_append_single(string_builder, "\n");
+
+		for(MetricsEntry* entry = family; entry != NULL; entry = entry->next) {
+			if(entry->exported || strcmp(entry->name, family->name) != 0) {
+				continue;
+			}
+
+			append_metrics_entry(string_builder, entry);
+			entry->exported = true;
+		}
+	}
+
+	result = pthread_mutex_unlock(&g_metrics_registry.mutex);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to unlock the metrics mutex",
+	                       {});
+
+	return string_builder;
+}
+
+void global_free_metrics(void) {
+
+	int result = pthread_mutex_lock(&g_metrics_registry.mutex);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to lock the metrics mutex",
+	                       return;);
+
+	MetricsEntry* entry = g_metrics_registry.first;
+
+	while(entry != NULL) {
+		MetricsEntry* next = entry->next;
+		free_metrics_entry(entry);
+		entry = next;
+	}
+
+	g_metrics_registry.first = NULL;
+	g_metrics_registry.last = NULL;
+
+	result = pthread_mutex_unlock(&g_metrics_registry.mutex);
+	CHECK_FOR_THREAD_ERROR(result, "An Error occurred while trying to unlock the metrics mutex",
+	                       {});
+}
@@ -0,0 +1,97 @@
+
+#pragma once
+
+#include "./string_builder.h"
+#include "./utils.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a process wide registry of counters, gauges and histograms, that can be exported in the
+// prometheus text format
+// every metric is split into shards, every thread writes to its own shard, so that increments on
+// the hot path don't contend on the same cache line, the shards are only summed up, when the
+// metrics are exported
+
+// threads get their shard assigned round robin, if there are more threads than shards, some
+// threads share a shard, which is still correct, as the shards are atomic
+#define METRICS_SHARD_COUNT 16
+
+#define METRICS_CACHE_LINE_SIZE 64
+
+// enough for log-linear buckets, like the ones of the http phase histograms
+#define METRICS_HISTOGRAM_MAX_BUCKETS 192
+
+typedef struct {
+	const char* name;
+	const char* value;
+} MetricsLabel;
+
+// the labels are copied, label_amount can be 0, then labels can be NULL
+typedef struct {
+	const MetricsLabel* labels;
+	size_t label_amount;
+} MetricsLabels;
+
+typedef struct MetricsCounterImpl MetricsCounter;
+
+typedef struct MetricsGaugeImpl MetricsGauge;
+
+typedef struct MetricsHistogramImpl MetricsHistogram;
+
+// called, while the metrics are exported, for values, that are already tracked somewhere else
+typedef int64_t (*MetricsGaugeCallback)(void* data);
+
+typedef struct {
+	// the upper bounds of the buckets, in ascending order, the +Inf bucket is added implicitly
+	const uint64_t* bounds;
+	size_t bound_amount;
+	// the observed values and bounds are multiplied by this on export, e.g. 1e-6 for observing
+	// microseconds and exporting seconds
+	double scale;
+} MetricsHistogramOptions;
+
+// metrics with the same name but different labels are exported as one family, they have to have
+// the same type and should have the same help text
+// all register functions return NULL on error, all functions, that change a value, accept NULL
+// and do nothing in that case
+
+NODISCARD MetricsCounter* metrics_register_counter(const char* name, const char* help,
+                                                   MetricsLabels labels);
+
+NODISCARD MetricsGauge* metrics_register_gauge(const char* name, const char* help,
+                                               MetricsLabels labels);
+
+// the data has to be valid, until global_free_metrics is called
+NODISCARD bool metrics_register_gauge_callback(const char* name, const char* help,
+                                               MetricsLabels labels, MetricsGaugeCallback callback,
+                                               void* data);
+
+NODISCARD MetricsHistogram* metrics_register_histogram(const char* name, const char* help,
+                                                       MetricsLabels labels,
+                                                       MetricsHistogramOptions options);
+
+void metrics_counter_add(MetricsCounter* counter, uint64_t value);
+
+void metrics_counter_increment(MetricsCounter* counter);
+
+void metrics_gauge_add(MetricsGauge* gauge, int64_t value);
+
+void metrics_histogram_observe(MetricsHistogram* histogram, uint64_t value);
+
+// sums up the shards, the values of different shards are not read at the same instant, so this is
+// only a snapshot, returns NULL on error
+NODISCARD StringBuilder* metrics_to_prometheus_text(void);
+
+// see https://prometheus.io/docs/instrumenting/exposition_formats/
+#define METRICS_PROMETHEUS_TEXT_MIME_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+// frees all registered metrics, no metric may be used afterwards
+void global_free_metrics(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,162 @@
+#include "./offload_pool.h"
+#include "generic/helper.h"
+#include "utils/log.h"
+
+#include <stdatomic.h>
+
+#define OFFLOAD_POOL_DEFAULT_MAX_PENDING 64
+
+typedef struct {
+	ThreadPool pool;
+	bool initialized;
+	// running and waiting jobs are limited together, so the queue of the pool never grows beyond
+	// max_pending
+	size_t max_outstanding;
+	_Atomic(size_t) outstanding;
+} OffloadPoolState;
+
+static OffloadPoolState
+    g_offload_pool_state; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+// offloaded functions, that offload work themselves, run that work inline, as waiting on the own
+// pool could dead lock, if all offload threads do that
+static _Thread_local bool
+    g_is_offload_thread = // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    false;
+
+typedef struct {
+	OffloadFunction function;
+	ANY_TYPE(UserType*) argument;
+} OffloadJobArgument;
+
+NODISCARD OffloadPoolOptions get_default_offload_pool_options(void) {
+	return (OffloadPoolOptions){ .threads = 0, .max_pending = OFFLOAD_POOL_DEFAULT_MAX_PENDING };
+}
+
+NODISCARD bool global_initialize_offload_pool(const OffloadPoolOptions options,
+                                              const ThreadPool* const connection_pool) {
+
+	OffloadPoolState* const state = &g_offload_pool_state;
+
+	size_t threads = options.threads;
+
+	if(threads == 0) {
+		// the connection workers use all cores, so the heavy work only gets half of them
+		threads = get_active_cpu_cores() / 2;
+
+		if(threads == 0) {
+			threads = 1;
+		}
+	}
+
+	const CreateResult create_result = pool_create(&(state->pool), threads);
+
+	if(create_result.error != CreateErrorNone) {
+		print_create_error(create_result.error);
+		return false;
+	}
+
+	state->max_outstanding = state->pool.worker_threads_amount + options.max_pending;
+
+	// every outstanding job blocks a connection worker, so at most half of them may wait for the
+	// offload pool, but at least one, so that the work isn't always rejected
+	if(connection_pool != NULL) {
+		size_t max_blocked_workers = connection_pool->worker_threads_amount / 2;
+
+		if(max_blocked_workers == 0) {
+			max_blocked_workers = 1;
+		}
+
+		if(state->max_outstanding > max_blocked_workers) {
+			state->max_outstanding = max_blocked_workers;
+		}
+	}
+
+	atomic_store_explicit(&(state->outstanding), 0, memory_order_relaxed);
+	state->initialized = true;
+
+	LOG_MESSAGE(LogLevelInfo,
+	            "Initialized the offload pool with %zu threads and at most %zu outstanding jobs\n",
+	            state->pool.worker_threads_amount, state->max_outstanding);
+
+	return true;
+}
+
+void global_free_offload_pool(void) {
+
+	OffloadPoolState* const state = &g_offload_pool_state;
+
+	if(!state->initialized) {
+		return;
+	}
+
+	state->initialized = false;
+
+	const GenericResult destroy_result = pool_destroy(&(state->pool));
+
+	IF_GENERIC_RESULT_IS_ERROR_IGN(destroy_result) {
+		LOG_MESSAGE_SIMPLE(LogLevelError, "Couldn't destroy the offload pool\n");
+	}
+}
+
+NODISCARD static ANY_TYPE(JobError*)
+    offload_job_function(ANY_TYPE(OffloadJobArgument*) arg_ign, WorkerInfo worker_info) {
+
+	UNUSED(worker_info);
+
+	const OffloadJobArgument* const argument = (OffloadJobArgument*)arg_ign;
+
+	g_is_offload_thread = true;
+
+	argument->function(argument->argument);
+
+	return JOB_ERROR_NONE;
+}
+
+NODISCARD OffloadResult offload_run(const OffloadFunction function,
+                                    ANY_TYPE(UserType*) const argument) {
+
+	OffloadPoolState* const state = &g_offload_pool_state;
+
+	if(!state->initialized || g_is_offload_thread) {
+		function(argument);
+		return OffloadResultOk;
+	}
+
+	// a full pool rejects at once, as waiting for a free slot would again block the worker
+	const size_t previous_outstanding =
+	    atomic_fetch_add_explicit(&(state->outstanding), 1, memory_order_acq_rel);
+
+	if(previous_outstanding >= state->max_outstanding) {
+		atomic_fetch_sub_explicit(&(state->outstanding), 1, memory_order_acq_rel);
+		return OffloadResultRejected;
+	}
+
+	OffloadJobArgument job_argument = { .function = function, .argument = argument };
+
+	JobId* const job_id = pool_submit(&(state->pool), offload_job_function, &job_argument);
+
+	if(is_submit_error((SubmitError)job_id)) {
+		print_submit_error((SubmitError)job_id);
+		atomic_fetch_sub_explicit(&(state->outstanding), 1, memory_order_acq_rel);
+		return OffloadResultError;
+	}
+
+	const JobError job_result = pool_await(job_id);
+
+	atomic_fetch_sub_explicit(&(state->outstanding), 1, memory_order_acq_rel);
+
+	if(job_result != JOB_ERROR_NONE) {
+		if(is_job_error(job_result)) {
+			print_job_error(job_result);
+		}
+
+		return OffloadResultError;
+	}
+
+	return OffloadResultOk;
+}
+
+NODISCARD size_t offload_pool_get_outstanding_jobs(void) {
+	return atomic_load_explicit(&(g_offload_pool_state.outstanding), memory_order_relaxed);
+}
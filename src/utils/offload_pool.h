@@ -0,0 +1,56 @@
+#pragma once
+
+#include "./thread_pool.h"
+#include "./utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a separate, bounded pool for blocking or cpu heavy work (password hashing, pam, big file reads,
+// high compression levels), the connection worker hands such work over and waits for it, so a
+// burst of that work can tie up at most threads + max_pending connection workers, this is capped
+// to half of the connection workers, so that the others stay free for cheap requests
+
+typedef struct {
+	// amount of offload threads, 0 means half of the cpu cores, but at least one
+	size_t threads;
+	// amount of jobs, that may wait for a free offload thread, further jobs are rejected
+	size_t max_pending;
+} OffloadPoolOptions;
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	// the function was run, either by the pool or inline, if no pool is initialized
+	OffloadResultOk = 0,
+	// the pool is full, the function was NOT run, the caller has to shed the work or degrade it
+	OffloadResultRejected,
+	// the function was NOT run, because of an internal error
+	OffloadResultError,
+} OffloadResult;
+
+typedef void (*OffloadFunction)(ANY_TYPE(UserType*));
+
+NODISCARD OffloadPoolOptions get_default_offload_pool_options(void);
+
+// has to be called before any worker offloads work, if it isn't called or failed, all offloaded
+// functions are run inline, the connection pool is only used to cap the running and waiting jobs,
+// if it is NULL, only the options cap them
+NODISCARD bool global_initialize_offload_pool(OffloadPoolOptions options,
+                                              const ThreadPool* connection_pool);
+
+// has to be called after all workers, that may offload work, are finished
+void global_free_offload_pool(void);
+
+// runs the function on the offload pool and waits for it to finish, the argument is only used
+// while this call runs, so it can live on the stack of the caller
+NODISCARD OffloadResult offload_run(OffloadFunction function, ANY_TYPE(UserType*) argument);
+
+// returns the amount of offloaded jobs, that are running or waiting, only a snapshot
+NODISCARD size_t offload_pool_get_outstanding_jobs(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,6 +6,10 @@
 
 #include <tstr.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 NODISCARD tstr get_serve_folder(const tstr* folder_to_resolve);
 
 NODISCARD bool file_is_absolute(const char* file);
@@ -13,3 +17,7 @@ NODISCARD bool file_is_absolute(const char* file);
 NODISCARD void* read_entire_file(const char* file_path, OUT_PARAM(size_t) out_len);
 
 NODISCARD bool get_file_size_of_file(const char* file_path, OUT_PARAM(size_t) out_len);
+
+#ifdef __cplusplus
+}
+#endif
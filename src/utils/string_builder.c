@@ -85,6 +85,11 @@ GenericResult string_builder_append_tstr(StringBuilder* const string_builder,
 	return string_builder_append_string_impl(string_builder, tstr_cstr(str), tstr_len(str));
 }
 
+GenericResult string_builder_append_buffer(StringBuilder* const string_builder,
+                                           const ReadonlyBuffer buffer) {
+	return string_builder_append_string_impl(string_builder, (const char*)buffer.data, buffer.size);
+}
+
 GenericResult string_builder_append_string_builder(StringBuilder* const string_builder,
                                                    StringBuilder** const string_builder2) {
 
@@ -43,6 +43,9 @@ GenericResult string_builder_append_tstr_static(StringBuilder* string_builder,
 
 GenericResult string_builder_append_tstr(StringBuilder* string_builder, const tstr* str);
 
+// appends raw bytes, they may contain 0 bytes, the size of the builder then also includes them
+GenericResult string_builder_append_buffer(StringBuilder* string_builder, ReadonlyBuffer buffer);
+
 NODISCARD char* string_builder_release_into_string(StringBuilder** string_builder);
 
 NODISCARD size_t string_builder_get_string_size(const StringBuilder* string_builder);
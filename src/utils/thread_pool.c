@@ -79,9 +79,13 @@ thread_pool_worker_thread_function(ANY_TYPE(my_thread_pool_ThreadArgument*) cons
 			break;
 		}
 
+		atomic_fetch_add_explicit(&(argument.thread_pool->busy_workers), 1, memory_order_relaxed);
+
 		// otherwise it just calls the function, and therefore executes it
 		ANY_TYPE(JobResult)
 		return_value = current_job->job_function(current_job->argument, argument.worker_info);
+
+		atomic_fetch_sub_explicit(&(argument.thread_pool->busy_workers), 1, memory_order_relaxed);
 		// atm a warning issued, when a functions returns something other than NULL, but thats
 		// only there, to show that it doesn't get returned, it wouldn't be that big of a deal to
 		// implement this, but it isn't needed and required
@@ -146,6 +150,8 @@ CreateResult pool_create(ThreadPool* const pool, const size_t size) { // NOLINT(
 	pool->fns = (LifecycleFunctions){ .startup_fn = thread_pool_worker_thread_startup_function,
 		                              .shutdown_fn = thread_pool_worker_thread_shutdown_function };
 
+	atomic_init(&(pool->busy_workers), 0);
+
 	if(!pool->worker_threads) {
 		LOG_MESSAGE_SIMPLE(COMBINE_LOG_FLAGS(LogLevelWarn, LogPrintLocation),
 		                   "Couldn't allocate memory!\n");
@@ -292,6 +298,26 @@ ANY_TYPE(JobResult) pool_await(JobId* job_description) {
 	return JOB_ERROR_INVALID_JOB;
 }
 
+size_t pool_get_busy_workers(const ThreadPool* const pool) {
+	return atomic_load_explicit(&(pool->busy_workers), memory_order_relaxed);
+}
+
+void pool_mark_worker_idle(ThreadPool* const pool) {
+	atomic_fetch_sub_explicit(&(pool->busy_workers), 1, memory_order_relaxed);
+}
+
+void pool_mark_worker_busy(ThreadPool* const pool) {
+	atomic_fetch_add_explicit(&(pool->busy_workers), 1, memory_order_relaxed);
+}
+
+bool pool_has_pending_jobs(ThreadPool* const pool) {
+	return !tqueue_is_empty(&(pool->job_queue));
+}
+
+size_t pool_get_pending_jobs_amount(ThreadPool* const pool) {
+	return tqueue_get_size(&(pool->job_queue));
+}
+
 // destroys the thread_pool, has to be called AFTER all jobs where awaited, otherwise it'S undefined
 // behaviour! this cn also block, until all jobs are finished
 GenericResult pool_destroy(ThreadPool* const pool) {
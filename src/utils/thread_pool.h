@@ -1,6 +1,7 @@
 #pragma once
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -44,6 +45,9 @@ typedef struct {
 	MyThreadPoolThreadInformation* worker_threads;
 	LifecycleFunctions fns;
 	SemaphoreType jobs_available;
+	// amount of workers that are currently executing a job, used as a cheap load indicator,
+	// workers, whose job waits idle, aren't counted, see pool_mark_worker_idle
+	_Atomic(size_t) busy_workers;
 } ThreadPool;
 
 typedef struct JobIdImpl JobId;
@@ -88,6 +92,24 @@ NODISCARD JobId* pool_submit(ThreadPool* pool, JobFunction start_routine, ANY_TY
 // printing a warning if its _THREAD_SHUTDOWN_JOB
 NODISCARD ANY_TYPE(JobResult*) pool_await(JobId* job_description);
 
+// returns the amount of workers currently executing a job, this is only a snapshot, as the value
+// may change right after reading it
+NODISCARD size_t pool_get_busy_workers(const ThreadPool* pool);
+
+// called by a job, that waits idle for a longer time, e.g. a keep-alive connection, that waits for
+// the next request, so that its worker isn't counted as busy in that time, it has to be paired with
+// pool_mark_worker_busy, before the job continues
+void pool_mark_worker_idle(ThreadPool* pool);
+
+void pool_mark_worker_busy(ThreadPool* pool);
+
+// returns true, if there are submitted jobs, that no worker has picked up yet, this is also only a
+// snapshot
+NODISCARD bool pool_has_pending_jobs(ThreadPool* pool);
+
+// returns the amount of submitted jobs, that no worker has picked up yet, also only a snapshot
+NODISCARD size_t pool_get_pending_jobs_amount(ThreadPool* pool);
+
 // destroys the thread_pool, has to be called AFTER all jobs where awaited, otherwise it'S undefined
 // behaviour! this cn also block, until all jobs are finished
 NODISCARD GenericResult pool_destroy(ThreadPool* pool);
@@ -37,6 +37,18 @@ bool tqueue_is_empty(TQueue* queue) {
 	return empty;
 }
 
+size_t tqueue_get_size(TQueue* queue) {
+	int result = comp_sem_wait(&(queue->can_access));
+	CHECK_FOR_ERROR(result, "Couldn't wait for the internal queue Semaphore", return 0;);
+
+	const size_t size = queue->size;
+
+	// now say that it can be accessed
+	result = comp_sem_post(&(queue->can_access));
+	CHECK_FOR_ERROR(result, "Couldn't post the internal queue Semaphore", return 0;);
+	return size;
+}
+
 // not checked for error code of malloc :(
 // modified to use void * instead of int as stored value
 GenericResult tqueue_push(TQueue* queue, void* value) {
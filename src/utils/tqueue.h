@@ -43,6 +43,9 @@ NODISCARD GenericResult tqueue_destroy(TQueue* queue);
 
 NODISCARD bool tqueue_is_empty(TQueue* queue);
 
+// returns 0 on error
+NODISCARD size_t tqueue_get_size(TQueue* queue);
+
 // not checked for error code of malloc :(
 // modified to use void * instead of int as stored value
 NODISCARD GenericResult tqueue_push(TQueue* queue, void* value);
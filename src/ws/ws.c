@@ -222,9 +222,11 @@ GenericResult handle_ws_handshake(const HttpRequest http_request,
 	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, http_request.head.header_fields); ++i) {
 		const HttpHeaderField header = TVEC_AT(HttpHeaderField, http_request.head.header_fields, i);
 
-		if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(host))) {
+		const HttpHeaderToken token = get_http_header_field_token(&header);
+
+		if(token == HttpHeaderTokenHost) {
 			found_list |= HandshakeHeaderHeaderHost;
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(upgrade))) {
+		} else if(token == HttpHeaderTokenUpgrade) {
 			found_list |= HandshakeHeaderHeaderUpgrade;
 
 			WsHeaderProcessArg process_arg = {
@@ -240,7 +242,7 @@ GenericResult handle_ws_handshake(const HttpRequest http_request,
 				                                     "upgrade does not contain 'websocket'",
 				                                     send_settings);
 			}
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(connection))) {
+		} else if(token == HttpHeaderTokenConnection) {
 			found_list |= HandshakeHeaderHeaderConnection;
 
 			WsHeaderProcessArg process_arg = {
@@ -261,8 +263,7 @@ GenericResult handle_ws_handshake(const HttpRequest http_request,
 				                                     "connection does not contain 'upgrade'",
 				                                     send_settings);
 			}
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key,
-		                                          HTTP_HEADER_NAME(ws_sec_websocket_key))) {
+		} else if(token == HttpHeaderTokenSecWebsocketKey) {
 			found_list |= HandshakeHeaderHeaderSecWebsocketKey;
 			if(is_valid_sec_key(&header.value)) {
 				sec_key = header.value;
@@ -270,23 +271,21 @@ GenericResult handle_ws_handshake(const HttpRequest http_request,
 				return send_failed_handshake_message(descriptor, general_context,
 				                                     "sec-websocket-key is invalid", send_settings);
 			}
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key,
-		                                          HTTP_HEADER_NAME(ws_sec_websocket_version))) {
+		} else if(token == HttpHeaderTokenSecWebsocketVersion) {
 			found_list |= HandshakeHeaderHeaderSecWebsocketVersion;
 			if(!tstr_eq_cstr(&header.value, "13")) {
 				return send_failed_handshake_message(descriptor, general_context,
 				                                     "sec-websocket-version has invalid value",
 				                                     send_settings);
 			}
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key,
-		                                          HTTP_HEADER_NAME(ws_sec_websocket_extensions))) {
+		} else if(token == HttpHeaderTokenSecWebsocketExtensions) {
 			// TODO(Totto): this header field may be specified multiple times, but we should
 			// combine all and than parse it, but lets see if the autobahn test suite tests for
 			// that first
 			// TODO: normalize headers in some place!
 			parse_ws_extensions(extensions, tstr_as_view(&header.value));
 
-		} else if(tstr_eq_ignore_case_static_tstr(&header.key, HTTP_HEADER_NAME(origin))) {
+		} else if(token == HttpHeaderTokenOrigin) {
 			from_browser = true;
 		} else {
 			// do nothing
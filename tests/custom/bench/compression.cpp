@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+
+#include <http/compression.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <support/helpers/cpp_types.hpp>
+
+// every supported compression format is crossed with some levels and payloads, the throughput is
+// reported as bytes of the uncompressed payload per second and the ratio as uncompressed size
+// divided by compressed size, so the negotiation and the levels of the compression policy can be
+// chosen on data
+
+namespace {
+
+struct CompressionBenchPayload {
+	std::string name;
+	std::string content;
+};
+
+struct CompressionBenchFormat {
+	CompressionType format;
+	std::vector<int> levels;
+};
+
+// the contents are generated with a fixed seed, so that the results are comparable between runs
+
+std::string get_html_payload() {
+	std::string result =
+	    "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n<meta charset=\"utf-8\">\n"
+	    "<title>Index of /files/</title>\n<link rel=\"stylesheet\" href=\"/style.css\">\n"
+	    "</head>\n<body>\n<h1>Index of /files/</h1>\n<table class=\"listing\">\n"
+	    "<tr><th>Name</th><th>Size</th><th>Last modified</th></tr>\n";
+
+	std::mt19937 generator{ 42 }; // NOLINT(readability-magic-numbers)
+	std::uniform_int_distribution<uint32_t> size_distribution{ 0, 10'000'000 };
+	std::uniform_int_distribution<uint32_t> day_distribution{ 1, 28 };
+
+	for(size_t i = 0; i < 256; ++i) { // NOLINT(readability-magic-numbers)
+		const std::string name = "document_" + std::to_string(i) + ".txt";
+		const std::string day = std::to_string(day_distribution(generator));
+
+		result += "<tr><td><a href=\"/files/" + name + "\">" + name + "</a></td><td>" +
+		          std::to_string(size_distribution(generator)) + "</td><td>2024-05-" + day +
+		          " 12:00</td></tr>\n";
+	}
+
+	result += "</table>\n</body>\n</html>\n";
+
+	return result;
+}
+
+std::string get_json_payload() {
+	std::string result = "[";
+
+	std::mt19937 generator{ 1337 }; // NOLINT(readability-magic-numbers)
+	std::uniform_int_distribution<uint32_t> id_distribution{ 0, 1'000'000 };
+	std::uniform_real_distribution<double> score_distribution{ 0.0, 100.0 };
+	std::uniform_int_distribution<uint32_t> bool_distribution{ 0, 1 };
+
+	for(size_t i = 0; i < 512; ++i) { // NOLINT(readability-magic-numbers)
+		if(i != 0) {
+			result += ",";
+		}
+
+		result += "{\"id\":" + std::to_string(id_distribution(generator)) + ",\"name\":\"user_" +
+		          std::to_string(i) + "\",\"email\":\"user_" + std::to_string(i) +
+		          "@example.com\",\"score\":" + std::to_string(score_distribution(generator)) +
+		          ",\"active\":" + (bool_distribution(generator) == 0 ? "false" : "true") +
+		          ",\"roles\":[\"reader\",\"writer\"]}";
+	}
+
+	result += "]";
+
+	return result;
+}
+
+// random bytes behave like an already compressed body, e.g. an image or an archive
+std::string get_compressed_payload() {
+	std::string result(64 * 1024, '\0'); // NOLINT(readability-magic-numbers)
+
+	std::mt19937 generator{ 7 }; // NOLINT(readability-magic-numbers)
+	std::uniform_int_distribution<uint32_t> byte_distribution{ 0, 255 };
+
+	for(char& character : result) {
+		character = static_cast<char>(byte_distribution(generator));
+	}
+
+	return result;
+}
+
+const std::vector<CompressionBenchPayload>& get_compression_bench_payloads() {
+	static const std::vector<CompressionBenchPayload> payloads = {
+		{ .name = "html", .content = get_html_payload() },
+		{ .name = "json", .content = get_json_payload() },
+		{ .name = "compressed", .content = get_compressed_payload() },
+		{ .name = "tiny", .content = "{\"ok\":true}" },
+	};
+
+	return payloads;
+}
+
+// the fastest, the built-in default and the best level, compress has no levels
+// NOLINTBEGIN(readability-magic-numbers)
+const std::vector<CompressionBenchFormat> compression_bench_formats = {
+	{ .format = CompressionTypeGzip, .levels = { 1, 6, 9 } },
+	{ .format = CompressionTypeDeflate, .levels = { 1, 6, 9 } },
+	{ .format = CompressionTypeBr, .levels = { 1, 5, 11 } },
+	{ .format = CompressionTypeZstd, .levels = { 1, 3, 19 } },
+	{ .format = CompressionTypeCompress, .levels = { COMPRESSION_LEVEL_DEFAULT } },
+};
+// NOLINTEND(readability-magic-numbers)
+
+void BM_compression(benchmark::State& state, const CompressionType format, const int level,
+                    const std::string& content) {
+
+	// the buffer is only read from
+	const SizedBuffer input = { .data = const_cast<char*>(content.data()), .size = content.size() };
+
+	size_t compressed_size = 0;
+
+	for(auto _ : state) {
+		const SizedBuffer result = compress_buffer_with_level(input, format, level);
+
+		if(result.data == nullptr) {
+			state.SkipWithError("compression failed");
+			break;
+		}
+
+		compressed_size = result.size;
+
+		free_sized_buffer(result);
+	}
+
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+	                        static_cast<int64_t>(content.size()));
+
+	state.counters["size"] = static_cast<double>(content.size());
+	state.counters["compressed_size"] = static_cast<double>(compressed_size);
+	state.counters["ratio"] = compressed_size == 0 ? 0.0
+	                                               : static_cast<double>(content.size()) /
+	                                                     static_cast<double>(compressed_size);
+}
+
+bool register_compression_benchmarks() {
+
+	for(const CompressionBenchFormat& format : compression_bench_formats) {
+		if(!is_compression_supported(format.format)) {
+			continue;
+		}
+
+		const std::string format_name =
+		    string_from_tstr(get_string_for_compress_format(format.format));
+
+		for(const int level : format.levels) {
+			const std::string level_name =
+			    level == COMPRESSION_LEVEL_DEFAULT ? "default" : std::to_string(level);
+
+			for(const CompressionBenchPayload& payload : get_compression_bench_payloads()) {
+				const std::string name =
+				    "compression/" + format_name + "/" + level_name + "/" + payload.name;
+
+				benchmark::RegisterBenchmark(name.c_str(), BM_compression, format.format, level,
+				                             payload.content);
+			}
+		}
+	}
+
+	return true;
+}
+
+// the benchmarks are registered before main runs, like the ones of the BENCHMARK macro
+[[maybe_unused]] const bool compression_benchmarks_registered = register_compression_benchmarks();
+
+} // namespace
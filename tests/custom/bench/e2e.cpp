@@ -0,0 +1,754 @@
+#include <benchmark/benchmark.h>
+
+#include <generic/authentication.h>
+#include <generic/ip.h>
+#include <generic/secure.h>
+#include <http/compression_policy.h>
+#include <http/hpack.h>
+#include <http/routes.h>
+#include <http/server.h>
+#include <http/server_metrics.h>
+#include <utils/log.h>
+#include <utils/path.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <support/helpers/cpp_types.hpp>
+
+// these benchmarks run a whole connection through http_socket_connection_handler, the client end
+// of a socketpair sends a single request and then closes its write side, so that every layer
+// (reading, parsing, routing, executing, compressing, serializing and writing) is measured, but
+// nothing outside of the process, the socketpairs are created outside of the measured time and the
+// response is read by one persistent thread
+
+enum class E2EProtocol : uint8_t {
+	Http1,
+	// http2 over cleartext with prior knowledge
+	H2c,
+};
+
+using E2EHeaders = std::vector<std::pair<std::string, std::string>>;
+
+namespace {
+
+constexpr const char* e2e_authority = "localhost";
+
+// the user of the default simple authentication provider in main.c, as "admin:admin" in base64
+constexpr const char* e2e_basic_authorization = "Basic YWRtaW46YWRtaW4=";
+
+// the default of SETTINGS_HEADER_TABLE_SIZE, see RFC 9113 6.5.2
+constexpr size_t e2e_header_table_size = 4096;
+
+constexpr const std::array<size_t, 3> e2e_file_sizes = { 1024, 64 * 1024, 1024 * 1024 };
+
+struct E2ESocketPair {
+	int client_fd;
+	int server_fd;
+};
+
+// socketpairs are created in batches outside of the measured time, every connection needs a new
+// one, as the handler closes the server end
+class E2ESocketPairs {
+  private:
+	std::vector<E2ESocketPair> m_pairs;
+
+  public:
+	E2ESocketPairs() : m_pairs{} {}
+
+	E2ESocketPairs(E2ESocketPairs&&) = delete;
+
+	E2ESocketPairs(const E2ESocketPairs&) = delete;
+
+	E2ESocketPairs& operator=(const E2ESocketPairs&) = delete;
+
+	E2ESocketPairs operator=(E2ESocketPairs&&) = delete;
+
+	~E2ESocketPairs() {
+		for(const E2ESocketPair& pair : m_pairs) {
+			close(pair.client_fd);
+			close(pair.server_fd);
+		}
+	}
+
+	[[nodiscard]] bool empty() const { return m_pairs.empty(); }
+
+	[[nodiscard]] bool refill(const size_t amount) {
+		for(size_t i = 0; i < amount; ++i) {
+			int fds[2] = { -1, -1 };
+
+			if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+				return false;
+			}
+
+			m_pairs.push_back(E2ESocketPair{ .client_fd = fds[0], .server_fd = fds[1] });
+		}
+
+		return true;
+	}
+
+	[[nodiscard]] E2ESocketPair pop() {
+		const E2ESocketPair pair = m_pairs.back();
+		m_pairs.pop_back();
+		return pair;
+	}
+};
+
+// reads the response of one connection after another on the same thread, so that no thread is
+// created per connection, the response buffer is reused as well
+class E2EResponseReader {
+  private:
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	int m_fd;
+	bool m_finished;
+	bool m_stop;
+	std::string m_response;
+	std::thread m_thread;
+
+	void run() {
+		std::array<char, 64 * 1024> buffer{};
+
+		std::unique_lock<std::mutex> lock{ m_mutex };
+
+		while(true) {
+			m_condition.wait(lock, [this]() { return m_stop || m_fd >= 0; });
+
+			if(m_stop) {
+				return;
+			}
+
+			const int fd = m_fd;
+
+			// the response is only accessed by the owner, after the read finished
+			lock.unlock();
+
+			while(true) {
+				const ssize_t result = recv(fd, buffer.data(), buffer.size(), 0);
+
+				if(result <= 0) {
+					break;
+				}
+
+				m_response.append(buffer.data(), static_cast<size_t>(result));
+			}
+
+			lock.lock();
+
+			m_fd = -1;
+			m_finished = true;
+			m_condition.notify_all();
+		}
+	}
+
+  public:
+	E2EResponseReader()
+	    : m_mutex{},
+	      m_condition{},
+	      m_fd{ -1 },
+	      m_finished{ false },
+	      m_stop{ false },
+	      m_response{},
+	      m_thread{ [this]() { run(); } } {}
+
+	E2EResponseReader(E2EResponseReader&&) = delete;
+
+	E2EResponseReader(const E2EResponseReader&) = delete;
+
+	E2EResponseReader& operator=(const E2EResponseReader&) = delete;
+
+	E2EResponseReader operator=(E2EResponseReader&&) = delete;
+
+	~E2EResponseReader() {
+		{
+			const std::lock_guard<std::mutex> lock{ m_mutex };
+			m_stop = true;
+		}
+
+		m_condition.notify_all();
+		m_thread.join();
+	}
+
+	// reads from the fd until the end of the stream
+	void start(const int fd) {
+		{
+			const std::lock_guard<std::mutex> lock{ m_mutex };
+			m_response.clear();
+			m_finished = false;
+			m_fd = fd;
+		}
+
+		m_condition.notify_all();
+	}
+
+	// the response is valid until the next start
+	[[nodiscard]] const std::string& wait() {
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_condition.wait(lock, [this]() { return m_finished; });
+		return m_response;
+	}
+};
+
+class E2EServer {
+  private:
+	SecureOptions* m_options;
+	ConnectionContextPtrs m_contexts;
+	AuthenticationProviders* m_auth_providers;
+	RouteManager* m_route_manager;
+	std::filesystem::path m_root_folder;
+	tstr m_serve_folder;
+
+	void create_files() {
+		std::filesystem::create_directories(m_root_folder / "files");
+
+		const std::string line = "The quick brown fox jumps over the lazy dog.\n";
+
+		for(const size_t size : e2e_file_sizes) {
+			std::ofstream file(m_root_folder / "files" / get_file_name(size), std::ios::binary);
+
+			for(size_t written = 0; written < size; written += line.size()) {
+				file << line.substr(0, std::min(line.size(), size - written));
+			}
+		}
+	}
+
+  public:
+	E2EServer()
+	    : m_options{ initialize_secure_options(false, tstr_static_null(), tstr_static_null()) },
+	      m_contexts{ TVEC_EMPTY(ConnectionContextPtr) },
+	      m_auth_providers{ initialize_authentication_providers() },
+	      m_route_manager{ nullptr },
+	      m_root_folder{ std::filesystem::temp_directory_path() /
+	                     ("simple_http_server_e2e_bench_" + std::to_string(getpid())) },
+	      m_serve_folder{ tstr_null() } {
+
+		// every request would be logged otherwise
+		set_log_level(LogLevelError);
+
+		if(m_options == nullptr || m_auth_providers == nullptr) {
+			throw std::runtime_error("Couldn't initialize the secure options or auth providers");
+		}
+
+		ConnectionContext* context = get_connection_context(m_options);
+
+		if(context == nullptr ||
+		   TVEC_PUSH(ConnectionContextPtr, &m_contexts, context) != TvecResultOk) {
+			throw std::runtime_error("Couldn't initialize the connection context");
+		}
+
+#ifdef _SIMPLE_SERVER_HAVE_BCRYPT
+		AuthenticationProvider* simple_auth_provider = initialize_simple_authentication_provider();
+
+		if(simple_auth_provider == nullptr) {
+			throw std::runtime_error("Couldn't initialize the simple auth provider");
+		}
+
+		tstr username = tstr_from_string("admin");
+		tstr password = tstr_from_string("admin");
+
+		const bool added = add_user_to_simple_authentication_provider_data_password_raw(
+		    simple_auth_provider, &username, &password, UserRoleAdmin);
+
+		tstr_free(&username);
+		tstr_free(&password);
+
+		if(!added || !add_authentication_provider(m_auth_providers, simple_auth_provider)) {
+			free_authentication_provider(simple_auth_provider);
+			throw std::runtime_error("Couldn't add the user to the simple auth provider");
+		}
+#endif
+
+		create_files();
+
+		tstr root_folder = tstr_from_string(m_root_folder.string());
+
+		m_serve_folder = get_serve_folder(&root_folder);
+
+		tstr_free(&root_folder);
+
+		if(tstr_is_null(&m_serve_folder)) {
+			throw std::runtime_error("Couldn't resolve the folder of the static files");
+		}
+
+		HTTPRoutes* routes = get_default_routes();
+
+		if(routes == nullptr) {
+			throw std::runtime_error("Couldn't get the default routes");
+		}
+
+		// the request path is appended to the folder, so the files are in "<folder>/files/"
+		HTTPRoute files_route = {
+			.method = HTTPRequestRouteMethodGet,
+			.path = { .type = HTTPRoutePathTypeStartsWith, .data = "/files" },
+			.data = { .type = HTTPRouteTypeServeFolder,
+			          .value = { .serve_folder = { .type = HTTPRouteServeFolderTypeAbsolute,
+			                                       .folder_path = m_serve_folder } } },
+			.auth = { .type = HTTPAuthorizationTypeNone, .data = {} },
+			.cache = {},
+			.concurrency = {},
+		};
+
+		if(TVEC_PUSH(HTTPRoute, &routes->routes, files_route) != TvecResultOk) {
+			throw std::runtime_error("Couldn't add the static files route");
+		}
+
+		// the same order as in start_http_server, the route metrics need the global metrics
+		global_initialize_http_global_data();
+
+		global_initialize_compression_policy(get_default_compression_policy(), nullptr);
+
+		global_initialize_http_server_metrics(nullptr);
+
+		m_route_manager = initialize_route_manager(routes, m_auth_providers);
+
+		if(m_route_manager == nullptr) {
+			throw std::runtime_error("Couldn't initialize the route manager");
+		}
+
+		route_manager_prebuild_responses(m_route_manager);
+	}
+
+	E2EServer(E2EServer&&) = delete;
+
+	E2EServer(const E2EServer&) = delete;
+
+	E2EServer& operator=(const E2EServer&) = delete;
+
+	E2EServer operator=(E2EServer&&) = delete;
+
+	~E2EServer() {
+		free_route_manager(m_route_manager);
+
+		free_authentication_providers(m_auth_providers);
+
+		for(size_t i = 0; i < TVEC_LENGTH(ConnectionContextPtr, m_contexts); ++i) {
+			free_connection_context(TVEC_AT(ConnectionContextPtr, m_contexts, i));
+		}
+
+		TVEC_FREE(ConnectionContextPtr, &m_contexts);
+
+		free_secure_options(m_options);
+
+		global_free_http_server_metrics();
+
+		global_free_compression_policy();
+
+		global_free_http_global_data();
+
+		tstr_free(&m_serve_folder);
+
+		std::error_code error_code;
+		std::filesystem::remove_all(m_root_folder, error_code);
+	}
+
+	[[nodiscard]] static std::string get_file_name(const size_t size) {
+		return "file_" + std::to_string(size) + ".txt";
+	}
+
+	// the response is read by the reader, returns false, if the handler failed
+	[[nodiscard]] bool run_connection(const std::string& request, const E2ESocketPair socket_pair,
+	                                  E2EResponseReader& reader) const {
+
+		const int client_fd = socket_pair.client_fd;
+
+		// the request is small enough for the socket buffer, so it can be sent upfront, the
+		// response is read concurrently, as it may not fit into the socket buffer
+		for(size_t sent = 0; sent < request.size();) {
+			const ssize_t result =
+			    send(client_fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+
+			if(result <= 0) {
+				close(client_fd);
+				close(socket_pair.server_fd);
+				return false;
+			}
+
+			sent += static_cast<size_t>(result);
+		}
+
+		shutdown(client_fd, SHUT_WR);
+
+		reader.start(client_fd);
+
+		auto* argument =
+		    static_cast<HTTPConnectionArgument*>(malloc(sizeof(HTTPConnectionArgument)));
+
+		if(argument == nullptr) {
+			shutdown(client_fd, SHUT_RDWR);
+			UNUSED(reader.wait());
+			close(client_fd);
+			close(socket_pair.server_fd);
+			return false;
+		}
+
+		*argument = {
+			.contexts = m_contexts,
+			.listener_thread = pthread_self(),
+			.connection_fd = socket_pair.server_fd,
+			.web_socket_manager = nullptr,
+			.route_manager = m_route_manager,
+			.address = from_ipv4(in_addr{ .s_addr = htonl(INADDR_LOOPBACK) }),
+			.pool = nullptr,
+			.reader_settings = get_default_http_reader_settings(),
+			.accepted_at_us = 0,
+		};
+
+		// the argument is freed and the server end is closed by the handler
+		const JobError job_error = http_socket_connection_handler(argument, WorkerInfo{ 0 });
+
+		if(job_error != JOB_ERROR_NONE) {
+			// the server end may still be open, this unblocks the reader in any case
+			shutdown(client_fd, SHUT_RDWR);
+		}
+
+		UNUSED(reader.wait());
+		close(client_fd);
+
+		return job_error == JOB_ERROR_NONE;
+	}
+};
+
+E2EServer& get_e2e_server() {
+	static E2EServer server{};
+	return server;
+}
+
+void append_http2_frame(std::string& result, const uint8_t type, const uint8_t flags,
+                        const uint32_t stream_identifier, const std::string& payload) {
+
+	// NOLINTBEGIN(readability-magic-numbers)
+	const std::array<uint8_t, 9> header = {
+		static_cast<uint8_t>(payload.size() >> 16),
+		static_cast<uint8_t>(payload.size() >> 8),
+		static_cast<uint8_t>(payload.size()),
+		type,
+		flags,
+		static_cast<uint8_t>((stream_identifier >> 24) & 0x7F),
+		static_cast<uint8_t>(stream_identifier >> 16),
+		static_cast<uint8_t>(stream_identifier >> 8),
+		static_cast<uint8_t>(stream_identifier),
+	};
+	// NOLINTEND(readability-magic-numbers)
+
+	result.append(reinterpret_cast<const char*>(header.data()), header.size());
+	result.append(payload);
+}
+
+// a literal header field without indexing and with a new name, without huffman encoding, see
+// RFC 7541 6.2.2, all names and values here are shorter than 127 bytes
+void append_hpack_literal(std::string& result, const std::string& name, const std::string& value) {
+	assert(name.size() < 127 && value.size() < 127); // NOLINT(readability-magic-numbers)
+
+	result.push_back('\0');
+	result.push_back(static_cast<char>(name.size()));
+	result.append(name);
+	result.push_back(static_cast<char>(value.size()));
+	result.append(value);
+}
+
+std::string get_e2e_request(const E2EProtocol protocol, const std::string& path,
+                            const E2EHeaders& headers) {
+
+	std::string result{};
+
+	if(protocol == E2EProtocol::Http1) {
+		result += "GET " + path + " HTTP/1.1\r\n";
+		result += "Host: " + std::string{ e2e_authority } + "\r\n";
+
+		for(const auto& [name, value] : headers) {
+			result += name + ": " + value + "\r\n";
+		}
+
+		result += "Connection: close\r\n\r\n";
+		return result;
+	}
+
+	// NOLINTBEGIN(readability-magic-numbers)
+	constexpr uint8_t frame_type_headers = 0x1;
+	constexpr uint8_t frame_type_settings = 0x4;
+	constexpr uint8_t frame_type_goaway = 0x7;
+	constexpr uint8_t flag_end_stream = 0x1;
+	constexpr uint8_t flag_end_headers = 0x4;
+	// NOLINTEND(readability-magic-numbers)
+
+	result += "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+	append_http2_frame(result, frame_type_settings, 0, 0, "");
+
+	std::string header_block{};
+	append_hpack_literal(header_block, ":method", "GET");
+	append_hpack_literal(header_block, ":scheme", "http");
+	append_hpack_literal(header_block, ":authority", e2e_authority);
+	append_hpack_literal(header_block, ":path", path);
+
+	for(const auto& [name, value] : headers) {
+		std::string lower_name = name;
+
+		for(char& character : lower_name) {
+			character = static_cast<char>(tolower(character));
+		}
+
+		append_hpack_literal(header_block, lower_name, value);
+	}
+
+	append_http2_frame(result, frame_type_headers, flag_end_stream | flag_end_headers, 1,
+	                   header_block);
+
+	// last stream identifier 1 and NO_ERROR, so that the server closes the connection after the
+	// response
+	append_http2_frame(result, frame_type_goaway, 0, 0, std::string{ "\0\0\0\1\0\0\0\0", 8 });
+
+	return result;
+}
+
+// the status of the response on stream 1, the server sends only this response, so the dynamic
+// table of a new decompress state is the same as the one of the server
+[[nodiscard]] std::optional<uint16_t> get_http2_response_status(const std::string& response) {
+
+	// NOLINTBEGIN(readability-magic-numbers)
+	constexpr size_t frame_header_size = 9;
+	constexpr uint8_t frame_type_headers = 0x1;
+	constexpr uint8_t flag_padded = 0x8;
+	constexpr uint8_t flag_priority = 0x20;
+	// NOLINTEND(readability-magic-numbers)
+
+	const auto* const data = reinterpret_cast<const uint8_t*>(response.data());
+
+	for(size_t offset = 0; offset + frame_header_size <= response.size();) {
+		// NOLINTBEGIN(readability-magic-numbers)
+		const size_t length = (static_cast<size_t>(data[offset]) << 16U) |
+		                      (static_cast<size_t>(data[offset + 1]) << 8U) |
+		                      static_cast<size_t>(data[offset + 2]);
+		const uint8_t type = data[offset + 3];
+		const uint8_t flags = data[offset + 4];
+		const uint32_t stream_identifier = ((data[offset + 5] & 0x7FU) << 24U) |
+		                                   (static_cast<uint32_t>(data[offset + 6]) << 16U) |
+		                                   (static_cast<uint32_t>(data[offset + 7]) << 8U) |
+		                                   static_cast<uint32_t>(data[offset + 8]);
+		// NOLINTEND(readability-magic-numbers)
+
+		const size_t payload_offset = offset + frame_header_size;
+
+		if(payload_offset + length > response.size()) {
+			return std::nullopt;
+		}
+
+		offset = payload_offset + length;
+
+		if(type != frame_type_headers || stream_identifier != 1) {
+			continue;
+		}
+
+		size_t start = payload_offset;
+		size_t end = payload_offset + length;
+
+		if((flags & flag_padded) != 0) {
+			if(start >= end || data[start] > end - start - 1) {
+				return std::nullopt;
+			}
+
+			end -= data[start];
+			++start;
+		}
+
+		if((flags & flag_priority) != 0) {
+			// the stream dependency and the weight
+			start += 5; // NOLINT(readability-magic-numbers)
+
+			if(start > end) {
+				return std::nullopt;
+			}
+		}
+
+		HpackDecompressState* const decompress_state =
+		    get_default_hpack_decompress_state(e2e_header_table_size);
+
+		if(decompress_state == nullptr) {
+			return std::nullopt;
+		}
+
+		const Http2HpackDecompressResult result = http2_hpack_decompress_data(
+		    decompress_state, ReadonlyBuffer{ .data = data + start, .size = end - start });
+
+		free_hpack_decompress_state(decompress_state);
+
+		IF_HTTP2_HPACK_DECOMPRESS_RESULT_IS_ERROR_IGN(result) {
+			return std::nullopt;
+		}
+
+		HttpHeaderFields header_fields = http2_hpack_decompress_result_get_as_ok(result);
+
+		const HttpHeaderField* const status_field =
+		    find_header_by_key(header_fields, TSTR_STATIC_LIT(":status"));
+
+		std::optional<uint16_t> status = std::nullopt;
+
+		if(status_field != nullptr) {
+			const std::string value = string_from_tstr(status_field->value);
+			uint16_t parsed = 0;
+
+			const auto [end_pointer, error] =
+			    std::from_chars(value.data(), value.data() + value.size(), parsed);
+
+			if(error == std::errc{} && end_pointer == value.data() + value.size()) {
+				status = parsed;
+			}
+		}
+
+		free_http_header_fields(&header_fields);
+
+		return status;
+	}
+
+	return std::nullopt;
+}
+
+[[nodiscard]] bool is_ok_response(const E2EProtocol protocol, const std::string& response) {
+	if(protocol == E2EProtocol::Http1) {
+		return response.starts_with("HTTP/1.1 200");
+	}
+
+	return get_http2_response_status(response) == 200; // NOLINT(readability-magic-numbers)
+}
+
+void run_e2e_benchmark(benchmark::State& state, const E2EProtocol protocol,
+                       const std::string& request) {
+
+	constexpr size_t socket_pair_batch_size = 64;
+
+	const E2EServer& server = get_e2e_server();
+
+	E2ESocketPairs socket_pairs{};
+
+	E2EResponseReader reader{};
+
+	int64_t received_bytes = 0;
+
+	for(auto _ : state) {
+		if(socket_pairs.empty()) {
+			state.PauseTiming();
+			const bool refilled = socket_pairs.refill(socket_pair_batch_size);
+			state.ResumeTiming();
+
+			if(!refilled) {
+				state.SkipWithError("couldn't create the socketpairs");
+				break;
+			}
+		}
+
+		if(!server.run_connection(request, socket_pairs.pop(), reader)) {
+			state.SkipWithError("the connection handler failed");
+			break;
+		}
+
+		const std::string& response = reader.wait();
+
+		if(response.empty()) {
+			state.SkipWithError("the response is empty");
+			break;
+		}
+
+		if(!is_ok_response(protocol, response)) {
+			state.SkipWithError("the response status is not 200");
+			break;
+		}
+
+		received_bytes += static_cast<int64_t>(response.size());
+	}
+
+	state.SetBytesProcessed(received_bytes);
+}
+
+} // namespace
+
+static void BM_e2e_small_get(benchmark::State& state, const E2EProtocol protocol) {
+	run_e2e_benchmark(state, protocol, get_e2e_request(protocol, "/static", {}));
+}
+
+static void BM_e2e_static_file(benchmark::State& state, const E2EProtocol protocol) {
+	const std::string path =
+	    "/files/" + E2EServer::get_file_name(static_cast<size_t>(state.range(0)));
+
+	run_e2e_benchmark(state, protocol, get_e2e_request(protocol, path, {}));
+}
+
+static void BM_e2e_json(benchmark::State& state, const E2EProtocol protocol,
+                        const char* const accept_encoding) {
+
+	// /json echoes the request, these headers make it bigger than the minimum compressed size
+	const E2EHeaders headers = {
+		{ "User-Agent", "Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0" },
+		{ "Accept", "application/json,text/plain;q=0.9,*/*;q=0.8" },
+		{ "Accept-Language", "en-US,en;q=0.7,de;q=0.3" },
+		{ "Accept-Encoding", accept_encoding },
+		{ "Cache-Control", "no-cache" },
+	};
+
+	run_e2e_benchmark(state, protocol, get_e2e_request(protocol, "/json", headers));
+}
+
+#ifdef _SIMPLE_SERVER_HAVE_BCRYPT
+
+static void BM_e2e_auth(benchmark::State& state, const E2EProtocol protocol) {
+	const E2EHeaders headers = { { "Authorization", e2e_basic_authorization } };
+
+	run_e2e_benchmark(state, protocol, get_e2e_request(protocol, "/auth", headers));
+}
+
+#endif
+
+BENCHMARK_CAPTURE(BM_e2e_small_get, http1, E2EProtocol::Http1)->Name("e2e/http1/small_get");
+
+BENCHMARK_CAPTURE(BM_e2e_small_get, h2c, E2EProtocol::H2c)->Name("e2e/h2c/small_get");
+
+BENCHMARK_CAPTURE(BM_e2e_static_file, http1, E2EProtocol::Http1)
+    ->Name("e2e/http1/static_file")
+    ->Arg(e2e_file_sizes[0])
+    ->Arg(e2e_file_sizes[1])
+    ->Arg(e2e_file_sizes[2]);
+
+BENCHMARK_CAPTURE(BM_e2e_static_file, h2c, E2EProtocol::H2c)
+    ->Name("e2e/h2c/static_file")
+    ->Arg(e2e_file_sizes[0])
+    ->Arg(e2e_file_sizes[1])
+    ->Arg(e2e_file_sizes[2]);
+
+BENCHMARK_CAPTURE(BM_e2e_json, http1_identity, E2EProtocol::Http1, "identity")
+    ->Name("e2e/http1/json/identity");
+
+BENCHMARK_CAPTURE(BM_e2e_json, http1_gzip, E2EProtocol::Http1, "gzip")
+    ->Name("e2e/http1/json/gzip");
+
+BENCHMARK_CAPTURE(BM_e2e_json, http1_br, E2EProtocol::Http1, "br")->Name("e2e/http1/json/br");
+
+BENCHMARK_CAPTURE(BM_e2e_json, http1_zstd, E2EProtocol::Http1, "zstd")
+    ->Name("e2e/http1/json/zstd");
+
+BENCHMARK_CAPTURE(BM_e2e_json, h2c_identity, E2EProtocol::H2c, "identity")
+    ->Name("e2e/h2c/json/identity");
+
+BENCHMARK_CAPTURE(BM_e2e_json, h2c_gzip, E2EProtocol::H2c, "gzip")->Name("e2e/h2c/json/gzip");
+
+#ifdef _SIMPLE_SERVER_HAVE_BCRYPT
+
+BENCHMARK_CAPTURE(BM_e2e_auth, http1, E2EProtocol::Http1)->Name("e2e/http1/auth");
+
+BENCHMARK_CAPTURE(BM_e2e_auth, h2c, E2EProtocol::H2c)->Name("e2e/h2c/auth");
+
+#endif
@@ -623,8 +623,12 @@ helpers::get_c_map_from_cpp(const std::vector<std::pair<std::string, std::string
 	assert(res == TvecResultOk);
 
 	for(const auto& elem : map) {
-		HttpHeaderField value = { .key = tstr_from_string(elem.first),
-			                      .value = tstr_from_string(elem.second) };
+		tstr key = tstr_from_string(elem.first);
+		const HttpHeaderToken token = get_http_header_token_for_key(&key);
+
+		HttpHeaderField value = { .key = key,
+			                      .value = tstr_from_string(elem.second),
+			                      .token = token };
 
 		res = TVEC_PUSH(HttpHeaderField, result, value);
 		assert(res == TvecResultOk);
@@ -67,6 +67,18 @@ std::ostream& operator<<(std::ostream& os, const CompressionEntry& entry) {
 	return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const CompressionType& type) {
+	os << "CompressionType{" << compression_type_to_string(type) << "}";
+	return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const HttpHeaderToken& token) {
+	const char* name = get_http_header_token_name(token);
+
+	os << "HttpHeaderToken{" << (name == nullptr ? "<none or other>" : name) << "}";
+	return os;
+}
+
 [[nodiscard]] bool operator==(const CompressionEntry& lhs, const CompressionEntry& rhs) {
 
 	if(lhs.value != rhs.value) {
@@ -100,6 +112,15 @@ http::ParsedURIWrapper::ParsedURIWrapper(ParsedRequestUriResult result) : m_resu
 	}
 }
 
+[[nodiscard]] const ParsedRequestURI& http::ParsedURIWrapper::request_uri() const {
+	IF_PARSED_REQUEST_URI_RESULT_IS_ERROR_CONST(m_result) {
+		throw std::runtime_error("invalid parse url result: " +
+		                         string_from_tstr_static(error.error));
+	}
+
+	return parsed_request_uri_result_get_as_ok_const_ref(&(this->m_result))->uri;
+}
+
 [[nodiscard]] tstr_static http::ParsedURIWrapper::error() const {
 	IF_PARSED_REQUEST_URI_RESULT_IS_ERROR_CONST(m_result) {
 		return error.error;
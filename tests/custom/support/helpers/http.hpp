@@ -38,6 +38,10 @@ class CompressionSettingsCpp {
 
 std::ostream& operator<<(std::ostream& os, const CompressionEntry& entry);
 
+std::ostream& operator<<(std::ostream& os, const CompressionType& type);
+
+std::ostream& operator<<(std::ostream& os, const HttpHeaderToken& token);
+
 [[nodiscard]] bool operator==(const CompressionEntry& lhs, const CompressionEntry& rhs);
 
 namespace http {
@@ -53,6 +57,8 @@ struct ParsedURIWrapper {
 
 	[[nodiscard]] const ParsedURLPath& path() const;
 
+	[[nodiscard]] const ParsedRequestURI& request_uri() const;
+
 	[[nodiscard]] tstr_static error() const;
 
 	~ParsedURIWrapper();
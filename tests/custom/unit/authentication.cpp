@@ -0,0 +1,450 @@
+#include <doctest.h>
+
+#include <generic/authentication.h>
+#include <generic/authentication_cache.h>
+#include <generic/authentication_session.h>
+#include <http/protocol.h>
+#include <http/routes.h>
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// the store uses the precise clocks, as the clock service isn't running in the tests
+constexpr uint64_t test_session_ttl_ms = 200;
+
+class TestSessionStore {
+  private:
+	AuthenticationSessionStore* m_store;
+
+  public:
+	explicit TestSessionStore(uint64_t ttl_ms)
+	    : m_store{ initialize_authentication_session_store(ttl_ms) } {
+		REQUIRE_NE(m_store, nullptr);
+	}
+
+	TestSessionStore(TestSessionStore&&) = delete;
+
+	TestSessionStore(const TestSessionStore&) = delete;
+
+	TestSessionStore& operator=(const TestSessionStore&) = delete;
+
+	TestSessionStore operator=(TestSessionStore&&) = delete;
+
+	~TestSessionStore() { free_authentication_session_store(m_store); }
+
+	// returns no token, if the store is full
+	[[nodiscard]] std::optional<std::string> create(const std::string& username,
+	                                                uint64_t generation = 0) {
+		tstr name = tstr_from_string(username);
+
+		const AuthUserWithContext user = {
+			.user = { .username = name, .role = UserRoleUser },
+			.provider_type = AuthenticationProviderTypeSimple,
+		};
+
+		bool store_full = false;
+		tstr token = authentication_session_create(m_store, generation, user, &store_full);
+
+		tstr_free(&name);
+
+		if(store_full) {
+			REQUIRE_TRUE(tstr_is_null(&token));
+			return std::nullopt;
+		}
+
+		REQUIRE_FALSE(tstr_is_null(&token));
+		std::string result = string_from_tstr(token);
+		tstr_free(&token);
+
+		REQUIRE_EQ(result.size(), AUTHENTICATION_SESSION_TOKEN_SIZE * 2);
+		return result;
+	}
+
+	// returns the username of the session
+	[[nodiscard]] std::optional<std::string> find(const std::string& token,
+	                                              uint64_t generation = 0) {
+		AuthUserWithContext user;
+
+		if(!authentication_session_find(
+		       m_store, tstr_view{ .data = token.data(), .len = token.size() }, generation,
+		       &user)) {
+			return std::nullopt;
+		}
+
+		std::string username = string_from_tstr(user.user.username);
+		tstr_free(&user.user.username);
+		return username;
+	}
+
+	[[nodiscard]] bool revoke(const std::string& token) {
+		return authentication_session_revoke(
+		    m_store, tstr_view{ .data = token.data(), .len = token.size() });
+	}
+};
+
+constexpr uint64_t test_cache_ttl_ms = 200;
+
+class TestAuthenticationCache {
+  private:
+	AuthenticationCache* m_cache;
+
+  public:
+	explicit TestAuthenticationCache(uint64_t ttl_ms)
+	    : m_cache{ initialize_authentication_cache(ttl_ms) } {
+		REQUIRE_NE(m_cache, nullptr);
+	}
+
+	TestAuthenticationCache(TestAuthenticationCache&&) = delete;
+
+	TestAuthenticationCache(const TestAuthenticationCache&) = delete;
+
+	TestAuthenticationCache& operator=(const TestAuthenticationCache&) = delete;
+
+	TestAuthenticationCache operator=(TestAuthenticationCache&&) = delete;
+
+	~TestAuthenticationCache() { free_authentication_cache(m_cache); }
+
+	[[nodiscard]] AuthenticationCacheKey get_key(const std::string& username,
+	                                             const std::string& password) const {
+		tstr username_tstr = tstr_from_string(username);
+		tstr password_tstr = tstr_from_string(password);
+
+		AuthenticationCacheKey key = { .data = {}, .size = 0 };
+		const bool success =
+		    get_authentication_cache_key(m_cache, &username_tstr, &password_tstr, &key);
+
+		tstr_free(&username_tstr);
+		tstr_free(&password_tstr);
+
+		REQUIRE_TRUE(success);
+		return key;
+	}
+
+	void put(const AuthenticationCacheKey& key, const std::string& username,
+	         uint64_t generation = 0) {
+		tstr name = tstr_from_string(username);
+
+		const AuthUserWithContext user = {
+			.user = { .username = name, .role = UserRoleAdmin },
+			.provider_type = AuthenticationProviderTypeSimple,
+		};
+
+		authentication_cache_put(m_cache, &key, generation, user);
+
+		tstr_free(&name);
+	}
+
+	// returns the username of the cached user
+	[[nodiscard]] std::optional<std::string> get(const AuthenticationCacheKey& key,
+	                                             uint64_t generation = 0) {
+		AuthUserWithContext user;
+
+		if(!authentication_cache_get(m_cache, &key, generation, &user)) {
+			return std::nullopt;
+		}
+
+		REQUIRE_TRUE(user.user.role == UserRoleAdmin);
+
+		std::string username = string_from_tstr(user.user.username);
+		tstr_free(&user.user.username);
+		return username;
+	}
+};
+
+// owns the header fields of a request, that only has a head
+class TestRequest {
+  private:
+	HttpRequest m_request;
+
+  public:
+	explicit TestRequest(const std::vector<std::pair<std::string, std::string>>& fields)
+	    : m_request{} {
+		m_request.head.header_fields = TVEC_EMPTY(HttpHeaderField);
+		m_request.trailer_fields = TVEC_EMPTY(HttpHeaderField);
+
+		for(const auto& [key, value] : fields) {
+			add_http_header_field(&m_request.head.header_fields, tstr_from_string(key),
+			                      tstr_from_string(value));
+		}
+
+		index_http_request_head(&m_request.head);
+	}
+
+	TestRequest(TestRequest&&) = delete;
+
+	TestRequest(const TestRequest&) = delete;
+
+	TestRequest& operator=(const TestRequest&) = delete;
+
+	TestRequest operator=(TestRequest&&) = delete;
+
+	~TestRequest() { free_http_header_fields(&m_request.head.header_fields); }
+
+	[[nodiscard]] std::optional<std::string> find_session_token() const {
+		tstr_view token = TSTR_EMPTY_VIEW;
+
+		if(!http_request_find_session_token(m_request, &token)) {
+			return std::nullopt;
+		}
+
+		return std::string{ token.data, token.len };
+	}
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN("authentication" * doctest::description("authentication tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the authentication session store <authentication_session>") {
+
+	TestSessionStore store{ test_session_ttl_ms };
+
+	SUBCASE("a created session is found until it is revoked") {
+		const auto token = store.create("user");
+		REQUIRE_TRUE(token.has_value());
+
+		REQUIRE_EQ(store.find(token.value()).value_or(""), "user");
+
+		REQUIRE_TRUE(store.revoke(token.value()));
+		REQUIRE_FALSE(store.find(token.value()).has_value());
+		REQUIRE_FALSE(store.revoke(token.value()));
+	}
+
+	SUBCASE("unknown and malformed tokens are not found") {
+		const auto token = store.create("user");
+		REQUIRE_TRUE(token.has_value());
+
+		std::string other_token = token.value();
+		other_token[0] = other_token[0] == 'a' ? 'b' : 'a';
+
+		REQUIRE_FALSE(store.find(other_token).has_value());
+		REQUIRE_FALSE(store.find("").has_value());
+		REQUIRE_FALSE(store.find(token.value().substr(1)).has_value());
+		REQUIRE_FALSE(store.find(token.value() + "0").has_value());
+	}
+
+	SUBCASE("sessions of another account store generation are invalid") {
+		const auto token = store.create("user", 1);
+		REQUIRE_TRUE(token.has_value());
+
+		REQUIRE_FALSE(store.find(token.value(), 2).has_value());
+		// the session was evicted, so it stays invalid
+		REQUIRE_FALSE(store.find(token.value(), 1).has_value());
+	}
+
+	SUBCASE("sessions expire") {
+		const auto token = store.create("user");
+		REQUIRE_TRUE(token.has_value());
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(test_session_ttl_ms + 50));
+
+		REQUIRE_FALSE(store.find(token.value()).has_value());
+	}
+
+	SUBCASE("a user with too many sessions only replaces their own oldest session") {
+		const auto other_token = store.create("other");
+		REQUIRE_TRUE(other_token.has_value());
+
+		std::vector<std::string> tokens{};
+
+		for(size_t i = 0; i <= AUTHENTICATION_SESSION_MAX_PER_USER; ++i) {
+			const auto token = store.create("user");
+			REQUIRE_TRUE(token.has_value());
+			tokens.push_back(token.value());
+
+			// so that the sessions expire in the order they were created
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+
+		REQUIRE_FALSE(store.find(tokens[0]).has_value());
+
+		for(size_t i = 1; i < tokens.size(); ++i) {
+			REQUIRE_EQ(store.find(tokens[i]).value_or(""), "user");
+		}
+
+		REQUIRE_EQ(store.find(other_token.value()).value_or(""), "other");
+	}
+}
+
+TEST_CASE("testing a full authentication session store <authentication_session_full>") {
+
+	// long enough, that no session expires during the test
+	TestSessionStore store{ AUTHENTICATION_SESSION_TTL_MS };
+
+	std::vector<std::string> tokens{};
+
+	constexpr size_t capacity = AUTHENTICATION_SESSION_SET_AMOUNT * AUTHENTICATION_SESSION_WAYS;
+
+	bool store_full = false;
+
+	// every user has one session, so that the limit per user doesn't replace anything, some set is
+	// full, before the whole store is
+	for(size_t i = 0; i <= capacity; ++i) {
+		const auto token = store.create("user" + std::to_string(i));
+
+		if(!token.has_value()) {
+			store_full = true;
+			break;
+		}
+
+		tokens.push_back(token.value());
+	}
+
+	REQUIRE_TRUE(store_full);
+
+	// no valid session was replaced
+	for(size_t i = 0; i < tokens.size(); ++i) {
+		REQUIRE_EQ(store.find(tokens[i]).value_or(""), "user" + std::to_string(i));
+	}
+}
+
+TEST_CASE("testing the authentication cache <authentication_cache>") {
+
+	TestAuthenticationCache cache{ test_cache_ttl_ms };
+
+	SUBCASE("the key depends on the username and the password") {
+		const AuthenticationCacheKey key = cache.get_key("user", "password");
+
+		const AuthenticationCacheKey same_key = cache.get_key("user", "password");
+		REQUIRE_TRUE(hmac_digest_eq(&key, &same_key));
+
+		const AuthenticationCacheKey other_password = cache.get_key("user", "password2");
+		REQUIRE_FALSE(hmac_digest_eq(&key, &other_password));
+
+		// the username is length prefixed, so moving the boundary changes the key
+		const AuthenticationCacheKey moved_boundary = cache.get_key("userp", "assword");
+		REQUIRE_FALSE(hmac_digest_eq(&key, &moved_boundary));
+
+		// every cache has its own random hmac key
+		TestAuthenticationCache other_cache{ test_cache_ttl_ms };
+		const AuthenticationCacheKey other_cache_key = other_cache.get_key("user", "password");
+		REQUIRE_FALSE(hmac_digest_eq(&key, &other_cache_key));
+	}
+
+	SUBCASE("a cached user is a hit") {
+		const AuthenticationCacheKey key = cache.get_key("user", "password");
+
+		REQUIRE_FALSE(cache.get(key).has_value());
+
+		cache.put(key, "user");
+
+		REQUIRE_EQ(cache.get(key).value_or(""), "user");
+		REQUIRE_FALSE(cache.get(cache.get_key("user", "wrong")).has_value());
+	}
+
+	SUBCASE("entries of another generation are misses") {
+		const AuthenticationCacheKey key = cache.get_key("user", "password");
+
+		cache.put(key, "user", 1);
+
+		REQUIRE_FALSE(cache.get(key, 2).has_value());
+		// the entry was evicted, so it stays a miss
+		REQUIRE_FALSE(cache.get(key, 1).has_value());
+	}
+
+	SUBCASE("entries expire") {
+		const AuthenticationCacheKey key = cache.get_key("user", "password");
+
+		cache.put(key, "user");
+		REQUIRE_TRUE(cache.get(key).has_value());
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(test_cache_ttl_ms + 50));
+
+		REQUIRE_FALSE(cache.get(key).has_value());
+	}
+
+	SUBCASE("a full set replaces its oldest entry") {
+		std::vector<AuthenticationCacheKey> keys{};
+
+		// collects one more key of the same set, than the set can hold
+		const AuthenticationCacheKey first_key = cache.get_key("user0", "password");
+		const size_t set_index = hmac_digest_get_index(&first_key, AUTHENTICATION_CACHE_SET_AMOUNT);
+		keys.push_back(first_key);
+
+		for(size_t i = 1; keys.size() <= AUTHENTICATION_CACHE_WAYS; ++i) {
+			const AuthenticationCacheKey key =
+			    cache.get_key("user" + std::to_string(i), "password");
+
+			if(hmac_digest_get_index(&key, AUTHENTICATION_CACHE_SET_AMOUNT) == set_index) {
+				keys.push_back(key);
+			}
+		}
+
+		for(size_t i = 0; i < keys.size(); ++i) {
+			cache.put(keys[i], "user");
+			// so that the entries are inserted at different times
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		REQUIRE_FALSE(cache.get(keys[0]).has_value());
+
+		for(size_t i = 1; i < keys.size(); ++i) {
+			REQUIRE_TRUE(cache.get(keys[i]).has_value());
+		}
+	}
+}
+
+TEST_CASE("testing the session token of requests <session_token>") {
+
+	SUBCASE("a bearer token") {
+		const TestRequest request{ { { "Authorization", "Bearer abc123" } } };
+
+		REQUIRE_EQ(request.find_session_token().value_or(""), "abc123");
+	}
+
+	SUBCASE("the auth-scheme is case insensitive") {
+		const TestRequest request{ { { "authorization", "bearer abc123" } } };
+
+		REQUIRE_EQ(request.find_session_token().value_or(""), "abc123");
+	}
+
+	SUBCASE("a session cookie") {
+		const TestRequest request{ { { "Cookie", "theme=dark; session=abc123; lang=en" } } };
+
+		REQUIRE_EQ(request.find_session_token().value_or(""), "abc123");
+	}
+
+	SUBCASE("cookies split into multiple fields") {
+		const TestRequest request{ { { "Cookie", "theme=dark" }, { "cookie", "session=abc123" } } };
+
+		REQUIRE_EQ(request.find_session_token().value_or(""), "abc123");
+	}
+
+	SUBCASE("a bearer token is preferred over the cookie") {
+		const TestRequest request{
+			{ { "Cookie", "session=from-cookie" }, { "Authorization", "Bearer from-header" } }
+		};
+
+		REQUIRE_EQ(request.find_session_token().value_or(""), "from-header");
+	}
+
+	SUBCASE("basic credentials fall back to the cookie") {
+		const TestRequest request{
+			{ { "Authorization", "Basic dGVzdDE6dGVzdDI=" }, { "Cookie", "session=abc123" } }
+		};
+
+		REQUIRE_EQ(request.find_session_token().value_or(""), "abc123");
+	}
+
+	SUBCASE("no token") {
+		const TestRequest without_headers{ {} };
+		REQUIRE_FALSE(without_headers.find_session_token().has_value());
+
+		const TestRequest other_cookies{ { { "Cookie", "sessionid=abc; xsession=def" } } };
+		REQUIRE_FALSE(other_cookies.find_session_token().has_value());
+
+		const TestRequest empty_bearer{ { { "Authorization", "Bearer " } } };
+		REQUIRE_FALSE(empty_bearer.find_session_token().has_value());
+	}
+}
+
+TEST_SUITE_END();
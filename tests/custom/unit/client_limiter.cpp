@@ -0,0 +1,219 @@
+#include <doctest.h>
+
+#include <generic/client_limiter.h>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <thread>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// loopback clients are never limited, so the tests use private addresses
+[[nodiscard]] IPAddress get_test_address(uint8_t last_byte) {
+	const uint32_t host_address = (10U << 24U) | last_byte;
+	return from_ipv4(in_addr{ .s_addr = htonl(host_address) });
+}
+
+[[nodiscard]] IPAddress get_test_loopback_address(uint8_t last_byte) {
+	const uint32_t host_address = (127U << 24U) | last_byte;
+	return from_ipv4(in_addr{ .s_addr = htonl(host_address) });
+}
+
+[[nodiscard]] ClientLimiterOptions get_test_options(uint32_t requests_per_second,
+                                                    uint32_t request_burst,
+                                                    size_t max_connections) {
+	ClientLimiterOptions options = get_default_client_limiter_options();
+	options.requests_per_second = requests_per_second;
+	options.request_burst = request_burst;
+	options.max_connections = max_connections;
+	return options;
+}
+
+// the limiter is global, this initializes it for one test case
+class TestClientLimiter {
+  public:
+	explicit TestClientLimiter(ClientLimiterOptions options) {
+		REQUIRE_TRUE(global_initialize_client_limiter(options, nullptr));
+	}
+
+	TestClientLimiter(TestClientLimiter&&) = delete;
+
+	TestClientLimiter(const TestClientLimiter&) = delete;
+
+	TestClientLimiter& operator=(const TestClientLimiter&) = delete;
+
+	TestClientLimiter operator=(TestClientLimiter&&) = delete;
+
+	~TestClientLimiter() { global_free_client_limiter(); }
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN("client_limiter" * doctest::description("client limiter tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the connection cap of the client limiter <client_limiter_connections>") {
+
+	const IPAddress address = get_test_address(1);
+	const IPAddress other_address = get_test_address(2);
+
+	SUBCASE("an uninitialized limiter allows everything") {
+		for(size_t i = 0; i < 100; ++i) {
+			REQUIRE_TRUE(client_limiter_acquire_connection(address));
+		}
+
+		uint32_t retry_after_s = 1;
+		REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+		REQUIRE_EQ(retry_after_s, 0);
+	}
+
+	SUBCASE("the cap is per client") {
+		TestClientLimiter limiter{ get_test_options(0, 0, 2) };
+
+		REQUIRE_TRUE(client_limiter_acquire_connection(address));
+		REQUIRE_TRUE(client_limiter_acquire_connection(address));
+		REQUIRE_FALSE(client_limiter_acquire_connection(address));
+
+		REQUIRE_TRUE(client_limiter_acquire_connection(other_address));
+
+		client_limiter_release_connection(address);
+		REQUIRE_TRUE(client_limiter_acquire_connection(address));
+		REQUIRE_FALSE(client_limiter_acquire_connection(address));
+
+		client_limiter_release_connection(address);
+		client_limiter_release_connection(address);
+		client_limiter_release_connection(other_address);
+	}
+
+	SUBCASE("the default cap has a floor, if there are few workers") {
+		ClientLimiterOptions options = get_default_client_limiter_options();
+		REQUIRE_EQ(options.max_connections, 0);
+
+		TestClientLimiter limiter{ options };
+
+		constexpr size_t min_default_connections = 8;
+
+		for(size_t i = 0; i < min_default_connections; ++i) {
+			REQUIRE_TRUE(client_limiter_acquire_connection(address));
+		}
+
+		REQUIRE_FALSE(client_limiter_acquire_connection(address));
+
+		for(size_t i = 0; i < min_default_connections; ++i) {
+			client_limiter_release_connection(address);
+		}
+	}
+}
+
+TEST_CASE("testing the request rate of the client limiter <client_limiter_requests>") {
+
+	const IPAddress address = get_test_address(1);
+	const IPAddress other_address = get_test_address(2);
+
+	SUBCASE("a full bucket allows a burst, then the client has to wait") {
+		// one token every 100 ms
+		TestClientLimiter limiter{ get_test_options(10, 3, 0) };
+
+		uint32_t retry_after_s = 0;
+
+		for(size_t i = 0; i < 3; ++i) {
+			REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+			REQUIRE_EQ(retry_after_s, 0);
+		}
+
+		REQUIRE_FALSE(client_limiter_allow_request(address, &retry_after_s));
+		// the wait is rounded up to whole seconds
+		REQUIRE_EQ(retry_after_s, 1);
+
+		REQUIRE_TRUE(client_limiter_allow_request(other_address, &retry_after_s));
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+		REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+		REQUIRE_FALSE(client_limiter_allow_request(address, &retry_after_s));
+	}
+
+	SUBCASE("the bucket doesn't grow beyond the burst") {
+		TestClientLimiter limiter{ get_test_options(100, 2, 0) };
+
+		uint32_t retry_after_s = 0;
+
+		REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+		REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+		REQUIRE_FALSE(client_limiter_allow_request(address, &retry_after_s));
+	}
+
+	SUBCASE("a rate of 0 disables the request limit") {
+		TestClientLimiter limiter{ get_test_options(0, 1, 0) };
+
+		uint32_t retry_after_s = 0;
+
+		for(size_t i = 0; i < 100; ++i) {
+			REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+		}
+	}
+}
+
+TEST_CASE("testing the exempt clients of the client limiter <client_limiter_exempt>") {
+
+	const IPAddress address = get_test_address(1);
+	const IPAddress trusted_address = get_test_address(2);
+	const IPAddress loopback_address = get_test_loopback_address(1);
+	const IPAddress other_loopback_address = get_test_loopback_address(42);
+
+	in6_addr v6_loopback = {};
+	REQUIRE_EQ(inet_pton(AF_INET6, "::1", &v6_loopback), 1);
+	const IPAddress v6_loopback_address = from_ipv6(v6_loopback);
+
+	ClientLimiterOptions options = get_test_options(10, 1, 1);
+	options.trusted_addresses[0] = trusted_address;
+	options.trusted_address_amount = 1;
+
+	TestClientLimiter limiter{ options };
+
+	REQUIRE_FALSE(client_limiter_is_exempt(address));
+	REQUIRE_TRUE(client_limiter_is_exempt(trusted_address));
+	REQUIRE_TRUE(client_limiter_is_exempt(loopback_address));
+	REQUIRE_TRUE(client_limiter_is_exempt(other_loopback_address));
+	REQUIRE_TRUE(client_limiter_is_exempt(v6_loopback_address));
+
+	SUBCASE("exempt clients have no connection cap") {
+		for(const IPAddress& exempt_address :
+		    { trusted_address, loopback_address, v6_loopback_address }) {
+			for(size_t i = 0; i < 100; ++i) {
+				REQUIRE_TRUE(client_limiter_acquire_connection(exempt_address));
+			}
+
+			for(size_t i = 0; i < 100; ++i) {
+				client_limiter_release_connection(exempt_address);
+			}
+		}
+
+		REQUIRE_TRUE(client_limiter_acquire_connection(address));
+		REQUIRE_FALSE(client_limiter_acquire_connection(address));
+		client_limiter_release_connection(address);
+	}
+
+	SUBCASE("exempt clients have no request limit") {
+		uint32_t retry_after_s = 0;
+
+		for(const IPAddress& exempt_address :
+		    { trusted_address, loopback_address, v6_loopback_address }) {
+			for(size_t i = 0; i < 100; ++i) {
+				REQUIRE_TRUE(client_limiter_allow_request(exempt_address, &retry_after_s));
+				REQUIRE_EQ(retry_after_s, 0);
+			}
+		}
+
+		REQUIRE_TRUE(client_limiter_allow_request(address, &retry_after_s));
+		REQUIRE_FALSE(client_limiter_allow_request(address, &retry_after_s));
+	}
+}
+
+TEST_SUITE_END();
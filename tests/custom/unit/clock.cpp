@@ -0,0 +1,149 @@
+#include <doctest.h>
+
+#include <utils/clock.h>
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// "Sun, 06 Nov 1994 08:49:37 GMT"
+constexpr size_t http_date_length = 29;
+
+// returns the seconds since the epoch, that the date string describes, or -1 if it is malformed
+[[nodiscard]] time_t parse_http_date_string(const HttpDateString& date_string) {
+	if(date_string.length != http_date_length || date_string.data[date_string.length] != '\0') {
+		return -1;
+	}
+
+	struct tm parsed = {};
+	const char* const end = strptime(date_string.data, "%a, %d %b %Y %H:%M:%S GMT", &parsed);
+
+	if(end == nullptr || *end != '\0') {
+		return -1;
+	}
+
+	return timegm(&parsed);
+}
+
+// this is also used in the reader threads, so it doesn't use any assertions
+[[nodiscard]] time_t get_precise_seconds() {
+	Time now = empty_time();
+
+	if(!get_current_time(&now)) {
+		return -1;
+	}
+
+	return static_cast<time_t>(get_time_in_seconds(now));
+}
+
+// checks every snapshot, that a reader sees, against the precise clock, a torn snapshot would mix
+// a date string with a different length or time, or go back in time
+struct ClockReaderStats {
+	std::atomic<size_t> reads{ 0 };
+	std::atomic<size_t> malformed_dates{ 0 };
+	std::atomic<size_t> wrong_dates{ 0 };
+	std::atomic<size_t> monotonic_regressions{ 0 };
+};
+
+void read_clock_until(const std::atomic<bool>& stop, ClockReaderStats& stats) {
+
+	uint64_t last_monotonic_ns = 0;
+
+	while(!stop.load()) {
+		const time_t before = get_precise_seconds();
+
+		HttpDateString date_string = {};
+		Time monotonic = empty_time();
+
+		if(!get_http_date_string(&date_string) || !get_coarse_monotonic_time(&monotonic)) {
+			++stats.malformed_dates;
+			continue;
+		}
+
+		const time_t after = get_precise_seconds();
+
+		const time_t date = parse_http_date_string(date_string);
+
+		if(date < 0) {
+			++stats.malformed_dates;
+		} else if(date + 1 < before || date > after) {
+			// the snapshot may lag behind by one resolution step, so one second is allowed
+			++stats.wrong_dates;
+		}
+
+		const uint64_t monotonic_ns = get_time_in_nano_seconds(monotonic);
+
+		if(monotonic_ns < last_monotonic_ns) {
+			++stats.monotonic_regressions;
+		}
+
+		last_monotonic_ns = monotonic_ns;
+		++stats.reads;
+	}
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("clock" * doctest::description("clock service tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the http date string without the clock service <clock_fallback>") {
+
+	global_initialize_locale_for_http();
+
+	HttpDateString date_string = {};
+	REQUIRE_TRUE(get_http_date_string(&date_string));
+
+	const time_t now = get_precise_seconds();
+	REQUIRE_GE(now, 0);
+
+	const time_t date = parse_http_date_string(date_string);
+
+	REQUIRE_GE(date, now - 1);
+	REQUIRE_LE(date, now);
+
+	global_free_locale_for_http();
+}
+
+TEST_CASE("testing concurrent readers of the clock service <clock_service>") {
+
+	global_initialize_locale_for_http();
+	global_start_clock_service();
+
+	constexpr size_t reader_amount = 4;
+	// a few date changes and many updates of the snapshot happen in this time
+	constexpr auto duration = std::chrono::milliseconds(1200);
+
+	std::atomic<bool> stop{ false };
+	ClockReaderStats stats{};
+
+	std::vector<std::thread> readers{};
+
+	for(size_t i = 0; i < reader_amount; ++i) {
+		readers.emplace_back([&stop, &stats]() { read_clock_until(stop, stats); });
+	}
+
+	std::this_thread::sleep_for(duration);
+	stop.store(true);
+
+	for(auto& reader : readers) {
+		reader.join();
+	}
+
+	global_stop_clock_service();
+	global_free_locale_for_http();
+
+	REQUIRE_GT(stats.reads.load(), 0);
+	REQUIRE_EQ(stats.malformed_dates.load(), 0);
+	REQUIRE_EQ(stats.wrong_dates.load(), 0);
+	REQUIRE_EQ(stats.monotonic_regressions.load(), 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,251 @@
+#include <doctest.h>
+
+#include <http/common_log.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+class TestLogCollector {
+  private:
+	LogCollector* m_collector;
+
+  public:
+	explicit TestLogCollector(LogCollectorOptions options)
+	    : m_collector{ initialize_log_collector(options) } {
+		REQUIRE_NE(m_collector, nullptr);
+	}
+
+	TestLogCollector(TestLogCollector&&) = delete;
+
+	TestLogCollector(const TestLogCollector&) = delete;
+
+	TestLogCollector& operator=(const TestLogCollector&) = delete;
+
+	TestLogCollector operator=(TestLogCollector&&) = delete;
+
+	~TestLogCollector() { free_log_collector(m_collector); }
+
+	void collect(const std::string& uri, HttpStatusCode status = HttpStatusOk) {
+		const auto parsed_uri = http::ParsedURIWrapper::parse(uri);
+		REQUIRE_EQ(parsed_uri.error(), TstrStaticIsNull{});
+
+		HttpRequest request{};
+		request.head.request_line.method = HTTPRequestMethodGet;
+		request.head.request_line.uri = parsed_uri.request_uri();
+		request.head.request_line.protocol_data.version = HTTPProtocolVersion1Dot1;
+		request.head.header_fields = TVEC_EMPTY(HttpHeaderField);
+		request.trailer_fields = TVEC_EMPTY(HttpHeaderField);
+		index_http_request_head(&request.head);
+
+		HTTPResponseToSend response{};
+		response.status = status;
+		response.body.content = SizedBuffer{ .data = nullptr, .size = 0 };
+		response.mime_type = tstr_null();
+		response.additional_headers = TVEC_EMPTY(HttpHeaderField);
+
+		const IPAddress address = from_ipv4(in_addr{ .s_addr = htonl(INADDR_LOOPBACK) });
+
+		log_collector_collect(m_collector, address, request, response);
+	}
+
+	[[nodiscard]] std::vector<std::string> get_snapshot_lines() {
+		StringBuilder* builder = log_collector_to_string_builder(m_collector);
+		REQUIRE_NE(builder, nullptr);
+
+		char* content = string_builder_release_into_string(&builder);
+		REQUIRE_NE(content, nullptr);
+
+		std::vector<std::string> lines{};
+		std::istringstream stream{ std::string{ content } };
+		free(content);
+
+		for(std::string line; std::getline(stream, line);) {
+			lines.push_back(line);
+		}
+
+		return lines;
+	}
+
+	// the snapshot doesn't wait for the drainer, so this polls, until the expected amount of lines
+	// was drained or the time is up
+	[[nodiscard]] std::vector<std::string> get_recent_lines(size_t expected_amount) {
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+		std::vector<std::string> lines = get_snapshot_lines();
+
+		while(lines.size() < expected_amount && std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			lines = get_snapshot_lines();
+		}
+
+		return lines;
+	}
+};
+
+[[nodiscard]] LogCollectorOptions get_memory_options() {
+	return LogCollectorOptions{
+		.file_path = nullptr,
+		.format = AccessLogFormatCommon,
+		.rotate_size = 0,
+		.rotate_interval_s = 0,
+	};
+}
+
+// returns the request line of a common log line
+[[nodiscard]] std::string get_request_line(const std::string& line) {
+	const size_t start = line.find('"');
+	const size_t end = line.rfind("\" ");
+
+	REQUIRE_NE(start, std::string::npos);
+	REQUIRE_NE(end, std::string::npos);
+	REQUIRE_GT(end, start);
+
+	return line.substr(start + 1, end - start - 1);
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("common_log" * doctest::description("access log tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the uri of access log entries <common_log_uri>") {
+
+	TestLogCollector collector{ get_memory_options() };
+
+	SUBCASE("paths, queries and the asterisk form are written like the request uri") {
+		collector.collect("/index.html");
+		collector.collect("/search?query=value");
+		collector.collect("/search?flag");
+		collector.collect("*");
+
+		const auto lines = collector.get_recent_lines(4);
+		REQUIRE_EQ(lines.size(), 4);
+
+		REQUIRE_EQ(get_request_line(lines[0]), "GET /index.html HTTP/1.1");
+		REQUIRE_EQ(get_request_line(lines[1]), "GET /search?query=value HTTP/1.1");
+		REQUIRE_EQ(get_request_line(lines[2]), "GET /search?flag HTTP/1.1");
+		REQUIRE_EQ(get_request_line(lines[3]), "GET * HTTP/1.1");
+
+		REQUIRE_NE(lines[0].find("\" 200 0"), std::string::npos);
+	}
+
+	SUBCASE("query parameters are separated") {
+		collector.collect("/search?first=1&second=2");
+
+		const auto lines = collector.get_recent_lines(1);
+		REQUIRE_EQ(lines.size(), 1);
+
+		// the order of the parameters isn't kept
+		const std::string request_line = get_request_line(lines[0]);
+		const bool valid = request_line == "GET /search?first=1&second=2 HTTP/1.1" ||
+		                   request_line == "GET /search?second=2&first=1 HTTP/1.1";
+		REQUIRE_MESSAGE(valid, "request line: " + request_line);
+	}
+
+	SUBCASE("quotes are escaped and long uris are truncated") {
+		collector.collect("/a\"b");
+		collector.collect("/" + std::string(LOG_ENTRY_URI_MAX_SIZE * 2, 'x'));
+
+		const auto lines = collector.get_recent_lines(2);
+		REQUIRE_EQ(lines.size(), 2);
+
+		REQUIRE_EQ(get_request_line(lines[0]), "GET /a\\\"b HTTP/1.1");
+		REQUIRE_EQ(get_request_line(lines[1]),
+		           "GET /" + std::string(LOG_ENTRY_URI_MAX_SIZE - 2, 'x') + " HTTP/1.1");
+	}
+}
+
+TEST_CASE("testing the snapshot of the recent entries <common_log_snapshot>") {
+
+	TestLogCollector collector{ get_memory_options() };
+
+	// nothing was drained yet, the snapshot is returned at once, without waiting for a drain
+	const auto start = std::chrono::steady_clock::now();
+	const auto empty_lines = collector.get_snapshot_lines();
+	const auto waited = std::chrono::steady_clock::now() - start;
+
+	REQUIRE_TRUE(empty_lines.empty());
+	REQUIRE_LT(std::chrono::duration_cast<std::chrono::milliseconds>(waited).count(),
+	           LOG_COLLECTOR_DRAIN_INTERVAL_MS);
+
+	// the snapshot woke up the drainer, so a collected entry shows up in a later snapshot
+	collector.collect("/later");
+
+	const auto lines = collector.get_recent_lines(1);
+	REQUIRE_EQ(lines.size(), 1);
+	REQUIRE_EQ(get_request_line(lines[0]), "GET /later HTTP/1.1");
+}
+
+TEST_CASE("testing the rotation of the access log file <common_log_rotation>") {
+
+	const std::filesystem::path directory =
+	    std::filesystem::temp_directory_path() /
+	    ("simple_http_server_common_log_test_" + std::to_string(getpid()));
+
+	std::filesystem::remove_all(directory);
+	REQUIRE_TRUE(std::filesystem::create_directory(directory));
+
+	const std::string file_path = (directory / "access.log").string();
+
+	constexpr size_t rotation_amount = 3;
+
+	{
+		// every drain, that wrote something, rotates the file, that happens several times in the
+		// same second
+		TestLogCollector collector{ LogCollectorOptions{
+		    .file_path = file_path.c_str(),
+		    .format = AccessLogFormatCommon,
+		    .rotate_size = 1,
+		    .rotate_interval_s = 0,
+		} };
+
+		for(size_t i = 0; i < rotation_amount; ++i) {
+			collector.collect("/entry" + std::to_string(i));
+			REQUIRE_EQ(collector.get_recent_lines(i + 1).size(), i + 1);
+		}
+	}
+
+	// no rotated file was overwritten, so every entry is in exactly one of them
+	std::vector<std::string> entries{};
+	size_t rotated_files = 0;
+
+	for(const auto& file : std::filesystem::directory_iterator(directory)) {
+		if(file.path().filename() == "access.log") {
+			REQUIRE_EQ(std::filesystem::file_size(file.path()), 0);
+			continue;
+		}
+
+		REQUIRE_TRUE(file.path().filename().string().starts_with("access.log."));
+		++rotated_files;
+
+		std::ifstream stream{ file.path() };
+
+		for(std::string line; std::getline(stream, line);) {
+			entries.push_back(get_request_line(line));
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+
+	REQUIRE_EQ(rotated_files, rotation_amount);
+	REQUIRE_EQ(entries.size(), rotation_amount);
+
+	for(size_t i = 0; i < rotation_amount; ++i) {
+		const std::string expected = "GET /entry" + std::to_string(i) + " HTTP/1.1";
+		REQUIRE_TRUE(std::find(entries.begin(), entries.end(), expected) != entries.end());
+	}
+}
+
+TEST_SUITE_END();
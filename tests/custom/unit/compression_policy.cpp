@@ -0,0 +1,216 @@
+#include <doctest.h>
+
+#include <http/compression.h>
+#include <http/compression_policy.h>
+#include <utils/thread_pool.h>
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+#include "helpers/string_maker.hpp"
+
+namespace {
+
+[[nodiscard]] CompressionDecision decide(CompressionType negotiated, const std::string& mime_type,
+                                         size_t body_size) {
+	tstr mime_type_str = tstr_from_string(mime_type);
+	const CompressionDecision decision =
+	    compression_policy_decide(negotiated, mime_type_str, body_size);
+	tstr_free(&mime_type_str);
+	return decision;
+}
+
+// the policy and its pool are global, this initializes both for one test case
+class TestCompressionPolicy {
+  public:
+	explicit TestCompressionPolicy(size_t workers) {
+		REQUIRE_TRUE(pool_create(&m_pool, workers).error == CreateErrorNone);
+		global_initialize_compression_policy(get_default_compression_policy(), &m_pool);
+	}
+
+	TestCompressionPolicy(TestCompressionPolicy&&) = delete;
+
+	TestCompressionPolicy(const TestCompressionPolicy&) = delete;
+
+	TestCompressionPolicy& operator=(const TestCompressionPolicy&) = delete;
+
+	TestCompressionPolicy operator=(TestCompressionPolicy&&) = delete;
+
+	~TestCompressionPolicy() {
+		global_free_compression_policy();
+		UNUSED(pool_destroy(&m_pool));
+	}
+
+	[[nodiscard]] ThreadPool* pool() { return &m_pool; }
+
+  private:
+	ThreadPool m_pool{};
+};
+
+// occupies a worker of the pool, until the test releases it, an idle job is marked as idle like a
+// keep-alive connection, that waits for the next request
+struct BlockingJob {
+	ThreadPool* pool;
+	bool idle;
+	std::promise<void> started;
+	std::shared_future<void> release;
+};
+
+void* run_blocking_job(void* argument, WorkerInfo worker_info) {
+	UNUSED(worker_info);
+
+	auto* job = static_cast<BlockingJob*>(argument);
+
+	if(job->idle) {
+		pool_mark_worker_idle(job->pool);
+	}
+
+	job->started.set_value();
+	job->release.wait();
+
+	if(job->idle) {
+		pool_mark_worker_busy(job->pool);
+	}
+
+	return JOB_ERROR_NONE;
+}
+
+struct BlockedPoolResult {
+	size_t busy_workers;
+	CompressionDecision decision;
+};
+
+// blocks 3 of the 4 workers, that is the default saturation percentage of 75, and decides, while
+// they are blocked
+[[nodiscard]] BlockedPoolResult decide_with_blocked_workers(ThreadPool* pool, bool idle) {
+
+	constexpr size_t blocked_workers = 3;
+
+	std::promise<void> release{};
+	const std::shared_future<void> release_future = release.get_future().share();
+
+	std::vector<BlockingJob> jobs(blocked_workers);
+	std::vector<JobId*> job_ids{};
+
+	bool submitted = true;
+
+	for(auto& job : jobs) {
+		job.pool = pool;
+		job.idle = idle;
+		job.release = release_future;
+
+		std::future<void> started = job.started.get_future();
+
+		JobId* const job_id = pool_submit(pool, run_blocking_job, &job);
+
+		if(is_submit_error((SubmitError)job_id)) {
+			submitted = false;
+			break;
+		}
+
+		job_ids.push_back(job_id);
+		started.wait();
+	}
+
+	const BlockedPoolResult result{ .busy_workers = pool_get_busy_workers(pool),
+		                            .decision = decide(CompressionTypeGzip, "text/html", 4096) };
+
+	// the jobs have to finish, before anything is required
+	release.set_value();
+
+	bool finished = true;
+
+	for(JobId* const job_id : job_ids) {
+		finished = pool_await(job_id) == JOB_ERROR_NONE && finished;
+	}
+
+	REQUIRE_TRUE(submitted);
+	REQUIRE_TRUE(finished);
+
+	return result;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("compression_policy" * doctest::description("compression policy tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the compression policy <compression_policy>") {
+
+	const size_t big_body = 4096;
+
+	SUBCASE("nothing negotiated") {
+		REQUIRE_EQ(decide(CompressionTypeNone, "text/html", big_body).format,
+		           CompressionTypeNone);
+	}
+
+	SUBCASE("compressible mime types") {
+		REQUIRE_EQ(decide(CompressionTypeGzip, "text/html", big_body).format,
+		           CompressionTypeGzip);
+		REQUIRE_EQ(decide(CompressionTypeBr, "text/css", big_body).format, CompressionTypeBr);
+		REQUIRE_EQ(decide(CompressionTypeZstd, "application/json; charset=utf-8", big_body).format,
+		           CompressionTypeZstd);
+		REQUIRE_EQ(decide(CompressionTypeGzip, "Application/JavaScript", big_body).format,
+		           CompressionTypeGzip);
+		REQUIRE_EQ(decide(CompressionTypeGzip, "application/vnd.api+json", big_body).format,
+		           CompressionTypeGzip);
+		REQUIRE_EQ(decide(CompressionTypeGzip, "image/svg+xml", big_body).format,
+		           CompressionTypeGzip);
+	}
+
+	SUBCASE("incompressible mime types") {
+		REQUIRE_EQ(decide(CompressionTypeGzip, "image/png", big_body).format,
+		           CompressionTypeNone);
+		REQUIRE_EQ(decide(CompressionTypeBr, "application/zip", big_body).format,
+		           CompressionTypeNone);
+		REQUIRE_EQ(decide(CompressionTypeZstd, "video/mp4", big_body).format,
+		           CompressionTypeNone);
+		REQUIRE_EQ(decide(CompressionTypeGzip, "font/woff2", big_body).format,
+		           CompressionTypeNone);
+		REQUIRE_EQ(decide(CompressionTypeGzip, "application/octet-stream", big_body).format,
+		           CompressionTypeNone);
+	}
+
+	SUBCASE("null mime type uses the default") {
+		const CompressionDecision decision =
+		    compression_policy_decide(CompressionTypeGzip, tstr_null(), big_body);
+		REQUIRE_EQ(decision.format, CompressionTypeGzip);
+	}
+
+	SUBCASE("small bodies") {
+		REQUIRE_EQ(decide(CompressionTypeGzip, "text/html", 0).format, CompressionTypeNone);
+		REQUIRE_EQ(decide(CompressionTypeGzip, "text/html", 16).format, CompressionTypeNone);
+	}
+}
+
+TEST_CASE("testing the compression levels of a saturated pool <compression_policy_saturation>") {
+
+	TestCompressionPolicy policy{ 4 };
+
+	const CompressionPolicy defaults = get_default_compression_policy();
+
+	SUBCASE("busy workers lower the levels") {
+		const BlockedPoolResult result = decide_with_blocked_workers(policy.pool(), false);
+
+		REQUIRE_EQ(result.busy_workers, 3);
+		REQUIRE_EQ(result.decision.format, CompressionTypeGzip);
+		REQUIRE_EQ(result.decision.level, defaults.saturated_levels.gzip);
+	}
+
+	SUBCASE("idle keep-alive connections don't make the pool look saturated") {
+		const BlockedPoolResult result = decide_with_blocked_workers(policy.pool(), true);
+
+		REQUIRE_EQ(result.busy_workers, 0);
+		REQUIRE_EQ(result.decision.format, CompressionTypeGzip);
+		REQUIRE_EQ(result.decision.level, defaults.levels.gzip);
+	}
+
+	// after the jobs finished, the normal levels are used again
+	REQUIRE_EQ(pool_get_busy_workers(policy.pool()), 0);
+	REQUIRE_EQ(decide(CompressionTypeGzip, "text/html", 4096).level, defaults.levels.gzip);
+}
+
+TEST_SUITE_END();
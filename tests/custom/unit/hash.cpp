@@ -1,5 +1,6 @@
 #include <generic/hash.h>
 
+#include <string>
 #include <vector>
 
 #include <doctest.h>
@@ -19,6 +20,45 @@ struct TestCaseBase64 {
 	std::string base64;
 };
 
+struct TestCaseHmac {
+	doctest::String name;
+	std::string key;
+	std::string data;
+	// lowercase hex
+	std::string digest;
+};
+
+namespace {
+
+[[nodiscard]] std::string hex_from_buffer(const uint8_t* data, size_t size) {
+	constexpr const char* hex_digits = "0123456789abcdef";
+
+	std::string result{};
+
+	for(size_t i = 0; i < size; ++i) {
+		result += hex_digits[data[i] >> 4];
+		result += hex_digits[data[i] & 0x0F];
+	}
+
+	return result;
+}
+
+[[nodiscard]] std::string repeated_bytes(uint8_t byte, size_t amount) {
+	return std::string(amount, static_cast<char>(byte));
+}
+
+[[nodiscard]] std::string counting_bytes(uint8_t first, uint8_t last) {
+	std::string result{};
+
+	for(size_t byte = first; byte <= last; ++byte) {
+		result += static_cast<char>(byte);
+	}
+
+	return result;
+}
+
+} // namespace
+
 TEST_SUITE_BEGIN("hash" * doctest::description("hash tests") *
                  doctest::timeout(2.0 * g_doctest_timeout_multiplier));
 
@@ -239,6 +279,107 @@ TEST_CASE("testing sha1 generation with openssl <sha1>") {
 	}
 }
 
+TEST_CASE("testing keyed hashes <hmac>") {
+
+	// with openssl HMAC-SHA256 is used, otherwise the HMAC-SHA1 fallback
+	const bool uses_openssl = std::string{ get_sha1_provider() }.starts_with("openssl");
+
+	// see https://datatracker.ietf.org/doc/html/rfc4231#section-4
+	const std::vector<TestCaseHmac> sha256_test_cases = {
+		{ .name = "rfc 4231 test case 1",
+		  .key = repeated_bytes(0x0b, 20),
+		  .data = "Hi There",
+		  .digest = "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7" },
+		{ .name = "rfc 4231 test case 2",
+		  .key = "Jefe",
+		  .data = "what do ya want for nothing?",
+		  .digest = "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+		{ .name = "rfc 4231 test case 3",
+		  .key = repeated_bytes(0xaa, 20),
+		  .data = repeated_bytes(0xdd, 50),
+		  .digest = "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe" },
+		{ .name = "rfc 4231 test case 4",
+		  .key = counting_bytes(0x01, 0x19),
+		  .data = repeated_bytes(0xcd, 50),
+		  .digest = "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b" },
+		{ .name = "rfc 4231 test case 6",
+		  .key = repeated_bytes(0xaa, 131),
+		  .data = "Test Using Larger Than Block-Size Key - Hash Key First",
+		  .digest = "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+		{ .name = "rfc 4231 test case 7",
+		  .key = repeated_bytes(0xaa, 131),
+		  .data = "This is a test using a larger than block-size key and a larger than "
+		          "block-size data. The key needs to be hashed before being used by the HMAC "
+		          "algorithm.",
+		  .digest = "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2" },
+	};
+
+	// see https://datatracker.ietf.org/doc/html/rfc2202#section-3
+	const std::vector<TestCaseHmac> sha1_test_cases = {
+		{ .name = "rfc 2202 test case 1",
+		  .key = repeated_bytes(0x0b, 20),
+		  .data = "Hi There",
+		  .digest = "b617318655057264e28bc0b6fb378c8ef146be00" },
+		{ .name = "rfc 2202 test case 2",
+		  .key = "Jefe",
+		  .data = "what do ya want for nothing?",
+		  .digest = "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79" },
+		{ .name = "rfc 2202 test case 3",
+		  .key = repeated_bytes(0xaa, 20),
+		  .data = repeated_bytes(0xdd, 50),
+		  .digest = "125d7342b9ac11cd91a39af48aa17b4f63f175d3" },
+		{ .name = "rfc 2202 test case 4",
+		  .key = counting_bytes(0x01, 0x19),
+		  .data = repeated_bytes(0xcd, 50),
+		  .digest = "4c9007f4026250c6bc8414f9bf50c86c2d7235da" },
+		{ .name = "rfc 2202 test case 6",
+		  .key = repeated_bytes(0xaa, 80),
+		  .data = "Test Using Larger Than Block-Size Key - Hash Key First",
+		  .digest = "aa4ae5e15272d00e95705637ce8a3b55ed402112" },
+		{ .name = "rfc 2202 test case 7",
+		  .key = repeated_bytes(0xaa, 80),
+		  .data = "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data",
+		  .digest = "e8e99d0f45237d786d6bbaa7965c7808bbff1a91" },
+	};
+
+	const std::vector<TestCaseHmac>& test_cases =
+	    uses_openssl ? sha256_test_cases : sha1_test_cases;
+
+	for(const auto& test_case : test_cases) {
+
+		SUBCASE(test_case.name) {
+			[&test_case]() -> void {
+				HmacDigest digest = { .data = {}, .size = 0 };
+
+				REQUIRE_TRUE(get_hmac_digest(helpers::buffer_from_string(test_case.key),
+				                             helpers::buffer_from_string(test_case.data), &digest));
+
+				REQUIRE_EQ(hex_from_buffer(digest.data, digest.size), test_case.digest);
+			}();
+		}
+	}
+
+	SUBCASE("digests are compared completely") {
+		const ReadonlyBuffer key = helpers::buffer_from_string("key");
+
+		HmacDigest digest1 = { .data = {}, .size = 0 };
+		HmacDigest digest2 = { .data = {}, .size = 0 };
+
+		REQUIRE_TRUE(get_hmac_digest(key, helpers::buffer_from_string("data"), &digest1));
+		REQUIRE_TRUE(get_hmac_digest(key, helpers::buffer_from_string("data"), &digest2));
+		REQUIRE_TRUE(hmac_digest_eq(&digest1, &digest2));
+
+		digest2.data[digest2.size - 1] ^= 1U;
+		REQUIRE_FALSE(hmac_digest_eq(&digest1, &digest2));
+
+		digest2.data[digest2.size - 1] ^= 1U;
+		digest2.size -= 1;
+		REQUIRE_FALSE(hmac_digest_eq(&digest1, &digest2));
+
+		REQUIRE_LT(hmac_digest_get_index(&digest1, 64), 64);
+	}
+}
+
 std::vector<TestCaseBase64> base64_test_cases = {
 	{ .name = "empty string", .raw = "", .base64 = "" },
 	{ .name = "simple string", .raw = "hello world", .base64 = "aGVsbG8gd29ybGQ=" },
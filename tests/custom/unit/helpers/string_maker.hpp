@@ -85,6 +85,18 @@ template <> struct StringMaker<CompressionEntry> {
 	}
 };
 
+template <> struct StringMaker<CompressionType> {
+	static String convert(const CompressionType& type) {
+		return ::os_stream_formattable_to_doctest(type);
+	}
+};
+
+template <> struct StringMaker<HttpHeaderToken> {
+	static String convert(const HttpHeaderToken& token) {
+		return ::os_stream_formattable_to_doctest(token);
+	}
+};
+
 template <> struct StringMaker<test::DynamicTable> {
 	static String convert(const test::DynamicTable& table) {
 		return ::os_stream_formattable_to_doctest(table);
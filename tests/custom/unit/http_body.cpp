@@ -0,0 +1,419 @@
+#include <doctest.h>
+
+#include <generic/secure.h>
+#include <http/body_spool.h>
+#include <http/chunked.h>
+#include <http/parser.h>
+#include <http/protocol.h>
+
+#include <cstdio>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// parses requests from one end of a socketpair, the other end is written by the test, a request
+// that is rejected before its body is read doesn't need the body to be written at all
+class TestHttpReader {
+  private:
+	ConnectionContext* m_context;
+	int m_client_fd;
+	HTTPReader* m_reader;
+
+  public:
+	explicit TestHttpReader(HttpReaderSettings settings)
+	    : m_context{ nullptr }, m_client_fd{ -1 }, m_reader{ nullptr } {
+
+		const SecureOptions not_secure = { .type = SecureOptionsTypeNotSecure };
+		m_context = get_connection_context(&not_secure);
+		REQUIRE_TRUE(m_context != nullptr);
+
+		int fds[2] = { -1, -1 };
+		REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+		m_client_fd = fds[0];
+
+		ConnectionDescriptor* const descriptor = get_connection_descriptor(m_context, fds[1]);
+		REQUIRE_TRUE(descriptor != nullptr);
+
+		m_reader = initialize_http_reader_from_connection(descriptor, settings);
+		REQUIRE_TRUE(m_reader != nullptr);
+	}
+
+	TestHttpReader(TestHttpReader&&) = delete;
+
+	TestHttpReader(const TestHttpReader&) = delete;
+
+	TestHttpReader& operator=(const TestHttpReader&) = delete;
+
+	TestHttpReader operator=(TestHttpReader&&) = delete;
+
+	[[nodiscard]] HttpRequestResult read(const std::string& raw_request) {
+		REQUIRE_EQ(write(m_client_fd, raw_request.data(), raw_request.size()),
+		           static_cast<ssize_t>(raw_request.size()));
+
+		return get_http_request(m_reader);
+	}
+
+	~TestHttpReader() {
+		const bool finished = finish_reader(m_reader, m_context);
+		CHECK_TRUE(finished);
+		free_connection_context(m_context);
+		close(m_client_fd);
+	}
+};
+
+[[nodiscard]] std::string get_error_name(const HttpRequestResult& result) {
+	REQUIRE_TRUE(result.type == HttpRequestResultTypeError);
+	REQUIRE_FALSE(result.value.error.is_advanced);
+
+	return string_from_tstr_static(
+	    get_error_string_for_http_request_error_type(result.value.error.value.enum_value));
+}
+
+[[nodiscard]] std::string get_body(const HttpRequest& request) {
+	return std::string{ reinterpret_cast<const char*>(request.body.data), request.body.size };
+}
+
+[[nodiscard]] HttpReaderSettings get_test_reader_settings() {
+	HttpReaderSettings settings = get_default_http_reader_settings();
+	settings.max_body_size = 64;
+	settings.body_spool.threshold = 16;
+	return settings;
+}
+
+struct DecodedChunkedBody {
+	bool ok;
+	std::string body;
+	std::string error;
+	bool body_too_large;
+	size_t slices;
+	std::vector<std::pair<std::string, std::string>> trailers;
+};
+
+// runs the decoder over the whole encoded data, the connection is closed after the data, so that
+// truncated input results in an error instead of blocking
+[[nodiscard]] DecodedChunkedBody decode_chunked(const std::string& encoded,
+                                                HttpChunkedSettings settings) {
+
+	const SecureOptions not_secure = { .type = SecureOptionsTypeNotSecure };
+	ConnectionContext* const context = get_connection_context(&not_secure);
+	REQUIRE_TRUE(context != nullptr);
+
+	int fds[2] = { -1, -1 };
+	REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+	REQUIRE_EQ(write(fds[0], encoded.data(), encoded.size()),
+	           static_cast<ssize_t>(encoded.size()));
+	REQUIRE_EQ(shutdown(fds[0], SHUT_WR), 0);
+
+	ConnectionDescriptor* const descriptor = get_connection_descriptor(context, fds[1]);
+	REQUIRE_TRUE(descriptor != nullptr);
+
+	BufferedReader* const buffered_reader = get_buffered_reader(descriptor);
+	REQUIRE_TRUE(buffered_reader != nullptr);
+
+	HttpChunkedDecoder decoder = http_chunked_decoder_init(settings);
+
+	DecodedChunkedBody result = {
+		.ok = false, .body = {}, .error = {}, .body_too_large = false, .slices = 0, .trailers = {}
+	};
+
+	while(true) {
+		const HttpChunkedReadResult read_result =
+		    http_chunked_decoder_read(&decoder, buffered_reader);
+
+		if(read_result.type == HttpChunkedReadResultTypeError) {
+			result.error = string_from_tstr_static(read_result.value.error);
+			result.body_too_large = decoder.body_too_large;
+			break;
+		}
+
+		if(read_result.type == HttpChunkedReadResultTypeEnd) {
+			result.ok = true;
+			break;
+		}
+
+		result.body.append(reinterpret_cast<const char*>(read_result.value.data.data),
+		                   read_result.value.data.size);
+		++result.slices;
+	}
+
+	HttpHeaderFields trailers = http_chunked_decoder_release_trailers(&decoder);
+
+	for(size_t i = 0; i < TVEC_LENGTH(HttpHeaderField, trailers); ++i) {
+		const HttpHeaderField field = TVEC_AT(HttpHeaderField, trailers, i);
+		result.trailers.emplace_back(string_from_tstr(field.key), string_from_tstr(field.value));
+	}
+
+	free_http_header_fields(&trailers);
+	free_http_chunked_decoder(&decoder);
+
+	const bool finished = finish_buffered_reader(buffered_reader, context, false);
+	CHECK_TRUE(finished);
+	close(fds[0]);
+	free_connection_context(context);
+
+	return result;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("http_body" * doctest::description("http request body tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the size limits of request bodies <body_limits>") {
+
+	TestHttpReader reader{ get_test_reader_settings() };
+
+	SUBCASE("a content-length above the limit is rejected before reading") {
+		const HttpRequestResult result =
+		    reader.read("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 65\r\n\r\n");
+
+		REQUIRE_EQ(get_error_name(result), "PayloadTooLarge");
+	}
+
+	SUBCASE("a chunked body above the limit is rejected") {
+		const HttpRequestResult result =
+		    reader.read("POST / HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+		                "20\r\n" +
+		                std::string(32, 'a') + "\r\n21\r\n");
+
+		REQUIRE_EQ(get_error_name(result), "PayloadTooLarge");
+	}
+
+	SUBCASE("a GET request with a content-length is rejected before reading") {
+		const HttpRequestResult result =
+		    reader.read("GET / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 10\r\n\r\n");
+
+		REQUIRE_EQ(get_error_name(result), "InvalidNonEmptyBody");
+	}
+
+	SUBCASE("a HEAD request with a chunked body is rejected at the first chunk") {
+		const HttpRequestResult result =
+		    reader.read("HEAD / HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+		                "1\r\n");
+
+		REQUIRE_EQ(get_error_name(result), "InvalidNonEmptyBody");
+	}
+
+	SUBCASE("a GET request with an empty chunked body is allowed") {
+		const HttpRequestResult result = reader.read(
+		    "GET / HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n");
+
+		REQUIRE_TRUE(result.type == HttpRequestResultTypeOk);
+		REQUIRE_EQ(result.value.ok.request.body.size, 0);
+
+		free_http_request_result(result.value.ok);
+	}
+
+	SUBCASE("a body at the limit is read") {
+		const std::string body(64, 'b');
+
+		const HttpRequestResult result =
+		    reader.read("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 64\r\n\r\n" + body);
+
+		REQUIRE_TRUE(result.type == HttpRequestResultTypeOk);
+		REQUIRE_EQ(get_body(result.value.ok.request), body);
+
+		free_http_request_result(result.value.ok);
+	}
+}
+
+TEST_CASE("testing the storage of request bodies <body_spool>") {
+
+	TestHttpReader reader{ get_test_reader_settings() };
+
+	SUBCASE("a small body stays in memory") {
+		const HttpRequestResult result =
+		    reader.read("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\n\r\nhello");
+
+		REQUIRE_TRUE(result.type == HttpRequestResultTypeOk);
+
+		const HttpRequest& request = result.value.ok.request;
+		REQUIRE_TRUE(request.body_storage.type == HttpRequestBodyStorageTypeMemory);
+		REQUIRE_EQ(get_body(request), "hello");
+
+		free_http_request_result(result.value.ok);
+	}
+
+	SUBCASE("a body above the threshold is spooled") {
+		const std::string body(40, 'c');
+
+		const HttpRequestResult result =
+		    reader.read("POST / HTTP/1.1\r\nHost: localhost\r\nContent-Length: 40\r\n\r\n" + body);
+
+		REQUIRE_TRUE(result.type == HttpRequestResultTypeOk);
+
+		const HttpRequest& request = result.value.ok.request;
+		REQUIRE_TRUE(request.body_storage.type == HttpRequestBodyStorageTypeFile);
+		REQUIRE_NE(request.body_storage.fd, -1);
+		REQUIRE_EQ(get_body(request), body);
+
+		free_http_request_result(result.value.ok);
+	}
+
+	SUBCASE("a chunked body above the threshold is spooled and keeps its trailers") {
+		const HttpRequestResult result =
+		    reader.read("POST / HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+		                "a\r\n0123456789\r\nA\r\nabcdefghij\r\n0\r\nx-checksum: 42\r\n\r\n");
+
+		REQUIRE_TRUE(result.type == HttpRequestResultTypeOk);
+
+		const HttpRequest& request = result.value.ok.request;
+		REQUIRE_TRUE(request.body_storage.type == HttpRequestBodyStorageTypeFile);
+		REQUIRE_EQ(get_body(request), "0123456789abcdefghij");
+
+		REQUIRE_EQ(TVEC_LENGTH(HttpHeaderField, request.trailer_fields), 1);
+		const HttpHeaderField trailer = TVEC_AT(HttpHeaderField, request.trailer_fields, 0);
+		REQUIRE_EQ(string_from_tstr(trailer.key), "x-checksum");
+		REQUIRE_EQ(string_from_tstr(trailer.value), "42");
+
+		free_http_request_result(result.value.ok);
+	}
+}
+
+TEST_CASE("testing the chunked decoder <chunked_decoder>") {
+
+	const HttpChunkedSettings settings = get_default_http_chunked_settings();
+
+	SUBCASE("chunks with extensions are decoded") {
+		const DecodedChunkedBody result =
+		    decode_chunked("5;name=value\r\nhello\r\n6 ; ext\r\n world\r\n0\r\n\r\n", settings);
+
+		REQUIRE_TRUE(result.ok);
+		REQUIRE_EQ(result.body, "hello world");
+		REQUIRE_EQ(result.trailers.size(), 0);
+	}
+
+	SUBCASE("trailer fields are returned") {
+		const DecodedChunkedBody result =
+		    decode_chunked("3\r\nabc\r\n0\r\nx-first: 1\r\nx-second:2\r\n\r\n", settings);
+
+		REQUIRE_TRUE(result.ok);
+		REQUIRE_EQ(result.body, "abc");
+		REQUIRE_EQ(result.trailers.size(), 2);
+		REQUIRE_EQ(result.trailers[0].first, "x-first");
+		REQUIRE_EQ(result.trailers[0].second, "1");
+		REQUIRE_EQ(result.trailers[1].first, "x-second");
+		REQUIRE_EQ(result.trailers[1].second, "2");
+	}
+
+	SUBCASE("large chunks are returned in slices") {
+		const size_t size = (HTTP_CHUNKED_READ_SLICE_SIZE * 2) + 5;
+		const std::string data(size, 'd');
+
+		char size_line[32] = {};
+		REQUIRE_GT(snprintf(size_line, sizeof(size_line), "%zx\r\n", size), 0);
+
+		const DecodedChunkedBody result =
+		    decode_chunked(std::string{ size_line } + data + "\r\n0\r\n\r\n", settings);
+
+		REQUIRE_TRUE(result.ok);
+		REQUIRE_EQ(result.body, data);
+		REQUIRE_EQ(result.slices, 3);
+	}
+
+	SUBCASE("invalid chunk sizes are rejected") {
+		const std::vector<std::string> invalid_lines = {
+			"5 xyz", "5 x;ext", "5x", ";ext", "", " 5", "-5", "10000000000000000",
+		};
+
+		for(const auto& line : invalid_lines) {
+			CAPTURE(line);
+
+			const DecodedChunkedBody result =
+			    decode_chunked(line + "\r\nhello\r\n0\r\n\r\n", settings);
+
+			REQUIRE_FALSE(result.ok);
+			REQUIRE_EQ(result.error, "invalid chunk size");
+		}
+	}
+
+	SUBCASE("whitespace before the extensions is allowed") {
+		const DecodedChunkedBody result =
+		    decode_chunked("5 \t ;x\r\nhello\r\n0 \r\n\r\n", settings);
+
+		REQUIRE_TRUE(result.ok);
+		REQUIRE_EQ(result.body, "hello");
+	}
+
+	SUBCASE("chunk data has to end with a CRLF") {
+		const DecodedChunkedBody result = decode_chunked("5\r\nhelloXX0\r\n\r\n", settings);
+
+		REQUIRE_FALSE(result.ok);
+		REQUIRE_EQ(result.error, "chunk data not terminated by CRLF");
+	}
+
+	SUBCASE("truncated bodies are rejected") {
+		const DecodedChunkedBody result = decode_chunked("5\r\nhel", settings);
+
+		REQUIRE_FALSE(result.ok);
+		REQUIRE_EQ(result.error, "failed to read chunk data");
+	}
+
+	SUBCASE("the chunk and body size limits are enforced") {
+		HttpChunkedSettings small_settings = settings;
+		small_settings.max_chunk_size = 4;
+		small_settings.max_body_size = 6;
+
+		const DecodedChunkedBody too_large_chunk =
+		    decode_chunked("5\r\nhello\r\n0\r\n\r\n", small_settings);
+
+		REQUIRE_FALSE(too_large_chunk.ok);
+		REQUIRE_EQ(too_large_chunk.error, "chunk too large");
+		REQUIRE_FALSE(too_large_chunk.body_too_large);
+
+		const DecodedChunkedBody too_large_body =
+		    decode_chunked("4\r\nabcd\r\n3\r\nefg\r\n0\r\n\r\n", small_settings);
+
+		REQUIRE_FALSE(too_large_body.ok);
+		REQUIRE_EQ(too_large_body.error, "chunked body too large");
+		REQUIRE_TRUE(too_large_body.body_too_large);
+	}
+
+	SUBCASE("chunk-size and trailer lines are bounded") {
+		const std::string long_extension(HTTP_CHUNKED_MAX_LINE_LENGTH, 'e');
+
+		const DecodedChunkedBody long_size_line =
+		    decode_chunked("5;" + long_extension + "\r\nhello\r\n0\r\n\r\n", settings);
+
+		REQUIRE_FALSE(long_size_line.ok);
+		REQUIRE_EQ(long_size_line.error, "failed to read chunk size");
+
+		const DecodedChunkedBody long_trailer_line =
+		    decode_chunked("0\r\nx-long: " + long_extension + "\r\n\r\n", settings);
+
+		REQUIRE_FALSE(long_trailer_line.ok);
+		REQUIRE_EQ(long_trailer_line.error, "failed to read trailer section");
+
+		const std::string max_extension(HTTP_CHUNKED_MAX_LINE_LENGTH - 2, 'e');
+
+		const DecodedChunkedBody max_size_line =
+		    decode_chunked("5;" + max_extension + "\r\nhello\r\n0\r\n\r\n", settings);
+
+		REQUIRE_TRUE(max_size_line.ok);
+		REQUIRE_EQ(max_size_line.body, "hello");
+	}
+
+	SUBCASE("the amount of trailer fields is limited") {
+		std::string encoded = "0\r\n";
+
+		for(size_t i = 0; i <= HTTP_CHUNKED_MAX_TRAILER_FIELDS; ++i) {
+			encoded += "x-field-" + std::to_string(i) + ": value\r\n";
+		}
+
+		encoded += "\r\n";
+
+		const DecodedChunkedBody result = decode_chunked(encoded, settings);
+
+		REQUIRE_FALSE(result.ok);
+		REQUIRE_EQ(result.error, "too many trailer fields");
+	}
+}
+
+TEST_SUITE_END();
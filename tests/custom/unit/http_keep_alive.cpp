@@ -0,0 +1,284 @@
+#include <doctest.h>
+
+#include <generic/secure.h>
+#include <http/parser.h>
+#include <http/protocol.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// what the tests need of a parsed request, the request itself is freed at once, as the next read
+// invalidates the buffer, it points into
+struct ReadRequest {
+	bool ok;
+	std::string path;
+	HttpConnectionPersistenceType persistence;
+	// whether the responses would be queued, as the next request is already buffered
+	bool queue_output;
+};
+
+// parses requests from one end of a socketpair, the other end is the client of the test
+class TestKeepAliveReader {
+  private:
+	ConnectionContext* m_context;
+	int m_client_fd;
+	HTTPReader* m_reader;
+
+  public:
+	explicit TestKeepAliveReader(HttpReaderSettings settings)
+	    : m_context{ nullptr }, m_client_fd{ -1 }, m_reader{ nullptr } {
+
+		const SecureOptions not_secure = { .type = SecureOptionsTypeNotSecure };
+		m_context = get_connection_context(&not_secure);
+		REQUIRE_TRUE(m_context != nullptr);
+
+		int fds[2] = { -1, -1 };
+		REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+		m_client_fd = fds[0];
+
+		ConnectionDescriptor* const descriptor = get_connection_descriptor(m_context, fds[1]);
+		REQUIRE_TRUE(descriptor != nullptr);
+
+		m_reader = initialize_http_reader_from_connection(descriptor, settings);
+		REQUIRE_TRUE(m_reader != nullptr);
+	}
+
+	TestKeepAliveReader(TestKeepAliveReader&&) = delete;
+
+	TestKeepAliveReader(const TestKeepAliveReader&) = delete;
+
+	TestKeepAliveReader& operator=(const TestKeepAliveReader&) = delete;
+
+	TestKeepAliveReader operator=(TestKeepAliveReader&&) = delete;
+
+	void write_client(const std::string& data) const {
+		REQUIRE_EQ(write(m_client_fd, data.data(), data.size()),
+		           static_cast<ssize_t>(data.size()));
+	}
+
+	void close_client() {
+		REQUIRE_EQ(close(m_client_fd), 0);
+		m_client_fd = -1;
+	}
+
+	[[nodiscard]] ReadRequest next() {
+		const HttpRequestResult result = get_http_request(m_reader);
+
+		ReadRequest read_request = { .ok = false,
+			                         .path = {},
+			                         .persistence = HttpConnectionPersistenceTypeClose,
+			                         .queue_output = false };
+
+		if(result.type != HttpRequestResultTypeOk) {
+			return read_request;
+		}
+
+		const RequestSettings& settings = result.value.ok.settings;
+
+		read_request.ok = true;
+		read_request.persistence = settings.persistence.type;
+		read_request.queue_output = http_general_context_should_queue_http1_output(
+		    http_reader_get_general_context(m_reader));
+
+		if(settings.http_properties.type == HTTPPropertyTypeNormal) {
+			read_request.path = string_from_tstr(settings.http_properties.data.normal.path);
+		}
+
+		free_http_request_result(result.value.ok);
+
+		return read_request;
+	}
+
+	[[nodiscard]] HttpReaderWaitResult wait(uint32_t timeout_ms) const {
+		return http_reader_wait_for_next_request(m_reader, timeout_ms);
+	}
+
+	[[nodiscard]] bool more_available() const { return http_reader_more_available(m_reader); }
+
+	void disable_keep_alive() { http_reader_disable_keep_alive(m_reader); }
+
+	~TestKeepAliveReader() {
+		const bool finished = finish_reader(m_reader, m_context);
+		CHECK_TRUE(finished);
+		free_connection_context(m_context);
+
+		if(m_client_fd >= 0) {
+			close(m_client_fd);
+		}
+	}
+};
+
+[[nodiscard]] std::string get_request(const std::string& path, const std::string& version = "1.1",
+                                      const std::string& extra_headers = "") {
+	return "GET " + path + " HTTP/" + version + "\r\nHost: localhost\r\n" + extra_headers + "\r\n";
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("http_keep_alive" *
+                 doctest::description("http/1 keep-alive and pipelining tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing pipelined requests in one read <keep_alive_pipelining>") {
+
+	TestKeepAliveReader reader{ get_default_http_reader_settings() };
+
+	reader.write_client(get_request("/first") + get_request("/second") + get_request("/third"));
+
+	const ReadRequest first = reader.next();
+	REQUIRE_TRUE(first.ok);
+	REQUIRE_EQ(first.path, "/first");
+	REQUIRE_TRUE(first.persistence == HttpConnectionPersistenceTypeKeepAlive);
+	// the next request is already buffered, so the response is queued
+	REQUIRE_TRUE(first.queue_output);
+
+	// a buffered request doesn't need to wait for the connection
+	REQUIRE_TRUE(reader.wait(0) == HttpReaderWaitResultReady);
+
+	const ReadRequest second = reader.next();
+	REQUIRE_TRUE(second.ok);
+	REQUIRE_EQ(second.path, "/second");
+	REQUIRE_TRUE(second.queue_output);
+
+	REQUIRE_TRUE(reader.wait(0) == HttpReaderWaitResultReady);
+
+	const ReadRequest third = reader.next();
+	REQUIRE_TRUE(third.ok);
+	REQUIRE_EQ(third.path, "/third");
+	REQUIRE_TRUE(third.persistence == HttpConnectionPersistenceTypeKeepAlive);
+	// the input is empty, so the queued responses are written now
+	REQUIRE_FALSE(third.queue_output);
+
+	REQUIRE_TRUE(reader.more_available());
+}
+
+TEST_CASE("testing the idle timeout of keep-alive connections <keep_alive_idle_timeout>") {
+
+	HttpReaderSettings settings = get_default_http_reader_settings();
+	settings.keep_alive.idle_timeout_ms = 20;
+
+	TestKeepAliveReader reader{ settings };
+
+	reader.write_client(get_request("/"));
+
+	const ReadRequest first = reader.next();
+	REQUIRE_TRUE(first.ok);
+	REQUIRE_TRUE(first.persistence == HttpConnectionPersistenceTypeKeepAlive);
+
+	SUBCASE("an idle connection times out") {
+		const auto start = std::chrono::steady_clock::now();
+		const HttpReaderWaitResult wait_result = reader.wait(settings.keep_alive.idle_timeout_ms);
+		const auto waited = std::chrono::steady_clock::now() - start;
+
+		REQUIRE_TRUE(wait_result == HttpReaderWaitResultTimeout);
+		// poll may wake up a bit early, depending on the clock resolution
+		REQUIRE_GE(static_cast<int64_t>(
+		               std::chrono::duration_cast<std::chrono::milliseconds>(waited).count()),
+		           static_cast<int64_t>(settings.keep_alive.idle_timeout_ms) - 5);
+
+		// that is what the server does after the idle timeout, the reader is left for finish_reader
+		reader.disable_keep_alive();
+		REQUIRE_FALSE(reader.more_available());
+	}
+
+	SUBCASE("a request within the timeout is read") {
+		reader.write_client(get_request("/next"));
+
+		REQUIRE_TRUE(reader.wait(settings.keep_alive.idle_timeout_ms) == HttpReaderWaitResultReady);
+
+		const ReadRequest next = reader.next();
+		REQUIRE_TRUE(next.ok);
+		REQUIRE_EQ(next.path, "/next");
+	}
+
+	SUBCASE("a client, that closes between requests, is no error") {
+		reader.close_client();
+
+		REQUIRE_TRUE(reader.wait(settings.keep_alive.idle_timeout_ms) ==
+		             HttpReaderWaitResultClosed);
+		REQUIRE_FALSE(reader.more_available());
+	}
+}
+
+TEST_CASE("testing Connection: close in a pipeline <keep_alive_connection_close>") {
+
+	TestKeepAliveReader reader{ get_default_http_reader_settings() };
+
+	reader.write_client(get_request("/first") +
+	                    get_request("/last", "1.1", "Connection: close\r\n") +
+	                    get_request("/ignored"));
+
+	const ReadRequest first = reader.next();
+	REQUIRE_TRUE(first.ok);
+	REQUIRE_TRUE(first.persistence == HttpConnectionPersistenceTypeKeepAlive);
+
+	const ReadRequest last = reader.next();
+	REQUIRE_TRUE(last.ok);
+	REQUIRE_EQ(last.path, "/last");
+	REQUIRE_TRUE(last.persistence == HttpConnectionPersistenceTypeClose);
+
+	// the request after the close is never parsed
+	REQUIRE_FALSE(reader.more_available());
+	REQUIRE_FALSE(reader.next().ok);
+}
+
+TEST_CASE("testing the limit of requests per connection <keep_alive_max_requests>") {
+
+	HttpReaderSettings settings = get_default_http_reader_settings();
+	settings.keep_alive.max_requests = 2;
+
+	TestKeepAliveReader reader{ settings };
+
+	reader.write_client(get_request("/first") + get_request("/second"));
+
+	const ReadRequest first = reader.next();
+	REQUIRE_TRUE(first.ok);
+	REQUIRE_TRUE(first.persistence == HttpConnectionPersistenceTypeKeepAlive);
+
+	const ReadRequest second = reader.next();
+	REQUIRE_TRUE(second.ok);
+	REQUIRE_TRUE(second.persistence == HttpConnectionPersistenceTypeClose);
+	REQUIRE_FALSE(reader.more_available());
+}
+
+TEST_CASE("testing keep-alive of http/1.0 requests <keep_alive_http10>") {
+
+	TestKeepAliveReader reader{ get_default_http_reader_settings() };
+
+	SUBCASE("http/1.0 closes by default") {
+		reader.write_client(get_request("/", "1.0"));
+
+		const ReadRequest request = reader.next();
+		REQUIRE_TRUE(request.ok);
+		REQUIRE_TRUE(request.persistence == HttpConnectionPersistenceTypeClose);
+		REQUIRE_FALSE(reader.more_available());
+	}
+
+	SUBCASE("http/1.0 persists with Connection: keep-alive") {
+		reader.write_client(get_request("/first", "1.0", "Connection: keep-alive\r\n"));
+
+		const ReadRequest first = reader.next();
+		REQUIRE_TRUE(first.ok);
+		REQUIRE_TRUE(first.persistence == HttpConnectionPersistenceTypeKeepAlive);
+
+		// without the header again, the second request is the last one
+		reader.write_client(get_request("/second", "1.0"));
+
+		REQUIRE_TRUE(reader.wait(1000) == HttpReaderWaitResultReady);
+
+		const ReadRequest second = reader.next();
+		REQUIRE_TRUE(second.ok);
+		REQUIRE_EQ(second.path, "/second");
+		REQUIRE_TRUE(second.persistence == HttpConnectionPersistenceTypeClose);
+		REQUIRE_FALSE(reader.more_available());
+	}
+}
+
+TEST_SUITE_END();
@@ -7,11 +7,13 @@
 #include <http/parser.h>
 #include <http/protocol.h>
 
+#include <cstring>
 #include <memory>
 #include <ostream>
 #include <sstream>
 #include <string>
 
+#include <support/generic.hpp>
 #include <support/helpers.hpp>
 #include <support/helpers/http.hpp>
 
@@ -330,6 +332,127 @@ TEST_CASE("testing the parsing of the http request - test url path parsing <url_
 			}
 		}();
 	}
+
+	SUBCASE("path url with repeated search parameters") {
+		[]() -> void {
+			const auto parsed_path =
+			    http::ParsedURIWrapper::parse("/test?b=2&a=1&a=3&c=%20x#fragment");
+
+			REQUIRE_EQ(parsed_path.error(), TstrStaticIsNull{});
+
+			const auto& path = parsed_path.path();
+
+			const ParsedSearchPath search_path = path.search_path;
+
+			REQUIRE_EQ(TMAP_SIZE(ParsedSearchPathHashMap, &search_path.hash_map), 3);
+
+			// the first value of a repeated key is kept
+			const ParsedSearchPathEntry* entry = find_search_key(search_path, "a"_tstr_static);
+
+			REQUIRE_NE(entry, nullptr);
+
+			REQUIRE_EQ(string_from_tstr(entry->value.val), "1");
+
+			// the query is kept as it was received
+			REQUIRE_EQ(string_from_tstr(path.query), "b=2&a=1&a=3&c=%20x");
+			REQUIRE_EQ(string_from_tstr(path.fragment), "fragment");
+		}();
+	}
+}
+
+TEST_CASE("testing the tokenization of header names <header_tokens>") {
+
+	const auto get_token = [](const char* name) -> HttpHeaderToken {
+		return get_http_header_token(name, strlen(name));
+	};
+
+	SUBCASE("well known names") {
+		REQUIRE_EQ(get_token("host"), HttpHeaderTokenHost);
+		REQUIRE_EQ(get_token("accept-encoding"), HttpHeaderTokenAcceptEncoding);
+		REQUIRE_EQ(get_token("te"), HttpHeaderTokenTe);
+		REQUIRE_EQ(get_token("x-special-reason"), HttpHeaderTokenXSpecialReason);
+	}
+
+	SUBCASE("names are case insensitive") {
+		REQUIRE_EQ(get_token("Host"), HttpHeaderTokenHost);
+		REQUIRE_EQ(get_token("CONTENT-LENGTH"), HttpHeaderTokenContentLength);
+		REQUIRE_EQ(get_token("Sec-WebSocket-Key"), HttpHeaderTokenSecWebsocketKey);
+	}
+
+	SUBCASE("unknown names") {
+		REQUIRE_EQ(get_token(""), HttpHeaderTokenOther);
+		REQUIRE_EQ(get_token("hos"), HttpHeaderTokenOther);
+		REQUIRE_EQ(get_token("hostt"), HttpHeaderTokenOther);
+		REQUIRE_EQ(get_token("x-custom-header"), HttpHeaderTokenOther);
+		REQUIRE_EQ(get_token("content_length"), HttpHeaderTokenOther);
+	}
+
+	SUBCASE("lookup in the request head") {
+		HttpRequestHead head{};
+		head.header_fields = TVEC_EMPTY(HttpHeaderField);
+
+		add_http_header_field(&head.header_fields, tstr_from("X-Custom"), tstr_from("1"));
+		add_http_header_field(&head.header_fields, tstr_from("Host"), tstr_from("first"));
+		add_http_header_field(&head.header_fields, tstr_from("host"), tstr_from("second"));
+
+		index_http_request_head(&head);
+
+		const HttpHeaderField* host = find_request_header(&head, HttpHeaderTokenHost);
+		REQUIRE_NE(host, nullptr);
+		REQUIRE_EQ(string_from_tstr(host->value), "first");
+
+		REQUIRE_EQ(find_request_header(&head, HttpHeaderTokenAuthorization), nullptr);
+
+		const HttpHeaderField* custom =
+		    find_header_by_key(head.header_fields, TSTR_STATIC_LIT("x-custom"));
+		REQUIRE_NE(custom, nullptr);
+
+		free_http_header_fields(&head.header_fields);
+	}
+}
+
+TEST_CASE("testing the validation of header field characters <header_validation>") {
+
+	const auto is_valid_name = [](const std::string& name) -> bool {
+		return is_valid_http_header_field_name(helpers::tstr_view_from_str(name));
+	};
+
+	const auto is_valid_value = [](const std::string& value) -> bool {
+		return is_valid_http_header_field_value(helpers::tstr_view_from_str(value));
+	};
+
+	SUBCASE("valid names") {
+		REQUIRE_TRUE(is_valid_name("host"));
+		REQUIRE_TRUE(is_valid_name("X-Forwarded-For"));
+		REQUIRE_TRUE(is_valid_name("x_custom.header!#$%&'*+^`|~0"));
+	}
+
+	SUBCASE("invalid names") {
+		REQUIRE_FALSE(is_valid_name(""));
+		REQUIRE_FALSE(is_valid_name("x:y"));
+		REQUIRE_FALSE(is_valid_name(":path"));
+		REQUIRE_FALSE(is_valid_name("x y"));
+		REQUIRE_FALSE(is_valid_name("x\r\ny"));
+		REQUIRE_FALSE(is_valid_name(std::string("x\0y", 3)));
+		REQUIRE_FALSE(is_valid_name("x\"y"));
+		REQUIRE_FALSE(is_valid_name("\x7Fx"));
+		REQUIRE_FALSE(is_valid_name("\xC3\xA4"));
+	}
+
+	SUBCASE("valid values") {
+		REQUIRE_TRUE(is_valid_value(""));
+		REQUIRE_TRUE(is_valid_value("text/html; charset=utf-8"));
+		REQUIRE_TRUE(is_valid_value("a\tb: c"));
+		REQUIRE_TRUE(is_valid_value("\xC3\xA4"));
+	}
+
+	SUBCASE("values, that would inject header fields or requests") {
+		REQUIRE_FALSE(is_valid_value("a\r\n\r\nGET /admin HTTP/1.1"));
+		REQUIRE_FALSE(is_valid_value("a\r\nx-injected: 1"));
+		REQUIRE_FALSE(is_valid_value("a\nb"));
+		REQUIRE_FALSE(is_valid_value("a\rb"));
+		REQUIRE_FALSE(is_valid_value(std::string("a\0b", 3)));
+	}
 }
 
 TEST_SUITE_END();
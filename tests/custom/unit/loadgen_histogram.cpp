@@ -0,0 +1,167 @@
+#include <doctest.h>
+
+#include <loadgen/histogram.h>
+
+#include <cstdint>
+#include <memory>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// the histogram has a few thousand buckets, so it is kept on the heap
+[[nodiscard]] std::unique_ptr<LatencyHistogram> get_empty_histogram() {
+	auto histogram = std::make_unique<LatencyHistogram>();
+	latency_histogram_reset(histogram.get());
+	return histogram;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("loadgen_histogram" * doctest::description("loadgen latency histogram tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the percentiles of the latency histogram <loadgen_histogram_percentile>") {
+
+	const auto histogram = get_empty_histogram();
+
+	SUBCASE("an empty histogram has no values") {
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 50.0), 0);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 100.0), 0);
+		REQUIRE_EQ(latency_histogram_get_mean(histogram.get()), doctest::Approx(0.0));
+	}
+
+	SUBCASE("small values are exact") {
+		for(uint64_t i = 1; i <= 100; ++i) {
+			latency_histogram_record(histogram.get(), i);
+		}
+
+		REQUIRE_EQ(histogram->total_count, 100);
+		REQUIRE_EQ(histogram->min_value, 1);
+		REQUIRE_EQ(histogram->max_value, 100);
+
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 0.0), 1);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 50.0), 50);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 99.0), 99);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 99.9), 100);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 100.0), 100);
+
+		// out of range percentiles are clamped
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), -1.0), 1);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 200.0), 100);
+
+		REQUIRE_EQ(latency_histogram_get_mean(histogram.get()), doctest::Approx(50.5));
+	}
+
+	SUBCASE("big values are within the relative error") {
+		constexpr uint64_t value = 1000;
+		constexpr uint64_t outlier = 1000000;
+
+		for(size_t i = 0; i < 99; ++i) {
+			latency_histogram_record(histogram.get(), value);
+		}
+
+		latency_histogram_record(histogram.get(), outlier);
+
+		const uint64_t median = latency_histogram_get_percentile(histogram.get(), 50.0);
+		REQUIRE_GE(median, value);
+		REQUIRE_LE(median, value + (value / LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT));
+
+		const uint64_t p99 = latency_histogram_get_percentile(histogram.get(), 99.0);
+		REQUIRE_GE(p99, value);
+		REQUIRE_LE(p99, value + (value / LATENCY_HISTOGRAM_SUB_BUCKET_HALF_COUNT));
+
+		// the highest value is clamped to the recorded maximum
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 100.0), outlier);
+	}
+
+	SUBCASE("values, that are too big for the histogram, are reported as the maximum") {
+		latency_histogram_record(histogram.get(), 1);
+		latency_histogram_record(histogram.get(), UINT64_MAX);
+
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 50.0), 1);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 100.0), UINT64_MAX);
+	}
+
+	SUBCASE("merged histograms have the values of both") {
+		const auto other = get_empty_histogram();
+
+		latency_histogram_record(histogram.get(), 10);
+		latency_histogram_record(other.get(), 5);
+		latency_histogram_record(other.get(), 20);
+
+		latency_histogram_merge(histogram.get(), other.get());
+
+		REQUIRE_EQ(histogram->total_count, 3);
+		REQUIRE_EQ(histogram->min_value, 5);
+		REQUIRE_EQ(histogram->max_value, 20);
+		REQUIRE_EQ(latency_histogram_get_percentile(histogram.get(), 50.0), 10);
+		REQUIRE_EQ(latency_histogram_get_mean(histogram.get()), doctest::Approx(35.0 / 3.0));
+	}
+}
+
+TEST_CASE("testing the coordinated omission correction of the latency histogram "
+          "<loadgen_histogram_corrected>") {
+
+	const auto source = get_empty_histogram();
+	const auto corrected = get_empty_histogram();
+
+	constexpr uint64_t interval = 10;
+
+	SUBCASE("a slow response adds the requests, that would have been sent in the meantime") {
+		for(size_t i = 0; i < 10; ++i) {
+			latency_histogram_record(source.get(), interval);
+		}
+
+		latency_histogram_record(source.get(), interval * 10);
+
+		latency_histogram_copy_corrected(corrected.get(), source.get(), interval);
+
+		// 90, 80, ..., 10 are added for the slow response
+		REQUIRE_EQ(corrected->total_count, 20);
+		REQUIRE_EQ(corrected->min_value, interval);
+		REQUIRE_EQ(corrected->max_value, interval * 10);
+
+		REQUIRE_EQ(latency_histogram_get_percentile(source.get(), 90.0), interval);
+		REQUIRE_EQ(latency_histogram_get_percentile(corrected.get(), 90.0), interval * 8);
+		REQUIRE_EQ(latency_histogram_get_percentile(corrected.get(), 100.0), interval * 10);
+
+		REQUIRE_EQ(latency_histogram_get_mean(corrected.get()), doctest::Approx(650.0 / 20.0));
+
+		// the source is not changed
+		REQUIRE_EQ(source->total_count, 11);
+	}
+
+	SUBCASE("responses within the interval are not corrected") {
+		latency_histogram_record(source.get(), 3);
+		latency_histogram_record(source.get(), interval);
+
+		latency_histogram_copy_corrected(corrected.get(), source.get(), interval);
+
+		REQUIRE_EQ(corrected->total_count, 2);
+		REQUIRE_EQ(latency_histogram_get_percentile(corrected.get(), 50.0), 3);
+		REQUIRE_EQ(latency_histogram_get_percentile(corrected.get(), 100.0), interval);
+	}
+
+	SUBCASE("an interval of 0 only copies the histogram") {
+		latency_histogram_record(source.get(), 1000);
+		latency_histogram_record(source.get(), 5);
+
+		latency_histogram_copy_corrected(corrected.get(), source.get(), 0);
+
+		REQUIRE_EQ(corrected->total_count, 2);
+		REQUIRE_EQ(corrected->min_value, 5);
+		REQUIRE_EQ(corrected->max_value, 1000);
+	}
+
+	SUBCASE("an empty histogram stays empty") {
+		latency_histogram_record(corrected.get(), 5);
+
+		latency_histogram_copy_corrected(corrected.get(), source.get(), interval);
+
+		REQUIRE_EQ(corrected->total_count, 0);
+		REQUIRE_EQ(latency_histogram_get_percentile(corrected.get(), 50.0), 0);
+	}
+}
+
+TEST_SUITE_END();
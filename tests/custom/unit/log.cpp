@@ -0,0 +1,292 @@
+#include <doctest.h>
+
+#include <utils/log.h>
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// the same as LOG_MESSAGE without a prelude
+void log_test_message(const std::string& message) {
+	LogRecordWriter writer = log_begin_record(false);
+	log_record_printf(&writer, "%s\n", message.c_str());
+	log_end_record(&writer);
+}
+
+[[nodiscard]] std::vector<std::string> split_lines(const std::string& output) {
+	std::vector<std::string> lines{};
+	std::istringstream stream{ output };
+
+	for(std::string line; std::getline(stream, line);) {
+		lines.push_back(line);
+	}
+
+	return lines;
+}
+
+// restarts the logger, so that it writes into a pipe, the pipe is read by a thread, that collects
+// the output, if reading is delayed, the flusher blocks, as soon as the pipe is full
+class LogCapture {
+  private:
+	LogLevel m_previous_level;
+	int m_read_fd;
+	FILE* m_file;
+	std::thread m_reader;
+	std::mutex m_mutex;
+	std::string m_output;
+	bool m_finished;
+
+	void read_output() {
+		char buffer[1024];
+
+		while(true) {
+			const ssize_t result = read(m_read_fd, buffer, sizeof(buffer));
+
+			if(result <= 0) {
+				break;
+			}
+
+			const std::lock_guard<std::mutex> lock{ m_mutex };
+			m_output.append(buffer, static_cast<size_t>(result));
+		}
+	}
+
+  public:
+	explicit LogCapture(bool read_immediately)
+	    : m_previous_level{ get_log_level() },
+	      m_read_fd{ -1 },
+	      m_file{ nullptr },
+	      m_reader{},
+	      m_mutex{},
+	      m_output{},
+	      m_finished{ false } {
+
+		int fds[2] = {};
+		REQUIRE_EQ(pipe(fds), 0);
+
+		m_read_fd = fds[0];
+		m_file = fdopen(fds[1], "w");
+		REQUIRE_NE(m_file, nullptr);
+
+		shutdown_logger();
+		set_log_output(m_file, m_file);
+		initialize_logger();
+		set_log_level(LogLevelInfo);
+
+		if(read_immediately) {
+			start_reading();
+		}
+	}
+
+	LogCapture(LogCapture&&) = delete;
+
+	LogCapture(const LogCapture&) = delete;
+
+	LogCapture& operator=(const LogCapture&) = delete;
+
+	LogCapture operator=(LogCapture&&) = delete;
+
+	~LogCapture() { UNUSED(finish()); }
+
+	void start_reading() {
+		if(!m_reader.joinable()) {
+			m_reader = std::thread{ [this]() { read_output(); } };
+		}
+	}
+
+	[[nodiscard]] std::string get_output() {
+		const std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_output;
+	}
+
+	// waits, until the output contains the needle
+	[[nodiscard]] bool wait_for_output(const std::string& needle,
+	                                   std::chrono::milliseconds timeout) {
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		while(std::chrono::steady_clock::now() < deadline) {
+			if(get_output().find(needle) != std::string::npos) {
+				return true;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		return get_output().find(needle) != std::string::npos;
+	}
+
+	// stops the logger, restores the normal output and returns everything, that was written
+	[[nodiscard]] std::string finish() {
+		if(m_finished) {
+			return get_output();
+		}
+
+		m_finished = true;
+
+		start_reading();
+
+		shutdown_logger();
+		set_log_output(nullptr, nullptr);
+
+		fclose(m_file);
+		m_reader.join();
+		close(m_read_fd);
+
+		initialize_logger();
+		set_log_level(m_previous_level);
+
+		return get_output();
+	}
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN("log" * doctest::description("logger tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the order of log messages <log_order>") {
+
+	LogCapture capture{ true };
+
+	constexpr size_t thread_amount = 4;
+	// less than a ring holds, so that nothing is dropped
+	constexpr size_t messages_per_thread = 50;
+
+	log_test_message("first");
+
+	std::vector<std::thread> threads{};
+
+	for(size_t thread_index = 0; thread_index < thread_amount; ++thread_index) {
+		threads.emplace_back([thread_index]() {
+			for(size_t i = 0; i < messages_per_thread; ++i) {
+				log_test_message("thread " + std::to_string(thread_index) + " message " +
+				                 std::to_string(i));
+			}
+		});
+	}
+
+	for(auto& thread : threads) {
+		thread.join();
+	}
+
+	// the threads exited, so their rings are abandoned, but they are still written
+	log_test_message("last");
+
+	const std::vector<std::string> lines = split_lines(capture.finish());
+
+	REQUIRE_EQ(lines.size(), (thread_amount * messages_per_thread) + 2);
+	REQUIRE_EQ(lines.front(), "first");
+	REQUIRE_EQ(lines.back(), "last");
+
+	// the messages of every thread are in the order, they were logged in
+	std::vector<size_t> next_message(thread_amount, 0);
+
+	for(size_t i = 1; i + 1 < lines.size(); ++i) {
+		size_t thread = 0;
+		size_t message = 0;
+
+		REQUIRE_EQ(sscanf(lines[i].c_str(), "thread %zu message %zu", &thread, &message), 2);
+		REQUIRE_LT(thread, thread_amount);
+		REQUIRE_EQ(message, next_message[thread]);
+
+		++next_message[thread];
+	}
+}
+
+TEST_CASE("testing dropped log messages <log_drop>") {
+
+	// the pipe isn't read, so the flusher blocks and the ring of this thread fills up
+	LogCapture capture{ false };
+
+	constexpr size_t message_amount = 4000;
+	const std::string padding(90, 'x');
+
+	for(size_t i = 0; i < message_amount; ++i) {
+		log_test_message("message " + std::to_string(i) + " " + padding);
+	}
+
+	const std::vector<std::string> lines = split_lines(capture.finish());
+
+	size_t written = 0;
+	size_t dropped = 0;
+	size_t last_message = 0;
+
+	for(const auto& line : lines) {
+		size_t number = 0;
+
+		if(sscanf(line.c_str(), "message %zu", &number) == 1) {
+			if(written > 0) {
+				REQUIRE_GT(number, last_message);
+			}
+
+			last_message = number;
+			++written;
+			continue;
+		}
+
+		const size_t position = line.find("Dropped ");
+		REQUIRE_NE(position, std::string::npos);
+
+		REQUIRE_EQ(sscanf(line.c_str() + position, "Dropped %zu log messages", &number), 1);
+		dropped += number;
+	}
+
+	REQUIRE_GT(dropped, 0);
+	REQUIRE_EQ(written + dropped, message_amount);
+}
+
+TEST_CASE("testing the shutdown of the logger <log_shutdown>") {
+
+	LogCapture capture{ true };
+
+	SUBCASE("a record, that was started before the shutdown, is written") {
+		LogRecordWriter writer = log_begin_record(false);
+		REQUIRE_NE(writer.record, nullptr);
+
+		std::thread stopper{ []() { shutdown_logger(); } };
+
+		// the shutdown waits for the record
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		log_record_printf(&writer, "%s\n", "started before the shutdown");
+		log_end_record(&writer);
+
+		stopper.join();
+
+		// the logger isn't running anymore, so this is written synchronously
+		LogRecordWriter after_writer = log_begin_record(false);
+		CHECK_EQ(after_writer.record, nullptr);
+		log_record_printf(&after_writer, "%s\n", "after the shutdown");
+		log_end_record(&after_writer);
+
+		const std::vector<std::string> lines = split_lines(capture.finish());
+
+		REQUIRE_EQ(lines.size(), 2);
+		REQUIRE_EQ(lines[0], "started before the shutdown");
+		REQUIRE_EQ(lines[1], "after the shutdown");
+	}
+
+	SUBCASE("an idle flusher is woken up by a new record") {
+		log_test_message("first");
+		REQUIRE_TRUE(capture.wait_for_output("first", std::chrono::milliseconds(1000)));
+
+		// the flusher waits for new records now
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		log_test_message("second");
+
+		// that is shorter than the idle interval of the flusher
+		REQUIRE_TRUE(capture.wait_for_output("second", std::chrono::milliseconds(500)));
+	}
+}
+
+TEST_SUITE_END();
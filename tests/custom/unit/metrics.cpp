@@ -0,0 +1,239 @@
+#include <doctest.h>
+
+#include <utils/metrics.h>
+
+#include <array>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+// the registry is global, this frees everything, that a test case registered
+class TestMetricsRegistry {
+  public:
+	TestMetricsRegistry() = default;
+
+	TestMetricsRegistry(TestMetricsRegistry&&) = delete;
+
+	TestMetricsRegistry(const TestMetricsRegistry&) = delete;
+
+	TestMetricsRegistry& operator=(const TestMetricsRegistry&) = delete;
+
+	TestMetricsRegistry operator=(TestMetricsRegistry&&) = delete;
+
+	~TestMetricsRegistry() { global_free_metrics(); }
+
+	[[nodiscard]] static std::string to_text() {
+		StringBuilder* string_builder = metrics_to_prometheus_text();
+		REQUIRE_TRUE(string_builder != nullptr);
+
+		char* text = string_builder_release_into_string(&string_builder);
+
+		if(text == nullptr) {
+			// an empty registry has no string
+			return "";
+		}
+
+		std::string result{ text };
+		free(text);
+		return result;
+	}
+};
+
+[[nodiscard]] MetricsLabels get_no_labels() {
+	return MetricsLabels{ .labels = nullptr, .label_amount = 0 };
+}
+
+int64_t get_test_gauge_value(void* data) {
+	return *static_cast<const int64_t*>(data);
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("metrics" * doctest::description("metrics registry tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the prometheus text of counters and gauges <metrics_text>") {
+
+	const TestMetricsRegistry registry{};
+
+	SUBCASE("counters, gauges and callback gauges") {
+		MetricsCounter* counter =
+		    metrics_register_counter("test_requests_total", "The requests", get_no_labels());
+		REQUIRE_TRUE(counter != nullptr);
+
+		const std::array<MetricsLabel, 1> labels = { MetricsLabel{ .name = "kind",
+			                                                       .value = "a" } };
+
+		MetricsGauge* gauge = metrics_register_gauge(
+		    "test_connections", "The connections",
+		    MetricsLabels{ .labels = labels.data(), .label_amount = labels.size() });
+		REQUIRE_TRUE(gauge != nullptr);
+
+		int64_t callback_value = 42;
+		REQUIRE_TRUE(metrics_register_gauge_callback("test_workers", "The workers",
+		                                             get_no_labels(), get_test_gauge_value,
+		                                             &callback_value));
+
+		// every thread writes to its own shard, the export sums them up
+		constexpr size_t thread_amount = 4;
+		constexpr size_t increments_per_thread = 1000;
+
+		std::vector<std::thread> threads{};
+
+		for(size_t i = 0; i < thread_amount; ++i) {
+			threads.emplace_back([counter, gauge]() {
+				for(size_t j = 0; j < increments_per_thread; ++j) {
+					metrics_counter_increment(counter);
+				}
+
+				metrics_gauge_add(gauge, 1);
+			});
+		}
+
+		for(auto& thread : threads) {
+			thread.join();
+		}
+
+		// this shard gets negative, only the sum is meaningful
+		metrics_gauge_add(gauge, -1);
+
+		REQUIRE_EQ(TestMetricsRegistry::to_text(), "# HELP test_requests_total The requests\n"
+		                                           "# TYPE test_requests_total counter\n"
+		                                           "test_requests_total 4000\n"
+		                                           "# HELP test_connections The connections\n"
+		                                           "# TYPE test_connections gauge\n"
+		                                           "test_connections{kind=\"a\"} 3\n"
+		                                           "# HELP test_workers The workers\n"
+		                                           "# TYPE test_workers gauge\n"
+		                                           "test_workers 42\n");
+
+		callback_value = -7;
+
+		const std::string text = TestMetricsRegistry::to_text();
+		REQUIRE_NE(text.find("\ntest_workers -7\n"), std::string::npos);
+	}
+
+	SUBCASE("metrics with the same name are exported as one family") {
+		const std::array<MetricsLabel, 1> first_labels = { MetricsLabel{ .name = "class",
+			                                                             .value = "2xx" } };
+		const std::array<MetricsLabel, 1> second_labels = { MetricsLabel{ .name = "class",
+			                                                              .value = "5xx" } };
+
+		MetricsCounter* first = metrics_register_counter(
+		    "test_responses_total", "The responses",
+		    MetricsLabels{ .labels = first_labels.data(), .label_amount = first_labels.size() });
+		MetricsCounter* other =
+		    metrics_register_counter("test_other_total", "Something else", get_no_labels());
+		MetricsCounter* second = metrics_register_counter(
+		    "test_responses_total", "The responses",
+		    MetricsLabels{ .labels = second_labels.data(), .label_amount = second_labels.size() });
+
+		REQUIRE_TRUE(first != nullptr);
+		REQUIRE_TRUE(other != nullptr);
+		REQUIRE_TRUE(second != nullptr);
+
+		metrics_counter_add(first, 2);
+		metrics_counter_add(second, 1);
+
+		REQUIRE_EQ(TestMetricsRegistry::to_text(), "# HELP test_responses_total The responses\n"
+		                                           "# TYPE test_responses_total counter\n"
+		                                           "test_responses_total{class=\"2xx\"} 2\n"
+		                                           "test_responses_total{class=\"5xx\"} 1\n"
+		                                           "# HELP test_other_total Something else\n"
+		                                           "# TYPE test_other_total counter\n"
+		                                           "test_other_total 0\n");
+	}
+
+	SUBCASE("label values are escaped") {
+		const std::array<MetricsLabel, 2> labels = {
+			MetricsLabel{ .name = "path", .value = "a\"b\\c\nd" },
+			MetricsLabel{ .name = "method", .value = "GET" },
+		};
+
+		MetricsCounter* counter = metrics_register_counter(
+		    "test_escaped_total", "Escaped labels",
+		    MetricsLabels{ .labels = labels.data(), .label_amount = labels.size() });
+		REQUIRE_TRUE(counter != nullptr);
+
+		const std::string text = TestMetricsRegistry::to_text();
+		REQUIRE_NE(text.find("\ntest_escaped_total{path=\"a\\\"b\\\\c\\nd\",method=\"GET\"} 0\n"),
+		           std::string::npos);
+	}
+
+	SUBCASE("null metrics are ignored") {
+		metrics_counter_add(nullptr, 1);
+		metrics_counter_increment(nullptr);
+		metrics_gauge_add(nullptr, 1);
+		metrics_histogram_observe(nullptr, 1);
+
+		REQUIRE_EQ(TestMetricsRegistry::to_text(), "");
+	}
+}
+
+TEST_CASE("testing the prometheus text of histograms <metrics_histogram>") {
+
+	const TestMetricsRegistry registry{};
+
+	const std::array<uint64_t, 3> bounds = { 10, 100, 1000 };
+
+	SUBCASE("buckets are cumulative and scaled") {
+		const std::array<MetricsLabel, 1> labels = { MetricsLabel{ .name = "route",
+			                                                       .value = "/x" } };
+
+		MetricsHistogram* histogram = metrics_register_histogram(
+		    "test_duration_seconds", "The duration",
+		    MetricsLabels{ .labels = labels.data(), .label_amount = labels.size() },
+		    MetricsHistogramOptions{
+		        .bounds = bounds.data(), .bound_amount = bounds.size(), .scale = 0.001 });
+		REQUIRE_TRUE(histogram != nullptr);
+
+		// a value on a bound is counted in the bucket of that bound
+		metrics_histogram_observe(histogram, 5);
+		metrics_histogram_observe(histogram, 10);
+		metrics_histogram_observe(histogram, 50);
+		metrics_histogram_observe(histogram, 5000);
+
+		REQUIRE_EQ(TestMetricsRegistry::to_text(),
+		           "# HELP test_duration_seconds The duration\n"
+		           "# TYPE test_duration_seconds histogram\n"
+		           "test_duration_seconds_bucket{route=\"/x\",le=\"0.01\"} 2\n"
+		           "test_duration_seconds_bucket{route=\"/x\",le=\"0.1\"} 3\n"
+		           "test_duration_seconds_bucket{route=\"/x\",le=\"1\"} 3\n"
+		           "test_duration_seconds_bucket{route=\"/x\",le=\"+Inf\"} 4\n"
+		           "test_duration_seconds_sum{route=\"/x\"} 5.065\n"
+		           "test_duration_seconds_count{route=\"/x\"} 4\n");
+	}
+
+	SUBCASE("the bounds have to be ascending and limited") {
+		const std::array<uint64_t, 3> unordered_bounds = { 10, 10, 100 };
+
+		REQUIRE_TRUE(metrics_register_histogram("test_unordered", "Unordered", get_no_labels(),
+		                                        MetricsHistogramOptions{
+		                                            .bounds = unordered_bounds.data(),
+		                                            .bound_amount = unordered_bounds.size(),
+		                                            .scale = 1.0,
+		                                        }) == nullptr);
+
+		std::array<uint64_t, METRICS_HISTOGRAM_MAX_BUCKETS + 1> too_many_bounds{};
+
+		for(size_t i = 0; i < too_many_bounds.size(); ++i) {
+			too_many_bounds[i] = i + 1;
+		}
+
+		REQUIRE_TRUE(metrics_register_histogram("test_too_many", "Too many", get_no_labels(),
+		                                        MetricsHistogramOptions{
+		                                            .bounds = too_many_bounds.data(),
+		                                            .bound_amount = too_many_bounds.size(),
+		                                            .scale = 1.0,
+		                                        }) == nullptr);
+
+		REQUIRE_EQ(TestMetricsRegistry::to_text(), "");
+	}
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,221 @@
+#include <doctest.h>
+
+#include <utils/offload_pool.h>
+
+#include <future>
+#include <thread>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+class TestOffloadPool {
+  public:
+	explicit TestOffloadPool(OffloadPoolOptions options,
+	                         const ThreadPool* connection_pool = nullptr) {
+		REQUIRE_TRUE(global_initialize_offload_pool(options, connection_pool));
+	}
+
+	TestOffloadPool(TestOffloadPool&&) = delete;
+
+	TestOffloadPool(const TestOffloadPool&) = delete;
+
+	TestOffloadPool& operator=(const TestOffloadPool&) = delete;
+
+	TestOffloadPool operator=(TestOffloadPool&&) = delete;
+
+	~TestOffloadPool() { global_free_offload_pool(); }
+};
+
+// the connection workers are only counted, no job is submitted to them
+class TestConnectionPool {
+  public:
+	explicit TestConnectionPool(size_t workers) {
+		REQUIRE_TRUE(pool_create(&m_pool, workers).error == CreateErrorNone);
+	}
+
+	TestConnectionPool(TestConnectionPool&&) = delete;
+
+	TestConnectionPool(const TestConnectionPool&) = delete;
+
+	TestConnectionPool& operator=(const TestConnectionPool&) = delete;
+
+	TestConnectionPool operator=(TestConnectionPool&&) = delete;
+
+	~TestConnectionPool() { UNUSED(pool_destroy(&m_pool)); }
+
+	[[nodiscard]] const ThreadPool* get() const { return &m_pool; }
+
+  private:
+	ThreadPool m_pool{};
+};
+
+struct ThreadRecord {
+	bool was_run;
+	std::thread::id thread_id;
+};
+
+void record_thread(void* argument) {
+	auto* record = static_cast<ThreadRecord*>(argument);
+	record->was_run = true;
+	record->thread_id = std::this_thread::get_id();
+}
+
+// blocks an offload thread, until the test releases it
+struct BlockingJob {
+	std::promise<void> started;
+	std::future<void> release;
+};
+
+void run_blocking_job(void* argument) {
+	auto* job = static_cast<BlockingJob*>(argument);
+	job->started.set_value();
+	job->release.wait();
+}
+
+struct NestedJob {
+	OffloadResult nested_result;
+	ThreadRecord outer;
+	ThreadRecord inner;
+};
+
+void run_nested_job(void* argument) {
+	auto* job = static_cast<NestedJob*>(argument);
+	record_thread(&job->outer);
+	job->nested_result = offload_run(record_thread, &job->inner);
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("offload_pool" * doctest::description("offload pool tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing where offloaded functions run <offload_pool_run>") {
+
+	SUBCASE("without a pool the function is run inline") {
+		ThreadRecord record{ .was_run = false, .thread_id = {} };
+
+		REQUIRE_TRUE(offload_run(record_thread, &record) == OffloadResultOk);
+
+		REQUIRE_TRUE(record.was_run);
+		REQUIRE_TRUE(record.thread_id == std::this_thread::get_id());
+	}
+
+	SUBCASE("with a pool the function is run on an offload thread") {
+		const TestOffloadPool pool{ OffloadPoolOptions{ .threads = 1, .max_pending = 0 } };
+
+		ThreadRecord record{ .was_run = false, .thread_id = {} };
+
+		REQUIRE_TRUE(offload_run(record_thread, &record) == OffloadResultOk);
+
+		REQUIRE_TRUE(record.was_run);
+		REQUIRE_TRUE(record.thread_id != std::this_thread::get_id());
+		REQUIRE_EQ(offload_pool_get_outstanding_jobs(), 0);
+	}
+
+	SUBCASE("offloaded functions, that offload work themselves, run it inline") {
+		// the nested call would be rejected, if it used the pool
+		const TestOffloadPool pool{ OffloadPoolOptions{ .threads = 1, .max_pending = 0 } };
+
+		NestedJob job{ .nested_result = OffloadResultError,
+			           .outer = { .was_run = false, .thread_id = {} },
+			           .inner = { .was_run = false, .thread_id = {} } };
+
+		REQUIRE_TRUE(offload_run(run_nested_job, &job) == OffloadResultOk);
+
+		REQUIRE_TRUE(job.nested_result == OffloadResultOk);
+		REQUIRE_TRUE(job.inner.was_run);
+		REQUIRE_TRUE(job.inner.thread_id == job.outer.thread_id);
+		REQUIRE_TRUE(job.outer.thread_id != std::this_thread::get_id());
+	}
+}
+
+TEST_CASE("testing the rejection of a full offload pool <offload_pool_reject>") {
+
+	const TestOffloadPool pool{ OffloadPoolOptions{ .threads = 1, .max_pending = 0 } };
+
+	std::promise<void> release{};
+
+	BlockingJob job{ .started = {}, .release = release.get_future() };
+	std::future<void> started = job.started.get_future();
+
+	OffloadResult blocking_result = OffloadResultError;
+
+	std::thread blocking_thread{ [&job, &blocking_result]() {
+		blocking_result = offload_run(run_blocking_job, &job);
+	} };
+
+	started.wait();
+
+	const size_t blocked_outstanding = offload_pool_get_outstanding_jobs();
+
+	// the only thread is busy and nothing may wait, so this is rejected at once
+	ThreadRecord record{ .was_run = false, .thread_id = {} };
+	const OffloadResult rejected_result = offload_run(record_thread, &record);
+
+	// the thread has to be joined, before anything is required
+	release.set_value();
+	blocking_thread.join();
+
+	REQUIRE_EQ(blocked_outstanding, 1);
+	REQUIRE_TRUE(rejected_result == OffloadResultRejected);
+	REQUIRE_FALSE(record.was_run);
+
+	REQUIRE_TRUE(blocking_result == OffloadResultOk);
+	REQUIRE_EQ(offload_pool_get_outstanding_jobs(), 0);
+
+	// after the blocking job finished, there is room again
+	REQUIRE_TRUE(offload_run(record_thread, &record) == OffloadResultOk);
+	REQUIRE_TRUE(record.was_run);
+}
+
+TEST_CASE("testing the cap by the connection workers <offload_pool_connection_cap>") {
+
+	// half of the 4 connection workers may wait for the offload pool, not 1 + 64
+	const TestConnectionPool connection_pool{ 4 };
+	const TestOffloadPool pool{ OffloadPoolOptions{ .threads = 1, .max_pending = 64 },
+		                        connection_pool.get() };
+
+	std::promise<void> release{};
+
+	// the first job runs, the second waits for the only offload thread
+	BlockingJob running_job{ .started = {}, .release = release.get_future() };
+	std::future<void> running_started = running_job.started.get_future();
+
+	OffloadResult running_result = OffloadResultError;
+	OffloadResult waiting_result = OffloadResultError;
+	ThreadRecord waiting_record{ .was_run = false, .thread_id = {} };
+
+	std::thread running_thread{ [&running_job, &running_result]() {
+		running_result = offload_run(run_blocking_job, &running_job);
+	} };
+
+	running_started.wait();
+
+	std::thread waiting_thread{ [&waiting_record, &waiting_result]() {
+		waiting_result = offload_run(record_thread, &waiting_record);
+	} };
+
+	// the waiting job is counted, before it is submitted
+	while(offload_pool_get_outstanding_jobs() < 2) {
+		std::this_thread::yield();
+	}
+
+	ThreadRecord record{ .was_run = false, .thread_id = {} };
+	const OffloadResult rejected_result = offload_run(record_thread, &record);
+
+	// the threads have to be joined, before anything is required
+	release.set_value();
+	running_thread.join();
+	waiting_thread.join();
+
+	REQUIRE_TRUE(rejected_result == OffloadResultRejected);
+	REQUIRE_FALSE(record.was_run);
+
+	REQUIRE_TRUE(running_result == OffloadResultOk);
+	REQUIRE_TRUE(waiting_result == OffloadResultOk);
+	REQUIRE_TRUE(waiting_record.was_run);
+	REQUIRE_EQ(offload_pool_get_outstanding_jobs(), 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,417 @@
+#include <doctest.h>
+
+#include <http/response_cache.h>
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+using TestHeaders = std::vector<std::pair<const char*, const char*>>;
+
+struct TestJoinResult {
+	std::optional<std::string> body;
+	HTTPResponseCacheFlight* flight;
+};
+
+[[nodiscard]] std::string string_from_buffer(const SizedBuffer buffer) {
+	return std::string{ static_cast<const char*>(buffer.data), buffer.size };
+}
+
+[[nodiscard]] ReadonlyBuffer buffer_from_string(const std::string& value) {
+	return ReadonlyBuffer{ .data = value.data(), .size = value.size() };
+}
+
+class TestResponseCache {
+  private:
+	HTTPResponseCache* m_cache;
+
+  public:
+	explicit TestResponseCache(HTTPResponseCacheOptions options)
+	    : m_cache{ initialize_http_response_cache(options) } {
+		REQUIRE_TRUE(m_cache != nullptr);
+	}
+
+	TestResponseCache(TestResponseCache&&) = delete;
+
+	TestResponseCache(const TestResponseCache&) = delete;
+
+	TestResponseCache& operator=(const TestResponseCache&) = delete;
+
+	TestResponseCache operator=(TestResponseCache&&) = delete;
+
+	~TestResponseCache() { free_http_response_cache(m_cache); }
+
+	[[nodiscard]] HTTPResponseCache* get() const { return m_cache; }
+
+	// the returned key is owned by the caller
+	[[nodiscard]] SizedBuffer get_key(const std::string& uri,
+	                                  HTTPRequestMethod method = HTTPRequestMethodGet,
+	                                  const TestHeaders& headers = {}) const {
+		const auto parsed_uri = http::ParsedURIWrapper::parse(uri);
+		REQUIRE_EQ(parsed_uri.error(), TstrStaticIsNull{});
+
+		HttpRequest request{};
+		request.head.request_line.method = method;
+		request.head.request_line.uri = parsed_uri.request_uri();
+		request.head.request_line.protocol_data.version = HTTPProtocolVersion1Dot1;
+		request.head.header_fields = TVEC_EMPTY(HttpHeaderField);
+		request.trailer_fields = TVEC_EMPTY(HttpHeaderField);
+
+		for(const auto& [name, value] : headers) {
+			add_http_header_field(&request.head.header_fields, tstr_from_string(name),
+			                      tstr_from_string(value));
+		}
+
+		index_http_request_head(&request.head);
+
+		const SizedBuffer key = http_response_cache_get_key(m_cache, request, parsed_uri.path());
+
+		free_http_header_fields(&request.head.header_fields);
+
+		REQUIRE_TRUE(key.data != nullptr);
+
+		return key;
+	}
+
+	[[nodiscard]] std::string get_key_string(const std::string& uri,
+	                                         HTTPRequestMethod method = HTTPRequestMethodGet,
+	                                         const TestHeaders& headers = {}) const {
+		const SizedBuffer key = get_key(uri, method, headers);
+		std::string result = string_from_buffer(key);
+		free_sized_buffer(key);
+		return result;
+	}
+
+	void put(const std::string& uri, const std::string& body,
+	         HTTPResponseCacheFlight* flight = nullptr) {
+		HTTPResponseCacheEntry* entry = http_response_cache_put(
+		    m_cache, get_key(uri), HttpStatusOk, TSTR_LIT("text/plain"), buffer_from_string(body),
+		    CompressionTypeNone, flight);
+		REQUIRE_TRUE(entry != nullptr);
+
+		http_response_cache_release(entry);
+	}
+
+	// returns the cached body, or nothing on a miss
+	[[nodiscard]] std::optional<std::string>
+	get_body(const std::string& uri, HTTPRequestMethod method = HTTPRequestMethodGet,
+	         CompressionType format = CompressionTypeNone) const {
+		const SizedBuffer key = get_key(uri, method);
+
+		HTTPResponseCacheEntry* entry = http_response_cache_get(m_cache, key, format);
+
+		free_sized_buffer(key);
+
+		if(entry == nullptr) {
+			return std::nullopt;
+		}
+
+		const PrebuiltHttpResponse* response = http_response_cache_entry_get_response(entry);
+
+		const HttpStatusCode status = prebuilt_http_response_get_status(response);
+		std::string body = string_from_buffer(prebuilt_http_response_get_body(response));
+
+		http_response_cache_release(entry);
+
+		REQUIRE_TRUE(status == HttpStatusOk);
+
+		return body;
+	}
+
+	// this doesn't require anything, so that it can be called by other threads
+	[[nodiscard]] TestJoinResult get_or_join(const SizedBuffer key, CompressionType format) const {
+		HTTPResponseCacheFlight* flight = nullptr;
+
+		HTTPResponseCacheEntry* entry =
+		    http_response_cache_get_or_join(m_cache, key, format, &flight);
+
+		TestJoinResult result{ .body = std::nullopt, .flight = flight };
+
+		if(entry != nullptr) {
+			const PrebuiltHttpResponse* response = http_response_cache_entry_get_response(entry);
+			result.body = string_from_buffer(prebuilt_http_response_get_body(response));
+
+			http_response_cache_release(entry);
+		}
+
+		return result;
+	}
+};
+
+[[nodiscard]] HTTPResponseCacheOptions get_test_options(uint32_t ttl_ms, bool coalesce = false) {
+	return HTTPResponseCacheOptions{
+		.ttl_ms = ttl_ms, .query_keys = nullptr, .vary_headers = nullptr, .coalesce = coalesce
+	};
+}
+
+// a format, that is built only on request, so a waiter, that wants it, only gets a hit, if it
+// joined the flight, that built the entry
+[[nodiscard]] CompressionType get_supported_compressed_format() {
+	for(const CompressionType format : { CompressionTypeGzip, CompressionTypeDeflate,
+	                                     CompressionTypeBr, CompressionTypeZstd }) {
+		if(is_compression_supported(format)) {
+			return format;
+		}
+	}
+
+	FAIL("no compression format is supported");
+	return CompressionTypeNone;
+}
+
+// the time, that a waiter thread gets for joining a running flight
+constexpr std::chrono::milliseconds test_join_delay{ 100 };
+
+} // namespace
+
+TEST_SUITE_BEGIN("response_cache" * doctest::description("response cache tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the keys of the response cache <response_cache_key>") {
+
+	SUBCASE("a ttl of 0 disables the cache") {
+		REQUIRE_TRUE(initialize_http_response_cache(get_test_options(0)) == nullptr);
+	}
+
+	SUBCASE("only get and head requests are cacheable") {
+		HttpRequest request{};
+
+		request.head.request_line.method = HTTPRequestMethodGet;
+		REQUIRE_TRUE(http_response_cache_is_cacheable_request(request));
+
+		request.head.request_line.method = HTTPRequestMethodHead;
+		REQUIRE_TRUE(http_response_cache_is_cacheable_request(request));
+
+		request.head.request_line.method = HTTPRequestMethodPost;
+		REQUIRE_FALSE(http_response_cache_is_cacheable_request(request));
+	}
+
+	SUBCASE("head requests share the key of get requests") {
+		const TestResponseCache cache{ get_test_options(1000) };
+
+		REQUIRE_EQ(cache.get_key_string("/index", HTTPRequestMethodHead),
+		           cache.get_key_string("/index", HTTPRequestMethodGet));
+		REQUIRE_NE(cache.get_key_string("/index"), cache.get_key_string("/other"));
+	}
+
+	SUBCASE("only the configured query parameters and header fields are part of the key") {
+		const char* const query_keys[] = { "page", nullptr };
+		const char* const vary_headers[] = { "accept-language", nullptr };
+
+		HTTPResponseCacheOptions options = get_test_options(1000);
+		options.query_keys = query_keys;
+		options.vary_headers = vary_headers;
+
+		const TestResponseCache cache{ options };
+
+		const std::string key = cache.get_key_string("/list?page=1");
+
+		REQUIRE_EQ(cache.get_key_string("/list?page=1&tracking=abc"), key);
+		REQUIRE_NE(cache.get_key_string("/list?page=2"), key);
+		REQUIRE_NE(cache.get_key_string("/list"), key);
+
+		REQUIRE_EQ(cache.get_key_string("/list?page=1", HTTPRequestMethodGet,
+		                                { { "user-agent", "test" } }),
+		           key);
+		REQUIRE_NE(cache.get_key_string("/list?page=1", HTTPRequestMethodGet,
+		                                { { "accept-language", "de" } }),
+		           key);
+	}
+}
+
+TEST_CASE("testing hits and misses of the response cache <response_cache_lookup>") {
+
+	SUBCASE("a put entry is hit until it expires") {
+		// the ttl is clamped to the minimum
+		TestResponseCache cache{ get_test_options(1) };
+
+		REQUIRE_FALSE(cache.get_body("/index").has_value());
+
+		cache.put("/index", "hello");
+
+		REQUIRE_EQ(cache.get_body("/index").value_or(""), "hello");
+		REQUIRE_EQ(cache.get_body("/index", HTTPRequestMethodHead).value_or(""), "hello");
+		REQUIRE_FALSE(cache.get_body("/other").has_value());
+
+		std::this_thread::sleep_for(
+		    std::chrono::milliseconds(HTTP_RESPONSE_CACHE_MIN_TTL_MS + 50));
+
+		REQUIRE_FALSE(cache.get_body("/index").has_value());
+	}
+
+	SUBCASE("a missing format is a miss") {
+		TestResponseCache cache{ get_test_options(1000) };
+
+		cache.put("/index", "hello");
+
+		REQUIRE_TRUE(
+		    cache.get_body("/index", HTTPRequestMethodGet, CompressionTypeNone).has_value());
+		REQUIRE_FALSE(
+		    cache.get_body("/index", HTTPRequestMethodGet, CompressionTypeGzip).has_value());
+	}
+
+	SUBCASE("a put replaces the entry with the same key") {
+		TestResponseCache cache{ get_test_options(1000) };
+
+		cache.put("/index", "first");
+		cache.put("/index", "second");
+
+		REQUIRE_EQ(cache.get_body("/index").value_or(""), "second");
+	}
+
+	SUBCASE("an acquired entry stays valid after it was replaced") {
+		TestResponseCache cache{ get_test_options(1000) };
+
+		cache.put("/index", "first");
+
+		const SizedBuffer key = cache.get_key("/index");
+		HTTPResponseCacheEntry* entry =
+		    http_response_cache_get(cache.get(), key, CompressionTypeNone);
+		free_sized_buffer(key);
+		REQUIRE_TRUE(entry != nullptr);
+
+		cache.put("/index", "second");
+
+		const PrebuiltHttpResponse* response = http_response_cache_entry_get_response(entry);
+		REQUIRE_EQ(string_from_buffer(prebuilt_http_response_get_body(response)), "first");
+
+		http_response_cache_release(entry);
+	}
+
+	SUBCASE("a full cache evicts the oldest entry") {
+		TestResponseCache cache{ get_test_options(1000) };
+
+		for(size_t i = 0; i < HTTP_RESPONSE_CACHE_MAX_ENTRIES; ++i) {
+			cache.put("/entry" + std::to_string(i), std::to_string(i));
+
+			// the expiry times differ, so that the oldest one is well defined
+			if(i == 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			}
+		}
+
+		cache.put("/new", "new");
+
+		REQUIRE_FALSE(cache.get_body("/entry0").has_value());
+		REQUIRE_EQ(cache.get_body("/entry1").value_or(""), "1");
+		REQUIRE_EQ(cache.get_body("/new").value_or(""), "new");
+	}
+}
+
+TEST_CASE("testing the coalescing of concurrent misses <response_cache_single_flight>") {
+
+	SUBCASE("without coalescing no flight is started") {
+		const TestResponseCache cache{ get_test_options(1000) };
+
+		const SizedBuffer key = cache.get_key("/index");
+		const TestJoinResult result = cache.get_or_join(key, CompressionTypeNone);
+		free_sized_buffer(key);
+
+		REQUIRE_FALSE(result.body.has_value());
+		REQUIRE_TRUE(result.flight == nullptr);
+	}
+
+	SUBCASE("waiters get the entry of the first request") {
+		TestResponseCache cache{ get_test_options(1000, true) };
+
+		const SizedBuffer key = cache.get_key("/index");
+
+		const TestJoinResult first = cache.get_or_join(key, CompressionTypeNone);
+		REQUIRE_FALSE(first.body.has_value());
+		REQUIRE_TRUE(first.flight != nullptr);
+
+		const CompressionType waiter_format = get_supported_compressed_format();
+		TestJoinResult waiter{ .body = std::nullopt, .flight = nullptr };
+
+		std::jthread waiter_thread{ [&cache, &waiter, key, waiter_format]() {
+			waiter = cache.get_or_join(key, waiter_format);
+		} };
+
+		std::this_thread::sleep_for(test_join_delay);
+
+		cache.put("/index", "hello", first.flight);
+
+		waiter_thread.join();
+		free_sized_buffer(key);
+
+		REQUIRE_EQ(waiter.body.value_or(""), "hello");
+		REQUIRE_TRUE(waiter.flight == nullptr);
+
+		// the entry was also built for the format of the waiter
+		REQUIRE_EQ(cache.get_body("/index", HTTPRequestMethodGet, waiter_format).value_or(""),
+		           "hello");
+	}
+
+	SUBCASE("waiters of an abandoned flight execute the route themselves") {
+		TestResponseCache cache{ get_test_options(1000, true) };
+
+		const SizedBuffer key = cache.get_key("/index");
+
+		const TestJoinResult first = cache.get_or_join(key, CompressionTypeNone);
+		REQUIRE_TRUE(first.flight != nullptr);
+
+		TestJoinResult waiter{ .body = std::nullopt, .flight = nullptr };
+
+		std::jthread waiter_thread{ [&cache, &waiter, key]() {
+			waiter = cache.get_or_join(key, CompressionTypeNone);
+		} };
+
+		std::this_thread::sleep_for(test_join_delay);
+
+		http_response_cache_abandon_flight(cache.get(), first.flight);
+
+		waiter_thread.join();
+
+		// the waiter neither gets an entry nor starts its own flight
+		REQUIRE_FALSE(waiter.body.has_value());
+		REQUIRE_TRUE(waiter.flight == nullptr);
+
+		// the abandoned flight is removed, so the next miss starts a new one
+		const TestJoinResult next = cache.get_or_join(key, CompressionTypeNone);
+		free_sized_buffer(key);
+
+		REQUIRE_FALSE(next.body.has_value());
+		REQUIRE_TRUE(next.flight != nullptr);
+
+		http_response_cache_abandon_flight(cache.get(), next.flight);
+	}
+}
+
+TEST_CASE("testing the maximum wait time of coalesced misses "
+          "<response_cache_single_flight_timeout>" *
+          doctest::timeout((2.0 + (HTTP_RESPONSE_CACHE_MAX_FLIGHT_WAIT_MS / 1000.0)) *
+                           g_doctest_timeout_multiplier)) {
+
+	TestResponseCache cache{ get_test_options(1000, true) };
+
+	const SizedBuffer key = cache.get_key("/index");
+
+	const TestJoinResult first = cache.get_or_join(key, CompressionTypeNone);
+	REQUIRE_TRUE(first.flight != nullptr);
+
+	// the flight is still running, so this waits the whole time and then misses
+	const auto start = std::chrono::steady_clock::now();
+	const TestJoinResult waiter = cache.get_or_join(key, CompressionTypeNone);
+	const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+	    std::chrono::steady_clock::now() - start);
+
+	free_sized_buffer(key);
+
+	REQUIRE_FALSE(waiter.body.has_value());
+	REQUIRE_TRUE(waiter.flight == nullptr);
+	// the deadline uses the realtime clock, so some slack is allowed
+	REQUIRE_GE(waited.count(), HTTP_RESPONSE_CACHE_MAX_FLIGHT_WAIT_MS - 50);
+
+	// the first request can still finish its flight
+	cache.put("/index", "hello", first.flight);
+
+	REQUIRE_EQ(cache.get_body("/index").value_or(""), "hello");
+}
+
+TEST_SUITE_END();
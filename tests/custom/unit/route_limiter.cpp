@@ -0,0 +1,211 @@
+#include <doctest.h>
+
+#include <http/header.h>
+#include <http/route_limiter.h>
+#include <utils/metrics.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+constexpr const char* test_route_path = "/test";
+
+// the limiter registers its metrics in the global registry, so that is freed with it
+class TestRouteLimiter {
+  public:
+	explicit TestRouteLimiter(HTTPRouteConcurrencyOptions options)
+	    : m_limiter{ initialize_http_route_limiter(test_route_path, options) } {
+		REQUIRE_TRUE(m_limiter != nullptr);
+	}
+
+	TestRouteLimiter(TestRouteLimiter&&) = delete;
+
+	TestRouteLimiter(const TestRouteLimiter&) = delete;
+
+	TestRouteLimiter& operator=(const TestRouteLimiter&) = delete;
+
+	TestRouteLimiter operator=(TestRouteLimiter&&) = delete;
+
+	~TestRouteLimiter() {
+		free_http_route_limiter(m_limiter);
+		global_free_metrics();
+	}
+
+	[[nodiscard]] HTTPRouteLimiter* get() const { return m_limiter; }
+
+  private:
+	HTTPRouteLimiter* m_limiter;
+};
+
+[[nodiscard]] std::string get_metrics_text() {
+	StringBuilder* string_builder = metrics_to_prometheus_text();
+	REQUIRE_TRUE(string_builder != nullptr);
+
+	char* text = string_builder_release_into_string(&string_builder);
+
+	if(text == nullptr) {
+		return "";
+	}
+
+	std::string result{ text };
+	free(text);
+	return result;
+}
+
+[[nodiscard]] bool has_metric(const std::string& name, int64_t value) {
+	const std::string line =
+	    "\n" + name + "{route=\"" + test_route_path + "\"} " + std::to_string(value) + "\n";
+	return get_metrics_text().find(line) != std::string::npos;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("route_limiter" * doctest::description("route concurrency limiter tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the slots of the route limiter <route_limiter_acquire>") {
+
+	SUBCASE("a disabled limit has no limiter and allows everything") {
+		HTTPRouteLimiter* limiter = initialize_http_route_limiter(
+		    test_route_path,
+		    HTTPRouteConcurrencyOptions{ .max_concurrent = 0, .max_waiting = 0, .max_wait_ms = 0 });
+		REQUIRE_TRUE(limiter == nullptr);
+
+		for(size_t i = 0; i < 10; ++i) {
+			REQUIRE_TRUE(http_route_limiter_acquire(limiter));
+		}
+
+		http_route_limiter_release(limiter);
+	}
+
+	SUBCASE("free slots are acquired at once") {
+		const TestRouteLimiter limiter{ HTTPRouteConcurrencyOptions{
+		    .max_concurrent = 2, .max_waiting = 0, .max_wait_ms = 0 } };
+
+		REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+		REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+		REQUIRE_TRUE(has_metric("http_route_executions", 2));
+
+		// nothing may wait, so this is rejected without waiting
+		REQUIRE_FALSE(http_route_limiter_acquire(limiter.get()));
+
+		http_route_limiter_release(limiter.get());
+		REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+
+		http_route_limiter_release(limiter.get());
+		http_route_limiter_release(limiter.get());
+		REQUIRE_TRUE(has_metric("http_route_executions", 0));
+	}
+}
+
+TEST_CASE("testing the waiting of the route limiter <route_limiter_wait>") {
+
+	SUBCASE("a waiting request gets the slot, that is released") {
+		const TestRouteLimiter limiter{ HTTPRouteConcurrencyOptions{
+		    .max_concurrent = 1, .max_waiting = 1, .max_wait_ms = 1000 } };
+
+		REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+
+		bool waiter_acquired = false;
+
+		std::thread waiter{ [&limiter, &waiter_acquired]() {
+			waiter_acquired = http_route_limiter_acquire(limiter.get());
+		} };
+
+		// the waiter is counted in the gauge, while it waits
+		bool waiter_seen = false;
+
+		for(size_t i = 0; i < 500 && !waiter_seen; ++i) {
+			waiter_seen = has_metric("http_route_waiting", 1);
+
+			if(!waiter_seen) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+
+		http_route_limiter_release(limiter.get());
+
+		// the thread has to be joined, before anything is required
+		waiter.join();
+
+		REQUIRE_TRUE(waiter_seen);
+		REQUIRE_TRUE(waiter_acquired);
+		REQUIRE_TRUE(has_metric("http_route_waiting", 0));
+		REQUIRE_TRUE(has_metric("http_route_executions", 1));
+		REQUIRE_TRUE(has_metric("http_route_rejected_total", 0));
+
+		http_route_limiter_release(limiter.get());
+	}
+
+	SUBCASE("a wait, that times out, is rejected with a 503 and Retry-After") {
+		constexpr uint32_t max_wait_ms = 50;
+
+		const TestRouteLimiter limiter{ HTTPRouteConcurrencyOptions{
+		    .max_concurrent = 1, .max_waiting = 1, .max_wait_ms = max_wait_ms } };
+
+		REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+
+		const auto start = std::chrono::steady_clock::now();
+		const bool acquired = http_route_limiter_acquire(limiter.get());
+		const auto waited = std::chrono::steady_clock::now() - start;
+
+		REQUIRE_FALSE(acquired);
+		// the deadline is measured with another clock, so a few milliseconds are tolerated
+		REQUIRE_GE(static_cast<int64_t>(
+		               std::chrono::duration_cast<std::chrono::milliseconds>(waited).count()),
+		           static_cast<int64_t>(max_wait_ms) - 5);
+		REQUIRE_TRUE(has_metric("http_route_rejected_total", 1));
+
+		HTTPResponseToSend response = get_http_route_limiter_busy_response(true);
+
+		const HttpHeaderField* const retry_after =
+		    find_header_by_key(response.additional_headers, HTTP_HEADER_NAME(retry_after));
+
+		const bool has_retry_after = retry_after != nullptr;
+		const std::string retry_after_value =
+		    has_retry_after ? string_from_tstr(retry_after->value) : "";
+
+		free_sized_buffer(response.body.content);
+		free_http_header_fields(&response.additional_headers);
+
+		REQUIRE_TRUE(response.status == HttpStatusServiceUnavailable);
+		REQUIRE_TRUE(has_retry_after);
+		REQUIRE_EQ(retry_after_value, HTTP_ROUTE_LIMITER_RETRY_AFTER_S);
+
+		http_route_limiter_release(limiter.get());
+	}
+}
+
+TEST_CASE("testing the rejections of the route limiter <route_limiter_reject>") {
+
+	// one request runs, nothing may wait, so all others are rejected at once
+	const TestRouteLimiter limiter{ HTTPRouteConcurrencyOptions{
+	    .max_concurrent = 1, .max_waiting = 0, .max_wait_ms = 0 } };
+
+	REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+
+	constexpr int64_t rejected_amount = 3;
+
+	for(int64_t i = 0; i < rejected_amount; ++i) {
+		REQUIRE_FALSE(http_route_limiter_acquire(limiter.get()));
+	}
+
+	REQUIRE_TRUE(has_metric("http_route_executions", 1));
+	REQUIRE_TRUE(has_metric("http_route_waiting", 0));
+	REQUIRE_TRUE(has_metric("http_route_rejected_total", rejected_amount));
+
+	http_route_limiter_release(limiter.get());
+
+	REQUIRE_TRUE(http_route_limiter_acquire(limiter.get()));
+	REQUIRE_TRUE(has_metric("http_route_rejected_total", rejected_amount));
+
+	http_route_limiter_release(limiter.get());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,270 @@
+#include <doctest.h>
+
+#include <http/route_tree.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+struct TestRouteMatch {
+	size_t route;
+	std::vector<std::pair<std::string, std::string>> params;
+};
+
+[[nodiscard]] std::string string_from_view(const tstr_view view) {
+	return std::string{ view.data, view.len };
+}
+
+[[nodiscard]] HTTPRoute get_test_route(HTTPRequestRouteMethod method, HTTPRoutePathType type,
+                                       const char* path) {
+	HTTPRoute route{};
+	route.method = method;
+	route.path = HTTPRoutePath{ .type = type, .data = path };
+	return route;
+}
+
+[[nodiscard]] HTTPRoute get_exact_route(const char* path) {
+	return get_test_route(HTTPRequestRouteMethodGet, HTTPRoutePathTypeExact, path);
+}
+
+[[nodiscard]] HTTPRoute get_prefix_route(const char* path) {
+	return get_test_route(HTTPRequestRouteMethodGet, HTTPRoutePathTypeStartsWith, path);
+}
+
+// only the method and the path of the routes are used by the tree
+class TestRouteTree {
+  private:
+	HTTPRoutesArray m_routes;
+	HTTPRouteTree* m_tree;
+
+  public:
+	explicit TestRouteTree(const std::vector<HTTPRoute>& routes)
+	    : m_routes{ TVEC_EMPTY(HTTPRoute) }, m_tree{ nullptr } {
+
+		for(const HTTPRoute& route : routes) {
+			REQUIRE_TRUE(TVEC_PUSH(HTTPRoute, &m_routes, route) == TvecResultOk);
+		}
+
+		m_tree = build_http_route_tree(m_routes);
+		REQUIRE_TRUE(m_tree != nullptr);
+	}
+
+	TestRouteTree(TestRouteTree&&) = delete;
+
+	TestRouteTree(const TestRouteTree&) = delete;
+
+	TestRouteTree& operator=(const TestRouteTree&) = delete;
+
+	TestRouteTree operator=(TestRouteTree&&) = delete;
+
+	~TestRouteTree() {
+		free_http_route_tree(m_tree);
+		TVEC_FREE(HTTPRoute, &m_routes);
+	}
+
+	[[nodiscard]] TestRouteMatch find(const std::string& path,
+	                                  HTTPRequestMethod method = HTTPRequestMethodGet) const {
+		HTTPRouteParams params = TVEC_EMPTY(HTTPRouteParam);
+
+		const size_t route = http_route_tree_find(
+		    m_tree, method, tstr_view{ .data = path.data(), .len = path.size() }, &params);
+
+		TestRouteMatch result{ .route = route, .params = {} };
+
+		for(size_t i = 0; i < TVEC_LENGTH(HTTPRouteParam, params); ++i) {
+			const HTTPRouteParam param = TVEC_AT(HTTPRouteParam, params, i);
+			result.params.emplace_back(string_from_view(param.name),
+			                           string_from_view(param.value));
+		}
+
+		TVEC_FREE(HTTPRouteParam, &params);
+
+		return result;
+	}
+
+	// the value of the parameter, as returned by find_route_param
+	[[nodiscard]] std::optional<std::string> find_param(const std::string& path,
+	                                                    const std::string& name) const {
+		HTTPRouteParams params = TVEC_EMPTY(HTTPRouteParam);
+
+		const size_t route = http_route_tree_find(
+		    m_tree, HTTPRequestMethodGet, tstr_view{ .data = path.data(), .len = path.size() },
+		    &params);
+		REQUIRE_NE(route, HTTP_ROUTE_TREE_NO_ROUTE);
+
+		const HTTPRouteParam* const param =
+		    find_route_param(&params, tstr_view{ .data = name.data(), .len = name.size() });
+
+		std::optional<std::string> result = std::nullopt;
+
+		if(param != nullptr) {
+			result = string_from_view(param->value);
+		}
+
+		TVEC_FREE(HTTPRouteParam, &params);
+
+		return result;
+	}
+
+	[[nodiscard]] size_t find_route(const std::string& path,
+	                                HTTPRequestMethod method = HTTPRequestMethodGet) const {
+		return find(path, method).route;
+	}
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN("route_tree" * doctest::description("route tree tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing exact and prefix routes of the route tree <route_tree_paths>") {
+
+	const TestRouteTree tree{ {
+	    get_exact_route("/"),
+	    get_exact_route("/index"),
+	    get_exact_route("/internal"),
+	    get_prefix_route("/files"),
+	} };
+
+	SUBCASE("exact routes only match the whole path") {
+		REQUIRE_EQ(tree.find_route("/"), 0);
+		REQUIRE_EQ(tree.find_route("/index"), 1);
+		REQUIRE_EQ(tree.find_route("/internal"), 2);
+
+		REQUIRE_EQ(tree.find_route("/ind"), HTTP_ROUTE_TREE_NO_ROUTE);
+		REQUIRE_EQ(tree.find_route("/index/"), HTTP_ROUTE_TREE_NO_ROUTE);
+		REQUIRE_EQ(tree.find_route("/indexes"), HTTP_ROUTE_TREE_NO_ROUTE);
+		REQUIRE_EQ(tree.find_route(""), HTTP_ROUTE_TREE_NO_ROUTE);
+	}
+
+	SUBCASE("prefix routes match everything, that starts with their path") {
+		REQUIRE_EQ(tree.find_route("/files"), 3);
+		REQUIRE_EQ(tree.find_route("/files/"), 3);
+		REQUIRE_EQ(tree.find_route("/files/a/b.txt"), 3);
+		// the prefix isn't bound to segments
+		REQUIRE_EQ(tree.find_route("/filesystem"), 3);
+
+		REQUIRE_EQ(tree.find_route("/file"), HTTP_ROUTE_TREE_NO_ROUTE);
+	}
+
+	SUBCASE("get routes also match head requests, but no other methods") {
+		REQUIRE_EQ(tree.find_route("/index", HTTPRequestMethodHead), 1);
+		REQUIRE_EQ(tree.find_route("/index", HTTPRequestMethodPost), HTTP_ROUTE_TREE_NO_ROUTE);
+		REQUIRE_EQ(tree.find_route("/index", HTTPRequestMethodOptions), HTTP_ROUTE_TREE_NO_ROUTE);
+	}
+}
+
+TEST_CASE("testing the precedence of routes in the route tree <route_tree_precedence>") {
+
+	SUBCASE("the route, that was registered first, wins") {
+		const TestRouteTree prefix_first{ {
+		    get_prefix_route("/api"),
+		    get_exact_route("/api/users"),
+		} };
+
+		REQUIRE_EQ(prefix_first.find_route("/api/users"), 0);
+
+		const TestRouteTree exact_first{ {
+		    get_exact_route("/api/users"),
+		    get_prefix_route("/api"),
+		} };
+
+		REQUIRE_EQ(exact_first.find_route("/api/users"), 0);
+		REQUIRE_EQ(exact_first.find_route("/api/other"), 1);
+	}
+
+	SUBCASE("static segments and captures are both tried") {
+		const TestRouteTree capture_first{ {
+		    get_exact_route("/users/:id"),
+		    get_exact_route("/users/me"),
+		} };
+
+		const TestRouteMatch match = capture_first.find("/users/me");
+		REQUIRE_EQ(match.route, 0);
+		REQUIRE_EQ(match.params.size(), 1);
+		REQUIRE_EQ(match.params[0].first, "id");
+		REQUIRE_EQ(match.params[0].second, "me");
+
+		const TestRouteTree static_first{ {
+		    get_exact_route("/users/me"),
+		    get_exact_route("/users/:id"),
+		} };
+
+		REQUIRE_EQ(static_first.find_route("/users/me"), 0);
+		REQUIRE_EQ(static_first.find("/users/me").params.size(), 0);
+		REQUIRE_EQ(static_first.find_route("/users/42"), 1);
+	}
+
+	SUBCASE("a route without a path matches everything") {
+		const TestRouteTree tree{ {
+		    get_exact_route("/index"),
+		    get_exact_route(nullptr),
+		} };
+
+		REQUIRE_EQ(tree.find_route("/index"), 0);
+		REQUIRE_EQ(tree.find_route("/"), 1);
+		REQUIRE_EQ(tree.find_route("/anything/else"), 1);
+	}
+
+	SUBCASE("the same path is matched per method") {
+		const TestRouteTree tree{ {
+		    get_test_route(HTTPRequestRouteMethodPost, HTTPRoutePathTypeExact, "/form"),
+		    get_exact_route("/form"),
+		} };
+
+		REQUIRE_EQ(tree.find_route("/form", HTTPRequestMethodPost), 0);
+		REQUIRE_EQ(tree.find_route("/form", HTTPRequestMethodGet), 1);
+	}
+}
+
+TEST_CASE("testing captured parameters of the route tree <route_tree_params>") {
+
+	const TestRouteTree tree{ {
+	    get_exact_route("/users/:id"),
+	    get_exact_route("/users/:id/posts/:post"),
+	    get_prefix_route("/static/:version/"),
+	} };
+
+	SUBCASE("every capture matches one segment") {
+		const TestRouteMatch match = tree.find("/users/42/posts/7");
+
+		REQUIRE_EQ(match.route, 1);
+		REQUIRE_EQ(match.params.size(), 2);
+		REQUIRE_EQ(match.params[0].first, "id");
+		REQUIRE_EQ(match.params[0].second, "42");
+		REQUIRE_EQ(match.params[1].first, "post");
+		REQUIRE_EQ(match.params[1].second, "7");
+
+		REQUIRE_EQ(tree.find_route("/users/42/posts"), HTTP_ROUTE_TREE_NO_ROUTE);
+		REQUIRE_EQ(tree.find_route("/users/42/posts/7/8"), HTTP_ROUTE_TREE_NO_ROUTE);
+	}
+
+	SUBCASE("captures are not empty") {
+		REQUIRE_EQ(tree.find_route("/users/"), HTTP_ROUTE_TREE_NO_ROUTE);
+		REQUIRE_EQ(tree.find_route("/users//posts/7"), HTTP_ROUTE_TREE_NO_ROUTE);
+	}
+
+	SUBCASE("prefix routes can contain captures") {
+		const TestRouteMatch match = tree.find("/static/v2/css/main.css");
+
+		REQUIRE_EQ(match.route, 2);
+		REQUIRE_EQ(match.params.size(), 1);
+		REQUIRE_EQ(match.params[0].first, "version");
+		REQUIRE_EQ(match.params[0].second, "v2");
+
+		REQUIRE_EQ(tree.find_route("/static/v2"), HTTP_ROUTE_TREE_NO_ROUTE);
+	}
+
+	SUBCASE("parameters are found by name") {
+		REQUIRE_EQ(tree.find_param("/users/42/posts/7", "post").value_or(""), "7");
+		REQUIRE_EQ(tree.find_param("/users/42/posts/7", "id").value_or(""), "42");
+		REQUIRE_FALSE(tree.find_param("/users/42/posts/7", "other").has_value());
+	}
+}
+
+TEST_SUITE_END();
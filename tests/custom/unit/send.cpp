@@ -0,0 +1,241 @@
+#include <doctest.h>
+
+#include <generic/secure.h>
+#include <http/send.h>
+
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+constexpr uint16_t test_port = 8080;
+
+[[nodiscard]] bool is_error(GenericResult result) {
+	IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
+		return true;
+	}
+
+	return false;
+}
+
+// sends one response over a socketpair and returns everything, that the other end received
+class TestResponseSender {
+  private:
+	ConnectionContext* m_context;
+	int m_client_fd;
+	ConnectionDescriptor* m_descriptor;
+
+	[[nodiscard]] std::string read_all() {
+		const GenericResult close_result = close_connection_descriptor(m_descriptor);
+		m_descriptor = nullptr;
+		REQUIRE_FALSE(is_error(close_result));
+
+		std::string result{};
+		char buffer[1024];
+
+		while(true) {
+			const ssize_t read_result = read(m_client_fd, buffer, sizeof(buffer));
+			REQUIRE_GE(read_result, 0);
+
+			if(read_result == 0) {
+				break;
+			}
+
+			result.append(buffer, static_cast<size_t>(read_result));
+		}
+
+		return result;
+	}
+
+  public:
+	TestResponseSender() : m_context{ nullptr }, m_client_fd{ -1 }, m_descriptor{ nullptr } {
+
+		global_setup_port_data(test_port);
+
+		const SecureOptions not_secure = { .type = SecureOptionsTypeNotSecure };
+		m_context = get_connection_context(&not_secure);
+		REQUIRE_TRUE(m_context != nullptr);
+
+		int fds[2] = { -1, -1 };
+		REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+		m_client_fd = fds[0];
+
+		m_descriptor = get_connection_descriptor(m_context, fds[1]);
+		REQUIRE_TRUE(m_descriptor != nullptr);
+	}
+
+	TestResponseSender(TestResponseSender&&) = delete;
+
+	TestResponseSender(const TestResponseSender&) = delete;
+
+	TestResponseSender& operator=(const TestResponseSender&) = delete;
+
+	TestResponseSender operator=(TestResponseSender&&) = delete;
+
+	~TestResponseSender() {
+		if(m_descriptor != nullptr) {
+			UNUSED(close_connection_descriptor(m_descriptor));
+		}
+
+		free_connection_context(m_context);
+		close(m_client_fd);
+	}
+
+	[[nodiscard]] std::string send(HTTPResponseToSend to_send, SendSettings send_settings) {
+		const GenericResult result =
+		    send_http_message_to_connection(nullptr, m_descriptor, to_send, send_settings);
+		REQUIRE_FALSE(is_error(result));
+
+		return read_all();
+	}
+
+	[[nodiscard]] std::string send_prebuilt(const PrebuiltHttpResponse* prebuilt_response,
+	                                        SendSettings send_settings) {
+		const GenericResult result = send_prebuilt_http_response_to_connection(
+		    nullptr, m_descriptor, prebuilt_response, send_settings, true);
+		REQUIRE_FALSE(is_error(result));
+
+		return read_all();
+	}
+};
+
+[[nodiscard]] SendSettings get_test_send_settings(HttpConnectionPersistenceType persistence) {
+	return SendSettings{
+		.compression_to_use = CompressionTypeNone,
+		.protocol_data = DEFAULT_RESPONSE_PROTOCOL_DATA,
+		.persistence = { .type = persistence, .idle_timeout_s = 5, .remaining_requests = 99 },
+	};
+}
+
+[[nodiscard]] HTTPResponseToSend get_test_response(HttpStatusCode status) {
+	HttpHeaderFields additional_headers = TVEC_EMPTY(HttpHeaderField);
+	add_http_header_field(&additional_headers, TSTR_LIT("x-test"), TSTR_LIT("value"));
+
+	return HTTPResponseToSend{
+		.status = status,
+		.body = http_response_body_from_static_string("hello", true),
+		.mime_type = TSTR_LIT("text/plain"),
+		.additional_headers = additional_headers,
+	};
+}
+
+[[nodiscard]] std::string get_server_header_line() {
+	return "server: Simple C HTTP Server: v" STRINGIFY(VERSION_STRING) "\r\n";
+}
+
+// the date changes on every send, so it is replaced by a fixed one
+[[nodiscard]] std::string without_date(const std::string& response) {
+	const std::string prefix = "\r\ndate: ";
+	const size_t start = response.find(prefix);
+	REQUIRE_NE(start, std::string::npos);
+
+	const size_t end = response.find("\r\n", start + prefix.size());
+	REQUIRE_NE(end, std::string::npos);
+
+	std::string result = response;
+	result.replace(start + prefix.size(), end - start - prefix.size(), "<date>");
+	return result;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("send" * doctest::description("response serialization tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the head of http/1 responses <send_http1_head>") {
+
+	TestResponseSender sender{};
+
+	SUBCASE("a keep-alive response has all standard header fields") {
+		const std::string response = sender.send(
+		    get_test_response(HttpStatusOk),
+		    get_test_send_settings(HttpConnectionPersistenceTypeKeepAlive));
+
+		REQUIRE_EQ(response, "HTTP/1.1 200 OK\r\n"
+		                     "content-type: text/plain\r\n"
+		                     "connection: keep-alive\r\n" +
+		                         get_server_header_line() +
+		                         "alt-svc: h2=\"8080\"\r\n"
+		                         "x-test: value\r\n"
+		                         "content-length: 5\r\n"
+		                         "keep-alive: timeout=5, max=99\r\n"
+		                         "\r\n"
+		                         "hello");
+	}
+
+	SUBCASE("a closing response has no keep-alive header field") {
+		const std::string response =
+		    sender.send(get_test_response(HttpStatusOk),
+		                get_test_send_settings(HttpConnectionPersistenceTypeClose));
+
+		REQUIRE_EQ(response, "HTTP/1.1 200 OK\r\n"
+		                     "content-type: text/plain\r\n"
+		                     "connection: close\r\n" +
+		                         get_server_header_line() +
+		                         "alt-svc: h2=\"8080\"\r\n"
+		                         "x-test: value\r\n"
+		                         "content-length: 5\r\n"
+		                         "\r\n"
+		                         "hello");
+	}
+
+	SUBCASE("a protocol switch has no connection and alt-svc header fields") {
+		const std::string response = sender.send(
+		    get_test_response(HttpStatusSwitchingProtocols),
+		    get_test_send_settings(HttpConnectionPersistenceTypeKeepAlive));
+
+		REQUIRE_EQ(response, "HTTP/1.1 101 Switching Protocols\r\n"
+		                     "content-type: text/plain\r\n" +
+		                         get_server_header_line() +
+		                         "x-test: value\r\n"
+		                         "content-length: 5\r\n"
+		                         "\r\n"
+		                         "hello");
+	}
+
+	SUBCASE("the default mime type is used, if none is given") {
+		HTTPResponseToSend to_send = get_test_response(HttpStatusOk);
+		to_send.mime_type = tstr_null();
+
+		const std::string response =
+		    sender.send(to_send, get_test_send_settings(HttpConnectionPersistenceTypeClose));
+
+		REQUIRE_NE(response.find("\r\ncontent-type: text/html\r\n"), std::string::npos);
+		REQUIRE_NE(response.find("\r\ncontent-length: 5\r\n\r\nhello"), std::string::npos);
+	}
+}
+
+TEST_CASE("testing the head of prebuilt http/1 responses <send_http1_prebuilt_head>") {
+
+	TestResponseSender sender{};
+
+	const std::string body = "hello";
+
+	PrebuiltHttpResponse* prebuilt_response = build_prebuilt_http_response_for_formats(
+	    HttpStatusOk, TSTR_LIT("text/plain"),
+	    ReadonlyBuffer{ .data = body.data(), .size = body.size() },
+	    PREBUILT_FORMAT_BIT(CompressionTypeNone));
+	REQUIRE_TRUE(prebuilt_response != nullptr);
+
+	const std::string response = sender.send_prebuilt(
+	    prebuilt_response, get_test_send_settings(HttpConnectionPersistenceTypeKeepAlive));
+
+	free_prebuilt_http_response(prebuilt_response);
+
+	// the standard header fields are the same as the ones of constructed responses
+	REQUIRE_EQ(without_date(response), "HTTP/1.1 200 OK\r\n"
+	                                   "content-type: text/plain\r\n" +
+	                                       get_server_header_line() +
+	                                       "alt-svc: h2=\"8080\"\r\n"
+	                                       "content-length: 5\r\n"
+	                                       "date: <date>\r\n"
+	                                       "connection: keep-alive\r\n"
+	                                       "keep-alive: timeout=5, max=99\r\n"
+	                                       "\r\n"
+	                                       "hello");
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,190 @@
+#include <doctest.h>
+
+#include <http/server_metrics.h>
+#include <utils/metrics.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+namespace {
+
+constexpr const char* test_route_path = "/test";
+
+// the server metrics are global, this initializes them without a pool and frees all metrics
+class TestServerMetrics {
+  public:
+	TestServerMetrics() {
+		global_initialize_http_server_metrics(nullptr);
+
+		m_route_metrics = initialize_http_route_metrics(test_route_path);
+		REQUIRE_TRUE(m_route_metrics != nullptr);
+	}
+
+	TestServerMetrics(TestServerMetrics&&) = delete;
+
+	TestServerMetrics(const TestServerMetrics&) = delete;
+
+	TestServerMetrics& operator=(const TestServerMetrics&) = delete;
+
+	TestServerMetrics operator=(TestServerMetrics&&) = delete;
+
+	~TestServerMetrics() {
+		free_http_route_metrics(m_route_metrics);
+		global_free_http_server_metrics();
+	}
+
+	[[nodiscard]] HTTPRequestMetrics get_request_metrics(bool with_route) const {
+		HTTPRequestMetrics request_metrics =
+		    get_default_http_request_metrics(HTTPProtocolVersion1Dot1);
+
+		if(with_route) {
+			request_metrics.route = m_route_metrics;
+		}
+
+		return request_metrics;
+	}
+
+  private:
+	HTTPRouteMetrics* m_route_metrics{ nullptr };
+};
+
+[[nodiscard]] std::string get_metrics_text() {
+	StringBuilder* string_builder = metrics_to_prometheus_text();
+	REQUIRE_TRUE(string_builder != nullptr);
+
+	char* text = string_builder_release_into_string(&string_builder);
+
+	if(text == nullptr) {
+		return "";
+	}
+
+	std::string result{ text };
+	free(text);
+	return result;
+}
+
+[[nodiscard]] bool has_line(const std::string& line) {
+	return get_metrics_text().find("\n" + line + "\n") != std::string::npos;
+}
+
+// the upper bounds of all finite buckets of one series, in the exported order
+[[nodiscard]] std::vector<double> get_bucket_bounds(const std::string& series_prefix) {
+	const std::string text = get_metrics_text();
+	const std::string prefix = "\n" + series_prefix + ",le=\"";
+
+	std::vector<double> bounds{};
+
+	for(size_t position = text.find(prefix); position != std::string::npos;
+	    position = text.find(prefix, position + 1)) {
+		const size_t value_start = position + prefix.size();
+		const size_t value_end = text.find('"', value_start);
+		const std::string value = text.substr(value_start, value_end - value_start);
+
+		if(value != "+Inf") {
+			bounds.push_back(std::stod(value));
+		}
+	}
+
+	return bounds;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN("server_metrics" * doctest::description("http server metrics tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the recording of the request phases <server_metrics_phase>") {
+
+	const TestServerMetrics metrics{};
+
+	SUBCASE("a duration is counted in its sub-bucket") {
+		http_server_metrics_observe_phase_duration(metrics.get_request_metrics(false),
+		                                           HTTPRequestPhaseExecutor, 100);
+
+		// 100us is between the sub-bucket bounds 96us and 104us of the power 64us
+		REQUIRE_TRUE(has_line("http_request_phase_seconds_bucket{protocol=\"http1\",phase="
+		                      "\"executor\",le=\"9.6e-05\"} 0"));
+		REQUIRE_TRUE(has_line("http_request_phase_seconds_bucket{protocol=\"http1\",phase="
+		                      "\"executor\",le=\"0.000104\"} 1"));
+		REQUIRE_TRUE(
+		    has_line("http_request_phase_seconds_count{protocol=\"http1\",phase=\"executor\"} 1"));
+		REQUIRE_TRUE(
+		    has_line("http_request_phase_seconds_count{protocol=\"http2\",phase=\"executor\"} 0"));
+	}
+
+	SUBCASE("only the phases after the route lookup are recorded per route") {
+		http_server_metrics_observe_phase_duration(metrics.get_request_metrics(true),
+		                                           HTTPRequestPhaseQueueWait, 50);
+		http_server_metrics_observe_phase_duration(metrics.get_request_metrics(true),
+		                                           HTTPRequestPhaseExecutor, 50);
+
+		REQUIRE_TRUE(has_line(
+		    "http_request_phase_seconds_count{protocol=\"http1\",phase=\"queue_wait\"} 1"));
+		REQUIRE_TRUE(
+		    has_line("http_request_phase_seconds_count{protocol=\"http1\",phase=\"executor\"} 1"));
+		REQUIRE_TRUE(
+		    has_line("http_route_phase_seconds_count{route=\"/test\",phase=\"executor\"} 1"));
+		REQUIRE_FALSE(get_metrics_text().find(
+		                  "http_route_phase_seconds_count{route=\"/test\",phase=\"queue_wait\"}") !=
+		              std::string::npos);
+	}
+
+	SUBCASE("a phase is measured from its start timestamp") {
+		const uint64_t start_us = http_server_metrics_get_timestamp_us();
+		REQUIRE_NE(start_us, static_cast<uint64_t>(0));
+
+		http_server_metrics_observe_phase(metrics.get_request_metrics(false), HTTPRequestPhaseSend,
+		                                  start_us);
+
+		// a failed timestamp read is not recorded
+		http_server_metrics_observe_phase(metrics.get_request_metrics(false), HTTPRequestPhaseSend,
+		                                  0);
+
+		REQUIRE_TRUE(
+		    has_line("http_request_phase_seconds_count{protocol=\"http1\",phase=\"send\"} 1"));
+	}
+
+	SUBCASE("invalid phases are ignored") {
+		http_server_metrics_observe_phase_duration(
+		    metrics.get_request_metrics(true),
+		    static_cast<HTTPRequestPhase>(HTTP_REQUEST_PHASE_AMOUNT), 100);
+
+		REQUIRE_FALSE(get_metrics_text().find("phase_seconds_count{protocol=\"http1\",phase="
+		                                      "\"executor\"} 1") != std::string::npos);
+	}
+}
+
+TEST_CASE("testing the buckets of the request phases <server_metrics_phase_buckets>") {
+
+	const TestServerMetrics metrics{};
+
+	const std::vector<double> bounds =
+	    get_bucket_bounds("http_request_phase_seconds_bucket{protocol=\"http1\",phase=\"send\"");
+
+	REQUIRE_FALSE(bounds.empty());
+	REQUIRE_LE(bounds.size(), static_cast<size_t>(METRICS_HISTOGRAM_MAX_BUCKETS));
+
+	// from 8us up to about 33s
+	REQUIRE_EQ(bounds.front(), doctest::Approx(8e-06));
+	REQUIRE_EQ(bounds.back(), doctest::Approx(33.554432));
+
+	// every bucket is at most 1/8 wider than its lower bound, so that is the relative error
+	bool ascending = true;
+	double max_relative_error = 0.0;
+
+	for(size_t i = 1; i < bounds.size(); ++i) {
+		ascending = ascending && bounds[i] > bounds[i - 1];
+
+		const double relative_error = (bounds[i] - bounds[i - 1]) / bounds[i - 1];
+		max_relative_error = relative_error > max_relative_error ? relative_error
+		                                                         : max_relative_error;
+	}
+
+	REQUIRE_TRUE(ascending);
+	REQUIRE_LE(max_relative_error, doctest::Approx(0.125));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,660 @@
+#include <doctest.h>
+
+#include <generic/ip.h>
+#include <generic/secure.h>
+#include <http/parser.h>
+#include <http/server.h>
+#include <http/upstream.h>
+#include <utils/log.h>
+#include <utils/metrics.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <support/helpers.hpp>
+
+// these tests forward requests, that were parsed from one end of a socketpair, to a small upstream
+// server on a unix socket, so that the request head, the framing of the response and the
+// connection pool can be checked from both sides
+
+namespace {
+
+constexpr int upstream_test_socket_timeout_s = 2;
+
+void set_socket_timeout(int fd) {
+	const struct timeval timeout = { .tv_sec = upstream_test_socket_timeout_s, .tv_usec = 0 };
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+[[nodiscard]] bool write_all(int fd, const std::string& data) {
+	size_t written = 0;
+
+	while(written < data.size()) {
+		const ssize_t result = write(fd, data.data() + written, data.size() - written);
+
+		if(result <= 0) {
+			return false;
+		}
+
+		written += static_cast<size_t>(result);
+	}
+
+	return true;
+}
+
+[[nodiscard]] std::string to_lower(std::string value) {
+	std::ranges::transform(value, value.begin(),
+	                       [](unsigned char character) { return std::tolower(character); });
+	return value;
+}
+
+// only handles the field names, that the tests use, the values are compared as they are
+[[nodiscard]] std::optional<std::string> get_header_value(const std::string& head,
+                                                          const std::string& name) {
+	const std::string lower_head = to_lower(head);
+	const std::string needle = "\r\n" + name + ":";
+
+	const size_t start = lower_head.find(needle);
+
+	if(start == std::string::npos) {
+		return std::nullopt;
+	}
+
+	const size_t value_start = head.find_first_not_of(' ', start + needle.size());
+	const size_t value_end = head.find("\r\n", value_start);
+
+	return head.substr(value_start, value_end - value_start);
+}
+
+// reads one request, the bodies of the tests are framed by a content-length
+[[nodiscard]] std::optional<std::string> read_request(int fd, std::string& buffer) {
+
+	while(true) {
+		const size_t head_end = buffer.find("\r\n\r\n");
+
+		if(head_end != std::string::npos) {
+			const std::string head = buffer.substr(0, head_end + 2);
+			const std::optional<std::string> content_length =
+			    get_header_value(head, "content-length");
+
+			const size_t size =
+			    head_end + 4 + (content_length.has_value() ? std::stoul(*content_length) : 0);
+
+			if(buffer.size() >= size) {
+				std::string request = buffer.substr(0, size);
+				buffer.erase(0, size);
+				return request;
+			}
+		}
+
+		char data[4096];
+		const ssize_t result = read(fd, data, sizeof(data));
+
+		if(result <= 0) {
+			return std::nullopt;
+		}
+
+		buffer.append(data, static_cast<size_t>(result));
+	}
+}
+
+[[nodiscard]] std::string read_until_eof(int fd) {
+	std::string result;
+
+	while(true) {
+		char data[4096];
+		const ssize_t amount = read(fd, data, sizeof(data));
+
+		if(amount <= 0) {
+			return result;
+		}
+
+		result.append(data, static_cast<size_t>(amount));
+	}
+}
+
+[[nodiscard]] int get_status(const std::string& response) {
+	// "HTTP/1.1 200 OK"
+	if(response.size() < 12) {
+		return 0;
+	}
+
+	return std::stoi(response.substr(9, 3));
+}
+
+[[nodiscard]] std::string get_body(const std::string& response) {
+	const size_t head_end = response.find("\r\n\r\n");
+
+	if(head_end == std::string::npos) {
+		return "";
+	}
+
+	return response.substr(head_end + 4);
+}
+
+struct UpstreamAnswer {
+	// std::nullopt closes the connection without answering
+	std::optional<std::string> response;
+	bool close_after;
+};
+
+// gets the index of the connection and the index of the request on that connection
+using UpstreamHandler =
+    std::function<UpstreamAnswer(size_t connection_index, size_t request_index)>;
+
+class TestUpstream {
+  private:
+	std::filesystem::path m_path;
+	int m_listen_fd;
+	UpstreamHandler m_handler;
+	std::atomic<bool> m_stop;
+	std::mutex m_mutex;
+	std::vector<std::string> m_requests;
+	std::vector<int> m_connection_fds;
+	std::vector<std::thread> m_connection_threads;
+	std::thread m_accept_thread;
+
+	void handle_connection(int fd, size_t connection_index) {
+		std::string buffer;
+
+		for(size_t request_index = 0;; ++request_index) {
+			const std::optional<std::string> request = read_request(fd, buffer);
+
+			if(!request.has_value()) {
+				return;
+			}
+
+			{
+				const std::lock_guard lock{ m_mutex };
+				m_requests.push_back(*request);
+			}
+
+			const UpstreamAnswer answer = m_handler(connection_index, request_index);
+
+			if(!answer.response.has_value()) {
+				shutdown(fd, SHUT_RDWR);
+				return;
+			}
+
+			if(!write_all(fd, *answer.response) || answer.close_after) {
+				shutdown(fd, SHUT_RDWR);
+				return;
+			}
+		}
+	}
+
+	void accept_connections() {
+		while(!m_stop.load()) {
+			struct pollfd poll_fd = { .fd = m_listen_fd, .events = POLLIN, .revents = 0 };
+
+			if(poll(&poll_fd, 1, 10) <= 0) {
+				continue;
+			}
+
+			const int fd = accept(m_listen_fd, nullptr, nullptr);
+
+			if(fd < 0) {
+				continue;
+			}
+
+			set_socket_timeout(fd);
+
+			const std::lock_guard lock{ m_mutex };
+
+			m_connection_threads.emplace_back(&TestUpstream::handle_connection, this, fd,
+			                                  m_connection_fds.size());
+			m_connection_fds.push_back(fd);
+		}
+	}
+
+  public:
+	TestUpstream(std::filesystem::path path, UpstreamHandler handler)
+	    : m_path{ std::move(path) },
+	      m_listen_fd{ socket(AF_UNIX, SOCK_STREAM, 0) },
+	      m_handler{ std::move(handler) },
+	      m_stop{ false } {
+
+		REQUIRE_NE(m_listen_fd, -1);
+
+		struct sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+
+		const std::string path_string = m_path.string();
+		REQUIRE_LT(path_string.size(), sizeof(address.sun_path));
+		std::ranges::copy(path_string, address.sun_path);
+
+		std::filesystem::remove(m_path);
+
+		REQUIRE_EQ(bind(m_listen_fd, reinterpret_cast<struct sockaddr*>(&address),
+		                sizeof(address)),
+		           0);
+		REQUIRE_EQ(listen(m_listen_fd, 16), 0);
+
+		m_accept_thread = std::thread(&TestUpstream::accept_connections, this);
+	}
+
+	TestUpstream(TestUpstream&&) = delete;
+
+	TestUpstream(const TestUpstream&) = delete;
+
+	TestUpstream& operator=(const TestUpstream&) = delete;
+
+	TestUpstream operator=(TestUpstream&&) = delete;
+
+	[[nodiscard]] size_t connection_amount() {
+		const std::lock_guard lock{ m_mutex };
+		return m_connection_fds.size();
+	}
+
+	[[nodiscard]] std::vector<std::string> requests() {
+		const std::lock_guard lock{ m_mutex };
+		return m_requests;
+	}
+
+	~TestUpstream() {
+		m_stop.store(true);
+		m_accept_thread.join();
+
+		for(const int fd : m_connection_fds) {
+			shutdown(fd, SHUT_RDWR);
+		}
+
+		for(std::thread& thread : m_connection_threads) {
+			thread.join();
+		}
+
+		for(const int fd : m_connection_fds) {
+			close(fd);
+		}
+
+		close(m_listen_fd);
+		std::filesystem::remove(m_path);
+	}
+};
+
+class ProxyEnvironment {
+  private:
+	ConnectionContext* m_context;
+	HTTPUpstreamGroup* m_group;
+	std::filesystem::path m_path;
+
+  public:
+	explicit ProxyEnvironment(HTTPUpstreamOptions options)
+	    : m_context{ nullptr },
+	      m_group{ nullptr },
+	      m_path{ std::filesystem::temp_directory_path() /
+	              ("simple_http_server_upstream_test_" + std::to_string(getpid()) + ".sock") } {
+
+		set_log_level(LogLevelCritical);
+
+		global_initialize_http_global_data();
+
+		const SecureOptions not_secure = { .type = SecureOptionsTypeNotSecure };
+		m_context = get_connection_context(&not_secure);
+		REQUIRE_TRUE(m_context != nullptr);
+
+		const std::string server = "unix:" + m_path.string();
+		const char* const servers[] = { server.c_str() };
+
+		m_group = initialize_http_upstream_group(servers, 1, options);
+		REQUIRE_TRUE(m_group != nullptr);
+	}
+
+	ProxyEnvironment(ProxyEnvironment&&) = delete;
+
+	ProxyEnvironment(const ProxyEnvironment&) = delete;
+
+	ProxyEnvironment& operator=(const ProxyEnvironment&) = delete;
+
+	ProxyEnvironment operator=(ProxyEnvironment&&) = delete;
+
+	[[nodiscard]] const std::filesystem::path& path() const { return m_path; }
+
+	// parses the raw request, as the server would, forwards it and returns the raw response
+	[[nodiscard]] std::string proxy(const std::string& raw_request) {
+		int fds[2] = { -1, -1 };
+		REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+		set_socket_timeout(fds[0]);
+
+		ConnectionDescriptor* const descriptor = get_connection_descriptor(m_context, fds[1]);
+		REQUIRE_TRUE(descriptor != nullptr);
+
+		HTTPReader* const reader =
+		    initialize_http_reader_from_connection(descriptor, get_default_http_reader_settings());
+		REQUIRE_TRUE(reader != nullptr);
+
+		REQUIRE_TRUE(write_all(fds[0], raw_request));
+
+		const HttpRequestResult request_result = get_http_request(reader);
+		REQUIRE_TRUE(request_result.type == HttpRequestResultTypeOk);
+
+		const HTTPResultOk request = request_result.value.ok;
+		REQUIRE_TRUE(request.settings.http_properties.type == HTTPPropertyTypeNormal);
+
+		const IPAddress address = from_ipv4({ .s_addr = htonl(INADDR_LOOPBACK) });
+
+		HTTPGeneralContext* const general_context = http_reader_get_general_context(reader);
+
+		bool failed = false;
+
+		const GenericResult result = http_upstream_proxy_request(
+		    m_group, descriptor, general_context, get_send_settings(request.settings),
+		    request.request, request.settings.http_properties.data.normal, address);
+
+		IF_GENERIC_RESULT_IS_ERROR_IGN(result) {
+			failed = true;
+		}
+
+		const GenericResult flush_result =
+		    http_general_context_flush_http1_output(general_context, descriptor);
+
+		IF_GENERIC_RESULT_IS_ERROR_IGN(flush_result) {
+			failed = true;
+		}
+
+		free_http_request_result(request);
+
+		REQUIRE_TRUE(finish_reader(reader, m_context));
+		REQUIRE_FALSE(failed);
+
+		std::string response = read_until_eof(fds[0]);
+		close(fds[0]);
+
+		return response;
+	}
+
+	~ProxyEnvironment() {
+		free_http_upstream_group(m_group);
+		free_connection_context(m_context);
+		global_free_http_global_data();
+		global_free_metrics();
+	}
+};
+
+[[nodiscard]] HTTPUpstreamOptions get_test_upstream_options() {
+	HTTPUpstreamOptions options = get_default_http_upstream_options();
+	options.connect_timeout_ms = 1000;
+	options.io_timeout_ms = 1000;
+	return options;
+}
+
+[[nodiscard]] UpstreamAnswer answer_with(const std::string& response) {
+	return UpstreamAnswer{ .response = response, .close_after = false };
+}
+
+constexpr const char* upstream_hello_response =
+    "HTTP/1.1 200 OK\r\ncontent-type: text/plain\r\ncontent-length: 5\r\n\r\nhello";
+
+} // namespace
+
+TEST_SUITE_BEGIN("upstream" * doctest::description("reverse proxy tests") *
+                 doctest::timeout(2.0 * g_doctest_timeout_multiplier));
+
+TEST_CASE("testing the forwarded request and the connection pool <upstream_pool>") {
+
+	ProxyEnvironment environment{ get_test_upstream_options() };
+
+	TestUpstream upstream{ environment.path(),
+		                   [](size_t, size_t) { return answer_with(upstream_hello_response); } };
+
+	const std::string first_response =
+	    environment.proxy("GET /some/path?key=value HTTP/1.1\r\n"
+	                      "Host: example.com\r\n"
+	                      "Connection: keep-alive, X-Private\r\n"
+	                      "X-Private: secret\r\n"
+	                      "X-Forwarded-For: 10.0.0.1\r\n"
+	                      "X-Custom: kept\r\n"
+	                      "\r\n");
+
+	REQUIRE_EQ(get_status(first_response), 200);
+	REQUIRE_EQ(get_body(first_response), "hello");
+
+	const std::string second_response =
+	    environment.proxy("GET /other HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+	REQUIRE_EQ(get_status(second_response), 200);
+	REQUIRE_EQ(get_body(second_response), "hello");
+
+	// the second request used the pooled connection
+	REQUIRE_EQ(upstream.connection_amount(), 1);
+
+	const std::vector<std::string> requests = upstream.requests();
+	REQUIRE_EQ(requests.size(), 2);
+
+	const std::string& forwarded = requests.at(0);
+
+	REQUIRE_EQ(forwarded.substr(0, forwarded.find("\r\n")),
+	           "GET /some/path?key=value HTTP/1.1");
+	REQUIRE_EQ(get_header_value(forwarded, "host").value_or(""), "example.com");
+	REQUIRE_EQ(get_header_value(forwarded, "x-custom").value_or(""), "kept");
+	REQUIRE_EQ(get_header_value(forwarded, "x-forwarded-for").value_or(""),
+	           "10.0.0.1, 127.0.0.1");
+
+	// hop by hop fields, also the ones listed in the Connection field, aren't forwarded
+	REQUIRE_FALSE(get_header_value(forwarded, "connection").has_value());
+	REQUIRE_FALSE(get_header_value(forwarded, "x-private").has_value());
+}
+
+TEST_CASE("testing the forwarded request target <upstream_target>") {
+
+	ProxyEnvironment environment{ get_test_upstream_options() };
+
+	TestUpstream upstream{ environment.path(),
+		                   [](size_t, size_t) { return answer_with(upstream_hello_response); } };
+
+	// the order, the repeated key and the escape codes have to reach the upstream unchanged
+	const std::string target = "/search?b=2&a=1&a=3&q=hello%20world%26more&flag";
+
+	const std::string response =
+	    environment.proxy("GET " + target + " HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+	REQUIRE_EQ(get_status(response), 200);
+
+	const std::vector<std::string> requests = upstream.requests();
+	REQUIRE_EQ(requests.size(), 1);
+
+	const std::string& forwarded = requests.at(0);
+
+	REQUIRE_EQ(forwarded.substr(0, forwarded.find("\r\n")), "GET " + target + " HTTP/1.1");
+}
+
+TEST_CASE("testing the framing of upstream responses <upstream_framing>") {
+
+	ProxyEnvironment environment{ get_test_upstream_options() };
+
+	SUBCASE("chunked as the last transfer coding") {
+		TestUpstream upstream{ environment.path(), [](size_t, size_t) {
+			                      return answer_with("HTTP/1.1 200 OK\r\n"
+			                                         "transfer-encoding: gzip, chunked\r\n"
+			                                         "\r\n"
+			                                         "5\r\nhello\r\n0\r\n\r\n");
+		                      } };
+
+		for(size_t i = 0; i < 2; ++i) {
+			const std::string response =
+			    environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+			REQUIRE_EQ(get_status(response), 200);
+			REQUIRE_NE(get_body(response).find("hello"), std::string::npos);
+		}
+
+		// the body didn't end with the connection, so the connection was reused
+		REQUIRE_EQ(upstream.connection_amount(), 1);
+	}
+
+	SUBCASE("more data than the content-length") {
+		TestUpstream upstream{ environment.path(), [](size_t, size_t) {
+			                      return answer_with(std::string(upstream_hello_response) +
+			                                         "HTTP/1.1 500 Unexpected\r\n\r\n");
+		                      } };
+
+		for(size_t i = 0; i < 2; ++i) {
+			const std::string response =
+			    environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+			REQUIRE_EQ(get_status(response), 200);
+			REQUIRE_EQ(get_body(response), "hello");
+		}
+
+		// the unexpected data was buffered, so the connection wasn't reused
+		REQUIRE_EQ(upstream.connection_amount(), 2);
+	}
+
+	SUBCASE("a response to a HEAD request has no body") {
+		TestUpstream upstream{ environment.path(), [](size_t, size_t) {
+			                      return answer_with("HTTP/1.1 200 OK\r\n"
+			                                         "content-length: 5\r\n"
+			                                         "\r\n");
+		                      } };
+
+		for(size_t i = 0; i < 2; ++i) {
+			const std::string response =
+			    environment.proxy("HEAD / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+			REQUIRE_EQ(get_status(response), 200);
+			REQUIRE_EQ(get_body(response), "");
+		}
+
+		REQUIRE_EQ(upstream.connection_amount(), 1);
+	}
+}
+
+TEST_CASE("testing invalid upstream response heads <upstream_invalid_head>") {
+
+	ProxyEnvironment environment{ get_test_upstream_options() };
+
+	SUBCASE("a bare LF in a field value") {
+		TestUpstream upstream{ environment.path(), [](size_t, size_t) {
+			                      return answer_with("HTTP/1.1 200 OK\r\n"
+			                                         "x-test: a\nset-cookie: injected\r\n"
+			                                         "content-length: 5\r\n"
+			                                         "\r\n"
+			                                         "hello");
+		                      } };
+
+		const std::string response =
+		    environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+		REQUIRE_EQ(get_status(response), 502);
+		REQUIRE_EQ(response.find("injected"), std::string::npos);
+	}
+
+	SUBCASE("a bare CR in the reason") {
+		TestUpstream upstream{ environment.path(), [](size_t, size_t) {
+			                      return answer_with("HTTP/1.1 200 OK\rset-cookie: injected\r\n"
+			                                         "content-length: 5\r\n"
+			                                         "\r\n"
+			                                         "hello");
+		                      } };
+
+		const std::string response =
+		    environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+		REQUIRE_EQ(get_status(response), 502);
+		REQUIRE_EQ(response.find("injected"), std::string::npos);
+	}
+
+	SUBCASE("a line, that is too long") {
+		TestUpstream upstream{ environment.path(), [](size_t, size_t) {
+			                      return answer_with("HTTP/1.1 200 OK\r\n"
+			                                         "x-test: " +
+			                                         std::string(1 << 14, 'a') +
+			                                         "\r\n"
+			                                         "content-length: 5\r\n"
+			                                         "\r\n"
+			                                         "hello");
+		                      } };
+
+		const std::string response =
+		    environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+		REQUIRE_EQ(get_status(response), 502);
+	}
+}
+
+TEST_CASE("testing requests on a closed pooled connection <upstream_retry>") {
+
+	ProxyEnvironment environment{ get_test_upstream_options() };
+
+	// the first connection is closed by the upstream after the first response, without the proxy
+	// noticing it before sending the next request
+	TestUpstream upstream{ environment.path(), [](size_t connection_index, size_t request_index) {
+		                      if(connection_index == 0 && request_index == 1) {
+			                      return UpstreamAnswer{ .response = std::nullopt,
+			                                             .close_after = true };
+		                      }
+
+		                      return answer_with(upstream_hello_response);
+	                      } };
+
+	REQUIRE_EQ(
+	    get_status(environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n")), 200);
+
+	SUBCASE("an idempotent request is sent again") {
+		const std::string response =
+		    environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+
+		REQUIRE_EQ(get_status(response), 200);
+		REQUIRE_EQ(upstream.connection_amount(), 2);
+		REQUIRE_EQ(upstream.requests().size(), 3);
+	}
+
+	SUBCASE("a non idempotent request isn't sent again") {
+		const std::string response = environment.proxy(
+		    "POST / HTTP/1.1\r\nHost: example.com\r\nContent-Length: 4\r\n\r\ndata");
+
+		REQUIRE_EQ(get_status(response), 502);
+		REQUIRE_EQ(upstream.connection_amount(), 1);
+
+		const std::vector<std::string> requests = upstream.requests();
+		REQUIRE_EQ(requests.size(), 2);
+		REQUIRE_EQ(get_body(requests.at(1)), "data");
+	}
+}
+
+TEST_CASE("testing the passive health checks <upstream_health>") {
+
+	HTTPUpstreamOptions options = get_test_upstream_options();
+	options.max_fails = 1;
+	options.fail_timeout_ms = 300;
+
+	ProxyEnvironment environment{ options };
+
+	// nothing listens on the socket yet
+	REQUIRE_EQ(
+	    get_status(environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n")), 502);
+
+	TestUpstream upstream{ environment.path(),
+		                   [](size_t, size_t) { return answer_with(upstream_hello_response); } };
+
+	// the server is skipped, until the fail timeout is over
+	REQUIRE_EQ(
+	    get_status(environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n")), 502);
+	REQUIRE_EQ(upstream.connection_amount(), 0);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(options.fail_timeout_ms + 100));
+
+	REQUIRE_EQ(
+	    get_status(environment.proxy("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n")), 200);
+	REQUIRE_EQ(upstream.connection_amount(), 1);
+}
+
+TEST_SUITE_END();
@@ -1,4 +1,5 @@
 import { generateHpackHeaderTableCodeH, generateHpackHuffmanCodeC, generateHpackTestCasesCPP } from "./hpack.js";
+import { generateHttpHeaderTokensCodeH } from "./http_headers.js";
 import { assert, testBitarray } from "./utils.js";
 import { generateVariantCodeC } from "./variants/index.js";
 
@@ -15,6 +16,9 @@ export async function generateFile(options: GenerateOptions): Promise<void> {
     } else if (options.type === "c_header_table") {
         await generateHpackHeaderTableCodeH(options.output)
         return;
+    } else if (options.type === "c_http_header_tokens") {
+        await generateHttpHeaderTokensCodeH(options.output)
+        return;
     } else if (options.type === "cpp_tests") {
 
         await generateHpackTestCasesCPP(options.output)
@@ -31,7 +35,7 @@ export async function generateFile(options: GenerateOptions): Promise<void> {
 
 }
 
-export type GenerateType = "cpp_tests" | "c_hpack_huffman" | "c_header_table" | 'c_variants'
+export type GenerateType = "cpp_tests" | "c_hpack_huffman" | "c_header_table" | "c_http_header_tokens" | 'c_variants'
 
 export interface GenerateOptions {
     output: string,
@@ -0,0 +1,310 @@
+import path from "node:path"
+import { addGenerateMacros, assert, getOtherFile, writeFileAndDirs } from "./utils.js"
+
+// well known header names, these get a token, so that they can be looked up by an index instead of
+// a string compare, they have to be lowercase
+const wellKnownHeaderNames: string[] = [
+    "accept",
+    "accept-charset",
+    "accept-encoding",
+    "accept-language",
+    "accept-ranges",
+    "access-control-request-headers",
+    "access-control-request-method",
+    "age",
+    "allow",
+    "alt-svc",
+    "authorization",
+    "cache-control",
+    "connection",
+    "content-description",
+    "content-disposition",
+    "content-encoding",
+    "content-language",
+    "content-length",
+    "content-location",
+    "content-range",
+    "content-transfer-encoding",
+    "content-type",
+    "cookie",
+    "date",
+    "etag",
+    "expect",
+    "expires",
+    "forwarded",
+    "from",
+    "host",
+    "http2-settings",
+    "if-match",
+    "if-modified-since",
+    "if-none-match",
+    "if-range",
+    "if-unmodified-since",
+    "keep-alive",
+    "last-modified",
+    "link",
+    "location",
+    "max-forwards",
+    "origin",
+    "pragma",
+    "proxy-authorization",
+    "range",
+    "referer",
+    "retry-after",
+    "sec-websocket-accept",
+    "sec-websocket-extensions",
+    "sec-websocket-key",
+    "sec-websocket-protocol",
+    "sec-websocket-version",
+    "server",
+    "set-cookie",
+    "te",
+    "trailer",
+    "transfer-encoding",
+    "upgrade",
+    "user-agent",
+    "vary",
+    "via",
+    "www-authenticate",
+    "x-forwarded-for",
+    "x-forwarded-proto",
+    "x-real-ip",
+    "x-shutdown",
+    "x-special-reason",
+]
+
+// the first two tokens are reserved: "none" (not computed) and "other" (not a well known name)
+const reservedTokenAmount = 2
+
+const fnvPrime = 16777619
+
+const fnvOffsetBasis = 0x811c9dc5
+
+const maxSeedTries = 1 << 20
+
+// this has to match the hash function in the generated c code
+function hashHeaderName(name: string, seed: number): number {
+    let hash = seed >>> 0
+
+    for (let i = 0; i < name.length; ++i) {
+        hash = (hash ^ (name.charCodeAt(i) | 0x20)) >>> 0
+        hash = Math.imul(hash, fnvPrime) >>> 0
+    }
+
+    return hash
+}
+
+function nextPowerOfTwo(value: number): number {
+    let result = 1
+
+    while (result < value) {
+        result *= 2
+    }
+
+    return result
+}
+
+interface PerfectHash {
+    seed: number,
+    // the token for every slot, or null if the slot is empty
+    table: (number | null)[]
+}
+
+function findPerfectHash(names: string[], tableSize: number): PerfectHash {
+
+    for (let tryIndex = 0; tryIndex < maxSeedTries; ++tryIndex) {
+        const seed = (fnvOffsetBasis ^ tryIndex) >>> 0
+
+        const table: (number | null)[] = new Array<number | null>(tableSize).fill(null)
+
+        let collision = false
+
+        for (let i = 0; i < names.length; ++i) {
+            // eslint-disable-next-line @typescript-eslint/no-non-null-assertion
+            const slot = hashHeaderName(names[i]!, seed) & (tableSize - 1)
+
+            if (table[slot] !== null) {
+                collision = true
+                break
+            }
+
+            table[slot] = i + reservedTokenAmount
+        }
+
+        if (!collision) {
+            return { seed, table }
+        }
+    }
+
+    throw new Error("Couldn't find a perfect hash for the header names")
+}
+
+function toTokenName(name: string): string {
+    return "HttpHeaderToken" + name.split("-").map((part) => {
+        assert(part.length > 0, "header name parts can't be empty")
+        return part.charAt(0).toUpperCase() + part.slice(1)
+    }).join("")
+}
+
+function toHex(value: number): string {
+    return `0x${value.toString(16).padStart(8, "0")}U`
+}
+
+export async function generateHttpHeaderTokensCodeH(generatedHttpHeaderTokensH: string): Promise<void> {
+
+    const tasks: Promise<void>[] = []
+
+    assert(path.extname(generatedHttpHeaderTokensH) == ".h", "http header tokens file has to end in .h")
+
+    for (const name of wellKnownHeaderNames) {
+        assert(name === name.toLowerCase(), `header name has to be lowercase: ${name}`)
+        assert(/^[a-z0-9-]+$/.test(name), `header name has an invalid character: ${name}`)
+    }
+
+    assert(new Set(wellKnownHeaderNames).size === wellKnownHeaderNames.length, "duplicate header name")
+
+    const tokenAmount = wellKnownHeaderNames.length + reservedTokenAmount
+
+    assert(tokenAmount <= 0xFF, "tokens have to fit into an uint8_t")
+
+    // a load factor of at most 0.25 makes finding a seed cheap
+    const tableSize = nextPowerOfTwo(wellKnownHeaderNames.length * 4)
+
+    const perfectHash = findPerfectHash(wellKnownHeaderNames, tableSize)
+
+    const minLength = Math.min(...wellKnownHeaderNames.map((name) => name.length))
+    const maxLength = Math.max(...wellKnownHeaderNames.map((name) => name.length))
+
+    const headerData = `
+#pragma once
+
+${await addGenerateMacros("http header tokens code")}
+
+#include "utils/utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @enum value
+ */
+typedef enum C_23_NARROW_ENUM_TO(uint8_t) {
+	// the token was not computed, e.g. for header fields, that were constructed by hand
+	HttpHeaderTokenNone = 0,
+	// not a well known header name
+	HttpHeaderTokenOther,
+${wellKnownHeaderNames.map((name) => `	${toTokenName(name)},`).join("\n")}
+} HttpHeaderToken;
+
+#define HTTP_HEADER_TOKEN_COUNT ${tokenAmount.toString()}
+
+// header names are case insensitive, the lookup uses a perfect hash, that was generated at build time
+NODISCARD HttpHeaderToken get_http_header_token(const char* name, size_t name_len);
+
+// returns the lowercase name or NULL for HttpHeaderTokenNone and HttpHeaderTokenOther
+NODISCARD const char* get_http_header_token_name(HttpHeaderToken token);
+
+#ifdef __cplusplus
+}
+#endif
+`
+
+    tasks.push(writeFileAndDirs(generatedHttpHeaderTokensH, headerData))
+
+    const tableRows: string[] = []
+
+    const rowSize = 16
+
+    for (let i = 0; i < perfectHash.table.length; i += rowSize) {
+        const row = perfectHash.table.slice(i, i + rowSize).map((token) => (token ?? 1).toString())
+        tableRows.push(`	${row.join(", ")},`)
+    }
+
+    const cFileData = `
+#include "./${path.basename(generatedHttpHeaderTokensH)}"
+
+${await addGenerateMacros("http header tokens code")}
+
+#include <strings.h>
+
+#define HTTP_HEADER_TOKEN_HASH_SEED ${toHex(perfectHash.seed)}
+
+#define HTTP_HEADER_TOKEN_HASH_PRIME ${toHex(fnvPrime)}
+
+#define HTTP_HEADER_TOKEN_TABLE_SIZE ${tableSize.toString()}
+
+#define HTTP_HEADER_TOKEN_MIN_LENGTH ${minLength.toString()}
+
+#define HTTP_HEADER_TOKEN_MAX_LENGTH ${maxLength.toString()}
+
+typedef struct {
+	const char* name;
+	size_t length;
+} HttpHeaderTokenName;
+
+static const HttpHeaderTokenName g_http_header_token_names[HTTP_HEADER_TOKEN_COUNT] = {
+	[HttpHeaderTokenNone] = { .name = NULL, .length = 0 },
+	[HttpHeaderTokenOther] = { .name = NULL, .length = 0 },
+${wellKnownHeaderNames.map((name) => `	[${toTokenName(name)}] = { .name = "${name}", .length = ${name.length.toString()} },`).join("\n")}
+};
+
+// empty slots map to HttpHeaderTokenOther
+static const uint8_t g_http_header_token_table[HTTP_HEADER_TOKEN_TABLE_SIZE] = {
+${tableRows.join("\n")}
+};
+
+NODISCARD static uint32_t get_http_header_token_hash(const char* const name, const size_t name_len) {
+	uint32_t hash = HTTP_HEADER_TOKEN_HASH_SEED;
+
+	for(size_t i = 0; i < name_len; ++i) {
+		// this lowercases letters, all other characters are only hashed, as the name is compared afterwards
+		hash ^= (uint32_t)((uint8_t)name[i] | 0x20U);
+		hash *= HTTP_HEADER_TOKEN_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+NODISCARD HttpHeaderToken get_http_header_token(const char* const name, const size_t name_len) {
+
+	if(name_len < HTTP_HEADER_TOKEN_MIN_LENGTH || name_len > HTTP_HEADER_TOKEN_MAX_LENGTH) {
+		return HttpHeaderTokenOther;
+	}
+
+	const uint32_t hash = get_http_header_token_hash(name, name_len);
+
+	const HttpHeaderToken token =
+	    (HttpHeaderToken)g_http_header_token_table[hash & (HTTP_HEADER_TOKEN_TABLE_SIZE - 1)];
+
+	if(token == HttpHeaderTokenOther) {
+		return HttpHeaderTokenOther;
+	}
+
+	const HttpHeaderTokenName entry = g_http_header_token_names[token];
+
+	if(entry.length != name_len || strncasecmp(entry.name, name, name_len) != 0) {
+		return HttpHeaderTokenOther;
+	}
+
+	return token;
+}
+
+NODISCARD const char* get_http_header_token_name(const HttpHeaderToken token) {
+	if(token >= HTTP_HEADER_TOKEN_COUNT) {
+		return NULL;
+	}
+
+	return g_http_header_token_names[token].name;
+}
+`
+
+    const generatedHttpHeaderTokensC = getOtherFile(generatedHttpHeaderTokensH, ".h", ".c")
+
+    tasks.push(writeFileAndDirs(generatedHttpHeaderTokensC, cFileData))
+
+    await Promise.all(tasks)
+}
@@ -7,7 +7,7 @@ export async function subcommandGenerator(args: string[]): Promise<void> {
     const options: Partial<GenerateOptions> = {
     }
 
-    const allTypes: GenerateType[] = ["c_hpack_huffman", "c_header_table", "cpp_tests", "c_variants"] as const
+    const allTypes: GenerateType[] = ["c_hpack_huffman", "c_header_table", "c_http_header_tokens", "cpp_tests", "c_variants"] as const
 
     for (let i = 0; i < args.length; ++i) {
         // eslint-disable-next-line @typescript-eslint/no-non-null-assertion